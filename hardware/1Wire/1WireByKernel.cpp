@@ -26,7 +26,7 @@
 
 C1WireByKernel::C1WireByKernel()
 {
-   m_Thread = new boost::thread(&C1WireByKernel::ThreadFunction,this);
+   m_Thread = new boost::thread(GetWorkerThreadAttributes(), boost::bind(&C1WireByKernel::ThreadFunction, this));
    _log.Log(LOG_STATUS,"Using 1-Wire support (kernel W1 module)...");
 }
 
@@ -12,6 +12,9 @@
 
 #define round(a) ( int ) ( a + .5 )
 
+#define ACCUWEATHER_CACHE_MAX_AGE 540
+#define ACCUWEATHER_LOCATION_CACHE_MAX_AGE 3600
+
 #ifdef _DEBUG
 	//#define DEBUG_AccuWeatherR
 	//#define DEBUG_AccuWeatherW
@@ -70,7 +73,7 @@ bool CAccuWeather::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CAccuWeather::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CAccuWeather::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	return (m_thread!=NULL);
@@ -136,7 +139,7 @@ std::string CAccuWeather::GetLocationKey()
 	{
 		bool bret;
 		std::string szURL = sURL.str();
-		bret = HTTPClient::GET(szURL, sResult);
+		bret = HTTPClient::GETCached(szURL, sResult, ACCUWEATHER_LOCATION_CACHE_MAX_AGE);
 		if (!bret)
 		{
 			_log.Log(LOG_ERROR, "AccuWeather: Error getting http data!");
@@ -204,7 +207,7 @@ void CAccuWeather::GetMeterDetails()
 	{
 		bool bret;
 		std::string szURL = sURL.str();
-		bret = HTTPClient::GET(szURL, sResult);
+		bret = HTTPClient::GETCached(szURL, sResult, ACCUWEATHER_CACHE_MAX_AGE);
 		if (!bret)
 		{
 			_log.Log(LOG_ERROR, "AccuWeather: Error getting http data!");
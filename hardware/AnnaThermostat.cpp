@@ -48,6 +48,8 @@ std::string ReadFile(std::string filename)
 }
 #endif
 
+#define ANNA_POLL_INTERVAL 30
+
 CAnnaThermostat::CAnnaThermostat(const int ID, const std::string &IPAddress, const unsigned short usIPPort, const std::string &Username, const std::string &Password) :
 m_IPAddress(IPAddress),
 m_IPPort(usIPPort),
@@ -66,58 +68,29 @@ CAnnaThermostat::~CAnnaThermostat(void)
 void CAnnaThermostat::Init()
 {
 	m_ThermostatID = "";
-	m_stoprequested = false;
+	m_PollID = 0;
 }
 
 bool CAnnaThermostat::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CAnnaThermostat::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "AnnaThermostat", boost::bind(&CAnnaThermostat::GetMeterDetails, this), ANNA_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
-	return (m_thread!=NULL);
+	return true;
 }
 
 bool CAnnaThermostat::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
     m_bIsStarted=false;
     return true;
 }
 
-#define ANNA_POLL_INTERVAL 30
-
-void CAnnaThermostat::Do_Work()
-{
-	bool bFirstTime = true;
-	_log.Log(LOG_STATUS,"AnnaThermostat: Worker started...");
-	int sec_counter = ANNA_POLL_INTERVAL-5;
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-		if (sec_counter % 12 == 0)
-		{
-			m_LastHeartbeat = mytime(NULL);
-		}
-
-		if ((sec_counter % ANNA_POLL_INTERVAL == 0) || (bFirstTime))
-		{
-			sec_counter = 0;
-			bFirstTime = false;
-			GetMeterDetails();
-		}
-
-	}
-	_log.Log(LOG_STATUS,"AnnaThermostat: Worker stopped...");
-}
-
 void CAnnaThermostat::SendSetPointSensor(const unsigned char Idx, const float Temp, const std::string &defaultname)
 {
 	_tThermostat thermos;
@@ -243,12 +216,12 @@ std::string GetPeriodMeasurement(TiXmlElement *pElement)
 	return ret;
 }
 
-void CAnnaThermostat::GetMeterDetails()
+bool CAnnaThermostat::GetMeterDetails()
 {
 	if (m_UserName.size() == 0)
-		return;
+		return true;
 	if (m_Password.size() == 0)
-		return;
+		return true;
 	std::string sResult;
 #ifdef DEBUG_AnnaThermostat
 	sResult = ReadFile("E:\\appliances.xml");
@@ -269,13 +242,13 @@ void CAnnaThermostat::GetMeterDetails()
 	if (!HTTPClient::GET(szURL.str(), sResult))
 	{
 		_log.Log(LOG_ERROR, "AnnaThermostat: Error getting current state!");
-		return;
+		return false;
 	}
 #endif
 	if (sResult.empty())
 	{
 		_log.Log(LOG_ERROR, "AnnaThermostat: Invalid data received!");
-		return;
+		return false;
 	}
 
 	stdreplace(sResult, "\r\n", "");
@@ -284,7 +257,7 @@ void CAnnaThermostat::GetMeterDetails()
 	if (doc.Parse(sResult.c_str()))
 	{
 		_log.Log(LOG_ERROR, "AnnaThermostat: Invalid data received!");
-		return;
+		return false;
 	}
 
 	TiXmlElement *pRoot;
@@ -296,7 +269,7 @@ void CAnnaThermostat::GetMeterDetails()
 	if (!pRoot)
 	{
 		_log.Log(LOG_ERROR, "AnnaThermostat: Invalid data received!");
-		return;
+		return false;
 	}
 	pAppliance = pRoot->FirstChildElement("appliance");
 	while (pAppliance)
@@ -307,7 +280,7 @@ void CAnnaThermostat::GetMeterDetails()
 		if (pElem == NULL)
 		{
 			_log.Log(LOG_ERROR, "AnnaThermostat: Invalid data received!");
-			return;
+			return false;
 		}
 		std::string ApplianceName=pElem->GetText();
 
@@ -329,14 +302,14 @@ void CAnnaThermostat::GetMeterDetails()
 		if (!pElem)
 		{
 			_log.Log(LOG_ERROR, "AnnaThermostat: Invalid data received!");
-			return;
+			return false;
 		}
 		TiXmlHandle hLogs = TiXmlHandle(pElem);
 		pElem = hAppliance.FirstChild("logs").Child("point_log", 0).ToElement();
 		if (!pElem)
 		{
 			_log.Log(LOG_ERROR, "AnnaThermostat: Invalid data received!");
-			return;
+			return false;
 		}
 		for (pElem; pElem; pElem = pElem->NextSiblingElement())
 		{
@@ -410,5 +383,5 @@ void CAnnaThermostat::GetMeterDetails()
 
 		pAppliance = pAppliance->NextSiblingElement("appliance");
 	}
-	return;
+	return true;
 }
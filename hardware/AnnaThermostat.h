@@ -21,13 +21,11 @@ private:
 	std::string m_UserName;
 	std::string m_Password;
 	std::string m_ThermostatID;
-	volatile bool m_stoprequested;
-	boost::shared_ptr<boost::thread> m_thread;
+	int m_PollID;
 
 	void Init();
 	bool StartHardware();
 	bool StopHardware();
-	void Do_Work();
-	void GetMeterDetails();
+	bool GetMeterDetails();
 };
 
@@ -48,7 +48,7 @@ bool Arilux::StartHardware()
 	m_bIsStarted = true;
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&Arilux::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&Arilux::Do_Work, this)));
 
 	return (m_thread != NULL);
 }
@@ -60,6 +60,8 @@ std::string ReadFile(std::string filename)
 }
 #endif
 
+#define AtagOne_POLL_INTERVAL 60
+
 CAtagOne::CAtagOne(const int ID, const std::string &Username, const std::string &Password, const int Mode1, const int Mode2, const int Mode3, const int Mode4, const int Mode5, const int Mode6)
 {
 	m_UserName = Username;
@@ -87,27 +89,25 @@ void CAtagOne::Init()
 {
 	m_ThermostatID = "";
 	m_bDoLogin = true;
-	m_stoprequested = false;
+	m_PollID = 0;
 }
 
 bool CAtagOne::StartHardware()
 {
 	Init();
 	m_LastMinute = -1;
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CAtagOne::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "AtagOne", boost::bind(&CAtagOne::GetMeterDetails, this), AtagOne_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
-	return (m_thread!=NULL);
+	return true;
 }
 
 bool CAtagOne::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
     m_bIsStarted=false;
     return true;
@@ -246,27 +246,7 @@ void CAtagOne::Logout()
 }
 
 
-#define AtagOne_POLL_INTERVAL 60
 
-void CAtagOne::Do_Work()
-{
-	_log.Log(LOG_STATUS,"AtagOne: Worker started...");
-	int sec_counter = AtagOne_POLL_INTERVAL-5;
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat=mytime(NULL);
-		}
-		if (sec_counter % AtagOne_POLL_INTERVAL == 0)
-		{
-			//SendOutsideTemperature();
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS,"AtagOne: Worker stopped...");
-}
 
 bool CAtagOne::GetOutsideTemperatureFromDomoticz(float &tvalue)
 {
@@ -356,15 +336,15 @@ static std::string GetHTMLPageValue(const std::string &hpage, const std::string
 	return "";
 }
 
-void CAtagOne::GetMeterDetails()
+bool CAtagOne::GetMeterDetails()
 {
 	if (m_UserName.empty() || m_Password.empty() )
-		return;
+		return true;
 
 	if (m_bDoLogin)
 	{
 		if (!Login())
-			return;
+			return false;
 	}
 
 	std::string sResult;
@@ -376,7 +356,7 @@ void CAtagOne::GetMeterDetails()
 	{
 		_log.Log(LOG_ERROR, "AtagOne: Error getting thermostat data!");
 		m_bDoLogin = true;
-		return;
+		return false;
 	}
 
 #ifdef DEBUG_AtagOneThermostat
@@ -390,7 +370,7 @@ void CAtagOne::GetMeterDetails()
 	if (sret.empty())
 	{
 		_log.Log(LOG_ERROR, "AtagOne: Invalid/no data received...");
-		return;
+		return false;
 	}
 	root["roomTemperature"] = static_cast<float>(atof(sret.c_str()));
 	root["deviceAlias"] = GetHTMLPageValue(sResult, "Apparaat alias", "Device alias", false);
@@ -418,7 +398,7 @@ void CAtagOne::GetMeterDetails()
 	{
 		_log.Log(LOG_ERROR, "AtagOne: Error getting target setpoint data!");
 		m_bDoLogin = true;
-		return;
+		return false;
 	}
 #ifdef DEBUG_AtagOneThermostat
 	SaveString2Disk(sResult, "E:\\AtagOne_gettargetsetpoint.txt");
@@ -430,12 +410,12 @@ void CAtagOne::GetMeterDetails()
 	if ((!ret) || (!root2.isObject()))
 	{
 		_log.Log(LOG_ERROR, "AtagOne: Invalid/no data received...");
-		return;
+		return false;
 	}
 	if (root2["targetTemp"].empty())
 	{
 		_log.Log(LOG_ERROR, "AtagOne: Invalid/no data received...");
-		return;
+		return false;
 	}
 	root["targetTemperature"] = static_cast<float>(atof(root2["targetTemp"].asString().c_str()));
 	root["currentMode"] = root2["currentMode"].asString();
@@ -499,6 +479,7 @@ void CAtagOne::GetMeterDetails()
 		SendSwitch(2, 1, 255, root["flameStatus"].asBool(), 0, "Flame Status");
 	}
 	
+	return true;
 }
 
 void CAtagOne::SetSetpoint(const int idx, const float temp)
@@ -28,8 +28,7 @@ private:
 	bool m_bDoLogin;
 
 	int m_OutsideTemperatureIdx;
-	volatile bool m_stoprequested;
-	boost::shared_ptr<boost::thread> m_thread;
+	int m_PollID;
 
 	int m_LastMinute;
 
@@ -37,7 +36,6 @@ private:
 	void SetModes(const int Mode1, const int Mode2, const int Mode3, const int Mode4, const int Mode5, const int Mode6);
 	bool StartHardware();
 	bool StopHardware();
-	void Do_Work();
-	void GetMeterDetails();
+	bool GetMeterDetails();
 };
 
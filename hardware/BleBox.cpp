@@ -52,7 +52,7 @@ bool BleBox::StartHardware()
 {
 	if (LoadNodes())
 	{
-		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&BleBox::Do_Work, this)));
+		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&BleBox::Do_Work, this)));
 		m_bIsStarted = true;
 		sOnConnected(this);
 		return (m_thread != NULL);
@@ -1167,7 +1167,7 @@ void BleBox::SearchNodes(const std::string &ipmask)
 		std::map<const std::string, const int>::const_iterator itt = m_devices.find(IPAddress);
 		if (itt == m_devices.end())
 		{
-			searchingThreads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&BleBox::AddNode, this, "unknown", IPAddress))));
+			searchingThreads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&BleBox::AddNode, this, "unknown", IPAddress))));
 		}
 	}
 
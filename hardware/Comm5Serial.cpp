@@ -83,7 +83,7 @@ bool Comm5Serial::WriteToHardware(const char * pdata, const unsigned char length
 bool Comm5Serial::StartHardware()
 {
 	m_stoprequested = false;
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&Comm5Serial::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&Comm5Serial::Do_Work, this)));
 
 	//Try to open the Serial Port
 	try
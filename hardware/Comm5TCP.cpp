@@ -55,7 +55,7 @@ bool Comm5TCP::StartHardware()
 	m_rxbufferpos = 0;
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&Comm5TCP::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&Comm5TCP::Do_Work, this)));
 
 	_log.Log(LOG_STATUS, "Comm5 MA-5XXX: Started");
 
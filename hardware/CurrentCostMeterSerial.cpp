@@ -34,7 +34,7 @@ CurrentCostMeterSerial::~CurrentCostMeterSerial()
 bool CurrentCostMeterSerial::StartHardware()
 {
 	m_stoprequested = false;
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CurrentCostMeterSerial::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CurrentCostMeterSerial::Do_Work, this)));
 
 	//Try to open the Serial Port
 	try
@@ -56,7 +56,7 @@ bool CurrentCostMeterTCP::StartHardware()
 	m_bIsStarted=true;
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CurrentCostMeterTCP::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CurrentCostMeterTCP::Do_Work, this)));
 	return (m_thread!=NULL);
 }
 
@@ -12,6 +12,8 @@
 
 #define round(a) ( int ) ( a + .5 )
 
+#define DARKSKY_CACHE_MAX_AGE 540
+
 #ifdef _DEBUG
 //#define DEBUG_DarkSkyR
 //#define DEBUG_DarkSkyW
@@ -68,7 +70,7 @@ bool CDarkSky::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CDarkSky::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CDarkSky::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	return (m_thread!=NULL);
@@ -132,7 +134,7 @@ void CDarkSky::GetMeterDetails()
 	{
 		bool bret;
 		std::string szURL = sURL.str();
-		bret = HTTPClient::GET(szURL, sResult);
+		bret = HTTPClient::GETCached(szURL, sResult, DARKSKY_CACHE_MAX_AGE);
 		if (!bret)
 		{
 			_log.Log(LOG_ERROR, "DarkSky: Error getting http data!.");
@@ -17,7 +17,7 @@ m_Password(CURLEncode::URLEncode(password))
 {
 	m_HwdID=ID;
 	m_usIPPort=usIPPort;
-	m_stoprequested=false;
+	m_PollID = 0;
 	m_bOutputLog = false;
 	Init();
 }
@@ -33,47 +33,24 @@ void CDenkoviSmartdenLan::Init()
 bool CDenkoviSmartdenLan::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CDenkoviSmartdenLan::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "Denkovi", boost::bind(&CDenkoviSmartdenLan::GetMeterDetails, this), DenkoviSmartdenLan_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
 	_log.Log(LOG_STATUS, "Denkovi: Started");
-	return (m_thread!=NULL);
+	return true;
 }
 
 bool CDenkoviSmartdenLan::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
     m_bIsStarted=false;
     return true;
 }
 
-void CDenkoviSmartdenLan::Do_Work()
-{
-	int sec_counter = DenkoviSmartdenLan_POLL_INTERVAL - 2;
-
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat=mytime(NULL);
-		}
-
-		if (sec_counter % DenkoviSmartdenLan_POLL_INTERVAL == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS,"Denkovi: Worker stopped...");
-}
-
 bool CDenkoviSmartdenLan::WriteToHardware(const char *pdata, const unsigned char length)
 {
 	const tRBUF *pSen = reinterpret_cast<const tRBUF*>(pdata);
@@ -172,7 +149,7 @@ void CDenkoviSmartdenLan::UpdateSwitch(const unsigned char Idx, const int SubUni
 	sDecodeRXMessage(this, (const unsigned char *)&lcmd.LIGHTING2, defaultname.c_str(), 255);
 }
 
-void CDenkoviSmartdenLan::GetMeterDetails()
+bool CDenkoviSmartdenLan::GetMeterDetails()
 {
 	std::string sResult;
 	std::stringstream szURL;
@@ -186,19 +163,19 @@ void CDenkoviSmartdenLan::GetMeterDetails()
 	if (!HTTPClient::GET(szURL.str(),sResult))
 	{
 		_log.Log(LOG_ERROR,"Denkovi: Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	std::vector<std::string> results;
 	StringSplit(sResult, "\r\n", results);
 	if (results.size()<8)
 	{
 		_log.Log(LOG_ERROR,"Denkovi: Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	if (results[0] != "<CurrentState>")
 	{
 		_log.Log(LOG_ERROR, "Denkovi: Error getting status");
-		return;
+		return false;
 	}
 	size_t ii;
 	std::string tmpstr;
@@ -236,4 +213,5 @@ void CDenkoviSmartdenLan::GetMeterDetails()
 			}
 		}
 	}
+	return true;
 }
@@ -14,14 +14,12 @@ private:
 	std::string m_szIPAddress;
 	unsigned short m_usIPPort;
 	std::string m_Password;
-	volatile bool m_stoprequested;
-	boost::shared_ptr<boost::thread> m_thread;
+	int m_PollID;
 
 	void Init();
 	bool StartHardware();
 	bool StopHardware();
-	void Do_Work();
-	void GetMeterDetails();
+	bool GetMeterDetails();
 	void UpdateSwitch(const unsigned char Idx, const int SubUnit, const bool bOn, const double Level, const std::string &defaultname);
 };
 
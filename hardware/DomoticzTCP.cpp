@@ -141,7 +141,7 @@ bool DomoticzTCP::StartHardwareTCP()
 	m_retrycntr=RETRY_DELAY; //will force reconnect first thing
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&DomoticzTCP::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&DomoticzTCP::Do_Work, this)));
 
 	return (m_thread!=NULL);
 }
@@ -18,7 +18,7 @@ m_Password(CURLEncode::URLEncode(password))
 {
 	m_HwdID=ID;
 	m_usIPPort=usIPPort;
-	m_stoprequested=false;
+	m_PollID = 0;
 	m_bOutputLog = false;
 	Init();
 }
@@ -34,47 +34,24 @@ void CETH8020::Init()
 bool CETH8020::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CETH8020::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "ETH8020", boost::bind(&CETH8020::GetMeterDetails, this), ETH8020_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
 	_log.Log(LOG_STATUS, "ETH8020: Started");
-	return (m_thread!=NULL);
+	return true;
 }
 
 bool CETH8020::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
     m_bIsStarted=false;
     return true;
 }
 
-void CETH8020::Do_Work()
-{
-	int sec_counter = ETH8020_POLL_INTERVAL - 2;
-
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat=mytime(NULL);
-		}
-
-		if (sec_counter % ETH8020_POLL_INTERVAL == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS,"ETH8020: Worker stopped...");
-}
-
 bool CETH8020::WriteToHardware(const char *pdata, const unsigned char length)
 {
 	const tRBUF *pSen = reinterpret_cast<const tRBUF*>(pdata);
@@ -176,7 +153,7 @@ void CETH8020::UpdateSwitch(const unsigned char Idx, const int SubUnit, const bo
 	sDecodeRXMessage(this, (const unsigned char *)&lcmd.LIGHTING2, defaultname.c_str(), 255);
 }
 
-void CETH8020::GetMeterDetails()
+bool CETH8020::GetMeterDetails()
 {
 	std::string sResult;
 	std::stringstream szURL;
@@ -195,19 +172,19 @@ void CETH8020::GetMeterDetails()
 	if (!HTTPClient::GET(szURL.str(),sResult))
 	{
 		_log.Log(LOG_ERROR,"ETH8020: Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	std::vector<std::string> results;
 	StringSplit(sResult, "\r\n", results);
 	if (results.size()<8)
 	{
 		_log.Log(LOG_ERROR,"ETH8020: Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	if (results[0] != "<response>")
 	{
 		_log.Log(LOG_ERROR, "ETH8020: Error getting status");
-		return;
+		return false;
 	}
 	size_t ii;
 	std::string tmpstr;
@@ -256,4 +233,5 @@ void CETH8020::GetMeterDetails()
 			}
 		}
 	}
+	return true;
 }
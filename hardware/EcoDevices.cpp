@@ -27,6 +27,7 @@ Version history
 #include "EcoDevices.h"
 #include "../main/Helper.h"
 #include "../main/Logger.h"
+#include "../main/mainworker.h"
 #include "hardwaretypes.h"
 #include "../main/localtime_r.h"
 #include "../httpclient/HTTPClient.h"
@@ -42,12 +43,14 @@ Version history
 #define MINOR 5
 #define RELEASE 12
 
+#define ECODEVICES_POLL_INTERVAL 30
+
 CEcoDevices::CEcoDevices(const int ID, const std::string &IPAddress, const unsigned short usIPPort)
 {
 	m_HwdID = ID;
 	m_szIPAddress = IPAddress;
 	m_usIPPort = usIPPort;
-	m_stoprequested = false;
+	m_PollID = 0;
 
 	Init();
 }
@@ -60,57 +63,31 @@ CEcoDevices::~CEcoDevices(void)
 
 void CEcoDevices::Init()
 {
-	m_stoprequested = false;
 }
 
 
 bool CEcoDevices::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CEcoDevices::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "EcoDevices", boost::bind(&CEcoDevices::GetMeterDetails, this), ECODEVICES_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
-	return (m_thread!=NULL);
+	return true;
 }
 
 
 bool CEcoDevices::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
 	m_bIsStarted=false;
 	return true;
 }
 
 
-#define ECODEVICES_POLL_INTERVAL 30
-
-void CEcoDevices::Do_Work()
-{
-	int sec_counter = 0;
-	_log.Log(LOG_STATUS,"EcoDevices: Worker started...");
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-		if (sec_counter % 12 == 0)
-		{
-			mytime(&m_LastHeartbeat);
-		}
-		if (sec_counter%ECODEVICES_POLL_INTERVAL == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS,"EcoDevices: Worker stopped...");
-}
-
-
 bool CEcoDevices::WriteToHardware(const char *pdata, const unsigned char length)
 {
 	return true;
@@ -162,10 +139,10 @@ void CEcoDevices::DecodeXML2Teleinfo(const std::string &sResult, Teleinfo &telei
 }
 
 
-void CEcoDevices::GetMeterDetails()
+bool CEcoDevices::GetMeterDetails()
 {
 	if (m_szIPAddress.size()==0)
-		return;
+		return true;
 	// From http://xx.xx.xx.xx/status.xml we get the pulse counters indexes and current flow
 	// From http://xx.xx.xx.xx/protect/settings/teleinfoX.xml we get a complete feed of Teleinfo data
 
@@ -188,7 +165,7 @@ void CEcoDevices::GetMeterDetails()
 	else
 	{
 		_log.Log(LOG_ERROR, "EcoDevices: Error getting status.xml from EcoDevices%s!", m_status.hostname.c_str());
-		return;
+		return false;
 	}
 
 	// Process XML result
@@ -196,7 +173,7 @@ void CEcoDevices::GetMeterDetails()
 	if (XMLdoc.Error())
 	{
 		_log.Log(LOG_ERROR, "Error parsing XML at /status.xml: %s", XMLdoc.ErrorDesc());
-		return;
+		return false;
 	}
 
 	// XML format changes dramatically between firmware versions. This code was developped for version 1.05.12
@@ -253,7 +230,7 @@ void CEcoDevices::GetMeterDetails()
 		message = message + static_cast<std::ostringstream*>( &(std::ostringstream() << min_major << "." << min_minor << "." << min_release) )->str();
 		message = message + ", current version is " + m_status.version;
 		_log.Log(LOG_ERROR, message.c_str());
-		return;
+		return false;
 	}
 
 	// Query Teleinfo counters only if an active subscrition is detected (PTEC != "----")
@@ -267,7 +244,7 @@ void CEcoDevices::GetMeterDetails()
 		if (!HTTPClient::GET(sstr.str(), ExtraHeaders, sResult))
 		{
 			_log.Log(LOG_ERROR, "EcoDevices: Error getting teleinfo1.xml from EcoDevices %s!", m_status.hostname.c_str());
-			return;
+			return false;
 		}
 		#ifdef DEBUG_EcoDevices
 		_log.Log(LOG_NORM, "DEBUG: XML output for Teleinfo1:\n%s", MakeHtml(sResult).c_str());
@@ -291,7 +268,7 @@ void CEcoDevices::GetMeterDetails()
 		if (!HTTPClient::GET(sstr.str(), ExtraHeaders, sResult))
 		{
 			_log.Log(LOG_ERROR, "EcoDevices: Error getting teleinfo2.xml from EcoDevices %s!", m_status.hostname.c_str());
-			return;
+			return false;
 		}
 		#ifdef DEBUG_EcoDevices
 		_log.Log(LOG_NORM, "DEBUG: XML output for Teleinfo2:\n%s", MakeHtml(sResult).c_str());
@@ -307,4 +284,5 @@ void CEcoDevices::GetMeterDetails()
 		ProcessTeleinfo("Teleinfo 2", 2, m_teleinfo2);
 	}
 
+	return true;
 }
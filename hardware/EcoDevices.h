@@ -17,8 +17,7 @@ class CEcoDevices : public CTeleinfoBase
 
 		std::string m_szIPAddress;
 		unsigned short m_usIPPort;
-		bool m_stoprequested;
-		boost::shared_ptr<boost::thread> m_thread;
+		int m_PollID;
 
 		typedef struct _tStatus
 		{
@@ -56,7 +55,6 @@ class CEcoDevices : public CTeleinfoBase
 		void Init();
 		bool StartHardware();
 		bool StopHardware();
-		void Do_Work();
 		void DecodeXML2Teleinfo(const std::string &sResult, Teleinfo &teleinfo);
-		void GetMeterDetails();
+		bool GetMeterDetails();
 };
@@ -282,6 +282,71 @@ const _t4BSLookup T4BSTable[]=
 	{ 0, 0, 0, 0, 0 }
 };
 
+struct _t4BSTempScale
+{
+	const int Func;
+	const int Type;
+	const float ScaleMin;
+	const float ScaleMax;
+};
+
+//Temperature range of the 4BS temperature profiles (raw 255 = ScaleMin, raw 0 = ScaleMax)
+const _t4BSTempScale T4BSTempScaleTable[]=
+{
+	//A5-02: Temperature Sensors (8 bit)
+	{ 0x02, 0x01, -40, 0 },
+	{ 0x02, 0x02, -30, 10 },
+	{ 0x02, 0x03, -20, 20 },
+	{ 0x02, 0x04, -10, 30 },
+	{ 0x02, 0x05, 0, 40 },
+	{ 0x02, 0x06, 10, 50 },
+	{ 0x02, 0x07, 20, 60 },
+	{ 0x02, 0x08, 30, 70 },
+	{ 0x02, 0x09, 40, 80 },
+	{ 0x02, 0x0A, 50, 90 },
+	{ 0x02, 0x0B, 60, 100 },
+	{ 0x02, 0x10, -60, 20 },
+	{ 0x02, 0x11, -50, 30 },
+	{ 0x02, 0x12, -40, 40 },
+	{ 0x02, 0x13, -30, 50 },
+	{ 0x02, 0x14, -20, 60 },
+	{ 0x02, 0x15, -10, 70 },
+	{ 0x02, 0x16, 0, 80 },
+	{ 0x02, 0x17, 10, 90 },
+	{ 0x02, 0x18, 20, 100 },
+	{ 0x02, 0x19, 30, 110 },
+	{ 0x02, 0x1A, 40, 120 },
+	{ 0x02, 0x1B, 50, 130 },
+	//A5-02: Temperature Sensors (10 bit)
+	{ 0x02, 0x20, -10, 41.2f },
+	{ 0x02, 0x30, -40, 62.3f },
+	//A5-04: Temperature and Humidity Sensors
+	{ 0x04, 0x01, 0, 40 },
+	{ 0x04, 0x02, -20, 60 },
+	{ 0x04, 0x03, -20, 60 }, //10bit?
+
+	//End of table
+	{ 0, 0, 0, 0 }
+};
+
+bool Get_Enocean4BSTempScale(const int Func, const int Type, float &ScaleMin, float &ScaleMax)
+{
+	const _t4BSTempScale *pTable=(const _t4BSTempScale *)&T4BSTempScaleTable;
+	while (pTable->Func)
+	{
+		if ((pTable->Func == Func)&&(pTable->Type == Type))
+		{
+			ScaleMin=pTable->ScaleMin;
+			ScaleMax=pTable->ScaleMax;
+			return true;
+		}
+		pTable++;
+	}
+	ScaleMin=0;
+	ScaleMax=0;
+	return false;
+}
+
 const char* Get_Enocean4BSType(const int Org, const int Func, const int Type)
 {
 	const _t4BSLookup *pOrgTable=(const _t4BSLookup *)&T4BSTable;
@@ -643,8 +708,10 @@ bool CEnOceanESP2::StartHardware()
 {
 	m_retrycntr=ENOCEAN_RETRY_DELAY*5; //will force reconnect first thing
 
+	LoadSensors();
+
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CEnOceanESP2::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CEnOceanESP2::Do_Work, this)));
 
 	return (m_thread!=NULL);
 }
@@ -1231,6 +1298,48 @@ float CEnOceanESP2::GetValueRange(const float InValue, const float ScaleMax, con
 	return multiplyer*(InValue-RangeMin)+ScaleMin;
 }
 
+void CEnOceanESP2::LoadSensors()
+{
+	m_sensors.clear();
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT DeviceID, Manufacturer, Profile, [Type] FROM EnoceanSensors WHERE (HardwareID==%d)", m_HwdID);
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		std::vector<std::string> sd = *itt;
+		_tEnOceanSensor sensor;
+		sensor.Manufacturer = atoi(sd[1].c_str());
+		sensor.Profile = atoi(sd[2].c_str());
+		sensor.Type = atoi(sd[3].c_str());
+		sensor.szST = Get_Enocean4BSType(0xA5, sensor.Profile, sensor.Type);
+		m_sensors[sd[0]] = sensor;
+	}
+}
+
+bool CEnOceanESP2::GetSensor(const std::string &szDeviceID, _tEnOceanSensor &sensor)
+{
+	std::map<std::string, _tEnOceanSensor>::const_iterator itt = m_sensors.find(szDeviceID);
+	if (itt == m_sensors.end())
+		return false;
+	sensor = itt->second;
+	return true;
+}
+
+//Returns false if the sensor was already teached-in
+bool CEnOceanESP2::AddSensor(const std::string &szDeviceID, const int Manufacturer, const int Profile, const int Type)
+{
+	if (m_sensors.find(szDeviceID) != m_sensors.end())
+		return false;
+	m_sql.safe_query("INSERT INTO EnoceanSensors (HardwareID, DeviceID, Manufacturer, Profile, [Type]) VALUES (%d,'%q',%d,%d,%d)", m_HwdID, szDeviceID.c_str(), Manufacturer, Profile, Type);
+	_tEnOceanSensor sensor;
+	sensor.Manufacturer = Manufacturer;
+	sensor.Profile = Profile;
+	sensor.Type = Type;
+	sensor.szST = Get_Enocean4BSType(0xA5, Profile, Type);
+	m_sensors[szDeviceID] = sensor;
+	return true;
+}
+
 bool CEnOceanESP2::ParseData()
 {
 	enocean_data_structure *pFrame=(enocean_data_structure*)&m_buffer;
@@ -1374,25 +1483,15 @@ bool CEnOceanESP2::ParseData()
 						profile,ttype,Get_Enocean4BSType(0xA5,profile,ttype));
 
 
-					std::vector<std::vector<std::string> > result;
-					result = m_sql.safe_query("SELECT ID FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-					if (result.size()<1)
-					{
-						//Add it to the database
-						result = m_sql.safe_query(
-							"INSERT INTO EnoceanSensors (HardwareID, DeviceID, Manufacturer, Profile, [Type]) "
-							"VALUES (%d,'%q',%d,%d,%d)",
-							m_HwdID, szDeviceID, manufacturer, profile, ttype);
-					}
+					AddSensor(szDeviceID, manufacturer, profile, ttype);
 
 				}
 			}
 			else
 			{
 				//Following sensors need to have had a teach-in
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT ID, Manufacturer, Profile, [Type] FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-				if (result.size()<1)
+				_tEnOceanSensor sensor;
+				if (!GetSensor(szDeviceID, sensor))
 				{
 					char *pszHumenTxt=enocean_hexToHuman(pFrame);
 					if (pszHumenTxt)
@@ -1402,11 +1501,11 @@ bool CEnOceanESP2::ParseData()
 					}
 					return true;
 				}
-				int Manufacturer=atoi(result[0][1].c_str());
-				int Profile=atoi(result[0][2].c_str());
-				int iType=atoi(result[0][3].c_str());
+				int Manufacturer=sensor.Manufacturer;
+				int Profile=sensor.Profile;
+				int iType=sensor.Type;
 
-				const std::string szST=Get_Enocean4BSType(0xA5,Profile,iType);
+				const std::string szST=sensor.szST;
 
 				if (szST=="AMR.Counter")
 				{
@@ -1583,39 +1682,14 @@ bool CEnOceanESP2::ParseData()
 				else if (szST.find("Temperature")==0)
 				{
 					//(EPP A5-02 01/30)
-					float ScaleMax=0;
-					float ScaleMin=0;
-					if (iType==0x01) { ScaleMax=-40; ScaleMin=0; }
-					else if (iType==0x02) { ScaleMax=-30; ScaleMin=10; }
-					else if (iType==0x03) { ScaleMax=-20; ScaleMin=20; }
-					else if (iType==0x04) { ScaleMax=-10; ScaleMin=30; }
-					else if (iType==0x05) { ScaleMax=0; ScaleMin=40; }
-					else if (iType==0x06) { ScaleMax=10; ScaleMin=50; }
-					else if (iType==0x07) { ScaleMax=20; ScaleMin=60; }
-					else if (iType==0x08) { ScaleMax=30; ScaleMin=70; }
-					else if (iType==0x09) { ScaleMax=40; ScaleMin=80; }
-					else if (iType==0x0A) { ScaleMax=50; ScaleMin=90; }
-					else if (iType==0x0B) { ScaleMax=60; ScaleMin=100; }
-					else if (iType==0x10) { ScaleMax=-60; ScaleMin=20; }
-					else if (iType==0x11) { ScaleMax=-50; ScaleMin=30; }
-					else if (iType==0x12) { ScaleMax=-40; ScaleMin=40; }
-					else if (iType==0x13) { ScaleMax=-30; ScaleMin=50; }
-					else if (iType==0x14) { ScaleMax=-20; ScaleMin=60; }
-					else if (iType==0x15) { ScaleMax=-10; ScaleMin=70; }
-					else if (iType==0x16) { ScaleMax=0; ScaleMin=80; }
-					else if (iType==0x17) { ScaleMax=10; ScaleMin=90; }
-					else if (iType==0x18) { ScaleMax=20; ScaleMin=100; }
-					else if (iType==0x19) { ScaleMax=30; ScaleMin=110; }
-					else if (iType==0x1A) { ScaleMax=40; ScaleMin=120; }
-					else if (iType==0x1B) { ScaleMax=50; ScaleMin=130; }
-					else if (iType==0x20) { ScaleMax=-10; ScaleMin=41.2f; }
-					else if (iType==0x30) { ScaleMax=-40; ScaleMin=62.3f; }
+					float ScaleMin, ScaleMax;
+					Get_Enocean4BSTempScale(Profile,iType,ScaleMin,ScaleMax);
 
 					float temp;
 					if (iType<0x20)
-						temp=GetValueRange(pFrame->DATA_BYTE1,ScaleMax,ScaleMin);
+						temp=GetValueRange(pFrame->DATA_BYTE1,ScaleMin,ScaleMax);
 					else
-						temp=GetValueRange(float(((pFrame->DATA_BYTE2&3)<<8)|pFrame->DATA_BYTE1),ScaleMax,ScaleMin); //10bit
+						temp=GetValueRange(float(((pFrame->DATA_BYTE2&3)<<8)|pFrame->DATA_BYTE1),ScaleMin,ScaleMax); //10bit
 					RBUF tsen;
 					memset(&tsen,0,sizeof(RBUF));
 					tsen.TEMP.packetlength=sizeof(tsen.TEMP)-1;
@@ -1636,13 +1710,10 @@ bool CEnOceanESP2::ParseData()
 				else if (szST=="TempHum")
 				{
 					//(EPP A5-04 01/02)
-					float ScaleMax = 0;
-					float ScaleMin = 0;
-					if (iType == 0x01) { ScaleMax = 0; ScaleMin = 40; }
-					else if (iType == 0x02) { ScaleMax = -20; ScaleMin = 60; }
-					else if (iType == 0x03) { ScaleMax = -20; ScaleMin = 60; } //10bit?
+					float ScaleMin, ScaleMax;
+					Get_Enocean4BSTempScale(Profile,iType,ScaleMin,ScaleMax);
 
-					float temp = GetValueRange(pFrame->DATA_BYTE1, ScaleMax, ScaleMin);
+					float temp = GetValueRange(pFrame->DATA_BYTE1, ScaleMin, ScaleMax);
 					float hum = GetValueRange(pFrame->DATA_BYTE2, 100);
 					RBUF tsen;
 					memset(&tsen,0,sizeof(RBUF));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include "ASyncSerial.h"
 #include "DomoticzHardware.h"
 
@@ -16,6 +17,13 @@ class CEnOceanESP2: public AsyncSerial, public CDomoticzHardwareBase
 		ERS_DATA,
 		ERS_CHECKSUM
 	};
+	struct _tEnOceanSensor
+	{
+		int Manufacturer;
+		int Profile;
+		int Type;
+		const char *szST;	//4BS profile label
+	};
 public:
     /**
     * Opens a serial device.
@@ -42,6 +50,9 @@ private:
 	void Do_Work();
 	bool ParseData();
 	void Add2SendQueue(const char* pData, const size_t length);
+	void LoadSensors();
+	bool GetSensor(const std::string &szDeviceID, _tEnOceanSensor &sensor);
+	bool AddSensor(const std::string &szDeviceID, const int Manufacturer, const int Profile, const int Type);
 	float GetValueRange(const float InValue, const float ScaleMax, const float ScaleMin=0, const float RangeMax=255, const float RangeMin=0);
 
 	_eEnOcean_Receive_State m_receivestate;
@@ -60,6 +71,9 @@ private:
 	boost::mutex m_sendMutex;
 	std::vector<std::string> m_sendqueue;
 
+	//Teached-in sensors (EnoceanSensors table), keyed by DeviceID
+	std::map<std::string, _tEnOceanSensor> m_sensors;
+
 	/**
      * Read callback, stores data in the buffer
      */
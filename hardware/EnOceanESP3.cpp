@@ -31,6 +31,7 @@
 
 extern const char* Get_EnoceanManufacturer(unsigned long ID);
 extern const char* Get_Enocean4BSType(const int Org, const int Func, const int Type);
+extern bool Get_Enocean4BSTempScale(const int Func, const int Type, float &ScaleMin, float &ScaleMax);
 
 // the following lines are taken from EO300I API header file
 
@@ -428,8 +429,10 @@ bool CEnOceanESP3::StartHardware()
 {
 	m_retrycntr=ENOCEAN_RETRY_DELAY*5; //will force reconnect first thing
 
+	LoadSensors();
+
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CEnOceanESP3::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CEnOceanESP3::Do_Work, this)));
 
 	return (m_thread!=NULL);
 }
@@ -881,6 +884,48 @@ float CEnOceanESP3::GetValueRange(const float InValue, const float ScaleMax, con
 	return multiplyer*(InValue-RangeMin)+ScaleMin;
 }
 
+void CEnOceanESP3::LoadSensors()
+{
+	m_sensors.clear();
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT DeviceID, Manufacturer, Profile, [Type] FROM EnoceanSensors WHERE (HardwareID==%d)", m_HwdID);
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		std::vector<std::string> sd = *itt;
+		_tEnOceanSensor sensor;
+		sensor.Manufacturer = atoi(sd[1].c_str());
+		sensor.Profile = atoi(sd[2].c_str());
+		sensor.Type = atoi(sd[3].c_str());
+		sensor.szST = Get_Enocean4BSType(0xA5, sensor.Profile, sensor.Type);
+		m_sensors[sd[0]] = sensor;
+	}
+}
+
+bool CEnOceanESP3::GetSensor(const std::string &szDeviceID, _tEnOceanSensor &sensor)
+{
+	std::map<std::string, _tEnOceanSensor>::const_iterator itt = m_sensors.find(szDeviceID);
+	if (itt == m_sensors.end())
+		return false;
+	sensor = itt->second;
+	return true;
+}
+
+//Returns false if the sensor was already teached-in
+bool CEnOceanESP3::AddSensor(const std::string &szDeviceID, const int Manufacturer, const int Profile, const int Type)
+{
+	if (m_sensors.find(szDeviceID) != m_sensors.end())
+		return false;
+	m_sql.safe_query("INSERT INTO EnoceanSensors (HardwareID, DeviceID, Manufacturer, Profile, [Type]) VALUES (%d,'%q',%d,%d,%d)", m_HwdID, szDeviceID.c_str(), Manufacturer, Profile, Type);
+	_tEnOceanSensor sensor;
+	sensor.Manufacturer = Manufacturer;
+	sensor.Profile = Profile;
+	sensor.Type = Type;
+	sensor.szST = Get_Enocean4BSType(0xA5, Profile, Type);
+	m_sensors[szDeviceID] = sensor;
+	return true;
+}
+
 bool CEnOceanESP3::ParseData()
 {
 #ifdef ENABLE_LOGGING
@@ -1202,13 +1247,9 @@ void CEnOceanESP3::ParseRadioDatagram()
 							profile,ttype,Get_Enocean4BSType(0xA5,profile,ttype));
  					}
 
-					// Search the sensor in database
-					std::vector<std::vector<std::string> > result;
-					result = m_sql.safe_query("SELECT ID FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-					if (result.size()<1)
+					// Search the sensor, if not found add it to the database
+					if (AddSensor(szDeviceID, manufacturer, profile, ttype))
 					{
-						// If not found, add it to the database
-						m_sql.safe_query("INSERT INTO EnoceanSensors (HardwareID, DeviceID, Manufacturer, Profile, [Type]) VALUES (%d,'%q',%d,%d,%d)", m_HwdID, szDeviceID, manufacturer, profile, ttype);
 						_log.Log(LOG_NORM, "EnOcean: Sender_ID 0x%08X inserted in the database", id);
 					}
 					else
@@ -1218,18 +1259,17 @@ void CEnOceanESP3::ParseRadioDatagram()
 				else	// RORG_4BS_TEACHIN_LRN_BIT is 1 -> Data datagram
 				{
 					//Following sensors need to have had a teach-in
-					std::vector<std::vector<std::string> > result;
-					result = m_sql.safe_query("SELECT ID, Manufacturer, Profile, [Type] FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-					if (result.size()<1)
+					_tEnOceanSensor sensor;
+					if (!GetSensor(szDeviceID, sensor))
 					{
 						_log.Log(LOG_NORM, "EnOcean: Need Teach-In for %s", szDeviceID);
 						return;
 					}
-					int Manufacturer=atoi(result[0][1].c_str());
-					int Profile=atoi(result[0][2].c_str());
-					int iType=atoi(result[0][3].c_str());
+					int Manufacturer=sensor.Manufacturer;
+					int Profile=sensor.Profile;
+					int iType=sensor.Type;
 
-					const std::string szST=Get_Enocean4BSType(0xA5,Profile,iType);
+					const std::string szST=sensor.szST;
 
 					if (szST=="AMR.Counter")
 					{
@@ -1406,33 +1446,8 @@ void CEnOceanESP3::ParseRadioDatagram()
 					else if (szST.find("Temperature")==0)
 					{
 						//(EPP A5-02 01/30)
-						float ScaleMax=0;
-						float ScaleMin=0;
-						if (iType==0x01) { ScaleMin=-40; ScaleMax=0; }
-						else if (iType==0x02) { ScaleMin=-30; ScaleMax=10; }
-						else if (iType==0x03) { ScaleMin=-20; ScaleMax=20; }
-						else if (iType==0x04) { ScaleMin=-10; ScaleMax=30; }
-						else if (iType==0x05) { ScaleMin=0; ScaleMax=40; }
-						else if (iType==0x06) { ScaleMin=10; ScaleMax=50; }
-						else if (iType==0x07) { ScaleMin=20; ScaleMax=60; }
-						else if (iType==0x08) { ScaleMin=30; ScaleMax=70; }
-						else if (iType==0x09) { ScaleMin=40; ScaleMax=80; }
-						else if (iType==0x0A) { ScaleMin=50; ScaleMax=90; }
-						else if (iType==0x0B) { ScaleMin=60; ScaleMax=100; }
-						else if (iType==0x10) { ScaleMin=-60; ScaleMax=20; }
-						else if (iType==0x11) { ScaleMin=-50; ScaleMax=30; }
-						else if (iType==0x12) { ScaleMin=-40; ScaleMax=40; }
-						else if (iType==0x13) { ScaleMin=-30; ScaleMax=50; }
-						else if (iType==0x14) { ScaleMin=-20; ScaleMax=60; }
-						else if (iType==0x15) { ScaleMin=-10; ScaleMax=70; }
-						else if (iType==0x16) { ScaleMin=0; ScaleMax=80; }
-						else if (iType==0x17) { ScaleMin=10; ScaleMax=90; }
-						else if (iType==0x18) { ScaleMin=20; ScaleMax=100; }
-						else if (iType==0x19) { ScaleMin=30; ScaleMax=110; }
-						else if (iType==0x1A) { ScaleMin=40; ScaleMax=120; }
-						else if (iType==0x1B) { ScaleMin=50; ScaleMax=130; }
-						else if (iType==0x20) { ScaleMin=-10; ScaleMax=41.2f; }
-						else if (iType==0x30) { ScaleMin=-40; ScaleMax=62.3f; }
+						float ScaleMin, ScaleMax;
+						Get_Enocean4BSTempScale(Profile,iType,ScaleMin,ScaleMax);
 
 						float temp;
 						if (iType<0x20)
@@ -1459,11 +1474,8 @@ void CEnOceanESP3::ParseRadioDatagram()
 					else if (szST.find("TempHum")==0)
 					{
 						//(EPP A5-04 01/02)
-						float ScaleMax = 0;
-						float ScaleMin = 0;
-						if (iType == 0x01) { ScaleMin = 0; ScaleMax = 40; }
-						else if (iType == 0x02) { ScaleMin = -20; ScaleMax = 60; }
-						else if (iType == 0x03) { ScaleMin = -20; ScaleMax = 60; } //10bit?
+						float ScaleMin, ScaleMax;
+						Get_Enocean4BSTempScale(Profile,iType,ScaleMin,ScaleMax);
 
 						float temp = GetValueRange(DATA_BYTE1, ScaleMax, ScaleMin,250,0);
 						float hum = GetValueRange(DATA_BYTE2, 100);
@@ -1653,13 +1665,12 @@ void CEnOceanESP3::ParseRadioDatagram()
 				sprintf(szDeviceID,"%08X",(unsigned int)id);
 
 				// if a button is attached to a module, we should ignore it else its datagram will conflict with status reported by the module using VLD datagram
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT ID, Profile, [Type] FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-				if (result.size() == 1)
+				_tEnOceanSensor sensor;
+				if (GetSensor(szDeviceID, sensor))
 				{
 					// hardware device was already teached-in
-					int Profile=atoi(result[0][1].c_str());
-					int iType=atoi(result[0][2].c_str());
+					int Profile=sensor.Profile;
+					int iType=sensor.Type;
 					if( (Profile == 0x01) &&						// profile 1 (D2-01) is Electronic switches and dimmers with Energy Measurement and Local Control
 						 ((iType == 0x0F) || (iType == 0x12))	// type 0F and 12 have external switch/push button control, it means they also act as rocker
 						)
@@ -1856,13 +1867,10 @@ void CEnOceanESP3::ParseRadioDatagram()
 						// Record EnOcean device profile
 						{
 							char szDeviceID[20];
-							std::vector<std::vector<std::string> > result;
 							sprintf(szDeviceID,"%08X",(unsigned int)id);
-							result = m_sql.safe_query("SELECT ID FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-							if (result.size()<1)
+							// If not found, add it to the database
+							if (AddSensor(szDeviceID, manID, func, type))
 							{
-								// If not found, add it to the database
-								m_sql.safe_query("INSERT INTO EnoceanSensors (HardwareID, DeviceID, Manufacturer, Profile, [Type]) VALUES (%d,'%q',%d,%d,%d)", m_HwdID, szDeviceID, manID, func, type);
 								_log.Log(LOG_NORM, "EnOcean: Sender_ID 0x%08X inserted in the database", id);
 							}
 							else
@@ -1939,11 +1947,10 @@ void CEnOceanESP3::ParseRadioDatagram()
 										
 										// report status only if it is a known device else we may have an incorrect profile
 										char szDeviceID[20];
-										std::vector<std::vector<std::string> > result;
 										sprintf(szDeviceID,"%08X",(unsigned int)id);
 
-										result = m_sql.safe_query("SELECT ID, Manufacturer, Profile, [Type] FROM EnoceanSensors WHERE (HardwareID==%d) AND (DeviceID=='%q')", m_HwdID, szDeviceID);
-										if (result.size()<1)
+										_tEnOceanSensor sensor;
+										if (!GetSensor(szDeviceID, sensor))
 										{
 											_log.Log(LOG_NORM, "EnOcean: Need Teach-In for %s", szDeviceID);
 											return;
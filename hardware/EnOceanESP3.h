@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include "ASyncSerial.h"
 #include "DomoticzHardware.h"
 
@@ -15,6 +16,13 @@ class CEnOceanESP3: public AsyncSerial, public CDomoticzHardwareBase
 		ERS_DATA,
 		ERS_CHECKSUM
 	};
+	struct _tEnOceanSensor
+	{
+		int Manufacturer;
+		int Profile;
+		int Type;
+		const char *szST;	//4BS profile label
+	};
 public:
     /**
     * Opens a serial device.
@@ -41,6 +49,9 @@ private:
 	void Do_Work();
 	bool ParseData();
 	void Add2SendQueue(const char* pData, const size_t length);
+	void LoadSensors();
+	bool GetSensor(const std::string &szDeviceID, _tEnOceanSensor &sensor);
+	bool AddSensor(const std::string &szDeviceID, const int Manufacturer, const int Profile, const int Type);
 	float GetValueRange(const float InValue, const float ScaleMax, const float ScaleMin=0, const float RangeMax=255, const float RangeMin=0);
 
 	bool sendFrame(unsigned char frametype, unsigned char *databuf, unsigned short datalen, unsigned char *optdata, unsigned char optdatalen);
@@ -69,6 +80,9 @@ private:
 	boost::mutex m_sendMutex;
 	std::vector<std::string> m_sendqueue;
 
+	//Teached-in sensors (EnoceanSensors table), keyed by DeviceID
+	std::map<std::string, _tEnOceanSensor> m_sensors;
+
 	/**
      * Read callback, stores data in the buffer
      */
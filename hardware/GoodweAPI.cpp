@@ -23,6 +23,8 @@
 #define GOODWE_BY_STATION_URL "http://www.goodwe-power.com/Mobile/GetMyPowerStationById?stationId="
 #define GOODWE_DEVICE_LIST_URL "http://www.goodwe-power.com/Mobile/GetMyDeviceListById?stationId="
 
+#define GOODWE_CACHE_MAX_AGE 240
+
 // parameter names for GetMyPowerStationByUser
 
 #define BY_USER_STATION_ID "stationId"
@@ -85,7 +87,7 @@ bool GoodweAPI::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&GoodweAPI::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&GoodweAPI::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	return (m_thread!=NULL);
@@ -239,7 +241,7 @@ void GoodweAPI::GetMeterDetails()
 
 	std::string sURL = GOODWE_BY_USER_URL + m_UserName;
 
-	bool bret = HTTPClient::GET(sURL, sResult);
+	bool bret = HTTPClient::GETCached(sURL, sResult, GOODWE_CACHE_MAX_AGE);
 	if (!bret)
 	{
 		_log.Log(LOG_ERROR, "GoodweAPI: Error getting http user data!");
@@ -294,7 +296,7 @@ void GoodweAPI::ParseStation(const std::string sStationId, const std::string sSt
 	std::string sURL = GOODWE_BY_STATION_URL + sStationId;
 	bool bret;
 
-	bret = HTTPClient::GET(sURL, sResult);
+	bret = HTTPClient::GETCached(sURL, sResult, GOODWE_CACHE_MAX_AGE);
 
 	if (!bret)
 	{
@@ -364,7 +366,7 @@ void GoodweAPI::ParseDeviceList(const std::string sStationId, const std::string
 	bool bret;
 	std::string sResult;
 
-	bret = HTTPClient::GET(sURL, sResult);
+	bret = HTTPClient::GETCached(sURL, sResult, GOODWE_CACHE_MAX_AGE);
 	if (!bret)
 	{
 		_log.Log(LOG_ERROR, "GoodweAPI: Error getting http data for device list !");
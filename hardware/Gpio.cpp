@@ -41,14 +41,31 @@ Connection information:
 	gpio edge <pin> both
 
 	Note: If you wire a pull-up, make sure you use 3.3V from P1-01, NOT the 5V pin ! The inputs are 3.3V max !
+
+	When the kernel GPIO character device (/dev/gpiochipN) is available it is used instead of wiringPi.
+	Pins do not have to be exported then, only the pins that have a device are requested, inputs with
+	edge detection (and the debounce time done by the kernel), so no polling is needed.
+	A device is an output once it has been switched from domoticz, or when its pin is configured as
+	output (for example gpio=17=op in config.txt), all other devices are inputs.
+	Devices added later get their line within 10 seconds. The Period setting is not used here, every
+	edge is reported.
+	Pins exported with "gpio export" are used by the kernel sysfs interface and can not be requested,
+	when such pins are found the wiringPi backend is used as before.
 */
 #include "stdafx.h"
 #ifdef WITH_GPIO
 #include "Gpio.h"
 #include "GpioPin.h"
-#ifndef WIN32
+#ifdef WITH_WIRINGPI
 #include <wiringPi.h>
 #endif
+#ifdef WITH_GPIO_CHARDEV
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <dirent.h>
+#endif
 #include "../main/Helper.h"
 #include "../main/Logger.h"
 #include "hardwaretypes.h"
@@ -78,6 +95,19 @@ boost::condition_variable interruptCondition;
 // struct timers for all GPIO pins
 struct timeval tvBegin[MAX_GPIO+1], tvEnd[MAX_GPIO+1], tvDiff[MAX_GPIO+1];
 
+#ifdef WITH_GPIO_CHARDEV
+#define GPIO_CONSUMER "domoticz"
+#define GPIO_MAX_EVENTS 16
+#define GPIO_DELAYED_STARTUP 30 //seconds
+#define GPIO_DEVICE_CHECK_INTERVAL 10 //seconds
+
+// Set by InitPins when a GPIO character device is found
+bool bUseChardev = false;
+std::string gpioChipPath;
+// Lines that were configured as output when the chip was enumerated
+std::set<int> gpioInitialOutputs;
+#endif
+
 /*
  * Direct GPIO implementation, inspired by other hardware implementations such as PiFace and EnOcean
  */
@@ -88,6 +118,9 @@ CGpio::CGpio(const int ID, const int debounce, const int period, const int polli
 	m_debounce=debounce;
 	m_period=period;
 	m_pollinterval = pollinterval;
+#ifdef WITH_GPIO_CHARDEV
+	m_epollfd = -1;
+#endif
 
 	//Prepare a generic packet info for LIGHTING1 packet, so we do not have to do it for every packet
 	IOPinStatusPacket.LIGHTING1.packetlength = sizeof(IOPinStatusPacket.LIGHTING1) -1;
@@ -218,21 +251,27 @@ void interruptHandler31(void) { pushInterrupt(31); }
 
 bool CGpio::StartHardware()
 {
-#ifndef WIN32
+#ifdef WITH_GPIO_CHARDEV
+	if (bUseChardev)
+		return StartChardev();
+#endif
+#ifndef WITH_WIRINGPI
+	_log.Log(LOG_ERROR, "GPIO: No GPIO character device found!");
+	return false;
+#else
 	// TODO make sure the WIRINGPI_CODES environment variable is set, otherwise WiringPi makes the program exit upon error
 	// Note : We're using the wiringPiSetupSys variant as it does not require root privilege
 	if (wiringPiSetupSys() != 0) {
 		_log.Log(LOG_ERROR, "GPIO: Error initializing wiringPi!");
 		return false;
 	}
-#endif
 	m_stoprequested=false;
 
 	//  Start worker thread that will be responsible for interrupt handling
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CGpio::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CGpio::Do_Work, this)));
 
 	m_bIsStarted=true;
-#ifndef WIN32
+
 	//Hook up interrupt call-backs for each input GPIO
 	for(std::vector<CGpioPin>::iterator it = pins.begin(); it != pins.end(); ++it) {
 		if (it->GetIsExported() && it->GetIsInput()) {
@@ -288,19 +327,19 @@ bool CGpio::StartHardware()
 		sleep_milliseconds(250);
 
 		//  Start thread to do a delayed setup of initial state
-		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CGpio::DelayedStartup, this)));
+		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CGpio::DelayedStartup, this)));
 	}
 
 	if (m_pollinterval > 0)
 	{
-		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CGpio::Poller, this)));
+		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CGpio::Poller, this)));
 	}
 
 	_log.Log(LOG_NORM, "GPIO: WiringPi is now initialized");
-#endif
 	sOnConnected(this);
 
 	return (m_thread != NULL);
+#endif
 }
 
 
@@ -311,6 +350,9 @@ bool CGpio::StopHardware()
 		interruptCondition.notify_one();
 		m_thread->join();
 	}
+#ifdef WITH_GPIO_CHARDEV
+	ReleaseLines();
+#endif
 
 	m_bIsStarted=false;
 
@@ -320,7 +362,7 @@ bool CGpio::StopHardware()
 
 bool CGpio::WriteToHardware(const char *pdata, const unsigned char length)
 {
-#ifndef WIN32
+#if defined(WITH_WIRINGPI) || defined(WITH_GPIO_CHARDEV)
 	const tRBUF *pCmd = reinterpret_cast<const tRBUF*>(pdata);
 
 	if ((pCmd->LIGHTING1.packettype == pTypeLighting1) && (pCmd->LIGHTING1.subtype == sTypeIMPULS)) {
@@ -329,11 +371,15 @@ bool CGpio::WriteToHardware(const char *pdata, const unsigned char length)
 			int gpioId = pCmd->LIGHTING1.unitcode;
 			_log.Log(LOG_NORM,"GPIO: WriteToHardware housecode %d, packetlength %d", pCmd->LIGHTING1.housecode, pCmd->LIGHTING1.packetlength);
 
-			int oldValue = digitalRead(gpioId);
+			int oldValue = ReadPin(gpioId);
 			_log.Log(LOG_NORM,"GPIO: pin #%d state was %d", gpioId, oldValue);
 
 			int newValue = static_cast<int>(pCmd->LIGHTING1.cmnd);
-			digitalWrite(gpioId, newValue);
+			if (!WritePin(gpioId, newValue))
+			{
+				_log.Log(LOG_ERROR, "GPIO: Could not set GPIO %d", gpioId);
+				return false;
+			}
 
 			_log.Log(LOG_NORM,"GPIO: WriteToHardware housecode %d, GPIO %d, previously %d, set %d", static_cast<int>(housecode), static_cast<int>(gpioId), oldValue, newValue);
 		}
@@ -354,7 +400,7 @@ bool CGpio::WriteToHardware(const char *pdata, const unsigned char length)
 
 
 void CGpio::ProcessInterrupt(int gpioId) {
-#ifndef WIN32
+#ifdef WITH_WIRINGPI
 	std::vector<std::vector<std::string> > result;
 
 	result = m_sql.safe_query("SELECT Name,nValue,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (Unit==%d)", m_HwdID, gpioId);
@@ -368,31 +414,116 @@ void CGpio::ProcessInterrupt(int gpioId) {
 
 		// Read GPIO data
 		int value = digitalRead(gpioId);
+		SendPinState(gpioId, value != 0);
 
-		if (value != 0) {
-			IOPinStatusPacket.LIGHTING1.cmnd = light1_sOn;
-		}
-		else {
-			IOPinStatusPacket.LIGHTING1.cmnd = light1_sOff;
-		}
+		_log.Log(LOG_NORM, "GPIO: Done processing interrupt for GPIO %d (%s).", gpioId, (value != 0) ? "HIGH" : "LOW");
+	}
+#endif
+}
 
-		unsigned char seqnr = IOPinStatusPacket.LIGHTING1.seqnbr;
-		seqnr++;
-		IOPinStatusPacket.LIGHTING1.seqnbr = seqnr;
-		IOPinStatusPacket.LIGHTING1.unitcode = gpioId;
+void CGpio::SendPinState(int gpioId, bool bOn)
+{
+	IOPinStatusPacket.LIGHTING1.cmnd = (bOn) ? light1_sOn : light1_sOff;
 
-		sDecodeRXMessage(this, (const unsigned char *)&IOPinStatusPacket, NULL, 255);
+	unsigned char seqnr = IOPinStatusPacket.LIGHTING1.seqnbr;
+	seqnr++;
+	IOPinStatusPacket.LIGHTING1.seqnbr = seqnr;
+	IOPinStatusPacket.LIGHTING1.unitcode = gpioId;
 
-		_log.Log(LOG_NORM, "GPIO: Done processing interrupt for GPIO %d (%s).", gpioId, (value != 0) ? "HIGH" : "LOW");
+	sDecodeRXMessage(this, (const unsigned char *)&IOPinStatusPacket, NULL, 255);
+}
+
+int CGpio::ReadPin(int gpioId)
+{
+#ifdef WITH_GPIO_CHARDEV
+	if (bUseChardev)
+	{
+		boost::mutex::scoped_lock lock(m_linesMutex);
+		std::map<int, int>::const_iterator itt = m_lines.find(gpioId);
+		if (itt == m_lines.end())
+			return -1;
+		struct gpio_v2_line_values values;
+		memset(&values, 0, sizeof(values));
+		values.mask = 1;
+		if (ioctl(itt->second, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0)
+			return -1;
+		return (values.bits & 1) ? 1 : 0;
+	}
+#endif
+#ifdef WITH_WIRINGPI
+	return digitalRead(gpioId);
+#else
+	return -1;
+#endif
+}
+
+bool CGpio::WritePin(int gpioId, int value)
+{
+#ifdef WITH_GPIO_CHARDEV
+	if (bUseChardev)
+	{
+		CGpioPin *pPin = GetPPinById(gpioId);
+		if ((pPin == NULL) || (!pPin->GetIsExported()) || (!pPin->GetIsOutput()))
+			return false;
+		boost::mutex::scoped_lock lock(m_linesMutex);
+		std::map<int, int>::iterator itt = m_lines.find(gpioId);
+		if (itt == m_lines.end())
+		{
+			// a device that was added after the start
+			int fd = RequestLine(gpioId, GPIO_V2_LINE_FLAG_OUTPUT, value);
+			if (fd < 0)
+				return false;
+			m_lines[gpioId] = fd;
+			m_outputLines.insert(gpioId);
+			lock.unlock();
+			SetDeviceOutput(gpioId);
+			return true;
+		}
+		if (m_outputLines.find(gpioId) == m_outputLines.end())
+		{
+			// first switch of a device that was started as input, the line stays requested
+			epoll_ctl(m_epollfd, EPOLL_CTL_DEL, itt->second, NULL);
+			if (!SetLineOutput(gpioId, itt->second, value))
+				return false;
+			m_outputLines.insert(gpioId);
+			lock.unlock();
+			SetDeviceOutput(gpioId);
+			return true;
+		}
+		struct gpio_v2_line_values values;
+		memset(&values, 0, sizeof(values));
+		values.mask = 1;
+		values.bits = (value != 0) ? 1 : 0;
+		if (ioctl(itt->second, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0)
+		{
+			_log.Log(LOG_ERROR, "GPIO: Could not set GPIO %d (%s)", gpioId, strerror(errno));
+			return false;
+		}
+		return true;
 	}
 #endif
+#ifdef WITH_WIRINGPI
+	digitalWrite(gpioId, value);
+	return true;
+#else
+	return false;
+#endif
 }
 
 void CGpio::Do_Work()
 {
+#ifdef WITH_GPIO_CHARDEV
+	if (bUseChardev)
+	{
+		Do_WorkChardev();
+		return;
+	}
+#endif
+#ifdef WITH_WIRINGPI
 	int interruptNumber = NO_INTERRUPT;
 	boost::posix_time::milliseconds duration(12000);
 	std::vector<int> triggers;
+#endif
 
 	_log.Log(LOG_NORM,"GPIO: Worker started, Debounce:%dms Period:%dms Poll-interval:%dsec", m_debounce, m_period, m_pollinterval);
 
@@ -401,7 +532,7 @@ void CGpio::Do_Work()
 		/* housekeeping */
 		mytime(&m_LastHeartbeat);
 
-#ifndef WIN32
+#ifdef WITH_WIRINGPI
 		
 		/* Interrupt handling */
 		boost::mutex::scoped_lock lock(interruptQueueMutex);	
@@ -465,6 +596,26 @@ void CGpio::Poller()
  *
  */
 bool CGpio::InitPins()
+{
+#ifdef WITH_GPIO_CHARDEV
+	if (InitPinsChardev())
+	{
+		bUseChardev = true;
+		return true;
+	}
+	pins.clear();
+	gpioInitialOutputs.clear();
+#endif
+#ifdef WITH_WIRINGPI
+	return InitPinsWiringPi();
+#else
+	_log.Log(LOG_ERROR, "GPIO: No GPIO character device found!");
+	return false;
+#endif
+}
+
+#ifdef WITH_WIRINGPI
+bool CGpio::InitPinsWiringPi()
 {
 	char buf[256];
 	bool exports[MAX_GPIO+1] = { false };
@@ -628,6 +779,7 @@ bool CGpio::InitPins()
 	}
 	return true;
 }
+#endif
 
 /* static */
 std::vector<CGpioPin> CGpio::GetPinList()
@@ -664,6 +816,23 @@ void CGpio::DelayedStartup()
 
 void CGpio::UpdateDeviceStates(bool forceUpdate)
 {
+#ifdef WITH_GPIO_CHARDEV
+	if (bUseChardev)
+	{
+		std::vector<int> gpioIds;
+		{
+			boost::mutex::scoped_lock lock(m_linesMutex);
+			std::map<int, int>::const_iterator itt;
+			for (itt = m_lines.begin(); itt != m_lines.end(); ++itt)
+				gpioIds.push_back(itt->first);
+		}
+		std::vector<int>::const_iterator ittId;
+		for (ittId = gpioIds.begin(); ittId != gpioIds.end(); ++ittId)
+			UpdateState(*ittId, forceUpdate);
+		return;
+	}
+#endif
+#ifdef WITH_WIRINGPI
     char buf[256];
     int gpioId;
     FILE *cmd = NULL;
@@ -704,12 +873,16 @@ void CGpio::UpdateDeviceStates(bool forceUpdate)
 			}
         }
     }
+    pclose(cmd);
+#endif
 }
 
 void CGpio::UpdateState(int gpioId, bool forceUpdate)
 {
 	bool updateDatabase = false;
-	int state = digitalRead(gpioId);
+	int state = ReadPin(gpioId);
+	if (state < 0)
+		return;
 	std::vector<std::vector<std::string> > result;
 
 	result = m_sql.safe_query("SELECT Name,nValue,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (Unit==%d)", m_HwdID, gpioId);
@@ -731,25 +904,332 @@ void CGpio::UpdateState(int gpioId, bool forceUpdate)
 
 	if (updateDatabase)
 	{
-		if (state != 0)
+		SendPinState(gpioId, state != 0);
+	}
+
+	//  _log.Log(LOG_NORM, "GPIO:%d initial state %s", gpioId, (value != 0) ? "OPEN" : "CLOSED");
+}
+
+
+#ifdef WITH_GPIO_CHARDEV
+/*
+ * GPIO character device backend
+ *********************************************************************************
+ */
+
+/* static */
+bool CGpio::InitPinsChardev()
+{
+	// The lowest numbered chip is the SoC GPIO controller on the Raspberry Pi and most other boards
+	std::vector<int> chips;
+	DIR *dir = opendir("/dev");
+	if (dir == NULL)
+		return false;
+	struct dirent *de;
+	while ((de = readdir(dir)) != NULL)
+	{
+		int chip;
+		if (sscanf(de->d_name, "gpiochip%d", &chip) == 1)
+			chips.push_back(chip);
+	}
+	closedir(dir);
+	std::sort(chips.begin(), chips.end());
+
+	std::vector<int>::const_iterator itt;
+	for (itt = chips.begin(); itt != chips.end(); ++itt)
+	{
+		char szPath[50];
+		sprintf(szPath, "/dev/gpiochip%d", *itt);
+		int fd = open(szPath, O_RDWR | O_CLOEXEC);
+		if (fd < 0)
 		{
-			IOPinStatusPacket.LIGHTING1.cmnd = light1_sOn;
+			_log.Log(LOG_ERROR, "GPIO: Could not open %s (%s)", szPath, strerror(errno));
+			continue;
+		}
+		struct gpiochip_info chipinfo;
+		memset(&chipinfo, 0, sizeof(chipinfo));
+		if ((ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &chipinfo) < 0) || (chipinfo.lines == 0))
+		{
+			close(fd);
+			continue;
+		}
+
+		int nLines = (chipinfo.lines > MAX_GPIO + 1) ? MAX_GPIO + 1 : chipinfo.lines;
+		int nSysfsLines = 0;
+		for (int offset = 0; offset < nLines; offset++)
+		{
+			struct gpio_v2_line_info info;
+			memset(&info, 0, sizeof(info));
+			info.offset = offset;
+			if (ioctl(fd, GPIO_V2_GET_LINEINFO_IOCTL, &info) < 0)
+				continue;
+			std::stringstream sLabel;
+			sLabel << "gpio" << offset;
+			if (info.name[0] != 0)
+				sLabel << " (" << info.name << ")";
+			// Lines in use by a kernel driver or another program can not be requested
+			bool bUsed = ((info.flags & GPIO_V2_LINE_FLAG_USED) != 0);
+			bool bOutput = ((info.flags & GPIO_V2_LINE_FLAG_OUTPUT) != 0);
+			if ((bUsed) && (info.consumer[0] != 0))
+				sLabel << " used by " << info.consumer;
+			if ((bUsed) && (strcmp(info.consumer, "sysfs") == 0))
+				nSysfsLines++;
+			if (bUsed)
+			{
+				pins.push_back(CGpioPin(offset, sLabel.str(), !bOutput, bOutput, false));
+				continue;
+			}
+			// A free line can be used in both directions, the device decides
+			if (bOutput)
+				gpioInitialOutputs.insert(offset);
+			pins.push_back(CGpioPin(offset, sLabel.str(), true, true, true));
+		}
+		close(fd);
+
+		if (nSysfsLines > 0)
+		{
+#ifdef WITH_WIRINGPI
+			// Set up with "gpio export", keep using that
+			_log.Log(LOG_STATUS, "GPIO: %d pins of %s are exported with sysfs, using wiringPi", nSysfsLines, szPath);
+			return false;
+#else
+			_log.Log(LOG_ERROR, "GPIO: %d pins of %s are exported with sysfs, unexport them (gpio unexport <pin>) to use them", nSysfsLines, szPath);
+#endif
+		}
+
+		gpioChipPath = szPath;
+		_log.Log(LOG_STATUS, "GPIO: Using %s (%s, %d lines)", szPath, chipinfo.label, chipinfo.lines);
+		return (!pins.empty());
+	}
+	return false;
+}
+
+int CGpio::RequestLine(const int gpioId, const uint64_t flags, const int value)
+{
+	int chipfd = open(gpioChipPath.c_str(), O_RDWR | O_CLOEXEC);
+	if (chipfd < 0)
+		return -1;
+
+	struct gpio_v2_line_request req;
+	memset(&req, 0, sizeof(req));
+	req.offsets[0] = gpioId;
+	req.num_lines = 1;
+	strncpy(req.consumer, GPIO_CONSUMER, sizeof(req.consumer) - 1);
+	req.config.flags = flags;
+	if (flags & GPIO_V2_LINE_FLAG_OUTPUT)
+	{
+		req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		req.config.attrs[0].attr.values = (value != 0) ? 1 : 0;
+		req.config.attrs[0].mask = 1;
+		req.config.num_attrs = 1;
+	}
+	else if ((flags & GPIO_V2_LINE_FLAG_EDGE_RISING) && (m_debounce > 0))
+	{
+		// Done in hardware when the controller supports it, otherwise the kernel debounces in software
+		req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+		req.config.attrs[0].attr.debounce_period_us = m_debounce * 1000;
+		req.config.attrs[0].mask = 1;
+		req.config.num_attrs = 1;
+	}
+	int ret = ioctl(chipfd, GPIO_V2_GET_LINE_IOCTL, &req);
+	if ((ret < 0) && (req.config.num_attrs != 0) && (!(flags & GPIO_V2_LINE_FLAG_OUTPUT)))
+	{
+		_log.Log(LOG_STATUS, "GPIO: Debounce not supported for GPIO %d (%s), continuing without", gpioId, strerror(errno));
+		req.config.num_attrs = 0;
+		ret = ioctl(chipfd, GPIO_V2_GET_LINE_IOCTL, &req);
+	}
+	if (ret < 0)
+		_log.Log(LOG_ERROR, "GPIO: Could not request GPIO %d (%s)", gpioId, strerror(errno));
+	close(chipfd);
+	return (ret < 0) ? -1 : req.fd;
+}
+
+// Changes the direction of a requested input line to output, without releasing it
+bool CGpio::SetLineOutput(const int gpioId, const int fd, const int value)
+{
+	struct gpio_v2_line_config config;
+	memset(&config, 0, sizeof(config));
+	config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+	config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+	config.attrs[0].attr.values = (value != 0) ? 1 : 0;
+	config.attrs[0].mask = 1;
+	config.num_attrs = 1;
+	if (ioctl(fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0)
+	{
+		_log.Log(LOG_ERROR, "GPIO: Could not configure GPIO %d as output (%s)", gpioId, strerror(errno));
+		return false;
+	}
+	_log.Log(LOG_STATUS, "GPIO: GPIO %d is now an output", gpioId);
+	return true;
+}
+
+// Remember that the device of the pin is an output, so it is requested as output on the next start
+void CGpio::SetDeviceOutput(const int gpioId)
+{
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT ID FROM DeviceStatus WHERE (HardwareID==%d) AND (Unit==%d)", m_HwdID, gpioId);
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		std::map<std::string, std::string> options = m_sql.GetDeviceOptions((*itt)[0]);
+		if (options["GpioOutput"] == "true")
+			continue;
+		options["GpioOutput"] = "true";
+		m_sql.SetDeviceOptions(strtoull((*itt)[0].c_str(), NULL, 10), options);
+	}
+}
+
+bool CGpio::StartChardev()
+{
+	ReleaseLines();
+	m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+	if (m_epollfd < 0)
+	{
+		_log.Log(LOG_ERROR, "GPIO: Could not create epoll instance (%s)", strerror(errno));
+		return false;
+	}
+
+	RequestDeviceLines(true);
+
+	//  Read all requested GPIO ports and set the device status accordingly.
+	UpdateDeviceStates(false);
+
+	m_stoprequested = false;
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CGpio::Do_Work, this)));
+	m_bIsStarted = true;
+	_log.Log(LOG_NORM, "GPIO: %d pins requested from %s", (int)m_lines.size(), gpioChipPath.c_str());
+	sOnConnected(this);
+	return (m_thread != NULL);
+}
+
+// Requests the lines of the devices that do not have one yet, returns the number of new lines
+int CGpio::RequestDeviceLines(const bool bLogErrors)
+{
+	// Only request the pins that have a device, the other lines stay available for other programs
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT ID, Unit, nValue FROM DeviceStatus WHERE (HardwareID==%d)", m_HwdID);
+	int nNewLines = 0;
+	boost::mutex::scoped_lock lock(m_linesMutex);
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		int gpioId = atoi((*itt)[1].c_str());
+		if (m_lines.find(gpioId) != m_lines.end())
+			continue;
+		CGpioPin *pPin = GetPPinById(gpioId);
+		if ((pPin == NULL) || (!pPin->GetIsExported()))
+		{
+			if (bLogErrors)
+				_log.Log(LOG_ERROR, "GPIO: GPIO %d is not available", gpioId);
+			continue;
+		}
+		std::map<std::string, std::string> options = m_sql.GetDeviceOptions((*itt)[0]);
+		if ((options["GpioOutput"] == "true") || (gpioInitialOutputs.find(gpioId) != gpioInitialOutputs.end()))
+		{
+			// Outputs get the last state of their device
+			int fd = RequestLine(gpioId, GPIO_V2_LINE_FLAG_OUTPUT, (atoi((*itt)[2].c_str()) == light1_sOn) ? 1 : 0);
+			if (fd < 0)
+				continue;
+			m_lines[gpioId] = fd;
+			m_outputLines.insert(gpioId);
 		}
 		else
 		{
-			IOPinStatusPacket.LIGHTING1.cmnd = light1_sOff;
+			int fd = RequestLine(gpioId, GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING, 0);
+			if (fd < 0)
+				continue;
+			struct epoll_event ev;
+			memset(&ev, 0, sizeof(ev));
+			ev.events = EPOLLIN;
+			ev.data.fd = fd;
+			epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &ev);
+			m_lines[gpioId] = fd;
 		}
+		nNewLines++;
+	}
+	return nNewLines;
+}
 
-		unsigned char seqnr = IOPinStatusPacket.LIGHTING1.seqnbr;
-		seqnr++;
-		IOPinStatusPacket.LIGHTING1.seqnbr = seqnr;
-		IOPinStatusPacket.LIGHTING1.unitcode = gpioId;
+void CGpio::ReleaseLines()
+{
+	std::map<int, int>::const_iterator itt;
+	for (itt = m_lines.begin(); itt != m_lines.end(); ++itt)
+		close(itt->second);
+	m_lines.clear();
+	m_outputLines.clear();
+	if (m_epollfd >= 0)
+		close(m_epollfd);
+	m_epollfd = -1;
+}
+
+void CGpio::HandleLineEvents(const int fd)
+{
+	struct gpio_v2_line_event events[GPIO_MAX_EVENTS];
+	ssize_t ret = read(fd, events, sizeof(events));
+	if (ret < (ssize_t)sizeof(struct gpio_v2_line_event))
+		return;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 
-		sDecodeRXMessage(this, (const unsigned char *)&IOPinStatusPacket, NULL, 255);
+	// Every edge is reported, a short pulse gives an On and an Off update
+	int nEvents = (int)(ret / sizeof(struct gpio_v2_line_event));
+	for (int ii = 0; ii < nEvents; ii++)
+	{
+		const struct gpio_v2_line_event &event = events[ii];
+		bool bOn = (event.id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+		// event timestamps are CLOCK_MONOTONIC, taken by the kernel in the interrupt handler
+		long latency = (now_ns > event.timestamp_ns) ? (long)((now_ns - event.timestamp_ns) / 1000) : 0;
+		_log.Log(LOG_NORM, "GPIO: GPIO %d %s (event %u, %ld us ago)", event.offset, (bOn) ? "HIGH" : "LOW", event.line_seqno, latency);
+		SendPinState(event.offset, bOn);
 	}
+}
 
-	//  _log.Log(LOG_NORM, "GPIO:%d initial state %s", gpioId, (value != 0) ? "OPEN" : "CLOSED");
+void CGpio::Do_WorkChardev()
+{
+	_log.Log(LOG_NORM, "GPIO: Worker started, using %s, Debounce:%dms", gpioChipPath.c_str(), m_debounce);
+
+	//  Copy the states once more when a master domoticz might connect after our startup
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT ID FROM Users WHERE (RemoteSharing==1) AND (Active==1)");
+	bool bDelayedStartup = (!result.empty());
+	time_t tStart = mytime(NULL);
+	time_t tLastDeviceCheck = tStart;
+
+	struct epoll_event events[GPIO_MAX_EVENTS];
+	while (!m_stoprequested)
+	{
+		mytime(&m_LastHeartbeat);
+		int nfds = epoll_wait(m_epollfd, events, GPIO_MAX_EVENTS, 1000);
+		if (nfds < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			_log.Log(LOG_ERROR, "GPIO: epoll_wait failed (%s)", strerror(errno));
+			sleep_milliseconds(1000);
+			continue;
+		}
+		for (int ii = 0; ii < nfds; ii++)
+			HandleLineEvents(events[ii].data.fd);
+
+		// Devices created after the start (for example from the switch add page) get their line here
+		if (m_LastHeartbeat - tLastDeviceCheck >= GPIO_DEVICE_CHECK_INTERVAL)
+		{
+			tLastDeviceCheck = m_LastHeartbeat;
+			if (RequestDeviceLines(false) > 0)
+				UpdateDeviceStates(false);
+		}
+
+		if ((bDelayedStartup) && (m_LastHeartbeat - tStart >= GPIO_DELAYED_STARTUP))
+		{
+			bDelayedStartup = false;
+			_log.Log(LOG_NORM, "GPIO: Optional connected Master Domoticz now updates its status");
+			UpdateDeviceStates(true);
+		}
+	}
+	_log.Log(LOG_NORM, "GPIO: Worker stopped...");
 }
+#endif // WITH_GPIO_CHARDEV
 
 #endif // WITH_GPIO
 
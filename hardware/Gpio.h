@@ -26,6 +26,7 @@ Source: http://wiringpi.com
 */
 #pragma once
 
+#include <set>
 #include "DomoticzHardware.h"
 #include "GpioPin.h"
 #include "../main/RFXtrx.h"
@@ -51,6 +52,28 @@ private:
 	void UpdateDeviceStates(bool forceUpdate);
 	void ProcessInterrupt(int gpioId);
 	void UpdateState(int gpioId, bool forceUpdate);
+	void SendPinState(int gpioId, bool bOn);
+	int ReadPin(int gpioId);
+	bool WritePin(int gpioId, int value);
+#ifdef WITH_WIRINGPI
+	static bool InitPinsWiringPi();
+#endif
+#ifdef WITH_GPIO_CHARDEV
+	static bool InitPinsChardev();
+	bool StartChardev();
+	int RequestDeviceLines(const bool bLogErrors);
+	void ReleaseLines();
+	int RequestLine(const int gpioId, const uint64_t flags, const int value);
+	bool SetLineOutput(const int gpioId, const int fd, const int value);
+	void SetDeviceOutput(const int gpioId);
+	void Do_WorkChardev();
+	void HandleLineEvents(const int fd);
+
+	std::map<int, int> m_lines;	// GPIO number -> line request fd
+	std::set<int> m_outputLines;	// GPIO numbers of the lines requested as output
+	boost::mutex m_linesMutex;
+	int m_epollfd;
+#endif
 
 	// List of GPIO pin numbers, ordered as listed
 	static std::vector<CGpioPin> pins;
@@ -6,6 +6,7 @@
 #include "../main/localtime_r.h"
 #include "../main/mainworker.h"
 #include "../main/SQLHelper.h"
+#include "../json/json.h"
 #include <wchar.h>
 
 //Note, for Windows we use OpenHardware Monitor
@@ -22,10 +23,22 @@
 	#include <string>
 	#include <limits>
 	#include <sys/time.h>
+	#include <sys/statvfs.h>
 	#include <unistd.h>
+	#include <fcntl.h>
+	#include <dirent.h>
+	#include <limits.h>
+	#include <stdlib.h>
 	#include <vector>
 	#include <map>
 
+#if defined(__FreeBSD__)
+	#define PROC_PATH "/compat/linux/proc/"
+#else
+	#define PROC_PATH "/proc/"
+#endif
+	#define THERMAL_PATH "/sys/class/thermal/"
+
 	struct _tDUsageStruct
 	{
 		std::string MountPoint;
@@ -54,6 +67,7 @@
 #endif
 
 #define POLL_INTERVAL 30
+#define DOMOTICZ_CPU_INDEX 50	//Load sensor index of the domoticz process
 
 extern bool bHasInternalTemperature;
 extern std::string szInternalTemperatureCommand;
@@ -72,6 +86,21 @@ CHardwareMonitor::CHardwareMonitor(const int ID)
 	m_HwdID = ID;
 	m_stoprequested=false;
 	m_bOutputLog = false;
+	m_metrics.MemUsage = 0;
+	m_metrics.CPUUsage = 0;
+	m_metrics.RSS = 0;
+	m_metrics.Threads = 0;
+	m_metrics.FDs = 0;
+	m_metrics.ProcessCPU = 0;
+#if defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	m_lastloadcpu = 0;
+	m_totcpu = 0;
+	m_iTemperatureZone = -1;
+#endif
+#ifdef __linux__
+	m_lastprocesstime = 0;
+	m_lastprocesscpu = 0;
+#endif
 #ifdef WIN32
 	m_pLocator = NULL;
 	m_pServicesOHM = NULL;
@@ -101,10 +130,33 @@ bool CHardwareMonitor::StartHardware()
 
 #ifdef WIN32
 	InitWMI();
+#elif defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	//Read the sysfs files of the configured commands ourselves instead of running cat/awk every poll
+	m_szTemperaturePath = "";
+	m_szVoltagePath = "";
+	m_szCurrentPath = "";
+	if (bHasInternalTemperature)
+	{
+		if (!GetSysfsPath(szInternalTemperatureCommand, m_szTemperaturePath))
+		{
+			//vcgencmd reports the same SoC sensor as the thermal zone
+			if ((szInternalTemperatureCommand.find("vcgencmd") != std::string::npos) && (file_exist(THERMAL_PATH "thermal_zone0/temp")))
+				m_szTemperaturePath = THERMAL_PATH "thermal_zone0/temp";
+		}
+	}
+	m_iTemperatureZone = GetThermalZone(m_szTemperaturePath);
+	if (bHasInternalVoltage)
+		GetSysfsPath(szInternalVoltageCommand, m_szVoltagePath);
+	if (bHasInternalCurrent)
+		GetSysfsPath(szInternalCurrentCommand, m_szCurrentPath);
+#ifdef __linux__
+	m_lastprocesstime = 0;
+	m_lastthreadcpu.clear();
+#endif
 #endif
 	m_stoprequested = false;
 	m_lastquerytime = 0;
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CHardwareMonitor::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CHardwareMonitor::Do_Work, this)));
 	m_bIsStarted = true;
 	sOnConnected(this);
 	return true;
@@ -120,6 +172,8 @@ bool CHardwareMonitor::StopHardware()
 	}
 #ifdef WIN32
 	ExitWMI();
+#elif defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	CloseProcFiles(false);
 #endif
 	m_bIsStarted = false;
 	return true;
@@ -181,6 +235,23 @@ void CHardwareMonitor::SendFanSensor(const int Idx, const int FanSpeed, const st
 
 void CHardwareMonitor::GetInternalTemperature()
 {
+#if defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	if (!m_szTemperaturePath.empty())
+	{
+		double value;
+		if (!ReadSysfsValue(m_szTemperaturePath, value))
+			return;
+		//thermal zones report millidegrees, some older kernels degrees
+		float temperature = static_cast<float>((value < 100) ? value : value / 1000.0);
+		if ((temperature != 0) && (temperature != 85) && (temperature != -127) && (temperature > -273))
+		{
+			SendTempSensor(1, 255, temperature, "Internal Temperature");
+			boost::lock_guard<boost::mutex> l(m_metricsMutex);
+			m_metrics.Temperatures["Internal"] = temperature;
+		}
+		return;
+	}
+#endif
 	std::vector<std::string> ret = ExecuteCommandAndReturn(szInternalTemperatureCommand);
 	if (ret.empty())
 		return;
@@ -206,6 +277,15 @@ void CHardwareMonitor::GetInternalTemperature()
 
 void CHardwareMonitor::GetInternalVoltage()
 {
+#if defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	if (!m_szVoltagePath.empty())
+	{
+		double value;
+		if ((ReadSysfsValue(m_szVoltagePath, value)) && (value != 0))
+			SendVoltageSensor(0, 1, 255, static_cast<float>(value / 1000000.0), "Internal Voltage");
+		return;
+	}
+#endif
 	std::vector<std::string> ret = ExecuteCommandAndReturn(szInternalVoltageCommand);
 	if (ret.empty())
 		return;
@@ -228,6 +308,15 @@ void CHardwareMonitor::GetInternalVoltage()
 
 void CHardwareMonitor::GetInternalCurrent()
 {
+#if defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	if (!m_szCurrentPath.empty())
+	{
+		double value;
+		if ((ReadSysfsValue(m_szCurrentPath, value)) && (value != 0))
+			SendCurrent(1, static_cast<float>(value / 1000000.0), "Internal Current");
+		return;
+	}
+#endif
 	std::vector<std::string> ret = ExecuteCommandAndReturn(szInternalCurrentCommand);
 	if (ret.empty())
 		return;
@@ -274,7 +363,47 @@ void CHardwareMonitor::FetchData()
 	{
 		GetInternalCurrent();
 	}
+#ifdef __linux__
+	GetThermalZones();
+	FetchProcessData();
 #endif
+	CloseProcFiles(true);
+#endif
+}
+
+void CHardwareMonitor::GetMetrics(Json::Value &root)
+{
+	boost::lock_guard<boost::mutex> l(m_metricsMutex);
+	root["MemUsage"] = m_metrics.MemUsage;
+	root["CPUUsage"] = m_metrics.CPUUsage;
+	int ii = 0;
+	std::map<std::string, float>::const_iterator itt;
+	for (itt = m_metrics.DiskUsage.begin(); itt != m_metrics.DiskUsage.end(); ++itt)
+	{
+		root["Disks"][ii]["MountPoint"] = itt->first;
+		root["Disks"][ii]["Usage"] = itt->second;
+		ii++;
+	}
+	ii = 0;
+	for (itt = m_metrics.Temperatures.begin(); itt != m_metrics.Temperatures.end(); ++itt)
+	{
+		root["Temperatures"][ii]["Name"] = itt->first;
+		root["Temperatures"][ii]["Temp"] = itt->second;
+		ii++;
+	}
+	root["Process"]["RSS"] = (Json::Value::Int64)m_metrics.RSS;
+	root["Process"]["Threads"] = m_metrics.Threads;
+	root["Process"]["FDs"] = m_metrics.FDs;
+	root["Process"]["CPU"] = m_metrics.ProcessCPU;
+	ii = 0;
+	std::vector<_tThreadCPU>::const_iterator ittThread;
+	for (ittThread = m_metrics.ThreadCPU.begin(); ittThread != m_metrics.ThreadCPU.end(); ++ittThread)
+	{
+		root["Process"]["ThreadCPU"][ii]["Name"] = ittThread->Name;
+		root["Process"]["ThreadCPU"][ii]["Threads"] = ittThread->Threads;
+		root["Process"]["ThreadCPU"][ii]["CPU"] = ittThread->CPU;
+		ii++;
+	}
 }
 
 void CHardwareMonitor::UpdateSystemSensor(const std::string& qType, const int dindex, const std::string& devName, const std::string& devValue)
@@ -472,6 +601,128 @@ void CHardwareMonitor::RunWMIQuery(const char* qTable, const std::string &qType)
 	}
 }
 #elif defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
+	bool CHardwareMonitor::ReadProcFile(const std::string &szPath, std::string &szContent)
+	{
+		std::map<std::string, _tProcFile>::iterator itt = m_procfiles.find(szPath);
+		if (itt == m_procfiles.end())
+		{
+			_tProcFile pfile;
+			pfile.fd = open(szPath.c_str(), O_RDONLY);
+			if (pfile.fd < 0)
+				return false;
+			fcntl(pfile.fd, F_SETFD, FD_CLOEXEC);
+			itt = m_procfiles.insert(std::make_pair(szPath, pfile)).first;
+		}
+		itt->second.bUsed = true;
+
+		//proc files are generated on read, reading from offset 0 gives fresh values
+		szContent.clear();
+		char szBuffer[4096];
+		off_t offset = 0;
+		while (true)
+		{
+			ssize_t ret = pread(itt->second.fd, szBuffer, sizeof(szBuffer), offset);
+			if (ret < 0)
+			{
+				close(itt->second.fd);
+				m_procfiles.erase(itt);
+				return false;
+			}
+			if (ret == 0)
+				break;
+			szContent.append(szBuffer, ret);
+			offset += ret;
+		}
+		return true;
+	}
+
+	void CHardwareMonitor::CloseProcFiles(const bool bOnlyUnused)
+	{
+		std::map<std::string, _tProcFile>::iterator itt = m_procfiles.begin();
+		while (itt != m_procfiles.end())
+		{
+			if ((!bOnlyUnused) || (!itt->second.bUsed))
+			{
+				close(itt->second.fd);
+				m_procfiles.erase(itt++);
+			}
+			else
+			{
+				itt->second.bUsed = false;
+				++itt;
+			}
+		}
+	}
+
+	bool CHardwareMonitor::ReadSysfsValue(const std::string &szPath, double &value)
+	{
+		std::string szContent;
+		if ((!ReadProcFile(szPath, szContent)) || (szContent.empty()))
+			return false;
+		value = atof(szContent.c_str());
+		return true;
+	}
+
+	//The default sensor commands are "cat /sys/... | awk ...", returns the file that is read
+	bool CHardwareMonitor::GetSysfsPath(const std::string &szCommand, std::string &szPath)
+	{
+		if (szCommand.find("cat /sys/") != 0)
+			return false;
+		size_t pos = szCommand.find(' ', 4);
+		szPath = szCommand.substr(4, (pos == std::string::npos) ? std::string::npos : pos - 4);
+		return file_exist(szPath.c_str());
+	}
+
+	//Returns the thermal zone of a temperature file, or -1. The same zone can be reached through
+	//different paths (/sys/class/thermal/thermal_zone0 links to /sys/devices/virtual/thermal/thermal_zone0)
+	int CHardwareMonitor::GetThermalZone(const std::string &szPath)
+	{
+		char szRealPath[PATH_MAX];
+		if ((szPath.empty()) || (realpath(szPath.c_str(), szRealPath) == NULL))
+			return -1;
+		char szZonePath[100];
+		char szZoneRealPath[PATH_MAX];
+		for (int zone = 0; ; zone++)
+		{
+			sprintf(szZonePath, THERMAL_PATH "thermal_zone%d/temp", zone);
+			if (realpath(szZonePath, szZoneRealPath) == NULL)
+				return -1;
+			if (strcmp(szRealPath, szZoneRealPath) == 0)
+				return zone;
+		}
+	}
+
+	void CHardwareMonitor::GetThermalZones()
+	{
+		char szPath[100];
+		for (int zone = 0; ; zone++)
+		{
+			sprintf(szPath, THERMAL_PATH "thermal_zone%d/temp", zone);
+			if (zone == m_iTemperatureZone)
+				continue; //already reported as Internal Temperature
+			double value;
+			if (!ReadSysfsValue(szPath, value))
+				break;
+			sprintf(szPath, THERMAL_PATH "thermal_zone%d/type", zone);
+			std::string szType;
+			ReadProcFile(szPath, szType);
+			stdstring_trim(szType);
+			if (szType.empty())
+			{
+				sprintf(szPath, "Zone %d", zone);
+				szType = szPath;
+			}
+			float temperature = static_cast<float>(value / 1000.0);
+			if ((temperature <= -273) || (temperature == 0))
+				continue;
+			char szTmp[30];
+			sprintf(szTmp, "%.2f", temperature);
+			UpdateSystemSensor("Temperature", zone, szType + " Temperature", szTmp);
+			boost::lock_guard<boost::mutex> l(m_metricsMutex);
+			m_metrics.Temperatures[szType] = temperature;
+		}
+	}
+
 	double time_so_far()
 	{
 		struct timeval tp;
@@ -481,36 +732,32 @@ void CHardwareMonitor::RunWMIQuery(const char* qTable, const std::string &qType)
 			(((double) tp.tv_usec) * 0.000001 );
 	}
 
-	float GetMemUsageLinux()
+	float GetMemUsageLinux(const std::string &szMemInfo)
 	{
-#if defined(__FreeBSD__)
-		std::ifstream mfile("/compat/linux/proc/meminfo");
-#else	// Linux
-		std::ifstream mfile("/proc/meminfo");
-#endif
-		if (!mfile.is_open())
-			return -1;
-		unsigned long MemTotal = -1;
-		unsigned long MemFree = -1;
-		unsigned long MemBuffers = -1;
-		unsigned long  MemCached = -1;
-		std::string token;
-		while (mfile >> token) {
-			if (token == "MemTotal:") {
-				mfile >> MemTotal;
-			}
-			else if (token == "MemFree:") {
-				mfile >> MemFree;
-			}
-			else if (token == "Buffers:") {
-				mfile >> MemBuffers;
-			}
-			else if (token == "Cached:") {
-				mfile >> MemCached;
-			}
-			// ignore rest of the line
-			mfile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		unsigned long MemTotal = 0;
+		unsigned long MemFree = 0;
+		unsigned long MemBuffers = 0;
+		unsigned long MemCached = 0;
+		std::vector<std::string> lines;
+		StringSplit(szMemInfo, "\n", lines);
+		std::vector<std::string>::const_iterator itt;
+		for (itt = lines.begin(); itt != lines.end(); ++itt)
+		{
+			char token[50];
+			unsigned long value;
+			if (sscanf((*itt).c_str(), "%49s %lu", token, &value) != 2)
+				continue;
+			if (strcmp(token, "MemTotal:") == 0)
+				MemTotal = value;
+			else if (strcmp(token, "MemFree:") == 0)
+				MemFree = value;
+			else if (strcmp(token, "Buffers:") == 0)
+				MemBuffers = value;
+			else if (strcmp(token, "Cached:") == 0)
+				MemCached = value;
 		}
+		if (MemTotal == 0)
+			return -1;
 		unsigned long MemUsed = MemTotal - MemFree - MemBuffers - MemCached;
 		float memusedpercentage = (100.0f / float(MemTotal))*MemUsed;
 		return memusedpercentage;
@@ -519,8 +766,11 @@ void CHardwareMonitor::RunWMIQuery(const char* qTable, const std::string &qType)
 	void CHardwareMonitor::FetchUnixData()
 	{
 		char szTmp[300];
+		std::string szContent;
 		//Memory
-		float memusedpercentage = GetMemUsageLinux();
+		float memusedpercentage = -1;
+		if (ReadProcFile(PROC_PATH "meminfo", szContent))
+			memusedpercentage = GetMemUsageLinux(szContent);
 #ifndef __FreeBSD__
 		if (memusedpercentage == -1)
 		{
@@ -535,126 +785,270 @@ void CHardwareMonitor::RunWMIQuery(const char* qTable, const std::string &qType)
 #endif
 		sprintf(szTmp,"%.2f",memusedpercentage);
 		UpdateSystemSensor("Load", 0, "Memory Usage", szTmp);
+		{
+			boost::lock_guard<boost::mutex> l(m_metricsMutex);
+			m_metrics.MemUsage = memusedpercentage;
+		}
 
 		//CPU
-		char cname[50];
-		if (m_lastquerytime==0)
+		if (ReadProcFile(PROC_PATH "stat", szContent))
 		{
-			//first time
-			m_lastquerytime = time_so_far();
-			int actload1,actload2,actload3;
-			int totcpu=-1;
-#if defined(__FreeBSD__)
-			FILE *fIn = fopen("/compat/linux/proc/stat", "r");
-#else	// Linux
-			FILE *fIn = fopen("/proc/stat", "r");
-#endif
-			if (fIn!=NULL)
+			char cname[50];
+			long long actload1, actload2, actload3;
+			double acttime = time_so_far();
+			int ret = sscanf(szContent.c_str(), "%49s %lld %lld %lld", cname, &actload1, &actload2, &actload3);
+			if (m_lastquerytime == 0)
 			{
-				bool bFirstLine=true;
-				while( fgets(szTmp, sizeof(szTmp), fIn) != NULL ) 
+				//first time, count the cpu lines
+				int totcpu = -1;
+				std::vector<std::string> lines;
+				StringSplit(szContent, "\n", lines);
+				std::vector<std::string>::const_iterator itt;
+				for (itt = lines.begin(); itt != lines.end(); ++itt)
 				{
-					int ret=sscanf(szTmp, "%s\t%d\t%d\t%d\n", cname, &actload1, &actload2, &actload3);
-					if ((bFirstLine)&&(ret==4)) {
-						bFirstLine=false;
-						m_lastloadcpu=actload1+actload2+actload3;
-					}
-					char *cPos=strstr(cname,"cpu");
-					if (cPos==NULL)
+					if ((*itt).find("cpu") != 0)
 						break;
 					totcpu++;
 				}
-				fclose(fIn);
+				if ((totcpu >= 1) && (ret == 4))
+				{
+					m_totcpu = totcpu;
+					m_lastloadcpu = actload1 + actload2 + actload3;
+					m_lastquerytime = acttime;
+				}
 			}
-			if (totcpu<1)
-				m_lastquerytime=0;
-			else
-				m_totcpu=totcpu;
-		}
-		else
-		{
-			double acttime = time_so_far();
-			int actload1,actload2,actload3;
-#if defined(__FreeBSD__)
-			FILE *fIn = fopen("/compat/linux/proc/stat", "r");
-#else	// Linux
-			FILE *fIn = fopen("/proc/stat", "r");
-#endif
-			if (fIn!=NULL)
+			else if (ret == 4)
 			{
-				int ret=fscanf(fIn, "%s\t%d\t%d\t%d\n", cname, &actload1, &actload2, &actload3);
-				fclose(fIn);
-				if (ret==4)
+				long long t = (actload1 + actload2 + actload3) - m_lastloadcpu;
+				double cpuper = ((t / (difftime(acttime, m_lastquerytime) * HZ)) * 100) / double(m_totcpu);
+				if (cpuper > 0)
 				{
-					long long t = (actload1+actload2+actload3)-m_lastloadcpu;
-					double cpuper=((t / (difftime(acttime,m_lastquerytime) * HZ)) * 100)/double(m_totcpu);
-					if (cpuper>0)
-					{
-						sprintf(szTmp,"%.2f", cpuper);
-						UpdateSystemSensor("Load", 1, "CPU_Usage", szTmp);
-					}
-					m_lastloadcpu=actload1+actload2+actload3;
+					sprintf(szTmp, "%.2f", cpuper);
+					UpdateSystemSensor("Load", 1, "CPU_Usage", szTmp);
+					boost::lock_guard<boost::mutex> l(m_metricsMutex);
+					m_metrics.CPUUsage = static_cast<float>(cpuper);
 				}
+				m_lastloadcpu = actload1 + actload2 + actload3;
+				m_lastquerytime = acttime;
 			}
-			m_lastquerytime=acttime;
 		}
 
 		//Disk Usage
+		FetchDiskUsage();
+	}
+
+	void CHardwareMonitor::FetchDiskUsage()
+	{
 		std::map<std::string, _tDUsageStruct> _disks;
 		std::map<std::string, std::string> _dmounts_;
+#ifdef __linux__
+		//Mounted block devices from the mount table, sizes with statvfs (what df does, without running it)
+		std::string szContent;
+		if (!ReadProcFile("/proc/self/mounts", szContent))
+			return;
+		std::vector<std::string> _rlines;
+		StringSplit(szContent, "\n", _rlines);
+		std::vector<std::string>::const_iterator ittMount;
+		for (ittMount = _rlines.begin(); ittMount != _rlines.end(); ++ittMount)
+		{
+			char dname[200];
+			char smountpoint[300];
+			if (sscanf((*ittMount).c_str(), "%199s %299s", dname, smountpoint) != 2)
+				continue;
+			if (strstr(dname, "/dev") == NULL)
+				continue;
+			std::map<std::string, std::string>::iterator it = _dmounts_.find(dname);
+			if (it != _dmounts_.end())
+			{
+				if (it->second.length() < strlen(smountpoint))
+				{
+					continue;
+				}
+			}
+			std::string szMountPoint = smountpoint;
+			stdreplace(szMountPoint, "\\040", " ");
+			struct statvfs vfs;
+			if (statvfs(szMountPoint.c_str(), &vfs) != 0)
+				continue;
+			_tDUsageStruct dusage;
+			dusage.TotalBlocks = (long long)vfs.f_blocks;
+			dusage.UsedBlocks = (long long)(vfs.f_blocks - vfs.f_bfree);
+			dusage.AvailBlocks = (long long)vfs.f_bavail;
+			dusage.MountPoint = szMountPoint;
+			_disks[dname] = dusage;
+			_dmounts_[dname] = smountpoint;
+		}
+#else
 		std::vector<std::string> _rlines=ExecuteCommandAndReturn("df");
-		if (!_rlines.empty())
+		if (_rlines.empty())
+			return;
+		std::vector<std::string>::const_iterator ittDF;
+		for (ittDF = _rlines.begin(); ittDF != _rlines.end(); ++ittDF)
 		{
-			std::vector<std::string>::const_iterator ittDF;
-			for (ittDF = _rlines.begin(); ittDF != _rlines.end(); ++ittDF)
+			char dname[200];
+			char suse[30];
+			char smountpoint[300];
+			long numblock, usedblocks, availblocks;
+			int ret = sscanf((*ittDF).c_str(), "%s\t%ld\t%ld\t%ld\t%s\t%s\n", dname, &numblock, &usedblocks, &availblocks, suse, smountpoint);
+			if (ret == 6)
 			{
-				char dname[200];
-				char suse[30];
-				char smountpoint[300];
-				long numblock, usedblocks, availblocks;
-				int ret = sscanf((*ittDF).c_str(), "%s\t%ld\t%ld\t%ld\t%s\t%s\n", dname, &numblock, &usedblocks, &availblocks, suse, smountpoint);
-				if (ret == 6)
+				std::map<std::string, std::string>::iterator it = _dmounts_.find(dname);
+				if (it != _dmounts_.end())
 				{
-					std::map<std::string, std::string>::iterator it = _dmounts_.find(dname);
-					if (it != _dmounts_.end())
+					if (it->second.length() < strlen(smountpoint))
 					{
-						if (it->second.length() < strlen(smountpoint))
-						{
-							continue;
-						}
+						continue;
 					}
-#if defined(__linux__) || defined(__FreeBSD__)
-					if (strstr(dname, "/dev") != NULL)
+				}
+#if defined(__FreeBSD__)
+				if (strstr(dname, "/dev") != NULL)
 #elif defined(__CYGWIN32__)
-					if (strstr(smountpoint, "/cygdrive/") != NULL)
+				if (strstr(smountpoint, "/cygdrive/") != NULL)
 #endif
-					{
-						_tDUsageStruct dusage;
-						dusage.TotalBlocks = numblock;
-						dusage.UsedBlocks = usedblocks;
-						dusage.AvailBlocks = availblocks;
-						dusage.MountPoint = smountpoint;
-						_disks[dname] = dusage;
-						_dmounts_[dname] = smountpoint;
-					}
+				{
+					_tDUsageStruct dusage;
+					dusage.TotalBlocks = numblock;
+					dusage.UsedBlocks = usedblocks;
+					dusage.AvailBlocks = availblocks;
+					dusage.MountPoint = smountpoint;
+					_disks[dname] = dusage;
+					_dmounts_[dname] = smountpoint;
 				}
 			}
-			int dindex = 0;
-			std::map<std::string, _tDUsageStruct>::const_iterator ittDisks;
-			for (ittDisks = _disks.begin(); ittDisks != _disks.end(); ++ittDisks)
+		}
+#endif
+		int dindex = 0;
+		std::map<std::string, float> usage;
+		std::map<std::string, _tDUsageStruct>::const_iterator ittDisks;
+		for (ittDisks = _disks.begin(); ittDisks != _disks.end(); ++ittDisks)
+		{
+			_tDUsageStruct dusage = (*ittDisks).second;
+			if (dusage.TotalBlocks > 0)
+			{
+				double UsagedPercentage = (100 / double(dusage.TotalBlocks))*double(dusage.UsedBlocks);
+				char szTmp[30];
+				sprintf(szTmp, "%.2f", UsagedPercentage);
+				std::string hddname = "HDD " + dusage.MountPoint;
+				UpdateSystemSensor("Load", 2 + dindex, hddname, szTmp);
+				usage[dusage.MountPoint] = static_cast<float>(UsagedPercentage);
+				dindex++;
+			}
+		}
+		boost::lock_guard<boost::mutex> l(m_metricsMutex);
+		m_metrics.DiskUsage = usage;
+	}
+
+#ifdef __linux__
+	//Returns the fields after the command name of a /proc/<pid>/stat line, the name can contain spaces
+	static bool SplitProcStat(const std::string &szStat, std::string &szName, std::vector<std::string> &fields)
+	{
+		size_t pos1 = szStat.find('(');
+		size_t pos2 = szStat.rfind(')');
+		if ((pos1 == std::string::npos) || (pos2 == std::string::npos) || (pos2 < pos1))
+			return false;
+		szName = szStat.substr(pos1 + 1, pos2 - pos1 - 1);
+		fields.clear();
+		std::stringstream sstr(szStat.substr(pos2 + 1));
+		std::string field;
+		while (sstr >> field)
+			fields.push_back(field);
+		//fields[0] is the state (field 3 in proc(5))
+		return (fields.size() >= 22);
+	}
+
+	void CHardwareMonitor::FetchProcessData()
+	{
+		std::string szContent;
+		std::string szName;
+		std::vector<std::string> fields;
+		if ((!ReadProcFile("/proc/self/stat", szContent)) || (!SplitProcStat(szContent, szName, fields)))
+			return;
+		double acttime = time_so_far();
+		long long cputicks = atoll(fields[11].c_str()) + atoll(fields[12].c_str()); //utime + stime
+		int threads = atoi(fields[17].c_str());
+		long rss = atol(fields[21].c_str()) * (sysconf(_SC_PAGESIZE) / 1024);
+
+		int fds = 0;
+		DIR *dir = opendir("/proc/self/fd");
+		if (dir != NULL)
+		{
+			struct dirent *de;
+			while ((de = readdir(dir)) != NULL)
+			{
+				if (de->d_name[0] != '.')
+					fds++;
+			}
+			closedir(dir);
+			fds--; //the one of opendir
+		}
+
+		double elapsed = acttime - m_lastprocesstime;
+		int ncpu = (m_totcpu > 0) ? m_totcpu : 1;
+
+		//Per thread, summed by thread name
+		std::map<std::string, _tThreadCPU> threadcpu;
+		std::map<int, long long> lastthreadcpu;
+		dir = opendir("/proc/self/task");
+		if (dir != NULL)
+		{
+			struct dirent *de;
+			while ((de = readdir(dir)) != NULL)
 			{
-				_tDUsageStruct dusage = (*ittDisks).second;
-				if (dusage.TotalBlocks > 0)
+				if (de->d_name[0] == '.')
+					continue;
+				int tid = atoi(de->d_name);
+				std::string szTaskStat;
+				std::string szThreadName;
+				std::vector<std::string> tfields;
+				if ((!ReadProcFile(std::string("/proc/self/task/") + de->d_name + "/stat", szTaskStat)) || (!SplitProcStat(szTaskStat, szThreadName, tfields)))
+					continue;
+				long long tticks = atoll(tfields[11].c_str()) + atoll(tfields[12].c_str());
+				lastthreadcpu[tid] = tticks;
+				_tThreadCPU &tcpu = threadcpu[szThreadName];
+				if (tcpu.Name.empty())
 				{
-					double UsagedPercentage = (100 / double(dusage.TotalBlocks))*double(dusage.UsedBlocks);
-					//std::cout << "Disk: " << (*ittDisks).first << ", Mount: " << dusage.MountPoint << ", Used: " << UsagedPercentage << std::endl;
-					sprintf(szTmp, "%.2f", UsagedPercentage);
-					std::string hddname = "HDD " + dusage.MountPoint;
-					UpdateSystemSensor("Load", 2 + dindex, hddname, szTmp);
-					dindex++;
+					tcpu.Name = szThreadName;
+					tcpu.Threads = 0;
+					tcpu.CPU = 0;
 				}
+				tcpu.Threads++;
+				std::map<int, long long>::const_iterator ittLast = m_lastthreadcpu.find(tid);
+				if ((m_lastprocesstime != 0) && (ittLast != m_lastthreadcpu.end()) && (elapsed > 0))
+					tcpu.CPU += static_cast<float>((((tticks - ittLast->second) / (elapsed * HZ)) * 100) / double(ncpu));
 			}
+			closedir(dir);
+		}
+		m_lastthreadcpu = lastthreadcpu;
+
+		float processcpu = 0;
+		if ((m_lastprocesstime != 0) && (elapsed > 0))
+			processcpu = static_cast<float>((((cputicks - m_lastprocesscpu) / (elapsed * HZ)) * 100) / double(ncpu));
+		bool bHaveCPU = (m_lastprocesstime != 0);
+		m_lastprocesscpu = cputicks;
+		m_lastprocesstime = acttime;
+
+		{
+			boost::lock_guard<boost::mutex> l(m_metricsMutex);
+			m_metrics.RSS = rss;
+			m_metrics.Threads = threads;
+			m_metrics.FDs = fds;
+			m_metrics.ProcessCPU = processcpu;
+			m_metrics.ThreadCPU.clear();
+			std::map<std::string, _tThreadCPU>::const_iterator itt;
+			for (itt = threadcpu.begin(); itt != threadcpu.end(); ++itt)
+				m_metrics.ThreadCPU.push_back(itt->second);
 		}
+
+		if (bHaveCPU)
+		{
+			char szTmp[30];
+			sprintf(szTmp, "%.2f", processcpu);
+			UpdateSystemSensor("Load", DOMOTICZ_CPU_INDEX, "Domoticz CPU Usage", szTmp);
+		}
+		SendCustomSensor(1, 1, 255, static_cast<float>(rss) / 1024.0f, "Domoticz Memory", "MB");
+		SendCustomSensor(1, 2, 255, static_cast<float>(threads), "Domoticz Threads", "threads");
+		SendCustomSensor(1, 3, 255, static_cast<float>(fds), "Domoticz Open Files", "files");
 	}
+#endif
 #endif //WIN32/#elif defined(__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
 
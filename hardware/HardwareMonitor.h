@@ -7,13 +7,42 @@
 	#pragma comment(lib, "wbemuuid.lib")
 #endif
 
+namespace Json
+{
+	class Value;
+};
+
 class CHardwareMonitor : public CDomoticzHardwareBase
 {
 public:
 	explicit CHardwareMonitor(const int ID);
 	~CHardwareMonitor(void);
 	bool WriteToHardware(const char *pdata, const unsigned char length) { return false; };
+	//Values of the last poll, for the getsystemmetrics command
+	void GetMetrics(Json::Value &root);
 private:
+	struct _tThreadCPU
+	{
+		std::string Name;
+		int Threads;
+		float CPU;	//percentage
+	};
+	struct _tMetrics
+	{
+		float MemUsage;
+		float CPUUsage;
+		std::map<std::string, float> DiskUsage;	//by mount point
+		std::map<std::string, float> Temperatures;
+		//domoticz process
+		long RSS;	//kB
+		int Threads;
+		int FDs;
+		float ProcessCPU;
+		std::vector<_tThreadCPU> ThreadCPU;
+	};
+	_tMetrics m_metrics;
+	boost::mutex m_metricsMutex;
+
 	bool StartHardware();
 	bool StopHardware();
 	double m_lastquerytime;
@@ -37,8 +66,32 @@ private:
 	IWbemServices *m_pServicesSystem;
 #elif defined (__linux__) || defined(__CYGWIN32__) || defined(__FreeBSD__)
 	void FetchUnixData();
+	void FetchDiskUsage();
+	bool ReadProcFile(const std::string &szPath, std::string &szContent);
+	void CloseProcFiles(const bool bOnlyUnused);
+	bool ReadSysfsValue(const std::string &szPath, double &value);
+	bool GetSysfsPath(const std::string &szCommand, std::string &szPath);
+	void GetThermalZones();
+	int GetThermalZone(const std::string &szPath);
 	long long m_lastloadcpu;
 	int m_totcpu;
+	//Files in /proc and /sys are kept open and re-read with pread
+	struct _tProcFile
+	{
+		int fd;
+		bool bUsed;
+	};
+	std::map<std::string, _tProcFile> m_procfiles;
+	std::string m_szTemperaturePath;
+	int m_iTemperatureZone;	//thermal zone of m_szTemperaturePath, -1 when it is not a thermal zone
+	std::string m_szVoltagePath;
+	std::string m_szCurrentPath;
+#ifdef __linux__
+	void FetchProcessData();
+	double m_lastprocesstime;
+	long long m_lastprocesscpu;
+	std::map<int, long long> m_lastthreadcpu;
+#endif
 #endif
 };
 
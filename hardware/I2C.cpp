@@ -135,7 +135,7 @@ bool I2C::StartHardware()
 	}
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&I2C::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&I2C::Do_Work, this)));
 	sOnConnected(this);
 	m_bIsStarted = true;
 	return (m_thread != NULL);
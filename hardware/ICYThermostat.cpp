@@ -24,12 +24,14 @@
 #define SEC_DATA_URL "https://secportal.icy.nl/api/data" //https://secportal.icy.nl/#/user/data" // /api/data
 
 
+#define ICY_POLL_INTERVAL 60
+
 CICYThermostat::CICYThermostat(const int ID, const std::string &Username, const std::string &Password) :
 m_UserName(Username),
 m_Password(Password)
 {
 	m_HwdID=ID;
-	m_stoprequested=false;
+	m_PollID = 0;
 	m_companymode = CMODE_UNKNOWN;
 	Init();
 }
@@ -47,48 +49,23 @@ void CICYThermostat::Init()
 bool CICYThermostat::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CICYThermostat::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "ICYThermostat", boost::bind(&CICYThermostat::GetMeterDetails, this), ICY_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
-	return (m_thread!=NULL);
+	return true;
 }
 
 bool CICYThermostat::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
     m_bIsStarted=false;
     return true;
 }
 
-#define ICY_POLL_INTERVAL 60
-
-void CICYThermostat::Do_Work()
-{
-	int sec_counter = ICY_POLL_INTERVAL-5;
-	_log.Log(LOG_STATUS,"ICYThermostat: Worker started...");
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-
-		if (sec_counter % 12 == 0)
-		{
-			m_LastHeartbeat = mytime(NULL);
-		}
-		if (sec_counter % ICY_POLL_INTERVAL ==0)
-		{
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS,"ICYThermostat: Worker stopped...");
-}
-
 bool CICYThermostat::WriteToHardware(const char *pdata, const unsigned char length)
 {
 	return false;
@@ -210,14 +187,14 @@ bool CICYThermostat::GetSerialAndToken()
 	return true;
 }
 
-void CICYThermostat::GetMeterDetails()
+bool CICYThermostat::GetMeterDetails()
 {
 	if (m_UserName.size()==0)
-		return;
+		return true;
 	if (m_Password.size()==0)
-		return;
+		return true;
 	if (!GetSerialAndToken())
-		return;
+		return false;
 
 	std::string sResult;
 
@@ -237,7 +214,7 @@ void CICYThermostat::GetMeterDetails()
 	if (!HTTPClient::GET(sURL, ExtraHeaders, sResult))
 	{
 		_log.Log(LOG_ERROR,"ICYThermostat: Error getting data!");
-		return;
+		return false;
 	}
 
 	Json::Value root;
@@ -247,20 +224,21 @@ void CICYThermostat::GetMeterDetails()
 	if ((!ret) || (!root.isObject()))
 	{
 		_log.Log(LOG_ERROR, "ICYThermostat: Invalid data received!");
-		return;
+		return false;
 	}
 	if (root["temperature1"].empty() == true)
 	{
 		_log.Log(LOG_ERROR, "ICYThermostat: Invalid data received!");
-		return;
+		return false;
 	}
 	SendSetPointSensor(1, root["temperature1"].asFloat(), "Room Setpoint");
 	if (root["temperature2"].empty() == true)
 	{
 		_log.Log(LOG_ERROR, "ICYThermostat: Invalid data received!");
-		return;
+		return false;
 	}
 	SendTempSensor(1, 255, root["temperature2"].asFloat(), "Room Temperature");
+	return true;
 }
 
 void CICYThermostat::SetSetpoint(const int idx, const float temp)
@@ -25,15 +25,13 @@ private:
 	std::string m_Password;
 	std::string m_SerialNumber;
 	std::string m_Token;
-	volatile bool m_stoprequested;
-	boost::shared_ptr<boost::thread> m_thread;
+	int m_PollID;
 
 	_eICYCompanyMode m_companymode;
 
 	void Init();
 	bool StartHardware();
 	bool StopHardware();
-	void Do_Work();
-	void GetMeterDetails();
+	bool GetMeterDetails();
 };
 
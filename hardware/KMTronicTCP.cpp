@@ -16,7 +16,7 @@ m_Username(CURLEncode::URLEncode(username)),
 m_Password(CURLEncode::URLEncode(password))
 {
 	m_HwdID=ID;
-	m_stoprequested=false;
+	m_PollID = 0;
 	m_usIPPort=usIPPort;
 }
 
@@ -31,47 +31,24 @@ void KMTronicTCP::Init()
 bool KMTronicTCP::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&KMTronicTCP::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "KMTronic", boost::bind(&KMTronicTCP::GetMeterDetails, this), KMTRONIC_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted = true;
 	sOnConnected(this);
 	_log.Log(LOG_STATUS, "KMTronic: Started");
-	return (m_thread != NULL);
+	return true;
 }
 
 bool KMTronicTCP::StopHardware()
 {
-	if (m_thread != NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
 	m_bIsStarted = false;
 	return true;
 }
 
-void KMTronicTCP::Do_Work()
-{
-	int sec_counter = KMTRONIC_POLL_INTERVAL - 2;
-
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat=mytime(NULL);
-		}
-
-		if (sec_counter % KMTRONIC_POLL_INTERVAL == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS, "KMTronic: TCP/IP Worker stopped...");
-} 
-
 bool KMTronicTCP::WriteToHardware(const char *pdata, const unsigned char length)
 {
 	const tRBUF *pSen = reinterpret_cast<const tRBUF*>(pdata);
@@ -124,7 +101,7 @@ bool KMTronicTCP::WriteInt(const unsigned char *data, const size_t len, const bo
 	return true;
 }
 
-void KMTronicTCP::GetMeterDetails()
+bool KMTronicTCP::GetMeterDetails()
 {
 	std::string sResult;
 	std::stringstream szURL;
@@ -143,14 +120,14 @@ void KMTronicTCP::GetMeterDetails()
 	if (!HTTPClient::GET(szURL.str(), sResult))
 	{
 		_log.Log(LOG_ERROR, "KMTronic: Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	std::vector<std::string> results;
 	StringSplit(sResult, "\r\n", results);
 	if (results.size()<8)
 	{
 		_log.Log(LOG_ERROR, "KMTronic: Invalid data received");
-		return;
+		return false;
 	}
 	size_t ii,jj;
 	std::string tmpstr;
@@ -171,8 +148,9 @@ void KMTronicTCP::GetMeterDetails()
 				if (iRelay > m_TotRelais)
 					m_TotRelais = iRelay;
 			}
-			return;
+			return true;
 		}
 	}
 	_log.Log(LOG_ERROR, "KMTronic: Invalid data received");
+	return false;
 }
@@ -24,10 +24,8 @@ protected:
 
 	bool WriteInt(const unsigned char *data, const size_t len, const bool bWaitForReturn);
 	void Init();
-	void GetMeterDetails();
-	void Do_Work();
+	bool GetMeterDetails();
 
-	boost::shared_ptr<boost::thread> m_thread;
-	volatile bool m_stoprequested;
+	int m_PollID;
 };
 
@@ -281,7 +281,7 @@ bool CLimitLess::StartHardware()
 	m_bIsStarted=true;
 	sOnConnected(this);
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CLimitLess::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CLimitLess::Do_Work, this)));
 	_log.Log(LOG_STATUS, "AppLamp: Worker Started...");
 	return (m_thread!=NULL);
 }
@@ -11,6 +11,17 @@
 #include "../main/localtime_r.h"
 #include "../webserver/cWebem.h"
 #include "../httpclient/HTTPClient.h"
+#include "../httpclient/UrlEncode.h"
+
+/*
+When the command line interface of the server (port 9090) can be reached, the player
+states are updated from the events the server pushes ('subscribe'). Only the players
+that reported a change are queried, and the full poll is only done every
+LMS_EVENT_RESYNC_INTERVAL seconds as safety net.
+Without CLI connection the server is polled every poll interval like before.
+*/
+#define LMS_CLI_PORT 9090
+#define LMS_EVENT_RESYNC_INTERVAL 300
 
 CLogitechMediaServer::CLogitechMediaServer(const int ID, const std::string &IPAddress, const int Port, const std::string &User, const std::string &Pwd, const int PollIntervalsec, const int PingTimeoutms) : 
 m_IP(IPAddress),
@@ -23,6 +34,8 @@ m_iThreadsRunning(0)
 	m_Port = Port;
 	m_bShowedStartupMessage = false;
 	m_iMissedQueries = 0;
+	m_bSubscribed = false;
+	m_bRefreshPlayers = false;
 	SetSettings(PollIntervalsec, PingTimeoutms);
 }
 
@@ -34,6 +47,9 @@ CLogitechMediaServer::CLogitechMediaServer(const int ID) : m_stoprequested(false
 	m_User = "";
 	m_Pwd = "";
 	m_bShowedStartupMessage = false;
+	m_iMissedQueries = 0;
+	m_bSubscribed = false;
+	m_bRefreshPlayers = false;
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query("SELECT Address, Port, Username, Password FROM Hardware WHERE ID==%d", m_HwdID);
 
@@ -67,9 +83,12 @@ Json::Value CLogitechMediaServer::Query(std::string sIP, int iPort, std::string
 		sURL << "http://" << sIP << ":" << iPort << "/jsonrpc.js";
 
 	sPostData << sPostdata;
-	
-	HTTPClient::SetTimeout(m_iPingTimeoutms / 1000);
-	bool bRetVal = HTTPClient::POST(sURL.str(), sPostData.str(), ExtraHeaders, sResult);
+
+	//per request timeout, do not change the timeout of the other HTTP users
+	int iTimeout = m_iPingTimeoutms / 1000;
+	if (iTimeout < 1)
+		iTimeout = 1;
+	bool bRetVal = HTTPClient::POST(sURL.str(), sPostData.str(), ExtraHeaders, sResult, true, iTimeout);
 
 	if (!bRetVal)
 	{
@@ -114,12 +133,15 @@ bool CLogitechMediaServer::StartHardware()
 	sOnConnected(this);
 	m_iThreadsRunning = 0;
 	m_bShowedStartupMessage = false;
+	m_bSubscribed = false;
+	m_bRefreshPlayers = false;
+	m_pendingPlayers.clear();
 
 	StartHeartbeatThread();
 
 	//Start worker thread
 	m_stoprequested = false;
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CLogitechMediaServer::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CLogitechMediaServer::Do_Work, this)));
 
 	return (m_thread != NULL);
 }
@@ -128,10 +150,20 @@ bool CLogitechMediaServer::StopHardware()
 {
 	StopHeartbeatThread();
 
+	m_stoprequested = true;
+	if (isConnected())
+	{
+		try {
+			disconnect();
+		}
+		catch (...)
+		{
+			//Don't throw from a Stop command
+		}
+	}
 	try {
 		if (m_thread)
 		{
-			m_stoprequested = true;
 			m_thread->join();
 			m_thread.reset();
 
@@ -324,15 +356,27 @@ void CLogitechMediaServer::Do_Work()
 	ReloadNodes();
 	ReloadPlaylists();
 
+	connect(m_IP, LMS_CLI_PORT);
+
 	while (!m_stoprequested)
 	{
 		sleep_milliseconds(500);
+
+		//handle the pushed events (this is also where a lost CLI connection is reconnected)
+		update();
+		if ((m_bSubscribed) && ((m_bRefreshPlayers) || (!m_pendingPlayers.empty())))
+		{
+			boost::lock_guard<boost::mutex> l(m_mutex);
+			UpdatePendingPlayers();
+		}
+
 		mcounter++;
 		if (mcounter == 2)
 		{
 			mcounter = 0;
 			scounter++;
-			if ((scounter >= m_iPollInterval) || (bFirstTime))
+			int iPollInterval = (m_bSubscribed) ? LMS_EVENT_RESYNC_INTERVAL : m_iPollInterval;
+			if ((scounter >= iPollInterval) || (bFirstTime))
 			{
 				boost::lock_guard<boost::mutex> l(m_mutex);
 
@@ -354,11 +398,121 @@ void CLogitechMediaServer::Do_Work()
 					}
 				}
 			}
+			else if ((m_bSubscribed) && (scounter % 12 == 0))
+			{
+				//the CLI connection is alive, no need to poll the server for the heartbeat
+				SetHeartbeatReceived();
+			}
 		}
 	}
 	_log.Log(LOG_STATUS, "Logitech Media Server: Worker stopped...");
 }
 
+//Query only the players that reported a change over the CLI connection
+void CLogitechMediaServer::UpdatePendingPlayers()
+{
+	if (m_bRefreshPlayers)
+	{
+		//player connected/disconnected/forgotten
+		m_bRefreshPlayers = false;
+		GetPlayerInfo();
+	}
+	std::set<std::string> players;
+	players.swap(m_pendingPlayers);
+
+	std::vector<LogitechMediaServerNode>::const_iterator itt;
+	for (itt = m_nodes.begin(); itt != m_nodes.end(); ++itt)
+	{
+		if (m_stoprequested)
+			return;
+		if (players.find(itt->IP) == players.end())
+			continue;
+		m_iThreadsRunning++;
+		Do_Node_Work(*itt);
+	}
+}
+
+void CLogitechMediaServer::OnConnect()
+{
+	_log.Log(LOG_STATUS, "Logitech Media Server: Connected to CLI on %s:%d, using server events", m_IP.c_str(), LMS_CLI_PORT);
+	m_sCLIBuffer.clear();
+	if ((m_User != "") && (m_Pwd != ""))
+		write("login " + CURLEncode::URLEncode(m_User) + " " + CURLEncode::URLEncode(m_Pwd) + "\n");
+	write("subscribe client,power,play,pause,stop,mode,playlist\n");
+	m_bSubscribed = true;
+	//get the current state of all players once
+	m_bRefreshPlayers = true;
+}
+
+void CLogitechMediaServer::OnDisconnect()
+{
+	if (m_bSubscribed)
+		_log.Log(LOG_STATUS, "Logitech Media Server: CLI connection lost, polling every %d seconds", m_iPollInterval);
+	m_bSubscribed = false;
+}
+
+void CLogitechMediaServer::OnData(const unsigned char *pData, size_t length)
+{
+	m_sCLIBuffer.append((const char*)pData, length);
+	size_t pos;
+	while ((pos = m_sCLIBuffer.find('\n')) != std::string::npos)
+	{
+		std::string sLine = m_sCLIBuffer.substr(0, pos);
+		m_sCLIBuffer.erase(0, pos + 1);
+		if ((!sLine.empty()) && (sLine[sLine.size() - 1] == '\r'))
+			sLine.erase(sLine.size() - 1);
+		if (!sLine.empty())
+			ParseLine(sLine);
+	}
+	//protect against a server that never sends a newline
+	if (m_sCLIBuffer.size() > 65536)
+		m_sCLIBuffer.clear();
+}
+
+void CLogitechMediaServer::OnError(const std::exception e)
+{
+	_log.Log(LOG_ERROR, "Logitech Media Server: CLI Error: %s", e.what());
+}
+
+void CLogitechMediaServer::OnError(const boost::system::error_code& error)
+{
+	m_bSubscribed = false;
+	if (
+		(error == boost::asio::error::address_in_use) ||
+		(error == boost::asio::error::connection_refused) ||
+		(error == boost::asio::error::access_denied) ||
+		(error == boost::asio::error::host_unreachable) ||
+		(error == boost::asio::error::timed_out)
+		)
+	{
+		_log.Log(LOG_STATUS, "Logitech Media Server: Can not connect to CLI on %s:%d, polling every %d seconds", m_IP.c_str(), LMS_CLI_PORT, m_iPollInterval);
+	}
+	else if (
+		(error == boost::asio::error::eof) ||
+		(error == boost::asio::error::connection_reset)
+		)
+	{
+		_log.Log(LOG_STATUS, "Logitech Media Server: CLI connection reset!");
+	}
+	else
+		_log.Log(LOG_ERROR, "Logitech Media Server: CLI %s", error.message().c_str());
+}
+
+//Notifications look like: "<playerid> <command> <parameters>", all fields are URL encoded
+void CLogitechMediaServer::ParseLine(const std::string &sLine)
+{
+	std::vector<std::string> results;
+	StringSplit(sLine, " ", results);
+	if (results.size() < 2)
+		return;
+	std::string sPlayerId = CURLEncode::URLDecode(results[0]);
+	if (sPlayerId.find(':') == std::string::npos)
+		return; //reply to our own login/subscribe
+	if (results[1] == "client")
+		m_bRefreshPlayers = true;
+	m_pendingPlayers.insert(sPlayerId);
+}
+
 void CLogitechMediaServer::GetPlayerInfo()
 {
 	try
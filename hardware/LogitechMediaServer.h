@@ -4,9 +4,11 @@
 
 #include <string>
 #include <vector>
+#include <set>
+#include "ASyncTCP.h"
 #include "../json/json.h"
 
-class CLogitechMediaServer : public CDomoticzHardwareBase
+class CLogitechMediaServer : public CDomoticzHardwareBase, ASyncTCP
 {
 	struct LogitechMediaServerNode
 	{
@@ -56,6 +58,15 @@ private:
 	void ReloadNodes();
 	void ReloadPlaylists();
 	std::string GetPlaylistByRefID(const int ID);
+	void UpdatePendingPlayers();
+
+	//CLI event subscription (port 9090)
+	void OnConnect();
+	void OnDisconnect();
+	void OnData(const unsigned char *pData, size_t length);
+	void OnError(const std::exception e);
+	void OnError(const boost::system::error_code& error);
+	void ParseLine(const std::string &sLine);
 
 	std::vector<LogitechMediaServerNode> m_nodes;
 	std::vector<LMSPlaylistNode> m_playlists;
@@ -70,6 +81,11 @@ private:
 	bool m_bShowedStartupMessage;
 	int m_iMissedQueries;
 
+	bool m_bSubscribed;
+	bool m_bRefreshPlayers;
+	std::string m_sCLIBuffer;
+	std::set<std::string> m_pendingPlayers;
+
 	boost::shared_ptr<boost::thread> m_thread;
 	volatile bool m_stoprequested;
 	boost::mutex m_mutex;
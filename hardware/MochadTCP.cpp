@@ -100,7 +100,7 @@ bool MochadTCP::StartHardware()
 //	m_bIsStarted=true;
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&MochadTCP::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&MochadTCP::Do_Work, this)));
 	return (m_thread!=NULL);
 }
 
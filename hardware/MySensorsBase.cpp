@@ -8,6 +8,13 @@
 #include "../main/WebServer.h"
 #include "../main/mainworker.h"
 #include "hardwaretypes.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#define MYSENSORS_ACK_RETRIES 2
+#define MYSENSORS_VAR_FLUSH_INTERVAL 30
+
+//Node, child and value type id's are all below 256
+#define MYSENSORS_KEY(node, child, type) (((node) << 16) | ((child) << 8) | (type))
 #include <string>
 #include <sstream>
 #include <algorithm>
@@ -240,10 +247,7 @@ MySensorsBase::MySensorsBase(void):
 m_GatewayVersion("?")
 {
 	m_bufferpos = 0;
-	m_bAckReceived = false;
-	m_AckNodeID = -1;
-	m_AckChildID = -1;
-	m_AckSetType = V_UNKNOWN;
+	m_LastVarFlush = 0;
 }
 
 MySensorsBase::~MySensorsBase(void)
@@ -304,6 +308,8 @@ void MySensorsBase::LoadDevicesFromDatabase()
 			m_nodes[ID] = mNode;
 		}
 	}
+	LoadVarsFromDatabase();
+	m_LastVarFlush = mytime(NULL);
 }
 
 void MySensorsBase::Add2Database(const int nodeID, const std::string &SketchName, const std::string &SketchVersion)
@@ -1261,34 +1267,99 @@ std::string MySensorsBase::GetGatewayVersion()
 	return m_GatewayVersion;
 }
 
+//Commands that need an ack do not block the caller,
+//the send thread resends them when no ack is received within AckTimeout
 bool MySensorsBase::SendNodeSetCommand(const int NodeID, const int ChildID, const _eMessageType messageType, const _eSetType SubType, const std::string &Payload, const bool bUseAck, const int AckTimeout)
 {
-	m_bAckReceived = false;
-	m_AckNodeID = NodeID;
-	m_AckChildID = ChildID;
-	m_AckSetType = SubType;
-	int repeat = 0;
-	int repeats = 2;
-
-	//Resend failed command
-	while ((!m_bAckReceived) && (repeat < repeats))
+	if (bUseAck)
 	{
-		SendCommandInt(NodeID, ChildID, messageType, bUseAck, SubType, Payload);
-		if (!bUseAck)
-			return true;
-		//Wait some time till we receive an ACK (should be received in 1000ms, but we wait 1200ms)
-		int waitRetries = AckTimeout/100;
-		if (waitRetries < 1)
-			waitRetries = 1;
-		int actWaits = 0;
-		while ((!m_bAckReceived) && (actWaits < waitRetries))
+		_tMySensorsPendingAck cmd;
+		cmd.NodeID = NodeID;
+		cmd.ChildID = ChildID;
+		cmd.messageType = messageType;
+		cmd.SubType = SubType;
+		cmd.Payload = Payload;
+		cmd.AckTimeout = (AckTimeout < 100) ? 100 : AckTimeout;
+		cmd.Retries = MYSENSORS_ACK_RETRIES - 1;
+		cmd.Deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(cmd.AckTimeout);
+
+		boost::lock_guard<boost::mutex> l(m_ackMutex);
+		//A newer command for the same node/child/type replaces the one still waiting
+		m_pendingAcks[MYSENSORS_KEY(NodeID, ChildID, SubType)] = cmd;
+	}
+	SendCommandInt(NodeID, ChildID, messageType, bUseAck, SubType, Payload);
+	return true;
+}
+
+bool MySensorsBase::HandleAck(const int NodeID, const int ChildID, const _eSetType SubType)
+{
+	{
+		boost::lock_guard<boost::mutex> l(m_ackMutex);
+		std::map<int, _tMySensorsPendingAck>::iterator itt = m_pendingAcks.find(MYSENSORS_KEY(NodeID, ChildID, SubType));
+		if (itt == m_pendingAcks.end())
+			return false;
+		m_pendingAcks.erase(itt);
+	}
+	OnSetCommandCompleted(NodeID, ChildID, SubType, true);
+	return true;
+}
+
+void MySensorsBase::CheckPendingAcks()
+{
+	std::vector<_tMySensorsPendingAck> failed;
+	{
+		boost::lock_guard<boost::mutex> l(m_ackMutex);
+		if (m_pendingAcks.empty())
+			return;
+		boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+		std::map<int, _tMySensorsPendingAck>::iterator itt = m_pendingAcks.begin();
+		while (itt != m_pendingAcks.end())
 		{
-			sleep_milliseconds(100);
-			actWaits++;
+			_tMySensorsPendingAck &cmd = itt->second;
+			if (now < cmd.Deadline)
+			{
+				++itt;
+				continue;
+			}
+			if (cmd.Retries > 0)
+			{
+				//Resend failed command
+				cmd.Retries--;
+				cmd.Deadline = now + boost::posix_time::milliseconds(cmd.AckTimeout);
+				SendCommandInt(cmd.NodeID, cmd.ChildID, cmd.messageType, true, cmd.SubType, cmd.Payload);
+				++itt;
+				continue;
+			}
+			failed.push_back(cmd);
+			m_pendingAcks.erase(itt++);
 		}
-		repeat++;
 	}
-	return m_bAckReceived;
+	std::vector<_tMySensorsPendingAck>::const_iterator itt;
+	for (itt = failed.begin(); itt != failed.end(); ++itt)
+		OnSetCommandCompleted(itt->NodeID, itt->ChildID, itt->SubType, false);
+}
+
+void MySensorsBase::OnSetCommandCompleted(const int NodeID, const int ChildID, const _eSetType SubType, const bool bAckReceived)
+{
+	boost::lock_guard<boost::mutex> l(m_ackMutex);
+	if (bAckReceived)
+	{
+		m_ackFailures.erase(std::make_pair(NodeID, ChildID));
+		return;
+	}
+	//shown in the child list of the node (mysensorsgetchilds)
+	m_ackFailures[std::make_pair(NodeID, ChildID)] = mytime(NULL);
+	_log.Log(LOG_ERROR, "MySensors: No ack received, NodeID: %d, ChildID: %d, SubType: %s", NodeID, ChildID, GetMySensorsValueTypeStr(SubType).c_str());
+}
+
+bool MySensorsBase::GetChildAckFailure(const int nodeID, const int childID, time_t &tFailed)
+{
+	boost::lock_guard<boost::mutex> l(m_ackMutex);
+	std::map<std::pair<int, int>, time_t>::const_iterator itt = m_ackFailures.find(std::make_pair(nodeID, childID));
+	if (itt == m_ackFailures.end())
+		return false;
+	tFailed = itt->second;
+	return true;
 }
 
 void MySensorsBase::SendNodeCommand(const int NodeID, const int ChildID, const _eMessageType messageType, const int SubType, const std::string &Payload)
@@ -1607,32 +1678,82 @@ bool MySensorsBase::WriteToHardware(const char *pdata, const unsigned char lengt
 
 void MySensorsBase::UpdateVar(const int NodeID, const int ChildID, const int VarID, const std::string &svalue)
 {
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT ROWID FROM MySensorsVars WHERE (HardwareID=%d) AND (NodeID=%d) AND (ChildID=%d) AND (VarID=%d)", m_HwdID, NodeID, ChildID, VarID);
-	if (result.size() == 0)
-	{
-		//Insert
-		m_sql.safe_query("INSERT INTO MySensorsVars (HardwareID, NodeID, ChildID, VarID, [Value]) VALUES (%d, %d, %d, %d,'%q')", m_HwdID, NodeID, ChildID, VarID, svalue.c_str());
-	}
-	else
-	{
-		//Update
-		m_sql.safe_query("UPDATE MySensorsVars SET [Value]='%q' WHERE (ROWID = '%q')", svalue.c_str(), result[0][0].c_str());
-	}
-
+	boost::lock_guard<boost::mutex> l(m_varMutex);
+	int key = MYSENSORS_KEY(NodeID, ChildID, VarID);
+	std::map<int, _tMySensorsVar>::const_iterator itt = m_vars.find(key);
+	if ((itt != m_vars.end()) && (itt->second.Value == svalue))
+		return;
+	_tMySensorsVar &mVar = m_vars[key];
+	mVar.NodeID = NodeID;
+	mVar.ChildID = ChildID;
+	mVar.VarID = VarID;
+	mVar.Value = svalue;
+	mVar.bDirty = true;
 }
 
 bool MySensorsBase::GetVar(const int NodeID, const int ChildID, const int VarID, std::string &sValue)
 {
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT [Value] FROM MySensorsVars WHERE (HardwareID=%d) AND (NodeID=%d) AND (ChildID=%d) AND (VarID=%d)", m_HwdID, NodeID, ChildID, VarID);
-	if (result.size() < 1)
+	boost::lock_guard<boost::mutex> l(m_varMutex);
+	std::map<int, _tMySensorsVar>::const_iterator itt = m_vars.find(MYSENSORS_KEY(NodeID, ChildID, VarID));
+	if (itt == m_vars.end())
 		return false;
-	std::vector<std::string> sd = result[0];
-	sValue = sd[0];
+	sValue = itt->second.Value;
 	return true;
 }
 
+void MySensorsBase::LoadVarsFromDatabase()
+{
+	boost::lock_guard<boost::mutex> l(m_varMutex);
+	m_vars.clear();
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT NodeID, ChildID, VarID, [Value] FROM MySensorsVars WHERE (HardwareID=%d)", m_HwdID);
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		std::vector<std::string> sd = *itt;
+		_tMySensorsVar mVar;
+		mVar.NodeID = atoi(sd[0].c_str());
+		mVar.ChildID = atoi(sd[1].c_str());
+		mVar.VarID = atoi(sd[2].c_str());
+		mVar.Value = sd[3];
+		mVar.bDirty = false;
+		m_vars[MYSENSORS_KEY(mVar.NodeID, mVar.ChildID, mVar.VarID)] = mVar;
+	}
+}
+
+void MySensorsBase::FlushVars()
+{
+	std::vector<_tMySensorsVar> dirty;
+	{
+		boost::lock_guard<boost::mutex> l(m_varMutex);
+		std::map<int, _tMySensorsVar>::iterator itt;
+		for (itt = m_vars.begin(); itt != m_vars.end(); ++itt)
+		{
+			if (!itt->second.bDirty)
+				continue;
+			dirty.push_back(itt->second);
+			itt->second.bDirty = false;
+		}
+	}
+	std::vector<_tMySensorsVar>::const_iterator itt;
+	for (itt = dirty.begin(); itt != dirty.end(); ++itt)
+	{
+		std::vector<std::vector<std::string> > result;
+		result = m_sql.safe_query("SELECT ROWID FROM MySensorsVars WHERE (HardwareID=%d) AND (NodeID=%d) AND (ChildID=%d) AND (VarID=%d)", m_HwdID, itt->NodeID, itt->ChildID, itt->VarID);
+		if (result.size() == 0)
+		{
+			//Insert
+			m_sql.safe_query("INSERT INTO MySensorsVars (HardwareID, NodeID, ChildID, VarID, [Value]) VALUES (%d, %d, %d, %d,'%q')", m_HwdID, itt->NodeID, itt->ChildID, itt->VarID, itt->Value.c_str());
+		}
+		else
+		{
+			//Update
+			m_sql.safe_query("UPDATE MySensorsVars SET [Value]='%q' WHERE (ROWID = '%q')", itt->Value.c_str(), result[0][0].c_str());
+		}
+	}
+	m_LastVarFlush = mytime(NULL);
+}
+
 void MySensorsBase::UpdateChildDBInfo(const int NodeID, const int ChildID, const _ePresentationType pType, const std::string &Name)
 {
 	std::vector<std::vector<std::string> > result;
@@ -1692,9 +1813,7 @@ void MySensorsBase::ParseLine()
 		}
 	}
 	std::stringstream sstr;
-#ifdef _DEBUG
-	_log.Log(LOG_NORM, "MySensors: NodeID: %d, ChildID: %d, MessageType: %d, Ack: %d, SubType: %d, Payload: %s",node_id,child_sensor_id,message_type,ack,sub_type,payload.c_str());
-#endif
+	_log.Log(LOGCAT_HARDWARE, LOG_TRACE, "MySensors: NodeID: %d, ChildID: %d, MessageType: %d, Ack: %d, SubType: %d, Payload: %s",node_id,child_sensor_id,message_type,ack,sub_type,payload.c_str());
 
 	if (message_type == MT_Internal)
 	{
@@ -1845,15 +1964,8 @@ void MySensorsBase::ParseLine()
 		}
 		pChild->lastreceived = pNode->lastreceived;
 
-		if (
-			(ack == 1) &&
-			(node_id == m_AckNodeID) &&
-			(child_sensor_id == m_AckChildID) &&
-			(vType == m_AckSetType))
+		if ((ack == 1) && (HandleAck(node_id, child_sensor_id, vType)))
 		{
-			m_AckNodeID = m_AckChildID = -1;
-			m_AckSetType = V_UNKNOWN;
-			m_bAckReceived = true;
 			//No need to process ack commands
 			return;
 		}
@@ -2268,7 +2380,7 @@ void MySensorsBase::ParseLine()
 bool MySensorsBase::StartSendQueue()
 {
 	//Start worker thread
-	m_send_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&MySensorsBase::Do_Send_Work, this)));
+	m_send_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&MySensorsBase::Do_Send_Work, this)));
 	return (m_send_thread != NULL);
 }
 
@@ -2282,6 +2394,9 @@ void MySensorsBase::StopSendQueue()
 		m_sendQueue.push(emptyString);
 		m_send_thread->join();
 	}
+	FlushVars();
+	boost::lock_guard<boost::mutex> l(m_ackMutex);
+	m_pendingAcks.clear();
 }
 
 void MySensorsBase::Do_Send_Work()
@@ -2289,7 +2404,10 @@ void MySensorsBase::Do_Send_Work()
 	while (true)
 	{
 		std::string toSend;
-		bool hasPopped = m_sendQueue.timed_wait_and_pop<boost::posix_time::milliseconds>(toSend, boost::posix_time::milliseconds(2000));
+		bool hasPopped = m_sendQueue.timed_wait_and_pop<boost::posix_time::milliseconds>(toSend, boost::posix_time::milliseconds(100));
+		CheckPendingAcks();
+		if (mytime(NULL) - m_LastVarFlush >= MYSENSORS_VAR_FLUSH_INTERVAL)
+			FlushVars();
 		if (!hasPopped) {
 			continue;
 		}
@@ -2298,9 +2416,7 @@ void MySensorsBase::Do_Send_Work()
 			//Exit thread
 			return;
 		}
-#ifdef _DEBUG
-		_log.Log(LOG_STATUS, "MySensors: going to send: %s", toSend.c_str());
-#endif
+		_log.Log(LOGCAT_HARDWARE, LOG_TRACE, "MySensors: going to send: %s", toSend.c_str());
 		WriteInt(toSend);
 	}
 }
@@ -2461,6 +2577,16 @@ namespace http {
 				}
 				root["result"][ii]["Values"] = szValues;
 				root["result"][ii]["LastReceived"] = szDate;
+				//the last command that needed an ack was not acknowledged
+				time_t tAckFailed;
+				if (pMySensorsHardware->GetChildAckFailure(NodeID, ChildID, tAckFailed))
+				{
+					char szTmp[100];
+					struct tm loctime;
+					localtime_r(&tAckFailed, &loctime);
+					strftime(szTmp, 80, "%Y-%m-%d %X", &loctime);
+					root["result"][ii]["AckFailed"] = szTmp;
+				}
 				ii++;
 			}
 		}
@@ -2,6 +2,7 @@
 
 #include "DomoticzHardware.h"
 #include "../main/concurrent_queue.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 class MySensorsBase : public CDomoticzHardwareBase
 {
@@ -411,6 +412,7 @@ public:
 	static std::string GetMySensorsValueTypeStr(const enum _eSetType vType);
 	static std::string GetMySensorsPresentationTypeStr(const enum _ePresentationType pType);
 	std::string GetGatewayVersion();
+	bool GetChildAckFailure(const int nodeID, const int childID, time_t &tFailed);
 private:
 	virtual void WriteInt(const std::string &sendStr) = 0;
 	void ParseData(const unsigned char *pData, int Len);
@@ -421,6 +423,9 @@ private:
 
 	void SendCommandInt(const int NodeID, const int ChildID, const _eMessageType messageType, const bool UseAck, const int SubType, const std::string &Payload);
 	bool SendNodeSetCommand(const int NodeID, const int ChildID, const _eMessageType messageType, const _eSetType SubType, const std::string &Payload, const bool bUseAck, const int AckTimeout);
+	bool HandleAck(const int NodeID, const int ChildID, const _eSetType SubType);
+	void CheckPendingAcks();
+	void OnSetCommandCompleted(const int NodeID, const int ChildID, const _eSetType SubType, const bool bAckReceived);
 	void SendNodeCommand(const int NodeID, const int ChildID, const _eMessageType messageType, const int SubType, const std::string &Payload);
 
 
@@ -453,6 +458,8 @@ private:
 
 	void UpdateVar(const int NodeID, const int ChildID, const int VarID, const std::string &svalue);
 	bool GetVar(const int NodeID, const int ChildID, const int VarID, std::string &sValue);
+	void LoadVarsFromDatabase();
+	void FlushVars();
 
 	std::map<int, _tMySensorNode> m_nodes;
 
@@ -464,10 +471,35 @@ private:
 
 	std::string m_GatewayVersion;
 
-	bool m_bAckReceived;
-	int m_AckNodeID;
-	int m_AckChildID;
-	_eSetType m_AckSetType;
+	//Set commands waiting for an ack, keyed by node/child/type
+	struct _tMySensorsPendingAck
+	{
+		int NodeID;
+		int ChildID;
+		_eMessageType messageType;
+		_eSetType SubType;
+		std::string Payload;
+		int AckTimeout;
+		int Retries;
+		boost::posix_time::ptime Deadline;
+	};
+	std::map<int, _tMySensorsPendingAck> m_pendingAcks;
+	//Time of the last command per node/child that was not acknowledged, removed by the next ack
+	std::map<std::pair<int, int>, time_t> m_ackFailures;
+	boost::mutex m_ackMutex;
+
+	//MySensorsVars cache, changed values are written to the database by the send thread
+	struct _tMySensorsVar
+	{
+		int NodeID;
+		int ChildID;
+		int VarID;
+		std::string Value;
+		bool bDirty;
+	};
+	std::map<int, _tMySensorsVar> m_vars;
+	boost::mutex m_varMutex;
+	time_t m_LastVarFlush;
 
 	unsigned char m_buffer[1028];
 	int m_bufferpos;
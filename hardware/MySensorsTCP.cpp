@@ -34,7 +34,7 @@ bool MySensorsTCP::StartHardware()
 	m_bIsStarted=true;
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&MySensorsTCP::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&MySensorsTCP::Do_Work, this)));
 	StartSendQueue();
 	return (m_thread!=NULL);
 }
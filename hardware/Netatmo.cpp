@@ -11,6 +11,8 @@
 
 #define round(a) ( int ) ( a + .5 )
 
+#define NETATMO_CACHE_MAX_AGE 540
+
 #ifdef _DEBUG
 	//#define DEBUG_NetatmoWeatherStationR
 #endif
@@ -95,7 +97,7 @@ bool CNetatmo::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CNetatmo::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CNetatmo::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	return (m_thread!=NULL);
@@ -1025,7 +1027,7 @@ void CNetatmo::GetMeterDetails()
 	sResult = ReadFile("E:\\netatmo_getstationdata.json");
 	bool ret = true;
 #else
-	bool ret=HTTPClient::GET(httpUrl, ExtraHeaders, sResult);
+	bool ret=HTTPClient::GETCached(httpUrl, ExtraHeaders, sResult, NETATMO_CACHE_MAX_AGE);
 	if (!ret)
 	{
 		_log.Log(LOG_ERROR, "Netatmo: Error connecting to Server...");
@@ -1061,7 +1063,7 @@ void CNetatmo::GetMeterDetails()
 			m_bFirstTimeWeatherData = false;
 			//Check if the user has an Home Coach device
 			httpUrl = MakeRequestURL(true);
-			bool ret = HTTPClient::GET(httpUrl, ExtraHeaders, sResult);
+			bool ret = HTTPClient::GETCached(httpUrl, ExtraHeaders, sResult, NETATMO_CACHE_MAX_AGE);
 			if (!ret)
 			{
 				_log.Log(LOG_ERROR, "Netatmo: Error connecting to Server...");
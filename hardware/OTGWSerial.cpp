@@ -64,7 +64,7 @@ void OTGWSerial::readCallback(const char *data, size_t len)
 
 void OTGWSerial::StartPollerThread()
 {
-	m_pollerthread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&OTGWSerial::Do_PollWork, this)));
+	m_pollerthread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&OTGWSerial::Do_PollWork, this)));
 }
 
 void OTGWSerial::StopPollerThread()
@@ -49,6 +49,8 @@ std::string ReadFile(std::string filename)
 
 #define round(a) ( int ) ( a + .5 )
 
+#define OPENWEATHERMAP_CACHE_MAX_AGE 540
+
 COpenWeatherMap::COpenWeatherMap(const int ID, const std::string &APIKey, const std::string &Location) :
 	m_APIKey(APIKey),
 	m_Location(Location),
@@ -73,7 +75,7 @@ COpenWeatherMap::~COpenWeatherMap(void)
 
 bool COpenWeatherMap::StartHardware()
 {
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&COpenWeatherMap::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&COpenWeatherMap::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	_log.Log(LOG_STATUS, "OpenWeatherMap: Started");
@@ -145,7 +147,7 @@ void COpenWeatherMap::GetMeterDetails()
 	{
 		bool bret;
 		std::string szURL = sURL.str();
-		bret = HTTPClient::GET(szURL, sResult);
+		bret = HTTPClient::GETCached(szURL, sResult, OPENWEATHERMAP_CACHE_MAX_AGE);
 		if (!bret)
 		{
 			_log.Log(LOG_ERROR, "OpenWeatherMap: Error getting http data!");
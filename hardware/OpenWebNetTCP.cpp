@@ -78,11 +78,11 @@ bool COpenWebNetTCP::StartHardware()
 	mask_request_status = 0x1; // Set scan all devices
 
 	//Start monitor thread
-	m_monitorThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&COpenWebNetTCP::MonitorFrames, this)));
+	m_monitorThread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&COpenWebNetTCP::MonitorFrames, this)));
 
 	//Start worker thread
 	if (m_monitorThread != NULL) {
-		m_heartbeatThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&COpenWebNetTCP::Do_Work, this)));
+		m_heartbeatThread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&COpenWebNetTCP::Do_Work, this)));
 	}
 
 	return (m_monitorThread!=NULL && m_heartbeatThread!=NULL);
@@ -45,7 +45,7 @@ bool COpenWebNetUSB::StartHardware()
 	m_retrycntr = RETRY_DELAY - 2; //will force reconnect first thing
 
 								   //Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&COpenWebNetUSB::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&COpenWebNetUSB::Do_Work, this)));
 
 	return (m_thread != NULL);
 
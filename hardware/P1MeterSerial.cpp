@@ -62,7 +62,7 @@ bool P1MeterSerial::StartHardware()
 	ParseData((const BYTE*)&buffer, ret, 1);
 #endif
 	m_stoprequested = false;
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&P1MeterSerial::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&P1MeterSerial::Do_Work, this)));
 
 	//Try to open the Serial Port
 	try
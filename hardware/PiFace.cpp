@@ -723,8 +723,8 @@ bool CPiFace::StartHardware()
                     GetAndSetInitialDeviceState(devId);
             }
             
-            m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CPiFace::Do_Work, this)));
-            m_queue_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CPiFace::Do_Work_Queue, this)));
+            m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CPiFace::Do_Work, this)));
+            m_queue_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CPiFace::Do_Work_Queue, this)));
         }
         else m_stoprequested=true;
     }
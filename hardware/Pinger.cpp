@@ -162,7 +162,7 @@ bool CPinger::StartHardware()
 
 	//Start worker thread
 	m_stoprequested = false;
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CPinger::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CPinger::Do_Work, this)));
 	_log.Log(LOG_STATUS,"Pinger: Started");
 
 	return true;
@@ -24,7 +24,7 @@ bool CRFLinkSerial::StartHardware()
 	m_retrycntr=RFLINK_RETRY_DELAY*5; //will force reconnect first thing
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CRFLinkSerial::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CRFLinkSerial::Do_Work, this)));
 
 	return (m_thread!=NULL);
 }
@@ -31,7 +31,7 @@ bool CRFLinkTCP::StartHardware()
 	m_bIsStarted=true;
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CRFLinkTCP::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CRFLinkTCP::Do_Work, this)));
 	return (m_thread!=NULL);
 }
 
@@ -137,7 +137,7 @@ bool CRego6XXSerial::StartHardware()
 	m_retrycntr=Rego6XX_RETRY_DELAY; //will force reconnect first thing
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CRego6XXSerial::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CRego6XXSerial::Do_Work, this)));
 
 	return (m_thread!=NULL);
 }
@@ -13,6 +13,8 @@
 
 #define round(a) ( int ) ( a + .5 )
 
+#define SOLAREDGE_CACHE_MAX_AGE 240
+
 //#define DEBUG_SolarEdgeAPI
 
 #define SE_VOLT_AC 1
@@ -71,7 +73,7 @@ SolarEdgeAPI::~SolarEdgeAPI(void)
 bool SolarEdgeAPI::StartHardware()
 {
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&SolarEdgeAPI::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&SolarEdgeAPI::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	return (m_thread!=NULL);
@@ -159,7 +161,7 @@ void SolarEdgeAPI::GetSite()
 	sURL << "https://monitoringapi.solaredge.com/sites/list?size=1&api_key=" << m_APIKey << "&format=application/json";
 	bool bret;
 	std::string szURL = sURL.str();
-	bret = HTTPClient::GET(szURL, sResult);
+	bret = HTTPClient::GETCached(szURL, sResult, SOLAREDGE_CACHE_MAX_AGE);
 	if (!bret)
 	{
 		_log.Log(LOG_ERROR, "SolarEdgeAPI: Error getting http data!");
@@ -212,7 +214,7 @@ void SolarEdgeAPI::GetInverters()
 	sURL << "https://monitoringapi.solaredge.com/equipment/" << m_SiteID << "/list?api_key=" << m_APIKey << "&format=application/json";
 	bool bret;
 	std::string szURL = sURL.str();
-	bret = HTTPClient::GET(szURL, sResult);
+	bret = HTTPClient::GETCached(szURL, sResult, SOLAREDGE_CACHE_MAX_AGE);
 	if (!bret)
 	{
 		_log.Log(LOG_ERROR, "SolarEdgeAPI: Error getting http data!");
@@ -20,7 +20,7 @@ m_Password(password)
 {
 	m_HwdID=ID;
 	m_usIPPort=usIPPort;
-	m_stoprequested=false;
+	m_PollID = 0;
 	m_bOutputLog = false;
 	Init();
 }
@@ -36,47 +36,24 @@ void CSterbox::Init()
 bool CSterbox::StartHardware()
 {
 	Init();
-	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CSterbox::Do_Work, this)));
+	m_PollID = m_mainworker.m_pollscheduler.Register(this, "Sterbox", boost::bind(&CSterbox::GetMeterDetails, this), STERBOX_POLL_INTERVAL, POLL_DEFAULT_TIMEOUT);
 	m_bIsStarted=true;
 	sOnConnected(this);
 	_log.Log(LOG_STATUS, "Sterbox: Started");
-	return (m_thread!=NULL);
+	return true;
 }
 
 bool CSterbox::StopHardware()
 {
-	if (m_thread!=NULL)
+	if (m_PollID > 0)
 	{
-		assert(m_thread);
-		m_stoprequested = true;
-		m_thread->join();
+		m_mainworker.m_pollscheduler.Unregister(m_PollID);
+		m_PollID = 0;
 	}
     m_bIsStarted=false;
     return true;
 }
 
-void CSterbox::Do_Work()
-{
-	int sec_counter = STERBOX_POLL_INTERVAL - 2;
-
-	while (!m_stoprequested)
-	{
-		sleep_seconds(1);
-		sec_counter++;
-
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat=mytime(NULL);
-		}
-
-		if (sec_counter % STERBOX_POLL_INTERVAL == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	_log.Log(LOG_STATUS,"Sterbox: Worker stopped...");
-}
-
 bool CSterbox::WriteToHardware(const char *pdata, const unsigned char length)
 {
 	const tRBUF *pSen = reinterpret_cast<const tRBUF*>(pdata);
@@ -181,7 +158,7 @@ void CSterbox::UpdateSwitch(const unsigned char Idx, const int SubUnit, const bo
 	sDecodeRXMessage(this, (const unsigned char *)&lcmd.LIGHTING2, defaultname.c_str(), 255);
 }
 
-void CSterbox::GetMeterDetails()
+bool CSterbox::GetMeterDetails()
 {
 	std::string sResult;
 	std::stringstream szURL;
@@ -200,7 +177,7 @@ void CSterbox::GetMeterDetails()
 	if (!HTTPClient::GET(szURL.str(),sResult))
 	{
 		_log.Log(LOG_ERROR,"Sterbox: Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	std::vector<std::string> results;
 	std::vector<std::string> outputs;
@@ -210,7 +187,7 @@ void CSterbox::GetMeterDetails()
 	if (results.size()<8)
 	{
 		_log.Log(LOG_ERROR,"Sterbox: Result 8 Error connecting to: %s", m_szIPAddress.c_str());
-		return;
+		return false;
 	}
 	//if (results[0] != "<body>")
 	std::string tmpstr;
@@ -376,4 +353,5 @@ void CSterbox::GetMeterDetails()
 			}
 		}
 	}
+	return true;
 }
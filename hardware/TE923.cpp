@@ -37,7 +37,7 @@ bool CTE923::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CTE923::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CTE923::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 
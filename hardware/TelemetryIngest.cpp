@@ -0,0 +1,283 @@
+#include "stdafx.h"
+#include "TelemetryIngest.h"
+#include "../main/Logger.h"
+#include "../main/Helper.h"
+#include "../main/SQLHelper.h"
+#include "../main/localtime_r.h"
+#include "../main/mainworker.h"
+#include <boost/bind.hpp>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+/*
+Lightweight telemetry ingest for custom sensors (ESP8266/ESP32 nodes, scripts, ...)
+
+Instead of one json.htm?type=command&param=udevice request per reading, a node sends
+one UDP datagram with many readings in a simple line protocol:
+
+	key=<api key>
+	<idx> <nvalue> <svalue>
+	<idx> <nvalue> <svalue>
+	...
+
+The first line holds the API key configured as password of this hardware.
+Every following line is a reading for the device with the given idx, the svalue is
+the remainder of the line and may contain spaces and semicolons (for example "21.5;65;1").
+Empty lines and lines starting with # are ignored.
+
+Readings are handed to the normal device update path (same as udevice).
+*/
+
+#define TELEMETRY_DEVICE_CACHE_TIME 60
+
+CTelemetryIngest::CTelemetryIngest(const int ID, const std::string &IPAddress, const unsigned short usIPPort, const std::string &APIKey) :
+	m_szIPAddress(IPAddress),
+	m_usIPPort(usIPPort),
+	m_APIKey(APIKey),
+	m_socket(m_ioservice)
+{
+	m_HwdID = ID;
+	m_stoprequested = false;
+	m_totReadings = 0;
+	m_totRejected = 0;
+}
+
+CTelemetryIngest::~CTelemetryIngest(void)
+{
+}
+
+bool CTelemetryIngest::StartHardware()
+{
+	m_stoprequested = false;
+	m_devices.clear();
+
+	if (m_APIKey.empty())
+	{
+		_log.Log(LOG_ERROR, "Telemetry Ingest: No API key (password) configured!");
+		return false;
+	}
+
+	try
+	{
+		boost::asio::ip::address listen_addr = boost::asio::ip::address_v4::any();
+		if ((!m_szIPAddress.empty()) && (m_szIPAddress != "0.0.0.0"))
+			listen_addr = boost::asio::ip::address::from_string(m_szIPAddress);
+		boost::asio::ip::udp::endpoint listen_endpoint(listen_addr, m_usIPPort);
+
+		m_ioservice.reset();
+		m_socket.open(listen_endpoint.protocol());
+		m_socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+		m_socket.bind(listen_endpoint);
+	}
+	catch (const boost::system::system_error& ex)
+	{
+		_log.Log(LOG_ERROR, "Telemetry Ingest: Could not listen on %s:%d (%s)", m_szIPAddress.c_str(), m_usIPPort, ex.what());
+		if (m_socket.is_open())
+		{
+			boost::system::error_code ec;
+			m_socket.close(ec);
+		}
+		return false;
+	}
+
+	start_receive();
+
+	m_bIsStarted = true;
+	sOnConnected(this);
+
+	//Start worker thread
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CTelemetryIngest::Do_Work, this)));
+	return (m_thread != NULL);
+}
+
+bool CTelemetryIngest::StopHardware()
+{
+	m_stoprequested = true;
+	try {
+		if (m_thread)
+		{
+			m_thread->join();
+			m_thread.reset();
+		}
+	}
+	catch (...)
+	{
+		//Don't throw from a Stop command
+	}
+	if (m_socket.is_open())
+	{
+		boost::system::error_code ec;
+		m_socket.close(ec);
+	}
+	m_bIsStarted = false;
+	return true;
+}
+
+void CTelemetryIngest::Do_Work()
+{
+	_log.Log(LOG_STATUS, "Telemetry Ingest: Worker started, listening on UDP port %d...", m_usIPPort);
+
+	boost::thread bt(boost::bind(&boost::asio::io_service::run, &m_ioservice));
+
+	int sec_counter = 0;
+	while (!m_stoprequested)
+	{
+		sleep_seconds(1);
+		sec_counter++;
+		if (sec_counter % 12 == 0) {
+			m_LastHeartbeat = mytime(NULL);
+		}
+		if (sec_counter % 300 == 0)
+		{
+			_log.Log(LOG_NORM, "Telemetry Ingest: %lu readings processed, %lu rejected", m_totReadings, m_totRejected);
+		}
+	}
+	m_ioservice.stop();
+	bt.join();
+	_log.Log(LOG_STATUS, "Telemetry Ingest: Worker stopped...");
+}
+
+bool CTelemetryIngest::WriteToHardware(const char *pdata, const unsigned char length)
+{
+	return false;
+}
+
+void CTelemetryIngest::start_receive()
+{
+	m_socket.async_receive_from(boost::asio::buffer(m_data, max_length), m_remote_endpoint, boost::bind(&CTelemetryIngest::handle_receive, this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+}
+
+void CTelemetryIngest::handle_receive(const boost::system::error_code& error, std::size_t bytes_recvd)
+{
+	if (error == boost::asio::error::operation_aborted)
+		return;
+	if (!error)
+	{
+		std::string szData(m_data, bytes_recvd);
+		if (HandleDatagram(szData) < 0)
+		{
+			_log.Log(LOG_ERROR, "Telemetry Ingest: Invalid API key received from %s", m_remote_endpoint.address().to_string().c_str());
+		}
+	}
+	if (!m_stoprequested)
+		start_receive();
+}
+
+//Returns the number of readings processed, or -1 when the API key did not match
+int CTelemetryIngest::HandleDatagram(const std::string &szData)
+{
+	std::vector<std::string> lines;
+	StringSplit(szData, "\n", lines);
+
+	bool bAuthorized = false;
+	int totProcessed = 0;
+	std::vector<std::string>::iterator itt;
+	for (itt = lines.begin(); itt != lines.end(); ++itt)
+	{
+		std::string sLine = *itt;
+		if ((!sLine.empty()) && (sLine[sLine.size() - 1] == '\r'))
+			sLine.erase(sLine.size() - 1);
+		stdstring_trim(sLine);
+		if ((sLine.empty()) || (sLine[0] == '#'))
+			continue;
+
+		if (!bAuthorized)
+		{
+			//the first line has to be the API key
+			if ((sLine.size() < 5) || (sLine.substr(0, 4) != "key=") || (sLine.substr(4) != m_APIKey))
+			{
+				m_totRejected++;
+				return -1;
+			}
+			bAuthorized = true;
+			continue;
+		}
+
+		uint64_t idx;
+		int nValue;
+		std::string sValue;
+		if (!ParseReading(sLine, idx, nValue, sValue))
+		{
+			_log.Log(LOG_ERROR, "Telemetry Ingest: Invalid reading '%s'", sLine.c_str());
+			m_totRejected++;
+			continue;
+		}
+
+		_tIngestDevice device;
+		if (!LookupDevice(idx, device))
+		{
+			_log.Log(LOG_ERROR, "Telemetry Ingest: Unknown device idx: %" PRIu64, idx);
+			m_totRejected++;
+			continue;
+		}
+		if (m_mainworker.UpdateDevice(device.HardwareID, device.DeviceID, device.Unit, device.devType, device.subType, nValue, sValue, 12, 255))
+		{
+			m_totReadings++;
+			totProcessed++;
+		}
+		else
+			m_totRejected++;
+	}
+	return totProcessed;
+}
+
+bool CTelemetryIngest::ParseReading(const std::string &sLine, uint64_t &idx, int &nValue, std::string &sValue)
+{
+	size_t pos1 = sLine.find(' ');
+	if (pos1 == std::string::npos)
+		return false;
+	std::string sIdx = sLine.substr(0, pos1);
+	std::string sRemainder = sLine.substr(pos1 + 1);
+	stdstring_ltrim(sRemainder);
+
+	std::string sNValue;
+	size_t pos2 = sRemainder.find(' ');
+	if (pos2 == std::string::npos)
+	{
+		sNValue = sRemainder;
+		sValue = "";
+	}
+	else
+	{
+		sNValue = sRemainder.substr(0, pos2);
+		sValue = sRemainder.substr(pos2 + 1);
+		stdstring_ltrim(sValue);
+	}
+	if ((!is_number(sIdx)) || (!is_number(sNValue)))
+		return false;
+
+	std::stringstream s_str(sIdx);
+	s_str >> idx;
+	nValue = atoi(sNValue.c_str());
+	return true;
+}
+
+bool CTelemetryIngest::LookupDevice(const uint64_t idx, _tIngestDevice &device)
+{
+	time_t atime = mytime(NULL);
+	std::map<uint64_t, _tIngestDevice>::const_iterator itt = m_devices.find(idx);
+	if (itt != m_devices.end())
+	{
+		if (atime - itt->second.LastLookup < TELEMETRY_DEVICE_CACHE_TIME)
+		{
+			device = itt->second;
+			return true;
+		}
+	}
+
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT HardwareID, DeviceID, Unit, Type, SubType FROM DeviceStatus WHERE (ID==%" PRIu64 ")", idx);
+	if (result.empty())
+	{
+		m_devices.erase(idx);
+		return false;
+	}
+	device.HardwareID = atoi(result[0][0].c_str());
+	device.DeviceID = result[0][1];
+	device.Unit = atoi(result[0][2].c_str());
+	device.devType = atoi(result[0][3].c_str());
+	device.subType = atoi(result[0][4].c_str());
+	device.LastLookup = atime;
+	m_devices[idx] = device;
+	return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "DomoticzHardware.h"
+#include <iostream>
+#include <map>
+#include <boost/asio.hpp>
+
+class CTelemetryIngest : public CDomoticzHardwareBase
+{
+	struct _tIngestDevice
+	{
+		int HardwareID;
+		std::string DeviceID;
+		int Unit;
+		int devType;
+		int subType;
+		time_t LastLookup;
+	};
+public:
+	CTelemetryIngest(const int ID, const std::string &IPAddress, const unsigned short usIPPort, const std::string &APIKey);
+	~CTelemetryIngest(void);
+	bool WriteToHardware(const char *pdata, const unsigned char length);
+private:
+	bool StartHardware();
+	bool StopHardware();
+	void Do_Work();
+	void start_receive();
+	void handle_receive(const boost::system::error_code& error, std::size_t bytes_recvd);
+	int HandleDatagram(const std::string &szData);
+	bool ParseReading(const std::string &sLine, uint64_t &idx, int &nValue, std::string &sValue);
+	bool LookupDevice(const uint64_t idx, _tIngestDevice &device);
+private:
+	std::string m_szIPAddress;
+	unsigned short m_usIPPort;
+	std::string m_APIKey;
+
+	boost::shared_ptr<boost::thread> m_thread;
+	volatile bool m_stoprequested;
+
+	boost::asio::io_service m_ioservice;
+	boost::asio::ip::udp::socket m_socket;
+	boost::asio::ip::udp::endpoint m_remote_endpoint;
+	enum { max_length = 8192 };
+	char m_data[max_length];
+
+	std::map<uint64_t, _tIngestDevice> m_devices;
+
+	unsigned long m_totReadings;
+	unsigned long m_totRejected;
+};
@@ -10,6 +10,8 @@
 
 #define WINDDELEN_POLL_INTERVAL 10
 
+#define WINDDELEN_CACHE_MAX_AGE (WINDDELEN_POLL_INTERVAL - 2)
+
 CWinddelen::CWinddelen(const int ID, const std::string &IPAddress, const unsigned short usIPPort, const unsigned short usMillID) :
 m_szIPAddress(IPAddress)
 {
@@ -32,7 +34,7 @@ bool CWinddelen::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CWinddelen::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CWinddelen::Do_Work, this)));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	return (m_thread!=NULL);
@@ -90,7 +92,7 @@ void CWinddelen::GetMeterDetails()
    sprintf(szURL,"http://backend.windcentrale.nl/windcentrale/productie_%d.txt", m_usMillID);
 	
 
-	if (!HTTPClient::GET(szURL,sResult))
+	if (!HTTPClient::GETCached(szURL,sResult, WINDDELEN_CACHE_MAX_AGE))
 	{
 		_log.Log(LOG_ERROR,"Winddelen: Error connecting to: %s", szURL);
 		return;
@@ -12,6 +12,8 @@
 
 #define round(a) ( int ) ( a + .5 )
 
+#define WUNDERGROUND_CACHE_MAX_AGE 540
+
 #ifdef _DEBUG
 	//#define DEBUG_WUNDERGROUNDR
 	//#define DEBUG_WUNDERGROUNDW
@@ -71,7 +73,7 @@ bool CWunderground::StartHardware()
 {
 	Init();
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CWunderground::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CWunderground::Do_Work, this)));
 	if (!m_thread)
 		return false;
 	m_bIsStarted=true;
@@ -139,7 +141,7 @@ void CWunderground::GetMeterDetails()
 	sURL << "http://api.wunderground.com/api/" << m_APIKey << "/conditions/q/" << szLoc << ".json";
 	bool bret;
 	std::string szURL=sURL.str();
-	bret=HTTPClient::GET(szURL,sResult);
+	bret=HTTPClient::GETCached(szURL,sResult, WUNDERGROUND_CACHE_MAX_AGE);
 	if (!bret)
 	{
 		_log.Log(LOG_ERROR,"Wunderground: Error getting http data!");
@@ -12,6 +12,7 @@
 #include <openssl/aes.h>
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 /*
 Xiaomi (Aqara) makes a smart home gateway/hub that has support
@@ -23,8 +24,25 @@ Domoticz need to be in the same network/subnet
 */
 
 #define round(a) ( int ) ( a + .5 )
+#define XIAOMI_DUPLICATE_WINDOW 1000	// ms, a repeated report within this time is a duplicate of the gateway
 std::vector<std::string> arrAqara_Wired_ID;
 
+boost::mutex XiaomiGateway::s_gatewaysMutex;
+std::vector<XiaomiGateway*> XiaomiGateway::s_gateways;
+boost::shared_ptr<boost::asio::io_service> XiaomiGateway::s_io_service;
+boost::shared_ptr<XiaomiGateway::xiaomi_udp_server> XiaomiGateway::s_udp_server;
+boost::shared_ptr<boost::thread> XiaomiGateway::s_udp_thread;
+
+static std::string GetStateKey(const unsigned int sID, const int unit)
+{
+	char szTmp[50];
+	if (sID == 1)
+		sprintf(szTmp, "1/%d", unit);
+	else
+		sprintf(szTmp, "%08X/%d", sID, unit);
+	return szTmp;
+}
+
 XiaomiGateway::XiaomiGateway(const int ID)
 {
 	m_HwdID = ID;
@@ -184,6 +202,24 @@ bool XiaomiGateway::WriteToHardware(const char * pdata, const unsigned char leng
 	return result;
 }
 
+//The gateway sends some reports twice (a plug reports its new state two times), only the first one is handled.
+//The state itself is compared with the database, so changes made outside this class are seen
+bool XiaomiGateway::IsDuplicateReport(const std::string &StateKey, const bool bIsOn, const int level, const std::string &messagetype)
+{
+	boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+	boost::lock_guard<boost::mutex> lock(m_ReportMutex);
+	_tLastReport &report = m_LastReports[StateKey];
+	if ((!report.received.is_not_a_date_time()) && (report.bIsOn == bIsOn) && (report.level == level) && (report.messagetype == messagetype)
+		&& ((now - report.received).total_milliseconds() < XIAOMI_DUPLICATE_WINDOW)) {
+		return true;
+	}
+	report.bIsOn = bIsOn;
+	report.level = level;
+	report.messagetype = messagetype;
+	report.received = now;
+	return false;
+}
+
 bool XiaomiGateway::SendMessageToGateway(const std::string &controlmessage) {
 	std::string message = controlmessage;
 	bool result = true;
@@ -197,9 +233,7 @@ bool XiaomiGateway::SendMessageToGateway(const std::string &controlmessage) {
 	sleep_milliseconds(150);
 	boost::array<char, 512> recv_buffer_;
 	memset(&recv_buffer_[0], 0, sizeof(recv_buffer_));
-#ifdef _DEBUG
-	_log.Log(LOG_STATUS, "XiaomiGateway: request %s", message.c_str());
-#endif
+	_log.Log(LOGCAT_HARDWARE, LOG_TRACE, "XiaomiGateway: request %s", message.c_str());
 	while (socket_.available() > 0) {
 		socket_.receive_from(boost::asio::buffer(recv_buffer_), remote_endpoint_);
 		std::string receivedString(recv_buffer_.data());
@@ -208,9 +242,7 @@ bool XiaomiGateway::SendMessageToGateway(const std::string &controlmessage) {
 			_log.Log(LOG_ERROR, "XiaomiGateway: unable to write command - Invalid Key");
 			result = false;
 		}
-#ifdef _DEBUG
-		_log.Log(LOG_STATUS, "XiaomiGateway: response %s", receivedString.c_str());
-#endif
+		_log.Log(LOGCAT_HARDWARE, LOG_TRACE, "XiaomiGateway: response %s", receivedString.c_str());
 	}
 	socket_.close();
 	return result;
@@ -274,17 +306,11 @@ void XiaomiGateway::InsertUpdateRGBGateway(const std::string & nodeid, const std
 	else
 		sprintf(szDeviceID, "%08X", (unsigned int)sID);
 
-	int lastLevel = 0;
-	int nvalue = 0;
-	bool tIsOn = !(bIsOn);
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query("SELECT nValue, LastLevel FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (SubType==%d)", m_HwdID, szDeviceID, pTypeLimitlessLights, sTypeLimitlessRGBW);
-
 	if (result.size() < 1)
 	{
 		_log.Log(LOG_STATUS, "XiaomiGateway: New Gateway Found (%s/%s)", str.c_str(), Name.c_str());
-		//int value = atoi(brightness.c_str());
-		//int value = hue; // atoi(hue.c_str());
 		int cmd = light1_sOn;
 		if (!bIsOn) {
 			cmd = light1_sOff;
@@ -294,33 +320,28 @@ void XiaomiGateway::InsertUpdateRGBGateway(const std::string & nodeid, const std
 		ycmd.type = pTypeLimitlessLights;
 		ycmd.subtype = sTypeLimitlessRGBW;
 		ycmd.id = sID;
-		//ycmd.dunit = 0;
 		ycmd.value = brightness;
 		ycmd.command = cmd;
 		m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&ycmd, NULL, -1);
 		m_sql.safe_query("UPDATE DeviceStatus SET Name='%q', SwitchType=%d, LastLevel=%d WHERE(HardwareID == %d) AND (DeviceID == '%s')", Name.c_str(), (STYPE_Dimmer), brightness, m_HwdID, szDeviceID);
+		return;
 	}
-	else {
-		nvalue = atoi(result[0][0].c_str());
-		tIsOn = (nvalue != 0);
-		lastLevel = atoi(result[0][1].c_str());
-		//int value = atoi(brightness.c_str());
-		if ((bIsOn != tIsOn) || (brightness != lastLevel))
-		{
-			int cmd = Limitless_LedOn;
-			if (!bIsOn) {
-				cmd = Limitless_LedOff;
-			}
-			_tLimitlessLights ycmd;
-			ycmd.len = sizeof(_tLimitlessLights) - 1;
-			ycmd.type = pTypeLimitlessLights;
-			ycmd.subtype = sTypeLimitlessRGBW;
-			ycmd.id = sID;
-			//ycmd.dunit = 0;
-			ycmd.value = brightness;
-			ycmd.command = cmd;
-			m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&ycmd, NULL, -1);
+	bool tIsOn = (atoi(result[0][0].c_str()) != 0);
+	int lastLevel = atoi(result[0][1].c_str());
+	if ((bIsOn != tIsOn) || (brightness != lastLevel))
+	{
+		int cmd = Limitless_LedOn;
+		if (!bIsOn) {
+			cmd = Limitless_LedOff;
 		}
+		_tLimitlessLights ycmd;
+		ycmd.len = sizeof(_tLimitlessLights) - 1;
+		ycmd.type = pTypeLimitlessLights;
+		ycmd.subtype = sTypeLimitlessRGBW;
+		ycmd.id = sID;
+		ycmd.value = brightness;
+		ycmd.command = cmd;
+		m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&ycmd, NULL, -1);
 	}
 }
 
@@ -365,11 +386,21 @@ void XiaomiGateway::InsertUpdateSwitch(const std::string &nodeid, const std::str
 		xcmd.cmnd = gswitch_sOff;
 	}
 
+	if (is2ndchannel) {
+		xcmd.unitcode = 2;
+	}
+	//Selector reports are events (click, flip...), a repeated click is a new event
+	if ((switchtype != STYPE_Selector) && (messagetype != "heartbeat") && (IsDuplicateReport(GetStateKey(sID, xcmd.unitcode), bIsOn, level, messagetype))) {
+		_log.Log(LOGCAT_HARDWARE, LOG_TRACE, "XiaomiGateway: duplicate report of %s dropped", str.c_str());
+		return;
+	}
+
 	//check if this switch is already in the database
 	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT nValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) ", m_HwdID, ID.c_str(), pTypeGeneralSwitch);
+	result = m_sql.safe_query("SELECT nValue, Unit FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) ORDER BY Unit", m_HwdID, ID.c_str(), pTypeGeneralSwitch);
 	if (result.size() < 1)
 	{
+		xcmd.unitcode = 1;
 		_log.Log(LOG_STATUS, "XiaomiGateway: New Device Found (%s)", str.c_str());
 		m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&xcmd, NULL, -1);
 		int customimage = 0;
@@ -415,16 +446,19 @@ void XiaomiGateway::InsertUpdateSwitch(const std::string &nodeid, const std::str
 		}
 	}
 	else {
-		if (is2ndchannel) {
-			xcmd.unitcode = 2;
-		}
-		int nvalue = atoi(result[0][0].c_str());
-		//if ((((bIsOn && nvalue == 0) || (bIsOn == false && nvalue == 1))) && (messagetype != "heartbeat")) {
-		if (messagetype != "heartbeat") {
-			if ((((bIsOn && nvalue == 0) || (bIsOn == false && nvalue == 1))) || (switchtype == STYPE_Selector)) {
-				m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&xcmd, NULL, -1);
+		bool tIsOn = (atoi(result[0][0].c_str()) != 0);
+		for (size_t i = 0; i < result.size(); i++) {
+			if (atoi(result[i][1].c_str()) == xcmd.unitcode) {
+				tIsOn = (atoi(result[i][0].c_str()) != 0);
 			}
 		}
+		if (messagetype == "heartbeat") {
+			return;
+		}
+		//the other reports are only passed on when the state changes
+		if ((bIsOn != tIsOn) || (switchtype == STYPE_Selector)) {
+			m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&xcmd, NULL, -1);
+		}
 		else {
 #ifdef _DEBUG
 			_log.Log(LOG_STATUS, "XiaomiGateway: not updating Domoticz for switch as no change from last state");
@@ -502,40 +536,17 @@ bool XiaomiGateway::StartHardware()
 	// update any CustomSwitch Xiaomi devices to GeneralSwitch		
  	m_sql.safe_query("UPDATE DeviceStatus SET SubType=73 WHERE(HardwareID == %d) AND (SubType == 72)", m_HwdID);	
 
-	//check there is only one instance of the Xiaomi Gateway
 	std::vector<std::vector<std::string> > result;
-	//result = m_sql.safe_query("SELECT Password, Address, ID FROM Hardware WHERE Type=%d AND ID=%d", HTYPE_XiaomiGateway, m_HwdID);
-	result = m_sql.safe_query("SELECT Password, Address, ID FROM Hardware WHERE Type=%d", HTYPE_XiaomiGateway);
+	result = m_sql.safe_query("SELECT Password, Address FROM Hardware WHERE Type=%d AND ID=%d", HTYPE_XiaomiGateway, m_HwdID);
 	if (result.size() > 0) {
-		int lowestId = 9999;
-		int Id = 0;
-		for (size_t i = 0; i < result.size(); i++) {
-			Id = atoi(result[i][2].c_str());
-			//_log.Log(LOG_STATUS, "XiaomiGateway: checking hardware id %d", Id);
-			if (Id < lowestId) {
-				lowestId = Id;
-			}
-			if (Id == m_HwdID) {
-				m_GatewayPassword = result[i][0].c_str();
-				m_GatewayIp = result[i][1].c_str();
-			}
-		}
-		m_ListenPort9898 = true;
-		if (lowestId != m_HwdID) {
-			//_log.Log(LOG_STATUS, "XiaomiGateway: %d != %d", lowestId, m_HwdID);
-			m_ListenPort9898 = false;
-		}
-		else {
-			_log.Log(LOG_STATUS, "XiaomiGateway: will listen on 9898 for hardware id %d", m_HwdID);
-		}
 		//retrieve the gateway key
-		//m_GatewayPassword = result[0][0].c_str();
-		//m_GatewayIp = result[0][1].c_str();
+		m_GatewayPassword = result[0][0].c_str();
+		m_GatewayIp = result[0][1].c_str();
 		m_GatewayRgbHex = "FFFFFF";
 		m_GatewayBrightnessInt = 100;
 		m_GatewayPrefix = "f0b4";
 		//Start worker thread
-		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&XiaomiGateway::Do_Work, this)));
+		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&XiaomiGateway::Do_Work, this)));
 	}
 
 	return (m_thread != NULL);
@@ -562,12 +573,14 @@ void XiaomiGateway::Do_Work()
 {
 	_log.Log(LOG_STATUS, "XiaomiGateway: Worker started...");
 	boost::asio::io_service io_service;
+	m_GatewayAddress = m_GatewayIp;
 	//find the local ip address that is similar to the xiaomi gateway
 	try {
 		boost::asio::ip::udp::resolver resolver(io_service);
 		boost::asio::ip::udp::resolver::query query(boost::asio::ip::udp::v4(), m_GatewayIp, "");
 		boost::asio::ip::udp::resolver::iterator endpoints = resolver.resolve(query);
 		boost::asio::ip::udp::endpoint ep = *endpoints;
+		m_GatewayAddress = ep.address().to_string();
 		boost::asio::ip::udp::socket socket(io_service);
 		socket.connect(ep);
 		boost::asio::ip::address addr = socket.local_endpoint().address();
@@ -582,11 +595,7 @@ void XiaomiGateway::Do_Work()
 		_log.Log(LOG_STATUS, "XiaomiGateway: Could not detect local IP address: %s", e.what());
 	}
 
-	XiaomiGateway::xiaomi_udp_server udp_server(io_service, m_HwdID, m_GatewayIp, m_LocalIp, m_ListenPort9898, this);
-	boost::thread bt;
-	if (m_ListenPort9898) {
-		bt = boost::thread(boost::bind(&boost::asio::io_service::run, &io_service));
-	}
+	RegisterGateway(this);
 
 	int sec_counter = 0;
 	while (!m_stoprequested)
@@ -601,7 +610,7 @@ void XiaomiGateway::Do_Work()
 			//_log.Log(LOG_STATUS, "sec_counter %d", sec_counter);
 		}
 	}
-	io_service.stop();
+	UnregisterGateway(this);
 	_log.Log(LOG_STATUS, "XiaomiGateway: stopped");
 }
 
@@ -636,61 +645,123 @@ std::string XiaomiGateway::GetGatewayKey()
 }
 
 
-XiaomiGateway::xiaomi_udp_server::xiaomi_udp_server(boost::asio::io_service& io_service, int m_HwdID, const std::string gatewayIp, const std::string localIp, const bool listenPort9898, XiaomiGateway *parent)
-	: socket_(io_service, boost::asio::ip::udp::v4())
+void XiaomiGateway::RegisterGateway(XiaomiGateway *pGateway)
 {
-	m_HardwareID = m_HwdID;
-	m_XiaomiGateway = parent;
-	m_gatewayip = gatewayIp;
-	m_localip = localIp;
-
-	if (listenPort9898) {
+	boost::lock_guard<boost::mutex> l(s_gatewaysMutex);
+	if (s_udp_server == NULL) {
+		s_io_service.reset(new boost::asio::io_service());
 		try {
-			socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
-			if (m_localip != "" ) {
-				boost::system::error_code ec;
-				boost::asio::ip::address listen_addr = boost::asio::ip::address::from_string(m_localip, ec);
-				boost::asio::ip::address mcast_addr = boost::asio::ip::address::from_string("224.0.0.50", ec);
-				boost::asio::ip::udp::endpoint listen_endpoint(mcast_addr, 9898);
-
-				socket_.bind(boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 9898));
-				boost::shared_ptr<std::string> message(new std::string("{\"cmd\":\"whois\"}"));
-				boost::asio::ip::udp::endpoint remote_endpoint;
-				remote_endpoint = boost::asio::ip::udp::endpoint(mcast_addr, 4321);
-				socket_.send_to(boost::asio::buffer(*message), remote_endpoint);
-				socket_.set_option(boost::asio::ip::multicast::join_group(mcast_addr.to_v4(), listen_addr.to_v4()), ec);
-				socket_.bind(listen_endpoint, ec);
-			}
-			else {
-				socket_.bind(boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 9898));
-				boost::shared_ptr<std::string> message(new std::string("{\"cmd\":\"whois\"}"));
-				boost::asio::ip::udp::endpoint remote_endpoint;
-				remote_endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("224.0.0.50"), 4321);
-				socket_.send_to(boost::asio::buffer(*message), remote_endpoint);
-				socket_.set_option(boost::asio::ip::multicast::join_group(boost::asio::ip::address::from_string("224.0.0.50")));
-			}
+			s_udp_server.reset(new xiaomi_udp_server(*s_io_service));
 		}
 		catch (const boost::system::system_error& ex) {
-			_log.Log(LOG_ERROR, "XiaomiGateway: %s", ex.code().category().name());
-			m_XiaomiGateway->StopHardware();
+			_log.Log(LOG_ERROR, "XiaomiGateway: could not listen on port 9898 (%s)", ex.what());
+			s_udp_server.reset();
+			s_io_service.reset();
 			return;
 		}
-		start_receive();
+		s_udp_thread.reset(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&boost::asio::io_service::run, s_io_service.get())));
 	}
-	else {
-		_log.Log(LOG_STATUS, "XiaomiGateway: NOT LISTENING TO UDP FOR HARDWARE ID %d", m_HwdID);
+	//socket operations are done by the listener thread
+	s_io_service->post(boost::bind(&xiaomi_udp_server::join_group, s_udp_server, pGateway->m_LocalIp));
+
+	//sorted on hardware id, reports from unknown addresses go to the first gateway
+	std::vector<XiaomiGateway*>::iterator itt = s_gateways.begin();
+	while ((itt != s_gateways.end()) && ((*itt)->m_HwdID < pGateway->m_HwdID)) {
+		++itt;
 	}
+	s_gateways.insert(itt, pGateway);
+	_log.Log(LOG_STATUS, "XiaomiGateway: will listen on 9898 for hardware id %d (%d gateways)", pGateway->m_HwdID, (int)s_gateways.size());
+}
+
+void XiaomiGateway::UnregisterGateway(XiaomiGateway *pGateway)
+{
+	boost::shared_ptr<boost::asio::io_service> io_service;
+	boost::shared_ptr<xiaomi_udp_server> udp_server;
+	boost::shared_ptr<boost::thread> udp_thread;
+	bool bLast = false;
+	{
+		boost::lock_guard<boost::mutex> l(s_gatewaysMutex);
+		std::vector<XiaomiGateway*>::iterator itt = std::find(s_gateways.begin(), s_gateways.end(), pGateway);
+		if (itt != s_gateways.end()) {
+			s_gateways.erase(itt);
+		}
+		if (s_gateways.empty()) {
+			bLast = true;
+			io_service.swap(s_io_service);
+			udp_server.swap(s_udp_server);
+			udp_thread.swap(s_udp_thread);
+		}
+	}
+	//the gateway can not be found anymore, wait for a report of it that is still being handled
+	{
+		boost::lock_guard<boost::mutex> l(pGateway->m_handlerMutex);
+	}
+	if (!bLast) {
+		return;
+	}
+	//last gateway stopped, stop the listener
+	if (io_service) {
+		io_service->stop();
+	}
+	if (udp_thread) {
+		udp_thread->join();
+	}
+}
+
+//Called with s_gatewaysMutex locked
+XiaomiGateway *XiaomiGateway::GetGateway(const std::string &address)
+{
+	if (s_gateways.empty()) {
+		return NULL;
+	}
+	std::vector<XiaomiGateway*>::const_iterator itt;
+	for (itt = s_gateways.begin(); itt != s_gateways.end(); ++itt) {
+		if (((*itt)->m_GatewayAddress == address) || ((*itt)->m_GatewayIp == address)) {
+			return *itt;
+		}
+	}
+	return s_gateways[0];
+}
+
+XiaomiGateway::xiaomi_udp_server::xiaomi_udp_server(boost::asio::io_service& io_service)
+	: socket_(io_service, boost::asio::ip::udp::v4())
+{
+	socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+	socket_.bind(boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 9898));
+	start_receive();
 }
 
 XiaomiGateway::xiaomi_udp_server::~xiaomi_udp_server()
 {
 }
 
+void XiaomiGateway::xiaomi_udp_server::join_group(const std::string &localIp)
+{
+	if (m_joined.find(localIp) != m_joined.end()) {
+		return;
+	}
+	m_joined.insert(localIp);
+	boost::system::error_code ec;
+	boost::asio::ip::address mcast_addr = boost::asio::ip::address::from_string("224.0.0.50", ec);
+	std::string message("{\"cmd\":\"whois\"}");
+	socket_.send_to(boost::asio::buffer(message), boost::asio::ip::udp::endpoint(mcast_addr, 4321), 0, ec);
+	if (localIp != "") {
+		boost::asio::ip::address listen_addr = boost::asio::ip::address::from_string(localIp, ec);
+		socket_.set_option(boost::asio::ip::multicast::join_group(mcast_addr.to_v4(), listen_addr.to_v4()), ec);
+	}
+	else {
+		socket_.set_option(boost::asio::ip::multicast::join_group(mcast_addr), ec);
+	}
+	if (ec) {
+		_log.Log(LOG_ERROR, "XiaomiGateway: could not join multicast group on %s (%s)", (localIp != "") ? localIp.c_str() : "default interface", ec.message().c_str());
+	}
+}
+
 void XiaomiGateway::xiaomi_udp_server::start_receive()
 {
 	//_log.Log(LOG_STATUS, "start_receive");
 	memset(&data_[0], 0, sizeof(data_));
-	socket_.async_receive_from(boost::asio::buffer(data_, max_length), remote_endpoint_, boost::bind(&xiaomi_udp_server::handle_receive, this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+	socket_.async_receive_from(boost::asio::buffer(data_, max_length - 1), remote_endpoint_, boost::bind(&xiaomi_udp_server::handle_receive, this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
 }
 
 void XiaomiGateway::xiaomi_udp_server::handle_receive(const boost::system::error_code & error, std::size_t bytes_recvd)
@@ -702,269 +773,283 @@ void XiaomiGateway::xiaomi_udp_server::handle_receive(const boost::system::error
 #endif
 		Json::Value root;
 		Json::Reader jReader;
-		bool showmessage = true;
 		bool ret = jReader.parse(data_, root);
 		if ((!ret) || (!root.isObject()))
 		{
 			_log.Log(LOG_ERROR, "XiaomiGateway: invalid data received!");
-			return;
 		}
 		else {
-			std::string cmd = root["cmd"].asString();
-			std::string model = root["model"].asString();
-			std::string sid = root["sid"].asString();
-			std::string data = root["data"].asString();
-			if ((cmd == "report") || (cmd == "read_ack") || (cmd == "heartbeat")) {
-
-				Json::Value root2;
-				ret = jReader.parse(data.c_str(), root2);
-				if ((ret) || (!root2.isObject()))
-				{
-					_eSwitchType type = STYPE_END;
-					std::string name = "Xiaomi Switch";
-					if (model == "motion") {
-						type = STYPE_Motion;
-						name = "Xiaomi Motion Sensor";
-					}
-					else if (model == "switch") {
-						type = STYPE_Selector;
-						name = "Xiaomi Wireless Switch";
-					}
-					else if (model == "magnet") {
-						type = STYPE_Contact;
-						name = "Xiaomi Door Sensor";
-					}
-					else if (model == "plug") {
-						type = STYPE_OnOff;
-						name = "Xiaomi Smart Plug";
-					}
-					else if (model == "sensor_ht") {
-						name = "Xiaomi Temperature/Humidity";
-					}
-					else if (model == "cube") {
-						name = "Xiaomi Cube";
-						type = STYPE_Selector;
-					}
-					else if (model == "86sw2") {
-						name = "Xiaomi Wireless Dual Wall Switch";
-						type = STYPE_Selector;
-					}
-					else if (model == "ctrl_neutral2") {
-						name = "Xiaomi Wired Dual Wall Switch";
-						//type = STYPE_Selector;
-					}
-					else if (model == "gateway") {
-						name = "Xiaomi RGB Gateway";
-					}
-					else if (model == "ctrl_neutral1") {
-						name = "Xiaomi Wired Single Wall Switch";
-						//type = STYPE_Selector;
-					}
-					else if (model == "86sw1") {
-						name = "Xiaomi Wireless Single Wall Switch";
-						type = STYPE_PushOn;
-					}
-					if (type != STYPE_END) {
-						std::string status = root2["status"].asString();
-						std::string no_close = root2["no_close"].asString();
-						std::string no_motion = root2["no_motion"].asString();
-						//Aqara's Wireless switch reports per channel
-						std::string aqara_wireless1 = root2["channel_0"].asString();
-						std::string aqara_wireless2 = root2["channel_1"].asString();
-						std::string aqara_wireless3 = root2["dual_channel"].asString();
-						bool on = false;
-						int level = -1;
-						if (model == "switch") {
- 							level = 0;
- 						}
-						if ((status == "motion") || (status == "open") || (status == "no_close") || (status == "on") || (no_close != "")) {
-							level = 0;
-							on = true;
-						}
-						else if ((status == "no_motion") || (status == "close") || (status == "off") || (no_motion != "")) {
-							level = 0;
-							on = false;
-						}
-						else if ((status == "click") || (status == "flip90") || (aqara_wireless1 == "click")) {
-							level = 10;
-							on = true;
-						}
-						else if ((status == "long_click_press")  || (status == "flip180") || (aqara_wireless2 == "click")) {
-							level = 20;
-							on = true;
-						}
-						else if ((status == "long_click_release") || (status == "move") || (aqara_wireless3 == "both_click")) {
-							level = 30;
-							on = true;
-						}
-						else if ((status == "tap_twice") || (status == "double_click")) {
-							level = 40;
-							on = true;
-						}
-						else if (status == "shake_air") {
-							level = 50;
-							on = true;
-						}
-						else if (status == "swing") {
-							level = 60;
-							on = true;
-						}
-						else if (status == "alert") {
-							level = 70;
-							on = true;
-						}
-						else if (status == "free_fall") {
-							level = 80;
-							on = true;
-						}
-						std::string rotate = root2["rotate"].asString();
-						if (rotate != "") {
-							int amount = atoi(rotate.c_str());
-							if (amount > 0) {
-								level = 90;
-							}
-							else {
-								level = 100;
-							}
-							on = true;
-							m_XiaomiGateway->InsertUpdateCubeText(sid.c_str(), name, rotate.c_str());
-							m_XiaomiGateway->InsertUpdateSwitch(sid.c_str(), name, on, type, level, cmd);
-						}
-						else {
-							std::string voltage = root2["voltage"].asString();
-							if (voltage != "") {
-								m_XiaomiGateway->InsertUpdateVoltage(sid.c_str(), name, atoi(voltage.c_str()));
-							}
-							else {
-								if (model == "plug" ) {
-									sleep_milliseconds(100); //need to sleep here as the gateway will send 2 update messages, and need time for the database to update the state so that the event is not triggered twice
-								}
-								if (level > -1) { //this should stop false updates when empty 'data' is received
-									m_XiaomiGateway->InsertUpdateSwitch(sid.c_str(), name, on, type, level, cmd);
-								}																
-							}
-						}
-					}
-					else if ((name == "Xiaomi Wired Dual Wall Switch") || (name == "Xiaomi Wired Single Wall Switch")) {
-						//aqara wired dual switch, bidirectional communiction support
-						type = STYPE_OnOff;
-						std::string aqara_wired1 = root2["channel_0"].asString();
-						std::string aqara_wired2 = root2["channel_1"].asString();
-						bool state = false;
-						bool xctrl = false;
-						if ((aqara_wired1 == "on") || (aqara_wired2 =="on")) {
-							state = true;
-						}
-						bool cid = false;
-						for (unsigned i = 0; i < arrAqara_Wired_ID.size(); i++) {
-							if (arrAqara_Wired_ID[i] == sid) {
-								cid = true;
-							}
-						}
-						if ((cid == false) || (arrAqara_Wired_ID.size() < 1)) {
-							arrAqara_Wired_ID.push_back(sid);
-						}
-						if (name == "Xiaomi Wired Dual Wall Switch") {
-							xctrl = true;
-						}
-						if (aqara_wired1 != "") {
-							m_XiaomiGateway->InsertUpdateSwitch(sid.c_str(), name, state, type, 0, cmd, xctrl, false);
-						}
-						else if (aqara_wired2 != "") {
-							m_XiaomiGateway->InsertUpdateSwitch(sid.c_str(), name, state, type, 0, cmd, xctrl, true);
-						}
+			//the whois answer tells the address of the gateway, the other messages are sent by it
+			std::string address = remote_endpoint_.address().to_string();
+			if ((root["cmd"].asString() == "iam") && (root["ip"].asString() != "")) {
+				address = root["ip"].asString();
+			}
+			//the gateway is looked up under the list lock, the report is handled under the lock of the gateway only
+			boost::unique_lock<boost::mutex> lGateways(s_gatewaysMutex);
+			XiaomiGateway *pGateway = GetGateway(address);
+			if (pGateway != NULL) {
+				boost::lock_guard<boost::mutex> lHandler(pGateway->m_handlerMutex);
+				lGateways.unlock();
+				handle_message(pGateway, root);
+			}
+		}
+		start_receive();
+	}
+	else {
+		//_log.Log(LOG_ERROR, "XiaomiGateway: error in handle_receive %d", error);
+	}
+}
+
+void XiaomiGateway::xiaomi_udp_server::handle_message(XiaomiGateway *pGateway, Json::Value &root)
+{
+	Json::Reader jReader;
+	bool showmessage = true;
+	bool ret;
+	std::string cmd = root["cmd"].asString();
+	std::string model = root["model"].asString();
+	std::string sid = root["sid"].asString();
+	std::string data = root["data"].asString();
+	if ((cmd == "report") || (cmd == "read_ack") || (cmd == "heartbeat")) {
+
+		Json::Value root2;
+		ret = jReader.parse(data.c_str(), root2);
+		if ((ret) || (!root2.isObject()))
+		{
+			_eSwitchType type = STYPE_END;
+			std::string name = "Xiaomi Switch";
+			if (model == "motion") {
+				type = STYPE_Motion;
+				name = "Xiaomi Motion Sensor";
+			}
+			else if (model == "switch") {
+				type = STYPE_Selector;
+				name = "Xiaomi Wireless Switch";
+			}
+			else if (model == "magnet") {
+				type = STYPE_Contact;
+				name = "Xiaomi Door Sensor";
+			}
+			else if (model == "plug") {
+				type = STYPE_OnOff;
+				name = "Xiaomi Smart Plug";
+			}
+			else if (model == "sensor_ht") {
+				name = "Xiaomi Temperature/Humidity";
+			}
+			else if (model == "cube") {
+				name = "Xiaomi Cube";
+				type = STYPE_Selector;
+			}
+			else if (model == "86sw2") {
+				name = "Xiaomi Wireless Dual Wall Switch";
+				type = STYPE_Selector;
+			}
+			else if (model == "ctrl_neutral2") {
+				name = "Xiaomi Wired Dual Wall Switch";
+				//type = STYPE_Selector;
+			}
+			else if (model == "gateway") {
+				name = "Xiaomi RGB Gateway";
+			}
+			else if (model == "ctrl_neutral1") {
+				name = "Xiaomi Wired Single Wall Switch";
+				//type = STYPE_Selector;
+			}
+			else if (model == "86sw1") {
+				name = "Xiaomi Wireless Single Wall Switch";
+				type = STYPE_PushOn;
+			}
+			if (type != STYPE_END) {
+				std::string status = root2["status"].asString();
+				std::string no_close = root2["no_close"].asString();
+				std::string no_motion = root2["no_motion"].asString();
+				//Aqara's Wireless switch reports per channel
+				std::string aqara_wireless1 = root2["channel_0"].asString();
+				std::string aqara_wireless2 = root2["channel_1"].asString();
+				std::string aqara_wireless3 = root2["dual_channel"].asString();
+				bool on = false;
+				int level = -1;
+				if (model == "switch") {
+					level = 0;
+				}
+				if ((status == "motion") || (status == "open") || (status == "no_close") || (status == "on") || (no_close != "")) {
+					level = 0;
+					on = true;
+				}
+				else if ((status == "no_motion") || (status == "close") || (status == "off") || (no_motion != "")) {
+					level = 0;
+					on = false;
+				}
+				else if ((status == "click") || (status == "flip90") || (aqara_wireless1 == "click")) {
+					level = 10;
+					on = true;
+				}
+				else if ((status == "long_click_press")  || (status == "flip180") || (aqara_wireless2 == "click")) {
+					level = 20;
+					on = true;
+				}
+				else if ((status == "long_click_release") || (status == "move") || (aqara_wireless3 == "both_click")) {
+					level = 30;
+					on = true;
+				}
+				else if ((status == "tap_twice") || (status == "double_click")) {
+					level = 40;
+					on = true;
+				}
+				else if (status == "shake_air") {
+					level = 50;
+					on = true;
+				}
+				else if (status == "swing") {
+					level = 60;
+					on = true;
+				}
+				else if (status == "alert") {
+					level = 70;
+					on = true;
+				}
+				else if (status == "free_fall") {
+					level = 80;
+					on = true;
+				}
+				std::string rotate = root2["rotate"].asString();
+				if (rotate != "") {
+					int amount = atoi(rotate.c_str());
+					if (amount > 0) {
+						level = 90;
 					}
-					else if (name == "Xiaomi Temperature/Humidity") {
-						std::string temperature = root2["temperature"].asString();
-						std::string humidity = root2["humidity"].asString();
-						if (temperature != "") {
-							float temp = (float)atoi(temperature.c_str());
-							temp = temp / 100;
-							m_XiaomiGateway->InsertUpdateTemperature(sid.c_str(), "Xiaomi Temperature", temp);
-						}
-						if (humidity != "") {
-							int hum = atoi(humidity.c_str());
-							hum = hum / 100;
-							m_XiaomiGateway->InsertUpdateHumidity(sid.c_str(), "Xiaomi Humidity", hum);
-						}
+					else {
+						level = 100;
 					}
-					else if (name == "Xiaomi RGB Gateway") {
-						std::string rgb = root2["rgb"].asString();
-						if (rgb != "") {
-							std::stringstream ss;
-							ss << std::hex << atoi(rgb.c_str());
-							std::string hexstring(ss.str());
-							if (hexstring.length() == 7) {
-								hexstring.insert(0, "0");
-							}
-							std::string bright_hex = hexstring.substr(0, 2);
-							std::stringstream ss2;
-							ss2 << std::hex << bright_hex.c_str();
-							int brightness = strtoul(bright_hex.c_str(), NULL, 16);
-							bool on = false;
-							if (rgb != "0") {
-								on = true;
-							}
-							m_XiaomiGateway->InsertUpdateRGBGateway(sid.c_str(), name, on, brightness, 0);
-						}
-						else {
-							//check for token
-							std::string token = root["token"].asString();
-							if (token != "") {
-#ifdef _DEBUG
-								_log.Log(LOG_STATUS, "XiaomiGateway: Token Received - %s", token.c_str());
-#endif
-								m_XiaomiGateway->UpdateToken(token);
-								showmessage = false;
-							}
-						}
+					on = true;
+					pGateway->InsertUpdateCubeText(sid.c_str(), name, rotate.c_str());
+					pGateway->InsertUpdateSwitch(sid.c_str(), name, on, type, level, cmd);
+				}
+				else {
+					std::string voltage = root2["voltage"].asString();
+					if (voltage != "") {
+						pGateway->InsertUpdateVoltage(sid.c_str(), name, atoi(voltage.c_str()));
 					}
 					else {
-						_log.Log(LOG_STATUS, "XiaomiGateway: unhandled model: %s", model.c_str());
+						if (level > -1) { //this should stop false updates when empty 'data' is received
+							pGateway->InsertUpdateSwitch(sid.c_str(), name, on, type, level, cmd);
+						}																
 					}
 				}
 			}
-			else if (cmd == "get_id_list_ack") {
-				Json::Value root2;
-				ret = jReader.parse(data.c_str(), root2);
-				if ((ret) || (!root2.isObject()))
-				{
-					for (int i = 0; i < (int)root2.size(); i++) {
-						std::string message = "{\"cmd\" : \"read\",\"sid\":\"";
-						message.append(root2[i].asString().c_str());
-						message.append("\"}");
-						boost::shared_ptr<std::string> message1(new std::string(message));
-						boost::asio::ip::udp::endpoint remote_endpoint;
-						remote_endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(m_gatewayip), 9898);
-						socket_.send_to(boost::asio::buffer(*message1), remote_endpoint);
+			else if ((name == "Xiaomi Wired Dual Wall Switch") || (name == "Xiaomi Wired Single Wall Switch")) {
+				//aqara wired dual switch, bidirectional communiction support
+				type = STYPE_OnOff;
+				std::string aqara_wired1 = root2["channel_0"].asString();
+				std::string aqara_wired2 = root2["channel_1"].asString();
+				bool state = false;
+				bool xctrl = false;
+				if ((aqara_wired1 == "on") || (aqara_wired2 =="on")) {
+					state = true;
+				}
+				bool cid = false;
+				for (unsigned i = 0; i < arrAqara_Wired_ID.size(); i++) {
+					if (arrAqara_Wired_ID[i] == sid) {
+						cid = true;
 					}
 				}
-				showmessage = false;
+				if ((cid == false) || (arrAqara_Wired_ID.size() < 1)) {
+					arrAqara_Wired_ID.push_back(sid);
+				}
+				if (name == "Xiaomi Wired Dual Wall Switch") {
+					xctrl = true;
+				}
+				if (aqara_wired1 != "") {
+					pGateway->InsertUpdateSwitch(sid.c_str(), name, state, type, 0, cmd, xctrl, false);
+				}
+				else if (aqara_wired2 != "") {
+					pGateway->InsertUpdateSwitch(sid.c_str(), name, state, type, 0, cmd, xctrl, true);
+				}
 			}
-			else if (cmd == "iam") {
-				if (model == "gateway") {
-					_log.Log(LOG_STATUS, "XiaomiGateway: RGB Gateway Detected");
-					m_XiaomiGateway->InsertUpdateRGBGateway(sid.c_str(), "Xiaomi RGB Gateway", false, 0, 100);
-					//query for list of devices
-					std::string message = "{\"cmd\" : \"get_id_list\"}";
-					boost::shared_ptr<std::string> message2(new std::string(message));
-					boost::asio::ip::udp::endpoint remote_endpoint;
-					remote_endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(m_gatewayip.c_str()), 9898);
-					socket_.send_to(boost::asio::buffer(*message2), remote_endpoint);
+			else if (name == "Xiaomi Temperature/Humidity") {
+				std::string temperature = root2["temperature"].asString();
+				std::string humidity = root2["humidity"].asString();
+				if (temperature != "") {
+					float temp = (float)atoi(temperature.c_str());
+					temp = temp / 100;
+					pGateway->InsertUpdateTemperature(sid.c_str(), "Xiaomi Temperature", temp);
+				}
+				if (humidity != "") {
+					int hum = atoi(humidity.c_str());
+					hum = hum / 100;
+					pGateway->InsertUpdateHumidity(sid.c_str(), "Xiaomi Humidity", hum);
+				}
+			}
+			else if (name == "Xiaomi RGB Gateway") {
+				std::string rgb = root2["rgb"].asString();
+				if (rgb != "") {
+					std::stringstream ss;
+					ss << std::hex << atoi(rgb.c_str());
+					std::string hexstring(ss.str());
+					if (hexstring.length() == 7) {
+						hexstring.insert(0, "0");
+					}
+					std::string bright_hex = hexstring.substr(0, 2);
+					std::stringstream ss2;
+					ss2 << std::hex << bright_hex.c_str();
+					int brightness = strtoul(bright_hex.c_str(), NULL, 16);
+					bool on = false;
+					if (rgb != "0") {
+						on = true;
+					}
+					pGateway->InsertUpdateRGBGateway(sid.c_str(), name, on, brightness, 0);
+				}
+				else {
+					//check for token
+					std::string token = root["token"].asString();
+					if (token != "") {
+#ifdef _DEBUG
+						_log.Log(LOG_STATUS, "XiaomiGateway: Token Received - %s", token.c_str());
+#endif
+						pGateway->UpdateToken(token);
+						showmessage = false;
+					}
 				}
-				showmessage = false;
 			}
 			else {
-				_log.Log(LOG_STATUS, "XiaomiGateway: unknown cmd received: %s", cmd.c_str());
+				_log.Log(LOG_STATUS, "XiaomiGateway: unhandled model: %s", model.c_str());
 			}
 		}
-		if (showmessage) {
-			_log.Log(LOG_STATUS, data_);
+	}
+	else if (cmd == "get_id_list_ack") {
+		Json::Value root2;
+		ret = jReader.parse(data.c_str(), root2);
+		if ((ret) || (!root2.isObject()))
+		{
+			for (int i = 0; i < (int)root2.size(); i++) {
+				std::string message = "{\"cmd\" : \"read\",\"sid\":\"";
+				message.append(root2[i].asString().c_str());
+				message.append("\"}");
+				boost::shared_ptr<std::string> message1(new std::string(message));
+				boost::asio::ip::udp::endpoint remote_endpoint;
+				remote_endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(pGateway->m_GatewayAddress), 9898);
+				socket_.send_to(boost::asio::buffer(*message1), remote_endpoint);
+			}
 		}
-		start_receive();
+		showmessage = false;
+	}
+	else if (cmd == "iam") {
+		if (model == "gateway") {
+			_log.Log(LOG_STATUS, "XiaomiGateway: RGB Gateway Detected");
+			pGateway->InsertUpdateRGBGateway(sid.c_str(), "Xiaomi RGB Gateway", false, 0, 100);
+			//query for list of devices
+			std::string message = "{\"cmd\" : \"get_id_list\"}";
+			boost::shared_ptr<std::string> message2(new std::string(message));
+			boost::asio::ip::udp::endpoint remote_endpoint;
+			remote_endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(pGateway->m_GatewayAddress), 9898);
+			socket_.send_to(boost::asio::buffer(*message2), remote_endpoint);
+		}
+		showmessage = false;
 	}
 	else {
-		//_log.Log(LOG_ERROR, "XiaomiGateway: error in handle_receive %d", error);
+		_log.Log(LOG_STATUS, "XiaomiGateway: unknown cmd received: %s", cmd.c_str());
+	}
+	if (showmessage) {
+		_log.Log(LOG_STATUS, "%s", data_);
 	}
-
 }
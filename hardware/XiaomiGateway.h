@@ -3,6 +3,14 @@
 #include "DomoticzHardware.h"
 #include <deque>
 #include <iostream>
+#include <map>
+#include <set>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace Json
+{
+	class Value;
+};
 
 class XiaomiGateway : public CDomoticzHardwareBase
 {
@@ -25,36 +33,59 @@ private:
 	bool m_bDoRestart;
 	void Do_Work();
 	boost::shared_ptr<boost::thread> m_thread;
-	boost::shared_ptr<boost::thread> m_udp_thread;
-	bool m_ListenPort9898;
 	std::string GetGatewayKey();
+	bool IsDuplicateReport(const std::string &StateKey, const bool bIsOn, const int level, const std::string &messagetype);
 	std::string m_GatewayRgbHex;
 	int m_GatewayBrightnessInt;
 	std::string m_GatewayPrefix;
 	std::string m_GatewayIp;
+	std::string m_GatewayAddress;	//resolved address, to recognize the reports of this gateway
 	std::string m_LocalIp;
 	std::string m_GatewayPassword;
 	std::string m_token;
 	boost::mutex m_mutex;
 
+	//Last report of the switches (DeviceID/Unit), the gateway sends some reports twice
+	struct _tLastReport
+	{
+		bool bIsOn;
+		int level;
+		std::string messagetype;
+		boost::posix_time::ptime received;
+	};
+	std::map<std::string, _tLastReport> m_LastReports;
+	boost::mutex m_ReportMutex;
+
 	volatile bool m_stoprequested;
 
+	//held while a report of this gateway is handled, taken before s_gatewaysMutex is released
+	boost::mutex m_handlerMutex;
+
 	class xiaomi_udp_server
 	{
 	public:
-		xiaomi_udp_server(boost::asio::io_service & io_service, int m_HwdID, const std::string gatewayIp, const std::string localIp, const bool listenPort9898, XiaomiGateway *parent);
+		xiaomi_udp_server(boost::asio::io_service & io_service);
 		~xiaomi_udp_server();
+		void join_group(const std::string &localIp);
 
 	private:
 		boost::asio::ip::udp::socket socket_;
 		boost::asio::ip::udp::endpoint remote_endpoint_;
 		enum { max_length = 1024 };
 		char data_[max_length];
-		int m_HardwareID;
-		std::string m_gatewayip;
-		std::string m_localip;
-		XiaomiGateway* m_XiaomiGateway;
+		std::set<std::string> m_joined;
 		void start_receive();
 		void handle_receive(const boost::system::error_code& error, std::size_t /*bytes_transferred*/);
+		void handle_message(XiaomiGateway *pGateway, Json::Value &root);
 	};
+
+	//All gateways share one listener on the multicast port
+	static void RegisterGateway(XiaomiGateway *pGateway);
+	static void UnregisterGateway(XiaomiGateway *pGateway);
+	static XiaomiGateway *GetGateway(const std::string &address);
+	static boost::mutex s_gatewaysMutex;	//protects s_gateways and the listener
+	static std::vector<XiaomiGateway*> s_gateways;
+	static boost::shared_ptr<boost::asio::io_service> s_io_service;
+	static boost::shared_ptr<xiaomi_udp_server> s_udp_server;
+	static boost::shared_ptr<boost::thread> s_udp_thread;
 };
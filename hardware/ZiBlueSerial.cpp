@@ -24,7 +24,7 @@ bool CZiBlueSerial::StartHardware()
 	m_retrycntr=ZiBlue_RETRY_DELAY*5; //will force reconnect first thing
 
 	//Start worker thread
-	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CZiBlueSerial::Do_Work, this)));
+	m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CZiBlueSerial::Do_Work, this)));
 
 	return (m_thread!=NULL);
 }
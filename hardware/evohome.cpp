@@ -192,7 +192,7 @@ bool CEvohome::StartHardware()
 		}
 		
 		//Start worker thread
-		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CEvohome::Do_Work, this)));
+		m_thread = boost::shared_ptr<boost::thread>(new boost::thread(GetWorkerThreadAttributes(), boost::bind(&CEvohome::Do_Work, this)));
 
 		return (m_thread!=NULL);
 	}
@@ -29,6 +29,7 @@
 #include "DelayedLink.h"
 
 #define MINIMUM_PYTHON_VERSION "3.4.0"
+#define DEFAULT_WORKER_THREADS 1
 
 #define ATTRIBUTE_VALUE(pElement, Name, Value) \
 		{	\
@@ -58,14 +59,104 @@ namespace Plugins {
 	std::queue<CPluginMessage*>	PluginMessageQueue;
 	boost::asio::io_service ios;
 
+	PyThreadState*	PythonMainThreadState = NULL;	// main interpreter, used to get the GIL when creating a plugin interpreter
+
 	std::map<int, CDomoticzHardwareBase*>	CPluginSystem::m_pPlugins;
 	std::map<std::string, std::string>		CPluginSystem::m_PluginXml;
 
+	//
+	//	Handles the messages of one or more plugins on its own thread.
+	//	Python callbacks hold the GIL only while running, so a plugin that blocks (sleep, socket I/O)
+	//	no longer delays the plugins that are handled by other workers
+	//
+	class CPluginWorker
+	{
+	public:
+		CPluginWorker(const int WorkerID) : m_WorkerID(WorkerID), m_stoprequested(false) {};
+		~CPluginWorker(void) {};
+
+		void Start()
+		{
+			m_stoprequested = false;
+			m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CPluginWorker::Do_Work, this)));
+		}
+		void Stop()
+		{
+			{
+				boost::lock_guard<boost::mutex> l(m_mutex);
+				m_stoprequested = true;
+				m_cond.notify_all();
+			}
+			if (m_thread)
+			{
+				m_thread->join();
+				m_thread.reset();
+			}
+			while (!m_queue.empty())
+			{
+				delete m_queue.front();
+				m_queue.pop();
+			}
+		}
+		void Queue(CPluginMessage* Message)
+		{
+			boost::lock_guard<boost::mutex> l(m_mutex);
+			m_queue.push(Message);
+			m_cond.notify_all();
+		}
+	private:
+		void Do_Work()
+		{
+			while (true)
+			{
+				CPluginMessage* Message = NULL;
+				{
+					boost::unique_lock<boost::mutex> lock(m_mutex);
+					while (!m_stoprequested && m_queue.empty())
+					{
+						m_cond.wait(lock);
+					}
+					if (m_stoprequested)
+						break;
+					Message = m_queue.front();
+					m_queue.pop();
+				}
+
+				CPlugin*	pPlugin = NULL;
+				{
+					boost::lock_guard<boost::mutex> l(PluginMutex);
+					CPluginSystem Plugins;
+					std::map<int, CDomoticzHardwareBase*>* pPlugins = Plugins.GetHardware();
+					std::map<int, CDomoticzHardwareBase*>::iterator itt = pPlugins->find(Message->m_HwdID);
+					if (itt != pPlugins->end())
+						pPlugin = (CPlugin*)itt->second;
+				}
+				if (pPlugin)
+				{
+					pPlugin->HandleMessage(Message);
+				}
+				else
+				{
+					_log.Log(LOG_ERROR, "PluginSystem: Plugin for Hardware %d not found in Plugins map.", Message->m_HwdID);
+				}
+				delete Message;
+			}
+		}
+
+		int m_WorkerID;
+		std::queue<CPluginMessage*> m_queue;
+		boost::mutex m_mutex;
+		boost::condition_variable m_cond;
+		volatile bool m_stoprequested;
+		boost::shared_ptr<boost::thread> m_thread;
+	};
+
 	CPluginSystem::CPluginSystem() : m_stoprequested(false)
 	{
 		m_bEnabled = false;
 		m_bAllPluginsStarted = false;
 		m_iPollInterval = 10;
+		m_iWorkerThreads = DEFAULT_WORKER_THREADS;
 	}
 
 	CPluginSystem::~CPluginSystem(void)
@@ -92,6 +183,11 @@ namespace Plugins {
 		// Pull UI elements from plugins and create manifest map in memory
 		BuildManifest();
 
+		m_iWorkerThreads = DEFAULT_WORKER_THREADS;
+		m_sql.GetPreferencesVar("PythonPluginThreads", m_iWorkerThreads);
+		if (m_iWorkerThreads < 0)
+			m_iWorkerThreads = DEFAULT_WORKER_THREADS;
+
 		m_thread = new boost::thread(boost::bind(&CPluginSystem::Do_Work, this));
 
 		std::string sVersion(Py_GetVersion());
@@ -121,8 +217,15 @@ namespace Plugins {
 
 			Py_Initialize();
 
+			// Plugins run on worker threads, create the GIL and release it so the workers can take it
+			PyEval_InitThreads();
+			PythonMainThreadState = PyEval_SaveThread();
+
 			m_bEnabled = true;
-			_log.Log(LOG_STATUS, "PluginSystem: Started, Python version '%s'.", sVersion.c_str());
+			if (m_iWorkerThreads == 0)
+				_log.Log(LOG_STATUS, "PluginSystem: Started, Python version '%s', one thread per plugin.", sVersion.c_str());
+			else
+				_log.Log(LOG_STATUS, "PluginSystem: Started, Python version '%s', %d plugin thread(s).", sVersion.c_str(), m_iWorkerThreads);
 		}
 		catch (...) {
 			_log.Log(LOG_ERROR, "PluginSystem: Failed to start, Python version '%s', Program '%S', Path '%S'.", sVersion.c_str(), Py_GetProgramFullPath(), Py_GetPath());
@@ -255,52 +358,43 @@ namespace Plugins {
 				}
 			}
 
+			// Hand the messages that are ready to the worker of their plugin, messages for the same plugin stay in order
 			time_t	Now = time(0);
-			bool	bProcessed = true;
-			while (bProcessed)
+			std::vector<CPluginMessage*>	vReady;
 			{
-				CPluginMessage* Message = NULL;
-				bProcessed = false;
-
-				// Cycle once through the queue looking for the 1st message that is ready to process
-				for (size_t i = 0; i < PluginMessageQueue.size(); i++)
+				boost::lock_guard<boost::mutex> l(PluginMutex);
+				size_t	iCount = PluginMessageQueue.size();
+				for (size_t i = 0; i < iCount; i++)
 				{
-					boost::lock_guard<boost::mutex> l(PluginMutex);
 					CPluginMessage* FrontMessage = PluginMessageQueue.front();
 					PluginMessageQueue.pop();
 					if (FrontMessage->m_When <= Now)
 					{
 						// Message is ready now or was already ready (this is the case for almost all messages)
-						Message = FrontMessage;
-						break;
+						vReady.push_back(FrontMessage);
+						continue;
 					}
 					// Message is for sometime in the future so requeue it (this happens when the 'Delay' parameter is used on a Send)
 					PluginMessageQueue.push(FrontMessage);
 				}
+			}
 
-				if (Message && Message->m_Type != PMT_NULL)
+			for (std::vector<CPluginMessage*>::iterator itt = vReady.begin(); itt != vReady.end(); ++itt)
+			{
+				CPluginMessage* Message = *itt;
+				if (Message->m_Type == PMT_NULL)
 				{
-					bProcessed = true;
-					if (!m_pPlugins.count(Message->m_HwdID))
-					{
-						_log.Log(LOG_ERROR, "PluginSystem: Unknown hardware in message: %d.", Message->m_HwdID);
-					}
-					else
-					{
-						CPlugin*	pPlugin = (CPlugin*)m_pPlugins[Message->m_HwdID];
-						if (pPlugin)
-						{
-							pPlugin->HandleMessage(Message);
-						}
-						else
-						{
-							_log.Log(LOG_ERROR, "PluginSystem: Plugin for Hardware %d not found in Plugins map.", Message->m_HwdID);
-						}
-
-					}
+					delete Message;
+				}
+				else if (!m_pPlugins.count(Message->m_HwdID))
+				{
+					_log.Log(LOG_ERROR, "PluginSystem: Unknown hardware in message: %d.", Message->m_HwdID);
+					delete Message;
+				}
+				else
+				{
+					GetWorker(Message->m_HwdID)->Queue(Message);
 				}
-				// Free the memory for the message
-				if (Message) delete Message;
 			}
 			sleep_milliseconds(50);
 		}
@@ -308,6 +402,32 @@ namespace Plugins {
 		_log.Log(LOG_STATUS, "PluginSystem: Exiting work loop.");
 	}
 
+	CPluginWorker* CPluginSystem::GetWorker(const int HwdID)
+	{
+		int	iWorkerID = HwdID;
+		if (m_iWorkerThreads > 0)
+			iWorkerID = HwdID % m_iWorkerThreads;
+
+		std::map<int, CPluginWorker*>::iterator itt = m_workers.find(iWorkerID);
+		if (itt != m_workers.end())
+			return itt->second;
+
+		CPluginWorker*	pWorker = new CPluginWorker(iWorkerID);
+		m_workers[iWorkerID] = pWorker;
+		pWorker->Start();
+		return pWorker;
+	}
+
+	void CPluginSystem::StopWorkers()
+	{
+		for (std::map<int, CPluginWorker*>::iterator itt = m_workers.begin(); itt != m_workers.end(); ++itt)
+		{
+			itt->second->Stop();
+			delete itt->second;
+		}
+		m_workers.clear();
+	}
+
 	bool CPluginSystem::StopPluginSystem()
 	{
 		m_bAllPluginsStarted = false;
@@ -318,10 +438,16 @@ namespace Plugins {
 			m_thread->join();
 			m_thread = NULL;
 		}
+		StopWorkers();
 
 		if (Py_LoadLibrary())
 		{
 			if (Py_IsInitialized()) {
+				if (PythonMainThreadState)
+				{
+					PyEval_RestoreThread(PythonMainThreadState);
+					PythonMainThreadState = NULL;
+				}
 				Py_Finalize();
 			}
 		}
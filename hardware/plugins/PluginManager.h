@@ -8,12 +8,15 @@ class CDomoticzHardwareBase;
 
 namespace Plugins {
 
+	class CPluginWorker;
+
 	class CPluginSystem
 	{
 	private:
 		bool	m_bEnabled;
 		bool	m_bAllPluginsStarted;
 		int		m_iPollInterval;
+		int		m_iWorkerThreads;	// 0 = thread per plugin, otherwise plugins are divided over this many threads
 
 		static	std::map<int, CDomoticzHardwareBase*>	m_pPlugins;
 		static	std::map<std::string, std::string>		m_PluginXml;
@@ -22,7 +25,11 @@ namespace Plugins {
 		volatile bool m_stoprequested;
 		boost::mutex m_mutex;
 
+		std::map<int, CPluginWorker*>	m_workers;
+
 		void Do_Work();
+		CPluginWorker* GetWorker(const int HwdID);
+		void StopWorkers();
 
 	public:
 		CPluginSystem();
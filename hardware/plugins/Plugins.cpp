@@ -36,6 +36,7 @@ namespace Plugins {
 	extern boost::asio::io_service ios;
 
 	boost::mutex PythonMutex;	// only used during startup when multiple threads could use Python
+	extern PyThreadState*	PythonMainThreadState;
 
 	//
 	//	Holds per plugin state details, specifically plugin object, read using PyModule_GetState(PyObject *module)
@@ -815,6 +816,35 @@ namespace Plugins {
 	}
 
 	void CPlugin::HandleMessage(const CPluginMessage* Message)
+	{
+		// Messages are handled on a plugin system worker thread, take the GIL for the time the message is processed.
+		// Without an interpreter (Initialise) the main thread state is used and only one thread at a time may do that
+		boost::unique_lock<boost::mutex> lock(PythonMutex, boost::defer_lock);
+		PyThreadState*	pInterpreter = (PyThreadState*)m_PyInterpreter;
+		if (pInterpreter)
+		{
+			PyEval_RestoreThread(pInterpreter);
+		}
+		else
+		{
+			lock.lock();
+			PyEval_RestoreThread(PythonMainThreadState);
+		}
+
+		ProcessMessage(Message);
+
+		if (pInterpreter && !m_PyInterpreter)
+		{
+			// Interpreter has been ended, there is no thread state left to save
+			PyEval_ReleaseLock();
+		}
+		else
+		{
+			PyEval_SaveThread();
+		}
+	}
+
+	void CPlugin::ProcessMessage(const CPluginMessage* Message)
 	{
 		std::string sHandler = "";
 		PyObject* pParams = NULL;
@@ -1055,7 +1085,6 @@ namespace Plugins {
 
 		try
 		{
-			if (m_PyInterpreter) PyEval_RestoreThread((PyThreadState*)m_PyInterpreter);
 			if (m_PyModule && sHandler.length())
 			{
 				PyObject*	pFunc = PyObject_GetAttrString((PyObject*)m_PyModule, sHandler.c_str());
@@ -1112,7 +1141,6 @@ namespace Plugins {
 	{
 		m_bIsStarted = false;
 
-		boost::lock_guard<boost::mutex> l(PythonMutex);
 		m_PyInterpreter = Py_NewInterpreter();
 		if (!m_PyInterpreter)
 		{
@@ -32,6 +32,7 @@ namespace Plugins {
 		bool StopHardware();
 		void LogPythonException();
 		void LogPythonException(const std::string &);
+		void ProcessMessage(const CPluginMessage* Message);
 		bool HandleInitialise();
 		bool HandleStart();
 		bool LoadSettings();
@@ -4,6 +4,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <algorithm>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "../main/localtime_r.h"
 
 #ifndef O_LARGEFILE
 	#define O_LARGEFILE 0
@@ -23,6 +28,17 @@ size_t write_curl_data(void *contents, size_t size, size_t nmemb, void *userp) {
 	return realsize;
 }
 
+size_t write_curl_headerdata(void *contents, size_t size, size_t nmemb, void *userp) {
+	size_t realsize = size * nmemb;
+	std::vector<std::string>* pvHeaderData = (std::vector<std::string>*)userp;
+	std::string szLine((const char*)contents, realsize);
+	while ((!szLine.empty()) && ((szLine[szLine.size() - 1] == '\n') || (szLine[szLine.size() - 1] == '\r')))
+		szLine.erase(szLine.size() - 1);
+	if (!szLine.empty())
+		pvHeaderData->push_back(szLine);
+	return realsize;
+}
+
 size_t write_curl_data_file(void *contents, size_t size, size_t nmemb, void *userp) {
 	size_t realsize = size * nmemb;
 	std::ofstream *outfile=(std::ofstream*)userp;
@@ -84,6 +100,12 @@ void HTTPClient::SetUserAgent(const std::string &useragent)
 }
 
 bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, const int TimeOut)
+{
+	std::vector<std::string> ResponseHeaders;
+	return GETBinary(url, ExtraHeaders, response, ResponseHeaders, TimeOut);
+}
+
+bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, std::vector<std::string> &ResponseHeaders, const int TimeOut)
 {
 	try
 	{
@@ -114,6 +136,8 @@ bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string
 		}
 
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
+		curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, write_curl_headerdata);
+		curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)&ResponseHeaders);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 		res = curl_easy_perform(curl);
 		curl_easy_cleanup(curl);
@@ -165,7 +189,7 @@ bool HTTPClient::GETBinaryToFile(const std::string &url, const std::string &outp
 	}
 }
 
-bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, const bool bFollowRedirect)
+bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, const bool bFollowRedirect, const int TimeOut)
 {
 	try
 	{
@@ -181,6 +205,10 @@ bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata,
 		{
 			curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 0L);
 		}
+		if (TimeOut != -1)
+		{
+			curl_easy_setopt(curl, CURLOPT_TIMEOUT, TimeOut);
+		}
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 		curl_easy_setopt(curl, CURLOPT_POST, 1);
@@ -336,11 +364,148 @@ bool HTTPClient::GET(const std::string &url, const std::vector<std::string> &Ext
 	return true;
 }
 
-bool HTTPClient::POST(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::string &response, const bool bFollowRedirect)
+//Shared response cache for GETCached
+//Result of a fetch that is in progress, the waiting threads keep it alive, the cache entry itself can be removed meanwhile
+struct _tHTTPFetchResult
+{
+	std::string response;
+	bool bOK;
+	bool bDone;
+	_tHTTPFetchResult() : bOK(false), bDone(false) {};
+};
+struct _tHTTPCacheEntry
+{
+	std::string response;
+	bool bOK;
+	time_t expires;
+	boost::shared_ptr<_tHTTPFetchResult> pFetch;	//set while the resource is fetched
+	_tHTTPCacheEntry() : bOK(false), expires(0) {};
+};
+static std::map<std::string, _tHTTPCacheEntry> m_HTTPCache;
+static boost::mutex m_HTTPCacheMutex;
+static boost::condition_variable m_HTTPCacheCondition;
+
+bool HTTPClient::GETCached(const std::string &url, std::string &response, const int MaxAge)
+{
+	std::vector<std::string> ExtraHeaders;
+	return GETCached(url, ExtraHeaders, response, MaxAge);
+}
+
+bool HTTPClient::GETCached(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::string &response, const int MaxAge)
+{
+	response = "";
+	//Requests with different headers (for example authorization) do not share a response
+	std::string szKey = url;
+	std::vector<std::string>::const_iterator itt;
+	for (itt = ExtraHeaders.begin(); itt != ExtraHeaders.end(); ++itt)
+		szKey += "\n" + *itt;
+
+	boost::unique_lock<boost::mutex> lock(m_HTTPCacheMutex);
+	std::map<std::string, _tHTTPCacheEntry>::iterator ittCache = m_HTTPCache.find(szKey);
+	if ((ittCache != m_HTTPCache.end()) && (ittCache->second.pFetch))
+	{
+		//Another thread is fetching this resource, share its result
+		boost::shared_ptr<_tHTTPFetchResult> pFetch = ittCache->second.pFetch;
+		while (!pFetch->bDone)
+			m_HTTPCacheCondition.wait(lock);
+		response = pFetch->response;
+		return pFetch->bOK;
+	}
+	time_t atime = mytime(NULL);
+	if ((ittCache != m_HTTPCache.end()) && (ittCache->second.bOK) && (atime < ittCache->second.expires))
+	{
+		response = ittCache->second.response;
+		return true;
+	}
+	boost::shared_ptr<_tHTTPFetchResult> pFetch(new _tHTTPFetchResult());
+	m_HTTPCache[szKey].pFetch = pFetch;
+	lock.unlock();
+
+	std::vector<unsigned char> vHTTPResponse;
+	std::vector<std::string> ResponseHeaders;
+	bool bOK = GETBinary(url, ExtraHeaders, vHTTPResponse, ResponseHeaders);
+	int iMaxAge = 0;
+	if (bOK)
+	{
+		iMaxAge = GetCacheMaxAge(ResponseHeaders, MaxAge);
+		if (iMaxAge < 0)
+			bOK = false; //HTTP error
+		else if (vHTTPResponse.empty())
+			bOK = false;
+		else
+			response.insert(response.begin(), vHTTPResponse.begin(), vHTTPResponse.end());
+	}
+
+	lock.lock();
+	atime = mytime(NULL);
+	//Remove expired entries
+	ittCache = m_HTTPCache.begin();
+	while (ittCache != m_HTTPCache.end())
+	{
+		if ((!ittCache->second.pFetch) && (atime >= ittCache->second.expires))
+			m_HTTPCache.erase(ittCache++);
+		else
+			++ittCache;
+	}
+	//Responses that may not be cached are only shared with the threads that are waiting
+	if ((bOK) && (iMaxAge > 0))
+	{
+		_tHTTPCacheEntry &entry = m_HTTPCache[szKey];
+		entry.response = response;
+		entry.bOK = true;
+		entry.expires = atime + iMaxAge;
+		entry.pFetch.reset();
+	}
+	else
+		m_HTTPCache.erase(szKey);
+	pFetch->response = response;
+	pFetch->bOK = bOK;
+	pFetch->bDone = true;
+	m_HTTPCacheCondition.notify_all();
+	return bOK;
+}
+
+//Returns the number of seconds a response may be cached, or -1 when the server returned an error
+int HTTPClient::GetCacheMaxAge(const std::vector<std::string> &ResponseHeaders, const int MaxAge)
+{
+	int iMaxAge = MaxAge;
+	int iStatus = 200;
+	std::vector<std::string>::const_iterator itt;
+	for (itt = ResponseHeaders.begin(); itt != ResponseHeaders.end(); ++itt)
+	{
+		std::string szHeader = *itt;
+		std::transform(szHeader.begin(), szHeader.end(), szHeader.begin(), ::tolower);
+		if (szHeader.find("http/") == 0)
+		{
+			//status line, there could be more then one when we followed a redirect
+			size_t pos = szHeader.find(' ');
+			if (pos != std::string::npos)
+				iStatus = atoi(szHeader.substr(pos + 1).c_str());
+			iMaxAge = MaxAge;
+		}
+		else if (szHeader.find("cache-control:") == 0)
+		{
+			if ((szHeader.find("no-store") != std::string::npos) || (szHeader.find("no-cache") != std::string::npos))
+				iMaxAge = 0;
+			size_t pos = szHeader.find("max-age=");
+			if (pos != std::string::npos)
+			{
+				int iServerMaxAge = atoi(szHeader.substr(pos + 8).c_str());
+				if (iServerMaxAge < iMaxAge)
+					iMaxAge = iServerMaxAge;
+			}
+		}
+	}
+	if ((iStatus < 200) || (iStatus >= 300))
+		return -1;
+	return iMaxAge;
+}
+
+bool HTTPClient::POST(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::string &response, const bool bFollowRedirect, const int TimeOut)
 {
 	response = "";
 	std::vector<unsigned char> vHTTPResponse;
-	if (!POSTBinary(url,postdata,ExtraHeaders, vHTTPResponse, bFollowRedirect))
+	if (!POSTBinary(url,postdata,ExtraHeaders, vHTTPResponse, bFollowRedirect, TimeOut))
 		return false;
 	if (vHTTPResponse.empty())
 		return true; //empty response possible
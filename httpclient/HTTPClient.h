@@ -9,12 +9,18 @@ public:
 	static bool GET(const std::string &url, std::string &response, const bool bIgnoreNoDataReturned = false);
 	static bool GET(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::string &response);
 	static bool GETBinary(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, const int TimeOut = -1);
+	static bool GETBinary(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, std::vector<std::string> &ResponseHeaders, const int TimeOut = -1);
+
+	//Cached GET functions, the response is shared between callers for at most MaxAge seconds (or less when the server says so with Cache-Control)
+	//Simultaneous requests for the same resource result in a single fetch
+	static bool GETCached(const std::string &url, std::string &response, const int MaxAge);
+	static bool GETCached(const std::string &url, const std::vector<std::string> &ExtraHeaders, std::string &response, const int MaxAge);
 
 	static bool GETBinaryToFile(const std::string &url, const std::string &outputfile);
 
 	//POST functions, postdata looks like: "name=john&age=123&country=this"
-	static bool POST(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::string &response, const bool bFollowRedirect=true);
-	static bool POSTBinary(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, const bool bFollowRedirect = true);
+	static bool POST(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::string &response, const bool bFollowRedirect=true, const int TimeOut = -1);
+	static bool POSTBinary(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::vector<unsigned char> &response, const bool bFollowRedirect = true, const int TimeOut = -1);
 
 	//PUT functions, postdata looks like: "name=john&age=123&country=this"
 	static bool PUT(const std::string &url, const std::string &postdata, const std::vector<std::string> &ExtraHeaders, std::string &response);
@@ -34,6 +40,7 @@ public:
 private:
 	static void SetGlobalOptions(void *curlobj);
 	static bool CheckIfGlobalInitDone();
+	static int GetCacheMaxAge(const std::vector<std::string> &ResponseHeaders, const int MaxAge);
 	//our static variables
 	static bool	m_bCurlGlobalInitialized;
 	static long	m_iConnectionTimeout;
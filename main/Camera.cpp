@@ -14,6 +14,8 @@
 #include "../json/json.h"
 
 #define CAMERA_POLL_INTERVAL 30
+//Viewers requesting a snapshot within this time get the last fetched image
+#define CAMERA_FRAME_CACHE_TIME 1000
 
 extern std::string szUserDataFolder;
 
@@ -31,6 +33,7 @@ void CCameraHandler::ReloadCameras()
 	std::vector<std::string> _AddedCameras;
 	boost::lock_guard<boost::mutex> l(m_mutex);
 	m_cameradevices.clear();
+	m_frames.clear();
 	std::vector<std::vector<std::string> > result;
 	std::vector<std::vector<std::string> >::const_iterator itt;
 
@@ -179,6 +182,8 @@ bool CCameraHandler::TakeRaspberrySnapshot(std::vector<unsigned char> &camimage)
 	std::string raspparams="-w 800 -h 600 -t 1";
 	m_sql.GetPreferencesVar("RaspCamParams", raspparams);
 
+	//raspistill and uvccapture share the same temporary file
+	boost::lock_guard<boost::mutex> l(m_localCaptureMutex);
 	std::string OutputFileName = szUserDataFolder + "tempcam.jpg";
 
 	std::string raspistillcmd="raspistill " + raspparams + " -o " + OutputFileName;
@@ -221,6 +226,7 @@ bool CCameraHandler::TakeUVCSnapshot(const std::string &device, std::vector<unsi
 	std::string uvcparams="-S80 -B128 -C128 -G80 -x800 -y600 -q100";
 	m_sql.GetPreferencesVar("UVCParams", uvcparams);
 
+	boost::lock_guard<boost::mutex> l(m_localCaptureMutex);
 	std::string OutputFileName = szUserDataFolder + "tempcam.jpg";
 	std::string nvcmd="uvccapture " + uvcparams+ " -o" + OutputFileName;
 	if (!device.empty()) {
@@ -259,43 +265,70 @@ bool CCameraHandler::TakeUVCSnapshot(const std::string &device, std::vector<unsi
 	return false;
 }
 
+//Only one fetch per camera is done at a time, other viewers of the same camera
+//wait for it and share the image. Different cameras are fetched in parallel.
 bool CCameraHandler::TakeSnapshot(const uint64_t CamID, std::vector<unsigned char> &camimage)
 {
-	boost::lock_guard<boost::mutex> l(m_mutex);
+	cameraDevice camera;
+	boost::shared_ptr<_tCameraFrame> pFrame;
+	{
+		boost::lock_guard<boost::mutex> l(m_mutex);
+		cameraDevice *pCamera = GetCamera(CamID);
+		if (pCamera == NULL)
+			return false;
+		camera = *pCamera;
+		std::map<uint64_t, boost::shared_ptr<_tCameraFrame> >::iterator itt = m_frames.find(CamID);
+		if (itt == m_frames.end())
+			itt = m_frames.insert(std::make_pair(CamID, boost::shared_ptr<_tCameraFrame>(new _tCameraFrame()))).first;
+		pFrame = itt->second;
+	}
 
-	cameraDevice *pCamera=GetCamera(CamID);
-	if (pCamera==NULL)
+	boost::lock_guard<boost::mutex> l(pFrame->fetchMutex);
+	boost::posix_time::ptime now = boost::get_system_time();
+	if ((pFrame->bValid) && (now - pFrame->fetchTime < boost::posix_time::milliseconds(CAMERA_FRAME_CACHE_TIME)))
+	{
+		camimage = pFrame->image;
+		return true;
+	}
+	pFrame->bValid = false;
+	pFrame->image.clear();
+	if (!FetchSnapshot(camera, pFrame->image))
 		return false;
+	pFrame->fetchTime = boost::get_system_time();
+	pFrame->bValid = true;
+	camimage = pFrame->image;
+	return true;
+}
 
-	std::string szURL=GetCameraURL(pCamera);
-	szURL+="/" + pCamera->ImageURL;
-	stdreplace(szURL, "#USERNAME", pCamera->Username);
-	stdreplace(szURL, "#PASSWORD", pCamera->Password);
-
-	if (pCamera->ImageURL=="raspberry.cgi")
+bool CCameraHandler::FetchSnapshot(const cameraDevice &camera, std::vector<unsigned char> &camimage)
+{
+	if (camera.ImageURL == "raspberry.cgi")
 		return TakeRaspberrySnapshot(camimage);
-	else if (pCamera->ImageURL=="uvccapture.cgi")
-		return TakeUVCSnapshot(pCamera->Username, camimage);
+	else if (camera.ImageURL == "uvccapture.cgi")
+		return TakeUVCSnapshot(camera.Username, camimage);
+
+	cameraDevice tmpcamera = camera;
+	std::string szURL = GetCameraURL(&tmpcamera);
+	szURL += "/" + camera.ImageURL;
+	stdreplace(szURL, "#USERNAME", camera.Username);
+	stdreplace(szURL, "#PASSWORD", camera.Password);
 
 	std::vector<std::string> ExtraHeaders;
-	return HTTPClient::GETBinary(szURL,ExtraHeaders,camimage,5);
+	return HTTPClient::GETBinary(szURL, ExtraHeaders, camimage, 5);
 }
 
+//Split in lines of lsize characters, in one pass
 std::string WrapBase64(const std::string &szSource, const size_t lsize=72)
 {
-	std::string cstring = szSource;
-	std::string ret = "";
-	while (cstring.size() > lsize)
+	std::string ret;
+	if (szSource.empty())
+		return ret;
+	ret.reserve(szSource.size() + (szSource.size() / lsize) + 1);
+	for (size_t pos = 0; pos < szSource.size(); pos += lsize)
 	{
-		std::string pstring = cstring.substr(0, lsize);
-		if (!ret.empty())
-			ret += "\n";
-		ret += pstring;
-		cstring = cstring.substr(lsize);
-	}
-	if (!cstring.empty())
-	{
-		ret += "\n" + cstring;
+		if (pos != 0)
+			ret += '\n';
+		ret.append(szSource, pos, lsize);
 	}
 	return ret;
 }
@@ -349,12 +382,9 @@ bool CCameraHandler::EmailCameraSnapshot(const std::string &CamIdx, const std::s
       if (!TakeSnapshot(*camIt, camimage))
          return false;
 
-      std::vector<char> filedata;
-	   filedata.insert(filedata.begin(),camimage.begin(),camimage.end());
-   	std::string imgstring;
-   	imgstring.insert(imgstring.end(),filedata.begin(),filedata.end());
-   	imgstring=base64_encode((const unsigned char*)imgstring.c_str(),filedata.size());
-   	imgstring = WrapBase64(imgstring);
+      if (camimage.empty())
+         return false;
+   	std::string imgstring = WrapBase64(base64_encode(&camimage[0], camimage.size()));
 
    	htmlMsg+=
    		"<img src=\"data:image/jpeg;base64,";
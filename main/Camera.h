@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 struct cameraActiveDevice
 {
@@ -24,6 +25,15 @@ struct cameraDevice
 
 class CCameraHandler
 {
+	//Last image of a camera, shared between all viewers
+	struct _tCameraFrame
+	{
+		boost::mutex fetchMutex;
+		std::vector<unsigned char> image;
+		boost::posix_time::ptime fetchTime;
+		bool bValid;
+		_tCameraFrame() : bValid(false) {};
+	};
 public:
 	CCameraHandler(void);
 	~CCameraHandler(void);
@@ -45,9 +55,12 @@ public:
 	std::string GetCameraURL(const uint64_t CamID);
 private:
 	void ReloadCameraActiveDevices(const std::string &CamID);
+	bool FetchSnapshot(const cameraDevice &camera, std::vector<unsigned char> &camimage);
 
 	boost::mutex m_mutex;
+	boost::mutex m_localCaptureMutex;
 	unsigned char m_seconds_counter;
 	std::vector<cameraDevice> m_cameradevices;
+	std::map<uint64_t, boost::shared_ptr<_tCameraFrame> > m_frames;
 };
 
@@ -9,6 +9,7 @@
 #include "../hardware/Kodi.h"
 #include "../hardware/LogitechMediaServer.h"
 #include <iostream>
+#include <fstream>
 #include "../httpclient/HTTPClient.h"
 #include "../httpclient/UrlEncode.h"
 #include "localtime_r.h"
@@ -19,6 +20,14 @@
 #include "../json/json.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#ifndef WIN32
+#include <time.h>
+#endif
+
+#define LUA_DEFAULT_TIMEOUT 10			//seconds of CPU time
+#define LUA_WALLCLOCK_FACTOR 6			//a script may run this many times its CPU budget, waiting included
+#define LUA_WALLCLOCK_MIN 60			//seconds, minimum run time before the wall clock stops a script
+#define LUA_WATCHDOG_INSTRUCTIONS 10000	//the run time is checked every .. instructions
 
 extern "C" {
 #ifdef WITH_EXTERNAL_LUA
@@ -46,6 +55,10 @@ CEventSystem::CEventSystem(void)
 {
 	m_stoprequested = false;
 	m_bEnabled = true;
+	m_measurementStatesDay = 0;
+	m_LuaTimeout = LUA_DEFAULT_TIMEOUT;
+	m_LuaRuns = 0;
+	m_LuaTimeouts = 0;
 }
 
 
@@ -68,6 +81,9 @@ void CEventSystem::StartEventSystem()
 		return;
 
 	m_sql.GetPreferencesVar("SecStatus", m_SecStatus);
+	int LuaTimeout = LUA_DEFAULT_TIMEOUT;
+	m_sql.GetPreferencesVar("LuaScriptTimeout", LuaTimeout);
+	SetLuaTimeout(LuaTimeout);
 
 	LoadEvents();
 	GetCurrentStates();
@@ -146,9 +162,7 @@ void CEventSystem::LoadEvents()
 
 		}
 	}
-#ifdef _DEBUG
-		_log.Log(LOG_STATUS, "EventSystem: Events (re)loaded");
-#endif
+	_log.Log(LOGCAT_EVENTSYSTEM, LOG_TRACE, "EventSystem: Events (re)loaded");
 }
 
 void CEventSystem::Do_Work()
@@ -274,6 +288,10 @@ void CEventSystem::GetCurrentStates()
 			m_devicestates[sitem.ID] = sitem;
 		}
 	}
+	devicestatesMutexLock.unlock();
+
+	boost::lock_guard<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
+	GetCurrentMeasurementStates();
 }
 
 void CEventSystem::GetCurrentUserVariables()
@@ -336,6 +354,80 @@ void CEventSystem::GetCurrentScenesGroups()
 	}
 }
 
+//Approximate number of bytes for the cached device, variable and measurement states
+template <typename K, typename T>
+static size_t MapMemoryUsage(const std::map<K, T> &states)
+{
+	//key + value + red/black tree node overhead
+	return states.size() * (sizeof(K) + sizeof(T) + 4 * sizeof(void*));
+}
+
+static size_t NameMapMemoryUsage(const std::map<std::string, float> &states)
+{
+	size_t nBytes = MapMemoryUsage(states);
+	std::map<std::string, float>::const_iterator itt;
+	for (itt = states.begin(); itt != states.end(); ++itt)
+		nBytes += itt->first.capacity();
+	return nBytes;
+}
+
+size_t CEventSystem::GetMemoryUsage(size_t &nItems)
+{
+	size_t nBytes = 0;
+	nItems = 0;
+	{
+		boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+		nBytes += MapMemoryUsage(m_devicestates);
+		std::map<uint64_t, _tDeviceStatus>::const_iterator itt;
+		for (itt = m_devicestates.begin(); itt != m_devicestates.end(); ++itt)
+		{
+			nBytes += itt->second.deviceName.capacity() + itt->second.sValue.capacity() + itt->second.nValueWording.capacity() + itt->second.lastUpdate.capacity();
+		}
+		nItems += m_devicestates.size();
+	}
+	{
+		boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(m_uservariablesMutex);
+		nBytes += MapMemoryUsage(m_uservariables);
+		std::map<uint64_t, _tUserVariable>::const_iterator itt;
+		for (itt = m_uservariables.begin(); itt != m_uservariables.end(); ++itt)
+		{
+			nBytes += itt->second.variableName.capacity() + itt->second.variableValue.capacity() + itt->second.lastUpdate.capacity();
+		}
+		nItems += m_uservariables.size();
+	}
+	{
+		boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(m_scenesgroupsMutex);
+		nBytes += MapMemoryUsage(m_scenesgroups);
+		std::map<uint64_t, _tScenesGroups>::const_iterator itt;
+		for (itt = m_scenesgroups.begin(); itt != m_scenesgroups.end(); ++itt)
+		{
+			nBytes += itt->second.scenesgroupName.capacity() + itt->second.scenesgroupValue.capacity() + itt->second.lastUpdate.capacity();
+		}
+		nItems += m_scenesgroups.size();
+	}
+	{
+		boost::lock_guard<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
+		const std::map<std::string, float> *nameMaps[] = {
+			&m_tempValuesByName, &m_dewValuesByName, &m_rainValuesByName, &m_rainLastHourValuesByName, &m_uvValuesByName, &m_weatherValuesByName,
+			&m_baroValuesByName, &m_utilityValuesByName, &m_winddirValuesByName, &m_windspeedValuesByName, &m_windgustValuesByName
+		};
+		for (size_t ii = 0; ii < sizeof(nameMaps) / sizeof(nameMaps[0]); ii++)
+			nBytes += NameMapMemoryUsage(*nameMaps[ii]);
+		const std::map<uint64_t, float> *idMaps[] = {
+			&m_tempValuesByID, &m_dewValuesByID, &m_rainValuesByID, &m_rainLastHourValuesByID, &m_uvValuesByID, &m_weatherValuesByID,
+			&m_baroValuesByID, &m_utilityValuesByID, &m_winddirValuesByID, &m_windspeedValuesByID, &m_windgustValuesByID
+		};
+		for (size_t ii = 0; ii < sizeof(idMaps) / sizeof(idMaps[0]); ii++)
+			nBytes += MapMemoryUsage(*idMaps[ii]);
+		nBytes += MapMemoryUsage(m_humValuesByName) + MapMemoryUsage(m_zwaveAlarmValuesByName);
+		nBytes += MapMemoryUsage(m_humValuesByID) + MapMemoryUsage(m_zwaveAlarmValuesByID);
+		nBytes += MapMemoryUsage(m_measurementStates);
+	}
+	return nBytes;
+}
+
+//Rebuilds the measurement states of all devices
+//(at startup and when the day changes, the counter and rain values are values of today)
 void CEventSystem::GetCurrentMeasurementStates()
 {
 	m_tempValuesByName.clear();
@@ -366,11 +458,32 @@ void CEventSystem::GetCurrentMeasurementStates()
 	m_windgustValuesByID.clear();
 	m_zwaveAlarmValuesByID.clear();
 
-	std::stringstream szQuery;
+	m_measurementStates.clear();
+	m_measurementNames.clear();
+	m_measurementStatesDay = GetMeasurementDay();
+
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+
+	typedef std::map<uint64_t, _tDeviceStatus>::iterator it_type;
+	for (it_type iterator = m_devicestates.begin(); iterator != m_devicestates.end(); ++iterator)
+	{
+		UpdateMeasurementState(iterator->second);
+	}
+}
+
+int CEventSystem::GetMeasurementDay()
+{
+	time_t now = mytime(NULL);
+	struct tm ltime;
+	localtime_r(&now, &ltime);
+	return ltime.tm_mday;
+}
 
-	float EnergyDivider = 1000.0f;
-	float GasDivider = 100.0f;
-	float WaterDivider = 100.0f;
+void CEventSystem::GetMeterDividers(float &EnergyDivider, float &GasDivider, float &WaterDivider)
+{
+	EnergyDivider = 1000.0f;
+	GasDivider = 100.0f;
+	WaterDivider = 100.0f;
 	int tValue;
 	if (m_sql.GetPreferencesVar("MeterDividerEnergy", tValue))
 	{
@@ -384,456 +497,427 @@ void CEventSystem::GetCurrentMeasurementStates()
 	{
 		WaterDivider = float(tValue);
 	}
+}
 
-	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+//Called with m_measurementStatesMutex locked
+void CEventSystem::RemoveMeasurementState(const uint64_t ulDevID)
+{
+	std::map<uint64_t, _tMeasurementState>::iterator itt = m_measurementStates.find(ulDevID);
+	if (itt == m_measurementStates.end())
+		return;
+	std::string deviceName = itt->second.deviceName;
+	m_tempValuesByID.erase(ulDevID);
+	m_dewValuesByID.erase(ulDevID);
+	m_humValuesByID.erase(ulDevID);
+	m_baroValuesByID.erase(ulDevID);
+	m_utilityValuesByID.erase(ulDevID);
+	m_rainValuesByID.erase(ulDevID);
+	m_rainLastHourValuesByID.erase(ulDevID);
+	m_weatherValuesByID.erase(ulDevID);
+	m_uvValuesByID.erase(ulDevID);
+	m_winddirValuesByID.erase(ulDevID);
+	m_windspeedValuesByID.erase(ulDevID);
+	m_windgustValuesByID.erase(ulDevID);
+	m_zwaveAlarmValuesByID.erase(ulDevID);
+	m_measurementStates.erase(itt);
+
+	std::map<std::string, std::set<uint64_t> >::iterator ittName = m_measurementNames.find(deviceName);
+	if (ittName != m_measurementNames.end())
+	{
+		ittName->second.erase(ulDevID);
+		if (ittName->second.empty())
+			m_measurementNames.erase(ittName);
+	}
+	UpdateMeasurementName(deviceName);
+}
 
-	//char szTmp[300];
+//Parses the measurements of one device and replaces its entries in the value tables
+//Called with m_measurementStatesMutex locked
+void CEventSystem::UpdateMeasurementState(const _tDeviceStatus &sitem)
+{
+	RemoveMeasurementState(sitem.ID);
 
-	typedef std::map<uint64_t, _tDeviceStatus>::iterator it_type;
-	for (it_type iterator = m_devicestates.begin(); iterator != m_devicestates.end(); ++iterator)
+	_tMeasurementState mstate;
+	if (!ParseMeasurementState(sitem, mstate))
+		return;
+
+	if (mstate.isTemp)
+		m_tempValuesByID[sitem.ID] = mstate.temp;
+	if (mstate.isDew)
+		m_dewValuesByID[sitem.ID] = mstate.dewpoint;
+	if (mstate.isHum)
+		m_humValuesByID[sitem.ID] = mstate.humidity;
+	if (mstate.isBaro)
+		m_baroValuesByID[sitem.ID] = mstate.barometer;
+	if (mstate.isUtility)
+		m_utilityValuesByID[sitem.ID] = mstate.utilityval;
+	if (mstate.isRain) {
+		m_rainValuesByID[sitem.ID] = mstate.rainmm;
+		m_rainLastHourValuesByID[sitem.ID] = mstate.rainmmlasthour;
+	}
+	if (mstate.isWeather)
+		m_weatherValuesByID[sitem.ID] = mstate.weatherval;
+	if (mstate.isUV)
+		m_uvValuesByID[sitem.ID] = mstate.uv;
+	if (mstate.isWindDir)
+		m_winddirValuesByID[sitem.ID] = mstate.winddir;
+	if (mstate.isWindSpeed)
+		m_windspeedValuesByID[sitem.ID] = mstate.windspeed;
+	if (mstate.isWindGust)
+		m_windgustValuesByID[sitem.ID] = mstate.windgust;
+	if (mstate.isZWaveAlarm)
+		m_zwaveAlarmValuesByID[sitem.ID] = mstate.alarmval;
+	m_measurementStates[sitem.ID] = mstate;
+	m_measurementNames[mstate.deviceName].insert(sitem.ID);
+	UpdateMeasurementName(mstate.deviceName);
+}
+
+//Sets the ByName entries of a name from the devices that have this name. Devices can share a name,
+//like the full rebuild the device with the highest ID provides a value
+//Called with m_measurementStatesMutex locked
+void CEventSystem::UpdateMeasurementName(const std::string &deviceName)
+{
+	m_tempValuesByName.erase(deviceName);
+	m_dewValuesByName.erase(deviceName);
+	m_humValuesByName.erase(deviceName);
+	m_baroValuesByName.erase(deviceName);
+	m_utilityValuesByName.erase(deviceName);
+	m_rainValuesByName.erase(deviceName);
+	m_rainLastHourValuesByName.erase(deviceName);
+	m_weatherValuesByName.erase(deviceName);
+	m_uvValuesByName.erase(deviceName);
+	m_winddirValuesByName.erase(deviceName);
+	m_windspeedValuesByName.erase(deviceName);
+	m_windgustValuesByName.erase(deviceName);
+	m_zwaveAlarmValuesByName.erase(deviceName);
+
+	std::map<std::string, std::set<uint64_t> >::const_iterator ittName = m_measurementNames.find(deviceName);
+	if (ittName == m_measurementNames.end())
+		return;
+	std::set<uint64_t>::const_iterator ittID;
+	for (ittID = ittName->second.begin(); ittID != ittName->second.end(); ++ittID)
 	{
-		_tDeviceStatus sitem = iterator->second;
-		std::vector<std::string> splitresults;
-		StringSplit(sitem.sValue, ";", splitresults);
-
-		float temp = 0;
-		float chill = 0;
-		unsigned char humidity = 0;
-		float barometer = 0;
-		float rainmm = 0;
-		float rainmmlasthour = 0;
-		float uv = 0;
-		float dewpoint = 0;
-		float utilityval = 0;
-		float weatherval = 0;
-		float winddir = 0;
-		float windspeed = 0;
-		float windgust = 0;
-		int alarmval = 0;
-
-		bool isTemp = false;
-		bool isDew = false;
-		bool isHum = false;
-		bool isBaro = false;
-		bool isBaroFloat = false;
-		bool isUtility = false;
-		bool isWeather = false;
-		bool isRain = false;
-		bool isUV = false;
-		bool isWindDir = false;
-		bool isWindSpeed = false;
-		bool isWindGust = false;
-		bool isZWaveAlarm = false;
-
-		szQuery.clear();
-		szQuery.str("");
-
-		switch (sitem.devType)
-		{
-		case pTypeRego6XXTemp:
-		case pTypeTEMP:
+		const _tMeasurementState &mstate = m_measurementStates[*ittID];
+		if (mstate.isTemp)
+			m_tempValuesByName[deviceName] = mstate.temp;
+		if (mstate.isDew)
+			m_dewValuesByName[deviceName] = mstate.dewpoint;
+		if (mstate.isHum)
+			m_humValuesByName[deviceName] = mstate.humidity;
+		if (mstate.isBaro)
+			m_baroValuesByName[deviceName] = mstate.barometer;
+		if (mstate.isUtility)
+			m_utilityValuesByName[deviceName] = mstate.utilityval;
+		if (mstate.isRain) {
+			m_rainValuesByName[deviceName] = mstate.rainmm;
+			m_rainLastHourValuesByName[deviceName] = mstate.rainmmlasthour;
+		}
+		if (mstate.isWeather)
+			m_weatherValuesByName[deviceName] = mstate.weatherval;
+		if (mstate.isUV)
+			m_uvValuesByName[deviceName] = mstate.uv;
+		if (mstate.isWindDir)
+			m_winddirValuesByName[deviceName] = mstate.winddir;
+		if (mstate.isWindSpeed)
+			m_windspeedValuesByName[deviceName] = mstate.windspeed;
+		if (mstate.isWindGust)
+			m_windgustValuesByName[deviceName] = mstate.windgust;
+		if (mstate.isZWaveAlarm)
+			m_zwaveAlarmValuesByName[deviceName] = mstate.alarmval;
+	}
+}
+
+//Updates the measurement state of a device from its current entry in m_devicestates. The device is read
+//under both locks, so concurrent updates of one device always leave the latest state in the tables.
+//m_measurementStatesMutex is always taken before m_devicestatesMutex
+void CEventSystem::RefreshMeasurementState(const uint64_t ulDevID)
+{
+	boost::lock_guard<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+	std::map<uint64_t, _tDeviceStatus>::const_iterator itt = m_devicestates.find(ulDevID);
+	if (itt != m_devicestates.end())
+		UpdateMeasurementState(itt->second);
+	else
+		RemoveMeasurementState(ulDevID);
+}
+
+bool CEventSystem::ParseMeasurementState(const _tDeviceStatus &sitem, _tMeasurementState &mstate)
+{
+	std::vector<std::string> splitresults;
+	StringSplit(sitem.sValue, ";", splitresults);
+
+	float temp = 0;
+	float chill = 0;
+	unsigned char humidity = 0;
+	float barometer = 0;
+	float rainmm = 0;
+	float rainmmlasthour = 0;
+	float uv = 0;
+	float dewpoint = 0;
+	float utilityval = 0;
+	float weatherval = 0;
+	float winddir = 0;
+	float windspeed = 0;
+	float windgust = 0;
+	int alarmval = 0;
+
+	bool isTemp = false;
+	bool isDew = false;
+	bool isHum = false;
+	bool isBaro = false;
+	bool isBaroFloat = false;
+	bool isUtility = false;
+	bool isWeather = false;
+	bool isRain = false;
+	bool isUV = false;
+	bool isWindDir = false;
+	bool isWindSpeed = false;
+	bool isWindGust = false;
+	bool isZWaveAlarm = false;
+
+	switch (sitem.devType)
+	{
+	case pTypeRego6XXTemp:
+	case pTypeTEMP:
+		if (!splitresults.empty())
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			isTemp = true;
+		}
+		break;
+	case pTypeThermostat:
+		if (sitem.subType == sTypeThermTemperature)
+		{
 			if (!splitresults.empty())
 			{
 				temp = static_cast<float>(atof(splitresults[0].c_str()));
 				isTemp = true;
 			}
-			break;
-		case pTypeThermostat:
-			if (sitem.subType == sTypeThermTemperature)
-			{
-				if (!splitresults.empty())
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					isTemp = true;
-				}
-			}
-			else
-			{
-				if (!splitresults.empty())
-				{
-					utilityval = static_cast<float>(atof(splitresults[0].c_str()));
-					isUtility = true;
-				}
-			}
-			break;
-		case pTypeThermostat1:
+		}
+		else
+		{
 			if (!splitresults.empty())
 			{
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				isTemp = true;
-			}
-			break;
-		case pTypeHUM:
-			humidity = (unsigned char)sitem.nValue;
-			isHum = true;
-			break;
-		case pTypeTEMP_HUM:
-			if (splitresults.size() > 1)
-			{
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				humidity = atoi(splitresults[1].c_str());
-				dewpoint = (float)CalculateDewPoint(temp, humidity);
-				isTemp = true;
-				isHum = true;
-				isDew = true;
-			}
-			break;
-		case pTypeTEMP_HUM_BARO:
-			if (splitresults.size() < 5) {
-				_log.Log(LOG_ERROR, "EventSystem: TEMP_HUM_BARO missing values : ID=%" PRIu64 ", sValue=%s", sitem.ID, sitem.sValue.c_str());
-				continue;
+				utilityval = static_cast<float>(atof(splitresults[0].c_str()));
+				isUtility = true;
 			}
+		}
+		break;
+	case pTypeThermostat1:
+		if (!splitresults.empty())
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			isTemp = true;
+		}
+		break;
+	case pTypeHUM:
+		humidity = (unsigned char)sitem.nValue;
+		isHum = true;
+		break;
+	case pTypeTEMP_HUM:
+		if (splitresults.size() > 1)
+		{
 			temp = static_cast<float>(atof(splitresults[0].c_str()));
 			humidity = atoi(splitresults[1].c_str());
-			if (sitem.subType == sTypeTHBFloat)
-			{
-				barometer = static_cast<float>(atof(splitresults[3].c_str()));
-				isBaroFloat = true;
-			}
-			else
-			{
-				barometer = static_cast<float>(atof(splitresults[3].c_str()));
-			}
 			dewpoint = (float)CalculateDewPoint(temp, humidity);
 			isTemp = true;
 			isHum = true;
-			isBaro = true;
 			isDew = true;
-			break;
-		case pTypeTEMP_BARO:
-			if (splitresults.size() > 1)
+		}
+		break;
+	case pTypeTEMP_HUM_BARO:
+		if (splitresults.size() < 5) {
+			_log.Log(LOG_ERROR, "EventSystem: TEMP_HUM_BARO missing values : ID=%" PRIu64 ", sValue=%s", sitem.ID, sitem.sValue.c_str());
+			return false;
+		}
+		temp = static_cast<float>(atof(splitresults[0].c_str()));
+		humidity = atoi(splitresults[1].c_str());
+		if (sitem.subType == sTypeTHBFloat)
+		{
+			barometer = static_cast<float>(atof(splitresults[3].c_str()));
+			isBaroFloat = true;
+		}
+		else
+		{
+			barometer = static_cast<float>(atof(splitresults[3].c_str()));
+		}
+		dewpoint = (float)CalculateDewPoint(temp, humidity);
+		isTemp = true;
+		isHum = true;
+		isBaro = true;
+		isDew = true;
+		break;
+	case pTypeTEMP_BARO:
+		if (splitresults.size() > 1)
+		{
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			barometer = static_cast<float>(atof(splitresults[1].c_str()));
+			isTemp = true;
+			isBaro = true;
+		}
+		break;
+	case pTypeBARO:
+		barometer = static_cast<float>(atof(splitresults[0].c_str()));
+		isBaro = true;
+		break;
+	case pTypeRadiator1:
+		if (sitem.subType == sTypeSmartwares)
+		{
+			utilityval = static_cast<float>(atof(sitem.sValue.c_str()));
+			isUtility = true;
+		}
+		break;
+	case pTypeUV:
+		if (splitresults.size() == 2)
+		{
+			uv = static_cast<float>(atof(splitresults[0].c_str()));
+			isUV = true;
+			weatherval = uv;
+			isWeather = true;
+
+			if (sitem.subType == sTypeUV3)
 			{
-				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				barometer = static_cast<float>(atof(splitresults[1].c_str()));
+				temp = static_cast<float>(atof(splitresults[1].c_str()));
 				isTemp = true;
-				isBaro = true;
 			}
-			break;
-		case pTypeBARO:
-			barometer = static_cast<float>(atof(splitresults[0].c_str()));
-			isBaro = true;
-			break;
-		case pTypeRadiator1:
-			if (sitem.subType == sTypeSmartwares)
+		}
+		break;
+	case pTypeWIND:
+		if (splitresults.size() == 6)
+		{
+			winddir = static_cast<float>(atof(splitresults[0].c_str()));
+			isWindDir = true;
+
+			if (sitem.subType != sTypeWIND5)
 			{
-				utilityval = static_cast<float>(atof(sitem.sValue.c_str()));
-				isUtility = true;
+				int intSpeed = atoi(splitresults[2].c_str());
+				windspeed = float(intSpeed) * 0.1f; //m/s
+				isWindSpeed = true;
 			}
-			break;
-		case pTypeUV:
-			if (splitresults.size() == 2)
-			{
-				uv = static_cast<float>(atof(splitresults[0].c_str()));
-				isUV = true;
-				weatherval = uv;
-				isWeather = true;
 
-				if (sitem.subType == sTypeUV3)
-				{
-					temp = static_cast<float>(atof(splitresults[1].c_str()));
-					isTemp = true;
-				}
-			}
-			break;
-		case pTypeWIND:
-			if (splitresults.size() == 6)
+			int intGust = atoi(splitresults[3].c_str());
+			windgust = float(intGust) * 0.1f; //m/s
+			isWindGust = true;
+			if ((windgust == 0) && (windspeed != 0))
 			{
-				winddir = static_cast<float>(atof(splitresults[0].c_str()));
-				isWindDir = true;
-
-				if (sitem.subType != sTypeWIND5)
-				{
-					int intSpeed = atoi(splitresults[2].c_str());
-					windspeed = float(intSpeed) * 0.1f; //m/s
-					isWindSpeed = true;
-				}
-
-				int intGust = atoi(splitresults[3].c_str());
-				windgust = float(intGust) * 0.1f; //m/s
-				isWindGust = true;
-				if ((windgust == 0) && (windspeed != 0))
-				{
-					weatherval = windspeed;
-					isWeather = true;
-				}
-				else
-				{
-					weatherval = windgust;
-					isWeather = true;
-				}
-				if ((sitem.subType == sTypeWIND4) || (sitem.subType == sTypeWINDNoTemp))
-				{
-					temp = static_cast<float>(atof(splitresults[4].c_str()));
-					chill = static_cast<float>(atof(splitresults[5].c_str()));
-					isTemp = true;
-				}
+				weatherval = windspeed;
+				isWeather = true;
 			}
-			break;
-		case pTypeRFXSensor:
-			if (sitem.subType == sTypeRFXSensorTemp)
+			else
 			{
-				if (!splitresults.empty())
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					isTemp = true;
-				}
+				weatherval = windgust;
+				isWeather = true;
 			}
-			else if ((sitem.subType == sTypeRFXSensorVolt) || (sitem.subType == sTypeRFXSensorAD))
+			if ((sitem.subType == sTypeWIND4) || (sitem.subType == sTypeWINDNoTemp))
 			{
-				utilityval = static_cast<float>(atof(sitem.sValue.c_str()));
-				isUtility = true;
+				temp = static_cast<float>(atof(splitresults[4].c_str()));
+				chill = static_cast<float>(atof(splitresults[5].c_str()));
+				isTemp = true;
 			}
-			break;
-		case pTypeAirQuality:
-			utilityval = (float)(sitem.nValue);
-			isUtility = true;
-			break;
-		case pTypeENERGY:
+		}
+		break;
+	case pTypeRFXSensor:
+		if (sitem.subType == sTypeRFXSensorTemp)
+		{
 			if (!splitresults.empty())
 			{
-				if (splitresults.size() == 2)
-					utilityval = static_cast<float>(atof(splitresults[1].c_str()));
-				else
-					utilityval = static_cast<float>(atof(splitresults[0].c_str()));
-				isUtility = true;
+				temp = static_cast<float>(atof(splitresults[0].c_str()));
+				isTemp = true;
 			}
-			break;
-		case pTypePOWER:
-			if (!splitresults.empty())
-			{
+		}
+		else if ((sitem.subType == sTypeRFXSensorVolt) || (sitem.subType == sTypeRFXSensorAD))
+		{
+			utilityval = static_cast<float>(atof(sitem.sValue.c_str()));
+			isUtility = true;
+		}
+		break;
+	case pTypeAirQuality:
+		utilityval = (float)(sitem.nValue);
+		isUtility = true;
+		break;
+	case pTypeENERGY:
+		if (!splitresults.empty())
+		{
+			if (splitresults.size() == 2)
+				utilityval = static_cast<float>(atof(splitresults[1].c_str()));
+			else
 				utilityval = static_cast<float>(atof(splitresults[0].c_str()));
-				isUtility = true;
-			}
-			break;
-		case pTypeUsage:
-			if (!splitresults.empty())
+			isUtility = true;
+		}
+		break;
+	case pTypePOWER:
+		if (!splitresults.empty())
+		{
+			utilityval = static_cast<float>(atof(splitresults[0].c_str()));
+			isUtility = true;
+		}
+		break;
+	case pTypeUsage:
+		if (!splitresults.empty())
+		{
+			utilityval = static_cast<float>(atof(splitresults[0].c_str()));
+			isUtility = true;
+		}
+		break;
+	case pTypeP1Power:
+		if (splitresults.size() == 6)
+		{
+			utilityval = static_cast<float>(atof(splitresults[4].c_str()));
+			isUtility = true;
+		}
+		break;
+	case pTypeLux:
+		if (!splitresults.empty())
+		{
+			utilityval = static_cast<float>(atof(splitresults[0].c_str()));
+			isUtility = true;
+		}
+		break;
+	case pTypeGeneral:
+	{
+		if (!splitresults.empty())
+		{
+			if ((sitem.subType == sTypeVisibility)
+			 || (sitem.subType == sTypeSolarRadiation))
 			{
 				utilityval = static_cast<float>(atof(splitresults[0].c_str()));
 				isUtility = true;
+				weatherval = utilityval;
+				isWeather = true;
 			}
-			break;
-		case pTypeP1Power:
-			if (splitresults.size() == 6)
+			else if (sitem.subType == sTypeBaro)
 			{
-				utilityval = static_cast<float>(atof(splitresults[4].c_str()));
-				isUtility = true;
+				barometer = static_cast<float>(atof(splitresults[0].c_str()));
+				isBaro = true;
 			}
-			break;
-		case pTypeLux:
-			if (!splitresults.empty())
+			else if ((sitem.subType == sTypeAlert)
+				|| (sitem.subType == sTypeDistance)
+				|| (sitem.subType == sTypePercentage)
+				|| (sitem.subType == sTypeWaterflow)
+				|| (sitem.subType == sTypeCustom)
+				|| (sitem.subType == sTypeVoltage)
+				|| (sitem.subType == sTypeCurrent)
+				|| (sitem.subType == sTypeSetPoint)
+				|| (sitem.subType == sTypeKwh)
+				|| (sitem.subType == sTypeSoundLevel)
+				)
 			{
 				utilityval = static_cast<float>(atof(splitresults[0].c_str()));
 				isUtility = true;
 			}
-			break;
-		case pTypeGeneral:
-		{
-			if (!splitresults.empty())
-			{
-				if ((sitem.subType == sTypeVisibility)
-				 || (sitem.subType == sTypeSolarRadiation))
-				{
-					utilityval = static_cast<float>(atof(splitresults[0].c_str()));
-					isUtility = true;
-					weatherval = utilityval;
-					isWeather = true;
-				}
-				else if (sitem.subType == sTypeBaro)
-				{
-					barometer = static_cast<float>(atof(splitresults[0].c_str()));
-					isBaro = true;
-				}
-				else if ((sitem.subType == sTypeAlert)
-					|| (sitem.subType == sTypeDistance)
-					|| (sitem.subType == sTypePercentage)
-					|| (sitem.subType == sTypeWaterflow)
-					|| (sitem.subType == sTypeCustom)
-					|| (sitem.subType == sTypeVoltage)
-					|| (sitem.subType == sTypeCurrent)
-					|| (sitem.subType == sTypeSetPoint)
-					|| (sitem.subType == sTypeKwh)
-					|| (sitem.subType == sTypeSoundLevel)
-					)
-				{
-					utilityval = static_cast<float>(atof(splitresults[0].c_str()));
-					isUtility = true;
-				}
-			}
-			else
-			{
-				if (sitem.subType == sTypeZWaveAlarm)
-				{
-					alarmval = static_cast<int>(sitem.nValue);
-					isZWaveAlarm = true;
-				}
-				else if (sitem.subType == sTypeCounterIncremental)
-				{
-					//get value of today
-					time_t now = mytime(NULL);
-					struct tm tm1;
-					localtime_r(&now, &tm1);
-
-					struct tm ltime;
-					ltime.tm_isdst = tm1.tm_isdst;
-					ltime.tm_hour = 0;
-					ltime.tm_min = 0;
-					ltime.tm_sec = 0;
-					ltime.tm_year = tm1.tm_year;
-					ltime.tm_mon = tm1.tm_mon;
-					ltime.tm_mday = tm1.tm_mday;
-
-					char szDate[40];
-					sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-					std::vector<std::vector<std::string> > result2;
-					result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-						sitem.ID, szDate);
-					if (result2.size() > 0)
-					{
-						std::vector<std::string> sd2 = result2[0];
-
-						unsigned long long total_min, total_max, total_real;
-
-						std::stringstream s_str1(sd2[0]);
-						s_str1 >> total_min;
-						std::stringstream s_str2(sd2[1]);
-						s_str2 >> total_max;
-						total_real = total_max - total_min;
-
-						char szTmp[100];
-						sprintf(szTmp, "%llu", total_real);
-
-						float musage = 0;
-						_eMeterType metertype = (_eMeterType)sitem.switchtype;
-						switch (metertype)
-						{
-						case MTYPE_ENERGY:
-						case MTYPE_ENERGY_GENERATED:
-							musage = float(total_real) / EnergyDivider;
-							sprintf(szTmp, "%.03f kWh", musage);
-							break;
-						case MTYPE_GAS:
-							musage = float(total_real) / GasDivider;
-							sprintf(szTmp, "%.02f m3", musage);
-							break;
-						case MTYPE_WATER:
-							musage = float(total_real) / WaterDivider;
-							sprintf(szTmp, "%.02f m3", musage);
-							break;
-						case MTYPE_COUNTER:
-							sprintf(szTmp, "%llu", total_real);
-							break;
-						default:
-							continue; //not handled
-						}
-						utilityval = static_cast<float>(atof(szTmp));
-						isUtility = true;
-					}
-				}
-			}
 		}
-		break;
-		case pTypeRAIN:
-			if (splitresults.size() == 2)
+		else
+		{
+			if (sitem.subType == sTypeZWaveAlarm)
 			{
-				//get lowest value of today
-				time_t now = mytime(NULL);
-				struct tm tm1;
-				localtime_r(&now, &tm1);
-
-				struct tm ltime;
-				ltime.tm_isdst = tm1.tm_isdst;
-				ltime.tm_hour = 0;
-				ltime.tm_min = 0;
-				ltime.tm_sec = 0;
-				ltime.tm_year = tm1.tm_year;
-				ltime.tm_mon = tm1.tm_mon;
-				ltime.tm_mday = tm1.tm_mday;
-
-				char szDate[100];
-				sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-				std::vector<std::vector<std::string> > result2;
-
-				szQuery.clear();
-				szQuery.str("");
-				if (sitem.subType != sTypeRAINWU)
-				{
-					result2 = m_sql.safe_query(
-						"SELECT MIN(Total), MAX(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-						sitem.ID, szDate);
-				}
-				else
-				{
-					result2 = m_sql.safe_query(
-						"SELECT Total, Total FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q') ORDER BY ROWID DESC LIMIT 1",
-						sitem.ID, szDate);
-				}
-				if (result2.size()>0)
-				{
-					double total_real = 0;
-					std::vector<std::string> sd2 = result2[0];
-					if (sitem.subType != sTypeRAINWU)
-					{
-						float total_min = static_cast<float>(atof(sd2[0].c_str()));
-						float total_max = static_cast<float>(atof(splitresults[1].c_str()));
-						total_real = total_max - total_min;
-					}
-					else
-					{
-						total_real = atof(sd2[1].c_str());
-					}
-					rainmm = float(total_real);
-					rainmmlasthour = static_cast<float>(atof(splitresults[0].c_str())) / 100.0f;
-					isRain = true;
-					weatherval = rainmmlasthour;
-					isWeather = true;
-				}
+				alarmval = static_cast<int>(sitem.nValue);
+				isZWaveAlarm = true;
 			}
-			break;
-		case pTypeP1Gas:
+			else if (sitem.subType == sTypeCounterIncremental)
 			{
-				//get lowest value of today
-				float GasDivider = 1000.0f;
-				time_t now = mytime(NULL);
-				struct tm tm1;
-				localtime_r(&now, &tm1);
-
-				struct tm ltime;
-				ltime.tm_isdst = tm1.tm_isdst;
-				ltime.tm_hour = 0;
-				ltime.tm_min = 0;
-				ltime.tm_sec = 0;
-				ltime.tm_year = tm1.tm_year;
-				ltime.tm_mon = tm1.tm_mon;
-				ltime.tm_mday = tm1.tm_mday;
-
-				char szDate[40];
-				sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-				std::vector<std::vector<std::string> > result2;
-				result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-					sitem.ID, szDate);
-				if (result2.size()>0)
-				{
-					std::vector<std::string> sd2 = result2[0];
-
-					unsigned long long total_min_gas, total_real_gas;
-					unsigned long long gasactual;
+				float EnergyDivider, GasDivider, WaterDivider;
+				GetMeterDividers(EnergyDivider, GasDivider, WaterDivider);
 
-					std::stringstream s_str1(sd2[0]);
-					s_str1 >> total_min_gas;
-					std::stringstream s_str2(sitem.sValue);
-					s_str2 >> gasactual;
-					total_real_gas = gasactual - total_min_gas;
-					utilityval = float(total_real_gas) / GasDivider;
-					isUtility = true;
-				}
-			}
-			break;
-		case pTypeRFXMeter:
-			if (sitem.subType == sTypeRFXMeterCount)
-			{
 				//get value of today
 				time_t now = mytime(NULL);
 				struct tm tm1;
@@ -854,7 +938,7 @@ void CEventSystem::GetCurrentMeasurementStates()
 				std::vector<std::vector<std::string> > result2;
 				result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
 					sitem.ID, szDate);
-				if (result2.size()>0)
+				if (result2.size() > 0)
 				{
 					std::vector<std::string> sd2 = result2[0];
 
@@ -890,72 +974,212 @@ void CEventSystem::GetCurrentMeasurementStates()
 						sprintf(szTmp, "%llu", total_real);
 						break;
 					default:
-						continue; //not handled
+						return false; //not handled
 					}
 					utilityval = static_cast<float>(atof(szTmp));
 					isUtility = true;
 				}
 			}
-			break;
-		default:
-			//Unknown device
-			continue;
-		}
-
-		if (isTemp) {
-			m_tempValuesByName[sitem.deviceName] = temp;
-			m_tempValuesByID[sitem.ID] = temp;
-		}
-		if (isDew) {
-			m_dewValuesByName[sitem.deviceName] = dewpoint;
-			m_dewValuesByID[sitem.ID] = dewpoint;
 		}
-		if (isHum) {
-			m_humValuesByName[sitem.deviceName] = humidity;
-			m_humValuesByID[sitem.ID] = humidity;
-		}
-		if (isBaro) {
-			m_baroValuesByName[sitem.deviceName] = barometer;
-			m_baroValuesByID[sitem.ID] = barometer;
-		}
-		if (isUtility)
+	}
+	break;
+	case pTypeRAIN:
+		if (splitresults.size() == 2)
 		{
-			m_utilityValuesByName[sitem.deviceName] = utilityval;
-			m_utilityValuesByID[sitem.ID] = utilityval;
-		}
-		if (isRain) {
-			m_rainValuesByName[sitem.deviceName] = rainmm;
-			m_rainValuesByID[sitem.ID] = rainmm;
-			m_rainLastHourValuesByName[sitem.deviceName] = rainmmlasthour;
-			m_rainLastHourValuesByID[sitem.ID] = rainmmlasthour;
+			//get lowest value of today
+			time_t now = mytime(NULL);
+			struct tm tm1;
+			localtime_r(&now, &tm1);
+
+			struct tm ltime;
+			ltime.tm_isdst = tm1.tm_isdst;
+			ltime.tm_hour = 0;
+			ltime.tm_min = 0;
+			ltime.tm_sec = 0;
+			ltime.tm_year = tm1.tm_year;
+			ltime.tm_mon = tm1.tm_mon;
+			ltime.tm_mday = tm1.tm_mday;
+
+			char szDate[100];
+			sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+
+			std::vector<std::vector<std::string> > result2;
+
+			if (sitem.subType != sTypeRAINWU)
+			{
+				result2 = m_sql.safe_query(
+					"SELECT MIN(Total), MAX(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
+					sitem.ID, szDate);
+			}
+			else
+			{
+				result2 = m_sql.safe_query(
+					"SELECT Total, Total FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q') ORDER BY ROWID DESC LIMIT 1",
+					sitem.ID, szDate);
+			}
+			if (result2.size()>0)
+			{
+				double total_real = 0;
+				std::vector<std::string> sd2 = result2[0];
+				if (sitem.subType != sTypeRAINWU)
+				{
+					float total_min = static_cast<float>(atof(sd2[0].c_str()));
+					float total_max = static_cast<float>(atof(splitresults[1].c_str()));
+					total_real = total_max - total_min;
+				}
+				else
+				{
+					total_real = atof(sd2[1].c_str());
+				}
+				rainmm = float(total_real);
+				rainmmlasthour = static_cast<float>(atof(splitresults[0].c_str())) / 100.0f;
+				isRain = true;
+				weatherval = rainmmlasthour;
+				isWeather = true;
+			}
 		}
-		if (isWeather)
+		break;
+	case pTypeP1Gas:
 		{
-			m_weatherValuesByName[sitem.deviceName] = weatherval;
-			m_weatherValuesByID[sitem.ID] = weatherval;
-		}
-		if (isUV) {
-			m_uvValuesByName[sitem.deviceName] = uv;
-			m_uvValuesByID[sitem.ID] = uv;
-		}
-		if (isWindDir) {
-			m_winddirValuesByName[sitem.deviceName] = winddir;
-			m_winddirValuesByID[sitem.ID] = winddir;
-		}
-		if (isWindSpeed) {
-			m_windspeedValuesByName[sitem.deviceName] = windspeed;
-			m_windspeedValuesByID[sitem.ID] = windspeed;
-		}
-		if (isWindGust) {
-			m_windgustValuesByName[sitem.deviceName] = windgust;
-			m_windgustValuesByID[sitem.ID] = windgust;
+			//get lowest value of today
+			float GasDivider = 1000.0f;
+			time_t now = mytime(NULL);
+			struct tm tm1;
+			localtime_r(&now, &tm1);
+
+			struct tm ltime;
+			ltime.tm_isdst = tm1.tm_isdst;
+			ltime.tm_hour = 0;
+			ltime.tm_min = 0;
+			ltime.tm_sec = 0;
+			ltime.tm_year = tm1.tm_year;
+			ltime.tm_mon = tm1.tm_mon;
+			ltime.tm_mday = tm1.tm_mday;
+
+			char szDate[40];
+			sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+
+			std::vector<std::vector<std::string> > result2;
+			result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
+				sitem.ID, szDate);
+			if (result2.size()>0)
+			{
+				std::vector<std::string> sd2 = result2[0];
+
+				unsigned long long total_min_gas, total_real_gas;
+				unsigned long long gasactual;
+
+				std::stringstream s_str1(sd2[0]);
+				s_str1 >> total_min_gas;
+				std::stringstream s_str2(sitem.sValue);
+				s_str2 >> gasactual;
+				total_real_gas = gasactual - total_min_gas;
+				utilityval = float(total_real_gas) / GasDivider;
+				isUtility = true;
+			}
 		}
-		if (isZWaveAlarm)
+		break;
+	case pTypeRFXMeter:
+		if (sitem.subType == sTypeRFXMeterCount)
 		{
-			m_zwaveAlarmValuesByName[sitem.deviceName] = alarmval;
-			m_zwaveAlarmValuesByID[sitem.ID] = alarmval;
+			float EnergyDivider, GasDivider, WaterDivider;
+			GetMeterDividers(EnergyDivider, GasDivider, WaterDivider);
+
+			//get value of today
+			time_t now = mytime(NULL);
+			struct tm tm1;
+			localtime_r(&now, &tm1);
+
+			struct tm ltime;
+			ltime.tm_isdst = tm1.tm_isdst;
+			ltime.tm_hour = 0;
+			ltime.tm_min = 0;
+			ltime.tm_sec = 0;
+			ltime.tm_year = tm1.tm_year;
+			ltime.tm_mon = tm1.tm_mon;
+			ltime.tm_mday = tm1.tm_mday;
+
+			char szDate[40];
+			sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+
+			std::vector<std::vector<std::string> > result2;
+			result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
+				sitem.ID, szDate);
+			if (result2.size()>0)
+			{
+				std::vector<std::string> sd2 = result2[0];
+
+				unsigned long long total_min, total_max, total_real;
+
+				std::stringstream s_str1(sd2[0]);
+				s_str1 >> total_min;
+				std::stringstream s_str2(sd2[1]);
+				s_str2 >> total_max;
+				total_real = total_max - total_min;
+
+				char szTmp[100];
+				sprintf(szTmp, "%llu", total_real);
+
+				float musage = 0;
+				_eMeterType metertype = (_eMeterType)sitem.switchtype;
+				switch (metertype)
+				{
+				case MTYPE_ENERGY:
+				case MTYPE_ENERGY_GENERATED:
+					musage = float(total_real) / EnergyDivider;
+					sprintf(szTmp, "%.03f kWh", musage);
+					break;
+				case MTYPE_GAS:
+					musage = float(total_real) / GasDivider;
+					sprintf(szTmp, "%.02f m3", musage);
+					break;
+				case MTYPE_WATER:
+					musage = float(total_real) / WaterDivider;
+					sprintf(szTmp, "%.02f m3", musage);
+					break;
+				case MTYPE_COUNTER:
+					sprintf(szTmp, "%llu", total_real);
+					break;
+				default:
+					return false; //not handled
+				}
+				utilityval = static_cast<float>(atof(szTmp));
+				isUtility = true;
+			}
 		}
+		break;
+	default:
+		//Unknown device
+		return false;
 	}
+
+	mstate.deviceName = sitem.deviceName;
+	mstate.temp = temp;
+	mstate.dewpoint = dewpoint;
+	mstate.humidity = humidity;
+	mstate.barometer = barometer;
+	mstate.utilityval = utilityval;
+	mstate.rainmm = rainmm;
+	mstate.rainmmlasthour = rainmmlasthour;
+	mstate.weatherval = weatherval;
+	mstate.uv = uv;
+	mstate.winddir = winddir;
+	mstate.windspeed = windspeed;
+	mstate.windgust = windgust;
+	mstate.alarmval = alarmval;
+	mstate.isTemp = isTemp;
+	mstate.isDew = isDew;
+	mstate.isHum = isHum;
+	mstate.isBaro = isBaro;
+	mstate.isUtility = isUtility;
+	mstate.isRain = isRain;
+	mstate.isWeather = isWeather;
+	mstate.isUV = isUV;
+	mstate.isWindDir = isWindDir;
+	mstate.isWindSpeed = isWindSpeed;
+	mstate.isWindGust = isWindGust;
+	mstate.isZWaveAlarm = isZWaveAlarm;
+	return true;
 }
 
 void CEventSystem::RemoveSingleState(int ulDevID)
@@ -967,7 +1191,9 @@ void CEventSystem::RemoveSingleState(int ulDevID)
 
 	//_log.Log(LOG_STATUS,"EventSystem: deleted device %d",ulDevID);
 	m_devicestates.erase(ulDevID);
+	devicestatesMutexLock.unlock();
 
+	RefreshMeasurementState(ulDevID);
 }
 
 void CEventSystem::WWWUpdateSingleState(const uint64_t ulDevID, const std::string &devname)
@@ -987,6 +1213,9 @@ void CEventSystem::WWWUpdateSingleState(const uint64_t ulDevID, const std::strin
 		_tDeviceStatus replaceitem = itt->second;
 		replaceitem.deviceName = l_deviceName;
 		itt->second = replaceitem;
+		devicestatesMutexLock.unlock();
+
+		RefreshMeasurementState(ulDevID);
 	}
 }
 
@@ -1038,6 +1267,9 @@ std::string CEventSystem::UpdateSingleState(const uint64_t ulDevID, const std::s
 		newitem.lastLevel = lastLevel;
 		m_devicestates[newitem.ID] = newitem;
 	}
+	devicestatesMutexLock.unlock();
+
+	RefreshMeasurementState(ulDevID);
 	return nValueWording;
 }
 
@@ -1067,6 +1299,12 @@ void CEventSystem::ProcessDevice(const int HardwareID, const uint64_t ulDevID, c
 
 void CEventSystem::ProcessMinute()
 {
+	{
+		//Counter and rain values are values of today
+		boost::lock_guard<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
+		if (GetMeasurementDay() != m_measurementStatesDay)
+			GetCurrentMeasurementStates();
+	}
 	GetCurrentUserVariables();
 	GetCurrentScenesGroups();
 	EvaluateEvent("time");
@@ -1284,7 +1522,6 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 	lua_setglobal(lua_state, "variable");
 
 	boost::lock_guard<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
-	GetCurrentMeasurementStates();
 
 	if (m_tempValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_tempValuesByID.size(), 0);
@@ -2165,9 +2402,8 @@ void CEventSystem::ParseActionString( const std::string &oAction_, _tActionParse
 			}
 		}
 	}
-#ifdef _DEBUG
 	_log.Log(
-		LOG_NORM, "Command=%s, FOR=%.2f, AFTER=%.2f, RANDOM=%.2f, REPEAT=%d INTERVAL %.2f",
+		LOGCAT_EVENTSYSTEM, LOG_TRACE, "EventSystem: Command=%s, FOR=%.2f, AFTER=%.2f, RANDOM=%.2f, REPEAT=%d INTERVAL %.2f",
 		oResults_.sCommand.c_str(),
 		oResults_.fForSec,
 		oResults_.fAfterSec,
@@ -2175,7 +2411,6 @@ void CEventSystem::ParseActionString( const std::string &oAction_, _tActionParse
 		oResults_.iRepeat,
 		oResults_.fRepeatSec
 	);
-#endif
 }
 
 #ifdef ENABLE_PYTHON
@@ -2365,6 +2600,7 @@ void CEventSystem::EvaluatePython(const std::string &reason, const std::string &
 
 		domoticz_namespace["user_variables"] = user_variables;
 		main_namespace["user_variables"] = user_variables;
+		boost::unique_lock<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
 		main_namespace["otherdevices_temperature"] = toPythonDict(m_tempValuesByName);
 		main_namespace["otherdevices_dewpoint"] = toPythonDict(m_dewValuesByName);
 		main_namespace["otherdevices_barometer"] = toPythonDict(m_baroValuesByName);
@@ -2376,6 +2612,7 @@ void CEventSystem::EvaluatePython(const std::string &reason, const std::string &
 		main_namespace["otherdevices_windspeed"] = toPythonDict(m_windspeedValuesByName);
 		main_namespace["otherdevices_windgust"] = toPythonDict(m_windgustValuesByName);
 		main_namespace["otherdevices_zwavealarms"] = toPythonDict(m_zwaveAlarmValuesByName);
+		measurementStatesMutexLock.unlock();
 
 		if(PyString.length() > 0)
 			exec(str(PyString), main_namespace);
@@ -2507,9 +2744,7 @@ void CEventSystem::EvaluateLua(const std::string &reason, const std::string &fil
 	lua_pushcfunction(lua_state, l_domoticz_applyXPath);
 	lua_setglobal(lua_state, "domoticz_applyXPath");
 
-#ifdef _DEBUG
-	_log.Log(LOG_STATUS, "EventSystem: script %s trigger", reason.c_str());
-#endif
+	_log.Log(LOGCAT_EVENTSYSTEM, LOG_TRACE, "EventSystem: script %s trigger", reason.c_str());
 
 	int intRise = getSunRiseSunSetMinutes("Sunrise");
 	int intSet = getSunRiseSunSetMinutes("Sunset");
@@ -2546,7 +2781,6 @@ void CEventSystem::EvaluateLua(const std::string &reason, const std::string &fil
 
 	{
 		boost::lock_guard<boost::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
-		GetCurrentMeasurementStates();
 
 		float thisDeviceTemp = 0;
 		float thisDeviceDew = 0;
@@ -2972,19 +3206,7 @@ void CEventSystem::EvaluateLua(const std::string &reason, const std::string &fil
 
 	if (status == 0)
 	{
-		lua_sethook(lua_state, luaStop, LUA_MASKCOUNT, 10000000);
-		//luaThread = boost::thread(&CEventSystem::luaThread, lua_state, filename);
-		//boost::shared_ptr<boost::thread> luaThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CEventSystem::luaThread, this, lua_state, filename)));
-		boost::thread luaThread(boost::bind(&CEventSystem::luaThread, this, lua_state, filename));
-		//m_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CEventSystem::Do_Work, this)));
-		if (!luaThread.timed_join(boost::posix_time::seconds(10)))
-		{
-			_log.Log(LOG_ERROR, "EventSystem: Warning!, lua script %s has been running for more than 10 seconds", filename.c_str());
-		}
-		else
-		{
-			//_log.Log(LOG_ERROR, "EventSystem: lua script completed");
-		}
+		luaExecute(lua_state, filename, LuaString);
 	}
 	else
 	{
@@ -3026,11 +3248,100 @@ void CEventSystem::EvaluateLua(const std::string &reason, const std::string &fil
 	*/
 }
 
-void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
+struct _tLuaWatchdog
 {
-	int status;
+	uint64_t cpuDeadline;	//ms, CPU time of the calling thread
+	uint64_t wallDeadline;	//ms, monotonic clock
+	bool bCPUTimedOut;
+	bool bWallTimedOut;
+};
+
+//Watchdog of the running script, scripts run one at a time (luaMutex).
+//A plain pointer, the hook runs on every function call and a registry lookup there doubled the call cost
+static _tLuaWatchdog *g_pLuaWatchdog = NULL;
+
+static uint64_t GetMonotonicMs()
+{
+#ifdef WIN32
+	return GetTickCount64();
+#else
+	//The coarse clock is good enough for deadlines in seconds and much cheaper, it is read on every call
+	struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+	return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+#endif
+}
+
+//CPU time used by the calling thread, scripts run on the thread that evaluates the event
+static uint64_t GetThreadCPUMs()
+{
+#ifdef WIN32
+	FILETIME ftCreation, ftExit, ftKernel, ftUser;
+	if (!GetThreadTimes(GetCurrentThread(), &ftCreation, &ftExit, &ftKernel, &ftUser))
+		return 0;
+	uint64_t kernel = ((uint64_t)ftKernel.dwHighDateTime << 32) | ftKernel.dwLowDateTime;
+	uint64_t user = ((uint64_t)ftUser.dwHighDateTime << 32) | ftUser.dwLowDateTime;
+	return (kernel + user) / 10000;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+#endif
+}
+
+//A script can set its own CPU budget (seconds) with a comment in its first lines, like
+//-- cpu_budget: 30
+static int GetLuaCPUBudget(const std::string &LuaString, const std::string &filename, const int defaultBudget)
+{
+	std::string header;
+	if (LuaString.empty())
+	{
+		std::ifstream is(filename.c_str());
+		std::string line;
+		for (int ii = 0; (ii < 5) && (std::getline(is, line)); ii++)
+			header += line + "\n";
+	}
+	else
+		header = LuaString.substr(0, 512);
+	size_t pos = header.find("-- cpu_budget:");
+	if (pos == std::string::npos)
+		return defaultBudget;
+	int budget = atoi(header.c_str() + pos + 14);
+	return (budget < 1) ? defaultBudget : budget;
+}
 
+void CEventSystem::luaExecute(lua_State *lua_state, const std::string &filename, const std::string &LuaString)
+{
+	int status;
+	const int CPUBudget = GetLuaCPUBudget(LuaString, filename, m_LuaTimeout);
+	const int WallLimit = std::max(CPUBudget * LUA_WALLCLOCK_FACTOR, LUA_WALLCLOCK_MIN);
+
+	_tLuaWatchdog watchdog;
+	watchdog.cpuDeadline = GetThreadCPUMs() + ((uint64_t)CPUBudget * 1000);
+	watchdog.wallDeadline = GetMonotonicMs() + ((uint64_t)WallLimit * 1000);
+	watchdog.bCPUTimedOut = false;
+	watchdog.bWallTimedOut = false;
+	g_pLuaWatchdog = &watchdog;
+	lua_sethook(lua_state, luaStop, LUA_MASKCOUNT | LUA_MASKCALL, LUA_WATCHDOG_INSTRUCTIONS);
+
+	m_LuaRuns++;
 	status = lua_pcall(lua_state, 0, LUA_MULTRET, 0);
+	lua_sethook(lua_state, NULL, 0, 0);
+	g_pLuaWatchdog = NULL;
+	if ((watchdog.bCPUTimedOut) || (watchdog.bWallTimedOut))
+	{
+		m_LuaTimeouts++;
+		if (watchdog.bCPUTimedOut)
+			_log.Log(LOG_ERROR, "EventSystem: Lua script %s used more than %d seconds of CPU time, aborted", filename.c_str(), CPUBudget);
+		else
+			_log.Log(LOG_ERROR, "EventSystem: Lua script %s has been running for more than %d seconds, aborted", filename.c_str(), WallLimit);
+		lua_close(lua_state);
+		return;
+	}
 	report_errors(lua_state, status, filename);
 
 	bool scriptTrue = false;
@@ -3061,13 +3372,37 @@ void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
 
 void CEventSystem::luaStop(lua_State *L, lua_Debug *ar)
 {
-	if (ar->event == LUA_HOOKCOUNT)
+	if ((ar->event != LUA_HOOKCOUNT) && (ar->event != LUA_HOOKCALL) && (ar->event != LUA_HOOKTAILCALL))
+		return;
+	_tLuaWatchdog *pWatchdog = g_pLuaWatchdog;
+	if (pWatchdog == NULL)
+		return;
+	if ((!pWatchdog->bCPUTimedOut) && (!pWatchdog->bWallTimedOut))
 	{
-		(void)ar;  /* unused arg. */
-		lua_sethook(L, NULL, 0, 0);
-		luaL_error(L, "Lua script execution exceeds maximum number of lines");
-		lua_close(L);
+		//Calls only check the wall clock: a loop around a blocking C call (os.execute("sleep 1"))
+		//runs too few instructions to reach the count hook in time
+		if ((ar->event == LUA_HOOKCOUNT) && (GetThreadCPUMs() > pWatchdog->cpuDeadline))
+			pWatchdog->bCPUTimedOut = true;
+		else if (GetMonotonicMs() > pWatchdog->wallDeadline)
+			pWatchdog->bWallTimedOut = true;
+		else
+			return;
 	}
+	//The hook stays active, a script that catches this error with pcall is stopped again
+	luaL_error(L, "Lua script execution exceeds maximum run time");
+}
+
+void CEventSystem::GetLuaStatistics(unsigned long &nRuns, unsigned long &nTimeouts, int &Timeout)
+{
+	nRuns = m_LuaRuns;
+	nTimeouts = m_LuaTimeouts;
+	Timeout = m_LuaTimeout;
+}
+
+//Used for the next script that is started, also while the event system is running
+void CEventSystem::SetLuaTimeout(const int Timeout)
+{
+	m_LuaTimeout = (Timeout < 1) ? 1 : Timeout;
 }
 
 bool CEventSystem::iterateLuaTable(lua_State *lua_state, const int tIndex, const std::string &filename)
@@ -3356,6 +3691,9 @@ void CEventSystem::OpenURL(const std::string &URL)
 
 void CEventSystem::WriteToLog(const std::string &devNameNoQuotes, const std::string &doWhat)
 {
+	//Do not lock the device states for a line that is not logged
+	if (!_log.IsLogLevelEnabled(LOG_STATUS))
+		return;
 
 	if (devNameNoQuotes == "WriteToLogText")
 	{
@@ -3574,9 +3912,7 @@ bool CEventSystem::ScheduleEvent(int deviceID, std::string Action, bool isScene,
 		}
 
 		m_sql.AddTaskItem( tItem );
-#ifdef _DEBUG
-		_log.Log(LOG_STATUS, "EventSystem: Scheduled %s after %0.2f.", tItem._command.c_str(), tItem._DelayTime );
-#endif
+		_log.Log(LOGCAT_EVENTSYSTEM, LOG_TRACE, "EventSystem: Scheduled %s after %0.2f.", tItem._command.c_str(), tItem._DelayTime );
 
 		if (
 			oParseResults.fForSec > (1./timer_resolution_hz/2)
@@ -3598,9 +3934,7 @@ bool CEventSystem::ScheduleEvent(int deviceID, std::string Action, bool isScene,
 				tDelayedtItem = _tTaskItem::SwitchLightEvent( fDelayTime, deviceID, previousState, previousLevel, -1, eventName );
 			}
 			m_sql.AddTaskItem( tDelayedtItem );
-#ifdef _DEBUG
-			_log.Log(LOG_STATUS, "EventSystem: Scheduled %s after %0.2f.", tDelayedtItem._command.c_str(), tDelayedtItem._DelayTime );
-#endif
+			_log.Log(LOGCAT_EVENTSYSTEM, LOG_TRACE, "EventSystem: Scheduled %s after %0.2f.", tDelayedtItem._command.c_str(), tDelayedtItem._DelayTime );
 		}
 
 	}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <set>
 #include <string>
 #include <vector>
+#include <boost/atomic.hpp>
 
 extern "C" {
 #ifdef WITH_EXTERNAL_LUA
@@ -59,6 +61,37 @@ public:
 		unsigned char switchtype;
 	};
 
+	//Measurements parsed from the sValue of a device
+	struct _tMeasurementState
+	{
+		std::string deviceName;	//name the values are stored under in the ByName tables
+		float temp;
+		float dewpoint;
+		int humidity;
+		float barometer;
+		float utilityval;
+		float rainmm;
+		float rainmmlasthour;
+		float weatherval;
+		float uv;
+		float winddir;
+		float windspeed;
+		float windgust;
+		int alarmval;
+		bool isTemp;
+		bool isDew;
+		bool isHum;
+		bool isBaro;
+		bool isUtility;
+		bool isRain;
+		bool isWeather;
+		bool isUV;
+		bool isWindDir;
+		bool isWindSpeed;
+		bool isWindGust;
+		bool isZWaveAlarm;
+	};
+
 	struct _tUserVariable
 	{
 		uint64_t ID;
@@ -94,6 +127,9 @@ public:
 	void GetCurrentStates();
 
 	void exportDeviceStatesToLua(lua_State *lua_state);
+	size_t GetMemoryUsage(size_t &nItems);
+	void GetLuaStatistics(unsigned long &nRuns, unsigned long &nTimeouts, int &Timeout);
+	void SetLuaTimeout(const int Timeout);
 
 private:
 	//lua_State	*m_pLUA;
@@ -113,6 +149,13 @@ private:
 	void Do_Work();
 	void ProcessMinute();
 	void GetCurrentMeasurementStates();
+	void UpdateMeasurementState(const _tDeviceStatus &sitem);
+	void RemoveMeasurementState(const uint64_t ulDevID);
+	void UpdateMeasurementName(const std::string &deviceName);
+	void RefreshMeasurementState(const uint64_t ulDevID);
+	bool ParseMeasurementState(const _tDeviceStatus &sitem, _tMeasurementState &mstate);
+	void GetMeterDividers(float &EnergyDivider, float &GasDivider, float &WaterDivider);
+	int GetMeasurementDay();
 	void GetCurrentUserVariables();
 	void GetCurrentScenesGroups();
 	std::string UpdateSingleState(const uint64_t ulDevID, const std::string &devname, const int nValue, const char* sValue, const unsigned char devType, const unsigned char subType, const _eSwitchType switchType, const std::string &lastUpdate, const unsigned char lastLevel, const std::map<std::string, std::string> & options);
@@ -130,8 +173,13 @@ private:
 	void EvaluateLua(const std::string &reason, const std::string &filename, const std::string &LuaString, const uint64_t varId);
 	void EvaluateLua(const std::string &reason, const std::string &filename, const std::string &LuaString);
 	void EvaluateLua(const std::string &reason, const std::string &filename, const std::string &LuaString, const uint64_t DeviceID, const std::string &devname, const int nValue, const char* sValue, std::string nValueWording, const uint64_t varId);
-	void luaThread(lua_State *lua_state, const std::string &filename);
+	void luaExecute(lua_State *lua_state, const std::string &filename, const std::string &LuaString);
 	static void luaStop(lua_State *L, lua_Debug *ar);
+
+	//Default CPU budget of a Lua script (seconds), checked from a count hook
+	boost::atomic<int> m_LuaTimeout;
+	boost::atomic<unsigned long> m_LuaRuns;
+	boost::atomic<unsigned long> m_LuaTimeouts;
 	std::string nValueToWording(const unsigned char dType, const unsigned char dSubType, const _eSwitchType switchtype, const unsigned char nValue, const std::string &sValue, const std::map<std::string, std::string> & options);
 	static int l_domoticz_print(lua_State* lua_state);
 	void OpenURL(const std::string &URL);
@@ -151,6 +199,12 @@ private:
 	std::map<uint64_t, _tDeviceStatus> m_devicestates;
 	std::map<uint64_t, _tUserVariable> m_uservariables;
 	std::map<uint64_t, _tScenesGroups> m_scenesgroups;
+
+	//Parsed measurements per device and the value tables for the scripts,
+	//updated by UpdateSingleState for the changed device only (m_measurementStatesMutex)
+	std::map<uint64_t, _tMeasurementState> m_measurementStates;
+	std::map<std::string, std::set<uint64_t> > m_measurementNames;	//devices with measurements per name
+	int m_measurementStatesDay;
 	std::map<std::string, float> m_tempValuesByName;
 	std::map<std::string, float> m_dewValuesByName;
 	std::map<std::string, float> m_rainValuesByName;
@@ -819,6 +819,45 @@ std::string MakeHtml(const std::string &txt)
         return sRet;
 }
 
+//Attributes of the hardware worker threads, the stack size is only set in lean mode
+//(the default of most Linux distributions is 8 MB per thread).
+//Threads that run Python or Lua keep the default stack
+static boost::thread::attributes g_WorkerThreadAttributes;
+
+bool SetWorkerThreadStackSize(const size_t stacksize)
+{
+	g_WorkerThreadAttributes.set_stack_size(stacksize);
+	return (g_WorkerThreadAttributes.get_stack_size() == stacksize);
+}
+
+const boost::thread::attributes &GetWorkerThreadAttributes()
+{
+	return g_WorkerThreadAttributes;
+}
+
+//Resident memory (kB) and number of threads of this process
+bool GetProcessMemoryUsage(long &ResidentKB, int &nThreads)
+{
+	ResidentKB = 0;
+	nThreads = 0;
+#ifdef __linux__
+	std::ifstream infile("/proc/self/status");
+	if (!infile.is_open())
+		return false;
+	std::string sLine;
+	while (std::getline(infile, sLine))
+	{
+		if (sLine.find("VmRSS:") == 0)
+			ResidentKB = atol(sLine.substr(6).c_str());
+		else if (sLine.find("Threads:") == 0)
+			nThreads = atoi(sLine.substr(8).c_str());
+	}
+	return (ResidentKB != 0);
+#else
+	return false;
+#endif
+}
+
 #if defined WIN32
 //FILETIME of Jan 1 1970 00:00:00
 static const uint64_t epoch = (const uint64_t)(116444736000000000);
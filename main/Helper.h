@@ -56,6 +56,9 @@ void DirectoryListing(std::vector<std::string>& entries, const std::string &dir,
 
 std::string GenerateUserAgent();
 std::string MakeHtml(const std::string &txt);
+bool SetWorkerThreadStackSize(const size_t stacksize);
+const boost::thread::attributes &GetWorkerThreadAttributes();
+bool GetProcessMemoryUsage(long &ResidentKB, int &nThreads);
 
 #if defined WIN32
 	int gettimeofday(timeval * tp, void * tzp);
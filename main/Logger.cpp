@@ -16,6 +16,7 @@
 #include "SQLHelper.h"
 
 #define MAX_LOG_LINE_BUFFER 100
+#define LEAN_LOG_LINE_BUFFER 20
 #define MAX_LOG_LINE_LENGTH (2048*3)
 
 extern bool g_bRunAsDaemon;
@@ -34,6 +35,9 @@ CLogger::CLogger(void)
 	m_bInSequenceMode=false;
 	m_bEnableLogTimestamps=true;
 	m_verbose_level=VBL_ALL;
+	m_trace_categories=LOGCAT_ALL;
+	m_bHaveFilter=false;
+	m_max_log_lines=MAX_LOG_LINE_BUFFER;
 	m_bEnableErrorsToNotificationSystem = false;
 	m_LastLogNotificationsSend = 0;
 }
@@ -72,6 +76,45 @@ void CLogger::SetVerboseLevel(_eLogFileVerboseLevel vLevel)
 	m_verbose_level=vLevel;
 }
 
+//Number of lines kept in memory per log buffer (lean mode uses a smaller buffer)
+void CLogger::SetLogBufferSize(const size_t lines)
+{
+	boost::unique_lock< boost::mutex > lock(m_mutex);
+	m_max_log_lines = (lines > 0) ? lines : MAX_LOG_LINE_BUFFER;
+	while (m_lastlog.size() > m_max_log_lines)
+		m_lastlog.pop_front();
+	while (m_last_status_log.size() > m_max_log_lines)
+		m_last_status_log.pop_front();
+	while (m_last_error_log.size() > m_max_log_lines)
+		m_last_error_log.pop_front();
+	while (m_notification_log.size() > m_max_log_lines)
+		m_notification_log.pop_front();
+}
+
+void CLogger::SetLeanMode()
+{
+	SetLogBufferSize(LEAN_LOG_LINE_BUFFER);
+}
+
+//Approximate number of bytes used by the in-memory log buffers
+size_t CLogger::GetMemoryUsage(size_t &nLines)
+{
+	boost::unique_lock< boost::mutex > lock(m_mutex);
+	const std::deque<_tLogLineStruct> *buffers[] = { &m_lastlog, &m_last_status_log, &m_last_error_log, &m_notification_log };
+	size_t nBytes = 0;
+	nLines = 0;
+	for (int ii = 0; ii < 4; ii++)
+	{
+		std::deque<_tLogLineStruct>::const_iterator itt;
+		for (itt = buffers[ii]->begin(); itt != buffers[ii]->end(); ++itt)
+		{
+			nBytes += sizeof(_tLogLineStruct) + itt->logmessage.capacity();
+		}
+		nLines += buffers[ii]->size();
+	}
+	return nBytes;
+}
+
 void CLogger::ForwardErrorsToNotificationSystem(const bool bDoForward)
 {
 	m_bEnableErrorsToNotificationSystem = bDoForward;
@@ -79,22 +122,39 @@ void CLogger::ForwardErrorsToNotificationSystem(const bool bDoForward)
 		m_notification_log.clear();
 }
 
+//Level and category checks only read atomics, so suppressed messages
+//are dropped before any formatting or locking
+bool CLogger::IsEnabled(const _eLogCategory category, const _eLogLevel level)
+{
+	if ((int)level > m_verbose_level.load(boost::memory_order_relaxed))
+		return false;
+	if (level != LOG_TRACE)
+		return true;
+	return ((m_trace_categories.load(boost::memory_order_relaxed) & category) != 0);
+}
+
+bool CLogger::IsLogLevelEnabled(const _eLogLevel level)
+{
+	return IsEnabled(LOGCAT_ALL, level);
+}
+
 void CLogger::Log(const _eLogLevel level, const char* logline, ...)
 {
-	boost::unique_lock< boost::mutex > lock(m_mutex);
+	if (!IsEnabled(LOGCAT_ALL, level))
+		return;
 
-	bool bDoLog = false;
-/*	if (m_verbose_level == VBL_ALL)
-		bDoLog = true;
-	else if ((m_verbose_level == VBL_STATUS_ERROR) && ((level == LOG_STATUS) || (level == LOG_ERROR)))
-		bDoLog = true;
-	else if ((m_verbose_level == VBL_ERROR) && (level == LOG_ERROR))
-		bDoLog = true;
-    */
-  if (level <= (_eLogLevel)m_verbose_level )
-		bDoLog = true;
-
-	if (!bDoLog)
+	va_list argList;
+	char cbuffer[MAX_LOG_LINE_LENGTH];
+	va_start(argList, logline);
+	vsnprintf(cbuffer, sizeof(cbuffer), logline, argList);
+	va_end(argList);
+
+	LogLine(level, cbuffer);
+}
+
+void CLogger::Log(const _eLogCategory category, const _eLogLevel level, const char* logline, ...)
+{
+	if (!IsEnabled(category, level))
 		return;
 
 	va_list argList;
@@ -103,8 +163,16 @@ void CLogger::Log(const _eLogLevel level, const char* logline, ...)
 	vsnprintf(cbuffer, sizeof(cbuffer), logline, argList);
 	va_end(argList);
 
-    //test if log contain a string to be filtered from LOG content
-    if (TestFilter(cbuffer) ) return ;
+	LogLine(level, cbuffer);
+}
+
+void CLogger::LogLine(const _eLogLevel level, const char *cbuffer)
+{
+	boost::unique_lock< boost::mutex > lock(m_mutex);
+
+	//test if log contain a string to be filtered from LOG content
+	if (IsFiltered(cbuffer))
+		return;
 
 	std::stringstream sstr;
 	bool bEnableLogTimestamps = m_bEnableLogTimestamps;
@@ -141,26 +209,26 @@ void CLogger::Log(const _eLogLevel level, const char* logline, ...)
 	{
 		sstr << "Error: " << cbuffer;
 	}
-	if (m_lastlog.size()>=MAX_LOG_LINE_BUFFER)
+	if (m_lastlog.size()>=m_max_log_lines)
 		m_lastlog.erase(m_lastlog.begin());
 	m_lastlog.push_back(_tLogLineStruct(level,sstr.str()));
 
 	if (level == LOG_STATUS)
 	{
-		if (m_last_status_log.size() >= MAX_LOG_LINE_BUFFER)
+		if (m_last_status_log.size() >= m_max_log_lines)
 			m_last_status_log.erase(m_last_status_log.begin());
 		m_last_status_log.push_back(_tLogLineStruct(level, sstr.str()));
 	}
 	else if (level == LOG_ERROR)
 	{
-		if (m_last_error_log.size() >= MAX_LOG_LINE_BUFFER)
+		if (m_last_error_log.size() >= m_max_log_lines)
 			m_last_error_log.erase(m_last_error_log.begin());
 		m_last_error_log.push_back(_tLogLineStruct(level, sstr.str()));
 
 		if (m_bEnableErrorsToNotificationSystem)
 		{
-			if (m_notification_log.size() >= MAX_LOG_LINE_BUFFER)
-				m_notification_log.erase(m_last_error_log.begin());
+			if (m_notification_log.size() >= m_max_log_lines)
+				m_notification_log.erase(m_notification_log.begin());
 			m_notification_log.push_back(_tLogLineStruct(level, sstr.str()));
 			if ((m_notification_log.size() == 1) && (mytime(NULL) - m_LastLogNotificationsSend >= 5))
 			{
@@ -205,13 +273,7 @@ bool strhasEnding(std::string const &fullString, std::string const &ending)
 
 void CLogger::LogNoLF(const _eLogLevel level, const char* logline, ...)
 {
-	boost::unique_lock< boost::mutex > lock(m_mutex);
-
-	bool bDoLog = false;
-  if (level <= (_eLogLevel)m_verbose_level )
-		bDoLog = true;
-
-	if (!bDoLog)
+	if (!IsEnabled(LOGCAT_ALL, level))
 		return;
 
 	va_list argList;
@@ -220,34 +282,37 @@ void CLogger::LogNoLF(const _eLogLevel level, const char* logline, ...)
 	vsnprintf(cbuffer, sizeof(cbuffer), logline, argList);
 	va_end(argList);
 
-    //test if log contain a string to be filtered from LOG content
-    if (TestFilter(cbuffer) ) return ;
+	boost::unique_lock< boost::mutex > lock(m_mutex);
+
+	//test if log contain a string to be filtered from LOG content
+	if (IsFiltered(cbuffer))
+		return;
 
 	std::string message=cbuffer;
 	if (strhasEnding(message,"\n"))
 	{
 		message=message.substr(0,message.size()-1);
 	}
-	if (m_lastlog.size()>=MAX_LOG_LINE_BUFFER)
+	if (m_lastlog.size()>=m_max_log_lines)
 		m_lastlog.erase(m_lastlog.begin());
 	m_lastlog.push_back(_tLogLineStruct(level,message));
 
 	if (level == LOG_STATUS)
 	{
-		if (m_last_status_log.size() >= MAX_LOG_LINE_BUFFER)
+		if (m_last_status_log.size() >= m_max_log_lines)
 			m_last_status_log.erase(m_last_status_log.begin());
 		m_last_status_log.push_back(_tLogLineStruct(level, message));
 	}
 	else if (level == LOG_ERROR)
 	{
-		if (m_last_error_log.size() >= MAX_LOG_LINE_BUFFER)
+		if (m_last_error_log.size() >= m_max_log_lines)
 			m_last_error_log.erase(m_last_error_log.begin());
 		m_last_error_log.push_back(_tLogLineStruct(level, message));
 
 		if (m_bEnableErrorsToNotificationSystem)
 		{
-			if (m_notification_log.size() >= MAX_LOG_LINE_BUFFER)
-				m_notification_log.erase(m_last_error_log.begin());
+			if (m_notification_log.size() >= m_max_log_lines)
+				m_notification_log.erase(m_notification_log.begin());
 			m_notification_log.push_back(_tLogLineStruct(level, message));
 			if ((m_notification_log.size() == 1) && (mytime(NULL) - m_LastLogNotificationsSend >= 5))
 			{
@@ -362,9 +427,8 @@ std::list<CLogger::_tLogLineStruct> CLogger::GetLog(const _eLogLevel lType)
 void CLogger::SetFilterString(std::string  &pFilter)
 {
 	std::vector<std::string> FilterList;
-	FilterString = pFilter;
-	FilterStringList.clear();
-	KeepStringList.clear();
+	std::vector<std::string> FilterStringList;
+	std::vector<std::string> KeepStringList;
 	StringSplit(pFilter, ";", FilterList);
 	for (unsigned int i=0;i<FilterList.size();i++)
 	{
@@ -373,38 +437,176 @@ void CLogger::SetFilterString(std::string  &pFilter)
 		else
 			FilterStringList.push_back (FilterList[i] );
 	}
+
+	boost::unique_lock< boost::mutex > lock(m_mutex);
+	FilterString = pFilter;
+	m_FilterMatcher.Build(FilterStringList);
+	m_KeepMatcher.Build(KeepStringList);
+	m_bHaveFilter = !m_FilterMatcher.empty();
+}
+
+//return true if trace enable (for the given subsystem)
+bool CLogger::isTraceEnabled(const _eLogCategory category)
+{
+	return IsEnabled(category, LOG_TRACE);
+}
+
+static const struct _tLogCategoryName
+{
+	_eLogCategory category;
+	const char *szName;
+} LogCategoryNames[] = {
+	{ LOGCAT_MAIN, "MAIN" },
+	{ LOGCAT_SQL, "SQL" },
+	{ LOGCAT_WEBSERVER, "WEB" },
+	{ LOGCAT_EVENTSYSTEM, "EVENT" },
+	{ LOGCAT_HARDWARE, "HARDWARE" },
+	{ LOGCAT_NONE, NULL }
+};
+
+//Categories is a comma separated list like "MAIN,SQL", empty or "ALL" traces every subsystem
+void CLogger::SetTraceCategories(const std::string &Categories)
+{
+	std::vector<std::string> strarray;
+	StringSplit(Categories, ",", strarray);
+	int mask = LOGCAT_NONE;
+	std::vector<std::string>::iterator itt;
+	for (itt = strarray.begin(); itt != strarray.end(); ++itt)
+	{
+		std::string szName = *itt;
+		stdstring_trim(szName);
+		std::transform(szName.begin(), szName.end(), szName.begin(), ::toupper);
+		if (szName == "ALL")
+		{
+			mask = LOGCAT_ALL;
+			break;
+		}
+		for (int ii = 0; LogCategoryNames[ii].szName != NULL; ii++)
+		{
+			if (szName == LogCategoryNames[ii].szName)
+				mask |= LogCategoryNames[ii].category;
+		}
+	}
+	if (strarray.empty())
+		mask = LOGCAT_ALL;
+	m_trace_categories = mask;
 }
 
-//return true if trace enable
-bool CLogger::isTraceEnabled()
+std::string CLogger::GetTraceCategories()
 {
-	return (m_verbose_level==	VBL_TRACE );
+	int mask = m_trace_categories;
+	if (mask == LOGCAT_ALL)
+		return "ALL";
+	std::string szCategories;
+	for (int ii = 0; LogCategoryNames[ii].szName != NULL; ii++)
+	{
+		if (mask & LogCategoryNames[ii].category)
+		{
+			if (!szCategories.empty())
+				szCategories += ",";
+			szCategories += LogCategoryNames[ii].szName;
+		}
+	}
+	return szCategories;
 }
 
 //return true if the log shall be filtered
-//
 bool CLogger::TestFilter(const char *cbuffer)
 {
-	bool filtered = false; //default not filtered
+	if (!m_bHaveFilter)
+		return false;
+	boost::unique_lock< boost::mutex > lock(m_mutex);
+	return IsFiltered(cbuffer);
+}
 
+//(m_mutex has to be locked by the caller)
+bool CLogger::IsFiltered(const char *cbuffer)
+{
+	if (!m_bHaveFilter)
+		return false;
 	//search if the log shall be filter
-	for (unsigned int i=0;i<FilterStringList.size();i++){
-		if (strstr ( cbuffer,FilterStringList[i].c_str() )!=0) {
-			filtered = true;
-			break;
-		}
-	}
+	if (!m_FilterMatcher.Match(cbuffer))
+		return false;
 	//if the log as been filtered , search if it shall be keeped
-	if (filtered)
+	return !m_KeepMatcher.Match(cbuffer);
+}
+
+void CLogger::CFilterMatcher::Build(const std::vector<std::string> &words)
+{
+	m_nodes.clear();
+	m_nodes.push_back(_tNode());
+
+	//build the trie
+	std::vector<std::string>::const_iterator itt;
+	for (itt = words.begin(); itt != words.end(); ++itt)
 	{
-		for (unsigned int i=0;i<KeepStringList.size();i++){
-			if (strstr ( cbuffer,KeepStringList[i].c_str() )!=0) {
-				filtered = false;
-				break;
+		if (itt->empty())
+			continue;
+		int state = 0;
+		std::string::const_iterator itc;
+		for (itc = itt->begin(); itc != itt->end(); ++itc)
+		{
+			std::map<char, int>::const_iterator itn = m_nodes[state].next.find(*itc);
+			if (itn != m_nodes[state].next.end())
+			{
+				state = itn->second;
+				continue;
 			}
+			int newstate = (int)m_nodes.size();
+			m_nodes.push_back(_tNode());
+			m_nodes[state].next[*itc] = newstate;
+			state = newstate;
+		}
+		m_nodes[state].output = true;
+	}
+
+	//breadth first pass to set the failure links
+	std::deque<int> queue;
+	std::map<char, int>::const_iterator itn;
+	for (itn = m_nodes[0].next.begin(); itn != m_nodes[0].next.end(); ++itn)
+		queue.push_back(itn->second);
+	while (!queue.empty())
+	{
+		int state = queue.front();
+		queue.pop_front();
+		for (itn = m_nodes[state].next.begin(); itn != m_nodes[state].next.end(); ++itn)
+		{
+			int child = itn->second;
+			int fail = m_nodes[state].fail;
+			while ((fail != 0) && (m_nodes[fail].next.find(itn->first) == m_nodes[fail].next.end()))
+				fail = m_nodes[fail].fail;
+			std::map<char, int>::const_iterator itf = m_nodes[fail].next.find(itn->first);
+			if ((itf != m_nodes[fail].next.end()) && (itf->second != child))
+				fail = itf->second;
+			m_nodes[child].fail = fail;
+			if (m_nodes[fail].output)
+				m_nodes[child].output = true;
+			queue.push_back(child);
 		}
 	}
-	return filtered;
+}
+
+bool CLogger::CFilterMatcher::Match(const char *szText) const
+{
+	if (empty())
+		return false;
+	int state = 0;
+	for (const char *pChar = szText; *pChar != 0; pChar++)
+	{
+		std::map<char, int>::const_iterator itn;
+		while (((itn = m_nodes[state].next.find(*pChar)) == m_nodes[state].next.end()) && (state != 0))
+			state = m_nodes[state].fail;
+		if (itn != m_nodes[state].next.end())
+			state = itn->second;
+		if (m_nodes[state].output)
+			return true;
+	}
+	return false;
+}
+
+bool CLogger::CFilterMatcher::empty() const
+{
+	return (m_nodes.size() < 2);
 }
 
 void CLogger::setLogVerboseLevel(int LogLevel)
@@ -430,7 +632,7 @@ bool  CLogger::GetLogDebug()
   return m_debug;
 }
 
-void CLogger::SetLogPreference (std::string  LogFilter, std::string  LogFileName , std::string  LogLevel )
+void CLogger::SetLogPreference (std::string  LogFilter, std::string  LogFileName , std::string  LogLevel, std::string LogTraceCategories )
 {
 	//if trace level is allowed
 	if (GetLogDebug()) {
@@ -438,14 +640,16 @@ void CLogger::SetLogPreference (std::string  LogFilter, std::string  LogFileName
 		m_sql.UpdatePreferencesVar("LogFilter", 0, LogFilter.c_str());
 		m_sql.UpdatePreferencesVar("LogFileName", 0, LogFileName.c_str());
 		m_sql.UpdatePreferencesVar("LogLevel", 0, LogLevel.c_str());
+		m_sql.UpdatePreferencesVar("LogTraceCategories", 0, LogTraceCategories.c_str());
 		SetFilterString(LogFilter);
+		SetTraceCategories(LogTraceCategories);
 		SetOutputFile(LogFileName.c_str());
 		setLogVerboseLevel(atoi(LogLevel.c_str()));
 	}
 }
 void CLogger::GetLogPreference()
 {
-	std::string LogFilter, LogFileName, LogLevel;
+	std::string LogFilter, LogFileName, LogLevel, LogTraceCategories;
 
   //if trace level is allowed
   if (GetLogDebug()){
@@ -453,7 +657,9 @@ void CLogger::GetLogPreference()
     m_sql.GetPreferencesVar("LogFilter", LogFilter);
     m_sql.GetPreferencesVar("LogFileName", LogFileName);
     m_sql.GetPreferencesVar("LogLevel", LogLevel);
+    m_sql.GetPreferencesVar("LogTraceCategories", LogTraceCategories);
     SetFilterString(LogFilter);
+    SetTraceCategories(LogTraceCategories);
     SetOutputFile(LogFileName.c_str());
 
     if (LogLevel.length() != 0)
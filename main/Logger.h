@@ -4,6 +4,9 @@
 #include <list>
 #include <string>
 #include <fstream>
+#include <map>
+#include <vector>
+#include <boost/atomic.hpp>
 
 enum _eLogLevel
 {
@@ -22,6 +25,18 @@ enum _eLogFileVerboseLevel
 
 };
 
+//Subsystems that can be traced independently (bitmask)
+enum _eLogCategory
+{
+	LOGCAT_NONE = 0x00,
+	LOGCAT_MAIN = 0x01,
+	LOGCAT_SQL = 0x02,
+	LOGCAT_WEBSERVER = 0x04,
+	LOGCAT_EVENTSYSTEM = 0x08,
+	LOGCAT_HARDWARE = 0x10,
+	LOGCAT_ALL = 0xFF
+};
+
 class CLogger
 {
 public:
@@ -38,8 +53,12 @@ public:
 
 	void SetOutputFile(const char *OutputFile);
 	void SetVerboseLevel(_eLogFileVerboseLevel vLevel);
+	void SetLogBufferSize(const size_t lines);
+	void SetLeanMode();
+	size_t GetMemoryUsage(size_t &nLines);
 
 	void Log(const _eLogLevel level, const char* logline, ...);
+	void Log(const _eLogCategory category, const _eLogLevel level, const char* logline, ...);
 	void LogNoLF(const _eLogLevel level, const char* logline, ...);
 
 	void LogSequenceStart();
@@ -51,10 +70,13 @@ public:
 	bool IsLogTimestampsEnabled();
 
 	void SetFilterString(std::string &Filter);
-	bool isTraceEnabled();
+	bool IsLogLevelEnabled(const _eLogLevel level);
+	bool isTraceEnabled(const _eLogCategory category = LOGCAT_ALL);
+	void SetTraceCategories(const std::string &Categories);
+	std::string GetTraceCategories();
 	bool TestFilter(const char *cbuffer);
 	void setLogVerboseLevel(int LogLevel);
-	void SetLogPreference(std::string LogFilter, std::string LogFileName, std::string LogLevel);
+	void SetLogPreference(std::string LogFilter, std::string LogFileName, std::string LogLevel, std::string LogTraceCategories);
 	void GetLogPreference();
 	void SetLogDebug(bool debug);
 	bool GetLogDebug();
@@ -66,21 +88,46 @@ public:
 	std::list<_tLogLineStruct> GetNotificationLogs();
 	bool NotificationLogsEnabled();
 private:
+	//Aho-Corasick automaton, matches all filter words in one pass over a log line
+	class CFilterMatcher
+	{
+	public:
+		void Build(const std::vector<std::string> &words);
+		bool Match(const char *szText) const;
+		bool empty() const;
+	private:
+		struct _tNode
+		{
+			std::map<char, int> next;
+			int fail;
+			bool output;
+			_tNode() : fail(0), output(false) {};
+		};
+		std::vector<_tNode> m_nodes;
+	};
+
+	bool IsEnabled(const _eLogCategory category, const _eLogLevel level);
+	bool IsFiltered(const char *cbuffer);
+	void LogLine(const _eLogLevel level, const char *cbuffer);
+
 	boost::mutex m_mutex;
 	std::ofstream m_outputfile;
 	std::deque<_tLogLineStruct> m_lastlog;
 	std::deque<_tLogLineStruct> m_last_status_log;
 	std::deque<_tLogLineStruct> m_last_error_log;
 	std::deque<_tLogLineStruct> m_notification_log;
+	size_t m_max_log_lines;
 	bool m_bInSequenceMode;
 	bool m_bEnableLogTimestamps;
 	bool m_bEnableErrorsToNotificationSystem;
 	time_t m_LastLogNotificationsSend;
 	std::stringstream m_sequencestring;
 	std::string FilterString;
-	std::vector<std::string> FilterStringList;	//contain the list of filtered words
-	std::vector<std::string> KeepStringList;	//contain the list of  words to be kept
-	_eLogFileVerboseLevel m_verbose_level;
+	CFilterMatcher m_FilterMatcher;	//filtered words
+	CFilterMatcher m_KeepMatcher;	//words to be kept
+	boost::atomic<bool> m_bHaveFilter;
+	boost::atomic<int> m_verbose_level;
+	boost::atomic<int> m_trace_categories;
 	bool m_debug;
 };
 extern CLogger _log;
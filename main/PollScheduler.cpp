@@ -0,0 +1,255 @@
+#include "stdafx.h"
+#include "PollScheduler.h"
+#include "Logger.h"
+#include "localtime_r.h"
+#include "../hardware/DomoticzHardware.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#define POLL_SCHEDULER_WORKERS 4
+#define POLL_STARTUP_DELAY 2		//first poll after registering (seconds)
+#define POLL_STARTUP_SPREAD 10		//spread the first polls of all hardware over this many seconds
+#define POLL_MAX_JITTER 5			//seconds, jitter is at most 10% of the interval
+#define POLL_MAX_BACKOFF 300		//seconds, longest delay between polls after failures
+
+CPollScheduler::CPollScheduler(void)
+{
+	m_nextPollID = 1;
+	m_stoprequested = false;
+}
+
+CPollScheduler::~CPollScheduler(void)
+{
+}
+
+void CPollScheduler::StartScheduler()
+{
+	m_stoprequested = false;
+	m_LastHousekeeping = boost::posix_time::microsec_clock::universal_time();
+	for (int ii = 0; ii < POLL_SCHEDULER_WORKERS; ii++)
+	{
+		m_workers.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CPollScheduler::Do_Work, this))));
+	}
+}
+
+void CPollScheduler::StopScheduler()
+{
+	{
+		boost::lock_guard<boost::mutex> l(m_mutex);
+		m_stoprequested = true;
+		m_cond.notify_all();
+	}
+	std::vector<boost::shared_ptr<boost::thread> >::iterator itt;
+	for (itt = m_workers.begin(); itt != m_workers.end(); ++itt)
+	{
+		(*itt)->join();
+	}
+	m_workers.clear();
+}
+
+int CPollScheduler::Register(CDomoticzHardwareBase *pHardware, const std::string &Name, const boost::function<bool()> &PollFunction, const int Interval, const int Timeout)
+{
+	boost::lock_guard<boost::mutex> l(m_mutex);
+	_tPollTask task;
+	task.PollID = m_nextPollID++;
+	task.pHardware = pHardware;
+	task.Name = Name;
+	task.PollFunction = PollFunction;
+	task.Interval = (Interval < 1) ? 1 : Interval;
+	task.Timeout = (Timeout < 1) ? task.Interval : Timeout;
+	task.bRunning = false;
+	task.bRemoved = false;
+	task.bTimeoutReported = false;
+	task.ConsecutiveFailures = 0;
+	task.Polls = 0;
+	task.Failures = 0;
+	task.LastDuration = 0;
+	task.MaxDuration = 0;
+	task.TotalDuration = 0;
+
+	//Do not let all hardware poll at the same moment at startup
+	int spread = (task.Interval < POLL_STARTUP_SPREAD) ? task.Interval : POLL_STARTUP_SPREAD;
+	task.NextRun = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(POLL_STARTUP_DELAY) + boost::posix_time::milliseconds(rand() % (spread * 1000));
+
+	m_tasks[task.PollID] = task;
+	m_cond.notify_all();
+	return task.PollID;
+}
+
+void CPollScheduler::Unregister(const int PollID)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	std::map<int, _tPollTask>::iterator itt = m_tasks.find(PollID);
+	if (itt == m_tasks.end())
+		return;
+	itt->second.bRemoved = true;
+	while (itt->second.bRunning)
+	{
+		m_cond.wait(lock);
+		itt = m_tasks.find(PollID);
+	}
+	m_tasks.erase(itt);
+}
+
+std::vector<CPollScheduler::_tPollStatistics> CPollScheduler::GetStatistics()
+{
+	boost::lock_guard<boost::mutex> l(m_mutex);
+	std::vector<_tPollStatistics> ret;
+	std::map<int, _tPollTask>::const_iterator itt;
+	for (itt = m_tasks.begin(); itt != m_tasks.end(); ++itt)
+	{
+		const _tPollTask &task = itt->second;
+		_tPollStatistics stats;
+		stats.PollID = task.PollID;
+		stats.HardwareID = (task.pHardware != NULL) ? task.pHardware->m_HwdID : -1;
+		stats.Name = task.Name;
+		stats.Interval = task.Interval;
+		stats.Polls = task.Polls;
+		stats.Failures = task.Failures;
+		stats.ConsecutiveFailures = task.ConsecutiveFailures;
+		stats.LastDuration = task.LastDuration;
+		stats.MaxDuration = task.MaxDuration;
+		stats.AvgDuration = (task.Polls > 0) ? int(task.TotalDuration / task.Polls) : 0;
+		stats.bRunning = task.bRunning;
+		ret.push_back(stats);
+	}
+	return ret;
+}
+
+int CPollScheduler::GetJitter(const int MaxMs)
+{
+	if (MaxMs <= 0)
+		return 0;
+	return (rand() % (2 * MaxMs + 1)) - MaxMs;
+}
+
+boost::posix_time::ptime CPollScheduler::GetNextRun(const _tPollTask &task, const boost::posix_time::ptime &now)
+{
+	int delay = task.Interval * 1000;
+	if (task.ConsecutiveFailures > 0)
+	{
+		//Back-off, double the interval for each failed poll
+		int maxdelay = (task.Interval > POLL_MAX_BACKOFF) ? task.Interval * 1000 : POLL_MAX_BACKOFF * 1000;
+		int shift = (task.ConsecutiveFailures < 5) ? task.ConsecutiveFailures : 5;
+		delay = delay << shift;
+		if (delay > maxdelay)
+			delay = maxdelay;
+	}
+	int maxjitter = delay / 10;
+	if (maxjitter > POLL_MAX_JITTER * 1000)
+		maxjitter = POLL_MAX_JITTER * 1000;
+	delay += GetJitter(maxjitter);
+
+	//Intervals are measured from the start of the previous poll
+	boost::posix_time::ptime next = task.StartTime + boost::posix_time::milliseconds(delay);
+	if (next < now)
+		next = now;
+	return next;
+}
+
+//Called with m_mutex locked
+void CPollScheduler::Housekeeping(const boost::posix_time::ptime &now)
+{
+	m_LastHousekeeping = now;
+	time_t atime = mytime(NULL);
+	std::map<int, _tPollTask>::iterator itt;
+	for (itt = m_tasks.begin(); itt != m_tasks.end(); ++itt)
+	{
+		_tPollTask &task = itt->second;
+		bool bHanging = (task.bRunning) && ((now - task.StartTime).total_seconds() > task.Timeout);
+		if (bHanging)
+		{
+			if (!task.bTimeoutReported)
+			{
+				_log.Log(LOG_ERROR, "PollScheduler: %s poll is taking longer than %d seconds!", task.Name.c_str(), task.Timeout);
+				task.bTimeoutReported = true;
+			}
+			//No heartbeat, mainworker will report the hardware as not responding
+			continue;
+		}
+		if (task.pHardware != NULL)
+			task.pHardware->m_LastHeartbeat = atime;
+	}
+}
+
+void CPollScheduler::Do_Work()
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	while (!m_stoprequested)
+	{
+		boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+		if ((now - m_LastHousekeeping).total_milliseconds() >= 1000)
+			Housekeeping(now);
+
+		//Find the poll that is due the longest
+		_tPollTask *pTask = NULL;
+		boost::posix_time::ptime wakeup = now + boost::posix_time::seconds(1);
+		std::map<int, _tPollTask>::iterator itt;
+		for (itt = m_tasks.begin(); itt != m_tasks.end(); ++itt)
+		{
+			_tPollTask &task = itt->second;
+			if ((task.bRunning) || (task.bRemoved))
+				continue;
+			if (task.NextRun <= now)
+			{
+				if ((pTask == NULL) || (task.NextRun < pTask->NextRun))
+					pTask = &task;
+			}
+			else if (task.NextRun < wakeup)
+				wakeup = task.NextRun;
+		}
+		if (pTask == NULL)
+		{
+			m_cond.timed_wait(lock, wakeup);
+			continue;
+		}
+
+		pTask->bRunning = true;
+		pTask->bTimeoutReported = false;
+		pTask->StartTime = now;
+		int PollID = pTask->PollID;
+		std::string Name = pTask->Name;
+		boost::function<bool()> PollFunction = pTask->PollFunction;
+		lock.unlock();
+
+		bool bSuccess = false;
+		try
+		{
+			bSuccess = PollFunction();
+		}
+		catch (std::exception& e)
+		{
+			_log.Log(LOG_ERROR, "PollScheduler: %s poll exception: %s", Name.c_str(), e.what());
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "PollScheduler: %s poll exception!", Name.c_str());
+		}
+
+		lock.lock();
+		now = boost::posix_time::microsec_clock::universal_time();
+		//The task can not be removed while running (Unregister waits for us)
+		itt = m_tasks.find(PollID);
+		if (itt != m_tasks.end())
+		{
+			_tPollTask &task = itt->second;
+			int duration = (int)(now - task.StartTime).total_milliseconds();
+			task.bRunning = false;
+			task.Polls++;
+			task.LastDuration = duration;
+			if (duration > task.MaxDuration)
+				task.MaxDuration = duration;
+			task.TotalDuration += duration;
+			if (bSuccess)
+				task.ConsecutiveFailures = 0;
+			else
+			{
+				task.Failures++;
+				task.ConsecutiveFailures++;
+			}
+			if (duration > task.Timeout * 1000)
+				_log.Log(LOG_STATUS, "PollScheduler: %s poll took %d ms", task.Name.c_str(), duration);
+			task.NextRun = GetNextRun(task, now);
+		}
+		m_cond.notify_all();
+	}
+}
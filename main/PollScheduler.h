@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+class CDomoticzHardwareBase;
+
+#define POLL_DEFAULT_TIMEOUT 30
+
+//Runs the periodic poll functions of network polled hardware on a small pool of worker threads
+class CPollScheduler
+{
+public:
+	struct _tPollStatistics
+	{
+		int PollID;
+		int HardwareID;
+		std::string Name;
+		int Interval;
+		unsigned long Polls;
+		unsigned long Failures;
+		int ConsecutiveFailures;
+		int LastDuration;	//ms
+		int MaxDuration;	//ms
+		int AvgDuration;	//ms
+		bool bRunning;
+	};
+
+	CPollScheduler(void);
+	~CPollScheduler(void);
+
+	void StartScheduler();
+	void StopScheduler();
+
+	//The poll function returns false when the poll failed, the next poll is then delayed (back-off)
+	//Timeout (seconds) is the time a poll is allowed to take before it is reported as hanging
+	int Register(CDomoticzHardwareBase *pHardware, const std::string &Name, const boost::function<bool()> &PollFunction, const int Interval, const int Timeout);
+	//Waits for a running poll to finish
+	void Unregister(const int PollID);
+
+	std::vector<_tPollStatistics> GetStatistics();
+private:
+	struct _tPollTask
+	{
+		int PollID;
+		CDomoticzHardwareBase *pHardware;
+		std::string Name;
+		boost::function<bool()> PollFunction;
+		int Interval;
+		int Timeout;
+		boost::posix_time::ptime NextRun;
+		boost::posix_time::ptime StartTime;
+		bool bRunning;
+		bool bRemoved;
+		bool bTimeoutReported;
+		int ConsecutiveFailures;
+		unsigned long Polls;
+		unsigned long Failures;
+		int LastDuration;
+		int MaxDuration;
+		double TotalDuration;
+	};
+
+	void Do_Work();
+	void Housekeeping(const boost::posix_time::ptime &now);
+	boost::posix_time::ptime GetNextRun(const _tPollTask &task, const boost::posix_time::ptime &now);
+	int GetJitter(const int MaxMs);
+
+	std::map<int, _tPollTask> m_tasks;
+	int m_nextPollID;
+	boost::mutex m_mutex;
+	boost::condition_variable m_cond;
+	volatile bool m_stoprequested;
+	std::vector<boost::shared_ptr<boost::thread> > m_workers;
+	boost::posix_time::ptime m_LastHousekeeping;
+};
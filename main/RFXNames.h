@@ -183,6 +183,7 @@ enum _eHardwareTypes {
 	HTYPE_IntergasInComfortLAN2RF,			//99
 	HTYPE_RelayNet,				//100
 	HTYPE_KMTronicUDP,			//101
+	HTYPE_TelemetryIngest,		//102
 	HTYPE_END
 };
 
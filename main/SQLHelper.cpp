@@ -32,10 +32,21 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
-#define DB_VERSION 113
+#define DB_VERSION 114
+
+//Distance between the [Order] values of rows, leaves room to move a row between two others
+#define ORDER_GAP 1000
+//ORDER_GAP as text, for the insert triggers
+#define ORDER_GAP_STRINGIFY(x) #x
+#define ORDER_GAP_STR(x) ORDER_GAP_STRINGIFY(x)
+
+//History cleanup deletes at most this many rows per statement, pausing in between
+#define RETENTION_DELETE_CHUNK_SIZE 500
+#define RETENTION_DELETE_CHUNK_PAUSE 5
 
 extern http::server::CWebServerHelper m_webservers;
 extern std::string szWWWFolder;
+extern bool g_bLeanMode;
 
 const char *sqlCreateDeviceStatus =
 "CREATE TABLE IF NOT EXISTS [DeviceStatus] ("
@@ -70,7 +81,7 @@ const char *sqlCreateDeviceStatus =
 const char *sqlCreateDeviceStatusTrigger =
 "CREATE TRIGGER IF NOT EXISTS devicestatusupdate AFTER INSERT ON DeviceStatus\n"
 "BEGIN\n"
-"	UPDATE DeviceStatus SET [Order] = (SELECT MAX([Order]) FROM DeviceStatus)+1 WHERE DeviceStatus.ID = NEW.ID;\n"
+"	UPDATE DeviceStatus SET [Order] = IFNULL((SELECT MAX([Order]) FROM DeviceStatus),0)+" ORDER_GAP_STR(ORDER_GAP) " WHERE DeviceStatus.ID = NEW.ID;\n"
 "END;\n";
 
 const char *sqlCreateEventActions =
@@ -322,7 +333,7 @@ const char *sqlCreatePlanMappings =
 const char *sqlCreateDevicesToPlanStatusTrigger =
 	"CREATE TRIGGER IF NOT EXISTS deviceplantatusupdate AFTER INSERT ON DeviceToPlansMap\n"
 	"BEGIN\n"
-	"	UPDATE DeviceToPlansMap SET [Order] = (SELECT MAX([Order]) FROM DeviceToPlansMap)+1 WHERE DeviceToPlansMap.ID = NEW.ID;\n"
+	"	UPDATE DeviceToPlansMap SET [Order] = IFNULL((SELECT MAX([Order]) FROM DeviceToPlansMap),0)+" ORDER_GAP_STR(ORDER_GAP) " WHERE DeviceToPlansMap.ID = NEW.ID;\n"
 	"END;\n";
 
 const char *sqlCreatePlans =
@@ -357,7 +368,7 @@ const char *sqlCreateScenes =
 const char *sqlCreateScenesTrigger =
 "CREATE TRIGGER IF NOT EXISTS scenesupdate AFTER INSERT ON Scenes\n"
 "BEGIN\n"
-"	UPDATE Scenes SET [Order] = (SELECT MAX([Order]) FROM Scenes)+1 WHERE Scenes.ID = NEW.ID;\n"
+"	UPDATE Scenes SET [Order] = IFNULL((SELECT MAX([Order]) FROM Scenes),0)+" ORDER_GAP_STR(ORDER_GAP) " WHERE Scenes.ID = NEW.ID;\n"
 "END;\n";
 
 const char *sqlCreateSceneDevices =
@@ -650,6 +661,7 @@ CSQLHelper::CSQLHelper(void)
 	m_iAcceptHardwareTimerCounter=0;
 	m_bDisableEventSystem = false;
 	m_ShortLogInterval = 5;
+	m_bEpochTimestamps = false;
 	m_bPreviousAcceptNewHardware = false;
 
 	SetDatabaseName("domoticz.db");
@@ -687,6 +699,11 @@ bool CSQLHelper::OpenDatabase()
 	sqlite3_exec(m_dbase, "PRAGMA journal_mode=DELETE", NULL, NULL, NULL);
 #endif
     sqlite3_exec(m_dbase, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
+	if (g_bLeanMode)
+	{
+		//512 kB page cache instead of the default 2 MB
+		sqlite3_exec(m_dbase, "PRAGMA cache_size = -512", NULL, NULL, NULL);
+	}
 	std::vector<std::vector<std::string> > result=query("SELECT name FROM sqlite_master WHERE type='table' AND name='DeviceStatus'");
 	bool bNewInstall=(result.size()==0);
 	int dbversion=0;
@@ -761,6 +778,9 @@ bool CSQLHelper::OpenDatabase()
 	query(sqlCreateMobileDevices);
 	//Add indexes to log tables
 	query("create index if not exists ds_hduts_idx    on DeviceStatus(HardwareID, DeviceID, Unit, Type, SubType);");
+	query("create index if not exists ds_order_idx    on DeviceStatus([Order]);");
+	query("create index if not exists s_order_idx     on Scenes([Order]);");
+	query("create index if not exists dp_order_idx    on DeviceToPlansMap(PlanID, [Order]);");
 	query("create index if not exists f_id_idx        on Fan(DeviceRowID);");
 	query("create index if not exists f_id_date_idx   on Fan(DeviceRowID, Date);");
 	query("create index if not exists fc_id_idx       on Fan_Calendar(DeviceRowID);");
@@ -797,6 +817,17 @@ bool CSQLHelper::OpenDatabase()
 	query("create index if not exists w_id_date_idx   on Wind(DeviceRowID, Date);");
 	query("create index if not exists wc_id_idx       on Wind_Calendar(DeviceRowID);");
 	query("create index if not exists wc_id_date_idx  on Wind_Calendar(DeviceRowID, Date);");
+	//Date indexes for the retention cleanup
+	query("create index if not exists f_date_idx      on Fan(Date);");
+	query("create index if not exists ll_date_idx     on LightingLog(Date);");
+	query("create index if not exists sl_date_idx     on SceneLog(Date);");
+	query("create index if not exists m_date_idx      on Meter(Date);");
+	query("create index if not exists mm_date_idx     on MultiMeter(Date);");
+	query("create index if not exists p_date_idx      on Percentage(Date);");
+	query("create index if not exists r_date_idx      on Rain(Date);");
+	query("create index if not exists t_date_idx      on Temperature(Date);");
+	query("create index if not exists u_date_idx      on UV(Date);");
+	query("create index if not exists w_date_idx      on Wind(Date);");
 
 	if ((!bNewInstall) && (dbversion < DB_VERSION))
 	{
@@ -2218,6 +2249,25 @@ bool CSQLHelper::OpenDatabase()
 				}
 			}
 		}
+		if (dbversion < 114)
+		{
+			//Spread the [Order] values so rows can be moved without renumbering the whole table
+			query("DROP TRIGGER IF EXISTS devicestatusupdate");
+			query(sqlCreateDeviceStatusTrigger);
+			query("DROP TRIGGER IF EXISTS deviceplantatusupdate");
+			query(sqlCreateDevicesToPlanStatusTrigger);
+			query("DROP TRIGGER IF EXISTS scenesupdate");
+			query(sqlCreateScenesTrigger);
+			RenumberOrder("DeviceStatus", "");
+			RenumberOrder("Scenes", "");
+			std::vector<std::vector<std::string> > result;
+			result = query("SELECT DISTINCT PlanID FROM DeviceToPlansMap");
+			std::vector<std::vector<std::string> >::const_iterator itt;
+			for (itt = result.begin(); itt != result.end(); ++itt)
+			{
+				RenumberOrder("DeviceToPlansMap", "PlanID==" + (*itt)[0]);
+			}
+		}
 	}
 	else if (bNewInstall)
 	{
@@ -2550,6 +2600,12 @@ bool CSQLHelper::OpenDatabase()
 	}
 	m_bLogEventScriptTrigger = (nValue != 0);
 
+	nValue = 10;
+	if ((!GetPreferencesVar("LuaScriptTimeout", nValue)) || (nValue < 1))
+	{
+		UpdatePreferencesVar("LuaScriptTimeout", 10);
+	}
+
 	if ((!GetPreferencesVar("WebTheme", sValue)) || (sValue.empty()))
 	{
 		UpdatePreferencesVar("WebTheme", "default");
@@ -2623,6 +2679,11 @@ bool CSQLHelper::OpenDatabase()
 	{
 		UpdatePreferencesVar("ShowUpdateEffect", 0);
 	}
+	nValue = 1;
+	if ((!GetPreferencesVar("PythonPluginThreads", nValue)) || (nValue < 0))
+	{
+		UpdatePreferencesVar("PythonPluginThreads", 1);
+	}
 	nValue = 5;
 	if (!GetPreferencesVar("ShortLogInterval", nValue))
 	{
@@ -2632,6 +2693,13 @@ bool CSQLHelper::OpenDatabase()
 		nValue = 5;
 	m_ShortLogInterval = nValue;
 
+	nValue = 0;
+	if (!GetPreferencesVar("EpochTimestamps", nValue))
+	{
+		UpdatePreferencesVar("EpochTimestamps", 0);
+	}
+	SetupEpochTimestamps(nValue != 0);
+
 	if (!GetPreferencesVar("SendErrorsAsNotification", nValue))
 	{
 		UpdatePreferencesVar("SendErrorsAsNotification", 0);
@@ -2724,8 +2792,8 @@ void CSQLHelper::Do_Work()
 		std::vector<_tTaskItem>::iterator itt=_items2do.begin();
 		while (itt!=_items2do.end())
 		{
-			if (_log.isTraceEnabled())
-						_log.Log(LOG_TRACE,"SQLH: Do Task ItemType:%d Cmd:%s Value:%s ",itt->_ItemType ,itt->_command.c_str() ,itt->_sValue.c_str() );
+			if (_log.isTraceEnabled(LOGCAT_SQL))
+						_log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH: Do Task ItemType:%d Cmd:%s Value:%s ",itt->_ItemType ,itt->_command.c_str() ,itt->_sValue.c_str() );
 
 			if (itt->_ItemType == TITEM_SWITCHCMD)
 			{
@@ -2917,6 +2985,12 @@ void CSQLHelper::Do_Work()
 	}
 }
 
+//Number of bytes currently allocated by SQLite (page cache, prepared statements)
+size_t CSQLHelper::GetMemoryUsage()
+{
+	return (size_t)sqlite3_memory_used();
+}
+
 void CSQLHelper::SetDatabaseName(const std::string &DBName)
 {
 	m_dbase_name=DBName;
@@ -3016,8 +3090,8 @@ std::vector<std::vector<std::string> > CSQLHelper::query(const std::string &szQu
 		sqlite3_finalize(statement);
 	}
 
-	if (_log.isTraceEnabled()) {
-		_log.Log(LOG_TRACE, "SQLQ query : %s", szQuery.c_str());
+	if (_log.isTraceEnabled(LOGCAT_SQL)) {
+		_log.Log(LOGCAT_SQL, LOG_TRACE, "SQLQ query : %s", szQuery.c_str());
 		if (!_log.TestFilter("SQLR"))
 			LogQueryResult(results);
 	}
@@ -3724,7 +3798,7 @@ uint64_t CSQLHelper::UpdateValueInt(const int HardwareID, const char* ID, const
 		break;
 	}
 
-	if (_log.isTraceEnabled()) _log.Log(LOG_TRACE,"SQLH UpdateValueInt %s HwID:%d  DevID:%s Type:%d  sType:%d nValue:%d sValue:%s ", devname.c_str(),HardwareID, ID, devType, subType, nValue, sValue );
+	_log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH UpdateValueInt %s HwID:%d  DevID:%s Type:%d  sType:%d nValue:%d sValue:%s ", devname.c_str(),HardwareID, ID, devType, subType, nValue, sValue );
 
 	if (bDeviceUsed)
 		m_mainworker.m_eventsystem.ProcessDevice(HardwareID, ulID, unit, devType, subType, signallevel, batterylevel, nValue, sValue, devname, 0);
@@ -4024,20 +4098,32 @@ void CSQLHelper::ScheduleShortlog()
 		//Force WAL flush
 		sqlite3_wal_checkpoint(m_dbase, NULL);
 
-		UpdateTemperatureLog();
-		UpdateRainLog();
-		UpdateWindLog();
-		UpdateUVLog();
-		UpdateMeter();
-		UpdateMultiMeter();
-		UpdatePercentageLog();
-		UpdateFanLog();
+		int SensorTimeOut = 60;
+		GetPreferencesVar("SensorTimeout", SensorTimeOut);
+
+		//Take one snapshot of the device states, and collect all samples in memory
+		std::vector<_tShortLogDevice> devices;
+		GetShortLogDevices(devices);
+
+		UpdateTemperatureLog(devices, SensorTimeOut);
+		UpdateRainLog(devices, SensorTimeOut);
+		UpdateWindLog(devices, SensorTimeOut);
+		UpdateUVLog(devices, SensorTimeOut);
+		UpdateMeter(devices, SensorTimeOut);
+		UpdateMultiMeter(devices, SensorTimeOut);
+		UpdatePercentageLog(devices, SensorTimeOut);
+		UpdateFanLog(devices, SensorTimeOut);
+
+		//Write them in one transaction
+		FlushShortLogRecords();
+
 		//Removing the line below could cause a very large database,
 		//and slow(large) data transfer (specially when working remote!!)
 		CleanupShortLog();
 	}
 	catch (boost::exception & e)
 	{
+		m_shortlog_records.clear();
 		_log.Log(LOG_ERROR, "Domoticz: Error running the shortlog schedule script!");
 #ifdef _DEBUG
 		_log.Log(LOG_ERROR, "-----------------\n%s\n----------------", boost::diagnostic_information(e).c_str());
@@ -4048,6 +4134,166 @@ void CSQLHelper::ScheduleShortlog()
 	}
 }
 
+void CSQLHelper::GetShortLogDevices(std::vector<_tShortLogDevice> &devices)
+{
+	devices.clear();
+
+	time_t now = mytime(NULL);
+	if (now == 0)
+		return;
+
+	std::vector<std::vector<std::string> > result;
+	result = safe_query("SELECT ID,Name,HardwareID,DeviceID,Unit,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus");
+	devices.reserve(result.size());
+
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		const std::vector<std::string> &sd = *itt;
+
+		_tShortLogDevice dev;
+		std::stringstream s_str(sd[0]);
+		s_str >> dev.ID;
+		dev.Name = sd[1];
+		dev.HardwareID = atoi(sd[2].c_str());
+		dev.DeviceID = sd[3];
+		dev.Unit = atoi(sd[4].c_str());
+		dev.devType = atoi(sd[5].c_str());
+		dev.subType = atoi(sd[6].c_str());
+		dev.nValue = atoi(sd[7].c_str());
+		dev.sValue = sd[8];
+
+		time_t checktime = 0;
+		SQLdatetimeToEpoch(sd[9], checktime);
+		dev.Age = difftime(now, checktime);
+
+		devices.push_back(dev);
+	}
+}
+
+void CSQLHelper::AddShortLogRecord(const std::string &Table, const std::string &Columns, const std::vector<std::string> &Values)
+{
+	_tShortLogTable &tbl = m_shortlog_records[Table];
+	if (tbl.Columns.empty())
+	{
+		tbl.Columns = Columns;
+		tbl.ColumnCount = Values.size();
+	}
+	if (Values.size() != tbl.ColumnCount)
+		return; //should not happen
+	tbl.Values.insert(tbl.Values.end(), Values.begin(), Values.end());
+}
+
+void CSQLHelper::FlushShortLogRecords()
+{
+	if (m_shortlog_records.empty())
+		return;
+
+	boost::lock_guard<boost::mutex> l(m_sqlQueryMutex);
+
+	sqlite3_exec(m_dbase, "BEGIN TRANSACTION", NULL, NULL, NULL);
+
+	//Fill DateUTC ourselves, so the insert trigger has nothing to do
+	std::string szColumnsUTC;
+	std::string szRowUTC;
+	if (m_bEpochTimestamps)
+	{
+		std::stringstream sstr;
+		sstr << (long long)mytime(NULL);
+		szColumnsUTC = ", DateUTC";
+		szRowUTC = "," + sstr.str();
+	}
+
+	std::map<std::string, _tShortLogTable>::const_iterator itt;
+	for (itt = m_shortlog_records.begin(); itt != m_shortlog_records.end(); ++itt)
+	{
+		const _tShortLogTable &tbl = itt->second;
+		if ((tbl.ColumnCount == 0) || (tbl.Values.empty()))
+			continue;
+
+		//Stay below the default SQLITE_MAX_VARIABLE_NUMBER (999)
+		size_t maxRows = 999 / tbl.ColumnCount;
+		size_t totRows = tbl.Values.size() / tbl.ColumnCount;
+
+		std::string szRow = "(";
+		for (size_t ii = 0; ii < tbl.ColumnCount; ii++)
+			szRow += (ii == 0) ? "?" : ",?";
+		szRow += szRowUTC + ")";
+
+		sqlite3_stmt *statement = NULL;
+		size_t stmtRows = 0;
+		size_t vpos = 0;
+		while (totRows > 0)
+		{
+			size_t nRows = (totRows > maxRows) ? maxRows : totRows;
+			if (nRows != stmtRows)
+			{
+				//(re)prepare for this amount of rows, a full chunk is reused until the last one
+				if (statement)
+					sqlite3_finalize(statement);
+				statement = NULL;
+				std::string szQuery = "INSERT INTO " + itt->first + " (" + tbl.Columns + szColumnsUTC + ") VALUES " + szRow;
+				for (size_t ii = 1; ii < nRows; ii++)
+					szQuery += "," + szRow;
+				if (sqlite3_prepare_v2(m_dbase, szQuery.c_str(), -1, &statement, NULL) != SQLITE_OK)
+				{
+					_log.Log(LOG_ERROR, "SQL: Problem preparing shortlog insert for %s: %s", itt->first.c_str(), sqlite3_errmsg(m_dbase));
+					statement = NULL;
+					break;
+				}
+				stmtRows = nRows;
+			}
+			else
+				sqlite3_reset(statement);
+
+			size_t nValues = nRows * tbl.ColumnCount;
+			for (size_t ii = 0; ii < nValues; ii++)
+			{
+				const std::string &sValue = tbl.Values[vpos + ii];
+				sqlite3_bind_text(statement, (int)ii + 1, sValue.c_str(), (int)sValue.size(), SQLITE_STATIC);
+			}
+			if (sqlite3_step(statement) != SQLITE_DONE)
+				_log.Log(LOG_ERROR, "SQL: Problem inserting shortlog records into %s: %s", itt->first.c_str(), sqlite3_errmsg(m_dbase));
+			vpos += nValues;
+			totRows -= nRows;
+		}
+		if (statement)
+			sqlite3_finalize(statement);
+	}
+
+	sqlite3_exec(m_dbase, "COMMIT TRANSACTION", NULL, NULL, NULL);
+	m_shortlog_records.clear();
+}
+
+static const char *szShortLogTables[] = { "Temperature", "Rain", "Wind", "UV", "Meter", "MultiMeter", "Percentage", "Fan", NULL };
+
+//Opt-in (EpochTimestamps preference): the short log tables get a DateUTC column with the UTC epoch of the (local time) Date column.
+//Date stays the column shown by the API, DateUTC is used for sorting and retention, which are then integer compares and DST proof.
+void CSQLHelper::SetupEpochTimestamps(const bool bEnabled)
+{
+	for (int ii = 0; szShortLogTables[ii] != NULL; ii++)
+	{
+		const char *szTable = szShortLogTables[ii];
+		if (!bEnabled)
+		{
+			//keep the column (and its index), it is completed again when the option is enabled
+			safe_query("DROP TRIGGER IF EXISTS %s_DateUTC", szTable);
+			continue;
+		}
+		if (!DoesColumnExistsInTable("DateUTC", szTable))
+		{
+			_log.Log(LOG_STATUS, "SQL: Adding epoch timestamps to the %s table...", szTable);
+			safe_query("ALTER TABLE %s ADD COLUMN [DateUTC] INTEGER DEFAULT NULL", szTable);
+		}
+		safe_query("UPDATE %s SET DateUTC=CAST(strftime('%%s', Date, 'utc') AS INTEGER) WHERE (DateUTC IS NULL)", szTable);
+		safe_query("CREATE INDEX IF NOT EXISTS %s_idx_dateutc ON %s (DateUTC)", szTable, szTable);
+		safe_query("CREATE INDEX IF NOT EXISTS %s_idx_id_dateutc ON %s (DeviceRowID, DateUTC)", szTable, szTable);
+		//Rows that are not inserted by FlushShortLogRecords
+		safe_query("CREATE TRIGGER IF NOT EXISTS %s_DateUTC AFTER INSERT ON %s WHEN NEW.DateUTC IS NULL BEGIN UPDATE %s SET DateUTC=CAST(strftime('%%s', NEW.Date, 'utc') AS INTEGER) WHERE (rowid==NEW.rowid); END;", szTable, szTable, szTable);
+	}
+	m_bEpochTimestamps = bEnabled;
+}
+
 void CSQLHelper::ScheduleDay()
 {
 	if (!m_dbase)
@@ -4080,872 +4326,685 @@ void CSQLHelper::ScheduleDay()
 	}
 }
 
-void CSQLHelper::UpdateTemperatureLog()
+void CSQLHelper::UpdateTemperatureLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
 {
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
+	{
+		const _tShortLogDevice &dev = *itt;
+
+		uint64_t ID = dev.ID;
+		unsigned char dType = dev.devType;
+		unsigned char dSubType = dev.subType;
+		int nValue = dev.nValue;
+		const std::string &sValue = dev.sValue;
+
+		switch (dType)
+		{
+		case pTypeTEMP:
+		case pTypeHUM:
+		case pTypeTEMP_HUM:
+		case pTypeTEMP_HUM_BARO:
+		case pTypeTEMP_BARO:
+		case pTypeUV:
+		case pTypeWIND:
+		case pTypeThermostat1:
+		case pTypeRFXSensor:
+		case pTypeRego6XXTemp:
+		case pTypeEvohomeZone:
+		case pTypeEvohomeWater:
+		case pTypeRadiator1:
+			break;
+		case pTypeGeneral:
+			if ((dSubType != sTypeSystemTemp) && (dSubType != sTypeBaro))
+				continue;
+			break;
+		case pTypeThermostat:
+			if (dSubType != sTypeThermSetpoint)
+				continue;
+			break;
+		default:
+			continue;
+		}
 
-	std::vector<std::vector<std::string> > result;
-	result=safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR Type=%d OR (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d))",
-		pTypeTEMP,
-		pTypeHUM,
-		pTypeTEMP_HUM,
-		pTypeTEMP_HUM_BARO,
-		pTypeTEMP_BARO,
-		pTypeUV,
-		pTypeWIND,
-		pTypeThermostat1,
-		pTypeRFXSensor,
-		pTypeRego6XXTemp,
-		pTypeEvohomeZone,
-		pTypeEvohomeWater,
-		pTypeRadiator1,
-		pTypeGeneral,sTypeSystemTemp,
-		pTypeThermostat,sTypeThermSetpoint,
-		pTypeGeneral, sTypeBaro
-		);
-	if (result.size()>0)
-	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
+		if (dType != pTypeRadiator1)
 		{
-			std::vector<std::string> sd=*itt;
+			//do not include sensors that have no reading within an hour (except for devices that do not provide feedback, like the smartware radiator)
+			if (dev.Age >= SensorTimeOut * 60)
+				continue;
+		}
 
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
+		std::vector<std::string> splitresults;
+		StringSplit(sValue, ";", splitresults);
+		if (splitresults.size()<1)
+			continue; //impossible
 
-			unsigned char dType=atoi(sd[1].c_str());
-			unsigned char dSubType=atoi(sd[2].c_str());
-			int nValue=atoi(sd[3].c_str());
-			std::string sValue=sd[4];
+		float temp=0;
+		float chill=0;
+		unsigned char humidity=0;
+		int barometer=0;
+		float dewpoint=0;
+		float setpoint=0;
 
-			if (dType != pTypeRadiator1)
+		switch (dType)
+		{
+		case pTypeRego6XXTemp:
+		case pTypeTEMP:
+		case pTypeThermostat:
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			break;
+		case pTypeThermostat1:
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			break;
+		case pTypeRadiator1:
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			break;
+		case pTypeEvohomeWater:
+			if (splitresults.size()>=2)
 			{
-				//do not include sensors that have no reading within an hour (except for devices that do not provide feedback, like the smartware radiator)
-				std::string sLastUpdate = sd[5];
-				struct tm ntime;
-				time_t checktime;
-				ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-				if (difftime(now,checktime) >= SensorTimeOut * 60)
-					continue;
+				temp=static_cast<float>(atof(splitresults[0].c_str()));
+				setpoint=static_cast<float>((splitresults[1]=="On")?60:0);
+				//FIXME hack setpoint just on or off...may throw graph out so maybe pick sensible on off values?
+				//(if the actual hw set point was retrievable should use that otherwise some config option)
+				//actually if we plot the average it should give us an idea of how often hw has been switched on
+				//more meaningful if it was plotted against the zone valve & boiler relay i guess (actual time hw heated)
 			}
-
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size()<1)
-				continue; //impossible
-
-			float temp=0;
-			float chill=0;
-			unsigned char humidity=0;
-			int barometer=0;
-			float dewpoint=0;
-			float setpoint=0;
-
-			switch (dType)
+			break;
+		case pTypeEvohomeZone:
+			if (splitresults.size()>=2)
+			{
+				temp=static_cast<float>(atof(splitresults[0].c_str()));
+				setpoint=static_cast<float>(atof(splitresults[1].c_str()));
+			}
+			break;
+		case pTypeHUM:
+			humidity=nValue;
+			break;
+		case pTypeTEMP_HUM:
+			if (splitresults.size()>=2)
 			{
-			case pTypeRego6XXTemp:
-			case pTypeTEMP:
-			case pTypeThermostat:
 				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeThermostat1:
+				humidity=atoi(splitresults[1].c_str());
+				dewpoint=(float)CalculateDewPoint(temp,humidity);
+			}
+			break;
+		case pTypeTEMP_HUM_BARO:
+			if (splitresults.size()==5)
+			{
 				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeRadiator1:
+				humidity=atoi(splitresults[1].c_str());
+				if (dSubType==sTypeTHBFloat)
+					barometer=int(atof(splitresults[3].c_str())*10.0f);
+				else
+					barometer=atoi(splitresults[3].c_str());
+				dewpoint=(float)CalculateDewPoint(temp,humidity);
+			}
+			break;
+		case pTypeTEMP_BARO:
+			if (splitresults.size()>=2)
+			{
 				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeEvohomeWater:
-				if (splitresults.size()>=2)
-				{
-					temp=static_cast<float>(atof(splitresults[0].c_str()));
-					setpoint=static_cast<float>((splitresults[1]=="On")?60:0);
-					//FIXME hack setpoint just on or off...may throw graph out so maybe pick sensible on off values?
-					//(if the actual hw set point was retrievable should use that otherwise some config option)
-					//actually if we plot the average it should give us an idea of how often hw has been switched on
-					//more meaningful if it was plotted against the zone valve & boiler relay i guess (actual time hw heated)
-				}
-				break;
-			case pTypeEvohomeZone:
-				if (splitresults.size()>=2)
-				{
-					temp=static_cast<float>(atof(splitresults[0].c_str()));
-					setpoint=static_cast<float>(atof(splitresults[1].c_str()));
-				}
-				break;
-			case pTypeHUM:
-				humidity=nValue;
-				break;
-			case pTypeTEMP_HUM:
-				if (splitresults.size()>=2)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					humidity=atoi(splitresults[1].c_str());
-					dewpoint=(float)CalculateDewPoint(temp,humidity);
-				}
-				break;
-			case pTypeTEMP_HUM_BARO:
-				if (splitresults.size()==5)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					humidity=atoi(splitresults[1].c_str());
-					if (dSubType==sTypeTHBFloat)
-						barometer=int(atof(splitresults[3].c_str())*10.0f);
-					else
-						barometer=atoi(splitresults[3].c_str());
-					dewpoint=(float)CalculateDewPoint(temp,humidity);
-				}
-				break;
-			case pTypeTEMP_BARO:
-				if (splitresults.size()>=2)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-					barometer=int(atof(splitresults[1].c_str())*10.0f);
-				}
-				break;
-			case pTypeUV:
-				if (dSubType!=sTypeUV3)
-					continue;
-				if (splitresults.size()>=2)
-				{
-					temp = static_cast<float>(atof(splitresults[1].c_str()));
-				}
-				break;
-			case pTypeWIND:
-				if ((dSubType!=sTypeWIND4)&&(dSubType!=sTypeWINDNoTemp))
-					continue;
-				if (splitresults.size()>=6)
-				{
-					temp = static_cast<float>(atof(splitresults[4].c_str()));
-					chill = static_cast<float>(atof(splitresults[5].c_str()));
-				}
-				break;
-			case pTypeRFXSensor:
-				if (dSubType!=sTypeRFXSensorTemp)
-					continue;
+				barometer=int(atof(splitresults[1].c_str())*10.0f);
+			}
+			break;
+		case pTypeUV:
+			if (dSubType!=sTypeUV3)
+				continue;
+			if (splitresults.size()>=2)
+			{
+				temp = static_cast<float>(atof(splitresults[1].c_str()));
+			}
+			break;
+		case pTypeWIND:
+			if ((dSubType!=sTypeWIND4)&&(dSubType!=sTypeWINDNoTemp))
+				continue;
+			if (splitresults.size()>=6)
+			{
+				temp = static_cast<float>(atof(splitresults[4].c_str()));
+				chill = static_cast<float>(atof(splitresults[5].c_str()));
+			}
+			break;
+		case pTypeRFXSensor:
+			if (dSubType!=sTypeRFXSensorTemp)
+				continue;
+			temp = static_cast<float>(atof(splitresults[0].c_str()));
+			break;
+		case pTypeGeneral:
+			if (dSubType == sTypeSystemTemp)
+			{
 				temp = static_cast<float>(atof(splitresults[0].c_str()));
-				break;
-			case pTypeGeneral:
-				if (dSubType == sTypeSystemTemp)
-				{
-					temp = static_cast<float>(atof(splitresults[0].c_str()));
-				}
-				else if (dSubType == sTypeBaro)
-				{
-					if (splitresults.size() != 2)
-						continue;
-					barometer = int(atof(splitresults[0].c_str())*10.0f);
-				}
-				break;
 			}
-			//insert record
-			safe_query(
-				"INSERT INTO Temperature (DeviceRowID, Temperature, Chill, Humidity, Barometer, DewPoint, SetPoint) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%.2f', '%d', '%d', '%.2f', '%.2f')",
-				ID,
-				temp,
-				chill,
-				humidity,
-				barometer,
-				dewpoint,
-				setpoint
-				);
+			else if (dSubType == sTypeBaro)
+			{
+				if (splitresults.size() != 2)
+					continue;
+				barometer = int(atof(splitresults[0].c_str())*10.0f);
+			}
+			break;
 		}
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%.2f", temp);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%.2f", chill);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%d", humidity);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%d", barometer);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%.2f", dewpoint);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%.2f", setpoint);
+		values.push_back(szTmp);
+		AddShortLogRecord("Temperature", "DeviceRowID, Temperature, Chill, Humidity, Barometer, DewPoint, SetPoint", values);
 	}
 }
 
-void CSQLHelper::UpdateRainLog()
+void CSQLHelper::UpdateRainLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
 {
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d)", pTypeRAIN);
-	if (result.size()>0)
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
 	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
-		{
-			std::vector<std::string> sd=*itt;
-
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue=sd[4];
-
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate=sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
+		const _tShortLogDevice &dev = *itt;
+		if (dev.devType != pTypeRAIN)
+			continue;
 
-			if (difftime(now,checktime) >= SensorTimeOut * 60)
-				continue;
+		//do not include sensors that have no reading within an hour
+		if (dev.Age >= SensorTimeOut * 60)
+			continue;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size()<2)
-				continue; //impossible
+		std::vector<std::string> splitresults;
+		StringSplit(dev.sValue, ";", splitresults);
+		if (splitresults.size()<2)
+			continue; //impossible
 
-			int rate=atoi(splitresults[0].c_str());
-			float total = static_cast<float>(atof(splitresults[1].c_str()));
+		int rate=atoi(splitresults[0].c_str());
+		float total = static_cast<float>(atof(splitresults[1].c_str()));
 
-			//insert record
-			safe_query(
-				"INSERT INTO Rain (DeviceRowID, Total, Rate) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%d')",
-				ID,
-				total,
-				rate
-				);
-		}
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, dev.ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%.2f", total);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%d", rate);
+		values.push_back(szTmp);
+		AddShortLogRecord("Rain", "DeviceRowID, Total, Rate", values);
 	}
 }
 
-void CSQLHelper::UpdateWindLog()
+void CSQLHelper::UpdateWindLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
 {
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result=safe_query("SELECT ID,DeviceID, Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d)", pTypeWIND);
-	if (result.size()>0)
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
 	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
-		{
-			std::vector<std::string> sd=*itt;
+		const _tShortLogDevice &dev = *itt;
+		if (dev.devType != pTypeWIND)
+			continue;
 
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
+		unsigned short DeviceID;
+		std::stringstream s_str2(dev.DeviceID);
+		s_str2 >> DeviceID;
 
-			unsigned short DeviceID;
-			std::stringstream s_str2(sd[1]);
-			s_str2 >> DeviceID;
+		//do not include sensors that have no reading within an hour
+		if (dev.Age >= SensorTimeOut * 60)
+			continue;
 
-			//unsigned char dType=atoi(sd[2].c_str());
-			//unsigned char dSubType=atoi(sd[3].c_str());
-			//int nValue=atoi(sd[4].c_str());
-			std::string sValue=sd[5];
+		std::vector<std::string> splitresults;
+		StringSplit(dev.sValue, ";", splitresults);
+		if (splitresults.size()<4)
+			continue; //impossible
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate=sd[6];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
+		float direction = static_cast<float>(atof(splitresults[0].c_str()));
 
-			if (difftime(now,checktime) >= SensorTimeOut * 60)
-				continue;
+		int speed = atoi(splitresults[2].c_str());
+		int gust = atoi(splitresults[3].c_str());
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size()<4)
-				continue; //impossible
+		std::map<unsigned short, _tWindCalculationStruct>::iterator itt2 = m_mainworker.m_wind_calculator.find(DeviceID);
+		if (itt2 != m_mainworker.m_wind_calculator.end())
+		{
+			int speed_max, gust_max, speed_min, gust_min;
+			itt2->second.GetMMSpeedGust(speed_min, speed_max, gust_min, gust_max);
+			if (speed_max != -1)
+				speed = speed_max;
+			if (gust_max != -1)
+				gust = gust_max;
+		}
 
-			float direction = static_cast<float>(atof(splitresults[0].c_str()));
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, dev.ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%.2f", direction);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%d", speed);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%d", gust);
+		values.push_back(szTmp);
+		AddShortLogRecord("Wind", "DeviceRowID, Direction, Speed, Gust", values);
+	}
+}
+
+void CSQLHelper::UpdateUVLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
+{
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
+	{
+		const _tShortLogDevice &dev = *itt;
+		if (
+			(dev.devType != pTypeUV) &&
+			(!((dev.devType == pTypeGeneral) && (dev.subType == sTypeUV)))
+			)
+			continue;
 
-			int speed = atoi(splitresults[2].c_str());
-			int gust = atoi(splitresults[3].c_str());
+		//do not include sensors that have no reading within an hour
+		if (dev.Age >= SensorTimeOut * 60)
+			continue;
 
-			std::map<unsigned short, _tWindCalculationStruct>::iterator itt = m_mainworker.m_wind_calculator.find(DeviceID);
-			if (itt != m_mainworker.m_wind_calculator.end())
-			{
-				int speed_max, gust_max, speed_min, gust_min;
-				itt->second.GetMMSpeedGust(speed_min, speed_max, gust_min, gust_max);
-				if (speed_max != -1)
-					speed = speed_max;
-				if (gust_max != -1)
-					gust = gust_max;
-			}
+		std::vector<std::string> splitresults;
+		StringSplit(dev.sValue, ";", splitresults);
+		if (splitresults.size()<1)
+			continue; //impossible
 
+		float level = static_cast<float>(atof(splitresults[0].c_str()));
 
-			//insert record
-			safe_query(
-				"INSERT INTO Wind (DeviceRowID, Direction, Speed, Gust) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%d', '%d')",
-				ID,
-				direction,
-				speed,
-				gust
-				);
-		}
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, dev.ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%g", level);
+		values.push_back(szTmp);
+		AddShortLogRecord("UV", "DeviceRowID, Level", values);
 	}
 }
 
-void CSQLHelper::UpdateUVLog()
+void CSQLHelper::UpdateMeter(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
 {
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
+	{
+		char szTmp[200];
+		const _tShortLogDevice &dev = *itt;
+
+		uint64_t ID = dev.ID;
+		const std::string &devname = dev.Name;
+		unsigned char dType = dev.devType;
+		unsigned char dSubType = dev.subType;
+		int nValue = dev.nValue;
+		std::string sValue = dev.sValue;
+
+		switch (dType)
+		{
+		case pTypeRFXMeter:
+		case pTypeP1Gas:
+		case pTypeYouLess:
+		case pTypeENERGY:
+		case pTypePOWER:
+		case pTypeAirQuality:
+		case pTypeUsage:
+		case pTypeLux:
+		case pTypeWEIGHT:
+			break;
+		case pTypeRego6XXValue:
+			if (dSubType != sTypeRego6XXCounter)
+				continue;
+			break;
+		case pTypeRFXSensor:
+			if ((dSubType != sTypeRFXSensorAD) && (dSubType != sTypeRFXSensorVolt))
+				continue;
+			break;
+		case pTypeGeneral:
+			if (
+				(dSubType != sTypeVisibility) &&
+				(dSubType != sTypeSolarRadiation) &&
+				(dSubType != sTypeSoilMoisture) &&
+				(dSubType != sTypeLeafWetness) &&
+				(dSubType != sTypeVoltage) &&
+				(dSubType != sTypeCurrent) &&
+				(dSubType != sTypeSoundLevel) &&
+				(dSubType != sTypeDistance) &&
+				(dSubType != sTypePressure) &&
+				(dSubType != sTypeCounterIncremental) &&
+				(dSubType != sTypeKwh)
+				)
+				continue;
+			break;
+		default:
+			continue;
+		}
 
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
+		std::string susage="0";
 
-	std::vector<std::vector<std::string> > result;
-	result=safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d) OR (Type=%d AND SubType=%d)",
-		pTypeUV,
-		pTypeGeneral, sTypeUV
-	);
-	if (result.size()>0)
-	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
+		//Check for timeout, if timeout then dont add value
+		if (dType!=pTypeP1Gas)
 		{
-			std::vector<std::string> sd=*itt;
-
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue=sd[4];
-
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate=sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now,checktime) >= SensorTimeOut * 60)
+			if (dev.Age >= SensorTimeOut * 60)
 				continue;
+		}
+		else
+		{
+			//P1 Gas meter transmits results every 1 a 2 hours
+			if (dev.Age >= 3 * 3600)
+				continue;
+		}
 
+		if (dType==pTypeYouLess)
+		{
 			std::vector<std::string> splitresults;
 			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size()<1)
-				continue; //impossible
-
-			float level = static_cast<float>(atof(splitresults[0].c_str()));
-
-			//insert record
-			safe_query(
-				"INSERT INTO UV (DeviceRowID, Level) "
-				"VALUES ('%" PRIu64 "', '%g')",
-				ID,
-				level
-				);
+			if (splitresults.size()<2)
+				continue;
+			sValue=splitresults[0];
+			susage = splitresults[1];
 		}
-	}
-}
-
-void CSQLHelper::UpdateMeter()
-{
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	std::vector<std::vector<std::string> > result2;
-
-	result=safe_query(
-		"SELECT ID,Name,HardwareID,DeviceID,Unit,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE ("
-		"Type=%d OR " //pTypeRFXMeter
-		"Type=%d OR " //pTypeP1Gas
-		"Type=%d OR " //pTypeYouLess
-		"Type=%d OR " //pTypeENERGY
-		"Type=%d OR " //pTypePOWER
-		"Type=%d OR " //pTypeAirQuality
-		"Type=%d OR " //pTypeUsage
-		"Type=%d OR " //pTypeLux
-		"Type=%d OR " //pTypeWEIGHT
-		"(Type=%d AND SubType=%d) OR " //pTypeRego6XXValue,sTypeRego6XXCounter
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeVisibility
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeSolarRadiation
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeSoilMoisture
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeLeafWetness
-		"(Type=%d AND SubType=%d) OR " //pTypeRFXSensor,sTypeRFXSensorAD
-		"(Type=%d AND SubType=%d) OR" //pTypeRFXSensor,sTypeRFXSensorVolt
-		"(Type=%d AND SubType=%d) OR"  //pTypeGeneral,sTypeVoltage
-		"(Type=%d AND SubType=%d) OR"  //pTypeGeneral,sTypeCurrent
-		"(Type=%d AND SubType=%d) OR"  //pTypeGeneral,sTypeSoundLevel
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeDistance
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypePressure
-		"(Type=%d AND SubType=%d) OR " //pTypeGeneral,sTypeCounterIncremental
-		"(Type=%d AND SubType=%d)"     //pTypeGeneral,sTypeKwh
-		")",
-		pTypeRFXMeter,
-		pTypeP1Gas,
-		pTypeYouLess,
-		pTypeENERGY,
-		pTypePOWER,
-		pTypeAirQuality,
-		pTypeUsage,
-		pTypeLux,
-		pTypeWEIGHT,
-		pTypeRego6XXValue,sTypeRego6XXCounter,
-		pTypeGeneral,sTypeVisibility,
-		pTypeGeneral,sTypeSolarRadiation,
-		pTypeGeneral,sTypeSoilMoisture,
-		pTypeGeneral,sTypeLeafWetness,
-		pTypeRFXSensor,sTypeRFXSensorAD,
-		pTypeRFXSensor,sTypeRFXSensorVolt,
-		pTypeGeneral, sTypeVoltage,
-		pTypeGeneral, sTypeCurrent,
-		pTypeGeneral, sTypeSoundLevel,
-		pTypeGeneral, sTypeDistance,
-		pTypeGeneral, sTypePressure,
-		pTypeGeneral, sTypeCounterIncremental,
-		pTypeGeneral, sTypeKwh
-		);
-	if (result.size()>0)
-	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
+		else if (dType==pTypeENERGY)
 		{
-			char szTmp[200];
-			std::vector<std::string> sd=*itt;
-
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
-			std::string devname = sd[1];
-			int hardwareID= atoi(sd[2].c_str());
-			std::string DeviceID=sd[3];
-			unsigned char Unit = atoi(sd[4].c_str());
-
-			unsigned char dType=atoi(sd[5].c_str());
-			unsigned char dSubType=atoi(sd[6].c_str());
-			int nValue=atoi(sd[7].c_str());
-			std::string sValue=sd[8];
-			std::string sLastUpdate=sd[9];
-
-			std::string susage="0";
-
-			//do not include sensors that have no reading within an hour
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-
-			//Check for timeout, if timeout then dont add value
-			if (dType!=pTypeP1Gas)
-			{
-				if (difftime(now,checktime) >= SensorTimeOut * 60)
-					continue;
-			}
-			else
-			{
-				//P1 Gas meter transmits results every 1 a 2 hours
-				if (difftime(now,checktime) >= 3 * 3600)
-					continue;
-			}
-
-			if (dType==pTypeYouLess)
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size()<2)
-					continue;
-				sValue=splitresults[0];
-				susage = splitresults[1];
-			}
-			else if (dType==pTypeENERGY)
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size()<2)
-					continue;
-				susage=splitresults[0];
-				double fValue=atof(splitresults[1].c_str())*100;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if (dType==pTypePOWER)
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size()<2)
-					continue;
-				susage=splitresults[0];
-				double fValue=atof(splitresults[1].c_str())*100;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if (dType==pTypeAirQuality)
-			{
-				sprintf(szTmp,"%d",nValue);
-				sValue=szTmp;
-				m_notifications.CheckAndHandleNotification(ID, devname, dType, dSubType, NTYPE_USAGE, (float)nValue);
-			}
-			else if ((dType==pTypeGeneral)&&((dSubType==sTypeSoilMoisture)||(dSubType==sTypeLeafWetness)))
-			{
-				sprintf(szTmp,"%d",nValue);
-				sValue=szTmp;
-			}
-			else if ((dType==pTypeGeneral)&&(dSubType==sTypeVisibility))
-			{
-				double fValue=atof(sValue.c_str())*10.0f;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeDistance))
-			{
-				double fValue = atof(sValue.c_str())*10.0f;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))
-			{
-				double fValue=atof(sValue.c_str())*10.0f;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))
-			{
-				double fValue = atof(sValue.c_str())*10.0f;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeKwh))
-			{
-				std::vector<std::string> splitresults;
-				StringSplit(sValue, ";", splitresults);
-				if (splitresults.size() < 2)
-					continue;
-
-				double fValue = atof(splitresults[0].c_str())*10.0f;
-				sprintf(szTmp, "%.0f", fValue);
-				susage = szTmp;
-
-				fValue = atof(splitresults[1].c_str());
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if (dType == pTypeLux)
-			{
-				double fValue=atof(sValue.c_str());
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if (dType==pTypeWEIGHT)
-			{
-				double fValue=atof(sValue.c_str())*10.0f;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if (dType==pTypeRFXSensor)
-			{
-				double fValue=atof(sValue.c_str());
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if ((dType==pTypeGeneral) && (dSubType == sTypeCounterIncremental))
-			{
-				double fValue=atof(sValue.c_str());
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if ((dType==pTypeGeneral)&&(dSubType==sTypeVoltage))
-			{
-				double fValue=atof(sValue.c_str())*1000.0f;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypeCurrent))
-			{
-				double fValue = atof(sValue.c_str())*1000.0f;
-				sprintf(szTmp, "%.0f", fValue);
-				sValue = szTmp;
-			}
-			else if ((dType == pTypeGeneral) && (dSubType == sTypePressure))
-			{
-				double fValue=atof(sValue.c_str())*10.0f;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-			else if (dType == pTypeUsage)
-			{
-				double fValue=atof(sValue.c_str())*10.0f;
-				sprintf(szTmp,"%.0f",fValue);
-				sValue=szTmp;
-			}
-
-			long long MeterValue;
-			std::stringstream s_str2( sValue );
-			s_str2 >> MeterValue;
-
-			long long MeterUsage;
-			std::stringstream s_str3( susage );
-			s_str3 >> MeterUsage;
-
-			//insert record
-			safe_query(
-				"INSERT INTO Meter (DeviceRowID, Value, [Usage]) "
-				"VALUES ('%" PRIu64 "', '%lld', '%lld')",
-				ID,
-				MeterValue,
-				MeterUsage
-				);
+			std::vector<std::string> splitresults;
+			StringSplit(sValue, ";", splitresults);
+			if (splitresults.size()<2)
+				continue;
+			susage=splitresults[0];
+			double fValue=atof(splitresults[1].c_str())*100;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
 		}
-	}
-}
-
-void CSQLHelper::UpdateMultiMeter()
-{
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result=safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d OR Type=%d OR Type=%d)",
-		pTypeP1Power,
-		pTypeCURRENT,
-		pTypeCURRENTENERGY
-		);
-	if (result.size()>0)
-	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
+		else if (dType==pTypePOWER)
 		{
-			std::vector<std::string> sd=*itt;
-
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
-			unsigned char dType=atoi(sd[1].c_str());
-			unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue=sd[4];
-
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate=sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-
-			if (difftime(now,checktime) >= SensorTimeOut * 60)
+			std::vector<std::string> splitresults;
+			StringSplit(sValue, ";", splitresults);
+			if (splitresults.size()<2)
 				continue;
+			susage=splitresults[0];
+			double fValue=atof(splitresults[1].c_str())*100;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if (dType==pTypeAirQuality)
+		{
+			sprintf(szTmp,"%d",nValue);
+			sValue=szTmp;
+			m_notifications.CheckAndHandleNotification(ID, devname, dType, dSubType, NTYPE_USAGE, (float)nValue);
+		}
+		else if ((dType==pTypeGeneral)&&((dSubType==sTypeSoilMoisture)||(dSubType==sTypeLeafWetness)))
+		{
+			sprintf(szTmp,"%d",nValue);
+			sValue=szTmp;
+		}
+		else if ((dType==pTypeGeneral)&&(dSubType==sTypeVisibility))
+		{
+			double fValue=atof(sValue.c_str())*10.0f;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if ((dType == pTypeGeneral) && (dSubType == sTypeDistance))
+		{
+			double fValue = atof(sValue.c_str())*10.0f;
+			sprintf(szTmp, "%.0f", fValue);
+			sValue = szTmp;
+		}
+		else if ((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))
+		{
+			double fValue=atof(sValue.c_str())*10.0f;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if ((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))
+		{
+			double fValue = atof(sValue.c_str())*10.0f;
+			sprintf(szTmp, "%.0f", fValue);
+			sValue = szTmp;
+		}
+		else if ((dType == pTypeGeneral) && (dSubType == sTypeKwh))
+		{
 			std::vector<std::string> splitresults;
 			StringSplit(sValue, ";", splitresults);
+			if (splitresults.size() < 2)
+				continue;
 
-			unsigned long long value1=0;
-			unsigned long long value2=0;
-			unsigned long long value3=0;
-			unsigned long long value4=0;
-			unsigned long long value5=0;
-			unsigned long long value6=0;
+			double fValue = atof(splitresults[0].c_str())*10.0f;
+			sprintf(szTmp, "%.0f", fValue);
+			susage = szTmp;
 
-			if (dType==pTypeP1Power)
-			{
-				if (splitresults.size()!=6)
-					continue; //impossible
-				unsigned long long powerusage1;
-				unsigned long long powerusage2;
-				unsigned long long powerdeliv1;
-				unsigned long long powerdeliv2;
-				unsigned long long usagecurrent;
-				unsigned long long delivcurrent;
-
-				std::stringstream s_powerusage1(splitresults[0]);
-				std::stringstream s_powerusage2(splitresults[1]);
-				std::stringstream s_powerdeliv1(splitresults[2]);
-				std::stringstream s_powerdeliv2(splitresults[3]);
-				std::stringstream s_usagecurrent(splitresults[4]);
-				std::stringstream s_delivcurrent(splitresults[5]);
-
-				s_powerusage1 >> powerusage1;
-				s_powerusage2 >> powerusage2;
-				s_powerdeliv1 >> powerdeliv1;
-				s_powerdeliv2 >> powerdeliv2;
-				s_usagecurrent >> usagecurrent;
-				s_delivcurrent >> delivcurrent;
-
-				value1=powerusage1;
-				value2=powerdeliv1;
-				value5=powerusage2;
-				value6=powerdeliv2;
-				value3=usagecurrent;
-				value4=delivcurrent;
-			}
-			else if ((dType==pTypeCURRENT)&&(dSubType==sTypeELEC1))
-			{
-				if (splitresults.size()!=3)
-					continue; //impossible
+			fValue = atof(splitresults[1].c_str());
+			sprintf(szTmp, "%.0f", fValue);
+			sValue = szTmp;
+		}
+		else if (dType == pTypeLux)
+		{
+			double fValue=atof(sValue.c_str());
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if (dType==pTypeWEIGHT)
+		{
+			double fValue=atof(sValue.c_str())*10.0f;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if (dType==pTypeRFXSensor)
+		{
+			double fValue=atof(sValue.c_str());
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if ((dType==pTypeGeneral) && (dSubType == sTypeCounterIncremental))
+		{
+			double fValue=atof(sValue.c_str());
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if ((dType==pTypeGeneral)&&(dSubType==sTypeVoltage))
+		{
+			double fValue=atof(sValue.c_str())*1000.0f;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if ((dType == pTypeGeneral) && (dSubType == sTypeCurrent))
+		{
+			double fValue = atof(sValue.c_str())*1000.0f;
+			sprintf(szTmp, "%.0f", fValue);
+			sValue = szTmp;
+		}
+		else if ((dType == pTypeGeneral) && (dSubType == sTypePressure))
+		{
+			double fValue=atof(sValue.c_str())*10.0f;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
+		else if (dType == pTypeUsage)
+		{
+			double fValue=atof(sValue.c_str())*10.0f;
+			sprintf(szTmp,"%.0f",fValue);
+			sValue=szTmp;
+		}
 
-				value1=(unsigned long)(atof(splitresults[0].c_str())*10.0f);
-				value2=(unsigned long)(atof(splitresults[1].c_str())*10.0f);
-				value3=(unsigned long)(atof(splitresults[2].c_str())*10.0f);
-			}
-			else if ((dType==pTypeCURRENTENERGY)&&(dSubType==sTypeELEC4))
-			{
-				if (splitresults.size()!=4)
-					continue; //impossible
+		long long MeterValue;
+		std::stringstream s_str2( sValue );
+		s_str2 >> MeterValue;
 
-				value1=(unsigned long)(atof(splitresults[0].c_str())*10.0f);
-				value2=(unsigned long)(atof(splitresults[1].c_str())*10.0f);
-				value3=(unsigned long)(atof(splitresults[2].c_str())*10.0f);
-				value4=(unsigned long long)(atof(splitresults[3].c_str())*1000.0f);
-			}
-			else
-				continue;//don't know you (yet)
+		long long MeterUsage;
+		std::stringstream s_str3( susage );
+		s_str3 >> MeterUsage;
 
-			//insert record
-			safe_query(
-				"INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6) "
-				"VALUES ('%" PRIu64 "', '%llu', '%llu', '%llu', '%llu', '%llu', '%llu')",
-				ID,
-				value1,
-				value2,
-				value3,
-				value4,
-				value5,
-				value6
-				);
-		}
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%lld", MeterValue);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%lld", MeterUsage);
+		values.push_back(szTmp);
+		AddShortLogRecord("Meter", "DeviceRowID, Value, [Usage]", values);
 	}
 }
 
-void CSQLHelper::UpdatePercentageLog()
+void CSQLHelper::UpdateMultiMeter(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
 {
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d) OR (Type=%d AND SubType=%d)",
-		pTypeGeneral, sTypePercentage,
-		pTypeGeneral, sTypeWaterflow,
-		pTypeGeneral, sTypeCustom
-		);
-	if (result.size()>0)
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
 	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
-		{
-			std::vector<std::string> sd=*itt;
+		const _tShortLogDevice &dev = *itt;
 
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
-
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue=sd[4];
+		unsigned char dType = dev.devType;
+		unsigned char dSubType = dev.subType;
+		if ((dType != pTypeP1Power) && (dType != pTypeCURRENT) && (dType != pTypeCURRENTENERGY))
+			continue;
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate=sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
+		//do not include sensors that have no reading within an hour
+		if (dev.Age >= SensorTimeOut * 60)
+			continue;
+		std::vector<std::string> splitresults;
+		StringSplit(dev.sValue, ";", splitresults);
 
-			if (difftime(now,checktime) >= SensorTimeOut * 60)
-				continue;
+		unsigned long long value1=0;
+		unsigned long long value2=0;
+		unsigned long long value3=0;
+		unsigned long long value4=0;
+		unsigned long long value5=0;
+		unsigned long long value6=0;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size()<1)
+		if (dType==pTypeP1Power)
+		{
+			if (splitresults.size()!=6)
+				continue; //impossible
+			unsigned long long powerusage1;
+			unsigned long long powerusage2;
+			unsigned long long powerdeliv1;
+			unsigned long long powerdeliv2;
+			unsigned long long usagecurrent;
+			unsigned long long delivcurrent;
+
+			std::stringstream s_powerusage1(splitresults[0]);
+			std::stringstream s_powerusage2(splitresults[1]);
+			std::stringstream s_powerdeliv1(splitresults[2]);
+			std::stringstream s_powerdeliv2(splitresults[3]);
+			std::stringstream s_usagecurrent(splitresults[4]);
+			std::stringstream s_delivcurrent(splitresults[5]);
+
+			s_powerusage1 >> powerusage1;
+			s_powerusage2 >> powerusage2;
+			s_powerdeliv1 >> powerdeliv1;
+			s_powerdeliv2 >> powerdeliv2;
+			s_usagecurrent >> usagecurrent;
+			s_delivcurrent >> delivcurrent;
+
+			value1=powerusage1;
+			value2=powerdeliv1;
+			value5=powerusage2;
+			value6=powerdeliv2;
+			value3=usagecurrent;
+			value4=delivcurrent;
+		}
+		else if ((dType==pTypeCURRENT)&&(dSubType==sTypeELEC1))
+		{
+			if (splitresults.size()!=3)
 				continue; //impossible
 
-			float percentage = static_cast<float>(atof(sValue.c_str()));
+			value1=(unsigned long)(atof(splitresults[0].c_str())*10.0f);
+			value2=(unsigned long)(atof(splitresults[1].c_str())*10.0f);
+			value3=(unsigned long)(atof(splitresults[2].c_str())*10.0f);
+		}
+		else if ((dType==pTypeCURRENTENERGY)&&(dSubType==sTypeELEC4))
+		{
+			if (splitresults.size()!=4)
+				continue; //impossible
 
-			//insert record
-			safe_query(
-				"INSERT INTO Percentage (DeviceRowID, Percentage) "
-				"VALUES ('%" PRIu64 "', '%g')",
-				ID,
-				percentage
-				);
+			value1=(unsigned long)(atof(splitresults[0].c_str())*10.0f);
+			value2=(unsigned long)(atof(splitresults[1].c_str())*10.0f);
+			value3=(unsigned long)(atof(splitresults[2].c_str())*10.0f);
+			value4=(unsigned long long)(atof(splitresults[3].c_str())*1000.0f);
 		}
+		else
+			continue;//don't know you (yet)
+
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, dev.ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%llu", value1);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%llu", value2);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%llu", value3);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%llu", value4);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%llu", value5);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%llu", value6);
+		values.push_back(szTmp);
+		AddShortLogRecord("MultiMeter", "DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6", values);
 	}
 }
 
-void CSQLHelper::UpdateFanLog()
+void CSQLHelper::UpdatePercentageLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
 {
-	time_t now = mytime(NULL);
-	if (now==0)
-		return;
-	struct tm tm1;
-	localtime_r(&now,&tm1);
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
+	{
+		const _tShortLogDevice &dev = *itt;
+		if (dev.devType != pTypeGeneral)
+			continue;
+		if ((dev.subType != sTypePercentage) && (dev.subType != sTypeWaterflow) && (dev.subType != sTypeCustom))
+			continue;
 
-	int SensorTimeOut=60;
-	GetPreferencesVar("SensorTimeout", SensorTimeOut);
+		//do not include sensors that have no reading within an hour
+		if (dev.Age >= SensorTimeOut * 60)
+			continue;
 
-	std::vector<std::vector<std::string> > result;
-	result=safe_query("SELECT ID,Type,SubType,nValue,sValue,LastUpdate FROM DeviceStatus WHERE (Type=%d AND SubType=%d)",
-		pTypeGeneral,sTypeFan
-		);
-	if (result.size()>0)
-	{
-		std::vector<std::vector<std::string> >::const_iterator itt;
-		for (itt=result.begin(); itt!=result.end(); ++itt)
-		{
-			std::vector<std::string> sd=*itt;
+		std::vector<std::string> splitresults;
+		StringSplit(dev.sValue, ";", splitresults);
+		if (splitresults.size()<1)
+			continue; //impossible
 
-			uint64_t ID;
-			std::stringstream s_str( sd[0] );
-			s_str >> ID;
+		float percentage = static_cast<float>(atof(dev.sValue.c_str()));
 
-			//unsigned char dType=atoi(sd[1].c_str());
-			//unsigned char dSubType=atoi(sd[2].c_str());
-			//int nValue=atoi(sd[3].c_str());
-			std::string sValue=sd[4];
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, dev.ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%g", percentage);
+		values.push_back(szTmp);
+		AddShortLogRecord("Percentage", "DeviceRowID, Percentage", values);
+	}
+}
 
-			//do not include sensors that have no reading within an hour
-			std::string sLastUpdate=sd[5];
-			struct tm ntime;
-			time_t checktime;
-			ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
+void CSQLHelper::UpdateFanLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut)
+{
+	char szTmp[100];
+	std::vector<_tShortLogDevice>::const_iterator itt;
+	for (itt = devices.begin(); itt != devices.end(); ++itt)
+	{
+		const _tShortLogDevice &dev = *itt;
+		if ((dev.devType != pTypeGeneral) || (dev.subType != sTypeFan))
+			continue;
 
-			if (difftime(now,checktime) >= SensorTimeOut * 60)
-				continue;
+		//do not include sensors that have no reading within an hour
+		if (dev.Age >= SensorTimeOut * 60)
+			continue;
 
-			std::vector<std::string> splitresults;
-			StringSplit(sValue, ";", splitresults);
-			if (splitresults.size()<1)
-				continue; //impossible
+		std::vector<std::string> splitresults;
+		StringSplit(dev.sValue, ";", splitresults);
+		if (splitresults.size()<1)
+			continue; //impossible
 
-			int speed= (int)atoi(sValue.c_str());
+		int speed= (int)atoi(dev.sValue.c_str());
 
-			//insert record
-			safe_query(
-				"INSERT INTO Fan (DeviceRowID, Speed) "
-				"VALUES ('%" PRIu64 "', '%d')",
-				ID,
-				speed
-				);
-		}
+		//queue record
+		std::vector<std::string> values;
+		sprintf(szTmp, "%" PRIu64, dev.ID);
+		values.push_back(szTmp);
+		sprintf(szTmp, "%d", speed);
+		values.push_back(szTmp);
+		AddShortLogRecord("Fan", "DeviceRowID, Speed", values);
 	}
 }
 
@@ -5702,42 +5761,114 @@ void CSQLHelper::CleanupShortLog()
             _log.Log(LOG_ERROR,"CleanupShortLog(): MinuteHistoryDays is zero!");
             return;
         }
-#if 0
-		char szDateStr[40];
-		time_t clear_time = mytime(NULL) - (n5MinuteHistoryDays * 24 * 3600);
-		struct tm ltime;
-		localtime_r(&clear_time, &ltime);
-		sprintf(szDateStr, "%04d-%02d-%02d %02d:%02d:%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday, ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
-		_log.Log(LOG_STATUS, "Cleaning up shortlog older than %s", szDateStr);
-#endif
 
-		char szQuery[250];
-		std::string szQueryFilter = "strftime('%s',datetime('now','localtime')) - strftime('%s',Date) > (SELECT p.nValue * 86400 From Preferences AS p WHERE p.Key='5MinuteHistoryDays')";
+		//Devices can override the retention period with the ShortLogDays option
+		std::map<uint64_t, int> overrides;
+		GetRetentionOverrides("ShortLogDays", overrides);
 
-		sprintf(szQuery, "DELETE FROM Temperature WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+		time_t now = mytime(NULL);
+		for (int ii = 0; szShortLogTables[ii] != NULL; ii++)
+			DeleteHistoryBefore(szShortLogTables[ii], "DeviceRowID", n5MinuteHistoryDays, now, overrides, m_bEpochTimestamps);
+	}
+}
 
-		sprintf(szQuery, "DELETE FROM Rain WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+std::string CSQLHelper::GetRetentionCutoff(const time_t now, const int Days)
+{
+	return EpochToSQLdatetime(now - (Days * 86400));
+}
 
-		sprintf(szQuery, "DELETE FROM Wind WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+std::string CSQLHelper::GetRetentionFilter(const time_t now, const int Days, const bool bEpoch)
+{
+	std::stringstream sFilter;
+	if (bEpoch)
+		sFilter << "(DateUTC < " << (long long)(now - (Days * 86400)) << ")";
+	else
+		sFilter << "(Date < '" << GetRetentionCutoff(now, Days) << "')";
+	return sFilter.str();
+}
 
-		sprintf(szQuery, "DELETE FROM UV WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+void CSQLHelper::GetRetentionOverrides(const std::string &OptionName, std::map<uint64_t, int> &overrides)
+{
+	overrides.clear();
+	std::vector<std::vector<std::string> > result;
+	result = safe_query("SELECT ID, Options FROM DeviceStatus WHERE (Options LIKE '%%%q:%%')", OptionName.c_str());
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		std::map<std::string, std::string> options = BuildDeviceOptions((*itt)[1]);
+		std::map<std::string, std::string>::const_iterator ittOption = options.find(OptionName);
+		if (ittOption == options.end())
+			continue;
+		int Days = atoi(ittOption->second.c_str());
+		if (Days < 1)
+			continue; //never delete everything
+		uint64_t ID;
+		std::stringstream s_str((*itt)[0]);
+		s_str >> ID;
+		overrides[ID] = Days;
+	}
+}
 
-		sprintf(szQuery, "DELETE FROM Meter WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+void CSQLHelper::DeleteHistoryBefore(const std::string &Table, const std::string &DeviceColumn, const int Days, const time_t now, const std::map<uint64_t, int> &overrides, const bool bEpoch)
+{
+	//The Date (and DateUTC) column is indexed, so compare against the precomputed cutoff instead of calculating the age of every row
+	std::stringstream sFilter;
+	sFilter << GetRetentionFilter(now, Days, bEpoch);
+	if (!overrides.empty())
+	{
+		sFilter << " AND (" << DeviceColumn << " NOT IN (";
+		std::map<uint64_t, int>::const_iterator itt;
+		for (itt = overrides.begin(); itt != overrides.end(); ++itt)
+		{
+			if (itt != overrides.begin())
+				sFilter << ",";
+			sFilter << itt->first;
+		}
+		sFilter << "))";
+	}
+	DeleteInChunks(Table, sFilter.str());
 
-		sprintf(szQuery, "DELETE FROM MultiMeter WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+	std::map<uint64_t, int>::const_iterator itt;
+	for (itt = overrides.begin(); itt != overrides.end(); ++itt)
+	{
+		std::stringstream sDevFilter;
+		sDevFilter << "(" << DeviceColumn << " = " << itt->first << ") AND " << GetRetentionFilter(now, itt->second, bEpoch);
+		DeleteInChunks(Table, sDevFilter.str());
+	}
+}
 
-		sprintf(szQuery, "DELETE FROM Percentage WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+void CSQLHelper::DeleteInChunks(const std::string &Table, const std::string &Filter)
+{
+	if (!m_dbase)
+		return;
 
-		sprintf(szQuery, "DELETE FROM Fan WHERE %s", szQueryFilter.c_str());
-		query(szQuery);
+	char *zQuery = sqlite3_mprintf("DELETE FROM %s WHERE rowid IN (SELECT rowid FROM %s WHERE %s LIMIT %d)",
+		Table.c_str(), Table.c_str(), Filter.c_str(), RETENTION_DELETE_CHUNK_SIZE);
+	if (!zQuery)
+	{
+		_log.Log(LOG_ERROR, "SQL: Out of memory, or invalid printf!....");
+		return;
+	}
+	while (true)
+	{
+		int changes = 0;
+		{
+			boost::lock_guard<boost::mutex> l(m_sqlQueryMutex);
+			char *errorMessage = NULL;
+			if (sqlite3_exec(m_dbase, zQuery, NULL, NULL, &errorMessage) != SQLITE_OK)
+			{
+				_log.Log(LOG_ERROR, "SQL Query(\"%s\") : %s", zQuery, (errorMessage) ? errorMessage : "unknown error");
+				sqlite3_free(errorMessage);
+				break;
+			}
+			changes = sqlite3_changes(m_dbase);
+		}
+		if (changes < RETENTION_DELETE_CHUNK_SIZE)
+			break;
+		//give other database users a chance before deleting the next batch
+		sleep_milliseconds(RETENTION_DELETE_CHUNK_PAUSE);
 	}
+	sqlite3_free(zQuery);
 }
 
 void CSQLHelper::ClearShortLog()
@@ -5973,7 +6104,7 @@ void CSQLHelper::CheckAndUpdateDeviceOrder()
 		{
 			std::vector<std::string> sd=*itt;
 
-			safe_query("UPDATE DeviceStatus SET [Order] = (SELECT MAX([Order]) FROM DeviceStatus)+1 WHERE (ROWID == '%q')", sd[0].c_str());
+			safe_query("UPDATE DeviceStatus SET [Order] = (SELECT MAX([Order]) FROM DeviceStatus)+%d WHERE (ROWID == '%q')", ORDER_GAP, sd[0].c_str());
 		}
 	}
 }
@@ -5996,25 +6127,94 @@ void CSQLHelper::CheckAndUpdateSceneDeviceOrder()
 	}
 }
 
+//Gives all rows (within Filter) an [Order] of ORDER_GAP, 2*ORDER_GAP, ... keeping their current sequence
+void CSQLHelper::RenumberOrder(const std::string &TableName, const std::string &Filter)
+{
+	std::string szWhere = (Filter.empty()) ? "" : " WHERE (" + Filter + ")";
+	std::vector<std::vector<std::string> > result;
+	result = safe_query("SELECT ROWID FROM %s%s ORDER BY [Order], ROWID", TableName.c_str(), szWhere.c_str());
+	if (result.empty())
+		return;
+
+	sqlite3_exec(m_dbase, "BEGIN TRANSACTION", NULL, NULL, NULL);
+	int64_t Order = 0;
+	std::vector<std::vector<std::string> >::const_iterator itt;
+	for (itt = result.begin(); itt != result.end(); ++itt)
+	{
+		Order += ORDER_GAP;
+		safe_query("UPDATE %s SET [Order]=%" PRId64 " WHERE (ROWID == %q)", TableName.c_str(), Order, (*itt)[0].c_str());
+	}
+	sqlite3_exec(m_dbase, "COMMIT TRANSACTION", NULL, NULL, NULL);
+}
+
+//A row moved to a lower [Order] is placed before RefID, a row moved to a higher [Order] after RefID.
+//The new [Order] is halfway between RefID and its neighbour, only when there is no room left the rows are renumbered first
+bool CSQLHelper::MoveOrder(const std::string &TableName, const std::string &KeyColumn, const std::string &MoveID, const std::string &RefID, const std::string &Filter)
+{
+	if (MoveID == RefID)
+		return true;
+	std::string szFilter = (Filter.empty()) ? "" : " AND (" + Filter + ")";
+	for (int iTry = 0; iTry < 2; iTry++)
+	{
+		std::vector<std::vector<std::string> > result;
+		result = safe_query("SELECT [Order] FROM %s WHERE (%s == '%q')%s", TableName.c_str(), KeyColumn.c_str(), MoveID.c_str(), szFilter.c_str());
+		if (result.empty())
+			return false;
+		int64_t OrderMove = 0;
+		std::stringstream s_str1(result[0][0]);
+		s_str1 >> OrderMove;
+
+		result = safe_query("SELECT [Order] FROM %s WHERE (%s == '%q')%s", TableName.c_str(), KeyColumn.c_str(), RefID.c_str(), szFilter.c_str());
+		if (result.empty())
+			return false;
+		int64_t OrderRef = 0;
+		std::stringstream s_str2(result[0][0]);
+		s_str2 >> OrderRef;
+
+		bool bBefore = (OrderMove > OrderRef);
+		int64_t NeighbourOrder;
+		if (bBefore)
+		{
+			result = safe_query("SELECT MAX([Order]) FROM %s WHERE ([Order] < %" PRId64 ")%s", TableName.c_str(), OrderRef, szFilter.c_str());
+			NeighbourOrder = 0;
+		}
+		else
+		{
+			result = safe_query("SELECT MIN([Order]) FROM %s WHERE ([Order] > %" PRId64 ")%s", TableName.c_str(), OrderRef, szFilter.c_str());
+			NeighbourOrder = OrderRef + (2 * ORDER_GAP);
+		}
+		if ((!result.empty()) && (!result[0][0].empty()))
+		{
+			std::stringstream s_str3(result[0][0]);
+			s_str3 >> NeighbourOrder;
+		}
+
+		int64_t NewOrder = (OrderRef + NeighbourOrder) / 2;
+		if ((OrderMove != OrderRef) && (NewOrder != OrderRef) && (NewOrder != NeighbourOrder) && (NewOrder > 0))
+		{
+			safe_query("UPDATE %s SET [Order] = %" PRId64 " WHERE (%s == '%q')%s", TableName.c_str(), NewOrder, KeyColumn.c_str(), MoveID.c_str(), szFilter.c_str());
+			return true;
+		}
+		//No room between the rows (or rows with the same order), spread them and try again
+		RenumberOrder(TableName, Filter);
+	}
+	return false;
+}
+
 void CSQLHelper::CleanupLightSceneLog()
 {
 	//cleanup the lighting log
 	int nMaxDays=30;
 	GetPreferencesVar("LightHistoryDays", nMaxDays);
 
-	char szDateEnd[40];
 	time_t now = mytime(NULL);
-	struct tm tm1;
-	localtime_r(&now,&tm1);
-
-	time_t daybefore;
-	struct tm tm2;
-	constructTime(daybefore,tm2,tm1.tm_year+1900,tm1.tm_mon+1,tm1.tm_mday-nMaxDays,tm1.tm_hour,tm1.tm_min,0,tm1.tm_isdst);
-	sprintf(szDateEnd,"%04d-%02d-%02d %02d:%02d:00",tm2.tm_year+1900,tm2.tm_mon+1,tm2.tm_mday,tm2.tm_hour,tm2.tm_min);
 
+	//Devices can override the retention period with the LightHistoryDays option
+	std::map<uint64_t, int> overrides;
+	GetRetentionOverrides("LightHistoryDays", overrides);
 
-	safe_query("DELETE FROM LightingLog WHERE (Date<'%q')", szDateEnd);
-	safe_query("DELETE FROM SceneLog WHERE (Date<'%q')", szDateEnd);
+	DeleteHistoryBefore("LightingLog", "DeviceRowID", nMaxDays, now, overrides);
+	DeleteInChunks("SceneLog", GetRetentionFilter(now, nMaxDays, false));
 }
 
 bool CSQLHelper::DoesSceneByNameExits(const std::string &SceneName)
@@ -6186,8 +6386,8 @@ void CSQLHelper::AddTaskItem(const _tTaskItem &tItem)
 	boost::lock_guard<boost::mutex> l(m_background_task_mutex);
 
 	// Check if an event for the same device is already in queue, and if so, replace it
-	if (_log.isTraceEnabled())
-	   _log.Log(LOG_TRACE, "SQLH AddTask: Request to add task: idx=%" PRIu64 ", DelayTime=%f, Command='%s', Level=%d, Hue=%d, RelatedEvent='%s'", tItem._idx, tItem._DelayTime, tItem._command.c_str(), tItem._level, tItem._Hue, tItem._relatedEvent.c_str());
+	if (_log.isTraceEnabled(LOGCAT_SQL))
+	   _log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH AddTask: Request to add task: idx=%" PRIu64 ", DelayTime=%f, Command='%s', Level=%d, Hue=%d, RelatedEvent='%s'", tItem._idx, tItem._DelayTime, tItem._command.c_str(), tItem._level, tItem._Hue, tItem._relatedEvent.c_str());
 	// Remove any previous task linked to the same device
 
 	if (
@@ -6198,15 +6398,15 @@ void CSQLHelper::AddTaskItem(const _tTaskItem &tItem)
 		std::vector<_tTaskItem>::iterator itt = m_background_task_queue.begin();
 		while (itt != m_background_task_queue.end())
 		{
-			if (_log.isTraceEnabled())
-				 _log.Log(LOG_TRACE, "SQLH AddTask: Comparing with item in queue: idx=%llu, DelayTime=%d, Command='%s', Level=%d, Hue=%d, RelatedEvent='%s'", itt->_idx, itt->_DelayTime, itt->_command.c_str(), itt->_level, itt->_Hue, itt->_relatedEvent.c_str());
+			if (_log.isTraceEnabled(LOGCAT_SQL))
+				 _log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH AddTask: Comparing with item in queue: idx=%llu, DelayTime=%d, Command='%s', Level=%d, Hue=%d, RelatedEvent='%s'", itt->_idx, itt->_DelayTime, itt->_command.c_str(), itt->_level, itt->_Hue, itt->_relatedEvent.c_str());
 			if (itt->_idx == tItem._idx && itt->_ItemType == tItem._ItemType)
 			{
 				float iDelayDiff = tItem._DelayTime - itt->_DelayTime;
 				if (iDelayDiff < (1./timer_resolution_hz/2))
 				{
-					if (_log.isTraceEnabled())
-						 _log.Log(LOG_TRACE, "SQLH AddTask: => Already present. Cancelling previous task item");
+					if (_log.isTraceEnabled(LOGCAT_SQL))
+						 _log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH AddTask: => Already present. Cancelling previous task item");
 					itt = m_background_task_queue.erase(itt);
 				}
 				else
@@ -6498,12 +6698,12 @@ void CSQLHelper::SetUnitsAndScale()
 
 bool CSQLHelper::HandleOnOffAction(const bool bIsOn, const std::string &OnAction, const std::string &OffAction)
 {
-	if (_log.isTraceEnabled())
+	if (_log.isTraceEnabled(LOGCAT_SQL))
 	{
 		if (bIsOn)
-			_log.Log(LOG_TRACE, "SQLH HandleOnOffAction: OnAction:%s", OnAction.c_str());
+			_log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH HandleOnOffAction: OnAction:%s", OnAction.c_str());
 		else
-			_log.Log(LOG_TRACE, "SQLH HandleOnOffAction: OffAction:%s", OffAction.c_str());
+			_log.Log(LOGCAT_SQL, LOG_TRACE, "SQLH HandleOnOffAction: OffAction:%s", OffAction.c_str());
 	}
 
 	if (bIsOn)
@@ -7210,7 +7410,7 @@ void LogRow (TSqlRowQuery * row)
 		std::string Row;
 		for (unsigned int j=0;j<(*row).size();j++)
 			Row = Row+(*row)[j]+";";
-    _log.Log(LOG_TRACE,"SQLR result: %s",Row.c_str());
+    _log.Log(LOGCAT_SQL, LOG_TRACE, "SQLR result: %s",Row.c_str());
 }
 void CSQLHelper::LogQueryResult (TSqlQueryResult &result)
 {
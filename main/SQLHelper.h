@@ -198,6 +198,21 @@ struct _tTaskItem
 	}
 };
 
+//DeviceStatus snapshot used to collect the short-log samples of one interval
+struct _tShortLogDevice
+{
+	uint64_t ID;
+	std::string Name;
+	int HardwareID;
+	std::string DeviceID;
+	unsigned char Unit;
+	unsigned char devType;
+	unsigned char subType;
+	int nValue;
+	std::string sValue;
+	double Age; //seconds since LastUpdate
+};
+
 //row result for an sql query : string Vector
 typedef   std::vector<std::string> TSqlRowQuery;
 
@@ -212,6 +227,7 @@ public:
 
 	bool OpenDatabase();
 	void SetDatabaseName(const std::string &DBName);
+	size_t GetMemoryUsage();
 
 	bool BackupDatabase(const std::string &OutputFile);
 
@@ -275,6 +291,9 @@ public:
 
 	void DeleteDevices(const std::string &idx);
 
+	//Places row MoveID directly before/after row RefID by only changing the [Order] of MoveID (see switchdeviceorder)
+	bool MoveOrder(const std::string &TableName, const std::string &KeyColumn, const std::string &MoveID, const std::string &RefID, const std::string &Filter);
+
 	void TransferDevice(const std::string &oldidx, const std::string &newidx);
 
 	bool DoesSceneByNameExits(const std::string &SceneName);
@@ -334,6 +353,7 @@ public:
 	int			m_ActiveTimerPlan;
 	bool		m_bDisableEventSystem;
 	int			m_ShortLogInterval;
+	bool		m_bEpochTimestamps;	//short log tables have an indexed DateUTC (epoch) column
 	bool		m_bLogEventScriptTrigger;
 private:
 	boost::mutex	m_sqlQueryMutex;
@@ -346,6 +366,14 @@ private:
 	float			m_iAcceptHardwareTimerCounter;
 	bool			m_bPreviousAcceptNewHardware;
 
+	struct _tShortLogTable
+	{
+		std::string Columns;
+		size_t ColumnCount;
+		std::vector<std::string> Values; //row major
+	};
+	std::map<std::string, _tShortLogTable> m_shortlog_records;
+
 	std::vector<_tTaskItem> m_background_task_queue;
 	boost::shared_ptr<boost::thread> m_background_task_thread;
 	boost::mutex m_background_task_mutex;
@@ -364,17 +392,22 @@ private:
 
 	void CheckAndUpdateDeviceOrder();
 	void CheckAndUpdateSceneDeviceOrder();
+	void RenumberOrder(const std::string &TableName, const std::string &Filter);
 
 	void CleanupLightSceneLog();
 
-	void UpdateTemperatureLog();
-	void UpdateRainLog();
-	void UpdateWindLog();
-	void UpdateUVLog();
-	void UpdateMeter();
-	void UpdateMultiMeter();
-	void UpdatePercentageLog();
-	void UpdateFanLog();
+	void GetShortLogDevices(std::vector<_tShortLogDevice> &devices);
+	void UpdateTemperatureLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdateRainLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdateWindLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdateUVLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdateMeter(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdateMultiMeter(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdatePercentageLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void UpdateFanLog(const std::vector<_tShortLogDevice> &devices, const int SensorTimeOut);
+	void AddShortLogRecord(const std::string &Table, const std::string &Columns, const std::vector<std::string> &Values);
+	void FlushShortLogRecords();
+	void SetupEpochTimestamps(const bool bEnabled);
 	void AddCalendarTemperature();
 	void AddCalendarUpdateRain();
 	void AddCalendarUpdateWind();
@@ -384,6 +417,11 @@ private:
 	void AddCalendarUpdatePercentage();
 	void AddCalendarUpdateFan();
 	void CleanupShortLog();
+	std::string GetRetentionCutoff(const time_t now, const int Days);
+	std::string GetRetentionFilter(const time_t now, const int Days, const bool bEpoch);
+	void GetRetentionOverrides(const std::string &OptionName, std::map<uint64_t, int> &overrides);
+	void DeleteHistoryBefore(const std::string &Table, const std::string &DeviceColumn, const int Days, const time_t now, const std::map<uint64_t, int> &overrides, const bool bEpoch = false);
+	void DeleteInChunks(const std::string &Table, const std::string &Filter);
 	std::string CheckUserVariable(const int vartype, const std::string &varvalue);
 	std::string CheckUserVariableName(const std::string &varname);
 	bool CheckDate(const std::string &sDate, int &d, int &m, int &y);
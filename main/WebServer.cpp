@@ -34,6 +34,7 @@
 #ifdef WITH_TELLDUSCORE
 #include "../hardware/Tellstick.h"
 #endif
+#include "../hardware/HardwareMonitor.h"
 #include "../webserver/Base64.h"
 #include "../smtpclient/SMTPClient.h"
 #include "../json/json.h"
@@ -355,6 +356,11 @@ namespace http {
 			RegisterCommandCode("getversion", boost::bind(&CWebServer::Cmd_GetVersion, this, _1, _2, _3), true);
 			RegisterCommandCode("getlog", boost::bind(&CWebServer::Cmd_GetLog, this, _1, _2, _3));
 			RegisterCommandCode("clearlog", boost::bind(&CWebServer::Cmd_ClearLog, this, _1, _2, _3));
+			RegisterCommandCode("getmemoryusage", boost::bind(&CWebServer::Cmd_GetMemoryUsage, this, _1, _2, _3));
+			RegisterCommandCode("getpollstatistics", boost::bind(&CWebServer::Cmd_GetPollStatistics, this, _1, _2, _3));
+			RegisterCommandCode("geteventsystemstatistics", boost::bind(&CWebServer::Cmd_GetEventSystemStatistics, this, _1, _2, _3));
+			RegisterCommandCode("getsystemmetrics", boost::bind(&CWebServer::Cmd_GetSystemMetrics, this, _1, _2, _3));
+			RegisterCommandCode("getwebserverstatistics", boost::bind(&CWebServer::Cmd_GetWebServerStatistics, this, _1, _2, _3));
 			RegisterCommandCode("getauth", boost::bind(&CWebServer::Cmd_GetAuth, this, _1, _2, _3), true);
 			RegisterCommandCode("getuptime", boost::bind(&CWebServer::Cmd_GetUptime, this, _1, _2, _3), true);
 
@@ -475,8 +481,90 @@ namespace http {
 			RegisterCommandCode("getconfig", boost::bind(&CWebServer::Cmd_GetConfig, this, _1, _2, _3),true);
 			RegisterCommandCode("sendnotification", boost::bind(&CWebServer::Cmd_SendNotification, this, _1, _2, _3));
 			RegisterCommandCode("emailcamerasnapshot", boost::bind(&CWebServer::Cmd_EmailCameraSnapshot, this, _1, _2, _3));
-			RegisterCommandCode("udevice", boost::bind(&CWebServer::Cmd_UpdateDevice, this, _1, _2, _3));
+			RegisterCommandCode("udevice", boost::bind(&CWebServer::Cmd_UpdateDevice, this, _1, _2, _3), false, 1);
 			RegisterCommandCode("udevices", boost::bind(&CWebServer::Cmd_UpdateDevices, this, _1, _2, _3));
+			RegisterCommandCode("switchlights", boost::bind(&CWebServer::Cmd_SwitchLights, this, _1, _2, _3));
+			RegisterCommandCode("switchlight", boost::bind(&CWebServer::Cmd_SwitchLight, this, _1, _2, _3), false, 1, "idx,switchcmd");
+			RegisterCommandCode("switchscene", boost::bind(&CWebServer::Cmd_SwitchScene, this, _1, _2, _3), false, 1, "idx,switchcmd");
+			RegisterCommandCode("getSunRiseSet", boost::bind(&CWebServer::Cmd_GetSunRiseSet, this, _1, _2, _3));
+			RegisterCommandCode("getServerTime", boost::bind(&CWebServer::Cmd_GetServerTime, this, _1, _2, _3));
+			RegisterCommandCode("getsecstatus", boost::bind(&CWebServer::Cmd_GetSecStatus, this, _1, _2, _3));
+			RegisterCommandCode("setsecstatus", boost::bind(&CWebServer::Cmd_SetSecStatus, this, _1, _2, _3));
+			RegisterCommandCode("getlightswitches", boost::bind(&CWebServer::Cmd_GetLightSwitches, this, _1, _2, _3));
+			RegisterCommandCode("getlightswitchesscenes", boost::bind(&CWebServer::Cmd_GetLightSwitchesScenes, this, _1, _2, _3));
+			RegisterCommandCode("deleteallsubdevices", boost::bind(&CWebServer::Cmd_DeleteAllSubDevices, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("deletesubdevice", boost::bind(&CWebServer::Cmd_DeleteSubDevice, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("addsubdevice", boost::bind(&CWebServer::Cmd_AddSubDevice, this, _1, _2, _3), false, 2, "idx,subidx");
+			RegisterCommandCode("addscenedevice", boost::bind(&CWebServer::Cmd_AddSceneDevice, this, _1, _2, _3), false, 2);
+			RegisterCommandCode("updatescenedevice", boost::bind(&CWebServer::Cmd_UpdateSceneDevice, this, _1, _2, _3), false, 2);
+			RegisterCommandCode("deletescenedevice", boost::bind(&CWebServer::Cmd_DeleteSceneDevice, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("getsubdevices", boost::bind(&CWebServer::Cmd_GetSubDevices, this, _1, _2, _3), false, 0, "idx");
+			RegisterCommandCode("getscenedevices", boost::bind(&CWebServer::Cmd_GetSceneDevices, this, _1, _2, _3), false, 0, "idx,isscene");
+			RegisterCommandCode("changescenedeviceorder", boost::bind(&CWebServer::Cmd_ChangeSceneDeviceOrder, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("deleteallscenedevices", boost::bind(&CWebServer::Cmd_DeleteAllSceneDevices, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("getmanualhardware", boost::bind(&CWebServer::Cmd_GetManualHardware, this, _1, _2, _3), false, 0);
+			RegisterCommandCode("getgpio", boost::bind(&CWebServer::Cmd_GetGpio, this, _1, _2, _3), false, 0);
+			RegisterCommandCode("getcamactivedevices", boost::bind(&CWebServer::Cmd_GetCamActiveDevices, this, _1, _2, _3), false, 0, "idx");
+			RegisterCommandCode("addcamactivedevice", boost::bind(&CWebServer::Cmd_AddCamActiveDevice, this, _1, _2, _3), false, 2, "idx,activeidx,activetype,activewhen,activedelay");
+			RegisterCommandCode("deleteamactivedevice", boost::bind(&CWebServer::Cmd_DeleteCamActiveDevice, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("deleteallactivecamdevices", boost::bind(&CWebServer::Cmd_DeleteAllCamActiveDevices, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("testnotification", boost::bind(&CWebServer::Cmd_TestNotification, this, _1, _2, _3), false, 2);
+			RegisterCommandCode("testswitch", boost::bind(&CWebServer::Cmd_TestSwitch, this, _1, _2, _3), false, 2, "hwdid,switchtype,lighttype");
+			RegisterCommandCode("addswitch", boost::bind(&CWebServer::Cmd_AddSwitch, this, _1, _2, _3), false, 2);
+			RegisterCommandCode("getnotificationtypes", boost::bind(&CWebServer::Cmd_GetNotificationTypes, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("addnotification", boost::bind(&CWebServer::Cmd_AddNotification, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("updatenotification", boost::bind(&CWebServer::Cmd_UpdateNotification, this, _1, _2, _3), false, 2, "idx,devidx");
+			RegisterCommandCode("deletenotification", boost::bind(&CWebServer::Cmd_DeleteNotification, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("switchdeviceorder", boost::bind(&CWebServer::Cmd_SwitchDeviceOrder, this, _1, _2, _3), false, 2, "idx1,idx2");
+			RegisterCommandCode("switchsceneorder", boost::bind(&CWebServer::Cmd_SwitchSceneOrder, this, _1, _2, _3), false, 2, "idx1,idx2");
+			RegisterCommandCode("clearnotifications", boost::bind(&CWebServer::Cmd_ClearNotifications, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("addcamera", boost::bind(&CWebServer::Cmd_AddCamera, this, _1, _2, _3), false, 2, "name,address,imageurl");
+			RegisterCommandCode("updatecamera", boost::bind(&CWebServer::Cmd_UpdateCamera, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("deletecamera", boost::bind(&CWebServer::Cmd_DeleteCamera, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("adduser", boost::bind(&CWebServer::Cmd_AddUser, this, _1, _2, _3), false, 2, "enabled,username,password,rights,RemoteSharing,TabsEnabled");
+			RegisterCommandCode("updateuser", boost::bind(&CWebServer::Cmd_UpdateUser, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("deleteuser", boost::bind(&CWebServer::Cmd_DeleteUser, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("clearlightlog", boost::bind(&CWebServer::Cmd_ClearLightLog, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("clearscenelog", boost::bind(&CWebServer::Cmd_ClearSceneLog, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("learnsw", boost::bind(&CWebServer::Cmd_LearnSwitch, this, _1, _2, _3), false, 2);
+			RegisterCommandCode("makefavorite", boost::bind(&CWebServer::Cmd_MakeFavorite, this, _1, _2, _3), false, 2, "idx,isfavorite");
+			RegisterCommandCode("makescenefavorite", boost::bind(&CWebServer::Cmd_MakeSceneFavorite, this, _1, _2, _3), false, 2, "idx,isfavorite");
+			RegisterCommandCode("resetsecuritystatus", boost::bind(&CWebServer::Cmd_ResetSecurityStatus, this, _1, _2, _3), false, 1, "idx,switchcmd");
+			RegisterCommandCode("verifypasscode", boost::bind(&CWebServer::Cmd_VerifyPasscode, this, _1, _2, _3), false, 0, "passcode");
+			RegisterCommandCode("switchmodal", boost::bind(&CWebServer::Cmd_SwitchModal, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("setcolbrightnessvalue", boost::bind(&CWebServer::Cmd_SetColBrightnessValue, this, _1, _2, _3), false, 1, "idx");
+			RegisterCommandCode("setkelvinlevel", boost::bind(&CWebServer::Cmd_SetKelvinLevel, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("brightnessup", boost::bind(&CWebServer::Cmd_BrightnessUp, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("brightnessdown", boost::bind(&CWebServer::Cmd_BrightnessDown, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("discomode", boost::bind(&CWebServer::Cmd_DiscoMode, this, _1, _2, _3), false, 1);
+			for (int ii = 1; ii <= 9; ii++)
+			{
+				std::stringstream sCommand;
+				sCommand << "discomodenum" << ii;
+				RegisterCommandCode(sCommand.str().c_str(), boost::bind(&CWebServer::Cmd_DiscoModeNum, this, _1, _2, _3, ii), false, 1);
+			}
+			RegisterCommandCode("discoup", boost::bind(&CWebServer::Cmd_DiscoUp, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("discodown", boost::bind(&CWebServer::Cmd_DiscoDown, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("speedup", boost::bind(&CWebServer::Cmd_SpeedUp, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("speeduplong", boost::bind(&CWebServer::Cmd_SpeedUpLong, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("speeddown", boost::bind(&CWebServer::Cmd_SpeedDown, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("speedmin", boost::bind(&CWebServer::Cmd_SpeedMin, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("speedmax", boost::bind(&CWebServer::Cmd_SpeedMax, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("warmer", boost::bind(&CWebServer::Cmd_Warmer, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("cooler", boost::bind(&CWebServer::Cmd_Cooler, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("fulllight", boost::bind(&CWebServer::Cmd_FullLight, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("nightlight", boost::bind(&CWebServer::Cmd_NightLight, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("whitelight", boost::bind(&CWebServer::Cmd_WhiteLight, this, _1, _2, _3), false, 1);
+			RegisterCommandCode("getfloorplanimages", boost::bind(&CWebServer::Cmd_GetFloorplanImages, this, _1, _2, _3), false, 0);
+			RegisterCommandCode("addfloorplan", boost::bind(&CWebServer::Cmd_AddFloorplan, this, _1, _2, _3), false, 2, "name,image,scalefactor");
+			RegisterCommandCode("updatefloorplan", boost::bind(&CWebServer::Cmd_UpdateFloorplan, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("deletefloorplan", boost::bind(&CWebServer::Cmd_DeleteFloorplan, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("changefloorplanorder", boost::bind(&CWebServer::Cmd_ChangeFloorplanOrder, this, _1, _2, _3), false, 2, "idx");
+			RegisterCommandCode("getunusedfloorplanplans", boost::bind(&CWebServer::Cmd_GetUnusedFloorplanPlans, this, _1, _2, _3), false, 2);
+			RegisterCommandCode("getfloorplanplans", boost::bind(&CWebServer::Cmd_GetFloorplanPlans, this, _1, _2, _3), false, 0, "idx");
+			RegisterCommandCode("addfloorplanplan", boost::bind(&CWebServer::Cmd_AddFloorplanPlan, this, _1, _2, _3), false, 2, "idx,planidx");
+			RegisterCommandCode("updatefloorplanplan", boost::bind(&CWebServer::Cmd_UpdateFloorplanPlan, this, _1, _2, _3), false, 2, "planidx");
+			RegisterCommandCode("deletefloorplanplan", boost::bind(&CWebServer::Cmd_DeleteFloorplanPlan, this, _1, _2, _3), false, 2, "idx");
 			RegisterCommandCode("thermostatstate", boost::bind(&CWebServer::Cmd_SetThermostatState, this, _1, _2, _3));
 			RegisterCommandCode("system_shutdown", boost::bind(&CWebServer::Cmd_SystemShutdown, this, _1, _2, _3));
 			RegisterCommandCode("system_reboot", boost::bind(&CWebServer::Cmd_SystemReboot, this, _1, _2, _3));
@@ -685,27 +773,59 @@ namespace http {
 			m_pWebEm->SetWebRoot(webRoot);
 		}
 
-		void CWebServer::RegisterCommandCode(const char* idname, webserver_response_function ResponseFunction, bool bypassAuthentication)
+		void CWebServer::RegisterCommandCode(const char* idname, webserver_response_function ResponseFunction, bool bypassAuthentication, const int Rights, const char *szRequiredParams)
 		{
-			m_webcommands.insert(std::pair<std::string, webserver_response_function >(std::string(idname), ResponseFunction));
+			RegisterHandler("command", idname, ResponseFunction, Rights, szRequiredParams);
 			if (bypassAuthentication)
 			{
 				m_pWebEm->RegisterWhitelistURLString(idname);
 			}
 		}
 
-		void CWebServer::RegisterRType(const char* idname, webserver_response_function ResponseFunction)
+		void CWebServer::RegisterRType(const char* idname, webserver_response_function ResponseFunction, const int Rights, const char *szRequiredParams)
 		{
-			m_webrtypes.insert(std::pair<std::string, webserver_response_function >(std::string(idname), ResponseFunction));
+			RegisterHandler(idname, "", ResponseFunction, Rights, szRequiredParams);
 		}
 
-		void CWebServer::HandleRType(const std::string &rtype, WebEmSession & session, const request& req, Json::Value &root)
+		void CWebServer::RegisterHandler(const std::string &rtype, const std::string &cparam, webserver_response_function ResponseFunction, const int Rights, const char *szRequiredParams)
+		{
+			_tWebHandler handler;
+			handler.ResponseFunction = ResponseFunction;
+			handler.Rights = Rights;
+			if (szRequiredParams != NULL)
+				StringSplit(szRequiredParams, ",", handler.RequiredParams);
+			m_webhandlers[rtype].insert(std::make_pair(cparam, handler));
+		}
+
+		//Returns false when no handler is registered for the request
+		bool CWebServer::DispatchJSonRequest(const std::string &rtype, const std::string &cparam, WebEmSession & session, const request& req, Json::Value &root)
 		{
-			std::map < std::string, webserver_response_function >::iterator pf = m_webrtypes.find(rtype);
-			if (pf != m_webrtypes.end())
+			//Looked up per level, a (rtype, cparam) key would copy both strings for every request
+			std::map < std::string, std::map<std::string, _tWebHandler> >::const_iterator ittType = m_webhandlers.find(rtype);
+			if (ittType == m_webhandlers.end())
+				return false;
+			std::map < std::string, _tWebHandler >::const_iterator pf = ittType->second.find(cparam);
+			if (pf == ittType->second.end())
+				return false;
+			const _tWebHandler &handler = pf->second;
+			if (session.rights < handler.Rights)
+			{
+				session.reply_status = reply::forbidden;
+				return true;
+			}
+			std::vector<std::string>::const_iterator itt;
+			for (itt = handler.RequiredParams.begin(); itt != handler.RequiredParams.end(); ++itt)
 			{
-				pf->second(session, req, root);
+				if (request::findValue(&req, itt->c_str()).empty())
+					return true;
 			}
+			handler.ResponseFunction(session, req, root);
+			return true;
+		}
+
+		void CWebServer::HandleRType(const std::string &rtype, WebEmSession & session, const request& req, Json::Value &root)
+		{
+			DispatchJSonRequest(rtype, "", session, req, root);
 		}
 
 		int GetDirFilesRecursive(const std::string &DirPath, std::map<std::string,int> &_Files)
@@ -844,7 +964,7 @@ namespace http {
 					goto exitjson;
 
 				}
-				if (_log.isTraceEnabled()) _log.Log(LOG_TRACE, "WEBS GetJSon :%s :%s ", cparam.c_str(), req.uri.c_str());
+				_log.Log(LOGCAT_WEBSERVER, LOG_TRACE, "WEBS GetJSon :%s :%s ", cparam.c_str(), req.uri.c_str());
 				HandleCommand(cparam, session, req, root);
 			} //(rtype=="command")
 			else {
@@ -1165,6 +1285,10 @@ namespace http {
 			else if (htype == HTYPE_Arilux) {
 				//all fine here!
 			}
+			else if (htype == HTYPE_TelemetryIngest) {
+				if ((port == 0) || (password == ""))
+					return;
+			}
 			else if (
 				(htype == HTYPE_Wunderground) ||
 				(htype == HTYPE_DarkSky) ||
@@ -1509,6 +1633,10 @@ namespace http {
 			else if (htype == HTYPE_Arilux) {
 				//All fine here
 			}
+			else if (htype == HTYPE_TelemetryIngest) {
+				if ((port == 0) || (password == ""))
+					return;
+			}
 			else if (
 				(htype == HTYPE_Wunderground) ||
 				(htype == HTYPE_DarkSky) ||
@@ -1953,6 +2081,136 @@ namespace http {
 			_log.ClearLog();
 		}
 
+		//Approximate memory usage per subsystem (see also the -lean startup option)
+		void CWebServer::Cmd_GetMemoryUsage(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetMemoryUsage";
+
+			long ResidentKB;
+			int nThreads;
+			if (GetProcessMemoryUsage(ResidentKB, nThreads))
+			{
+				root["ResidentKB"] = (Json::Value::Int64)ResidentKB;
+				root["Threads"] = nThreads;
+			}
+
+			int ii = 0;
+			size_t nItems = 0;
+			size_t nBytes = _log.GetMemoryUsage(nItems);
+			root["result"][ii]["Name"] = "Log";
+			root["result"][ii]["Items"] = (Json::Value::UInt64)nItems;
+			root["result"][ii]["Bytes"] = (Json::Value::UInt64)nBytes;
+			ii++;
+
+			nBytes = m_mainworker.m_eventsystem.GetMemoryUsage(nItems);
+			root["result"][ii]["Name"] = "EventSystem";
+			root["result"][ii]["Items"] = (Json::Value::UInt64)nItems;
+			root["result"][ii]["Bytes"] = (Json::Value::UInt64)nBytes;
+			ii++;
+
+			root["result"][ii]["Name"] = "Database";
+			root["result"][ii]["Bytes"] = (Json::Value::UInt64)m_sql.GetMemoryUsage();
+		}
+
+		void CWebServer::Cmd_GetPollStatistics(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetPollStatistics";
+
+			std::vector<CPollScheduler::_tPollStatistics> stats = m_mainworker.m_pollscheduler.GetStatistics();
+			std::vector<CPollScheduler::_tPollStatistics>::const_iterator itt;
+			int ii = 0;
+			for (itt = stats.begin(); itt != stats.end(); ++itt)
+			{
+				root["result"][ii]["HardwareID"] = itt->HardwareID;
+				root["result"][ii]["Name"] = itt->Name;
+				root["result"][ii]["Interval"] = itt->Interval;
+				root["result"][ii]["Polls"] = (Json::Value::UInt64)itt->Polls;
+				root["result"][ii]["Failures"] = (Json::Value::UInt64)itt->Failures;
+				root["result"][ii]["ConsecutiveFailures"] = itt->ConsecutiveFailures;
+				root["result"][ii]["LastDuration"] = itt->LastDuration;
+				root["result"][ii]["AvgDuration"] = itt->AvgDuration;
+				root["result"][ii]["MaxDuration"] = itt->MaxDuration;
+				root["result"][ii]["Running"] = itt->bRunning;
+				ii++;
+			}
+		}
+
+		void CWebServer::Cmd_GetEventSystemStatistics(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetEventSystemStatistics";
+
+			unsigned long nRuns, nTimeouts;
+			int Timeout;
+			m_mainworker.m_eventsystem.GetLuaStatistics(nRuns, nTimeouts, Timeout);
+			root["LuaScriptRuns"] = (Json::Value::UInt64)nRuns;
+			root["LuaScriptTimeouts"] = (Json::Value::UInt64)nTimeouts;
+			root["LuaScriptTimeout"] = Timeout;
+		}
+
+		void CWebServer::Cmd_GetSystemMetrics(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			CHardwareMonitor *pMonitor = dynamic_cast<CHardwareMonitor*>(m_mainworker.GetHardwareByType(HTYPE_System));
+			if (pMonitor == NULL)
+				return; //Motherboard sensors not enabled
+			root["status"] = "OK";
+			root["title"] = "GetSystemMetrics";
+			pMonitor->GetMetrics(root);
+		}
+
+		void CWebServer::Cmd_GetWebServerStatistics(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetWebServerStatistics";
+			root["Port"] = m_pWebEm->GetPort();
+
+			//Statistics of the server that handles this request (http or https)
+			std::vector<request_scheduler::class_statistics> stats = m_pWebEm->GetRequestStatistics();
+			std::vector<request_scheduler::class_statistics>::const_iterator itt;
+			int ii = 0;
+			for (itt = stats.begin(); itt != stats.end(); ++itt)
+			{
+				root["result"][ii]["Name"] = itt->name;
+				root["result"][ii]["Active"] = itt->active;
+				root["result"][ii]["Queued"] = itt->queued;
+				root["result"][ii]["Handled"] = (Json::Value::UInt64)itt->handled;
+				root["result"][ii]["RejectedClient"] = (Json::Value::UInt64)itt->rejected_client;
+				root["result"][ii]["RejectedQueue"] = (Json::Value::UInt64)itt->rejected_queue;
+				root["result"][ii]["Expired"] = (Json::Value::UInt64)itt->expired;
+				root["result"][ii]["AvgQueueTime"] = itt->avg_queue_time;
+				root["result"][ii]["MaxQueueTime"] = itt->max_queue_time;
+				root["result"][ii]["AvgExecTime"] = itt->avg_exec_time;
+				ii++;
+			}
+		}
+
 		//Plan Functions
 		void CWebServer::Cmd_AddPlan(WebEmSession & session, const request& req, Json::Value &root)
 		{
@@ -2747,12 +3005,6 @@ namespace http {
 
 		void CWebServer::Cmd_UpdateDevice(WebEmSession & session, const request& req, Json::Value &root)
 		{
-			if (session.rights < 1)
-			{
-				session.reply_status = reply::forbidden;
-				return; //only user or higher allowed
-			}
-
 			std::string idx = request::findValue(&req, "idx");
 			std::string hid = request::findValue(&req, "hid");
 			std::string did = request::findValue(&req, "did");
@@ -2859,12 +3111,201 @@ namespace http {
 			}
 		}
 
+		//Reads the idx of a switchlights item, a number or a numeric string
+		static bool GetSwitchItemIdx(const Json::Value &jIdx, uint64_t &idx)
+		{
+			if (jIdx.isString())
+			{
+				std::string sIdx = jIdx.asString();
+				if ((sIdx.empty()) || (!isdigit((unsigned char)sIdx[0])))
+					return false;
+				char *pEnd = NULL;
+				idx = strtoull(sIdx.c_str(), &pEnd, 10);
+				return (*pEnd == 0);
+			}
+			if (!jIdx.isUInt64())
+				return false;
+			idx = jIdx.asUInt64();
+			return true;
+		}
+
+		//Reads an optional integer value of a switchlights item, a number, boolean or numeric string
+		static bool GetSwitchItemInt(const Json::Value &jItem, const char *szName, const int defValue, int &value)
+		{
+			value = defValue;
+			if (!jItem.isMember(szName))
+				return true;
+			const Json::Value &jValue = jItem[szName];
+			if (jValue.isString())
+			{
+				std::string sValue = jValue.asString();
+				if (sValue.empty())
+					return false;
+				char *pEnd = NULL;
+				long lValue = strtol(sValue.c_str(), &pEnd, 10);
+				if ((*pEnd != 0) || (lValue < INT_MIN) || (lValue > INT_MAX))
+					return false;
+				value = (int)lValue;
+				return true;
+			}
+			if (jValue.isBool())
+			{
+				value = jValue.asBool() ? 1 : 0;
+				return true;
+			}
+			if ((!jValue.isNumeric()) || (!jValue.isConvertibleTo(Json::intValue)))
+				return false;
+			value = jValue.asInt();
+			return true;
+		}
+
+		//Switch a list of devices with one request
+		//items (or the request body) is a JSON array: [{"idx":12,"switchcmd":"Set Level","level":50},{"idx":13,"switchcmd":"Off"},...]
+		//optional per item: "hue" and "ooc" (only on change), "passcode" (request parameter) is used for protected devices
+		void CWebServer::Cmd_SwitchLights(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights < 1)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only user/admin allowed
+			}
+			std::string Username = "Admin";
+			if (!session.username.empty())
+				Username = session.username;
+
+			std::string sItems = request::findValue(&req, "items");
+			if (sItems.empty())
+				sItems = req.content;
+			std::string passcode = request::findValue(&req, "passcode");
+
+			Json::Value jItems;
+			Json::Reader jReader;
+			if ((!jReader.parse(sItems, jItems)) || (!jItems.isArray()) || (jItems.empty()))
+				return;
+
+			root["title"] = "SwitchLights";
+
+			//Items with an invalid idx or value get an error, the other items are still switched
+			std::vector<MainWorker::_tSwitchLightRequest> requests;
+			std::vector<std::string> errors;
+			std::stringstream sIDs;
+			bool bHaveIDs = false;
+			for (Json::ArrayIndex ii = 0; ii < jItems.size(); ii++)
+			{
+				const Json::Value &jItem = jItems[ii];
+				MainWorker::_tSwitchLightRequest request;
+				request.idx = 0;
+				request.level = 0;
+				request.hue = -1;
+				request.ooc = false;
+				request.bResult = false;
+				int ooc = 0;
+				std::string szError;
+				if ((!jItem.isObject()) || (!jItem.isMember("idx")) || (!jItem.isMember("switchcmd")))
+					szError = "Invalid item";
+				else if (!GetSwitchItemIdx(jItem["idx"], request.idx))
+					szError = "Invalid idx";
+				else if ((!jItem["switchcmd"].isString()) || (jItem["switchcmd"].asString().empty()))
+					szError = "Invalid switchcmd";
+				else if (
+					(!GetSwitchItemInt(jItem, "level", 0, request.level)) ||
+					(!GetSwitchItemInt(jItem, "hue", -1, request.hue)) ||
+					(!GetSwitchItemInt(jItem, "ooc", 0, ooc))
+					)
+					szError = "Invalid level/hue/ooc";
+				else
+				{
+					request.switchcmd = jItem["switchcmd"].asString();
+					request.ooc = (ooc != 0);
+					if (bHaveIDs)
+						sIDs << ",";
+					sIDs << request.idx;
+					bHaveIDs = true;
+				}
+				requests.push_back(request);
+				errors.push_back(szError);
+			}
+
+			//Check protection of all devices at once
+			std::map<uint64_t, std::pair<bool, std::string> > devices;
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT ID, [Protected], [Name] FROM DeviceStatus WHERE (ID IN (%q))", sIDs.str().c_str());
+			bool bHaveProtected = false;
+			std::vector<std::vector<std::string> >::const_iterator itt;
+			for (itt = result.begin(); itt != result.end(); ++itt)
+			{
+				std::vector<std::string> sd = *itt;
+				uint64_t ID;
+				std::stringstream s_str(sd[0]);
+				s_str >> ID;
+				bool bIsProtected = atoi(sd[1].c_str()) != 0;
+				if (bIsProtected)
+					bHaveProtected = true;
+				devices[ID] = std::pair<bool, std::string>(bIsProtected, sd[2]);
+			}
+			bool bPasscodeOK = false;
+			if ((bHaveProtected) && (!passcode.empty()))
+			{
+				std::string rpassword;
+				int nValue = 1;
+				m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
+				bPasscodeOK = (GenerateMD5Hash(passcode) == rpassword);
+				if (!bPasscodeOK)
+					_log.Log(LOG_ERROR, "User: %s initiated a switch command (Wrong code!)", Username.c_str());
+			}
+
+			//Only the devices that may be switched are passed on, the others get their error here
+			std::vector<MainWorker::_tSwitchLightRequest> allowed;
+			for (size_t ii = 0; ii < requests.size(); ii++)
+			{
+				if (!errors[ii].empty())
+					continue;
+				std::map<uint64_t, std::pair<bool, std::string> >::const_iterator ittDevice = devices.find(requests[ii].idx);
+				if (ittDevice == devices.end())
+				{
+					errors[ii] = "Device not found";
+					continue;
+				}
+				if ((ittDevice->second.first) && (!bPasscodeOK))
+				{
+					errors[ii] = "WRONG CODE";
+					continue;
+				}
+				_log.Log(LOG_STATUS, "User: %s initiated a switch command (%" PRIu64 "/%s/%s)", Username.c_str(), requests[ii].idx, ittDevice->second.second.c_str(), requests[ii].switchcmd.c_str());
+				allowed.push_back(requests[ii]);
+			}
+
+			m_mainworker.SwitchLights(allowed);
+
+			std::vector<MainWorker::_tSwitchLightRequest>::const_iterator ittAllowed = allowed.begin();
+			for (size_t ii = 0; ii < requests.size(); ii++)
+			{
+				std::stringstream sidx;
+				sidx << requests[ii].idx;
+				root["result"][(int)ii]["idx"] = sidx.str();
+				if (errors[ii].empty())
+				{
+					bool bResult = ittAllowed->bResult;
+					++ittAllowed;
+					if (bResult)
+					{
+						root["result"][(int)ii]["status"] = "OK";
+						continue;
+					}
+					errors[ii] = "Error sending switch command, check device/hardware !";
+				}
+				root["result"][(int)ii]["status"] = "ERROR";
+				root["result"][(int)ii]["message"] = errors[ii];
+			}
+			root["status"] = "OK";
+		}
+
 		void CWebServer::Cmd_SetThermostatState(WebEmSession & session, const request& req, Json::Value &root)
 		{
 			std::string sstate = request::findValue(&req, "state");
 			std::string idx = request::findValue(&req, "idx");
 			std::string name = request::findValue(&req,"name");
-			_log.Log(LOG_TRACE, "WEBS SetThermostatState  State cmd Id:%s Name:%s State:%s",idx.c_str(), name.c_str(),sstate.c_str());
+			_log.Log(LOGCAT_WEBSERVER, LOG_TRACE, "WEBS SetThermostatState  State cmd Id:%s Name:%s State:%s",idx.c_str(), name.c_str(),sstate.c_str());
 
 			if (
 				(idx == "") ||
@@ -3146,500 +3587,366 @@ namespace http {
 			m_sql.DeleteDataPoint(idx.c_str(), Date);
 		}
 
-		void CWebServer::HandleCommand(const std::string &cparam, WebEmSession & session, const request& req, Json::Value &root)
+		void CWebServer::Cmd_SwitchLight(WebEmSession & session, const request& req, Json::Value &root)
 		{
-			std::map < std::string, webserver_response_function >::iterator pf = m_webcommands.find(cparam);
-			if (pf != m_webcommands.end())
-			{
-				pf->second(session, req, root);
-				return;
-			}
-
 			std::vector<std::vector<std::string> > result;
-			std::vector<std::vector<std::string> > result2;
-			char szTmp[300];
 
-			bool bHaveUser = (session.username != "");
-			int iUser = -1;
-			if (bHaveUser)
+			std::string Username = "Admin";
+			if (!session.username.empty())
+				Username = session.username;
+
+			std::string idx = request::findValue(&req, "idx");
+			std::string switchcmd = request::findValue(&req, "switchcmd");
+			std::string level = request::findValue(&req, "level");
+			std::string onlyonchange=request::findValue(&req, "ooc");//No update unless the value changed (check if updated)
+			_log.Log(LOGCAT_WEBSERVER, LOG_TRACE, "WEBS switchlight idx:%s switchcmd:%s level:%s",  idx.c_str() , switchcmd.c_str() , level.c_str());
+			std::string passcode = request::findValue(&req, "passcode");
+
+			result = m_sql.safe_query(
+				"SELECT [Protected],[Name] FROM DeviceStatus WHERE (ID = '%q')", idx.c_str());
+			if (result.empty())
 			{
-				iUser = FindUser(session.username.c_str());
+				//Switch not found!
+				return;
 			}
+			bool bIsProtected = atoi(result[0][0].c_str()) != 0;
+			std::string sSwitchName  = result[0][1];
 
-			if (cparam == "deleteallsubdevices")
+			if (bIsProtected)
 			{
-				if (session.rights < 2)
+				if (passcode.empty())
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
+					//Switch is protected, but no passcode has been
+					root["title"] = "SwitchLight";
+					root["status"] = "ERROR";
+					root["message"] = "WRONG CODE";
+					return;
 				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
+				//Check if passcode is correct
+				passcode = GenerateMD5Hash(passcode);
+				std::string rpassword;
+				int nValue = 1;
+				m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
+				if (passcode != rpassword)
+				{
+					_log.Log(LOG_ERROR, "User: %s initiated a switch command (Wrong code!)", Username.c_str());
+					root["title"] = "SwitchLight";
+					root["status"] = "ERROR";
+					root["message"] = "WRONG CODE";
 					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteAllSubDevices";
-				result = m_sql.safe_query("DELETE FROM LightSubDevices WHERE (ParentID == '%q')", idx.c_str());
+				}
 			}
-			else if (cparam == "deletesubdevice")
-			{
-				if (session.rights < 2)
+
+			_log.Log(LOG_STATUS, "User: %s initiated a switch command (%s/%s/%s)", Username.c_str(), idx.c_str(), sSwitchName.c_str(), switchcmd.c_str());
+
+			if (switchcmd == "Toggle") {
+				//Request current state of switch
+				result = m_sql.safe_query(
+					"SELECT [Type],[SubType],SwitchType,nValue,sValue FROM DeviceStatus WHERE (ID = '%q')", idx.c_str());
+				if (result.size() > 0)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
+					std::vector<std::string> sd = result[0];
+					unsigned char devType = (unsigned char)atoi(sd[0].c_str());
+					unsigned char subType = (unsigned char)atoi(sd[1].c_str());
+					_eSwitchType switchtype = (_eSwitchType)atoi(sd[2].c_str());
+					int nValue = atoi(sd[3].c_str());
+					std::string sValue = sd[4];
+					std::string lstatus = "";
+					int llevel = 0;
+					bool bHaveDimmer = false;
+					bool bHaveGroupCmd = false;
+					int maxDimLevel = 0;
+					GetLightStatus(devType, subType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+					switchcmd = (IsLightSwitchOn(lstatus) == true) ? "Off" : "On";
 				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
+			}
+			root["title"] = "SwitchLight";
+			if (m_mainworker.SwitchLight(idx, switchcmd, level, "-1", onlyonchange, 0) == true)
+			{
 				root["status"] = "OK";
-				root["title"] = "DeleteSubDevice";
-				result = m_sql.safe_query("DELETE FROM LightSubDevices WHERE (ID == '%q')", idx.c_str());
 			}
-			else if (cparam == "addsubdevice")
+			else
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+				root["status"] = "ERROR";
+				root["message"] = "Error sending switch command, check device/hardware !";
+			}
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string subidx = request::findValue(&req, "subidx");
-				if ((idx == "") || (subidx == ""))
-					return;
-				if (idx == subidx)
-					return;
+		void CWebServer::Cmd_SwitchScene(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-				//first check if it is not already a sub device
-				result = m_sql.safe_query("SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q') AND (ParentID =='%q')",
-					subidx.c_str(), idx.c_str());
-				if (result.size() == 0)
-				{
-					root["status"] = "OK";
-					root["title"] = "AddSubDevice";
-					//no it is not, add it
-					result = m_sql.safe_query(
-						"INSERT INTO LightSubDevices (DeviceRowID, ParentID) VALUES ('%q','%q')",
-						subidx.c_str(),
-						idx.c_str()
-						);
-				}
+			std::string Username = "Admin";
+			if (!session.username.empty())
+				Username = session.username;
+
+			std::string idx = request::findValue(&req, "idx");
+			std::string switchcmd = request::findValue(&req, "switchcmd");
+			std::string passcode = request::findValue(&req, "passcode");
+
+			result = m_sql.safe_query(
+				"SELECT [Protected] FROM Scenes WHERE (ID = '%q')", idx.c_str());
+			if (result.empty())
+			{
+				//Scene/Group not found!
+				return;
 			}
-			else if (cparam == "addscenedevice")
+			bool bIsProtected = atoi(result[0][0].c_str()) != 0;
+			if (bIsProtected)
 			{
-				if (session.rights < 2)
+				if (passcode.empty())
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx = request::findValue(&req, "idx");
-				std::string devidx = request::findValue(&req, "devidx");
-				std::string isscene = request::findValue(&req, "isscene");
-				std::string scommand = request::findValue(&req, "command");
-				int ondelay = atoi(request::findValue(&req, "ondelay").c_str());
-				int offdelay = atoi(request::findValue(&req, "offdelay").c_str());
-
-				if (
-					(idx == "") ||
-					(devidx == "") ||
-					(isscene == "")
-					)
+					root["title"] = "SwitchScene";
+					root["status"] = "ERROR";
+					root["message"] = "WRONG CODE";
 					return;
-				int level = atoi(request::findValue(&req, "level").c_str());
-				int hue = atoi(request::findValue(&req, "hue").c_str());
-
-				unsigned char command=0;
-				result = m_sql.safe_query("SELECT HardwareID, DeviceID, Unit, Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID=='%q')",
-					devidx.c_str());
-				if (result.size() > 0)
+				}
+				//Check if passcode is correct
+				passcode = GenerateMD5Hash(passcode);
+				std::string rpassword;
+				int nValue = 1;
+				m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
+				if (passcode != rpassword)
 				{
-					int dType = atoi(result[0][3].c_str());
-					int sType = atoi(result[0][4].c_str());
-					_eSwitchType switchtype = (_eSwitchType)atoi(result[0][5].c_str());
-					std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(result[0][6].c_str());
-					GetLightCommand(dType, sType, switchtype, scommand, command, options);
+					root["title"] = "SwitchScene";
+					root["status"] = "ERROR";
+					root["message"] = "WRONG CODE";
+					_log.Log(LOG_ERROR, "User: %s initiated a scene/group command (Wrong code!)", Username.c_str());
+					return;
 				}
+			}
+			_log.Log(LOG_STATUS, "User: %s initiated a scene/group command", Username.c_str());
 
-				//first check if this device is not the scene code!
-				result = m_sql.safe_query("SELECT Activators, SceneType FROM Scenes WHERE (ID=='%q')", idx.c_str());
-				if (result.size() > 0)
+			if (m_mainworker.SwitchScene(idx, switchcmd) == true)
+			{
+				root["status"] = "OK";
+				root["title"] = "SwitchScene";
+			}
+		}
+
+		void CWebServer::Cmd_GetSunRiseSet(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			char szTmp[300];
+			if (!m_mainworker.m_LastSunriseSet.empty())
+			{
+				std::vector<std::string> strarray;
+				StringSplit(m_mainworker.m_LastSunriseSet, ";", strarray);
+				if (strarray.size() == 2)
 				{
-					int SceneType = atoi(result[0][1].c_str());
+					struct tm loctime;
+					time_t now = mytime(NULL);
 
-					std::vector<std::string> arrayActivators;
-					StringSplit(result[0][0], ";", arrayActivators);
-					std::vector<std::string>::const_iterator ittAct;
-					for (ittAct = arrayActivators.begin(); ittAct != arrayActivators.end(); ++ittAct)
-					{
-						std::string sCodeCmd = *ittAct;
+					localtime_r(&now, &loctime);
+					//strftime(szTmp, 80, "%b %d %Y %X", &loctime);
+					strftime(szTmp, 80, "%Y-%m-%d %X", &loctime);
 
-						std::vector<std::string> arrayCode;
-						StringSplit(sCodeCmd, ":", arrayCode);
+					root["status"] = "OK";
+					root["title"] = "getSunRiseSet";
+					root["ServerTime"] = szTmp;
+					root["Sunrise"] = strarray[0];
+					root["Sunset"] = strarray[1];
+				}
+			}
+		}
 
-						std::string sID = arrayCode[0];
-						std::string sCode = "";
-						if (arrayCode.size() == 2)
-						{
-							sCode = arrayCode[1];
-						}
-
-						if (sID == devidx)
-						{
-							return; //Group does not work with separate codes, so already there
-						}
-					}
-				}
-				//first check if it is not already a part of this scene/group (with the same OnDelay)
-				if (isscene == "true") {
-					result = m_sql.safe_query("SELECT ID FROM SceneDevices WHERE (DeviceRowID=='%q') AND (SceneRowID =='%q') AND (OnDelay == %d) AND (OffDelay == %d) AND (Cmd == %d)",
-						devidx.c_str(), idx.c_str(), ondelay, offdelay, command);
-				}
-				else {
-					result = m_sql.safe_query("SELECT ID FROM SceneDevices WHERE (DeviceRowID=='%q') AND (SceneRowID =='%q') AND (OnDelay == %d)",
-						devidx.c_str(), idx.c_str(), ondelay);
-				}
-				if (result.size() == 0)
-				{
-					root["status"] = "OK";
-					root["title"] = "AddSceneDevice";
-					//no it is not, add it
-					if (isscene == "true")
-					{
-						m_sql.safe_query(
-							"INSERT INTO SceneDevices (DeviceRowID, SceneRowID, Cmd, Level, Hue, OnDelay, OffDelay) VALUES ('%q','%q',%d,%d,%d,%d,%d)",
-							devidx.c_str(),
-							idx.c_str(),
-							command,
-							level,
-							hue,
-							ondelay,
-							offdelay
-							);
-					}
-					else
-					{
-						m_sql.safe_query(
-							"INSERT INTO SceneDevices (DeviceRowID, SceneRowID, Level, Hue, OnDelay, OffDelay) VALUES ('%q','%q',%d,%d,%d,%d)",
-							devidx.c_str(),
-							idx.c_str(),
-							level,
-							hue,
-							ondelay,
-							offdelay
-							);
-					}
-				}
-			}
-			else if (cparam == "updatescenedevice")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		void CWebServer::Cmd_GetServerTime(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			char szTmp[300];
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string devidx = request::findValue(&req, "devidx");
-				std::string scommand = request::findValue(&req, "command");
-				int ondelay = atoi(request::findValue(&req, "ondelay").c_str());
-				int offdelay = atoi(request::findValue(&req, "offdelay").c_str());
+			struct tm loctime;
+			time_t now = mytime(NULL);
 
-				if (
-					(idx == "") ||
-					(devidx == "")
-					)
-					return;
+			localtime_r(&now, &loctime);
+			//strftime(szTmp, 80, "%b %d %Y %X", &loctime);
+			strftime(szTmp, 80, "%Y-%m-%d %X", &loctime);
 
-				unsigned char command = 0;
+			root["status"] = "OK";
+			root["title"] = "getServerTime";
+			root["ServerTime"] = szTmp;
+		}
 
-				result = m_sql.safe_query("SELECT HardwareID, DeviceID, Unit, Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID=='%q')",
-					devidx.c_str());
-				if (result.size() > 0)
-				{
-					int dType = atoi(result[0][3].c_str());
-					int sType = atoi(result[0][4].c_str());
-					_eSwitchType switchtype = (_eSwitchType)atoi(result[0][5].c_str());
-					std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(result[0][6].c_str());
-					GetLightCommand(dType, sType, switchtype, scommand, command, options);
-				}
-				int level = atoi(request::findValue(&req, "level").c_str());
-				int hue = atoi(request::findValue(&req, "hue").c_str());
-				root["status"] = "OK";
-				root["title"] = "UpdateSceneDevice";
-				result = m_sql.safe_query(
-					"UPDATE SceneDevices SET Cmd=%d, Level=%d, Hue=%d, OnDelay=%d, OffDelay=%d  WHERE (ID == '%q')",
-					command, level, hue, ondelay, offdelay, idx.c_str());
-			}
-			else if (cparam == "deletescenedevice")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		void CWebServer::Cmd_GetSecStatus(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "GetSecStatus";
+			int secstatus = 0;
+			m_sql.GetPreferencesVar("SecStatus", secstatus);
+			root["secstatus"] = secstatus;
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteSceneDevice";
-				m_sql.safe_query("DELETE FROM SceneDevices WHERE (ID == '%q')", idx.c_str());
-				m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (DevSceneType==1) AND (DevSceneRowID == '%q')", idx.c_str());
-			}
-			else if (cparam == "getsubdevices")
+		void CWebServer::Cmd_SetSecStatus(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string ssecstatus = request::findValue(&req, "secstatus");
+			std::string seccode = request::findValue(&req, "seccode");
+			if ((ssecstatus == "") || (seccode == ""))
 			{
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-
-				root["status"] = "OK";
-				root["title"] = "GetSubDevices";
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT a.ID, b.Name FROM LightSubDevices a, DeviceStatus b WHERE (a.ParentID=='%q') AND (b.ID == a.DeviceRowID)",
-					idx.c_str());
-				if (result.size() > 0)
-				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					int ii = 0;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
-
-						root["result"][ii]["ID"] = sd[0];
-						root["result"][ii]["Name"] = sd[1];
-						ii++;
-					}
-				}
+				root["message"] = "WRONG CODE";
+				return;
 			}
-			else if (cparam == "getscenedevices")
+			root["title"] = "SetSecStatus";
+			std::string rpassword;
+			int nValue = 1;
+			m_sql.GetPreferencesVar("SecPassword", nValue, rpassword);
+			if (seccode != rpassword)
 			{
-				std::string idx = request::findValue(&req, "idx");
-				std::string isscene = request::findValue(&req, "isscene");
-
-				if (
-					(idx == "") ||
-					(isscene == "")
-					)
-					return;
-
-				root["status"] = "OK";
-				root["title"] = "GetSceneDevices";
-
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT a.ID, b.Name, a.DeviceRowID, b.Type, b.SubType, b.nValue, b.sValue, a.Cmd, a.Level, b.ID, a.[Order], a.Hue, a.OnDelay, a.OffDelay, b.SwitchType FROM SceneDevices a, DeviceStatus b WHERE (a.SceneRowID=='%q') AND (b.ID == a.DeviceRowID) ORDER BY a.[Order]",
-					idx.c_str());
-				if (result.size() > 0)
-				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					int ii = 0;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
-
-						root["result"][ii]["ID"] = sd[0];
-						root["result"][ii]["Name"] = sd[1];
-						root["result"][ii]["DevID"] = sd[2];
-						root["result"][ii]["DevRealIdx"] = sd[9];
-						root["result"][ii]["Order"] = atoi(sd[10].c_str());
-						root["result"][ii]["OnDelay"] = atoi(sd[12].c_str());
-						root["result"][ii]["OffDelay"] = atoi(sd[13].c_str());
-
-						_eSwitchType switchtype=(_eSwitchType)atoi(sd[14].c_str());
-
-						unsigned char devType = atoi(sd[3].c_str());
-
-						//switchtype seemed not to be used down with the GetLightStatus command,
-						//causing RFY to go wrong, fixing here
-						if (devType != pTypeRFY)
-							switchtype = STYPE_OnOff;
-
-						unsigned char subType = atoi(sd[4].c_str());
-						unsigned char nValue = (unsigned char)atoi(sd[5].c_str());
-						std::string sValue = sd[6];
-						int command = atoi(sd[7].c_str());
-						int level = atoi(sd[8].c_str());
-
-						std::string lstatus = "";
-						int llevel = 0;
-						bool bHaveDimmer = false;
-						bool bHaveGroupCmd = false;
-						int maxDimLevel = 0;
-						GetLightStatus(devType, subType, switchtype, command, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-						root["result"][ii]["Command"] = lstatus;
-						root["result"][ii]["Level"] = level;
-						root["result"][ii]["Hue"] = atoi(sd[11].c_str());
-						root["result"][ii]["Type"] = RFX_Type_Desc(devType, 1);
-						root["result"][ii]["SubType"] = RFX_Type_SubType_Desc(devType, subType);
-						ii++;
-					}
-				}
+				root["status"] = "ERROR";
+				root["message"] = "WRONG CODE";
+				return;
 			}
-			else if (cparam == "changescenedeviceorder")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				std::string sway = request::findValue(&req, "way");
-				if (sway == "")
-					return;
-				bool bGoUp = (sway == "0");
-
-				std::string aScene, aOrder, oID, oOrder;
-
-				//Get actual device order
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT SceneRowID, [Order] FROM SceneDevices WHERE (ID=='%q')",
-					idx.c_str());
-				if (result.size() < 1)
-					return;
-				aScene = result[0][0];
-				aOrder = result[0][1];
-
-				if (!bGoUp)
-				{
-					//Get next device order
-					result = m_sql.safe_query("SELECT ID, [Order] FROM SceneDevices WHERE (SceneRowID=='%q' AND [Order]>'%q') ORDER BY [Order] ASC",
-						aScene.c_str(), aOrder.c_str());
-					if (result.size() < 1)
-						return;
-					oID = result[0][0];
-					oOrder = result[0][1];
-				}
-				else
-				{
-					//Get previous device order
-					result = m_sql.safe_query("SELECT ID, [Order] FROM SceneDevices WHERE (SceneRowID=='%q' AND [Order]<'%q') ORDER BY [Order] DESC",
-						aScene.c_str(), aOrder.c_str());
-					if (result.size() < 1)
-						return;
-					oID = result[0][0];
-					oOrder = result[0][1];
-				}
-				//Swap them
-				root["status"] = "OK";
-				root["title"] = "ChangeSceneDeviceOrder";
+			root["status"] = "OK";
+			int iSecStatus = atoi(ssecstatus.c_str());
+			m_mainworker.UpdateDomoticzSecurityStatus(iSecStatus);
+		}
 
-				result = m_sql.safe_query("UPDATE SceneDevices SET [Order] = '%q' WHERE (ID='%q')",
-					oOrder.c_str(), idx.c_str());
-				result = m_sql.safe_query("UPDATE SceneDevices SET [Order] = '%q' WHERE (ID='%q')",
-					aOrder.c_str(), oID.c_str());
-			}
-			else if (cparam == "deleteallscenedevices")
+		void CWebServer::Cmd_GetLightSwitches(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "GetLightSwitches";
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT ID, Name, Type, SubType, Used, SwitchType, Options FROM DeviceStatus ORDER BY Name");
+			if (result.size() > 0)
 			{
-				if (session.rights < 2)
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				int ii = 0;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+					std::vector<std::string> sd = *itt;
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteAllSceneDevices";
-				result = m_sql.safe_query("DELETE FROM SceneDevices WHERE (SceneRowID == %q)", idx.c_str());
-			}
-			else if (cparam == "getmanualhardware")
-			{
-				//used by Add Manual Light/Switch dialog
-				root["status"] = "OK";
-				root["title"] = "GetHardware";
-				result = m_sql.safe_query("SELECT ID, Name, Type FROM Hardware ORDER BY ID ASC");
-				if (result.size() > 0)
-				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					int ii = 0;
-					for (itt = result.begin(); itt != result.end(); ++itt)
+					std::string ID = sd[0];
+					std::string Name = sd[1];
+					int Type = atoi(sd[2].c_str());
+					int SubType = atoi(sd[3].c_str());
+					int used = atoi(sd[4].c_str());
+					_eSwitchType switchtype = (_eSwitchType)atoi(sd[5].c_str());
+					std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sd[6]);
+					bool bdoAdd=false;
+					switch (Type)
 					{
-						std::vector<std::string> sd = *itt;
-
-						int ID = atoi(sd[0].c_str());
-						std::string Name = sd[1];
-						_eHardwareTypes Type = (_eHardwareTypes)atoi(sd[2].c_str());
-						switch (Type)
+					case pTypeLighting1:
+					case pTypeLighting2:
+					case pTypeLighting3:
+					case pTypeLighting4:
+					case pTypeLighting5:
+					case pTypeLighting6:
+					case pTypeFan:
+					case pTypeLimitlessLights:
+					case pTypeSecurity1:
+					case pTypeSecurity2:
+					case pTypeEvohome:
+					case pTypeEvohomeRelay:
+					case pTypeCurtain:
+					case pTypeBlinds:
+					case pTypeRFY:
+					case pTypeChime:
+					case pTypeThermostat2:
+					case pTypeThermostat3:
+					case pTypeThermostat4:
+					case pTypeRemote:
+					case pTypeRadiator1:
+					case pTypeGeneralSwitch:
+					case pTypeHomeConfort:
+						bdoAdd = true;
+						if (!used)
+						{
+							bdoAdd = false;
+							bool bIsSubDevice = false;
+							std::vector<std::vector<std::string> > resultSD;
+							resultSD = m_sql.safe_query("SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q')",
+								sd[0].c_str());
+							if (resultSD.size() > 0)
+								bdoAdd = true;
+						}
+						if ((Type == pTypeRadiator1) && (SubType != sTypeSmartwaresSwitchRadiator))
+							bdoAdd = false;
+						if (bdoAdd)
 						{
-						case HTYPE_RFXLAN:
-						case HTYPE_RFXtrx315:
-						case HTYPE_RFXtrx433:
-						case HTYPE_RFXtrx868:
-						case HTYPE_EnOceanESP2:
-						case HTYPE_EnOceanESP3:
-						case HTYPE_Dummy:
-						case HTYPE_Tellstick:
-						case HTYPE_EVOHOME_SCRIPT:
-						case HTYPE_EVOHOME_SERIAL:
-						case HTYPE_RaspberryGPIO:
-						case HTYPE_RFLINKUSB:
-						case HTYPE_RFLINKTCP:
-						case HTYPE_ZIBLUEUSB:
-						case HTYPE_ZIBLUETCP:
-						case HTYPE_OpenWebNetTCP:
-						case HTYPE_OpenWebNetUSB:
 							root["result"][ii]["idx"] = ID;
 							root["result"][ii]["Name"] = Name;
+							root["result"][ii]["Type"] = RFX_Type_Desc(Type, 1);
+							root["result"][ii]["SubType"] = RFX_Type_SubType_Desc(Type, SubType);
+							bool bIsDimmer = (
+								(switchtype == STYPE_Dimmer) ||
+								(switchtype == STYPE_BlindsPercentage) ||
+								(switchtype == STYPE_BlindsPercentageInverted) ||
+								(switchtype == STYPE_Selector)
+								);
+							root["result"][ii]["IsDimmer"] = bIsDimmer;
+
+							std::string dimmerLevels = "none";
+
+							if (bIsDimmer)
+							{
+								std::stringstream ss;
+
+								if (switchtype == STYPE_Selector) {
+									std::map<std::string, std::string> selectorStatuses;
+									GetSelectorSwitchStatuses(options, selectorStatuses);
+									bool levelOffHidden = options["LevelOffHidden"] == "true";
+									for (int i = 0; i < (int)selectorStatuses.size(); i++) {
+										if (levelOffHidden && (i == 0)) {
+											continue;
+										}
+										if ((levelOffHidden && (i > 1)) || (i > 0)) {
+											ss << ",";
+										}
+										ss << i * 10;
+									}
+								}
+								else
+								{
+									int nValue = 0;
+									std::string sValue = "";
+									std::string lstatus = "";
+									int llevel = 0;
+									bool bHaveDimmer = false;
+									int maxDimLevel = 0;
+									bool bHaveGroupCmd = false;
+
+									GetLightStatus(Type, SubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+
+									for (int i = 0; i <= maxDimLevel; i++)
+									{
+										if (i != 0)
+										{
+											ss << ",";
+										}
+										ss << (int)float((100.0f / float(maxDimLevel))*i);
+									}
+								}
+								dimmerLevels = ss.str();
+							}
+							root["result"][ii]["DimmerLevels"] = dimmerLevels;
 							ii++;
-							break;
 						}
+						break;
 					}
 				}
 			}
-			else if (cparam == "getgpio")
-			{
-				//used by Add Manual Light/Switch dialog
-				root["title"] = "GetGpio";
-#ifdef WITH_GPIO
-				std::vector<CGpioPin> pins = CGpio::GetPinList();
-				if (pins.size() == 0) {
-					root["status"] = "ERROR";
-					root["result"][0]["idx"] = 0;
-					root["result"][0]["Name"] = "GPIO INIT ERROR";
-				}
-				else {
-					int ii = 0;
-					for (std::vector<CGpioPin>::iterator it = pins.begin(); it != pins.end(); ++it) {
-						CGpioPin pin = *it;
-						root["status"] = "OK";
-						root["result"][ii]["idx"] = pin.GetId();
-						root["result"][ii]["Name"] = pin.ToString();
-						ii++;
-					}
-				}
-#else
-				root["status"] = "OK";
-				root["result"][0]["idx"] = 0;
-				root["result"][0]["Name"] = "N/A";
-#endif
-			}
-			else if (cparam == "getlightswitches")
+		}
+
+		void CWebServer::Cmd_GetLightSwitchesScenes(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "GetLightSwitchesScenes";
+			std::vector<std::vector<std::string> > result;
+			int ii = 0;
+
+			//First List/Switch Devices
+			result = m_sql.safe_query("SELECT ID, Name, Type, SubType, Used FROM DeviceStatus ORDER BY Name");
+			if (result.size() > 0)
 			{
-				root["status"] = "OK";
-				root["title"] = "GetLightSwitches";
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT ID, Name, Type, SubType, Used, SwitchType, Options FROM DeviceStatus ORDER BY Name");
-				if (result.size() > 0)
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					int ii = 0;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
+					std::vector<std::string> sd = *itt;
 
-						std::string ID = sd[0];
-						std::string Name = sd[1];
-						int Type = atoi(sd[2].c_str());
-						int SubType = atoi(sd[3].c_str());
-						int used = atoi(sd[4].c_str());
-						_eSwitchType switchtype = (_eSwitchType)atoi(sd[5].c_str());
-						std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sd[6]);
-						bool bdoAdd=false;
+					std::string ID = sd[0];
+					std::string Name = sd[1];
+					int Type = atoi(sd[2].c_str());
+					int SubType = atoi(sd[3].c_str());
+					int used = atoi(sd[4].c_str());
+					if (used)
+					{
 						switch (Type)
 						{
 						case pTypeLighting1:
@@ -3662,970 +3969,742 @@ namespace http {
 						case pTypeThermostat3:
 						case pTypeThermostat4:
 						case pTypeRemote:
-						case pTypeRadiator1:
 						case pTypeGeneralSwitch:
 						case pTypeHomeConfort:
-							bdoAdd = true;
-							if (!used)
-							{
-								bdoAdd = false;
-								bool bIsSubDevice = false;
-								std::vector<std::vector<std::string> > resultSD;
-								resultSD = m_sql.safe_query("SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q')",
-									sd[0].c_str());
-								if (resultSD.size() > 0)
-									bdoAdd = true;
-							}
-							if ((Type == pTypeRadiator1) && (SubType != sTypeSmartwaresSwitchRadiator))
-								bdoAdd = false;
-							if (bdoAdd)
+							root["result"][ii]["type"] = 0;
+							root["result"][ii]["idx"] = ID;
+							root["result"][ii]["Name"] = "[Light/Switch] " + Name;
+							ii++;
+							break;
+						case pTypeRadiator1:
+							if (SubType == sTypeSmartwaresSwitchRadiator)
 							{
+								root["result"][ii]["type"] = 0;
 								root["result"][ii]["idx"] = ID;
-								root["result"][ii]["Name"] = Name;
-								root["result"][ii]["Type"] = RFX_Type_Desc(Type, 1);
-								root["result"][ii]["SubType"] = RFX_Type_SubType_Desc(Type, SubType);
-								bool bIsDimmer = (
-									(switchtype == STYPE_Dimmer) ||
-									(switchtype == STYPE_BlindsPercentage) ||
-									(switchtype == STYPE_BlindsPercentageInverted) ||
-									(switchtype == STYPE_Selector)
-									);
-								root["result"][ii]["IsDimmer"] = bIsDimmer;
-
-								std::string dimmerLevels = "none";
-
-								if (bIsDimmer)
-								{
-									std::stringstream ss;
-
-									if (switchtype == STYPE_Selector) {
-										std::map<std::string, std::string> selectorStatuses;
-										GetSelectorSwitchStatuses(options, selectorStatuses);
-										bool levelOffHidden = options["LevelOffHidden"] == "true";
-										for (int i = 0; i < (int)selectorStatuses.size(); i++) {
-											if (levelOffHidden && (i == 0)) {
-												continue;
-											}
-											if ((levelOffHidden && (i > 1)) || (i > 0)) {
-												ss << ",";
-											}
-											ss << i * 10;
-										}
-									}
-									else
-									{
-										int nValue = 0;
-										std::string sValue = "";
-										std::string lstatus = "";
-										int llevel = 0;
-										bool bHaveDimmer = false;
-										int maxDimLevel = 0;
-										bool bHaveGroupCmd = false;
-
-										GetLightStatus(Type, SubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-
-										for (int i = 0; i <= maxDimLevel; i++)
-										{
-											if (i != 0)
-											{
-												ss << ",";
-											}
-											ss << (int)float((100.0f / float(maxDimLevel))*i);
-										}
-									}
-									dimmerLevels = ss.str();
-								}
-								root["result"][ii]["DimmerLevels"] = dimmerLevels;
+								root["result"][ii]["Name"] = "[Light/Switch] " + Name;
 								ii++;
 							}
 							break;
 						}
 					}
 				}
-			}
-			else if (cparam == "getlightswitchesscenes")
-			{
-				root["status"] = "OK";
-				root["title"] = "GetLightSwitchesScenes";
-				std::vector<std::vector<std::string> > result;
-				int ii = 0;
+			}//end light/switches
 
-				//First List/Switch Devices
-				result = m_sql.safe_query("SELECT ID, Name, Type, SubType, Used FROM DeviceStatus ORDER BY Name");
-				if (result.size() > 0)
+			//Add Scenes
+			result = m_sql.safe_query("SELECT ID, Name FROM Scenes ORDER BY Name");
+			if (result.size() > 0)
+			{
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
+					std::vector<std::string> sd = *itt;
 
-						std::string ID = sd[0];
-						std::string Name = sd[1];
-						int Type = atoi(sd[2].c_str());
-						int SubType = atoi(sd[3].c_str());
-						int used = atoi(sd[4].c_str());
-						if (used)
-						{
-							switch (Type)
-							{
-							case pTypeLighting1:
-							case pTypeLighting2:
-							case pTypeLighting3:
-							case pTypeLighting4:
-							case pTypeLighting5:
-							case pTypeLighting6:
-							case pTypeFan:
-							case pTypeLimitlessLights:
-							case pTypeSecurity1:
-							case pTypeSecurity2:
-							case pTypeEvohome:
-							case pTypeEvohomeRelay:
-							case pTypeCurtain:
-							case pTypeBlinds:
-							case pTypeRFY:
-							case pTypeChime:
-							case pTypeThermostat2:
-							case pTypeThermostat3:
-							case pTypeThermostat4:
-							case pTypeRemote:
-							case pTypeGeneralSwitch:
-							case pTypeHomeConfort:
-								root["result"][ii]["type"] = 0;
-								root["result"][ii]["idx"] = ID;
-								root["result"][ii]["Name"] = "[Light/Switch] " + Name;
-								ii++;
-								break;
-							case pTypeRadiator1:
-								if (SubType == sTypeSmartwaresSwitchRadiator)
-								{
-									root["result"][ii]["type"] = 0;
-									root["result"][ii]["idx"] = ID;
-									root["result"][ii]["Name"] = "[Light/Switch] " + Name;
-									ii++;
-								}
-								break;
-							}
-						}
-					}
-				}//end light/switches
+					std::string ID = sd[0];
+					std::string Name = sd[1];
 
-				//Add Scenes
-				result = m_sql.safe_query("SELECT ID, Name FROM Scenes ORDER BY Name");
-				if (result.size() > 0)
-				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
+					root["result"][ii]["type"] = 1;
+					root["result"][ii]["idx"] = ID;
+					root["result"][ii]["Name"] = "[Scene] " + Name;
+					ii++;
+				}
+			}//end light/switches
+		}
 
-						std::string ID = sd[0];
-						std::string Name = sd[1];
+		void CWebServer::HandleCommand(const std::string &cparam, WebEmSession & session, const request& req, Json::Value &root)
+		{
+			DispatchJSonRequest("command", cparam, session, req, root);
+		}
 
-						root["result"][ii]["type"] = 1;
-						root["result"][ii]["idx"] = ID;
-						root["result"][ii]["Name"] = "[Scene] " + Name;
-						ii++;
-					}
-				}//end light/switches
-			}
-			else if (cparam == "getcamactivedevices")
+		void CWebServer::Cmd_DeleteAllSubDevices(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteAllSubDevices";
+			result = m_sql.safe_query("DELETE FROM LightSubDevices WHERE (ParentID == '%q')", idx.c_str());
+		}
+
+		void CWebServer::Cmd_DeleteSubDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteSubDevice";
+			result = m_sql.safe_query("DELETE FROM LightSubDevices WHERE (ID == '%q')", idx.c_str());
+		}
+
+		void CWebServer::Cmd_AddSubDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			std::string subidx = request::findValue(&req, "subidx");
+			if (idx == subidx)
+				return;
+
+			//first check if it is not already a sub device
+			result = m_sql.safe_query("SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q') AND (ParentID =='%q')",
+				subidx.c_str(), idx.c_str());
+			if (result.size() == 0)
 			{
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
 				root["status"] = "OK";
-				root["title"] = "GetCameraActiveDevices";
-				std::vector<std::vector<std::string> > result;
-				//First List/Switch Devices
-				result = m_sql.safe_query("SELECT ID, DevSceneType, DevSceneRowID, DevSceneWhen, DevSceneDelay FROM CamerasActiveDevices WHERE (CameraRowID=='%q') ORDER BY ID",
-					idx.c_str());
-				if (result.size() > 0)
-				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					int ii = 0;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
+				root["title"] = "AddSubDevice";
+				//no it is not, add it
+				result = m_sql.safe_query(
+					"INSERT INTO LightSubDevices (DeviceRowID, ParentID) VALUES ('%q','%q')",
+					subidx.c_str(),
+					idx.c_str()
+					);
+			}
+		}
 
-						std::string ID = sd[0];
-						int DevSceneType = atoi(sd[1].c_str());
-						std::string DevSceneRowID = sd[2];
-						int DevSceneWhen = atoi(sd[3].c_str());
-						int DevSceneDelay = atoi(sd[4].c_str());
+		void CWebServer::Cmd_AddSceneDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-						std::string Name = "";
-						if (DevSceneType == 0)
-						{
-							std::vector<std::vector<std::string> > result2;
-							result2 = m_sql.safe_query("SELECT Name FROM DeviceStatus WHERE (ID=='%q')",
-								DevSceneRowID.c_str());
-							if (result2.size() > 0)
-							{
-								Name = "[Light/Switches] " + result2[0][0];
-							}
-						}
-						else
-						{
-							std::vector<std::vector<std::string> > result2;
-							result2 = m_sql.safe_query("SELECT Name FROM Scenes WHERE (ID=='%q')",
-								DevSceneRowID.c_str());
-							if (result2.size() > 0)
-							{
-								Name = "[Scene] " + result2[0][0];
-							}
-						}
-						if (Name != "")
-						{
-							root["result"][ii]["idx"] = ID;
-							root["result"][ii]["type"] = DevSceneType;
-							root["result"][ii]["DevSceneRowID"] = DevSceneRowID;
-							root["result"][ii]["when"] = DevSceneWhen;
-							root["result"][ii]["delay"] = DevSceneDelay;
-							root["result"][ii]["Name"] = Name;
-							ii++;
-						}
-					}
-				}
+			std::string idx = request::findValue(&req, "idx");
+			std::string devidx = request::findValue(&req, "devidx");
+			std::string isscene = request::findValue(&req, "isscene");
+			std::string scommand = request::findValue(&req, "command");
+			int ondelay = atoi(request::findValue(&req, "ondelay").c_str());
+			int offdelay = atoi(request::findValue(&req, "offdelay").c_str());
+
+			if (
+				(idx == "") ||
+				(devidx == "") ||
+				(isscene == "")
+				)
+				return;
+			int level = atoi(request::findValue(&req, "level").c_str());
+			int hue = atoi(request::findValue(&req, "hue").c_str());
+
+			unsigned char command=0;
+			result = m_sql.safe_query("SELECT HardwareID, DeviceID, Unit, Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID=='%q')",
+				devidx.c_str());
+			if (result.size() > 0)
+			{
+				int dType = atoi(result[0][3].c_str());
+				int sType = atoi(result[0][4].c_str());
+				_eSwitchType switchtype = (_eSwitchType)atoi(result[0][5].c_str());
+				std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(result[0][6].c_str());
+				GetLightCommand(dType, sType, switchtype, scommand, command, options);
 			}
-			else if (cparam == "addcamactivedevice")
+
+			//first check if this device is not the scene code!
+			result = m_sql.safe_query("SELECT Activators, SceneType FROM Scenes WHERE (ID=='%q')", idx.c_str());
+			if (result.size() > 0)
 			{
-				if (session.rights < 2)
+				int SceneType = atoi(result[0][1].c_str());
+
+				std::vector<std::string> arrayActivators;
+				StringSplit(result[0][0], ";", arrayActivators);
+				std::vector<std::string>::const_iterator ittAct;
+				for (ittAct = arrayActivators.begin(); ittAct != arrayActivators.end(); ++ittAct)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+					std::string sCodeCmd = *ittAct;
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string activeidx = request::findValue(&req, "activeidx");
-				std::string sactivetype = request::findValue(&req, "activetype");
-				std::string sactivewhen = request::findValue(&req, "activewhen");
-				std::string sactivedelay = request::findValue(&req, "activedelay");
+					std::vector<std::string> arrayCode;
+					StringSplit(sCodeCmd, ":", arrayCode);
 
-				if (
-					(idx == "") ||
-					(activeidx == "") ||
-					(sactivetype == "") ||
-					(sactivewhen == "") ||
-					(sactivedelay == "")
-					)
+					std::string sID = arrayCode[0];
+					std::string sCode = "";
+					if (arrayCode.size() == 2)
+					{
+						sCode = arrayCode[1];
+					}
+
+					if (sID == devidx)
+					{
+						return; //Group does not work with separate codes, so already there
+					}
+				}
+			}
+			//first check if it is not already a part of this scene/group (with the same OnDelay)
+			if (isscene == "true") {
+				result = m_sql.safe_query("SELECT ID FROM SceneDevices WHERE (DeviceRowID=='%q') AND (SceneRowID =='%q') AND (OnDelay == %d) AND (OffDelay == %d) AND (Cmd == %d)",
+					devidx.c_str(), idx.c_str(), ondelay, offdelay, command);
+			}
+			else {
+				result = m_sql.safe_query("SELECT ID FROM SceneDevices WHERE (DeviceRowID=='%q') AND (SceneRowID =='%q') AND (OnDelay == %d)",
+					devidx.c_str(), idx.c_str(), ondelay);
+			}
+			if (result.size() == 0)
+			{
+				root["status"] = "OK";
+				root["title"] = "AddSceneDevice";
+				//no it is not, add it
+				if (isscene == "true")
 				{
-					return;
+					m_sql.safe_query(
+						"INSERT INTO SceneDevices (DeviceRowID, SceneRowID, Cmd, Level, Hue, OnDelay, OffDelay) VALUES ('%q','%q',%d,%d,%d,%d,%d)",
+						devidx.c_str(),
+						idx.c_str(),
+						command,
+						level,
+						hue,
+						ondelay,
+						offdelay
+						);
 				}
-
-				int activetype = atoi(sactivetype.c_str());
-				int activewhen = atoi(sactivewhen.c_str());
-				int activedelay = atoi(sactivedelay.c_str());
-
-				//first check if it is not already a Active Device
-				result = m_sql.safe_query(
-					"SELECT ID FROM CamerasActiveDevices WHERE (CameraRowID=='%q')"
-					" AND (DevSceneType==%d) AND (DevSceneRowID=='%q')"
-					" AND (DevSceneWhen==%d)",
-					idx.c_str(), activetype, activeidx.c_str(), activewhen);
-				if (result.size() == 0)
+				else
 				{
-					root["status"] = "OK";
-					root["title"] = "AddCameraActiveDevice";
-					//no it is not, add it
-					result = m_sql.safe_query(
-						"INSERT INTO CamerasActiveDevices (CameraRowID, DevSceneType, DevSceneRowID, DevSceneWhen, DevSceneDelay) VALUES ('%q',%d,'%q',%d,%d)",
+					m_sql.safe_query(
+						"INSERT INTO SceneDevices (DeviceRowID, SceneRowID, Level, Hue, OnDelay, OffDelay) VALUES ('%q','%q',%d,%d,%d,%d)",
+						devidx.c_str(),
 						idx.c_str(),
-						activetype,
-						activeidx.c_str(),
-						activewhen,
-						activedelay
+						level,
+						hue,
+						ondelay,
+						offdelay
 						);
-					m_mainworker.m_cameras.ReloadCameras();
 				}
 			}
-			else if (cparam == "deleteamactivedevice")
+		}
+
+		void CWebServer::Cmd_UpdateSceneDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			std::string devidx = request::findValue(&req, "devidx");
+			std::string scommand = request::findValue(&req, "command");
+			int ondelay = atoi(request::findValue(&req, "ondelay").c_str());
+			int offdelay = atoi(request::findValue(&req, "offdelay").c_str());
+
+			if (
+				(idx == "") ||
+				(devidx == "")
+				)
+				return;
+
+			unsigned char command = 0;
+
+			result = m_sql.safe_query("SELECT HardwareID, DeviceID, Unit, Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID=='%q')",
+				devidx.c_str());
+			if (result.size() > 0)
+			{
+				int dType = atoi(result[0][3].c_str());
+				int sType = atoi(result[0][4].c_str());
+				_eSwitchType switchtype = (_eSwitchType)atoi(result[0][5].c_str());
+				std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(result[0][6].c_str());
+				GetLightCommand(dType, sType, switchtype, scommand, command, options);
+			}
+			int level = atoi(request::findValue(&req, "level").c_str());
+			int hue = atoi(request::findValue(&req, "hue").c_str());
+			root["status"] = "OK";
+			root["title"] = "UpdateSceneDevice";
+			result = m_sql.safe_query(
+				"UPDATE SceneDevices SET Cmd=%d, Level=%d, Hue=%d, OnDelay=%d, OffDelay=%d  WHERE (ID == '%q')",
+				command, level, hue, ondelay, offdelay, idx.c_str());
+		}
+
+		void CWebServer::Cmd_DeleteSceneDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteSceneDevice";
+			m_sql.safe_query("DELETE FROM SceneDevices WHERE (ID == '%q')", idx.c_str());
+			m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (DevSceneType==1) AND (DevSceneRowID == '%q')", idx.c_str());
+		}
+
+		void CWebServer::Cmd_GetSubDevices(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+
+			root["status"] = "OK";
+			root["title"] = "GetSubDevices";
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT a.ID, b.Name FROM LightSubDevices a, DeviceStatus b WHERE (a.ParentID=='%q') AND (b.ID == a.DeviceRowID)",
+				idx.c_str());
+			if (result.size() > 0)
 			{
-				if (session.rights < 2)
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				int ii = 0;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+					std::vector<std::string> sd = *itt;
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteCameraActiveDevice";
-				result = m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (ID == '%q')", idx.c_str());
-				m_mainworker.m_cameras.ReloadCameras();
+					root["result"][ii]["ID"] = sd[0];
+					root["result"][ii]["Name"] = sd[1];
+					ii++;
+				}
 			}
-			else if (cparam == "deleteallactivecamdevices")
+		}
+
+		void CWebServer::Cmd_GetSceneDevices(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string isscene = request::findValue(&req, "isscene");
+
+			root["status"] = "OK";
+			root["title"] = "GetSceneDevices";
+
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT a.ID, b.Name, a.DeviceRowID, b.Type, b.SubType, b.nValue, b.sValue, a.Cmd, a.Level, b.ID, a.[Order], a.Hue, a.OnDelay, a.OffDelay, b.SwitchType FROM SceneDevices a, DeviceStatus b WHERE (a.SceneRowID=='%q') AND (b.ID == a.DeviceRowID) ORDER BY a.[Order]",
+				idx.c_str());
+			if (result.size() > 0)
 			{
-				if (session.rights < 2)
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				int ii = 0;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
+					std::vector<std::string> sd = *itt;
+
+					root["result"][ii]["ID"] = sd[0];
+					root["result"][ii]["Name"] = sd[1];
+					root["result"][ii]["DevID"] = sd[2];
+					root["result"][ii]["DevRealIdx"] = sd[9];
+					root["result"][ii]["Order"] = atoi(sd[10].c_str());
+					root["result"][ii]["OnDelay"] = atoi(sd[12].c_str());
+					root["result"][ii]["OffDelay"] = atoi(sd[13].c_str());
+
+					_eSwitchType switchtype=(_eSwitchType)atoi(sd[14].c_str());
+
+					unsigned char devType = atoi(sd[3].c_str());
+
+					//switchtype seemed not to be used down with the GetLightStatus command,
+					//causing RFY to go wrong, fixing here
+					if (devType != pTypeRFY)
+						switchtype = STYPE_OnOff;
+
+					unsigned char subType = atoi(sd[4].c_str());
+					unsigned char nValue = (unsigned char)atoi(sd[5].c_str());
+					std::string sValue = sd[6];
+					int command = atoi(sd[7].c_str());
+					int level = atoi(sd[8].c_str());
+
+					std::string lstatus = "";
+					int llevel = 0;
+					bool bHaveDimmer = false;
+					bool bHaveGroupCmd = false;
+					int maxDimLevel = 0;
+					GetLightStatus(devType, subType, switchtype, command, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+					root["result"][ii]["Command"] = lstatus;
+					root["result"][ii]["Level"] = level;
+					root["result"][ii]["Hue"] = atoi(sd[11].c_str());
+					root["result"][ii]["Type"] = RFX_Type_Desc(devType, 1);
+					root["result"][ii]["SubType"] = RFX_Type_SubType_Desc(devType, subType);
+					ii++;
 				}
+			}
+		}
+
+		void CWebServer::Cmd_ChangeSceneDeviceOrder(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string sway = request::findValue(&req, "way");
+			if (sway == "")
+				return;
+			bool bGoUp = (sway == "0");
+
+			std::string aScene, aOrder, oID, oOrder;
+
+			//Get actual device order
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT SceneRowID, [Order] FROM SceneDevices WHERE (ID=='%q')",
+				idx.c_str());
+			if (result.size() < 1)
+				return;
+			aScene = result[0][0];
+			aOrder = result[0][1];
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
+			if (!bGoUp)
+			{
+				//Get next device order
+				result = m_sql.safe_query("SELECT ID, [Order] FROM SceneDevices WHERE (SceneRowID=='%q' AND [Order]>'%q') ORDER BY [Order] ASC",
+					aScene.c_str(), aOrder.c_str());
+				if (result.size() < 1)
 					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteAllCameraActiveDevices";
-				result = m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (CameraRowID == '%q')", idx.c_str());
-				m_mainworker.m_cameras.ReloadCameras();
+				oID = result[0][0];
+				oOrder = result[0][1];
 			}
-			else if (cparam == "testnotification")
+			else
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+				//Get previous device order
+				result = m_sql.safe_query("SELECT ID, [Order] FROM SceneDevices WHERE (SceneRowID=='%q' AND [Order]<'%q') ORDER BY [Order] DESC",
+					aScene.c_str(), aOrder.c_str());
+				if (result.size() < 1)
+					return;
+				oID = result[0][0];
+				oOrder = result[0][1];
+			}
+			//Swap them
+			root["status"] = "OK";
+			root["title"] = "ChangeSceneDeviceOrder";
 
-				std::string notification_Title = "Domoticz test";
-				std::string notification_Message = "Domoticz test message!";
-				std::string subsystem = request::findValue(&req, "subsystem");
+			result = m_sql.safe_query("UPDATE SceneDevices SET [Order] = '%q' WHERE (ID='%q')",
+				oOrder.c_str(), idx.c_str());
+			result = m_sql.safe_query("UPDATE SceneDevices SET [Order] = '%q' WHERE (ID='%q')",
+				aOrder.c_str(), oID.c_str());
+		}
 
-				m_notifications.ConfigFromGetvars(req, false);
-				if (m_notifications.SendMessage(0, std::string(""), subsystem, notification_Title, notification_Message, std::string(""), 1, std::string(""), false)) {
-					root["status"] = "OK";
-				}
-				/* we need to reload the config, because the values that were set were only for testing */
-				m_notifications.LoadConfig();
-			}
-			else if (cparam == "testswitch")
+		void CWebServer::Cmd_DeleteAllSceneDevices(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteAllSceneDevices";
+			result = m_sql.safe_query("DELETE FROM SceneDevices WHERE (SceneRowID == %q)", idx.c_str());
+		}
+
+		void CWebServer::Cmd_GetManualHardware(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			//used by Add Manual Light/Switch dialog
+			root["status"] = "OK";
+			root["title"] = "GetHardware";
+			result = m_sql.safe_query("SELECT ID, Name, Type FROM Hardware ORDER BY ID ASC");
+			if (result.size() > 0)
 			{
-				if (session.rights < 2)
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				int ii = 0;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+					std::vector<std::string> sd = *itt;
 
-				std::string hwdid = request::findValue(&req, "hwdid");
-				std::string sswitchtype = request::findValue(&req, "switchtype");
-				std::string slighttype = request::findValue(&req, "lighttype");
-				if (
-					(hwdid == "") ||
-					(sswitchtype == "") ||
-					(slighttype == "")
-					)
-					return;
-				_eSwitchType switchtype = (_eSwitchType)atoi(sswitchtype.c_str());
-				int lighttype = atoi(slighttype.c_str());
-				int dtype;
-				int subtype = 0;
-				std::string sunitcode;
-				std::string devid;
-
-				if (lighttype == 70)
-				{
-					//EnOcean (Lighting2 with Base_ID offset)
-					dtype = pTypeLighting2;
-					subtype = sTypeAC;
-					std::string sgroupcode = request::findValue(&req, "groupcode");
-					sunitcode = request::findValue(&req, "unitcode");
-					int iUnitTest = atoi(sunitcode.c_str());	//only First Rocker_ID at the moment, gives us 128 devices we can control, should be enough!
-					if (
-						(sunitcode == "") ||
-						(sgroupcode == "") ||
-						((iUnitTest < 1) || (iUnitTest>128))
-						)
-						return;
-					sunitcode = sgroupcode;//Button A or B
-					CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hwdid.c_str())));
-					if (pBaseHardware == NULL)
-						return;
-					if ((pBaseHardware->HwdType != HTYPE_EnOceanESP2) && (pBaseHardware->HwdType != HTYPE_EnOceanESP3))
-						return;
-					unsigned long rID = 0;
-					if (pBaseHardware->HwdType == HTYPE_EnOceanESP2)
-					{
-						CEnOceanESP2 *pEnoceanHardware = reinterpret_cast<CEnOceanESP2 *>(pBaseHardware);
-						rID = pEnoceanHardware->m_id_base + iUnitTest;
-					}
-					else
+					int ID = atoi(sd[0].c_str());
+					std::string Name = sd[1];
+					_eHardwareTypes Type = (_eHardwareTypes)atoi(sd[2].c_str());
+					switch (Type)
 					{
-						CEnOceanESP3 *pEnoceanHardware = reinterpret_cast<CEnOceanESP3 *>(pBaseHardware);
-						rID = pEnoceanHardware->m_id_base + iUnitTest;
+					case HTYPE_RFXLAN:
+					case HTYPE_RFXtrx315:
+					case HTYPE_RFXtrx433:
+					case HTYPE_RFXtrx868:
+					case HTYPE_EnOceanESP2:
+					case HTYPE_EnOceanESP3:
+					case HTYPE_Dummy:
+					case HTYPE_Tellstick:
+					case HTYPE_EVOHOME_SCRIPT:
+					case HTYPE_EVOHOME_SERIAL:
+					case HTYPE_RaspberryGPIO:
+					case HTYPE_RFLINKUSB:
+					case HTYPE_RFLINKTCP:
+					case HTYPE_ZIBLUEUSB:
+					case HTYPE_ZIBLUETCP:
+					case HTYPE_OpenWebNetTCP:
+					case HTYPE_OpenWebNetUSB:
+						root["result"][ii]["idx"] = ID;
+						root["result"][ii]["Name"] = Name;
+						ii++;
+						break;
 					}
-					//convert to hex, and we have our ID
-					std::stringstream s_strid;
-					s_strid << std::hex << std::uppercase << rID;
-					devid = s_strid.str();
 				}
-				else if (lighttype == 68)
-				{
+			}
+		}
+
+		void CWebServer::Cmd_GetGpio(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			//used by Add Manual Light/Switch dialog
+			root["title"] = "GetGpio";
 #ifdef WITH_GPIO
-					dtype = pTypeLighting1;
-					subtype = sTypeIMPULS;
-					devid = "0";
-					sunitcode = request::findValue(&req, "unitcode"); //Unit code = GPIO number
-
-					if (sunitcode == "") {
-						root["status"] = "ERROR";
-						root["message"] = "No GPIO number given";
-						return;
-					}
-					CGpio *pGpio = (CGpio *)m_mainworker.GetHardware(atoi(hwdid.c_str()));
-					if (pGpio == NULL) {
-						root["status"] = "ERROR";
-						root["message"] = "Could not retrieve GPIO hardware pointer";
-						return;
-					}
-					if (pGpio->HwdType != HTYPE_RaspberryGPIO) {
-						root["status"] = "ERROR";
-						root["message"] = "Given hardware is not GPIO";
-						return;
-					}
-					CGpioPin *pPin = CGpio::GetPPinById(atoi(sunitcode.c_str()));
-					if (pPin == NULL) {
-						root["status"] = "ERROR";
-						root["message"] = "Given pin does not exist on this GPIO hardware";
-						return;
-					}
-					if (!pPin->GetIsExported()) {
-						root["status"] = "ERROR";
-						root["message"] = "Given pin is not exported";
-						return;
-					}
-					if (!pPin->GetIsOutput()) {
-						root["status"] = "ERROR";
-						root["message"] = "Given pin is not configured for output";
-						return;
-					}
+			std::vector<CGpioPin> pins = CGpio::GetPinList();
+			if (pins.size() == 0) {
+				root["status"] = "ERROR";
+				root["result"][0]["idx"] = 0;
+				root["result"][0]["Name"] = "GPIO INIT ERROR";
+			}
+			else {
+				int ii = 0;
+				for (std::vector<CGpioPin>::iterator it = pins.begin(); it != pins.end(); ++it) {
+					CGpioPin pin = *it;
+					root["status"] = "OK";
+					root["result"][ii]["idx"] = pin.GetId();
+					root["result"][ii]["Name"] = pin.ToString();
+					ii++;
+				}
+			}
 #else
-					root["status"] = "ERROR";
-					root["message"] = "GPIO support is disabled";
-					return;
+			root["status"] = "OK";
+			root["result"][0]["idx"] = 0;
+			root["result"][0]["Name"] = "N/A";
 #endif
-				}
-				else if (lighttype < 20)
-				{
-					dtype = pTypeLighting1;
-					subtype = lighttype;
-					std::string shousecode = request::findValue(&req, "housecode");
-					sunitcode = request::findValue(&req, "unitcode");
-					if (
-						(shousecode == "") ||
-						(sunitcode == "")
-						)
-						return;
-					devid = shousecode;
-				}
-				else if (lighttype < 30)
-				{
-					dtype = pTypeLighting2;
-					subtype = lighttype - 20;
-					std::string id = request::findValue(&req, "id");
-					sunitcode = request::findValue(&req, "unitcode");
-					if (
-						(id == "") ||
-						(sunitcode == "")
-						)
-						return;
-					devid = id;
-				}
-				else if (lighttype < 70)
-				{
-					dtype = pTypeLighting5;
-					subtype = lighttype - 50;
-					if (lighttype == 59)
-						subtype = sTypeIT;
-					std::string id = request::findValue(&req, "id");
-					sunitcode = request::findValue(&req, "unitcode");
-					if (
-						(id == "") ||
-						(sunitcode == "")
-						)
-						return;
-					if ((subtype != sTypeEMW100) && (subtype != sTypeLivolo) && (subtype != sTypeLivoloAppliance) && (subtype != sTypeRGB432W) && (subtype != sTypeIT))
-						devid = "00" + id;
-					else
-						devid = id;
-				}
-				else
+		}
+
+		void CWebServer::Cmd_GetCamActiveDevices(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "GetCameraActiveDevices";
+			std::vector<std::vector<std::string> > result;
+			//First List/Switch Devices
+			result = m_sql.safe_query("SELECT ID, DevSceneType, DevSceneRowID, DevSceneWhen, DevSceneDelay FROM CamerasActiveDevices WHERE (CameraRowID=='%q') ORDER BY ID",
+				idx.c_str());
+			if (result.size() > 0)
+			{
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				int ii = 0;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					if (lighttype == 100)
+					std::vector<std::string> sd = *itt;
+
+					std::string ID = sd[0];
+					int DevSceneType = atoi(sd[1].c_str());
+					std::string DevSceneRowID = sd[2];
+					int DevSceneWhen = atoi(sd[3].c_str());
+					int DevSceneDelay = atoi(sd[4].c_str());
+
+					std::string Name = "";
+					if (DevSceneType == 0)
 					{
-						//Chime/ByronSX
-						dtype = pTypeChime;
-						subtype = sTypeByronSX;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						int iUnitCode = atoi(sunitcode.c_str()) - 1;
-						switch (iUnitCode)
+						std::vector<std::vector<std::string> > result2;
+						result2 = m_sql.safe_query("SELECT Name FROM DeviceStatus WHERE (ID=='%q')",
+							DevSceneRowID.c_str());
+						if (result2.size() > 0)
 						{
-						case 0:
-							iUnitCode = chime_sound0;
-							break;
-						case 1:
-							iUnitCode = chime_sound1;
-							break;
-						case 2:
-							iUnitCode = chime_sound2;
-							break;
-						case 3:
-							iUnitCode = chime_sound3;
-							break;
-						case 4:
-							iUnitCode = chime_sound4;
-							break;
-						case 5:
-							iUnitCode = chime_sound5;
-							break;
-						case 6:
-							iUnitCode = chime_sound6;
-							break;
-						case 7:
-							iUnitCode = chime_sound7;
-							break;
+							Name = "[Light/Switches] " + result2[0][0];
 						}
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						devid = id;
 					}
-					else if (lighttype == 101)
-					{
-						//Curtain Harrison
-						dtype = pTypeCurtain;
-						subtype = sTypeHarrison;
-						std::string shousecode = request::findValue(&req, "housecode");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(shousecode == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = shousecode;
-					}
-					else if (lighttype == 102)
-					{
-						//RFY
-						dtype = pTypeRFY;
-						subtype = sTypeRFY;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = id;
-					}
-					else if (lighttype == 103)
-					{
-						//Meiantech
-						dtype = pTypeSecurity1;
-						subtype = sTypeMeiantech;
-						std::string id = request::findValue(&req, "id");
-						if (
-							(id == "")
-							)
-							return;
-						devid = id;
-						sunitcode = "0";
-					}
-					else if (lighttype == 104)
-					{
-						//HE105
-						dtype = pTypeThermostat2;
-						subtype = sTypeHE105;
-						sunitcode = request::findValue(&req, "unitcode");
-						if (sunitcode == "")
-							return;
-						//convert to hex, and we have our Unit Code
-						std::stringstream s_strid;
-						s_strid << std::hex << std::uppercase << sunitcode;
-						int iUnitCode;
-						s_strid >> iUnitCode;
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						devid = "1";
-					}
-					else if (lighttype == 105)
-					{
-						//ASA
-						dtype = pTypeRFY;
-						subtype = sTypeASA;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = id;
-					}
-					else if (lighttype == 106)
-					{
-						//Blyss
-						dtype = pTypeLighting6;
-						subtype = lighttype - 60;
-						std::string sgroupcode = request::findValue(&req, "groupcode");
-						sunitcode = request::findValue(&req, "unitcode");
-						std::string id = request::findValue(&req, "id");
-						if (
-							(sgroupcode == "") ||
-							(sunitcode == "") ||
-							(id == "")
-							)
-							return;
-						devid = id + sgroupcode;
-					}
-					else if (lighttype == 107)
-					{
-						//RFY2
-						dtype = pTypeRFY;
-						subtype = sTypeRFY2;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = id;
-					}
-					else if ((lighttype >= 200) && (lighttype < 300))
-					{
-						dtype = pTypeBlinds;
-						subtype = lighttype-200;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						int iUnitCode = atoi(sunitcode.c_str());
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						devid = id;
-					}
-					else if (lighttype == 301)
-					{
-						//Smartwares Radiator
-						dtype = pTypeRadiator1;
-						subtype = sTypeSmartwaresSwitchRadiator;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = id;
-					}
-					else if (lighttype == 302)
-					{
-						//Home Confort
-						dtype = pTypeHomeConfort;
-						subtype = sTypeHomeConfortTEL010;
-						std::string id = request::findValue(&req, "id");
-
-						std::string shousecode = request::findValue(&req, "housecode");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id.empty()) ||
-							(shousecode.empty()) ||
-							(sunitcode.empty())
-							)
-							return;
-
-						int iUnitCode = atoi(sunitcode.c_str());
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						sprintf(szTmp, "%02X", atoi(shousecode.c_str()));
-						shousecode = szTmp;
-						devid = id + shousecode;
-					}
-					else if (lighttype == 303)
-					{
-						//Selector Switch
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchTypeSelector;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = id;
-					}
-					else if (lighttype == 304)
-					{
-						//Itho CVE RFT
-						dtype = pTypeFan;
-						subtype = sTypeItho;
-						std::string id = request::findValue(&req, "id");
-						if (id.empty())
-							return;
-						devid = id;
-						sunitcode = "0";
-					}
-					else if (lighttype == 305)
+					else
 					{
-						//Lucci Air
-						dtype = pTypeFan;
-						subtype = sTypeLucciAir;
-						std::string id = request::findValue(&req, "id");
-						if (id.empty())
-							return;
-						devid = id;
-						sunitcode = "0";
-					}
-					else if (lighttype == 400) {
-						//Openwebnet Bus Blinds
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchBlindsT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 401) {
-						//Openwebnet Bus Lights
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchLightT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
+						std::vector<std::vector<std::string> > result2;
+						result2 = m_sql.safe_query("SELECT Name FROM Scenes WHERE (ID=='%q')",
+							DevSceneRowID.c_str());
+						if (result2.size() > 0)
+						{
+							Name = "[Scene] " + result2[0][0];
+						}
 					}
-					else if (lighttype == 402)
+					if (Name != "")
 					{
-						//Openwebnet Bus Auxiliary
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchAuxiliaryT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 403) {
-						//Openwebnet Zigbee Blinds
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchBlindsT2;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 404) {
-						//Light Openwebnet Zigbee
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchLightT2;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if ((lighttype == 405) || (lighttype == 406)) {
-						// Openwebnet Dry Contact / IR Detection
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchContactT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-				}
-       // ----------- If needed convert to GeneralSwitch type (for o.a. RFlink) -----------
-				CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hwdid.c_str())));
-				if (pBaseHardware != NULL)
-				{
-					if ((pBaseHardware->HwdType == HTYPE_RFLINKUSB) || (pBaseHardware->HwdType == HTYPE_RFLINKTCP)) {
-						ConvertToGeneralSwitchType(devid, dtype, subtype);
+						root["result"][ii]["idx"] = ID;
+						root["result"][ii]["type"] = DevSceneType;
+						root["result"][ii]["DevSceneRowID"] = DevSceneRowID;
+						root["result"][ii]["when"] = DevSceneWhen;
+						root["result"][ii]["delay"] = DevSceneDelay;
+						root["result"][ii]["Name"] = Name;
+						ii++;
 					}
 				}
-        // -----------------------------------------------
+			}
+		}
+
+		void CWebServer::Cmd_AddCamActiveDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			std::string activeidx = request::findValue(&req, "activeidx");
+			std::string sactivetype = request::findValue(&req, "activetype");
+			std::string sactivewhen = request::findValue(&req, "activewhen");
+			std::string sactivedelay = request::findValue(&req, "activedelay");
+
+			int activetype = atoi(sactivetype.c_str());
+			int activewhen = atoi(sactivewhen.c_str());
+			int activedelay = atoi(sactivedelay.c_str());
 
+			//first check if it is not already a Active Device
+			result = m_sql.safe_query(
+				"SELECT ID FROM CamerasActiveDevices WHERE (CameraRowID=='%q')"
+				" AND (DevSceneType==%d) AND (DevSceneRowID=='%q')"
+				" AND (DevSceneWhen==%d)",
+				idx.c_str(), activetype, activeidx.c_str(), activewhen);
+			if (result.size() == 0)
+			{
 				root["status"] = "OK";
-				root["message"] = "OK";
-				root["title"] = "TestSwitch";
-				std::vector<std::string> sd;
-
-				sd.push_back(hwdid);
-				sd.push_back(devid);
-				sd.push_back(sunitcode);
-				sprintf(szTmp, "%d", dtype);
-				sd.push_back(szTmp);
-				sprintf(szTmp, "%d", subtype);
-				sd.push_back(szTmp);
-				sprintf(szTmp, "%d", switchtype);
-				sd.push_back(szTmp);
-				sd.push_back(""); //AddjValue2
-				sd.push_back(""); //nValue
-				sd.push_back(""); //sValue
-				sd.push_back(""); //Name
-				sd.push_back(""); //Options
-
-				std::string switchcmd = "On";
-				int level = 0;
-				if (lighttype == 70)
-				{
-					//Special EnOcean case, if it is a dimmer, set a dim value
-					if (switchtype == STYPE_Dimmer)
-						level = 5;
-				}
-				m_mainworker.SwitchLightInt(sd, switchcmd, level, -1, true);
+				root["title"] = "AddCameraActiveDevice";
+				//no it is not, add it
+				result = m_sql.safe_query(
+					"INSERT INTO CamerasActiveDevices (CameraRowID, DevSceneType, DevSceneRowID, DevSceneWhen, DevSceneDelay) VALUES ('%q',%d,'%q',%d,%d)",
+					idx.c_str(),
+					activetype,
+					activeidx.c_str(),
+					activewhen,
+					activedelay
+					);
+				m_mainworker.m_cameras.ReloadCameras();
 			}
-			else if (cparam == "addswitch")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		}
+
+		void CWebServer::Cmd_DeleteCamActiveDevice(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteCameraActiveDevice";
+			result = m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (ID == '%q')", idx.c_str());
+			m_mainworker.m_cameras.ReloadCameras();
+		}
+
+		void CWebServer::Cmd_DeleteAllCamActiveDevices(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
+
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteAllCameraActiveDevices";
+			result = m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (CameraRowID == '%q')", idx.c_str());
+			m_mainworker.m_cameras.ReloadCameras();
+		}
+
+		void CWebServer::Cmd_TestNotification(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string notification_Title = "Domoticz test";
+			std::string notification_Message = "Domoticz test message!";
+			std::string subsystem = request::findValue(&req, "subsystem");
+
+			m_notifications.ConfigFromGetvars(req, false);
+			if (m_notifications.SendMessage(0, std::string(""), subsystem, notification_Title, notification_Message, std::string(""), 1, std::string(""), false)) {
+				root["status"] = "OK";
+			}
+			/* we need to reload the config, because the values that were set were only for testing */
+			m_notifications.LoadConfig();
+		}
 
-				std::string hwdid = request::findValue(&req, "hwdid");
-				std::string name = request::findValue(&req, "name");
-				std::string sswitchtype = request::findValue(&req, "switchtype");
-				std::string slighttype = request::findValue(&req, "lighttype");
-				std::string maindeviceidx = request::findValue(&req, "maindeviceidx");
-				std::string deviceoptions;
+		void CWebServer::Cmd_TestSwitch(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			char szTmp[300];
 
+			std::string hwdid = request::findValue(&req, "hwdid");
+			std::string sswitchtype = request::findValue(&req, "switchtype");
+			std::string slighttype = request::findValue(&req, "lighttype");
+			_eSwitchType switchtype = (_eSwitchType)atoi(sswitchtype.c_str());
+			int lighttype = atoi(slighttype.c_str());
+			int dtype;
+			int subtype = 0;
+			std::string sunitcode;
+			std::string devid;
+
+			if (lighttype == 70)
+			{
+				//EnOcean (Lighting2 with Base_ID offset)
+				dtype = pTypeLighting2;
+				subtype = sTypeAC;
+				std::string sgroupcode = request::findValue(&req, "groupcode");
+				sunitcode = request::findValue(&req, "unitcode");
+				int iUnitTest = atoi(sunitcode.c_str());	//only First Rocker_ID at the moment, gives us 128 devices we can control, should be enough!
 				if (
-					(hwdid == "") ||
-					(sswitchtype == "") ||
-					(slighttype == "") ||
-					(name == "")
+					(sunitcode == "") ||
+					(sgroupcode == "") ||
+					((iUnitTest < 1) || (iUnitTest>128))
 					)
 					return;
-				_eSwitchType switchtype = (_eSwitchType)atoi(sswitchtype.c_str());
-				int lighttype = atoi(slighttype.c_str());
-				int dtype = 0;
-				int subtype = 0;
-				std::string sunitcode;
-				std::string devid;
-
-				if (lighttype == 70)
+				sunitcode = sgroupcode;//Button A or B
+				CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hwdid.c_str())));
+				if (pBaseHardware == NULL)
+					return;
+				if ((pBaseHardware->HwdType != HTYPE_EnOceanESP2) && (pBaseHardware->HwdType != HTYPE_EnOceanESP3))
+					return;
+				unsigned long rID = 0;
+				if (pBaseHardware->HwdType == HTYPE_EnOceanESP2)
 				{
-					//EnOcean (Lighting2 with Base_ID offset)
-					dtype = pTypeLighting2;
-					subtype = sTypeAC;
-					sunitcode = request::findValue(&req, "unitcode");
-					std::string sgroupcode = request::findValue(&req, "groupcode");
-					int iUnitTest = atoi(sunitcode.c_str());	//gives us 128 devices we can control, should be enough!
-					if (
-						(sunitcode == "") ||
-						(sgroupcode == "") ||
-						((iUnitTest < 1) || (iUnitTest>128))
-						)
-						return;
-					sunitcode = sgroupcode;//Button A/B
-					CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hwdid.c_str())));
-					if (pBaseHardware == NULL)
-						return;
-					if ((pBaseHardware->HwdType != HTYPE_EnOceanESP2) && (pBaseHardware->HwdType != HTYPE_EnOceanESP3))
-						return;
-					unsigned long rID = 0;
-					if (pBaseHardware->HwdType == HTYPE_EnOceanESP2)
-					{
-						CEnOceanESP2 *pEnoceanHardware = reinterpret_cast<CEnOceanESP2*>(pBaseHardware);
-						if (pEnoceanHardware->m_id_base == 0)
-						{
-							root["message"] = "BaseID not found, is the hardware running?";
-							return;
-						}
-						rID = pEnoceanHardware->m_id_base + iUnitTest;
-					}
-					else
-					{
-						CEnOceanESP3 *pEnoceanHardware = reinterpret_cast<CEnOceanESP3*>(pBaseHardware);
-						if (pEnoceanHardware->m_id_base == 0)
-						{
-							root["message"] = "BaseID not found, is the hardware running?";
-							return;
-						}
-						rID = pEnoceanHardware->m_id_base + iUnitTest;
-					}
-					//convert to hex, and we have our ID
-					std::stringstream s_strid;
-					s_strid << std::hex << std::uppercase << rID;
-					devid = s_strid.str();
+					CEnOceanESP2 *pEnoceanHardware = reinterpret_cast<CEnOceanESP2 *>(pBaseHardware);
+					rID = pEnoceanHardware->m_id_base + iUnitTest;
 				}
-				else if (lighttype == 68)
+				else
 				{
+					CEnOceanESP3 *pEnoceanHardware = reinterpret_cast<CEnOceanESP3 *>(pBaseHardware);
+					rID = pEnoceanHardware->m_id_base + iUnitTest;
+				}
+				//convert to hex, and we have our ID
+				std::stringstream s_strid;
+				s_strid << std::hex << std::uppercase << rID;
+				devid = s_strid.str();
+			}
+			else if (lighttype == 68)
+			{
 #ifdef WITH_GPIO
-					dtype = pTypeLighting1;
-					subtype = sTypeIMPULS;
-					devid = "0";
-					sunitcode = request::findValue(&req, "unitcode"); //Unit code = GPIO number
+				dtype = pTypeLighting1;
+				subtype = sTypeIMPULS;
+				devid = "0";
+				sunitcode = request::findValue(&req, "unitcode"); //Unit code = GPIO number
 
-					if (sunitcode == "") {
-						return;
-					}
-					CGpio *pGpio = (CGpio *)m_mainworker.GetHardware(atoi(hwdid.c_str()));
-					if (pGpio == NULL) {
-						return;
-					}
-					if (pGpio->HwdType != HTYPE_RaspberryGPIO) {
-						return;
-					}
-					CGpioPin *pPin = CGpio::GetPPinById(atoi(sunitcode.c_str()));
-					if (pPin == NULL) {
-						return;
-					}
-					if (!pPin->GetIsExported()) {
-						return;
-					}
-#else
+				if (sunitcode == "") {
+					root["status"] = "ERROR";
+					root["message"] = "No GPIO number given";
 					return;
-#endif
 				}
-				else if (lighttype < 20)
-				{
-					dtype = pTypeLighting1;
-					subtype = lighttype;
-					std::string shousecode = request::findValue(&req, "housecode");
-					sunitcode = request::findValue(&req, "unitcode");
-					if (
-						(shousecode == "") ||
-						(sunitcode == "")
-						)
-						return;
-					devid = shousecode;
+				CGpio *pGpio = (CGpio *)m_mainworker.GetHardware(atoi(hwdid.c_str()));
+				if (pGpio == NULL) {
+					root["status"] = "ERROR";
+					root["message"] = "Could not retrieve GPIO hardware pointer";
+					return;
 				}
-				else if (lighttype < 30)
-				{
-					dtype = pTypeLighting2;
-					subtype = lighttype - 20;
-					std::string id = request::findValue(&req, "id");
-					sunitcode = request::findValue(&req, "unitcode");
-					if (
-						(id == "") ||
-						(sunitcode == "")
-						)
-						return;
-					devid = id;
+				if (pGpio->HwdType != HTYPE_RaspberryGPIO) {
+					root["status"] = "ERROR";
+					root["message"] = "Given hardware is not GPIO";
+					return;
+				}
+				CGpioPin *pPin = CGpio::GetPPinById(atoi(sunitcode.c_str()));
+				if (pPin == NULL) {
+					root["status"] = "ERROR";
+					root["message"] = "Given pin does not exist on this GPIO hardware";
+					return;
+				}
+				if (!pPin->GetIsExported()) {
+					root["status"] = "ERROR";
+					root["message"] = "Given pin is not exported";
+					return;
+				}
+				if (!pPin->GetIsOutput()) {
+					root["status"] = "ERROR";
+					root["message"] = "Given pin is not configured for output";
+					return;
 				}
-				else if (lighttype < 70)
+#else
+				root["status"] = "ERROR";
+				root["message"] = "GPIO support is disabled";
+				return;
+#endif
+			}
+			else if (lighttype < 20)
+			{
+				dtype = pTypeLighting1;
+				subtype = lighttype;
+				std::string shousecode = request::findValue(&req, "housecode");
+				sunitcode = request::findValue(&req, "unitcode");
+				if (
+					(shousecode == "") ||
+					(sunitcode == "")
+					)
+					return;
+				devid = shousecode;
+			}
+			else if (lighttype < 30)
+			{
+				dtype = pTypeLighting2;
+				subtype = lighttype - 20;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
+				if (
+					(id == "") ||
+					(sunitcode == "")
+					)
+					return;
+				devid = id;
+			}
+			else if (lighttype < 70)
+			{
+				dtype = pTypeLighting5;
+				subtype = lighttype - 50;
+				if (lighttype == 59)
+					subtype = sTypeIT;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
+				if (
+					(id == "") ||
+					(sunitcode == "")
+					)
+					return;
+				if ((subtype != sTypeEMW100) && (subtype != sTypeLivolo) && (subtype != sTypeLivoloAppliance) && (subtype != sTypeRGB432W) && (subtype != sTypeIT))
+					devid = "00" + id;
+				else
+					devid = id;
+			}
+			else
+			{
+				if (lighttype == 100)
 				{
-					dtype = pTypeLighting5;
-					subtype = lighttype - 50;
-					if (lighttype == 59)
-						subtype = sTypeIT;
+					//Chime/ByronSX
+					dtype = pTypeChime;
+					subtype = sTypeByronSX;
 					std::string id = request::findValue(&req, "id");
 					sunitcode = request::findValue(&req, "unitcode");
 					if (
@@ -4633,10 +4712,37 @@ namespace http {
 						(sunitcode == "")
 						)
 						return;
-					if ((subtype != sTypeEMW100) && (subtype != sTypeLivolo) && (subtype != sTypeLivoloAppliance) && (subtype != sTypeRGB432W) && (subtype != sTypeLightwaveRF) && (subtype != sTypeIT))
-						devid = "00" + id;
-					else
-						devid = id;
+					int iUnitCode = atoi(sunitcode.c_str()) - 1;
+					switch (iUnitCode)
+					{
+					case 0:
+						iUnitCode = chime_sound0;
+						break;
+					case 1:
+						iUnitCode = chime_sound1;
+						break;
+					case 2:
+						iUnitCode = chime_sound2;
+						break;
+					case 3:
+						iUnitCode = chime_sound3;
+						break;
+					case 4:
+						iUnitCode = chime_sound4;
+						break;
+					case 5:
+						iUnitCode = chime_sound5;
+						break;
+					case 6:
+						iUnitCode = chime_sound6;
+						break;
+					case 7:
+						iUnitCode = chime_sound7;
+						break;
+					}
+					sprintf(szTmp, "%d", iUnitCode);
+					sunitcode = szTmp;
+					devid = id;
 				}
 				else if (lighttype == 101)
 				{
@@ -4740,910 +4846,1344 @@ namespace http {
 						return;
 					devid = id;
 				}
-				else
+				else if ((lighttype >= 200) && (lighttype < 300))
 				{
-					if (lighttype == 100)
-					{
-						//Chime/ByronSX
-						dtype = pTypeChime;
-						subtype = sTypeByronSX;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						int iUnitCode = atoi(sunitcode.c_str()) - 1;
-						switch (iUnitCode)
-						{
-						case 0:
-							iUnitCode = chime_sound0;
-							break;
-						case 1:
-							iUnitCode = chime_sound1;
-							break;
-						case 2:
-							iUnitCode = chime_sound2;
-							break;
-						case 3:
-							iUnitCode = chime_sound3;
-							break;
-						case 4:
-							iUnitCode = chime_sound4;
-							break;
-						case 5:
-							iUnitCode = chime_sound5;
-							break;
-						case 6:
-							iUnitCode = chime_sound6;
-							break;
-						case 7:
-							iUnitCode = chime_sound7;
-							break;
-						}
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						devid = id;
-					}
-					else if ((lighttype >= 200) && (lighttype < 300))
-					{
-						dtype = pTypeBlinds;
-						subtype = lighttype-200;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						int iUnitCode = atoi(sunitcode.c_str());
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						devid = id;
-					}
-					else if (lighttype == 301)
-					{
-						//Smartwares Radiator
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = id;
-
-						//For this device, we will also need to add a Radiator type, do that first
-						dtype = pTypeRadiator1;
-						subtype = sTypeSmartwares;
-
-						//check if switch is unique
-						std::vector<std::vector<std::string> > result;
-						result = m_sql.safe_query(
-							"SELECT Name FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
-							hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
-						if (result.size() > 0)
-						{
-							root["message"] = "Switch already exists!";
-							return;
-						}
-						bool bActEnabledState = m_sql.m_bAcceptNewHardware;
-						m_sql.m_bAcceptNewHardware = true;
-						std::string devname;
-						m_sql.UpdateValue(atoi(hwdid.c_str()), devid.c_str(), atoi(sunitcode.c_str()), dtype, subtype, 0, -1, 0, "20.5", devname);
-						m_sql.m_bAcceptNewHardware = bActEnabledState;
-
-						//set name and switchtype
-						result = m_sql.safe_query(
-							"SELECT ID FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
-							hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
-						if (result.size() < 1)
-						{
-							root["message"] = "Error finding switch in Database!?!?";
-							return;
-						}
-						std::string ID = result[0][0];
-
-						m_sql.safe_query(
-							"UPDATE DeviceStatus SET Used=1, Name='%q', SwitchType=%d WHERE (ID == '%q')",
-							name.c_str(), switchtype, ID.c_str());
-
-						//Now continue to insert the switch
-						dtype = pTypeRadiator1;
-						subtype = sTypeSmartwaresSwitchRadiator;
-					}
-					else if (lighttype == 302)
-					{
-						//Home Confort
-						dtype = pTypeHomeConfort;
-						subtype = sTypeHomeConfortTEL010;
-						std::string id = request::findValue(&req, "id");
-
-						std::string shousecode = request::findValue(&req, "housecode");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id.empty()) ||
-							(shousecode.empty()) ||
-							(sunitcode.empty())
-							)
-							return;
-
-						int iUnitCode = atoi(sunitcode.c_str());
-						sprintf(szTmp, "%d", iUnitCode);
-						sunitcode = szTmp;
-						sprintf(szTmp, "%02X", atoi(shousecode.c_str()));
-						shousecode = szTmp;
-						devid = id + shousecode;
-					}
-					else if (lighttype == 303)
-					{
-						//Selector Switch
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchTypeSelector;
-						std::string id = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(id == "") ||
-							(sunitcode == "")
-							)
-							return;
-						devid = "0" + id;
-						switchtype = STYPE_Selector;
-						if (!deviceoptions.empty()) {
-							deviceoptions.append(";");
-						}
-						deviceoptions.append("SelectorStyle:0;LevelNames:Off|Level1|Level2|Level3");
-					}
-					else if (lighttype == 304)
-					{
-						//Itho CVE RFT
-						dtype = pTypeFan;
-						subtype = sTypeItho;
-						std::string id = request::findValue(&req, "id");
-						if (id.empty())
-							return;
-						devid = id;
-						sunitcode = "0";
-					}
-					else if (lighttype == 305)
-					{
-						//Lucci Air
-						dtype = pTypeFan;
-						subtype = sTypeLucciAir;
-						std::string id = request::findValue(&req, "id");
-						if (id.empty())
-							return;
-						devid = id;
-						sunitcode = "0";
-					}
-					else if (lighttype == 400)
-					{
-						//Openwebnet Bus Blinds
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchBlindsT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 401)
-					{
-						//Openwebnet Bus Lights
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchLightT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 402)
-					{
-					    //Openwebnet Bus Auxiliary
-					    dtype = pTypeGeneralSwitch;
-						subtype = sSwitchAuxiliaryT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 403)
-					{
-						//Openwebnet Zigbee Blinds
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchBlindsT2;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if (lighttype == 404)
-					{
-						//Openwebnet Zigbee Lights
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchLightT2;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
-					else if ((lighttype == 405) || (lighttype == 406))
-					{
-						//Openwebnet Dry Contact / IR Detection
-						dtype = pTypeGeneralSwitch;
-						subtype = sSwitchContactT1;
-						devid = request::findValue(&req, "id");
-						sunitcode = request::findValue(&req, "unitcode");
-						if (
-							(devid == "") ||
-							(sunitcode == "")
-							)
-							return;
-					}
+					dtype = pTypeBlinds;
+					subtype = lighttype-200;
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					int iUnitCode = atoi(sunitcode.c_str());
+					sprintf(szTmp, "%d", iUnitCode);
+					sunitcode = szTmp;
+					devid = id;
+				}
+				else if (lighttype == 301)
+				{
+					//Smartwares Radiator
+					dtype = pTypeRadiator1;
+					subtype = sTypeSmartwaresSwitchRadiator;
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					devid = id;
 				}
+				else if (lighttype == 302)
+				{
+					//Home Confort
+					dtype = pTypeHomeConfort;
+					subtype = sTypeHomeConfortTEL010;
+					std::string id = request::findValue(&req, "id");
 
-				//check if switch is unique
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query(
-					"SELECT Name FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
-					hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
-				if (result.size() > 0)
+					std::string shousecode = request::findValue(&req, "housecode");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id.empty()) ||
+						(shousecode.empty()) ||
+						(sunitcode.empty())
+						)
+						return;
+
+					int iUnitCode = atoi(sunitcode.c_str());
+					sprintf(szTmp, "%d", iUnitCode);
+					sunitcode = szTmp;
+					sprintf(szTmp, "%02X", atoi(shousecode.c_str()));
+					shousecode = szTmp;
+					devid = id + shousecode;
+				}
+				else if (lighttype == 303)
 				{
-					root["message"] = "Switch already exists!";
-					return;
+					//Selector Switch
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchTypeSelector;
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					devid = id;
 				}
-
-				// ----------- If needed convert to GeneralSwitch type (for o.a. RFlink) -----------
-				CDomoticzHardwareBase *pBaseHardware = m_mainworker.GetHardware(atoi(hwdid.c_str()));
-				if (pBaseHardware != NULL)
+				else if (lighttype == 304)
 				{
-					if ((pBaseHardware->HwdType == HTYPE_RFLINKUSB) || (pBaseHardware->HwdType == HTYPE_RFLINKTCP)) {
-						ConvertToGeneralSwitchType(devid, dtype, subtype);
-					}
+					//Itho CVE RFT
+					dtype = pTypeFan;
+					subtype = sTypeItho;
+					std::string id = request::findValue(&req, "id");
+					if (id.empty())
+						return;
+					devid = id;
+					sunitcode = "0";
 				}
-        // -----------------------------------------------
-
-				bool bActEnabledState = m_sql.m_bAcceptNewHardware;
-				m_sql.m_bAcceptNewHardware = true;
-				std::string devname;
-				m_sql.UpdateValue(atoi(hwdid.c_str()), devid.c_str(), atoi(sunitcode.c_str()), dtype, subtype, 0, -1, 0, devname);
-				m_sql.m_bAcceptNewHardware = bActEnabledState;
-
-				//set name and switchtype
-				result = m_sql.safe_query(
-					"SELECT ID FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
-					hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
-				if (result.size() < 1)
+				else if (lighttype == 305)
 				{
-					root["message"] = "Error finding switch in Database!?!?";
-					return;
+					//Lucci Air
+					dtype = pTypeFan;
+					subtype = sTypeLucciAir;
+					std::string id = request::findValue(&req, "id");
+					if (id.empty())
+						return;
+					devid = id;
+					sunitcode = "0";
 				}
-				std::string ID = result[0][0];
-
-				m_sql.safe_query(
-					"UPDATE DeviceStatus SET Used=1, Name='%q', SwitchType=%d WHERE (ID == '%q')",
-					name.c_str(), switchtype, ID.c_str());
-				m_mainworker.m_eventsystem.GetCurrentStates();
-
-				//Set device options
-				m_sql.SetDeviceOptions(atoi(ID.c_str()), m_sql.BuildDeviceOptions(deviceoptions, false));
-
-				if (maindeviceidx != "")
+				else if (lighttype == 400) {
+					//Openwebnet Bus Blinds
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchBlindsT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
+				}
+				else if (lighttype == 401) {
+					//Openwebnet Bus Lights
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchLightT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
+				}
+				else if (lighttype == 402)
 				{
-					if (maindeviceidx != ID)
-					{
-						//this is a sub device for another light/switch
-						//first check if it is not already a sub device
-						result = m_sql.safe_query(
-							"SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q') AND (ParentID =='%q')",
-							ID.c_str(), maindeviceidx.c_str());
-						if (result.size() == 0)
-						{
-							//no it is not, add it
-							result = m_sql.safe_query(
-								"INSERT INTO LightSubDevices (DeviceRowID, ParentID) VALUES ('%q','%q')",
-								ID.c_str(),
-								maindeviceidx.c_str()
-								);
-						}
-					}
+					//Openwebnet Bus Auxiliary
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchAuxiliaryT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
+				}
+				else if (lighttype == 403) {
+					//Openwebnet Zigbee Blinds
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchBlindsT2;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
+				}
+				else if (lighttype == 404) {
+					//Light Openwebnet Zigbee
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchLightT2;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
+				}
+				else if ((lighttype == 405) || (lighttype == 406)) {
+					// Openwebnet Dry Contact / IR Detection
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchContactT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-
-				root["status"] = "OK";
-				root["title"] = "AddSwitch";
 			}
-			else if (cparam == "getnotificationtypes")
+       // ----------- If needed convert to GeneralSwitch type (for o.a. RFlink) -----------
+			CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hwdid.c_str())));
+			if (pBaseHardware != NULL)
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
+				if ((pBaseHardware->HwdType == HTYPE_RFLINKUSB) || (pBaseHardware->HwdType == HTYPE_RFLINKTCP)) {
+					ConvertToGeneralSwitchType(devid, dtype, subtype);
 				}
+			}
+        // -----------------------------------------------
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				//First get Device Type/SubType
-				result = m_sql.safe_query("SELECT Type, SubType, SwitchType FROM DeviceStatus WHERE (ID == '%q')",
-					idx.c_str());
-				if (result.size() < 1)
-					return;
+			root["status"] = "OK";
+			root["message"] = "OK";
+			root["title"] = "TestSwitch";
+			std::vector<std::string> sd;
+
+			sd.push_back(hwdid);
+			sd.push_back(devid);
+			sd.push_back(sunitcode);
+			sprintf(szTmp, "%d", dtype);
+			sd.push_back(szTmp);
+			sprintf(szTmp, "%d", subtype);
+			sd.push_back(szTmp);
+			sprintf(szTmp, "%d", switchtype);
+			sd.push_back(szTmp);
+			sd.push_back(""); //AddjValue2
+			sd.push_back(""); //nValue
+			sd.push_back(""); //sValue
+			sd.push_back(""); //Name
+			sd.push_back(""); //Options
+
+			std::string switchcmd = "On";
+			int level = 0;
+			if (lighttype == 70)
+			{
+				//Special EnOcean case, if it is a dimmer, set a dim value
+				if (switchtype == STYPE_Dimmer)
+					level = 5;
+			}
+			m_mainworker.SwitchLightInt(sd, switchcmd, level, -1, true);
+		}
 
-				root["status"] = "OK";
-				root["title"] = "GetNotificationTypes";
-				unsigned char dType = atoi(result[0][0].c_str());
-				unsigned char dSubType = atoi(result[0][1].c_str());
-				unsigned char switchtype = atoi(result[0][2].c_str());
+		void CWebServer::Cmd_AddSwitch(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			char szTmp[300];
 
-				int ii = 0;
+			std::string hwdid = request::findValue(&req, "hwdid");
+			std::string name = request::findValue(&req, "name");
+			std::string sswitchtype = request::findValue(&req, "switchtype");
+			std::string slighttype = request::findValue(&req, "lighttype");
+			std::string maindeviceidx = request::findValue(&req, "maindeviceidx");
+			std::string deviceoptions;
+
+			if (
+				(hwdid == "") ||
+				(sswitchtype == "") ||
+				(slighttype == "") ||
+				(name == "")
+				)
+				return;
+			_eSwitchType switchtype = (_eSwitchType)atoi(sswitchtype.c_str());
+			int lighttype = atoi(slighttype.c_str());
+			int dtype = 0;
+			int subtype = 0;
+			std::string sunitcode;
+			std::string devid;
+
+			if (lighttype == 70)
+			{
+				//EnOcean (Lighting2 with Base_ID offset)
+				dtype = pTypeLighting2;
+				subtype = sTypeAC;
+				sunitcode = request::findValue(&req, "unitcode");
+				std::string sgroupcode = request::findValue(&req, "groupcode");
+				int iUnitTest = atoi(sunitcode.c_str());	//gives us 128 devices we can control, should be enough!
 				if (
-					(dType == pTypeLighting1) ||
-					(dType == pTypeLighting2) ||
-					(dType == pTypeLighting3) ||
-					(dType == pTypeLighting4) ||
-					(dType == pTypeLighting5) ||
-					(dType == pTypeLighting6) ||
-					(dType == pTypeLimitlessLights) ||
-					(dType == pTypeSecurity1) ||
-					(dType == pTypeSecurity2) ||
-					(dType == pTypeEvohome) ||
-					(dType == pTypeEvohomeRelay) ||
-					(dType == pTypeCurtain) ||
-					(dType == pTypeBlinds) ||
-					(dType == pTypeRFY) ||
-					(dType == pTypeChime) ||
-					(dType == pTypeThermostat2) ||
-					(dType == pTypeThermostat3) ||
-					(dType == pTypeThermostat4) ||
-					(dType == pTypeRemote) ||
-					(dType == pTypeGeneralSwitch) ||
-					(dType == pTypeHomeConfort) ||
-					((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))
+					(sunitcode == "") ||
+					(sgroupcode == "") ||
+					((iUnitTest < 1) || (iUnitTest>128))
 					)
+					return;
+				sunitcode = sgroupcode;//Button A/B
+				CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hwdid.c_str())));
+				if (pBaseHardware == NULL)
+					return;
+				if ((pBaseHardware->HwdType != HTYPE_EnOceanESP2) && (pBaseHardware->HwdType != HTYPE_EnOceanESP3))
+					return;
+				unsigned long rID = 0;
+				if (pBaseHardware->HwdType == HTYPE_EnOceanESP2)
 				{
-					if (switchtype != STYPE_PushOff)
+					CEnOceanESP2 *pEnoceanHardware = reinterpret_cast<CEnOceanESP2*>(pBaseHardware);
+					if (pEnoceanHardware->m_id_base == 0)
 					{
-						root["result"][ii]["val"] = NTYPE_SWITCH_ON;
-						root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 0);
-						root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 1);
-						ii++;
+						root["message"] = "BaseID not found, is the hardware running?";
+						return;
 					}
-					if (switchtype != STYPE_PushOn)
+					rID = pEnoceanHardware->m_id_base + iUnitTest;
+				}
+				else
+				{
+					CEnOceanESP3 *pEnoceanHardware = reinterpret_cast<CEnOceanESP3*>(pBaseHardware);
+					if (pEnoceanHardware->m_id_base == 0)
 					{
-						root["result"][ii]["val"] = NTYPE_SWITCH_OFF;
-						root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 0);
-						root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 1);
-						ii++;
+						root["message"] = "BaseID not found, is the hardware running?";
+						return;
 					}
-					if (switchtype == STYPE_Media)
-					{
-						std::string idx = request::findValue(&req, "idx");
-						std::vector<std::vector<std::string> > result;
+					rID = pEnoceanHardware->m_id_base + iUnitTest;
+				}
+				//convert to hex, and we have our ID
+				std::stringstream s_strid;
+				s_strid << std::hex << std::uppercase << rID;
+				devid = s_strid.str();
+			}
+			else if (lighttype == 68)
+			{
+#ifdef WITH_GPIO
+				dtype = pTypeLighting1;
+				subtype = sTypeIMPULS;
+				devid = "0";
+				sunitcode = request::findValue(&req, "unitcode"); //Unit code = GPIO number
 
-						result = m_sql.safe_query("SELECT HardwareID FROM DeviceStatus WHERE (ID=='%q')", idx.c_str());
-						if (!result.empty())
-						{
-							std::string hdwid = result[0][0];
-							CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hdwid.c_str())));
-							if (pBaseHardware != NULL) {
-								_eHardwareTypes type = pBaseHardware->HwdType;
-								root["result"][ii]["val"] = NTYPE_PAUSED;
-								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PAUSED, 0);
-								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PAUSED, 1);
-								ii++;
-								if (type == HTYPE_Kodi) {
-									root["result"][ii]["val"] = NTYPE_AUDIO;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AUDIO, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AUDIO, 1);
-									ii++;
-									root["result"][ii]["val"] = NTYPE_VIDEO;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_VIDEO, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_VIDEO, 1);
-									ii++;
-									root["result"][ii]["val"] = NTYPE_PHOTO;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PHOTO, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PHOTO, 1);
-									ii++;
-								}
-								if (type == HTYPE_LogitechMediaServer) {
-									root["result"][ii]["val"] = NTYPE_PLAYING;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PLAYING, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PLAYING, 1);
-									ii++;
-									root["result"][ii]["val"] = NTYPE_STOPPED;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_STOPPED, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_STOPPED, 1);
-									ii++;
-								}
-								if (type == HTYPE_HEOS) {
-									root["result"][ii]["val"] = NTYPE_PLAYING;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PLAYING, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PLAYING, 1);
-									ii++;
-									root["result"][ii]["val"] = NTYPE_STOPPED;
-									root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_STOPPED, 0);
-									root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_STOPPED, 1);
-									ii++;
-								}
-							}
-						}
-					}
+				if (sunitcode == "") {
+					return;
+				}
+				CGpio *pGpio = (CGpio *)m_mainworker.GetHardware(atoi(hwdid.c_str()));
+				if (pGpio == NULL) {
+					return;
+				}
+				if (pGpio->HwdType != HTYPE_RaspberryGPIO) {
+					return;
+				}
+				CGpioPin *pPin = CGpio::GetPPinById(atoi(sunitcode.c_str()));
+				if (pPin == NULL) {
+					return;
+				}
+				if (!pPin->GetIsExported()) {
+					return;
 				}
+#else
+				return;
+#endif
+			}
+			else if (lighttype < 20)
+			{
+				dtype = pTypeLighting1;
+				subtype = lighttype;
+				std::string shousecode = request::findValue(&req, "housecode");
+				sunitcode = request::findValue(&req, "unitcode");
 				if (
-					(
-					(dType == pTypeTEMP) ||
-					(dType == pTypeTEMP_HUM) ||
-					(dType == pTypeTEMP_HUM_BARO) ||
-					(dType == pTypeTEMP_BARO) ||
-					(dType == pTypeEvohomeZone) ||
-					(dType == pTypeEvohomeWater) ||
-					(dType == pTypeThermostat1) ||
-					(dType == pTypeRego6XXTemp) ||
-					((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorTemp))
-					) ||
-					((dType == pTypeUV) && (dSubType == sTypeUV3)) ||
-					((dType == pTypeWIND) && (dSubType == sTypeWIND4)) ||
-					((dType == pTypeWIND) && (dSubType == sTypeWINDNoTemp)) ||
-					((dType == pTypeGeneral) && (dSubType == sTypeSystemTemp))
+					(shousecode == "") ||
+					(sunitcode == "")
 					)
-				{
-					root["result"][ii]["val"] = NTYPE_TEMPERATURE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 1);
-					ii++;
-				}
+					return;
+				devid = shousecode;
+			}
+			else if (lighttype < 30)
+			{
+				dtype = pTypeLighting2;
+				subtype = lighttype - 20;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
 				if (
-					(dType == pTypeHUM) ||
-					(dType == pTypeTEMP_HUM) ||
-					(dType == pTypeTEMP_HUM_BARO)
+					(id == "") ||
+					(sunitcode == "")
 					)
-				{
-					root["result"][ii]["val"] = NTYPE_HUMIDITY;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_HUMIDITY, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_HUMIDITY, 1);
-					ii++;
-				}
+					return;
+				devid = id;
+			}
+			else if (lighttype < 70)
+			{
+				dtype = pTypeLighting5;
+				subtype = lighttype - 50;
+				if (lighttype == 59)
+					subtype = sTypeIT;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
 				if (
-					(dType == pTypeTEMP_HUM) ||
-					(dType == pTypeTEMP_HUM_BARO)
+					(id == "") ||
+					(sunitcode == "")
 					)
-				{
-					root["result"][ii]["val"] = NTYPE_DEWPOINT;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_DEWPOINT, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_DEWPOINT, 1);
-					ii++;
-				}
-				if (dType == pTypeRAIN)
-				{
-					root["result"][ii]["val"] = NTYPE_RAIN;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_RAIN, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_RAIN, 1);
-					ii++;
-				}
-				if (dType == pTypeWIND)
-				{
-					root["result"][ii]["val"] = NTYPE_WIND;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_WIND, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_WIND, 1);
-					ii++;
-				}
-				if (dType == pTypeUV)
-				{
-					root["result"][ii]["val"] = NTYPE_UV;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_UV, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_UV, 1);
-					ii++;
-				}
+					return;
+				if ((subtype != sTypeEMW100) && (subtype != sTypeLivolo) && (subtype != sTypeLivoloAppliance) && (subtype != sTypeRGB432W) && (subtype != sTypeLightwaveRF) && (subtype != sTypeIT))
+					devid = "00" + id;
+				else
+					devid = id;
+			}
+			else if (lighttype == 101)
+			{
+				//Curtain Harrison
+				dtype = pTypeCurtain;
+				subtype = sTypeHarrison;
+				std::string shousecode = request::findValue(&req, "housecode");
+				sunitcode = request::findValue(&req, "unitcode");
 				if (
-					(dType == pTypeTEMP_HUM_BARO) ||
-					(dType == pTypeBARO) ||
-					(dType == pTypeTEMP_BARO)
+					(shousecode == "") ||
+					(sunitcode == "")
 					)
-				{
-					root["result"][ii]["val"] = NTYPE_BARO;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_BARO, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_BARO, 1);
-					ii++;
-				}
+					return;
+				devid = shousecode;
+			}
+			else if (lighttype == 102)
+			{
+				//RFY
+				dtype = pTypeRFY;
+				subtype = sTypeRFY;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
 				if (
-					((dType == pTypeRFXMeter) && (dSubType == sTypeRFXMeterCount)) ||
-                    ((dType == pTypeGeneral) && (dSubType == sTypeCounterIncremental)) ||
-					(dType == pTypeYouLess) ||
-					((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXCounter))
+					(id == "") ||
+					(sunitcode == "")
 					)
+					return;
+				devid = id;
+			}
+			else if (lighttype == 103)
+			{
+				//Meiantech
+				dtype = pTypeSecurity1;
+				subtype = sTypeMeiantech;
+				std::string id = request::findValue(&req, "id");
+				if (
+					(id == "")
+					)
+					return;
+				devid = id;
+				sunitcode = "0";
+			}
+			else if (lighttype == 104)
+			{
+				//HE105
+				dtype = pTypeThermostat2;
+				subtype = sTypeHE105;
+				sunitcode = request::findValue(&req, "unitcode");
+				if (sunitcode == "")
+					return;
+				//convert to hex, and we have our Unit Code
+				std::stringstream s_strid;
+				s_strid << std::hex << std::uppercase << sunitcode;
+				int iUnitCode;
+				s_strid >> iUnitCode;
+				sprintf(szTmp, "%d", iUnitCode);
+				sunitcode = szTmp;
+				devid = "1";
+			}
+			else if (lighttype == 105)
+			{
+				//ASA
+				dtype = pTypeRFY;
+				subtype = sTypeASA;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
+				if (
+					(id == "") ||
+					(sunitcode == "")
+					)
+					return;
+				devid = id;
+			}
+			else if (lighttype == 106)
+			{
+				//Blyss
+				dtype = pTypeLighting6;
+				subtype = lighttype - 60;
+				std::string sgroupcode = request::findValue(&req, "groupcode");
+				sunitcode = request::findValue(&req, "unitcode");
+				std::string id = request::findValue(&req, "id");
+				if (
+					(sgroupcode == "") ||
+					(sunitcode == "") ||
+					(id == "")
+					)
+					return;
+				devid = id + sgroupcode;
+			}
+			else if (lighttype == 107)
+			{
+				//RFY2
+				dtype = pTypeRFY;
+				subtype = sTypeRFY2;
+				std::string id = request::findValue(&req, "id");
+				sunitcode = request::findValue(&req, "unitcode");
+				if (
+					(id == "") ||
+					(sunitcode == "")
+					)
+					return;
+				devid = id;
+			}
+			else
+			{
+				if (lighttype == 100)
 				{
-					if ((switchtype == MTYPE_ENERGY)|| (switchtype == MTYPE_ENERGY_GENERATED))
-					{
-						root["result"][ii]["val"] = NTYPE_TODAYENERGY;
-						root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 0);
-						root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 1);
-					}
-					else if (switchtype == MTYPE_GAS)
-					{
-						root["result"][ii]["val"] = NTYPE_TODAYGAS;
-						root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYGAS, 0);
-						root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYGAS, 1);
-					}
-					else if (switchtype == MTYPE_COUNTER)
-					{
-						root["result"][ii]["val"] = NTYPE_TODAYCOUNTER;
-						root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYCOUNTER, 0);
-						root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYCOUNTER, 1);
-					}
-					else
-					{
-						//water (same as gas)
-						root["result"][ii]["val"] = NTYPE_TODAYGAS;
-						root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYGAS, 0);
-						root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYGAS, 1);
-					}
-					ii++;
-				}
-				if (dType == pTypeYouLess)
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if (dType == pTypeAirQuality)
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				else if ((dType == pTypeGeneral) && ((dSubType == sTypeSoilMoisture) || (dSubType == sTypeLeafWetness)))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeVisibility))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeDistance))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeVoltage))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeCurrent))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypePressure))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeBaro))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					//Chime/ByronSX
+					dtype = pTypeChime;
+					subtype = sTypeByronSX;
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					int iUnitCode = atoi(sunitcode.c_str()) - 1;
+					switch (iUnitCode)
+					{
+					case 0:
+						iUnitCode = chime_sound0;
+						break;
+					case 1:
+						iUnitCode = chime_sound1;
+						break;
+					case 2:
+						iUnitCode = chime_sound2;
+						break;
+					case 3:
+						iUnitCode = chime_sound3;
+						break;
+					case 4:
+						iUnitCode = chime_sound4;
+						break;
+					case 5:
+						iUnitCode = chime_sound5;
+						break;
+					case 6:
+						iUnitCode = chime_sound6;
+						break;
+					case 7:
+						iUnitCode = chime_sound7;
+						break;
+					}
+					sprintf(szTmp, "%d", iUnitCode);
+					sunitcode = szTmp;
+					devid = id;
 				}
-				if (dType == pTypeLux)
+				else if ((lighttype >= 200) && (lighttype < 300))
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					dtype = pTypeBlinds;
+					subtype = lighttype-200;
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					int iUnitCode = atoi(sunitcode.c_str());
+					sprintf(szTmp, "%d", iUnitCode);
+					sunitcode = szTmp;
+					devid = id;
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))
+				else if (lighttype == 301)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					//Smartwares Radiator
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					devid = id;
+
+					//For this device, we will also need to add a Radiator type, do that first
+					dtype = pTypeRadiator1;
+					subtype = sTypeSmartwares;
+
+					//check if switch is unique
+					std::vector<std::vector<std::string> > result;
+					result = m_sql.safe_query(
+						"SELECT Name FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
+						hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
+					if (result.size() > 0)
+					{
+						root["message"] = "Switch already exists!";
+						return;
+					}
+					bool bActEnabledState = m_sql.m_bAcceptNewHardware;
+					m_sql.m_bAcceptNewHardware = true;
+					std::string devname;
+					m_sql.UpdateValue(atoi(hwdid.c_str()), devid.c_str(), atoi(sunitcode.c_str()), dtype, subtype, 0, -1, 0, "20.5", devname);
+					m_sql.m_bAcceptNewHardware = bActEnabledState;
+
+					//set name and switchtype
+					result = m_sql.safe_query(
+						"SELECT ID FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
+						hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
+					if (result.size() < 1)
+					{
+						root["message"] = "Error finding switch in Database!?!?";
+						return;
+					}
+					std::string ID = result[0][0];
+
+					m_sql.safe_query(
+						"UPDATE DeviceStatus SET Used=1, Name='%q', SwitchType=%d WHERE (ID == '%q')",
+						name.c_str(), switchtype, ID.c_str());
+
+					//Now continue to insert the switch
+					dtype = pTypeRadiator1;
+					subtype = sTypeSmartwaresSwitchRadiator;
 				}
-				if (dType == pTypeWEIGHT)
+				else if (lighttype == 302)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					//Home Confort
+					dtype = pTypeHomeConfort;
+					subtype = sTypeHomeConfortTEL010;
+					std::string id = request::findValue(&req, "id");
+
+					std::string shousecode = request::findValue(&req, "housecode");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id.empty()) ||
+						(shousecode.empty()) ||
+						(sunitcode.empty())
+						)
+						return;
+
+					int iUnitCode = atoi(sunitcode.c_str());
+					sprintf(szTmp, "%d", iUnitCode);
+					sunitcode = szTmp;
+					sprintf(szTmp, "%02X", atoi(shousecode.c_str()));
+					shousecode = szTmp;
+					devid = id + shousecode;
 				}
-				if (dType == pTypeUsage)
+				else if (lighttype == 303)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					//Selector Switch
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchTypeSelector;
+					std::string id = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(id == "") ||
+						(sunitcode == "")
+						)
+						return;
+					devid = "0" + id;
+					switchtype = STYPE_Selector;
+					if (!deviceoptions.empty()) {
+						deviceoptions.append(";");
+					}
+					deviceoptions.append("SelectorStyle:0;LevelNames:Off|Level1|Level2|Level3");
 				}
-				if (
-					(dType == pTypeENERGY)||
-					((dType == pTypeGeneral)&& (dSubType == sTypeKwh))
-					)
+				else if (lighttype == 304)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					//Itho CVE RFT
+					dtype = pTypeFan;
+					subtype = sTypeItho;
+					std::string id = request::findValue(&req, "id");
+					if (id.empty())
+						return;
+					devid = id;
+					sunitcode = "0";
 				}
-				if (dType == pTypePOWER)
+				else if (lighttype == 305)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					//Lucci Air
+					dtype = pTypeFan;
+					subtype = sTypeLucciAir;
+					std::string id = request::findValue(&req, "id");
+					if (id.empty())
+						return;
+					devid = id;
+					sunitcode = "0";
 				}
-				if ((dType == pTypeCURRENT) && (dSubType == sTypeELEC1))
+				else if (lighttype == 400)
 				{
-					root["result"][ii]["val"] = NTYPE_AMPERE1;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE1, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE1, 1);
-					ii++;
-					root["result"][ii]["val"] = NTYPE_AMPERE2;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE2, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE2, 1);
-					ii++;
-					root["result"][ii]["val"] = NTYPE_AMPERE3;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE3, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE3, 1);
-					ii++;
+					//Openwebnet Bus Blinds
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchBlindsT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-				if ((dType == pTypeCURRENTENERGY) && (dSubType == sTypeELEC4))
+				else if (lighttype == 401)
 				{
-					root["result"][ii]["val"] = NTYPE_AMPERE1;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE1, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE1, 1);
-					ii++;
-					root["result"][ii]["val"] = NTYPE_AMPERE2;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE2, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE2, 1);
-					ii++;
-					root["result"][ii]["val"] = NTYPE_AMPERE3;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE3, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE3, 1);
-					ii++;
+					//Openwebnet Bus Lights
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchLightT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-				if (dType == pTypeP1Power)
+				else if (lighttype == 402)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
-					root["result"][ii]["val"] = NTYPE_TODAYENERGY;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 1);
-					ii++;
+				    //Openwebnet Bus Auxiliary
+				    dtype = pTypeGeneralSwitch;
+					subtype = sSwitchAuxiliaryT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-				if (dType == pTypeP1Gas)
+				else if (lighttype == 403)
 				{
-					root["result"][ii]["val"] = NTYPE_TODAYGAS;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYGAS, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYGAS, 1);
-					ii++;
+					//Openwebnet Zigbee Blinds
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchBlindsT2;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-				if ((dType == pTypeThermostat) && (dSubType == sTypeThermSetpoint))
+				else if (lighttype == 404)
 				{
-					root["result"][ii]["val"] = NTYPE_TEMPERATURE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 1);
-					ii++;
+					//Openwebnet Zigbee Lights
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchLightT2;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-				if (dType == pTypeEvohomeZone)
+				else if ((lighttype == 405) || (lighttype == 406))
 				{
-					root["result"][ii]["val"]=NTYPE_TEMPERATURE;
-					root["result"][ii]["text"]=Notification_Type_Desc(NTYPE_SETPOINT,0); //FIXME NTYPE_SETPOINT implementation?
-					root["result"][ii]["ptag"]=Notification_Type_Desc(NTYPE_SETPOINT,1);
-					ii++;
+					//Openwebnet Dry Contact / IR Detection
+					dtype = pTypeGeneralSwitch;
+					subtype = sSwitchContactT1;
+					devid = request::findValue(&req, "id");
+					sunitcode = request::findValue(&req, "unitcode");
+					if (
+						(devid == "") ||
+						(sunitcode == "")
+						)
+						return;
 				}
-				if ((dType == pTypeRFXSensor) && ((dSubType == sTypeRFXSensorAD) || (dSubType == sTypeRFXSensorVolt)))
-				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+			}
+
+			//check if switch is unique
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query(
+				"SELECT Name FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
+				hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
+			if (result.size() > 0)
+			{
+				root["message"] = "Switch already exists!";
+				return;
+			}
+
+			// ----------- If needed convert to GeneralSwitch type (for o.a. RFlink) -----------
+			CDomoticzHardwareBase *pBaseHardware = m_mainworker.GetHardware(atoi(hwdid.c_str()));
+			if (pBaseHardware != NULL)
+			{
+				if ((pBaseHardware->HwdType == HTYPE_RFLINKUSB) || (pBaseHardware->HwdType == HTYPE_RFLINKTCP)) {
+					ConvertToGeneralSwitchType(devid, dtype, subtype);
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypePercentage))
+			}
+        // -----------------------------------------------
+
+			bool bActEnabledState = m_sql.m_bAcceptNewHardware;
+			m_sql.m_bAcceptNewHardware = true;
+			std::string devname;
+			m_sql.UpdateValue(atoi(hwdid.c_str()), devid.c_str(), atoi(sunitcode.c_str()), dtype, subtype, 0, -1, 0, devname);
+			m_sql.m_bAcceptNewHardware = bActEnabledState;
+
+			//set name and switchtype
+			result = m_sql.safe_query(
+				"SELECT ID FROM DeviceStatus WHERE (HardwareID=='%q' AND DeviceID=='%q' AND Unit=='%q' AND Type==%d AND SubType==%d)",
+				hwdid.c_str(), devid.c_str(), sunitcode.c_str(), dtype, subtype);
+			if (result.size() < 1)
+			{
+				root["message"] = "Error finding switch in Database!?!?";
+				return;
+			}
+			std::string ID = result[0][0];
+
+			m_sql.safe_query(
+				"UPDATE DeviceStatus SET Used=1, Name='%q', SwitchType=%d WHERE (ID == '%q')",
+				name.c_str(), switchtype, ID.c_str());
+			m_mainworker.m_eventsystem.GetCurrentStates();
+
+			//Set device options
+			m_sql.SetDeviceOptions(atoi(ID.c_str()), m_sql.BuildDeviceOptions(deviceoptions, false));
+
+			if (maindeviceidx != "")
+			{
+				if (maindeviceidx != ID)
 				{
-					root["result"][ii]["val"] = NTYPE_PERCENTAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PERCENTAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PERCENTAGE, 1);
-					ii++;
+					//this is a sub device for another light/switch
+					//first check if it is not already a sub device
+					result = m_sql.safe_query(
+						"SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q') AND (ParentID =='%q')",
+						ID.c_str(), maindeviceidx.c_str());
+					if (result.size() == 0)
+					{
+						//no it is not, add it
+						result = m_sql.safe_query(
+							"INSERT INTO LightSubDevices (DeviceRowID, ParentID) VALUES ('%q','%q')",
+							ID.c_str(),
+							maindeviceidx.c_str()
+							);
+					}
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeWaterflow))
+			}
+
+			root["status"] = "OK";
+			root["title"] = "AddSwitch";
+		}
+
+		void CWebServer::Cmd_GetNotificationTypes(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			//First get Device Type/SubType
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT Type, SubType, SwitchType FROM DeviceStatus WHERE (ID == '%q')",
+				idx.c_str());
+			if (result.size() < 1)
+				return;
+
+			root["status"] = "OK";
+			root["title"] = "GetNotificationTypes";
+			unsigned char dType = atoi(result[0][0].c_str());
+			unsigned char dSubType = atoi(result[0][1].c_str());
+			unsigned char switchtype = atoi(result[0][2].c_str());
+
+			int ii = 0;
+			if (
+				(dType == pTypeLighting1) ||
+				(dType == pTypeLighting2) ||
+				(dType == pTypeLighting3) ||
+				(dType == pTypeLighting4) ||
+				(dType == pTypeLighting5) ||
+				(dType == pTypeLighting6) ||
+				(dType == pTypeLimitlessLights) ||
+				(dType == pTypeSecurity1) ||
+				(dType == pTypeSecurity2) ||
+				(dType == pTypeEvohome) ||
+				(dType == pTypeEvohomeRelay) ||
+				(dType == pTypeCurtain) ||
+				(dType == pTypeBlinds) ||
+				(dType == pTypeRFY) ||
+				(dType == pTypeChime) ||
+				(dType == pTypeThermostat2) ||
+				(dType == pTypeThermostat3) ||
+				(dType == pTypeThermostat4) ||
+				(dType == pTypeRemote) ||
+				(dType == pTypeGeneralSwitch) ||
+				(dType == pTypeHomeConfort) ||
+				((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))
+				)
+			{
+				if (switchtype != STYPE_PushOff)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+					root["result"][ii]["val"] = NTYPE_SWITCH_ON;
+					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 0);
+					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 1);
 					ii++;
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeCustom))
+				if (switchtype != STYPE_PushOn)
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+					root["result"][ii]["val"] = NTYPE_SWITCH_OFF;
+					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 0);
+					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 1);
 					ii++;
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeFan))
+				if (switchtype == STYPE_Media)
 				{
-					root["result"][ii]["val"] = NTYPE_RPM;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_RPM, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_RPM, 1);
-					ii++;
+					std::string idx = request::findValue(&req, "idx");
+					std::vector<std::vector<std::string> > result;
+
+					result = m_sql.safe_query("SELECT HardwareID FROM DeviceStatus WHERE (ID=='%q')", idx.c_str());
+					if (!result.empty())
+					{
+						std::string hdwid = result[0][0];
+						CDomoticzHardwareBase *pBaseHardware = reinterpret_cast<CDomoticzHardwareBase*>(m_mainworker.GetHardware(atoi(hdwid.c_str())));
+						if (pBaseHardware != NULL) {
+							_eHardwareTypes type = pBaseHardware->HwdType;
+							root["result"][ii]["val"] = NTYPE_PAUSED;
+							root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PAUSED, 0);
+							root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PAUSED, 1);
+							ii++;
+							if (type == HTYPE_Kodi) {
+								root["result"][ii]["val"] = NTYPE_AUDIO;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AUDIO, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AUDIO, 1);
+								ii++;
+								root["result"][ii]["val"] = NTYPE_VIDEO;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_VIDEO, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_VIDEO, 1);
+								ii++;
+								root["result"][ii]["val"] = NTYPE_PHOTO;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PHOTO, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PHOTO, 1);
+								ii++;
+							}
+							if (type == HTYPE_LogitechMediaServer) {
+								root["result"][ii]["val"] = NTYPE_PLAYING;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PLAYING, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PLAYING, 1);
+								ii++;
+								root["result"][ii]["val"] = NTYPE_STOPPED;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_STOPPED, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_STOPPED, 1);
+								ii++;
+							}
+							if (type == HTYPE_HEOS) {
+								root["result"][ii]["val"] = NTYPE_PLAYING;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PLAYING, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PLAYING, 1);
+								ii++;
+								root["result"][ii]["val"] = NTYPE_STOPPED;
+								root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_STOPPED, 0);
+								root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_STOPPED, 1);
+								ii++;
+							}
+						}
+					}
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeAlert))
+			}
+			if (
+				(
+				(dType == pTypeTEMP) ||
+				(dType == pTypeTEMP_HUM) ||
+				(dType == pTypeTEMP_HUM_BARO) ||
+				(dType == pTypeTEMP_BARO) ||
+				(dType == pTypeEvohomeZone) ||
+				(dType == pTypeEvohomeWater) ||
+				(dType == pTypeThermostat1) ||
+				(dType == pTypeRego6XXTemp) ||
+				((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorTemp))
+				) ||
+				((dType == pTypeUV) && (dSubType == sTypeUV3)) ||
+				((dType == pTypeWIND) && (dSubType == sTypeWIND4)) ||
+				((dType == pTypeWIND) && (dSubType == sTypeWINDNoTemp)) ||
+				((dType == pTypeGeneral) && (dSubType == sTypeSystemTemp))
+				)
+			{
+				root["result"][ii]["val"] = NTYPE_TEMPERATURE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 1);
+				ii++;
+			}
+			if (
+				(dType == pTypeHUM) ||
+				(dType == pTypeTEMP_HUM) ||
+				(dType == pTypeTEMP_HUM_BARO)
+				)
+			{
+				root["result"][ii]["val"] = NTYPE_HUMIDITY;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_HUMIDITY, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_HUMIDITY, 1);
+				ii++;
+			}
+			if (
+				(dType == pTypeTEMP_HUM) ||
+				(dType == pTypeTEMP_HUM_BARO)
+				)
+			{
+				root["result"][ii]["val"] = NTYPE_DEWPOINT;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_DEWPOINT, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_DEWPOINT, 1);
+				ii++;
+			}
+			if (dType == pTypeRAIN)
+			{
+				root["result"][ii]["val"] = NTYPE_RAIN;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_RAIN, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_RAIN, 1);
+				ii++;
+			}
+			if (dType == pTypeWIND)
+			{
+				root["result"][ii]["val"] = NTYPE_WIND;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_WIND, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_WIND, 1);
+				ii++;
+			}
+			if (dType == pTypeUV)
+			{
+				root["result"][ii]["val"] = NTYPE_UV;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_UV, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_UV, 1);
+				ii++;
+			}
+			if (
+				(dType == pTypeTEMP_HUM_BARO) ||
+				(dType == pTypeBARO) ||
+				(dType == pTypeTEMP_BARO)
+				)
+			{
+				root["result"][ii]["val"] = NTYPE_BARO;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_BARO, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_BARO, 1);
+				ii++;
+			}
+			if (
+				((dType == pTypeRFXMeter) && (dSubType == sTypeRFXMeterCount)) ||
+                    ((dType == pTypeGeneral) && (dSubType == sTypeCounterIncremental)) ||
+				(dType == pTypeYouLess) ||
+				((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXCounter))
+				)
+			{
+				if ((switchtype == MTYPE_ENERGY)|| (switchtype == MTYPE_ENERGY_GENERATED))
 				{
-					root["result"][ii]["val"] = NTYPE_USAGE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
-					ii++;
+					root["result"][ii]["val"] = NTYPE_TODAYENERGY;
+					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 0);
+					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 1);
 				}
-				if ((dType == pTypeGeneral) && (dSubType == sTypeZWaveAlarm))
+				else if (switchtype == MTYPE_GAS)
 				{
-					root["result"][ii]["val"] = NTYPE_VALUE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_VALUE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_VALUE, 1);
-					ii++;
+					root["result"][ii]["val"] = NTYPE_TODAYGAS;
+					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYGAS, 0);
+					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYGAS, 1);
 				}
-				if ((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXStatus))
+				else if (switchtype == MTYPE_COUNTER)
 				{
-					root["result"][ii]["val"] = NTYPE_SWITCH_ON;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 1);
-					ii++;
-					root["result"][ii]["val"] = NTYPE_SWITCH_OFF;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 1);
-					ii++;
+					root["result"][ii]["val"] = NTYPE_TODAYCOUNTER;
+					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYCOUNTER, 0);
+					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYCOUNTER, 1);
 				}
-				if (!IsLightOrSwitch(dType, dSubType))
+				else
 				{
-					root["result"][ii]["val"] = NTYPE_LASTUPDATE;
-					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
-					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
-					ii++;
+					//water (same as gas)
+					root["result"][ii]["val"] = NTYPE_TODAYGAS;
+					root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYGAS, 0);
+					root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYGAS, 1);
 				}
+				ii++;
 			}
-			else if (cparam == "addnotification")
+			if (dType == pTypeYouLess)
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if (dType == pTypeAirQuality)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			else if ((dType == pTypeGeneral) && ((dSubType == sTypeSoilMoisture) || (dSubType == sTypeLeafWetness)))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeVisibility))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeDistance))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeVoltage))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeCurrent))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypePressure))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeBaro))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if (dType == pTypeLux)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if (dType == pTypeWEIGHT)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if (dType == pTypeUsage)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if (
+				(dType == pTypeENERGY)||
+				((dType == pTypeGeneral)&& (dSubType == sTypeKwh))
+				)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if (dType == pTypePOWER)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeCURRENT) && (dSubType == sTypeELEC1))
+			{
+				root["result"][ii]["val"] = NTYPE_AMPERE1;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE1, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE1, 1);
+				ii++;
+				root["result"][ii]["val"] = NTYPE_AMPERE2;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE2, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE2, 1);
+				ii++;
+				root["result"][ii]["val"] = NTYPE_AMPERE3;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE3, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE3, 1);
+				ii++;
+			}
+			if ((dType == pTypeCURRENTENERGY) && (dSubType == sTypeELEC4))
+			{
+				root["result"][ii]["val"] = NTYPE_AMPERE1;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE1, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE1, 1);
+				ii++;
+				root["result"][ii]["val"] = NTYPE_AMPERE2;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE2, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE2, 1);
+				ii++;
+				root["result"][ii]["val"] = NTYPE_AMPERE3;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_AMPERE3, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_AMPERE3, 1);
+				ii++;
+			}
+			if (dType == pTypeP1Power)
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+				root["result"][ii]["val"] = NTYPE_TODAYENERGY;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYENERGY, 1);
+				ii++;
+			}
+			if (dType == pTypeP1Gas)
+			{
+				root["result"][ii]["val"] = NTYPE_TODAYGAS;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TODAYGAS, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TODAYGAS, 1);
+				ii++;
+			}
+			if ((dType == pTypeThermostat) && (dSubType == sTypeThermSetpoint))
+			{
+				root["result"][ii]["val"] = NTYPE_TEMPERATURE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_TEMPERATURE, 1);
+				ii++;
+			}
+			if (dType == pTypeEvohomeZone)
+			{
+				root["result"][ii]["val"]=NTYPE_TEMPERATURE;
+				root["result"][ii]["text"]=Notification_Type_Desc(NTYPE_SETPOINT,0); //FIXME NTYPE_SETPOINT implementation?
+				root["result"][ii]["ptag"]=Notification_Type_Desc(NTYPE_SETPOINT,1);
+				ii++;
+			}
+			if ((dType == pTypeRFXSensor) && ((dSubType == sTypeRFXSensorAD) || (dSubType == sTypeRFXSensorVolt)))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypePercentage))
+			{
+				root["result"][ii]["val"] = NTYPE_PERCENTAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_PERCENTAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_PERCENTAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeWaterflow))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeCustom))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeFan))
+			{
+				root["result"][ii]["val"] = NTYPE_RPM;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_RPM, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_RPM, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeAlert))
+			{
+				root["result"][ii]["val"] = NTYPE_USAGE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_USAGE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_USAGE, 1);
+				ii++;
+			}
+			if ((dType == pTypeGeneral) && (dSubType == sTypeZWaveAlarm))
+			{
+				root["result"][ii]["val"] = NTYPE_VALUE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_VALUE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_VALUE, 1);
+				ii++;
+			}
+			if ((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXStatus))
+			{
+				root["result"][ii]["val"] = NTYPE_SWITCH_ON;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_ON, 1);
+				ii++;
+				root["result"][ii]["val"] = NTYPE_SWITCH_OFF;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_SWITCH_OFF, 1);
+				ii++;
+			}
+			if (!IsLightOrSwitch(dType, dSubType))
+			{
+				root["result"][ii]["val"] = NTYPE_LASTUPDATE;
+				root["result"][ii]["text"] = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
+				root["result"][ii]["ptag"] = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
+				ii++;
+			}
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
+		void CWebServer::Cmd_AddNotification(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			char szTmp[300];
 
-				std::string stype = request::findValue(&req, "ttype");
-				std::string swhen = request::findValue(&req, "twhen");
-				std::string svalue = request::findValue(&req, "tvalue");
-				std::string scustommessage = request::findValue(&req, "tmsg");
-				std::string sactivesystems = request::findValue(&req, "tsystems");
-				std::string spriority = request::findValue(&req, "tpriority");
-				std::string ssendalways = request::findValue(&req, "tsendalways");
-				if ((stype.empty()) || (swhen.empty()) || (svalue.empty()) || (spriority.empty()) || (ssendalways.empty()))
-					return;
+			std::string idx = request::findValue(&req, "idx");
 
-				_eNotificationTypes ntype = (_eNotificationTypes)atoi(stype.c_str());
-				std::string ttype = Notification_Type_Desc(ntype, 1);
-				if (
-					(ntype == NTYPE_SWITCH_ON) ||
-					(ntype == NTYPE_SWITCH_OFF) ||
-					(ntype == NTYPE_DEWPOINT)
-					)
-				{
-					if ((ntype == NTYPE_SWITCH_ON) && (swhen == "2")) { // '='
-						unsigned char twhen = '=';
-						sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
-					}
-					else
-						strcpy(szTmp, ttype.c_str());
+			std::string stype = request::findValue(&req, "ttype");
+			std::string swhen = request::findValue(&req, "twhen");
+			std::string svalue = request::findValue(&req, "tvalue");
+			std::string scustommessage = request::findValue(&req, "tmsg");
+			std::string sactivesystems = request::findValue(&req, "tsystems");
+			std::string spriority = request::findValue(&req, "tpriority");
+			std::string ssendalways = request::findValue(&req, "tsendalways");
+			if ((stype.empty()) || (swhen.empty()) || (svalue.empty()) || (spriority.empty()) || (ssendalways.empty()))
+				return;
+
+			_eNotificationTypes ntype = (_eNotificationTypes)atoi(stype.c_str());
+			std::string ttype = Notification_Type_Desc(ntype, 1);
+			if (
+				(ntype == NTYPE_SWITCH_ON) ||
+				(ntype == NTYPE_SWITCH_OFF) ||
+				(ntype == NTYPE_DEWPOINT)
+				)
+			{
+				if ((ntype == NTYPE_SWITCH_ON) && (swhen == "2")) { // '='
+					unsigned char twhen = '=';
+					sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
 				}
 				else
-				{
-					unsigned char twhen = '<';
-					if (swhen == "0")
-						twhen = '>';
-					else if (swhen == "1")
-						twhen = 'M';
-					else if (swhen == "2")
+					strcpy(szTmp, ttype.c_str());
+			}
+			else
+			{
+				unsigned char twhen = '<';
+				if (swhen == "0")
+					twhen = '>';
+				else if (swhen == "1")
+					twhen = 'M';
+				else if (swhen == "2")
                                                 twhen = '=';
                                         else if (swhen == "3")
                                                 twhen = 'N';
                                         else if (swhen == "4")
                                                 twhen = 'L';
-					sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
-				}
-				int priority = atoi(spriority.c_str());
-				bool bOK = m_notifications.AddNotification(idx, szTmp, scustommessage, sactivesystems, priority, (ssendalways == "true") ? true : false);
-				if (bOK) {
-					root["status"] = "OK";
-					root["title"] = "AddNotification";
-				}
+				sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
 			}
-			else if (cparam == "updatenotification")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			int priority = atoi(spriority.c_str());
+			bool bOK = m_notifications.AddNotification(idx, szTmp, scustommessage, sactivesystems, priority, (ssendalways == "true") ? true : false);
+			if (bOK) {
+				root["status"] = "OK";
+				root["title"] = "AddNotification";
+			}
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string devidx = request::findValue(&req, "devidx");
-				if ((idx == "") || (devidx == ""))
-					return;
+		void CWebServer::Cmd_UpdateNotification(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			char szTmp[300];
 
-				std::string stype = request::findValue(&req, "ttype");
-				std::string swhen = request::findValue(&req, "twhen");
-				std::string svalue = request::findValue(&req, "tvalue");
-				std::string scustommessage = request::findValue(&req, "tmsg");
-				std::string sactivesystems = request::findValue(&req, "tsystems");
-				std::string spriority = request::findValue(&req, "tpriority");
-				std::string ssendalways = request::findValue(&req, "tsendalways");
+			std::string idx = request::findValue(&req, "idx");
+			std::string devidx = request::findValue(&req, "devidx");
 
-				if ((stype.empty()) || (swhen.empty()) || (svalue.empty()) || (spriority.empty()) || (ssendalways.empty()))
-					return;
-				root["status"] = "OK";
-				root["title"] = "UpdateNotification";
+			std::string stype = request::findValue(&req, "ttype");
+			std::string swhen = request::findValue(&req, "twhen");
+			std::string svalue = request::findValue(&req, "tvalue");
+			std::string scustommessage = request::findValue(&req, "tmsg");
+			std::string sactivesystems = request::findValue(&req, "tsystems");
+			std::string spriority = request::findValue(&req, "tpriority");
+			std::string ssendalways = request::findValue(&req, "tsendalways");
 
-				//delete old record
-				m_notifications.RemoveNotification(idx);
+			if ((stype.empty()) || (swhen.empty()) || (svalue.empty()) || (spriority.empty()) || (ssendalways.empty()))
+				return;
+			root["status"] = "OK";
+			root["title"] = "UpdateNotification";
 
-				_eNotificationTypes ntype = (_eNotificationTypes)atoi(stype.c_str());
-				std::string ttype = Notification_Type_Desc(ntype, 1);
-				if (
-					(ntype == NTYPE_SWITCH_ON) ||
-					(ntype == NTYPE_SWITCH_OFF) ||
-					(ntype == NTYPE_DEWPOINT)
-					)
-				{
-					if ((ntype == NTYPE_SWITCH_ON) && (swhen == "2")) { // '='
-						unsigned char twhen = '=';
-						sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
-					}
-					else
-						strcpy(szTmp, ttype.c_str());
+			//delete old record
+			m_notifications.RemoveNotification(idx);
+
+			_eNotificationTypes ntype = (_eNotificationTypes)atoi(stype.c_str());
+			std::string ttype = Notification_Type_Desc(ntype, 1);
+			if (
+				(ntype == NTYPE_SWITCH_ON) ||
+				(ntype == NTYPE_SWITCH_OFF) ||
+				(ntype == NTYPE_DEWPOINT)
+				)
+			{
+				if ((ntype == NTYPE_SWITCH_ON) && (swhen == "2")) { // '='
+					unsigned char twhen = '=';
+					sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
 				}
 				else
-				{
+					strcpy(szTmp, ttype.c_str());
+			}
+			else
+			{
                                         unsigned char twhen = '<';
                                         if (swhen == "0")
                                                 twhen = '>';
@@ -5656,1584 +6196,1133 @@ namespace http {
                                         else if (swhen == "4")
                                                 twhen = 'L';
                                         sprintf(szTmp, "%s;%c;%s", ttype.c_str(), twhen, svalue.c_str());
-				}
-				int priority = atoi(spriority.c_str());
-				m_notifications.AddNotification(devidx, szTmp, scustommessage, sactivesystems, priority, (ssendalways == "true") ? true : false);
-			}
-			else if (cparam == "deletenotification")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-
-				root["status"] = "OK";
-				root["title"] = "DeleteNotification";
-
-				m_notifications.RemoveNotification(idx);
-			}
-			else if (cparam == "switchdeviceorder")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx1 = request::findValue(&req, "idx1");
-				std::string idx2 = request::findValue(&req, "idx2");
-				if ((idx1 == "") || (idx2 == ""))
-					return;
-				std::string sroomid = request::findValue(&req, "roomid");
-				int roomid = atoi(sroomid.c_str());
-
-				std::string Order1, Order2;
-				if (roomid == 0)
-				{
-					//get device order 1
-					result = m_sql.safe_query("SELECT [Order] FROM DeviceStatus WHERE (ID == '%q')",
-						idx1.c_str());
-					if (result.size() < 1)
-						return;
-					Order1 = result[0][0];
-
-					//get device order 2
-					result = m_sql.safe_query("SELECT [Order] FROM DeviceStatus WHERE (ID == '%q')",
-						idx2.c_str());
-					if (result.size() < 1)
-						return;
-					Order2 = result[0][0];
-
-					root["status"] = "OK";
-					root["title"] = "SwitchDeviceOrder";
-
-					if (atoi(Order1.c_str()) < atoi(Order2.c_str()))
-					{
-						m_sql.safe_query(
-							"UPDATE DeviceStatus SET [Order] = [Order]+1 WHERE ([Order] >= '%q' AND [Order] < '%q')",
-							Order1.c_str(), Order2.c_str());
-					}
-					else
-					{
-						m_sql.safe_query(
-							"UPDATE DeviceStatus SET [Order] = [Order]-1 WHERE ([Order] > '%q' AND [Order] <= '%q')",
-							Order2.c_str(), Order1.c_str());
-					}
-
-					m_sql.safe_query("UPDATE DeviceStatus SET [Order] = '%q' WHERE (ID == '%q')",
-						Order1.c_str(), idx2.c_str());
-				}
-				else
-				{
-					//change order in a room
-					//get device order 1
-					result = m_sql.safe_query("SELECT [Order] FROM DeviceToPlansMap WHERE (DeviceRowID == '%q') AND (PlanID==%d)",
-						idx1.c_str(), roomid);
-					if (result.size() < 1)
-						return;
-					Order1 = result[0][0];
-
-					//get device order 2
-					result = m_sql.safe_query("SELECT [Order] FROM DeviceToPlansMap WHERE (DeviceRowID == '%q') AND (PlanID==%d)",
-						idx2.c_str(), roomid);
-					if (result.size() < 1)
-						return;
-					Order2 = result[0][0];
-
-					root["status"] = "OK";
-					root["title"] = "SwitchDeviceOrder";
-
-					if (atoi(Order1.c_str()) < atoi(Order2.c_str()))
-					{
-						m_sql.safe_query(
-							"UPDATE DeviceToPlansMap SET [Order] = [Order]+1 WHERE ([Order] >= '%q' AND [Order] < '%q') AND (PlanID==%d)",
-							Order1.c_str(), Order2.c_str(), roomid);
-					}
-					else
-					{
-						m_sql.safe_query(
-							"UPDATE DeviceToPlansMap SET [Order] = [Order]-1 WHERE ([Order] > '%q' AND [Order] <= '%q') AND (PlanID==%d)",
-							Order2.c_str(), Order1.c_str(), roomid);
-					}
-
-					m_sql.safe_query("UPDATE DeviceToPlansMap SET [Order] = '%q' WHERE (DeviceRowID == '%q') AND (PlanID==%d)",
-						Order1.c_str(), idx2.c_str(), roomid);
-				}
 			}
-			else if (cparam == "switchsceneorder")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx1 = request::findValue(&req, "idx1");
-				std::string idx2 = request::findValue(&req, "idx2");
-				if ((idx1 == "") || (idx2 == ""))
-					return;
-
-				std::string Order1, Order2;
-				//get device order 1
-				result = m_sql.safe_query("SELECT [Order] FROM Scenes WHERE (ID == '%q')",
-					idx1.c_str());
-				if (result.size() < 1)
-					return;
-				Order1 = result[0][0];
-
-				//get device order 2
-				result = m_sql.safe_query("SELECT [Order] FROM Scenes WHERE (ID == '%q')",
-					idx2.c_str());
-				if (result.size() < 1)
-					return;
-				Order2 = result[0][0];
-
-				root["status"] = "OK";
-				root["title"] = "SwitchSceneOrder";
+			int priority = atoi(spriority.c_str());
+			m_notifications.AddNotification(devidx, szTmp, scustommessage, sactivesystems, priority, (ssendalways == "true") ? true : false);
+		}
 
-				if (atoi(Order1.c_str()) < atoi(Order2.c_str()))
-				{
-					m_sql.safe_query(
-						"UPDATE Scenes SET [Order] = [Order]+1 WHERE ([Order] >= '%q' AND [Order] < '%q')",
-						Order1.c_str(), Order2.c_str());
-				}
-				else
-				{
-					m_sql.safe_query(
-						"UPDATE Scenes SET [Order] = [Order]-1 WHERE ([Order] > '%q' AND [Order] <= '%q')",
-						Order2.c_str(), Order1.c_str());
-				}
+		void CWebServer::Cmd_DeleteNotification(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
 
-				m_sql.safe_query("UPDATE Scenes SET [Order] = '%q' WHERE (ID == '%q')",
-					Order1.c_str(), idx2.c_str());
-			}
-			else if (cparam == "clearnotifications")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			root["status"] = "OK";
+			root["title"] = "DeleteNotification";
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
+			m_notifications.RemoveNotification(idx);
+		}
 
-				root["status"] = "OK";
-				root["title"] = "ClearNotification";
+		void CWebServer::Cmd_SwitchDeviceOrder(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx1 = request::findValue(&req, "idx1");
+			std::string idx2 = request::findValue(&req, "idx2");
+			std::string sroomid = request::findValue(&req, "roomid");
+			int roomid = atoi(sroomid.c_str());
 
-				m_notifications.RemoveDeviceNotifications(idx);
-			}
-			else if (cparam == "addcamera")
+			//idx2 is placed in front of/after idx1, only the order of idx2 is changed
+			if (roomid == 0)
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string name = request::findValue(&req, "name");
-				std::string senabled = request::findValue(&req, "enabled");
-				std::string address = request::findValue(&req, "address");
-				std::string sport = request::findValue(&req, "port");
-				std::string username = request::findValue(&req, "username");
-				std::string password = request::findValue(&req, "password");
-				std::string timageurl = request::findValue(&req, "imageurl");
-				if (
-					(name == "") ||
-					(address == "") ||
-					(timageurl == "")
-					)
+				if (!m_sql.MoveOrder("DeviceStatus", "ID", idx2, idx1, ""))
 					return;
-
-				std::string imageurl;
-				if (request_handler::url_decode(timageurl, imageurl))
-				{
-					imageurl = base64_decode(imageurl);
-
-					int port = atoi(sport.c_str());
-					root["status"] = "OK";
-					root["title"] = "AddCamera";
-					m_sql.safe_query(
-						"INSERT INTO Cameras (Name, Enabled, Address, Port, Username, Password, ImageURL) VALUES ('%q',%d,'%q',%d,'%q','%q','%q')",
-						name.c_str(),
-						(senabled == "true") ? 1 : 0,
-						address.c_str(),
-						port,
-						base64_encode((const unsigned char*)username.c_str(), username.size()).c_str(),
-						base64_encode((const unsigned char*)password.c_str(), password.size()).c_str(),
-						imageurl.c_str()
-						);
-					m_mainworker.m_cameras.ReloadCameras();
-				}
 			}
-			else if (cparam == "updatecamera")
+			else
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				std::string name = request::findValue(&req, "name");
-				std::string senabled = request::findValue(&req, "enabled");
-				std::string address = request::findValue(&req, "address");
-				std::string sport = request::findValue(&req, "port");
-				std::string username = request::findValue(&req, "username");
-				std::string password = request::findValue(&req, "password");
-				std::string timageurl = request::findValue(&req, "imageurl");
-				if (
-					(name == "") ||
-					(senabled == "") ||
-					(address == "") ||
-					(timageurl == "")
-					)
+				//change order in a room
+				std::stringstream sFilter;
+				sFilter << "PlanID==" << roomid;
+				if (!m_sql.MoveOrder("DeviceToPlansMap", "DeviceRowID", idx2, idx1, sFilter.str()))
 					return;
+			}
+			root["status"] = "OK";
+			root["title"] = "SwitchDeviceOrder";
+		}
 
-				std::string imageurl;
-				if (request_handler::url_decode(timageurl, imageurl))
-				{
-					imageurl = base64_decode(imageurl);
+		void CWebServer::Cmd_SwitchSceneOrder(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx1 = request::findValue(&req, "idx1");
+			std::string idx2 = request::findValue(&req, "idx2");
 
-					int port = atoi(sport.c_str());
+			if (!m_sql.MoveOrder("Scenes", "ID", idx2, idx1, ""))
+				return;
+			root["status"] = "OK";
+			root["title"] = "SwitchSceneOrder";
+		}
 
-					root["status"] = "OK";
-					root["title"] = "UpdateCamera";
+		void CWebServer::Cmd_ClearNotifications(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
 
-					m_sql.safe_query(
-						"UPDATE Cameras SET Name='%q', Enabled=%d, Address='%q', Port=%d, Username='%q', Password='%q', ImageURL='%q' WHERE (ID == '%q')",
-						name.c_str(),
-						(senabled == "true") ? 1 : 0,
-						address.c_str(),
-						port,
-						base64_encode((const unsigned char*)username.c_str(), username.size()).c_str(),
-						base64_encode((const unsigned char*)password.c_str(), password.size()).c_str(),
-						imageurl.c_str(),
-						idx.c_str()
-						);
-					m_mainworker.m_cameras.ReloadCameras();
-				}
-			}
-			else if (cparam == "deletecamera")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			root["status"] = "OK";
+			root["title"] = "ClearNotification";
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteCamera";
+			m_notifications.RemoveDeviceNotifications(idx);
+		}
 
-				m_sql.DeleteCamera(idx);
-				m_mainworker.m_cameras.ReloadCameras();
-			}
-			else if (cparam == "adduser")
+		void CWebServer::Cmd_AddCamera(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string name = request::findValue(&req, "name");
+			std::string senabled = request::findValue(&req, "enabled");
+			std::string address = request::findValue(&req, "address");
+			std::string sport = request::findValue(&req, "port");
+			std::string username = request::findValue(&req, "username");
+			std::string password = request::findValue(&req, "password");
+			std::string timageurl = request::findValue(&req, "imageurl");
+
+			std::string imageurl;
+			if (request_handler::url_decode(timageurl, imageurl))
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+				imageurl = base64_decode(imageurl);
 
-				std::string senabled = request::findValue(&req, "enabled");
-				std::string username = request::findValue(&req, "username");
-				std::string password = request::findValue(&req, "password");
-				std::string srights = request::findValue(&req, "rights");
-				std::string sRemoteSharing = request::findValue(&req, "RemoteSharing");
-				std::string sTabsEnabled = request::findValue(&req, "TabsEnabled");
-				if (
-					(senabled == "") ||
-					(username == "") ||
-					(password == "") ||
-					(srights == "") ||
-					(sRemoteSharing == "") ||
-					(sTabsEnabled == "")
-					)
-					return;
-				int rights = atoi(srights.c_str());
-				if (rights != 2)
-				{
-					if (!FindAdminUser())
-					{
-						root["message"] = "Add a Admin user first! (Or enable Settings/Website Protection)";
-						return;
-					}
-				}
+				int port = atoi(sport.c_str());
 				root["status"] = "OK";
-				root["title"] = "AddUser";
+				root["title"] = "AddCamera";
 				m_sql.safe_query(
-					"INSERT INTO Users (Active, Username, Password, Rights, RemoteSharing, TabsEnabled) VALUES (%d,'%q','%q','%d','%d','%d')",
+					"INSERT INTO Cameras (Name, Enabled, Address, Port, Username, Password, ImageURL) VALUES ('%q',%d,'%q',%d,'%q','%q','%q')",
+					name.c_str(),
 					(senabled == "true") ? 1 : 0,
+					address.c_str(),
+					port,
 					base64_encode((const unsigned char*)username.c_str(), username.size()).c_str(),
-					password.c_str(),
-					rights,
-					(sRemoteSharing == "true") ? 1 : 0,
-					atoi(sTabsEnabled.c_str())
+					base64_encode((const unsigned char*)password.c_str(), password.size()).c_str(),
+					imageurl.c_str()
 					);
-				LoadUsers();
+				m_mainworker.m_cameras.ReloadCameras();
 			}
-			else if (cparam == "updateuser")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				std::string senabled = request::findValue(&req, "enabled");
-				std::string username = request::findValue(&req, "username");
-				std::string password = request::findValue(&req, "password");
-				std::string srights = request::findValue(&req, "rights");
-				std::string sRemoteSharing = request::findValue(&req, "RemoteSharing");
-				std::string sTabsEnabled = request::findValue(&req, "TabsEnabled");
-				if (
-					(senabled == "") ||
-					(username == "") ||
-					(password == "") ||
-					(srights == "") ||
-					(sRemoteSharing == "") ||
-					(sTabsEnabled == "")
-					)
-					return;
-				int rights = atoi(srights.c_str());
-				if (rights != 2)
-				{
-					if (!FindAdminUser())
-					{
-						root["message"] = "Add a Admin user first! (Or enable Settings/Website Protection)";
-						return;
-					}
-				}
-				std::string sHashedUsername = base64_encode((const unsigned char*)username.c_str(), username.size()).c_str();
+		void CWebServer::Cmd_UpdateCamera(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string name = request::findValue(&req, "name");
+			std::string senabled = request::findValue(&req, "enabled");
+			std::string address = request::findValue(&req, "address");
+			std::string sport = request::findValue(&req, "port");
+			std::string username = request::findValue(&req, "username");
+			std::string password = request::findValue(&req, "password");
+			std::string timageurl = request::findValue(&req, "imageurl");
+			if (
+				(name == "") ||
+				(senabled == "") ||
+				(address == "") ||
+				(timageurl == "")
+				)
+				return;
 
-				// Invalid user's sessions if username or password has changed
-				std::vector<std::vector<std::string> > result;
-				std::string sOldUsername;
-				std::string sOldPassword;
-				result = m_sql.safe_query("SELECT Username, Password FROM Users WHERE (ID == '%q')", idx.c_str());
-				if (result.size() == 1)
-				{
-					sOldUsername = result[0][0];
-					sOldPassword = result[0][1];
-				}
-				if ((sHashedUsername != sOldUsername) || (password != sOldPassword))
-					RemoveUsersSessions(sOldUsername, session);
+			std::string imageurl;
+			if (request_handler::url_decode(timageurl, imageurl))
+			{
+				imageurl = base64_decode(imageurl);
+
+				int port = atoi(sport.c_str());
 
 				root["status"] = "OK";
-				root["title"] = "UpdateUser";
+				root["title"] = "UpdateCamera";
+
 				m_sql.safe_query(
-					"UPDATE Users SET Active=%d, Username='%q', Password='%q', Rights=%d, RemoteSharing=%d, TabsEnabled=%d WHERE (ID == '%q')",
+					"UPDATE Cameras SET Name='%q', Enabled=%d, Address='%q', Port=%d, Username='%q', Password='%q', ImageURL='%q' WHERE (ID == '%q')",
+					name.c_str(),
 					(senabled == "true") ? 1 : 0,
-					sHashedUsername.c_str(),
-					password.c_str(),
-					rights,
-					(sRemoteSharing == "true") ? 1 : 0,
-					atoi(sTabsEnabled.c_str()),
+					address.c_str(),
+					port,
+					base64_encode((const unsigned char*)username.c_str(), username.size()).c_str(),
+					base64_encode((const unsigned char*)password.c_str(), password.size()).c_str(),
+					imageurl.c_str(),
 					idx.c_str()
 					);
-				LoadUsers();
-
-
+				m_mainworker.m_cameras.ReloadCameras();
 			}
-			else if (cparam == "deleteuser")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
+		void CWebServer::Cmd_DeleteCamera(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteCamera";
 
-				root["status"] = "OK";
-				root["title"] = "DeleteUser";
+			m_sql.DeleteCamera(idx);
+			m_mainworker.m_cameras.ReloadCameras();
+		}
 
-				// Remove user's sessions
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT Username FROM Users WHERE (ID == '%q')", idx.c_str());
-				if (result.size() == 1)
+		void CWebServer::Cmd_AddUser(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string senabled = request::findValue(&req, "enabled");
+			std::string username = request::findValue(&req, "username");
+			std::string password = request::findValue(&req, "password");
+			std::string srights = request::findValue(&req, "rights");
+			std::string sRemoteSharing = request::findValue(&req, "RemoteSharing");
+			std::string sTabsEnabled = request::findValue(&req, "TabsEnabled");
+			int rights = atoi(srights.c_str());
+			if (rights != 2)
+			{
+				if (!FindAdminUser())
 				{
-					RemoveUsersSessions(result[0][0], session);
+					root["message"] = "Add a Admin user first! (Or enable Settings/Website Protection)";
+					return;
 				}
-
-				m_sql.safe_query("DELETE FROM Users WHERE (ID == '%q')", idx.c_str());
-
-				m_sql.safe_query("DELETE FROM SharedDevices WHERE (SharedUserID == '%q')",
-					idx.c_str());
-
-				LoadUsers();
 			}
-			else if (cparam == "clearlightlog")
+			root["status"] = "OK";
+			root["title"] = "AddUser";
+			m_sql.safe_query(
+				"INSERT INTO Users (Active, Username, Password, Rights, RemoteSharing, TabsEnabled) VALUES (%d,'%q','%q','%d','%d','%d')",
+				(senabled == "true") ? 1 : 0,
+				base64_encode((const unsigned char*)username.c_str(), username.size()).c_str(),
+				password.c_str(),
+				rights,
+				(sRemoteSharing == "true") ? 1 : 0,
+				atoi(sTabsEnabled.c_str())
+				);
+			LoadUsers();
+		}
+
+		void CWebServer::Cmd_UpdateUser(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string senabled = request::findValue(&req, "enabled");
+			std::string username = request::findValue(&req, "username");
+			std::string password = request::findValue(&req, "password");
+			std::string srights = request::findValue(&req, "rights");
+			std::string sRemoteSharing = request::findValue(&req, "RemoteSharing");
+			std::string sTabsEnabled = request::findValue(&req, "TabsEnabled");
+			if (
+				(senabled == "") ||
+				(username == "") ||
+				(password == "") ||
+				(srights == "") ||
+				(sRemoteSharing == "") ||
+				(sTabsEnabled == "")
+				)
+				return;
+			int rights = atoi(srights.c_str());
+			if (rights != 2)
 			{
-				if (session.rights < 2)
+				if (!FindAdminUser())
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
+					root["message"] = "Add a Admin user first! (Or enable Settings/Website Protection)";
+					return;
 				}
+			}
+			std::string sHashedUsername = base64_encode((const unsigned char*)username.c_str(), username.size()).c_str();
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				//First get Device Type/SubType
-				result = m_sql.safe_query("SELECT Type, SubType FROM DeviceStatus WHERE (ID == '%q')",
-					idx.c_str());
-				if (result.size() < 1)
-					return;
+			// Invalid user's sessions if username or password has changed
+			std::vector<std::vector<std::string> > result;
+			std::string sOldUsername;
+			std::string sOldPassword;
+			result = m_sql.safe_query("SELECT Username, Password FROM Users WHERE (ID == '%q')", idx.c_str());
+			if (result.size() == 1)
+			{
+				sOldUsername = result[0][0];
+				sOldPassword = result[0][1];
+			}
+			if ((sHashedUsername != sOldUsername) || (password != sOldPassword))
+				RemoveUsersSessions(sOldUsername, session);
 
-				unsigned char dType = atoi(result[0][0].c_str());
-				unsigned char dSubType = atoi(result[0][1].c_str());
+			root["status"] = "OK";
+			root["title"] = "UpdateUser";
+			m_sql.safe_query(
+				"UPDATE Users SET Active=%d, Username='%q', Password='%q', Rights=%d, RemoteSharing=%d, TabsEnabled=%d WHERE (ID == '%q')",
+				(senabled == "true") ? 1 : 0,
+				sHashedUsername.c_str(),
+				password.c_str(),
+				rights,
+				(sRemoteSharing == "true") ? 1 : 0,
+				atoi(sTabsEnabled.c_str()),
+				idx.c_str()
+				);
+			LoadUsers();
+		}
 
-				if (
-					(dType != pTypeLighting1) &&
-					(dType != pTypeLighting2) &&
-					(dType != pTypeLighting3) &&
-					(dType != pTypeLighting4) &&
-					(dType != pTypeLighting5) &&
-					(dType != pTypeLighting6) &&
-					(dType != pTypeFan) &&
-					(dType != pTypeLimitlessLights) &&
-					(dType != pTypeSecurity1) &&
-					(dType != pTypeSecurity2) &&
-					(dType != pTypeEvohome) &&
-					(dType != pTypeEvohomeRelay) &&
-					(dType != pTypeCurtain) &&
-					(dType != pTypeBlinds) &&
-					(dType != pTypeRFY) &&
-					(dType != pTypeChime) &&
-					(dType != pTypeThermostat2) &&
-					(dType != pTypeThermostat3) &&
-					(dType != pTypeThermostat4) &&
-					(dType != pTypeRemote) &&
-					(dType != pTypeGeneralSwitch) &&
-					(dType != pTypeHomeConfort) &&
-					(!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator)))&&
-					(!((dType == pTypeGeneral) && (dSubType == sTypeTextStatus))) &&
-					(!((dType == pTypeGeneral) && (dSubType == sTypeAlert)))
-					)
-					return; //no light device! we should not be here!
+		void CWebServer::Cmd_DeleteUser(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
 
-				root["status"] = "OK";
-				root["title"] = "ClearLightLog";
+			root["status"] = "OK";
+			root["title"] = "DeleteUser";
 
-				result = m_sql.safe_query("DELETE FROM LightingLog WHERE (DeviceRowID=='%q')", idx.c_str());
-			}
-			else if (cparam == "clearscenelog")
+			// Remove user's sessions
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT Username FROM Users WHERE (ID == '%q')", idx.c_str());
+			if (result.size() == 1)
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+				RemoveUsersSessions(result[0][0], session);
+			}
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "ClearSceneLog";
+			m_sql.safe_query("DELETE FROM Users WHERE (ID == '%q')", idx.c_str());
 
-				result = m_sql.safe_query("DELETE FROM SceneLog WHERE (SceneRowID=='%q')", idx.c_str());
-			}
-			else if (cparam == "learnsw")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			m_sql.safe_query("DELETE FROM SharedDevices WHERE (SharedUserID == '%q')",
+				idx.c_str());
 
-				m_sql.AllowNewHardwareTimer(5);
-				m_sql.m_LastSwitchID = "";
-				bool bReceivedSwitch = false;
-				unsigned char cntr = 0;
-				while ((!bReceivedSwitch) && (cntr < 50))	//wait for max. 5 seconds
-				{
-					if (m_sql.m_LastSwitchID != "")
-					{
-						bReceivedSwitch = true;
-						break;
-					}
-					else
-					{
-						//sleep 100ms
-						sleep_milliseconds(100);
-						cntr++;
-					}
-				}
-				if (bReceivedSwitch)
-				{
-					//check if used
-					result = m_sql.safe_query("SELECT Name, Used, nValue FROM DeviceStatus WHERE (ID==%" PRIu64 ")",
-						m_sql.m_LastSwitchRowID);
-					if (result.size() > 0)
-					{
-						root["status"] = "OK";
-						root["title"] = "LearnSW";
-						root["ID"] = m_sql.m_LastSwitchID;
-						root["idx"] = m_sql.m_LastSwitchRowID;
-						root["Name"] = result[0][0];
-						root["Used"] = atoi(result[0][1].c_str());
-						root["Cmd"] = atoi(result[0][2].c_str());
-					}
-				}
-			} //learnsw
-			else if (cparam == "makefavorite")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			LoadUsers();
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string sisfavorite = request::findValue(&req, "isfavorite");
-				if ((idx == "") || (sisfavorite == ""))
-					return;
-				int isfavorite = atoi(sisfavorite.c_str());
-				m_sql.safe_query("UPDATE DeviceStatus SET Favorite=%d WHERE (ID == '%q')",
-					isfavorite, idx.c_str());
-				root["status"] = "OK";
-				root["title"] = "MakeFavorite";
-			} //makefavorite
-			else if (cparam == "makescenefavorite")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		void CWebServer::Cmd_ClearLightLog(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string sisfavorite = request::findValue(&req, "isfavorite");
-				if ((idx == "") || (sisfavorite == ""))
-					return;
-				int isfavorite = atoi(sisfavorite.c_str());
-				m_sql.safe_query("UPDATE Scenes SET Favorite=%d WHERE (ID == '%q')",
-					isfavorite, idx.c_str());
-				root["status"] = "OK";
-				root["title"] = "MakeSceneFavorite";
-			} //makescenefavorite
-			else if (cparam == "resetsecuritystatus")
-			{
-				std::string idx = request::findValue(&req, "idx");
-				std::string switchcmd = request::findValue(&req, "switchcmd");
+			std::string idx = request::findValue(&req, "idx");
+			//First get Device Type/SubType
+			result = m_sql.safe_query("SELECT Type, SubType FROM DeviceStatus WHERE (ID == '%q')",
+				idx.c_str());
+			if (result.size() < 1)
+				return;
+
+			unsigned char dType = atoi(result[0][0].c_str());
+			unsigned char dSubType = atoi(result[0][1].c_str());
+
+			if (
+				(dType != pTypeLighting1) &&
+				(dType != pTypeLighting2) &&
+				(dType != pTypeLighting3) &&
+				(dType != pTypeLighting4) &&
+				(dType != pTypeLighting5) &&
+				(dType != pTypeLighting6) &&
+				(dType != pTypeFan) &&
+				(dType != pTypeLimitlessLights) &&
+				(dType != pTypeSecurity1) &&
+				(dType != pTypeSecurity2) &&
+				(dType != pTypeEvohome) &&
+				(dType != pTypeEvohomeRelay) &&
+				(dType != pTypeCurtain) &&
+				(dType != pTypeBlinds) &&
+				(dType != pTypeRFY) &&
+				(dType != pTypeChime) &&
+				(dType != pTypeThermostat2) &&
+				(dType != pTypeThermostat3) &&
+				(dType != pTypeThermostat4) &&
+				(dType != pTypeRemote) &&
+				(dType != pTypeGeneralSwitch) &&
+				(dType != pTypeHomeConfort) &&
+				(!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator)))&&
+				(!((dType == pTypeGeneral) && (dSubType == sTypeTextStatus))) &&
+				(!((dType == pTypeGeneral) && (dSubType == sTypeAlert)))
+				)
+				return; //no light device! we should not be here!
+
+			root["status"] = "OK";
+			root["title"] = "ClearLightLog";
 
-				if ((idx == "") || (switchcmd == ""))
-					return;
+			result = m_sql.safe_query("DELETE FROM LightingLog WHERE (DeviceRowID=='%q')", idx.c_str());
+		}
 
-				root["status"] = "OK";
-				root["title"] = "ResetSecurityStatus";
+		void CWebServer::Cmd_ClearSceneLog(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-				int nValue = -1;
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "ClearSceneLog";
 
-				// Change to generic *Security_Status_Desc lookup...
+			result = m_sql.safe_query("DELETE FROM SceneLog WHERE (SceneRowID=='%q')", idx.c_str());
+		}
 
-				if (switchcmd == "Panic End") {
-					nValue = 7;
-				}
-				else if (switchcmd == "Normal") {
-					nValue = 0;
-				}
+		void CWebServer::Cmd_LearnSwitch(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-				if (nValue >= 0)
+			m_sql.AllowNewHardwareTimer(5);
+			m_sql.m_LastSwitchID = "";
+			bool bReceivedSwitch = false;
+			unsigned char cntr = 0;
+			while ((!bReceivedSwitch) && (cntr < 50))	//wait for max. 5 seconds
+			{
+				if (m_sql.m_LastSwitchID != "")
 				{
-					m_sql.safe_query("UPDATE DeviceStatus SET nValue=%d WHERE (ID == '%q')",
-						nValue, idx.c_str());
-					root["status"] = "OK";
-					root["title"] = "SwitchLight";
+					bReceivedSwitch = true;
+					break;
 				}
-			}
-			else if (cparam == "verifypasscode")
-			{
-				std::string passcode = request::findValue(&req, "passcode");
-				if (passcode == "")
-					return;
-				//Check if passcode is correct
-				passcode = GenerateMD5Hash(passcode);
-				std::string rpassword;
-				int nValue = 1;
-				m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
-				if (passcode == rpassword)
+				else
 				{
-					root["title"] = "VerifyPasscode";
-					root["status"] = "OK";
-					return;
+					//sleep 100ms
+					sleep_milliseconds(100);
+					cntr++;
 				}
 			}
-			else if (cparam=="switchmodal")
+			if (bReceivedSwitch)
 			{
-				int urights=3;
-				if (bHaveUser)
+				//check if used
+				result = m_sql.safe_query("SELECT Name, Used, nValue FROM DeviceStatus WHERE (ID==%" PRIu64 ")",
+					m_sql.m_LastSwitchRowID);
+				if (result.size() > 0)
 				{
-					int iUser=-1;
-					iUser=FindUser(session.username.c_str());
-					if (iUser != -1)
-					{
-						urights = (int)m_users[iUser].userrights;
-						_log.Log(LOG_STATUS, "User: %s initiated a modal command", m_users[iUser].Username.c_str());
-					}
+					root["status"] = "OK";
+					root["title"] = "LearnSW";
+					root["ID"] = m_sql.m_LastSwitchID;
+					root["idx"] = m_sql.m_LastSwitchRowID;
+					root["Name"] = result[0][0];
+					root["Used"] = atoi(result[0][1].c_str());
+					root["Cmd"] = atoi(result[0][2].c_str());
 				}
-				if (urights<1)
-					return;
+			}
+		}
 
-				std::string idx=request::findValue(&req, "idx");
-				std::string switchcmd=request::findValue(&req, "status");
-				std::string until=request::findValue(&req, "until");//optional until date / time as applicable
-				std::string action=request::findValue(&req, "action");//Run action or not (update status only)
-				std::string onlyonchange=request::findValue(&req, "ooc");//No update unless the value changed (check if updated)
-				//The on action is used to call a script to update the real device so we only want to use it when altering the status in the Domoticz Web Client
-				//If we're posting the status from the real device to domoticz we don't want to run the on action script ("action"!=1) to avoid loops and contention
-				//""... we only want to log a change (and trigger an event) when the status has actually changed ("ooc"==1) i.e. suppress non transient updates
-				if ((idx=="")||(switchcmd==""))
-					return;
+		void CWebServer::Cmd_MakeFavorite(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string sisfavorite = request::findValue(&req, "isfavorite");
+			int isfavorite = atoi(sisfavorite.c_str());
+			m_sql.safe_query("UPDATE DeviceStatus SET Favorite=%d WHERE (ID == '%q')",
+				isfavorite, idx.c_str());
+			root["status"] = "OK";
+			root["title"] = "MakeFavorite";
+		}
 
-				std::string passcode=request::findValue(&req, "passcode");
-				if (passcode.size()>0)
-				{
-					//Check if passcode is correct
-					passcode = GenerateMD5Hash(passcode);
-					std::string rpassword;
-					int nValue=1;
-					m_sql.GetPreferencesVar("ProtectionPassword",nValue,rpassword);
-					if (passcode!=rpassword)
-					{
-						root["title"]="Modal";
-						root["status"]="ERROR";
-						root["message"]="WRONG CODE";
-						return;
-					}
-				}
+		void CWebServer::Cmd_MakeSceneFavorite(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string sisfavorite = request::findValue(&req, "isfavorite");
+			int isfavorite = atoi(sisfavorite.c_str());
+			m_sql.safe_query("UPDATE Scenes SET Favorite=%d WHERE (ID == '%q')",
+				isfavorite, idx.c_str());
+			root["status"] = "OK";
+			root["title"] = "MakeSceneFavorite";
+		}
 
-				if (m_mainworker.SwitchModal(idx,switchcmd,action,onlyonchange,until)==true)//FIXME we need to return a status of already set / no update if ooc=="1" and no status update was performed
-				{
-					root["status"]="OK";
-					root["title"]="Modal";
-				}
-			}
-			else if (cparam == "switchlight")
-			{
-				if (session.rights < 1)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only user/admin allowed
-				}
-				std::string Username = "Admin";
-				if (!session.username.empty())
-					Username = session.username;
-
-				std::string idx = request::findValue(&req, "idx");
-				std::string switchcmd = request::findValue(&req, "switchcmd");
-				std::string level = request::findValue(&req, "level");
-				std::string onlyonchange=request::findValue(&req, "ooc");//No update unless the value changed (check if updated)
-				if (_log.isTraceEnabled()) _log.Log(LOG_TRACE,"WEBS switchlight idx:%s switchcmd:%s level:%s",  idx.c_str() , switchcmd.c_str() , level.c_str());
-				std::string passcode = request::findValue(&req, "passcode");
-				if ((idx == "") || (switchcmd == ""))
-					return;
+		void CWebServer::Cmd_ResetSecurityStatus(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string switchcmd = request::findValue(&req, "switchcmd");
 
-				result = m_sql.safe_query(
-					"SELECT [Protected],[Name] FROM DeviceStatus WHERE (ID = '%q')", idx.c_str());
-				if (result.empty())
-				{
-					//Switch not found!
-					return;
-				}
-				bool bIsProtected = atoi(result[0][0].c_str()) != 0;
-				std::string sSwitchName  = result[0][1];
+			root["status"] = "OK";
+			root["title"] = "ResetSecurityStatus";
 
-				if (bIsProtected)
-				{
-					if (passcode.empty())
-					{
-						//Switch is protected, but no passcode has been
-						root["title"] = "SwitchLight";
-						root["status"] = "ERROR";
-						root["message"] = "WRONG CODE";
-						return;
-					}
-					//Check if passcode is correct
-					passcode = GenerateMD5Hash(passcode);
-					std::string rpassword;
-					int nValue = 1;
-					m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
-					if (passcode != rpassword)
-					{
-						_log.Log(LOG_ERROR, "User: %s initiated a switch command (Wrong code!)", Username.c_str());
-						root["title"] = "SwitchLight";
-						root["status"] = "ERROR";
-						root["message"] = "WRONG CODE";
-						return;
-					}
-				}
+			int nValue = -1;
 
-				_log.Log(LOG_STATUS, "User: %s initiated a switch command (%s/%s/%s)", Username.c_str(), idx.c_str(), sSwitchName.c_str(), switchcmd.c_str());
+			// Change to generic *Security_Status_Desc lookup...
 
-				if (switchcmd == "Toggle") {
-					//Request current state of switch
-					result = m_sql.safe_query(
-						"SELECT [Type],[SubType],SwitchType,nValue,sValue FROM DeviceStatus WHERE (ID = '%q')", idx.c_str());
-					if (result.size() > 0)
-					{
-						std::vector<std::string> sd = result[0];
-						unsigned char devType = (unsigned char)atoi(sd[0].c_str());
-						unsigned char subType = (unsigned char)atoi(sd[1].c_str());
-						_eSwitchType switchtype = (_eSwitchType)atoi(sd[2].c_str());
-						int nValue = atoi(sd[3].c_str());
-						std::string sValue = sd[4];
-						std::string lstatus = "";
-						int llevel = 0;
-						bool bHaveDimmer = false;
-						bool bHaveGroupCmd = false;
-						int maxDimLevel = 0;
-						GetLightStatus(devType, subType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-						switchcmd = (IsLightSwitchOn(lstatus) == true) ? "Off" : "On";
-					}
-				}
+			if (switchcmd == "Panic End") {
+				nValue = 7;
+			}
+			else if (switchcmd == "Normal") {
+				nValue = 0;
+			}
+
+			if (nValue >= 0)
+			{
+				m_sql.safe_query("UPDATE DeviceStatus SET nValue=%d WHERE (ID == '%q')",
+					nValue, idx.c_str());
+				root["status"] = "OK";
 				root["title"] = "SwitchLight";
-				if (m_mainworker.SwitchLight(idx, switchcmd, level, "-1", onlyonchange, 0) == true)
-				{
-					root["status"] = "OK";
-				}
-				else
-				{
-					root["status"] = "ERROR";
-					root["message"] = "Error sending switch command, check device/hardware !";
-				}
-			} //(rtype=="switchlight")
-			else if (cparam == "switchscene")
+			}
+		}
+
+		void CWebServer::Cmd_VerifyPasscode(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string passcode = request::findValue(&req, "passcode");
+			//Check if passcode is correct
+			passcode = GenerateMD5Hash(passcode);
+			std::string rpassword;
+			int nValue = 1;
+			m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
+			if (passcode == rpassword)
+			{
+				root["title"] = "VerifyPasscode";
+				root["status"] = "OK";
+				return;
+			}
+		}
+
+		void CWebServer::Cmd_SwitchModal(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			bool bHaveUser = (session.username != "");
+
+			int urights=3;
+			if (bHaveUser)
 			{
-				if (session.rights < 1)
+				int iUser=-1;
+				iUser=FindUser(session.username.c_str());
+				if (iUser != -1)
 				{
-					session.reply_status = reply::forbidden;
-					return; //Only user/admin allowed
+					urights = (int)m_users[iUser].userrights;
+					_log.Log(LOG_STATUS, "User: %s initiated a modal command", m_users[iUser].Username.c_str());
 				}
-				std::string Username = "Admin";
-				if (!session.username.empty())
-					Username = session.username;
+			}
+			if (urights<1)
+				return;
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string switchcmd = request::findValue(&req, "switchcmd");
-				std::string passcode = request::findValue(&req, "passcode");
-				if ((idx == "") || (switchcmd == ""))
-					return;
+			std::string idx=request::findValue(&req, "idx");
+			std::string switchcmd=request::findValue(&req, "status");
+			std::string until=request::findValue(&req, "until");//optional until date / time as applicable
+			std::string action=request::findValue(&req, "action");//Run action or not (update status only)
+			std::string onlyonchange=request::findValue(&req, "ooc");//No update unless the value changed (check if updated)
+			//The on action is used to call a script to update the real device so we only want to use it when altering the status in the Domoticz Web Client
+			//If we're posting the status from the real device to domoticz we don't want to run the on action script ("action"!=1) to avoid loops and contention
+			//""... we only want to log a change (and trigger an event) when the status has actually changed ("ooc"==1) i.e. suppress non transient updates
+			if ((idx=="")||(switchcmd==""))
+				return;
 
-				result = m_sql.safe_query(
-					"SELECT [Protected] FROM Scenes WHERE (ID = '%q')", idx.c_str());
-				if (result.empty())
+			std::string passcode=request::findValue(&req, "passcode");
+			if (passcode.size()>0)
+			{
+				//Check if passcode is correct
+				passcode = GenerateMD5Hash(passcode);
+				std::string rpassword;
+				int nValue=1;
+				m_sql.GetPreferencesVar("ProtectionPassword",nValue,rpassword);
+				if (passcode!=rpassword)
 				{
-					//Scene/Group not found!
+					root["title"]="Modal";
+					root["status"]="ERROR";
+					root["message"]="WRONG CODE";
 					return;
 				}
-				bool bIsProtected = atoi(result[0][0].c_str()) != 0;
-				if (bIsProtected)
-				{
-					if (passcode.empty())
-					{
-						root["title"] = "SwitchScene";
-						root["status"] = "ERROR";
-						root["message"] = "WRONG CODE";
-						return;
-					}
-					//Check if passcode is correct
-					passcode = GenerateMD5Hash(passcode);
-					std::string rpassword;
-					int nValue = 1;
-					m_sql.GetPreferencesVar("ProtectionPassword", nValue, rpassword);
-					if (passcode != rpassword)
-					{
-						root["title"] = "SwitchScene";
-						root["status"] = "ERROR";
-						root["message"] = "WRONG CODE";
-						_log.Log(LOG_ERROR, "User: %s initiated a scene/group command (Wrong code!)", Username.c_str());
-						return;
-					}
-				}
-				_log.Log(LOG_STATUS, "User: %s initiated a scene/group command", Username.c_str());
-
-				if (m_mainworker.SwitchScene(idx, switchcmd) == true)
-				{
-					root["status"] = "OK";
-					root["title"] = "SwitchScene";
-				}
-			} //(rtype=="switchscene")
-			else if (cparam == "getSunRiseSet") {
-				if (!m_mainworker.m_LastSunriseSet.empty())
-				{
-					std::vector<std::string> strarray;
-					StringSplit(m_mainworker.m_LastSunriseSet, ";", strarray);
-					if (strarray.size() == 2)
-					{
-						struct tm loctime;
-						time_t now = mytime(NULL);
-
-						localtime_r(&now, &loctime);
-						//strftime(szTmp, 80, "%b %d %Y %X", &loctime);
-						strftime(szTmp, 80, "%Y-%m-%d %X", &loctime);
+			}
 
-						root["status"] = "OK";
-						root["title"] = "getSunRiseSet";
-						root["ServerTime"] = szTmp;
-						root["Sunrise"] = strarray[0];
-						root["Sunset"] = strarray[1];
-					}
-				}
+			if (m_mainworker.SwitchModal(idx,switchcmd,action,onlyonchange,until)==true)//FIXME we need to return a status of already set / no update if ooc=="1" and no status update was performed
+			{
+				root["status"]="OK";
+				root["title"]="Modal";
 			}
-			else if (cparam == "getServerTime") {
+		}
 
-				struct tm loctime;
-				time_t now = mytime(NULL);
+		void CWebServer::Cmd_SetColBrightnessValue(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
 
-				localtime_r(&now, &loctime);
-				//strftime(szTmp, 80, "%b %d %Y %X", &loctime);
-				strftime(szTmp, 80, "%Y-%m-%d %X", &loctime);
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				root["status"] = "OK";
-				root["title"] = "getServerTime";
-				root["ServerTime"] = szTmp;
-			}
-			else if (cparam == "getsecstatus")
+			std::string hex = request::findValue(&req, "hex");
+			std::string hue = request::findValue(&req, "hue");
+			std::string brightness = request::findValue(&req, "brightness");
+			std::string iswhite = request::findValue(&req, "iswhite");
+
+			if (!hex.empty())
 			{
-				root["status"] = "OK";
-				root["title"] = "GetSecStatus";
-				int secstatus = 0;
-				m_sql.GetPreferencesVar("SecStatus", secstatus);
-				root["secstatus"] = secstatus;
+				std::stringstream sstr;
+				sstr << hex;
+				int ihex;
+				sstr >> std::hex >> ihex;
+				unsigned char r = (unsigned char)((ihex & 0xFF0000) >> 16);
+				unsigned char g = (unsigned char)((ihex & 0x00FF00) >> 8);
+				unsigned char b = (unsigned char)ihex & 0xFF;
+				float hsb[3];
+				rgb2hsb(r, g, b, hsb);
+				hsb[0] *= 360.0;
+				hsb[1] *= 255.0;
+				hsb[2] *= 100.0;
+				char szConv[20];
+				sprintf(szConv, "%d", (int)hsb[0]);
+				hue = szConv;
+				//sprintf(szConv, "%d", (int)hsb[1]);
+				//sat = szConv;
+				iswhite = (hsb[1] < 20.0) ? "true" : "false";
+				sprintf(szConv, "%d", (int)hsb[2]);
+				brightness = szConv;
+			}
+			if (hue.empty() || brightness.empty() || iswhite.empty())
+			{
+				return;
 			}
-			else if (cparam == "setsecstatus")
+
+			if (iswhite != "true")
 			{
-				std::string ssecstatus = request::findValue(&req, "secstatus");
-				std::string seccode = request::findValue(&req, "seccode");
-				if ((ssecstatus == "") || (seccode == ""))
-				{
-					root["message"] = "WRONG CODE";
-					return;
-				}
-				root["title"] = "SetSecStatus";
-				std::string rpassword;
-				int nValue = 1;
-				m_sql.GetPreferencesVar("SecPassword", nValue, rpassword);
-				if (seccode != rpassword)
-				{
-					root["status"] = "ERROR";
-					root["message"] = "WRONG CODE";
-					return;
-				}
-				root["status"] = "OK";
-				int iSecStatus = atoi(ssecstatus.c_str());
-				m_mainworker.UpdateDomoticzSecurityStatus(iSecStatus);
+				//convert hue from 360 steps to 255
+				double dval;
+				dval = (255.0 / 360.0)*atof(hue.c_str());
+				int ival;
+				ival = round(dval);
+				m_mainworker.SwitchLight(ID, "Set Color", ival, -1,false,0);
 			}
-			else if (cparam == "setcolbrightnessvalue")
+			else
 			{
-				std::string idx = request::findValue(&req, "idx");
-
-				if (idx.empty())
-				{
-					return;
-				}
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+				m_mainworker.SwitchLight(ID, "Set White", 0, -1,false,0);
+			}
+			sleep_milliseconds(100);
+			m_mainworker.SwitchLight(ID, "Set Brightness", (unsigned char)atoi(brightness.c_str()), -1,false,0);
+			root["status"] = "OK";
+			root["title"] = "SetColBrightnessValue";
+		}
 
-				std::string hex = request::findValue(&req, "hex");
-				std::string hue = request::findValue(&req, "hue");
-				std::string brightness = request::findValue(&req, "brightness");
-				std::string iswhite = request::findValue(&req, "iswhite");
+		void CWebServer::Cmd_SetKelvinLevel(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set Kelvin Level";
 
-				if (!hex.empty())
-				{
-					std::stringstream sstr;
-					sstr << hex;
-					int ihex;
-					sstr >> std::hex >> ihex;
-					unsigned char r = (unsigned char)((ihex & 0xFF0000) >> 16);
-					unsigned char g = (unsigned char)((ihex & 0x00FF00) >> 8);
-					unsigned char b = (unsigned char)ihex & 0xFF;
-					float hsb[3];
-					rgb2hsb(r, g, b, hsb);
-					hsb[0] *= 360.0;
-					hsb[1] *= 255.0;
-					hsb[2] *= 100.0;
-					char szConv[20];
-					sprintf(szConv, "%d", (int)hsb[0]);
-					hue = szConv;
-					//sprintf(szConv, "%d", (int)hsb[1]);
-					//sat = szConv;
-					iswhite = (hsb[1] < 20.0) ? "true" : "false";
-					sprintf(szConv, "%d", (int)hsb[2]);
-					brightness = szConv;
-				}
-				if (hue.empty() || brightness.empty() || iswhite.empty())
-				{
-					return;
-				}
+			std::string idx = request::findValue(&req, "idx");
 
-				if (iswhite != "true")
-				{
-					//convert hue from 360 steps to 255
-					double dval;
-					dval = (255.0 / 360.0)*atof(hue.c_str());
-					int ival;
-					ival = round(dval);
-					m_mainworker.SwitchLight(ID, "Set Color", ival, -1,false,0);
-				}
-				else
-				{
-					m_mainworker.SwitchLight(ID, "Set White", 0, -1,false,0);
-				}
-				sleep_milliseconds(100);
-				m_mainworker.SwitchLight(ID, "Set Brightness", (unsigned char)atoi(brightness.c_str()), -1,false,0);
-				root["status"] = "OK";
-				root["title"] = "SetColBrightnessValue";
-			}
-			else if (cparam.find("setkelvinlevel") == 0)
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set Kelvin Level";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			std::string kelvin = request::findValue(&req, "kelvin");
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+			int ival;
+			//ival = atof(cparam.substr(14).c_str());
+			ival = atof(kelvin.c_str());
 
-				std::string kelvin = request::findValue(&req, "kelvin");
+			m_mainworker.SwitchLight(ID, "Set Kelvin Level", ival, -1,false,0);
+		}
 
-				int ival;
-				//ival = atof(cparam.substr(14).c_str());
-				ival = atof(kelvin.c_str());
+		void CWebServer::Cmd_BrightnessUp(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set brightness up!";
 
-				m_mainworker.SwitchLight(ID, "Set Kelvin Level", ival, -1,false,0);
-			}
-			else if (cparam == "brightnessup")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set brightness up!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Bright Up", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_BrightnessDown(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set brightness down!";
 
-				m_mainworker.SwitchLight(ID, "Bright Up", 0, -1,false,0);
-			}
-			else if (cparam == "brightnessdown")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set brightness down!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Bright Down", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_DiscoMode(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set to last known disco mode!";
 
-				m_mainworker.SwitchLight(ID, "Bright Down", 0, -1,false,0);
-			}
-			else if (cparam == "discomode")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set to last known disco mode!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Disco Mode", 0, -1, false, 0);
+		}
+
+		void CWebServer::Cmd_DiscoModeNum(WebEmSession & session, const request& req, Json::Value &root, const int mode)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set to disco mode!";
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+			std::string idx = request::findValue(&req, "idx");
 
-				m_mainworker.SwitchLight(ID, "Disco Mode", 0, -1, false, 0);
-			}
-			else if (cparam.find("discomodenum") == 0 && cparam != "discomode" && cparam.size()==13)
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set to disco mode!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			char szTmp[40];
+			sprintf(szTmp, "Disco Mode %d", mode);
+			m_mainworker.SwitchLight(ID, szTmp, 0, -1, false, 0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_DiscoUp(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set to next disco mode!";
 
-				char szTmp[40];
-			    sprintf(szTmp,"Disco Mode %s",cparam.substr(12).c_str());
-				m_mainworker.SwitchLight(ID, szTmp, 0, -1, false, 0);
-			}
-			else if (cparam == "discoup")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set to next disco mode!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Disco Up", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_DiscoDown(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set to previous disco mode!";
 
-				m_mainworker.SwitchLight(ID, "Disco Up", 0, -1,false,0);
-			}
-			else if (cparam == "discodown")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set to previous disco mode!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Disco Down", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_SpeedUp(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set disco speed up!";
 
-				m_mainworker.SwitchLight(ID, "Disco Down", 0, -1,false,0);
-			}
-			else if (cparam == "speedup")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set disco speed up!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Speed Up", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_SpeedUpLong(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set speed long!";
 
-				m_mainworker.SwitchLight(ID, "Speed Up", 0, -1,false,0);
-			}
-			else if (cparam == "speeduplong")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
+				return;
+			}
 
-				root["status"] = "OK";
-                root["title"] = "Set speed long!";
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				std::string idx = request::findValue(&req, "idx");
+			m_mainworker.SwitchLight(ID, "Speed Up Long", 0, -1,false,0);
+		}
 
-				if (idx == "")
-				{
-					return;
-				}
+		void CWebServer::Cmd_SpeedDown(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set disco speed down!";
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+			std::string idx = request::findValue(&req, "idx");
 
-				m_mainworker.SwitchLight(ID, "Speed Up Long", 0, -1,false,0);
-			}
-			else if (cparam == "speeddown")
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set disco speed down!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Speed Down", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_SpeedMin(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set disco speed minimal!";
 
-				m_mainworker.SwitchLight(ID, "Speed Down", 0, -1,false,0);
-			}
-			else if (cparam == "speedmin")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set disco speed minimal!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Speed Minimal", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_SpeedMax(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set disco speed maximal!";
 
-				m_mainworker.SwitchLight(ID, "Speed Minimal", 0, -1,false,0);
-			}
-			else if (cparam == "speedmax")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set disco speed maximal!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Speed Maximal", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_Warmer(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set Kelvin up!";
 
-				m_mainworker.SwitchLight(ID, "Speed Maximal", 0, -1,false,0);
-			}
-			else if (cparam == "warmer")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set Kelvin up!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Warmer", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_Cooler(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set Kelvin down!";
 
-				m_mainworker.SwitchLight(ID, "Warmer", 0, -1,false,0);
-			}
-			else if (cparam == "cooler")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set Kelvin down!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Cooler", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_FullLight(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set Full!";
 
-				m_mainworker.SwitchLight(ID, "Cooler", 0, -1,false,0);
-			}
-			else if (cparam == "fulllight")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-				root["title"] = "Set Full!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Set Full", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_NightLight(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set to nightlight!";
 
-				m_mainworker.SwitchLight(ID, "Set Full", 0, -1,false,0);
-			}
-			else if (cparam == "nightlight")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set to nightlight!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Set Night", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_WhiteLight(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			root["status"] = "OK";
+			root["title"] = "Set to clear white!";
 
-				m_mainworker.SwitchLight(ID, "Set Night", 0, -1,false,0);
-			}
-			else if (cparam == "whitelight")
+			std::string idx = request::findValue(&req, "idx");
+
+			if (idx == "")
 			{
-				root["status"] = "OK";
-                root["title"] = "Set to clear white!";
+				return;
+			}
 
-				std::string idx = request::findValue(&req, "idx");
+			uint64_t ID;
+			std::stringstream s_strid;
+			s_strid << idx;
+			s_strid >> ID;
 
-				if (idx == "")
-				{
-					return;
-				}
+			m_mainworker.SwitchLight(ID, "Set White", 0, -1,false,0);
+		}
 
-				uint64_t ID;
-				std::stringstream s_strid;
-				s_strid << idx;
-				s_strid >> ID;
+		void CWebServer::Cmd_GetFloorplanImages(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-				m_mainworker.SwitchLight(ID, "Set White", 0, -1,false,0);
-			}
-			else if (cparam == "getfloorplanimages")
-			{
-				root["status"] = "OK";
-				root["title"] = "GetFloorplanImages";
+			root["status"] = "OK";
+			root["title"] = "GetFloorplanImages";
 
-				DIR *lDir;
-				struct dirent *ent;
-				std::string imagesFolder = szWWWFolder + "/images/floorplans";
-				int iFile = 0;
-				if ((lDir = opendir(imagesFolder.c_str())) != NULL)
+			DIR *lDir;
+			struct dirent *ent;
+			std::string imagesFolder = szWWWFolder + "/images/floorplans";
+			int iFile = 0;
+			if ((lDir = opendir(imagesFolder.c_str())) != NULL)
+			{
+				while ((ent = readdir(lDir)) != NULL)
 				{
-					while ((ent = readdir(lDir)) != NULL)
-					{
-						std::string filename = ent->d_name;
+					std::string filename = ent->d_name;
 
-						std::string temp_filename = filename;
-						std::transform(temp_filename.begin(), temp_filename.end(), temp_filename.begin(), ::tolower);
+					std::string temp_filename = filename;
+					std::transform(temp_filename.begin(), temp_filename.end(), temp_filename.begin(), ::tolower);
 
-						size_t pos = temp_filename.find(".png");
+					size_t pos = temp_filename.find(".png");
+					if (pos == std::string::npos)
+					{
+						pos = temp_filename.find(".jpg");
 						if (pos == std::string::npos)
 						{
-							pos = temp_filename.find(".jpg");
-							if (pos == std::string::npos)
-							{
-								pos = temp_filename.find(".bmp");
-							}
-						}
-						if (pos != std::string::npos)
-						{
-							root["result"]["images"][iFile++] = filename;
+							pos = temp_filename.find(".bmp");
 						}
 					}
-					closedir(lDir);
+					if (pos != std::string::npos)
+					{
+						root["result"]["images"][iFile++] = filename;
+					}
 				}
+				closedir(lDir);
 			}
-			else if (cparam == "addfloorplan")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		}
 
-				std::string name = request::findValue(&req, "name");
-				std::string imagefile = request::findValue(&req, "image");
-				std::string scalefactor = request::findValue(&req, "scalefactor");
-				if (
-					(name == "") ||
-					(imagefile == "") ||
-					(scalefactor == "")
-					)
-					return;
+		void CWebServer::Cmd_AddFloorplan(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string name = request::findValue(&req, "name");
+			std::string imagefile = request::findValue(&req, "image");
+			std::string scalefactor = request::findValue(&req, "scalefactor");
+
+			root["status"] = "OK";
+			root["title"] = "AddFloorplan";
+			m_sql.safe_query(
+				"INSERT INTO Floorplans (Name,ImageFile,ScaleFactor) VALUES ('%q','%q',%q)",
+				name.c_str(),
+				imagefile.c_str(),
+				scalefactor.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) '%s' created with image file '%s', Scale Factor %s.", name.c_str(), imagefile.c_str(), scalefactor.c_str());
+		}
+
+		void CWebServer::Cmd_UpdateFloorplan(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string name = request::findValue(&req, "name");
+			std::string imagefile = request::findValue(&req, "image");
+			std::string scalefactor = request::findValue(&req, "scalefactor");
+			if (
+				(name == "") ||
+				(imagefile == "")
+				)
+				return;
+
+			root["status"] = "OK";
+			root["title"] = "UpdateFloorplan";
+
+			m_sql.safe_query(
+				"UPDATE Floorplans SET Name='%q',ImageFile='%q', ScaleFactor='%q' WHERE (ID == '%q')",
+				name.c_str(),
+				imagefile.c_str(),
+				scalefactor.c_str(),
+				idx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) '%s' updated with image file '%s', Scale Factor %s.", name.c_str(), imagefile.c_str(), scalefactor.c_str());
+		}
+
+		void CWebServer::Cmd_DeleteFloorplan(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteFloorplan";
+			 m_sql.safe_query(
+				"UPDATE DeviceToPlansMap SET XOffset=0,YOffset=0 WHERE (PlanID IN (SELECT ID from Plans WHERE (FloorplanID == '%q')))",
+				idx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Device coordinates reset for all plans on floorplan '%s'.", idx.c_str());
+			m_sql.safe_query(
+				"UPDATE Plans SET FloorplanID=0,Area='' WHERE (FloorplanID == '%q')",
+				idx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Plans for floorplan '%s' reset.", idx.c_str());
+			m_sql.safe_query(
+				"DELETE FROM Floorplans WHERE (ID == '%q')",
+				idx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Floorplan '%s' deleted.", idx.c_str());
+		}
 
-				root["status"] = "OK";
-				root["title"] = "AddFloorplan";
-				m_sql.safe_query(
-					"INSERT INTO Floorplans (Name,ImageFile,ScaleFactor) VALUES ('%q','%q',%q)",
-					name.c_str(),
-					imagefile.c_str(),
-					scalefactor.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) '%s' created with image file '%s', Scale Factor %s.", name.c_str(), imagefile.c_str(), scalefactor.c_str());
-			}
-			else if (cparam == "updatefloorplan")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		void CWebServer::Cmd_ChangeFloorplanOrder(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string sway = request::findValue(&req, "way");
+			if (sway == "")
+				return;
+			bool bGoUp = (sway == "0");
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				std::string name = request::findValue(&req, "name");
-				std::string imagefile = request::findValue(&req, "image");
-				std::string scalefactor = request::findValue(&req, "scalefactor");
-				if (
-					(name == "") ||
-					(imagefile == "")
-					)
-					return;
+			std::string aOrder, oID, oOrder;
 
-				root["status"] = "OK";
-				root["title"] = "UpdateFloorplan";
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT [Order] FROM Floorplans WHERE (ID=='%q')",
+				idx.c_str());
+			if (result.size() < 1)
+				return;
+			aOrder = result[0][0];
 
-				m_sql.safe_query(
-					"UPDATE Floorplans SET Name='%q',ImageFile='%q', ScaleFactor='%q' WHERE (ID == '%q')",
-					name.c_str(),
-					imagefile.c_str(),
-					scalefactor.c_str(),
-					idx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) '%s' updated with image file '%s', Scale Factor %s.", name.c_str(), imagefile.c_str(), scalefactor.c_str());
-			}
-			else if (cparam == "deletefloorplan")
+			if (!bGoUp)
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
+				//Get next device order
+				result = m_sql.safe_query("SELECT ID, [Order] FROM Floorplans WHERE ([Order]>'%q') ORDER BY [Order] ASC",
+					aOrder.c_str());
+				if (result.size() < 1)
 					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteFloorplan";
-				 m_sql.safe_query(
-					"UPDATE DeviceToPlansMap SET XOffset=0,YOffset=0 WHERE (PlanID IN (SELECT ID from Plans WHERE (FloorplanID == '%q')))",
-					idx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Device coordinates reset for all plans on floorplan '%s'.", idx.c_str());
-				m_sql.safe_query(
-					"UPDATE Plans SET FloorplanID=0,Area='' WHERE (FloorplanID == '%q')",
-					idx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Plans for floorplan '%s' reset.", idx.c_str());
-				m_sql.safe_query(
-					"DELETE FROM Floorplans WHERE (ID == '%q')",
-					idx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Floorplan '%s' deleted.", idx.c_str());
+				oID = result[0][0];
+				oOrder = result[0][1];
 			}
-			else if (cparam == "changefloorplanorder")
+			else
 			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
-
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				std::string sway = request::findValue(&req, "way");
-				if (sway == "")
-					return;
-				bool bGoUp = (sway == "0");
-
-				std::string aOrder, oID, oOrder;
-
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT [Order] FROM Floorplans WHERE (ID=='%q')",
-					idx.c_str());
+				//Get previous device order
+				result = m_sql.safe_query("SELECT ID, [Order] FROM Floorplans WHERE ([Order]<'%q') ORDER BY [Order] DESC",
+					aOrder.c_str());
 				if (result.size() < 1)
 					return;
-				aOrder = result[0][0];
+				oID = result[0][0];
+				oOrder = result[0][1];
+			}
+			//Swap them
+			root["status"] = "OK";
+			root["title"] = "ChangeFloorPlanOrder";
 
-				if (!bGoUp)
-				{
-					//Get next device order
-					result = m_sql.safe_query("SELECT ID, [Order] FROM Floorplans WHERE ([Order]>'%q') ORDER BY [Order] ASC",
-						aOrder.c_str());
-					if (result.size() < 1)
-						return;
-					oID = result[0][0];
-					oOrder = result[0][1];
-				}
-				else
-				{
-					//Get previous device order
-					result = m_sql.safe_query("SELECT ID, [Order] FROM Floorplans WHERE ([Order]<'%q') ORDER BY [Order] DESC",
-						aOrder.c_str());
-					if (result.size() < 1)
-						return;
-					oID = result[0][0];
-					oOrder = result[0][1];
-				}
-				//Swap them
-				root["status"] = "OK";
-				root["title"] = "ChangeFloorPlanOrder";
+			m_sql.safe_query("UPDATE Floorplans SET [Order] = '%q' WHERE (ID='%q')",
+				oOrder.c_str(), idx.c_str());
+			m_sql.safe_query("UPDATE Floorplans SET [Order] = '%q' WHERE (ID='%q')",
+				aOrder.c_str(), oID.c_str());
+		}
 
-				m_sql.safe_query("UPDATE Floorplans SET [Order] = '%q' WHERE (ID='%q')",
-					oOrder.c_str(), idx.c_str());
-				m_sql.safe_query("UPDATE Floorplans SET [Order] = '%q' WHERE (ID='%q')",
-					aOrder.c_str(), oID.c_str());
-			}
-			else if (cparam == "getunusedfloorplanplans")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		void CWebServer::Cmd_GetUnusedFloorplanPlans(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::vector<std::vector<std::string> > result;
 
-				root["status"] = "OK";
-				root["title"] = "GetUnusedFloorplanPlans";
-				int ii = 0;
+			root["status"] = "OK";
+			root["title"] = "GetUnusedFloorplanPlans";
+			int ii = 0;
 
-				result = m_sql.safe_query("SELECT ID, Name FROM Plans WHERE (FloorplanID==0) ORDER BY Name");
-				if (result.size() > 0)
+			result = m_sql.safe_query("SELECT ID, Name FROM Plans WHERE (FloorplanID==0) ORDER BY Name");
+			if (result.size() > 0)
+			{
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
+					std::vector<std::string> sd = *itt;
 
-						root["result"][ii]["type"] = 0;
-						root["result"][ii]["idx"] = sd[0];
-						root["result"][ii]["Name"] = sd[1];
-						ii++;
-					}
+					root["result"][ii]["type"] = 0;
+					root["result"][ii]["idx"] = sd[0];
+					root["result"][ii]["Name"] = sd[1];
+					ii++;
 				}
 			}
-			else if (cparam == "getfloorplanplans")
+		}
+
+		void CWebServer::Cmd_GetFloorplanPlans(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "GetFloorplanPlans";
+			std::vector<std::vector<std::string> > result;
+			int ii = 0;
+			result = m_sql.safe_query("SELECT ID, Name, Area FROM Plans WHERE (FloorplanID=='%q') ORDER BY Name",
+				idx.c_str());
+			if (result.size() > 0)
 			{
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "GetFloorplanPlans";
-				std::vector<std::vector<std::string> > result;
-				int ii = 0;
-				result = m_sql.safe_query("SELECT ID, Name, Area FROM Plans WHERE (FloorplanID=='%q') ORDER BY Name",
-					idx.c_str());
-				if (result.size() > 0)
+				std::vector<std::vector<std::string> >::const_iterator itt;
+				for (itt = result.begin(); itt != result.end(); ++itt)
 				{
-					std::vector<std::vector<std::string> >::const_iterator itt;
-					for (itt = result.begin(); itt != result.end(); ++itt)
-					{
-						std::vector<std::string> sd = *itt;
+					std::vector<std::string> sd = *itt;
 
-						root["result"][ii]["idx"] = sd[0];
-						root["result"][ii]["Name"] = sd[1];
-						root["result"][ii]["Area"] = sd[2];
-						ii++;
-					}
+					root["result"][ii]["idx"] = sd[0];
+					root["result"][ii]["Name"] = sd[1];
+					root["result"][ii]["Area"] = sd[2];
+					ii++;
 				}
 			}
-			else if (cparam == "addfloorplanplan")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				std::string planidx = request::findValue(&req, "planidx");
-				if (
-					(idx == "") ||
-					(planidx == "")
-					)
-					return;
-				root["status"] = "OK";
-				root["title"] = "AddFloorplanPlan";
+		void CWebServer::Cmd_AddFloorplanPlan(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			std::string planidx = request::findValue(&req, "planidx");
+			root["status"] = "OK";
+			root["title"] = "AddFloorplanPlan";
 
-				 m_sql.safe_query(
-					"UPDATE Plans SET FloorplanID='%q' WHERE (ID == '%q')",
-					idx.c_str(),
-					planidx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Plan '%s' added to floorplan '%s'.", planidx.c_str(), idx.c_str());
-			}
-			else if (cparam == "updatefloorplanplan")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			 m_sql.safe_query(
+				"UPDATE Plans SET FloorplanID='%q' WHERE (ID == '%q')",
+				idx.c_str(),
+				planidx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Plan '%s' added to floorplan '%s'.", planidx.c_str(), idx.c_str());
+		}
 
-				std::string planidx = request::findValue(&req, "planidx");
-				std::string planarea = request::findValue(&req, "area");
-				if (planidx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "UpdateFloorplanPlan";
+		void CWebServer::Cmd_UpdateFloorplanPlan(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string planidx = request::findValue(&req, "planidx");
+			std::string planarea = request::findValue(&req, "area");
+			root["status"] = "OK";
+			root["title"] = "UpdateFloorplanPlan";
 
-				m_sql.safe_query(
-					"UPDATE Plans SET Area='%q' WHERE (ID == '%q')",
-					planarea.c_str(),
-					planidx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Plan '%s' floor area updated to '%s'.", planidx.c_str(), planarea.c_str());
-			}
-			else if (cparam == "deletefloorplanplan")
-			{
-				if (session.rights < 2)
-				{
-					session.reply_status = reply::forbidden;
-					return; //Only admin user allowed
-				}
+			m_sql.safe_query(
+				"UPDATE Plans SET Area='%q' WHERE (ID == '%q')",
+				planarea.c_str(),
+				planidx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Plan '%s' floor area updated to '%s'.", planidx.c_str(), planarea.c_str());
+		}
 
-				std::string idx = request::findValue(&req, "idx");
-				if (idx == "")
-					return;
-				root["status"] = "OK";
-				root["title"] = "DeleteFloorplanPlan";
-				m_sql.safe_query(
-					"UPDATE DeviceToPlansMap SET XOffset=0,YOffset=0 WHERE (PlanID == '%q')",
-					idx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Device coordinates reset for plan '%s'.", idx.c_str());
-				m_sql.safe_query(
-					"UPDATE Plans SET FloorplanID=0,Area='' WHERE (ID == '%q')",
-					idx.c_str()
-					);
-				_log.Log(LOG_STATUS, "(Floorplan) Plan '%s' floorplan data reset.", idx.c_str());
-			}
+		void CWebServer::Cmd_DeleteFloorplanPlan(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			std::string idx = request::findValue(&req, "idx");
+			root["status"] = "OK";
+			root["title"] = "DeleteFloorplanPlan";
+			m_sql.safe_query(
+				"UPDATE DeviceToPlansMap SET XOffset=0,YOffset=0 WHERE (PlanID == '%q')",
+				idx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Device coordinates reset for plan '%s'.", idx.c_str());
+			m_sql.safe_query(
+				"UPDATE Plans SET FloorplanID=0,Area='' WHERE (ID == '%q')",
+				idx.c_str()
+				);
+			_log.Log(LOG_STATUS, "(Floorplan) Plan '%s' floorplan data reset.", idx.c_str());
 		}
 
 		void CWebServer::DisplaySwitchTypesCombo(std::string & content_part)
@@ -7296,7 +7385,8 @@ namespace http {
 
 		void CWebServer::LoadUsers()
 		{
-			ClearUserPasswords();
+			//Build the complete list first, requests are authenticated while the users are reloaded
+			std::vector<_tWebUserPassword> users;
 			std::string WebUserName, WebPassword;
 			int nValue = 0;
 			if (m_sql.GetPreferencesVar("WebUserName", nValue, WebUserName))
@@ -7307,7 +7397,7 @@ namespace http {
 					{
 						WebUserName = base64_decode(WebUserName);
 						//WebPassword = WebPassword;
-						AddUser(10000, WebUserName, WebPassword, URIGHTS_ADMIN, 0xFFFF);
+						AddUser(users, 10000, WebUserName, WebPassword, URIGHTS_ADMIN, 0xFFFF);
 
 						std::vector<std::vector<std::string> > result;
 						result = m_sql.safe_query("SELECT ID, Active, Username, Password, Rights, TabsEnabled FROM Users");
@@ -7330,17 +7420,19 @@ namespace http {
 									_eUserRights rights = (_eUserRights)atoi(sd[4].c_str());
 									int activetabs = atoi(sd[5].c_str());
 
-									AddUser(ID, username, password, rights, activetabs);
+									AddUser(users, ID, username, password, rights, activetabs);
 								}
 							}
 						}
 					}
 				}
 			}
+			m_users = users;
+			m_pWebEm->SetUserPasswords(users);
 			m_mainworker.LoadSharedUsers();
 		}
 
-		void CWebServer::AddUser(const unsigned long ID, const std::string &username, const std::string &password, const int userrights, const int activetabs)
+		void CWebServer::AddUser(std::vector<_tWebUserPassword> &users, const unsigned long ID, const std::string &username, const std::string &password, const int userrights, const int activetabs)
 		{
 			_tWebUserPassword wtmp;
 			wtmp.ID = ID;
@@ -7348,9 +7440,7 @@ namespace http {
 			wtmp.Password = password;
 			wtmp.userrights = (_eUserRights)userrights;
 			wtmp.ActiveTabs = activetabs;
-			m_users.push_back(wtmp);
-
-			m_pWebEm->AddUserPassword(ID, username, password, (_eUserRights)userrights, activetabs);
+			users.push_back(wtmp);
 		}
 
 		void CWebServer::ClearUserPasswords()
@@ -7397,7 +7487,8 @@ namespace http {
 			std::string Longitude = request::findValue(&req, "Longitude");
 			_log.SetLogPreference ( CURLEncode::URLDecode( request::findValue(&req,"LogFilter")   ),
 									CURLEncode::URLDecode( request::findValue(&req,"LogFileName") ),
-									CURLEncode::URLDecode( request::findValue(&req,"LogLevel")    ) );
+									CURLEncode::URLDecode( request::findValue(&req,"LogLevel")    ),
+									CURLEncode::URLDecode( request::findValue(&req,"LogTraceCategories") ) );
 			if ((Latitude != "") && (Longitude != ""))
 			{
 				std::string LatLong = Latitude + ";" + Longitude;
@@ -7440,6 +7531,10 @@ namespace http {
 			m_sql.UpdatePreferencesVar("ShortLogInterval", iShortLogInterval);
 			m_sql.m_ShortLogInterval = iShortLogInterval;
 
+			//The short log tables are migrated at startup, so this takes effect after a restart
+			std::string sEpochTimestamps = request::findValue(&req, "EpochTimestamps");
+			m_sql.UpdatePreferencesVar("EpochTimestamps", (sEpochTimestamps == "on") ? 1 : 0);
+
 			std::string sElectricVoltage = request::findValue(&req, "ElectricVoltage");
 			m_sql.UpdatePreferencesVar("ElectricVoltage", atoi(sElectricVoltage.c_str()));
 
@@ -7598,6 +7693,16 @@ namespace http {
 			int iShowUpdateEffect = (ShowUpdateEffect == "on" ? 1 : 0);
 			m_sql.UpdatePreferencesVar("ShowUpdateEffect", iShowUpdateEffect);
 
+			//Used when the plugin system starts, 0 is one thread per plugin
+			std::string PythonPluginThreads = request::findValue(&req, "PythonPluginThreads");
+			if (!PythonPluginThreads.empty())
+			{
+				int iPythonPluginThreads = atoi(PythonPluginThreads.c_str());
+				if (iPythonPluginThreads < 0)
+					iPythonPluginThreads = 1;
+				m_sql.UpdatePreferencesVar("PythonPluginThreads", iPythonPluginThreads);
+			}
+
 			std::string SendErrorsAsNotification = request::findValue(&req, "SendErrorsAsNotification");
 			int iSendErrorsAsNotification = (SendErrorsAsNotification == "on" ? 1 : 0);
 			m_sql.UpdatePreferencesVar("SendErrorsAsNotification", iSendErrorsAsNotification);
@@ -7622,6 +7727,12 @@ namespace http {
 			m_sql.m_bLogEventScriptTrigger = (LogEventScriptTrigger == "on" ? 1 : 0);
 			m_sql.UpdatePreferencesVar("LogEventScriptTrigger", m_sql.m_bLogEventScriptTrigger);
 
+			int iLuaScriptTimeout = atoi(request::findValue(&req, "LuaScriptTimeout").c_str());
+			if (iLuaScriptTimeout < 1)
+				iLuaScriptTimeout = 10;
+			m_sql.UpdatePreferencesVar("LuaScriptTimeout", iLuaScriptTimeout);
+			m_mainworker.m_eventsystem.SetLuaTimeout(iLuaScriptTimeout);
+
 			std::string EnableWidgetOrdering = request::findValue(&req, "AllowWidgetOrdering");
 			int iEnableAllowWidgetOrdering = (EnableWidgetOrdering == "on" ? 1 : 0);
 			m_sql.UpdatePreferencesVar("AllowWidgetOrdering", iEnableAllowWidgetOrdering);
@@ -7751,6 +7862,86 @@ namespace http {
 			bool Enabled;
 		} tHardwareList;
 
+		//Values of today from a log table (counter/rain totals) for GetJSonDevices.
+		//When listing devices they are read for all devices with one grouped query instead of a query per device
+		struct _tTodayValues
+		{
+			const char *szTable;
+			const char *szColumns;
+			bool bSingleDevice;
+			bool bEnabled;
+			bool bLoaded;
+			std::map<std::string, std::vector<std::string> > values;
+
+			_tTodayValues(const char *table, const char *columns, const bool singledevice) :
+				szTable(table), szColumns(columns), bSingleDevice(singledevice), bEnabled(true), bLoaded(false) {};
+
+			std::vector<std::vector<std::string> > Get(const std::string &idx, const char *szDate)
+			{
+				std::vector<std::vector<std::string> > result;
+				if (!bEnabled)
+					return result;
+				if (bSingleDevice)
+					return m_sql.safe_query("SELECT %s FROM %s WHERE (DeviceRowID='%q' AND Date>='%q')", szColumns, szTable, idx.c_str(), szDate);
+				if (!bLoaded)
+				{
+					result = m_sql.safe_query("SELECT DeviceRowID, %s FROM %s WHERE (Date>='%q') GROUP BY DeviceRowID", szColumns, szTable, szDate);
+					std::vector<std::vector<std::string> >::const_iterator itt;
+					for (itt = result.begin(); itt != result.end(); ++itt)
+					{
+						std::vector<std::string> sd = *itt;
+						std::string DeviceRowID = sd[0];
+						sd.erase(sd.begin());
+						values[DeviceRowID] = sd;
+					}
+					result.clear();
+					bLoaded = true;
+				}
+				std::map<std::string, std::vector<std::string> >::const_iterator itt = values.find(idx);
+				if (itt != values.end())
+					result.push_back(itt->second);
+				return result;
+			}
+		};
+
+		//limit/offset of GetJSonDevices, a device (or scene) that is in more than one plan has a row per plan
+		struct _tDevicePage
+		{
+			enum _ePageResult
+			{
+				PAGE_ADD,
+				PAGE_SKIP,
+				PAGE_FULL
+			};
+			int Limit;
+			int Offset;
+			int Skipped;
+			bool bFull;
+			std::string SkippedKey;
+			std::string LastKey;
+
+			_tDevicePage(const int limit, const int offset) : Limit(limit), Offset(offset), Skipped(0), bFull(false) {};
+
+			_ePageResult Check(const std::string &Key, const int ResultCount)
+			{
+				if ((!SkippedKey.empty()) && (Key == SkippedKey))
+					return PAGE_SKIP;
+				if (Skipped < Offset)
+				{
+					Skipped++;
+					SkippedKey = Key;
+					return PAGE_SKIP;
+				}
+				if ((Limit > 0) && (ResultCount >= Limit) && (Key != LastKey))
+				{
+					bFull = true;
+					return PAGE_FULL;
+				}
+				LastKey = Key;
+				return PAGE_ADD;
+			}
+		};
+
 		void CWebServer::GetJSonDevices(
 			Json::Value &root,
 			const std::string &rused,
@@ -7764,10 +7955,41 @@ namespace http {
 			const bool bFetchFavorites,
 			const time_t LastUpdate,
 			const std::string &username,
-			const std::string &hardwareid)
+			const std::string &hardwareid,
+			const int Limit,
+			const int Offset,
+			const std::string &Fields)
 		{
 			std::vector<std::vector<std::string> > result;
 
+			//Only return these fields (idx is always returned)
+			std::set<std::string> _Fields;
+			if (!Fields.empty())
+			{
+				std::vector<std::string> strarray;
+				StringSplit(Fields, ",", strarray);
+				_Fields.insert(strarray.begin(), strarray.end());
+			}
+			_tDevicePage page(Limit, Offset);
+
+			//Counter values of today are only needed for these fields
+			const bool bSingleDevice = (rowid != "");
+			_tTodayValues todayMeter("Meter", "MIN(Value), MAX(Value)", bSingleDevice);
+			_tTodayValues todayMultiMeter("MultiMeter", "MIN(Value1), MIN(Value2), MIN(Value5), MIN(Value6)", bSingleDevice);
+			_tTodayValues todayRain("Rain", "MIN(Total), MAX(Total)", bSingleDevice);
+			if (!_Fields.empty())
+			{
+				const char *szCounterFields[] = { "Counter", "CounterToday", "CounterDeliv", "CounterDelivToday", "Data", "Usage", NULL };
+				bool bWantCounters = false;
+				for (int jj = 0; szCounterFields[jj] != NULL; jj++)
+				{
+					if (_Fields.find(szCounterFields[jj]) != _Fields.end())
+						bWantCounters = true;
+				}
+				todayMeter.bEnabled = bWantCounters;
+				todayMultiMeter.bEnabled = bWantCounters;
+			}
+
 			time_t now = mytime(NULL);
 			struct tm tm1;
 			localtime_r(&now, &tm1);
@@ -7936,6 +8158,12 @@ namespace http {
 								continue;
 							}
 
+							_tDevicePage::_ePageResult pageResult = page.Check("S" + sd[0], ii);
+							if (pageResult == _tDevicePage::PAGE_SKIP)
+								continue;
+							if (pageResult == _tDevicePage::PAGE_FULL)
+								break;
+
 							if (scenetype == 0)
 							{
 								root["result"][ii]["Type"] = "Scene";
@@ -8205,7 +8433,7 @@ namespace http {
 				}
 			}
 
-			if (result.size() > 0)
+			if ((result.size() > 0) && (!page.bFull))
 			{
 				std::vector<std::vector<std::string> >::const_iterator itt;
 				for (itt = result.begin(); itt != result.end(); ++itt)
@@ -8435,6 +8663,12 @@ namespace http {
 						}
 					}
 
+					_tDevicePage::_ePageResult pageResult = page.Check("D" + sd[0], ii);
+					if (pageResult == _tDevicePage::PAGE_SKIP)
+						continue;
+					if (pageResult == _tDevicePage::PAGE_FULL)
+						break;
+
 					// has this device already been seen, now with different plan?
 					// assume results are ordered such that same device is adjacent
 					// if the idx and the Type are equal (type to prevent matching against Scene with same idx)
@@ -9203,8 +9437,7 @@ namespace http {
 
 							if (dSubType != sTypeRAINWU)
 							{
-								result2 = m_sql.safe_query(
-									"SELECT MIN(Total), MAX(Total) FROM Rain WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
+								result2 = todayRain.Get(sd[0], szDate);
 							}
 							else
 							{
@@ -9281,8 +9514,7 @@ namespace http {
 
 						std::vector<std::vector<std::string> > result2;
 						strcpy(szTmp, "0");
-						result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')",
-							sd[0].c_str(), szDate);
+						result2 = todayMeter.Get(sd[0], szDate);
 						if (result2.size() > 0)
 						{
 							std::vector<std::string> sd2 = result2[0];
@@ -9399,7 +9631,7 @@ namespace http {
 
                         std::vector<std::vector<std::string> > result2;
                         strcpy(szTmp, "0");
-                        result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
+                        result2 = todayMeter.Get(sd[0], szDate);
                         if (result2.size() > 0)
                         {
                             std::vector<std::string> sd2 = result2[0];
@@ -9515,7 +9747,7 @@ namespace http {
 
 						std::vector<std::vector<std::string> > result2;
 						strcpy(szTmp, "0");
-						result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
+						result2 = todayMeter.Get(sd[0], szDate);
 						if (result2.size() > 0)
 						{
 							std::vector<std::string> sd2 = result2[0];
@@ -9727,8 +9959,7 @@ namespace http {
 
 							std::vector<std::vector<std::string> > result2;
 							strcpy(szTmp, "0");
-							result2 = m_sql.safe_query("SELECT MIN(Value1), MIN(Value2), MIN(Value5), MIN(Value6) FROM MultiMeter WHERE (DeviceRowID='%q' AND Date>='%q')",
-								sd[0].c_str(), szDate);
+							result2 = todayMultiMeter.Get(sd[0], szDate);
 							if (result2.size() > 0)
 							{
 								std::vector<std::string> sd2 = result2[0];
@@ -9775,8 +10006,7 @@ namespace http {
 
 						std::vector<std::vector<std::string> > result2;
 						strcpy(szTmp, "0");
-						result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')",
-							sd[0].c_str(), szDate);
+						result2 = todayMeter.Get(sd[0], szDate);
 						if (result2.size() > 0)
 						{
 							std::vector<std::string> sd2 = result2[0];
@@ -9901,8 +10131,7 @@ namespace http {
 
 							std::vector<std::vector<std::string> > result2;
 							strcpy(szTmp, "0");
-							result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')",
-								sd[0].c_str(), szDate);
+							result2 = todayMeter.Get(sd[0], szDate);
 							if (result2.size() > 0)
 							{
 								float EnergyDivider = 1000.0f;
@@ -10414,8 +10643,7 @@ namespace http {
 
 							std::vector<std::vector<std::string> > result2;
 							strcpy(szTmp, "0");
-							result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')",
-								sd[0].c_str(), szDate);
+							result2 = todayMeter.Get(sd[0], szDate);
 							if (result2.size() > 0)
 							{
 								std::vector<std::string> sd2 = result2[0];
@@ -10442,6 +10670,21 @@ namespace http {
 					ii++;
 				}
 			}
+
+			if ((!_Fields.empty()) && (root.isMember("result")))
+			{
+				for (Json::ArrayIndex jj = 0; jj < root["result"].size(); jj++)
+				{
+					Json::Value &jDevice = root["result"][jj];
+					std::vector<std::string> members = jDevice.getMemberNames();
+					std::vector<std::string>::const_iterator itt;
+					for (itt = members.begin(); itt != members.end(); ++itt)
+					{
+						if ((*itt != "idx") && (_Fields.find(*itt) == _Fields.end()))
+							jDevice.removeMember(itt->c_str());
+					}
+				}
+			}
 		}
 
 		void CWebServer::GetDatabaseBackup(WebEmSession & session, const request& req, reply & rep)
@@ -10978,7 +11221,11 @@ namespace http {
 			root["status"] = "OK";
 			root["title"] = "Devices";
 
-			GetJSonDevices(root, rused, rfilter, order, rid, planid, floorid, bDisplayHidden, bDisabledDisabled, bFetchFavorites, LastUpdate, session.username, hwidx);
+			int Limit = atoi(request::findValue(&req, "limit").c_str());
+			int Offset = atoi(request::findValue(&req, "offset").c_str());
+			std::string Fields = request::findValue(&req, "fields");
+
+			GetJSonDevices(root, rused, rfilter, order, rid, planid, floorid, bDisplayHidden, bDisabledDisabled, bFetchFavorites, LastUpdate, session.username, hwidx, Limit, Offset, Fields);
 		}
 
 		void CWebServer::RType_Users(WebEmSession & session, const request& req, Json::Value &root)
@@ -12157,6 +12404,10 @@ namespace http {
 				{
 					root["ShortLogInterval"] = nValue;
 				}
+				else if (Key == "EpochTimestamps")
+				{
+					root["EpochTimestamps"] = nValue;
+				}
 				else if (Key == "WebUserName")
 				{
 					root["WebUserName"] = base64_decode(sValue);
@@ -12335,6 +12586,10 @@ namespace http {
 				{
 					root["ShowUpdateEffect"] = nValue;
 				}
+				else if (Key == "PythonPluginThreads")
+				{
+					root["PythonPluginThreads"] = nValue;
+				}
 				else if (Key == "DegreeDaysBaseTemperature")
 				{
 					root["DegreeDaysBaseTemperature"] = sValue;
@@ -12347,6 +12602,10 @@ namespace http {
 				{
 					root["LogEventScriptTrigger"] = nValue;
 				}
+				else if (Key == "LuaScriptTimeout")
+				{
+					root["LuaScriptTimeout"] = nValue;
+				}
 				else if (Key == "(1WireSensorPollPeriod")
 				{
 					root["1WireSensorPollPeriod"] = nValue;
@@ -12440,6 +12699,9 @@ namespace http {
 				else if (Key == "LogLevel") {
 					root[Key] = sValue;
 				}
+				else if (Key == "LogTraceCategories") {
+					root[Key] = sValue;
+				}
 				else if (Key == "DeltaTemperatureLog") {
 					root[Key] = sValue;
 				}
@@ -12754,11 +13016,13 @@ namespace http {
 
 			if (srange == "day")
 			{
+				//With epoch timestamps sort on DateUTC, so the rows of the hour that is repeated at the end of DST stay in order
+				const char *szDateOrder = (m_sql.m_bEpochTimestamps) ? "DateUTC" : "Date";
 				if (sensor == "temp") {
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Temperature, Chill, Humidity, Barometer, Date, SetPoint FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Temperature, Chill, Humidity, Barometer, Date, SetPoint FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -12843,7 +13107,7 @@ namespace http {
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Percentage, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Percentage, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -12862,7 +13126,7 @@ namespace http {
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Speed, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Speed, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -12885,7 +13149,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Value4, Value5, Value6, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Value4, Value5, Value6, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13050,7 +13314,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13070,7 +13334,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13105,7 +13369,7 @@ namespace http {
 						{
 							vdiv = 1000.0f;
 						}
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13134,7 +13398,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13154,7 +13418,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13174,7 +13438,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13195,7 +13459,7 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13223,7 +13487,7 @@ namespace http {
 
 						root["displaytype"] = displaytype;
 
-						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13298,7 +13562,7 @@ namespace http {
 
 						root["displaytype"] = displaytype;
 
-						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 						if (result.size() > 0)
 						{
 							std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13406,7 +13670,7 @@ namespace http {
 						}
 
 						int ii = 0;
-						result = m_sql.safe_query("SELECT Value,[Usage], Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value,[Usage], Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 
 						int method = 0;
 						std::string sMethod = request::findValue(&req, "method");
@@ -13570,7 +13834,7 @@ namespace http {
 							EnergyDivider *= 100.0f;
 
 						int ii = 0;
-						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 
 						int method = 0;
 						std::string sMethod = request::findValue(&req, "method");
@@ -13757,7 +14021,7 @@ namespace http {
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Level, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Level, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13782,7 +14046,7 @@ namespace http {
 					float LastValue = -1;
 					std::string LastDate = "";
 
-					result = m_sql.safe_query("SELECT Total, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Total, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13829,7 +14093,7 @@ namespace http {
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Direction, Speed, Gust, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Direction, Speed, Gust, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -13867,7 +14131,7 @@ namespace http {
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Direction, Speed, Gust FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					result = m_sql.safe_query("SELECT Direction, Speed, Gust FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY %s ASC", dbasetable.c_str(), idx, szDateOrder);
 					if (result.size() > 0)
 					{
 						std::vector<std::vector<std::string> >::const_iterator itt;
@@ -21,6 +21,13 @@ namespace http {
 class CWebServer : public session_store, public boost::enable_shared_from_this<CWebServer>
 {
 	typedef boost::function< void(WebEmSession & session, const request& req, Json::Value &root) > webserver_response_function;
+	//Entry of the json.htm dispatch table, the rights and parameters are checked before the handler is called
+	struct _tWebHandler
+	{
+		webserver_response_function ResponseFunction;
+		int Rights;		//minimum session rights, -1 when the handler checks them itself
+		std::vector<std::string> RequiredParams;
+	};
 public:
 	struct _tCustomIcon
 	{
@@ -33,8 +40,8 @@ public:
 	~CWebServer(void);
 	bool StartServer(server_settings & settings, const std::string &serverpath, const bool bIgnoreUsernamePassword);
 	void StopServer();
-	void RegisterCommandCode(const char* idname, webserver_response_function ResponseFunction, bool bypassAuthentication=false);
-	void RegisterRType(const char* idname, webserver_response_function ResponseFunction);
+	void RegisterCommandCode(const char* idname, webserver_response_function ResponseFunction, bool bypassAuthentication=false, const int Rights=-1, const char *szRequiredParams=NULL);
+	void RegisterRType(const char* idname, webserver_response_function ResponseFunction, const int Rights=-1, const char *szRequiredParams=NULL);
 
 	void DisplaySwitchTypesCombo(std::string & content_part);
 	void DisplayMeterTypesCombo(std::string & content_part);
@@ -69,7 +76,7 @@ public:
 	void ReloadCustomSwitchIcons();
 
 	void LoadUsers();
-	void AddUser(const unsigned long ID, const std::string &username, const std::string &password, const int userrights, const int activetabs);
+	void AddUser(std::vector<_tWebUserPassword> &users, const unsigned long ID, const std::string &username, const std::string &password, const int userrights, const int activetabs);
 	void ClearUserPasswords();
 	bool FindAdminUser();
 	int FindUser(const char* szUserName);
@@ -91,7 +98,10 @@ public:
 		const bool bFetchFavorites,
 		const time_t LastUpdate,
 		const std::string &username,
-		const std::string &hardwareid = ""); // OTO
+		const std::string &hardwareid = "", // OTO
+		const int Limit = 0,
+		const int Offset = 0,
+		const std::string &Fields = "");
 
 	// SessionStore interface
 	const WebEmStoredSession GetSession(const std::string & sessionId);
@@ -103,6 +113,8 @@ public:
 private:
 	void HandleCommand(const std::string &cparam, WebEmSession & session, const request& req, Json::Value &root);
 	void HandleRType(const std::string &rtype, WebEmSession & session, const request& req, Json::Value &root);
+	void RegisterHandler(const std::string &rtype, const std::string &cparam, webserver_response_function ResponseFunction, const int Rights, const char *szRequiredParams);
+	bool DispatchJSonRequest(const std::string &rtype, const std::string &cparam, WebEmSession & session, const request& req, Json::Value &root);
 
 	//Commands
 	void Cmd_RFXComGetFirmwarePercentage(WebEmSession & session, const request& req, Json::Value &root);
@@ -163,6 +175,11 @@ private:
 	void Cmd_AllowNewHardware(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetLog(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_ClearLog(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetMemoryUsage(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetPollStatistics(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetEventSystemStatistics(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetSystemMetrics(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetWebServerStatistics(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_AddPlan(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_UpdatePlan(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_DeletePlan(WebEmSession & session, const request& req, Json::Value &root);
@@ -184,6 +201,83 @@ private:
 	void Cmd_EmailCameraSnapshot(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_UpdateDevice(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_UpdateDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SwitchLights(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SwitchLight(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SwitchScene(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetSunRiseSet(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetServerTime(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetSecStatus(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SetSecStatus(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetLightSwitches(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetLightSwitchesScenes(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteAllSubDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteSubDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddSubDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddSceneDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_UpdateSceneDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteSceneDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetSubDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetSceneDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_ChangeSceneDeviceOrder(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteAllSceneDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetManualHardware(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetGpio(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetCamActiveDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddCamActiveDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteCamActiveDevice(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteAllCamActiveDevices(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_TestNotification(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_TestSwitch(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddSwitch(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetNotificationTypes(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddNotification(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_UpdateNotification(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteNotification(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SwitchDeviceOrder(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SwitchSceneOrder(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_ClearNotifications(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddCamera(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_UpdateCamera(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteCamera(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddUser(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_UpdateUser(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteUser(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_ClearLightLog(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_ClearSceneLog(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_LearnSwitch(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_MakeFavorite(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_MakeSceneFavorite(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_ResetSecurityStatus(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_VerifyPasscode(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SwitchModal(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SetColBrightnessValue(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SetKelvinLevel(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_BrightnessUp(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_BrightnessDown(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DiscoMode(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DiscoModeNum(WebEmSession & session, const request& req, Json::Value &root, const int mode);
+	void Cmd_DiscoUp(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DiscoDown(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SpeedUp(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SpeedUpLong(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SpeedDown(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SpeedMin(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SpeedMax(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_Warmer(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_Cooler(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_FullLight(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_NightLight(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_WhiteLight(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetFloorplanImages(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddFloorplan(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_UpdateFloorplan(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteFloorplan(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_ChangeFloorplanOrder(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetUnusedFloorplanPlans(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetFloorplanPlans(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_AddFloorplanPlan(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_UpdateFloorplanPlan(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_DeleteFloorplanPlan(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_SetThermostatState(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_SystemShutdown(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_SystemReboot(WebEmSession & session, const request& req, Json::Value &root);
@@ -364,8 +458,8 @@ private:
 #endif
 	boost::shared_ptr<boost::thread> m_thread;
 
-	std::map < std::string, webserver_response_function > m_webcommands;
-	std::map < std::string, webserver_response_function > m_webrtypes;
+	//json.htm handlers, keyed on type and (for type=command) param
+	std::map < std::string, std::map<std::string, _tWebHandler> > m_webhandlers;
 	void Do_Work();
 	std::vector<_tCustomIcon> m_custom_light_icons;
 	std::map<int, int> m_custom_light_icons_lookup;
@@ -107,7 +107,10 @@ const char *szHelp=
 	"\t-loglevel (0=All, 1=Status+Error, 2=Error , 3= Trace )\n"
 	"\t-debug    allow log trace level 3 \n"
 	"\t-notimestamps (do not prepend timestamps to logs; useful with syslog, etc.)\n"
+	"\t-lean (reduce memory usage, for boards with little RAM)\n"
+	"\t-logbuffer lines (number of log lines kept in memory, default=100, lean=20)\n"
 	"\t-php_cgi_path (for example /usr/bin/php-cgi)\n"
+	"\t-fastcgi_server (FastCGI server for php files, for example 127.0.0.1:9000 or /run/php/php-fpm.sock)\n"
 #ifndef WIN32
 	"\t-daemon (run as background daemon)\n"
 	"\t-pidfile pid file location (for example /var/run/domoticz.pid)\n"
@@ -168,8 +171,11 @@ bool g_bStopApplication = false;
 bool g_bUseSyslog = false;
 bool g_bRunAsDaemon = false;
 bool g_bDontCacheWWW = false;
+bool g_bLeanMode = false;
 int pidFilehandle = 0;
 
+#define LEAN_THREAD_STACK_SIZE (512*1024)
+
 #define DAEMON_NAME "domoticz"
 #define PID_FILE "/var/run/domoticz.pid" 
 
@@ -482,6 +488,23 @@ int main(int argc, char**argv)
 	{
 		_log.EnableLogTimestamps(false);
 	}
+	if (cmdLine.HasSwitch("-lean"))
+	{
+		//smaller thread stacks, log buffers and database cache
+		g_bLeanMode = true;
+		_log.SetLeanMode();
+		if (!SetWorkerThreadStackSize(LEAN_THREAD_STACK_SIZE))
+			_log.Log(LOG_ERROR, "Lean mode: Could not set the worker thread stack size!");
+	}
+	if (cmdLine.HasSwitch("-logbuffer"))
+	{
+		if (cmdLine.GetArgumentCount("-logbuffer") != 1)
+		{
+			_log.Log(LOG_ERROR, "Please specify the number of log lines to keep in memory");
+			return 1;
+		}
+		_log.SetLogBufferSize(atoi(cmdLine.GetSafeArgument("-logbuffer", 0, "").c_str()));
+	}
 
 	if (cmdLine.HasSwitch("-approot"))
 	{
@@ -655,6 +678,15 @@ int main(int argc, char**argv)
 		}
 		webserver_settings.php_cgi_path = cmdLine.GetSafeArgument("-php_cgi_path", 0, "");
 	}
+	if (cmdLine.HasSwitch("-fastcgi_server"))
+	{
+		if (cmdLine.GetArgumentCount("-fastcgi_server") != 1)
+		{
+			_log.Log(LOG_ERROR, "Please specify the address of the FastCGI server");
+			return 1;
+		}
+		webserver_settings.fastcgi_server = cmdLine.GetSafeArgument("-fastcgi_server", 0, "");
+	}
 	if (cmdLine.HasSwitch("-wwwroot"))
 	{
 		if (cmdLine.GetArgumentCount("-wwwroot") != 1)
@@ -754,6 +786,15 @@ int main(int argc, char**argv)
 		}
 		secure_webserver_settings.php_cgi_path = cmdLine.GetSafeArgument("-php_cgi_path", 0, "");
 	}
+	if (cmdLine.HasSwitch("-fastcgi_server"))
+	{
+		if (cmdLine.GetArgumentCount("-fastcgi_server") != 1)
+		{
+			_log.Log(LOG_ERROR, "Please specify the address of the FastCGI server");
+			return 1;
+		}
+		secure_webserver_settings.fastcgi_server = cmdLine.GetSafeArgument("-fastcgi_server", 0, "");
+	}
 	secure_webserver_settings.www_root = szWWWFolder;
 	m_mainworker.SetSecureWebserverSettings(secure_webserver_settings);
 #endif
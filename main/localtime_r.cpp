@@ -24,6 +24,11 @@ struct tm *localtime_r(const time_t *timep, struct tm *result)
 }
 #endif
 
+//Only used to skip the fallback above, the functions below need the real localtime_r
+#if defined(__APPLE__) || defined(__USE_POSIX)
+	#undef localtime_r
+#endif
+
 time_t mytime(time_t * _Time)
 {
 	time_t acttime=time(_Time);
@@ -89,6 +94,115 @@ bool ParseSQLdatetime(time_t &time, struct tm &result, const std::string szSQLda
 }
 
 
+/* Days since 1970-01-01 for a proleptic Gregorian date (month 1-12) */
+static long DaysFromCivil(int year, const int month, const int day)
+{
+	year -= (month <= 2);
+	const long era = (year >= 0 ? year : year - 399) / 400;
+	const long yoe = year - era * 400;
+	const long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	const long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+
+#define UTC_OFFSET_CACHE_SIZE 64
+
+struct _tUTCOffsetCache
+{
+	time_t hour;
+	long offset;
+};
+static _tUTCOffsetCache m_UTCOffsetCache[UTC_OFFSET_CACHE_SIZE];
+static bool m_bUTCOffsetCacheInit = false;
+boost::mutex UTCOffsetMutex_;
+
+/* GetUTCOffset()
+ * Returns the offset of local time to UTC in seconds at the given moment.
+ * DST changes happen on whole hours, so the offset is cached per hour and most
+ * calls do not need localtime_r (which takes the global timezone lock).
+ */
+long GetUTCOffset(const time_t time)
+{
+	time_t hour = time - (time % 3600);
+	size_t slot = (size_t)((hour / 3600) % UTC_OFFSET_CACHE_SIZE);
+	{
+		boost::mutex::scoped_lock lock(UTCOffsetMutex_);
+		if (!m_bUTCOffsetCacheInit)
+		{
+			for (size_t ii = 0; ii < UTC_OFFSET_CACHE_SIZE; ii++)
+				m_UTCOffsetCache[ii].hour = -1;
+			m_bUTCOffsetCacheInit = true;
+		}
+		if (m_UTCOffsetCache[slot].hour == hour)
+			return m_UTCOffsetCache[slot].offset;
+	}
+	struct tm ltime;
+	if (localtime_r(&hour, &ltime) == NULL)
+		return 0;
+	long offset = (long)((DaysFromCivil(ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday) * 86400 + ltime.tm_hour * 3600 + ltime.tm_min * 60 + ltime.tm_sec) - hour);
+
+	boost::mutex::scoped_lock lock(UTCOffsetMutex_);
+	m_UTCOffsetCache[slot].hour = hour;
+	m_UTCOffsetCache[slot].offset = offset;
+	return offset;
+}
+
+/* SQLdatetimeToEpoch()
+ * Converts a local datetime string in SQL format (YYYY-MM-DD HH:mm:ss) to a UTC epoch value.
+ * Inside the DST "fall back" hour the first occurrence is returned.
+ *
+ * Returns false if the string could not be parsed
+ */
+bool SQLdatetimeToEpoch(const std::string &szSQLdate, time_t &time)
+{
+	int year, month, day, hour, minute, second;
+	if ((szSQLdate.length() != 19) || (sscanf(szSQLdate.c_str(), "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6))
+		return false;
+	time_t localsecs = (time_t)(DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second);
+
+	//DST changes are more than a day apart, so the offsets one day before and after are the only candidates
+	time_t time1 = localsecs - GetUTCOffset(localsecs - 86400);
+	time_t time2 = localsecs - GetUTCOffset(localsecs + 86400);
+	bool bValid1 = (time1 + GetUTCOffset(time1) == localsecs);
+	bool bValid2 = (time2 + GetUTCOffset(time2) == localsecs);
+	if ((bValid1) && (bValid2))
+		time = (time1 < time2) ? time1 : time2;
+	else if (bValid2)
+		time = time2;
+	else
+		time = time1; //valid, or inside the DST "black hole" range
+	return true;
+}
+
+/* EpochToSQLdatetime()
+ * Formats a UTC epoch value as local datetime string in SQL format
+ */
+std::string EpochToSQLdatetime(const time_t time)
+{
+	time_t localsecs = time + GetUTCOffset(time);
+	long days = (long)(localsecs / 86400);
+	long secs = (long)(localsecs % 86400);
+	if (secs < 0)
+	{
+		secs += 86400;
+		days--;
+	}
+	//civil from days
+	days += 719468;
+	const long era = (days >= 0 ? days : days - 146096) / 146097;
+	const long doe = days - era * 146097;
+	const long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const long mp = (5 * doy + 2) / 153;
+	const int day = (int)(doy - (153 * mp + 2) / 5 + 1);
+	const int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+	const int year = (int)(yoe + era * 400 + (month <= 2));
+
+	char szDate[40];
+	sprintf(szDate, "%04d-%02d-%02d %02d:%02d:%02d", year, month, day, (int)(secs / 3600), (int)((secs / 60) % 60), (int)(secs % 60));
+	return szDate;
+}
+
 /* constructTime()
  * Updates a time_t value and corresponding tm struct with given datetime components
  *
@@ -14,6 +14,12 @@ time_t mytime(time_t * _Time);
 bool ParseSQLdatetime(time_t &time, struct tm &result, const std::string szSQLdate);
 bool ParseSQLdatetime(time_t &time, struct tm &result, const std::string szSQLdate, int isdst);
 
+// Cached local timezone offset (seconds east of UTC) and conversions between
+// local SQL datetime strings and UTC epoch values that do not call mktime
+long GetUTCOffset(const time_t time);
+bool SQLdatetimeToEpoch(const std::string &szSQLdate, time_t &time);
+std::string EpochToSQLdatetime(const time_t time);
+
 
 // DST safe datetime constructors
 bool getMidnight(time_t &time, struct tm &result);
@@ -77,6 +77,7 @@
 #include "../hardware/KMTronicSerial.h"
 #include "../hardware/KMTronicTCP.h"
 #include "../hardware/KMTronicUDP.h"
+#include "../hardware/TelemetryIngest.h"
 #include "../hardware/KMTronic433.h"
 #include "../hardware/SolarMaxTCP.h"
 #include "../hardware/Pinger.h"
@@ -784,6 +785,10 @@ bool MainWorker::AddHardwareFromParams(
 		//UDP
 		pHardware = new KMTronicUDP(ID, Address, Port);
 		break;
+	case HTYPE_TelemetryIngest:
+		//UDP
+		pHardware = new CTelemetryIngest(ID, Address, Port, Password);
+		break;
 	case HTYPE_NefitEastLAN:
 		pHardware = new CNefitEasy(ID, Address, Port);
 		break;
@@ -1020,6 +1025,7 @@ bool MainWorker::Start()
 #ifdef USE_PYTHON_PLUGINS
 	m_pluginsystem.StartPluginSystem();
 #endif
+	m_pollscheduler.StartScheduler();
 	AddAllDomoticzHardware();
 	m_fibaropush.Start();
 	m_httppush.Start();
@@ -1052,6 +1058,7 @@ bool MainWorker::Stop()
 		m_sharedserver.StopServer();
 		_log.Log(LOG_STATUS, "Stopping all hardware...");
 		StopDomoticzHardware();
+		m_pollscheduler.StopScheduler();
 		m_scheduler.StopScheduler();
 		m_eventsystem.StopEventSystem();
 		m_fibaropush.Stop();
@@ -1620,7 +1627,7 @@ void MainWorker::SendCommand(const int HwdID, unsigned char Cmd, const char *szM
 		return;
 
 	if (szMessage!=NULL)
-		if (_log.isTraceEnabled()) _log.Log(LOG_TRACE,"MAIN SendCommand: %s", szMessage);
+		_log.Log(LOGCAT_MAIN, LOG_TRACE, "MAIN SendCommand: %s", szMessage);
 
 
 	tRBUF cmd;
@@ -1649,7 +1656,7 @@ bool MainWorker::WriteToHardware(const int HwdID, const char *pdata, const unsig
 		return false;
 
 	return m_hardwaredevices[hindex]->WriteToHardware(pdata,length);
-	if (_log.isTraceEnabled()) _log.Log(LOG_TRACE,"MAIN WriteToHardware %s",m_hardwaredevices[hindex]->Name.c_str()  );
+	_log.Log(LOGCAT_MAIN, LOG_TRACE, "MAIN WriteToHardware %s",m_hardwaredevices[hindex]->Name.c_str()  );
 
 }
 
@@ -2081,7 +2088,7 @@ void MainWorker::ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const
 	std::string DeviceName = "";
 	tcp::server::CTCPClient *pClient2Ignore = NULL;
 
-	if (_log.isTraceEnabled()) {
+	if (_log.isTraceEnabled(LOGCAT_MAIN)) {
 		char  mes[sizeof(tRBUF)*2+2];
 		char * ptmes = mes;
 		for (size_t i = 0; i < Len; i++) {
@@ -2090,7 +2097,7 @@ void MainWorker::ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const
 		}
 		*ptmes = 0 ;
 
-		_log.Log(LOG_TRACE, "MAIN ProcessRX Msg %s", mes);
+		_log.Log(LOGCAT_MAIN, LOG_TRACE, "MAIN ProcessRX Msg %s", mes);
 	}
 
 	if (pHardware->HwdType == HTYPE_Domoticz)
@@ -10755,7 +10762,7 @@ bool MainWorker::SwitchLightInt(const std::vector<std::string> &sd, std::string
 
 	int HardwareID = atoi(sd[0].c_str());
 
-	if (_log.isTraceEnabled()) _log.Log(LOG_TRACE,"MAIN SwitchLightInt : switchcmd:%s level:%d HWid:%d  sd:%s %s %s %s %s %s", switchcmd.c_str(),level,HardwareID ,
+	_log.Log(LOGCAT_MAIN, LOG_TRACE, "MAIN SwitchLightInt : switchcmd:%s level:%d HWid:%d  sd:%s %s %s %s %s %s", switchcmd.c_str(),level,HardwareID ,
 	 sd[0].c_str(), sd[1].c_str(), sd[2].c_str(), sd[3].c_str(), sd[4].c_str(), sd[5].c_str() );
 
 	int hindex=FindDomoticzHardware(HardwareID);
@@ -11732,7 +11739,7 @@ bool MainWorker::SwitchLight(const std::string &idx, const std::string &switchcm
 bool MainWorker::SwitchLight(const uint64_t idx, const std::string &switchcmd, const int level, const int hue, const bool ooc, const int ExtraDelay)
 {
 	//Get Device details
-    if (_log.isTraceEnabled()) _log.Log(LOG_TRACE,"MAIN SwitchLight idx:%d cmd:%s lvl:%d " ,(long)idx,switchcmd.c_str(),level );
+    _log.Log(LOGCAT_MAIN, LOG_TRACE, "MAIN SwitchLight idx:%d cmd:%s lvl:%d " ,(long)idx,switchcmd.c_str(),level );
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query(
 		"SELECT HardwareID,DeviceID,Unit,Type,SubType,SwitchType,AddjValue2,nValue,sValue,Name,Options FROM DeviceStatus WHERE (ID == %" PRIu64 ")",
@@ -11740,8 +11747,12 @@ bool MainWorker::SwitchLight(const uint64_t idx, const std::string &switchcmd, c
 	if (result.size() < 1)
 		return false;
 
-	std::vector<std::string> sd = result[0];
+	return SwitchLight(idx, result[0], switchcmd, level, hue, ooc, ExtraDelay);
+}
 
+//sd holds the DeviceStatus columns HardwareID,DeviceID,Unit,Type,SubType,SwitchType,AddjValue2,nValue,sValue,Name,Options
+bool MainWorker::SwitchLight(const uint64_t idx, const std::vector<std::string> &sd, const std::string &switchcmd, const int level, const int hue, const bool ooc, const int ExtraDelay)
+{
 	//unsigned char dType = atoi(sd[3].c_str());
 	//unsigned char dSubType = atoi(sd[4].c_str());
 	_eSwitchType switchtype = (_eSwitchType)atoi(sd[5].c_str());
@@ -11776,6 +11787,104 @@ bool MainWorker::SwitchLight(const uint64_t idx, const std::string &switchcmd, c
 		return SwitchLightInt(sd, switchcmd, level, hue, false);
 }
 
+void MainWorker::SwitchLights(std::vector<_tSwitchLightRequest> &requests)
+{
+	if (requests.empty())
+		return;
+
+	//Resolve all devices with one query
+	std::stringstream sIDs;
+	std::vector<_tSwitchLightRequest>::iterator itt;
+	for (itt = requests.begin(); itt != requests.end(); ++itt)
+	{
+		itt->bResult = false;
+		if (itt != requests.begin())
+			sIDs << ",";
+		sIDs << itt->idx;
+	}
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query(
+		"SELECT ID,HardwareID,DeviceID,Unit,Type,SubType,SwitchType,AddjValue2,nValue,sValue,Name,Options FROM DeviceStatus WHERE (ID IN (%q))",
+		sIDs.str().c_str());
+
+	std::map<uint64_t, std::vector<std::string> > devices;
+	std::vector<std::vector<std::string> >::iterator itt2;
+	for (itt2 = result.begin(); itt2 != result.end(); ++itt2)
+	{
+		std::vector<std::string> sd = *itt2;
+		uint64_t ID;
+		std::stringstream s_str(sd[0]);
+		s_str >> ID;
+		sd.erase(sd.begin());
+		devices[ID] = sd;
+	}
+
+	//Group the requests per hardware, commands for the same hardware are send in order
+	std::map<int, std::vector<size_t> > hwrequests;
+	for (size_t ii = 0; ii < requests.size(); ii++)
+	{
+		std::map<uint64_t, std::vector<std::string> >::const_iterator ittDevice = devices.find(requests[ii].idx);
+		if (ittDevice == devices.end())
+			continue;
+		hwrequests[atoi(ittDevice->second[0].c_str())].push_back(ii);
+	}
+	if (hwrequests.empty())
+		return;
+
+	if (hwrequests.size() == 1)
+	{
+		SwitchLightsHardware(requests, devices, hwrequests.begin()->second);
+		return;
+	}
+
+	//Different hardware is handled in parallel, a slow (network) hardware does not delay the others
+	std::vector<boost::shared_ptr<boost::thread> > workers;
+	std::map<int, std::vector<size_t> >::const_iterator ittHW;
+	for (ittHW = hwrequests.begin(); ittHW != hwrequests.end(); ++ittHW)
+	{
+		workers.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&MainWorker::SwitchLightsHardware, this, boost::ref(requests), boost::cref(devices), boost::cref(ittHW->second)))));
+	}
+	std::vector<boost::shared_ptr<boost::thread> >::iterator ittWorker;
+	for (ittWorker = workers.begin(); ittWorker != workers.end(); ++ittWorker)
+	{
+		(*ittWorker)->join();
+	}
+}
+
+void MainWorker::SwitchLightsHardware(std::vector<_tSwitchLightRequest> &requests, const std::map<uint64_t, std::vector<std::string> > &devices, const std::vector<size_t> &items)
+{
+	std::vector<size_t>::const_iterator itt;
+	for (itt = items.begin(); itt != items.end(); ++itt)
+	{
+		_tSwitchLightRequest &request = requests[*itt];
+		std::map<uint64_t, std::vector<std::string> >::const_iterator ittDevice = devices.find(request.idx);
+		if (request.switchcmd == "Toggle")
+		{
+			//Resolve the toggle with the current state, a dimmer at a partial level is switched off
+			const std::vector<std::string> &sd = ittDevice->second;
+			unsigned char devType = (unsigned char)atoi(sd[3].c_str());
+			unsigned char subType = (unsigned char)atoi(sd[4].c_str());
+			_eSwitchType switchtype = (_eSwitchType)atoi(sd[5].c_str());
+			int nValue = atoi(sd[7].c_str());
+			std::string lstatus = "";
+			int llevel = 0;
+			bool bHaveDimmer = false;
+			bool bHaveGroupCmd = false;
+			int maxDimLevel = 0;
+			GetLightStatus(devType, subType, switchtype, nValue, sd[8], lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+			request.switchcmd = (IsLightSwitchOn(lstatus) == true) ? "Off" : "On";
+		}
+		try
+		{
+			request.bResult = SwitchLight(request.idx, ittDevice->second, request.switchcmd, request.level, request.hue, request.ooc, 0);
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "SwitchLights: Exception switching device idx: %" PRIu64, request.idx);
+		}
+	}
+}
+
 bool MainWorker::SetSetPoint(const std::string &idx, const float TempValue, const int newMode, const std::string &until)
 {
 	//Get Device details
@@ -12000,7 +12109,7 @@ bool MainWorker::SetSetPointInt(const std::vector<std::string> &sd, const float
 			if (pHardware->HwdType == HTYPE_Dummy)
 			{
 				//Also set it in the database, ad this devices does not send updates
-				_log.Log(LOG_TRACE, "MAIN SetPoint command Idx=%s : Temp=%f",sd[7].c_str(),TempValue);
+				_log.Log(LOGCAT_MAIN, LOG_TRACE, "MAIN SetPoint command Idx=%s : Temp=%f",sd[7].c_str(),TempValue);
 				PushAndWaitRxMessage(pHardware, (const unsigned char*)&tmeter, NULL, -1);
 			}
 		}
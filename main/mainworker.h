@@ -3,6 +3,7 @@
 #include "RFXtrx.h"
 #include "../hardware/DomoticzHardware.h"
 #include "Scheduler.h"
+#include "PollScheduler.h"
 #include "EventSystem.h"
 #include "Camera.h"
 #include <map>
@@ -61,6 +62,18 @@ public:
 
 	bool SwitchLight(const std::string &idx, const std::string &switchcmd,const std::string &level, const std::string &hue, const std::string &ooc, const int ExtraDelay);
 	bool SwitchLight(const uint64_t idx, const std::string &switchcmd, const int level, const int hue, const bool ooc, const int ExtraDelay);
+	bool SwitchLight(const uint64_t idx, const std::vector<std::string> &sd, const std::string &switchcmd, const int level, const int hue, const bool ooc, const int ExtraDelay);
+
+	struct _tSwitchLightRequest
+	{
+		uint64_t idx;
+		std::string switchcmd;
+		int level;
+		int hue;
+		bool ooc;
+		bool bResult;
+	};
+	void SwitchLights(std::vector<_tSwitchLightRequest> &requests);
 	bool SwitchLightInt(const std::vector<std::string> &sd, std::string switchcmd, int level, int hue, const bool IsTesting);
 
 	bool SwitchScene(const std::string &idx, const std::string &switchcmd);
@@ -117,6 +130,7 @@ public:
 	boost::signals2::signal<void(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)> sOnDeviceReceived;
 
 	CScheduler m_scheduler;
+	CPollScheduler m_pollscheduler;
 	CEventSystem m_eventsystem;
 #ifdef USE_PYTHON_PLUGINS
 	Plugins::CPluginSystem m_pluginsystem;
@@ -144,6 +158,7 @@ public:
 
 private:
 	void HandleAutomaticBackups();
+	void SwitchLightsHardware(std::vector<_tSwitchLightRequest> &requests, const std::map<uint64_t, std::vector<std::string> > &devices, const std::vector<size_t> &items);
 	uint64_t PerformRealActionFromDomoticzClient(const unsigned char *pRXCommand, CDomoticzHardwareBase **pOriginalHardware);
 	void HandleLogNotifications();
 	std::map<std::string, time_t > m_componentheartbeats;
@@ -13,6 +13,12 @@
 #include "../webserver/cWebem.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <fstream>
+#include <sys/stat.h>
+
+#define PUBSUB_DEFAULT_BATCH_SIZE 20
+#define PUBSUB_DEFAULT_BATCH_INTERVAL 1000	//ms
+#define PUBSUB_MAX_QUEUE_SIZE 1000
 
 #ifdef ENABLE_PYTHON
 extern "C" {
@@ -27,7 +33,11 @@ extern std::string szUserDataFolder;
 // this should be filled in by the preprocessor
 extern const char * Python_exe;
 
-CGooglePubSubPush::CGooglePubSubPush()
+CGooglePubSubPush::CGooglePubSubPush():
+	m_stoprequested(false),
+	m_BatchSize(PUBSUB_DEFAULT_BATCH_SIZE),
+	m_BatchInterval(PUBSUB_DEFAULT_BATCH_INTERVAL),
+	m_ScriptModTime(0)
 {
 	m_bLinkActive = false;
 }
@@ -36,12 +46,14 @@ void CGooglePubSubPush::Start()
 {
 	UpdateActive();
 	m_sConnection = m_mainworker.sOnDeviceReceived.connect(boost::bind(&CGooglePubSubPush::OnDeviceReceived, this, _1, _2, _3, _4));
+	StartThread();
 }
 
 void CGooglePubSubPush::Stop()
 {
 	if (m_sConnection.connected())
 		m_sConnection.disconnect();
+	StopThread();
 }
 
 
@@ -50,6 +62,12 @@ void CGooglePubSubPush::UpdateActive()
 	int fActive;
 	m_sql.GetPreferencesVar("GooglePubSubActive", fActive);
 	m_bLinkActive = (fActive == 1);
+	int nValue = PUBSUB_DEFAULT_BATCH_SIZE;
+	m_sql.GetPreferencesVar("GooglePubSubBatchSize", nValue);
+	m_BatchSize = (nValue < 1) ? 1 : nValue;
+	nValue = PUBSUB_DEFAULT_BATCH_INTERVAL;
+	m_sql.GetPreferencesVar("GooglePubSubBatchInterval", nValue);
+	m_BatchInterval = (nValue < 10) ? 10 : nValue;
 }
 
 void CGooglePubSubPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
@@ -223,74 +241,193 @@ void CGooglePubSubPush::DoGooglePubSubPush()
 			replaceAll(googlePubSubData, "%idx", sdeviceId);
 
 			if (sendValue != "") {
-				std::stringstream python_DirT;
-
+				// debug
+				if (googlePubSubDebugActive) {
+					_log.Log(LOG_NORM, "GooglePubSubLink: data to send : %s", googlePubSubData.c_str());
+				}
 #ifdef ENABLE_PYTHON
-#ifdef WIN32
-				python_DirT << szUserDataFolder << "scripts\\python\\";
-				std::string filename = szUserDataFolder + "scripts\\python\\" + "googlepubsub.py";
+				boost::lock_guard<boost::mutex> l(m_background_task_mutex);
+				if (m_background_task_queue.size() < PUBSUB_MAX_QUEUE_SIZE)
+				{
+					m_background_task_queue.push_back(googlePubSubData);
+					if ((int)m_background_task_queue.size() >= m_BatchSize)
+						m_background_task_cond.notify_one();
+				}
+				else
+					_log.Log(LOG_ERROR, "GooglePubSubLink: Queue full, data dropped!");
 #else
-				python_DirT << szUserDataFolder << "scripts/python/";
-				std::string filename = szUserDataFolder + "scripts/python/" + "googlepubsub.py";
+				_log.Log(LOG_ERROR, "Error sending data to GooglePubSub : Python not available!");
 #endif
+			}
+		}
+	}
+}
 
-				char * argv[1];
-				argv[0]=(char *)filename.c_str();
-				PySys_SetArgv(1,argv);
-
-				std::string python_Dir = python_DirT.str();
-				if (!Py_IsInitialized()) {
-					Py_SetProgramName((char*)Python_exe); // will this cast lead to problems ?
-					Py_Initialize();
-					Py_InitModule("domoticz_", DomoticzMethods);
+bool CGooglePubSubPush::StartThread()
+{
+	StopThread();
+	m_stoprequested = false;
+	m_background_task_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&CGooglePubSubPush::Do_Work, this)));
+	return (m_background_task_thread != NULL);
+}
 
-					// TODO: may have a small memleak, remove references in destructor
-					PyObject* sys = PyImport_ImportModule("sys");
-					PyObject *path = PyObject_GetAttrString(sys, "path");
-				}
+void CGooglePubSubPush::StopThread()
+{
+	if (m_background_task_thread)
+	{
+		{
+			boost::lock_guard<boost::mutex> l(m_background_task_mutex);
+			m_stoprequested = true;
+			m_background_task_cond.notify_one();
+		}
+		m_background_task_thread->join();
+		m_background_task_thread.reset();
+	}
+}
 
-				FILE* PythonScriptFile = fopen(filename.c_str(), "r");
-				object main_module = import("__main__");
-				object main_namespace = dict(main_module.attr("__dict__")).copy();
+//Collects the queued data and hands it to the script in batches,
+//when the batch size is reached or the batch interval has passed
+void CGooglePubSubPush::Do_Work()
+{
+	std::vector<std::string> _items2do;
 
-				try {
-					object domoticz_module = import("domoticz");
-					object reloader = import("reloader");
-					reloader.attr("_check_reload")();
+	while (!m_stoprequested)
+	{
+		{
+			boost::unique_lock<boost::mutex> lock(m_background_task_mutex);
+			if ((int)m_background_task_queue.size() < m_BatchSize)
+				m_background_task_cond.timed_wait(lock, boost::posix_time::milliseconds(m_BatchInterval));
+			if ((m_stoprequested) || (m_background_task_queue.empty()))
+				continue;
+			_items2do = m_background_task_queue;
+			m_background_task_queue.clear();
+		}
 
-					object domoticz_namespace = domoticz_module.attr("__dict__");
-					main_namespace["data"] = googlePubSubData;
-					domoticz_namespace["data"] = googlePubSubData;
+		std::vector<std::string>::const_iterator itt = _items2do.begin();
+		while (itt != _items2do.end())
+		{
+			std::vector<std::string>::const_iterator ittEnd = itt;
+			if (_items2do.end() - itt > m_BatchSize)
+				ittEnd += m_BatchSize;
+			else
+				ittEnd = _items2do.end();
+			PublishBatch(std::vector<std::string>(itt, ittEnd));
+			itt = ittEnd;
+		}
+	}
+}
 
-					// debug
-					if (googlePubSubDebugActive) {
-						_log.Log(LOG_NORM, "GooglePubSubLink: data to send : %s", googlePubSubData.c_str());
-					}
+#ifdef ENABLE_PYTHON
+//The compiled script and the namespace it was executed in (only used by the worker thread)
+static PyObject *pPubSubCode = NULL;
+static PyObject *pPubSubNamespace = NULL;
+#endif
 
-					object ignored = exec_file(str(filename), main_namespace);
-				}
-				catch (...) {
-					PyObject *exc, *val, *tb;
-					PyErr_Fetch(&exc, &val, &tb);
-					boost::python::handle<> hexc(exc), hval(boost::python::allow_null(val)), htb(boost::python::allow_null(tb));
-					boost::python::object traceback(boost::python::import("traceback"));
-
-					boost::python::object format_exception(traceback.attr("format_exception"));
-					boost::python::object formatted_list = format_exception(hexc, hval, htb);
-					boost::python::object formatted = boost::python::str("\n").join(formatted_list);
-
-					object traceback_module = import("traceback");
-					std::string formatted_str = extract<std::string>(formatted);
-					//PyErr_Print();
-					PyErr_Clear();
-					_log.Log(LOG_ERROR, "%s", formatted_str.c_str());
-				}
+void CGooglePubSubPush::PublishBatch(const std::vector<std::string> &items)
+{
+#ifdef ENABLE_PYTHON
+	std::stringstream python_DirT;
+#ifdef WIN32
+	python_DirT << szUserDataFolder << "scripts\\python\\";
+	std::string filename = szUserDataFolder + "scripts\\python\\" + "googlepubsub.py";
 #else
-				_log.Log(LOG_ERROR, "Error sending data to GooglePubSub : Python not available!");
+	python_DirT << szUserDataFolder << "scripts/python/";
+	std::string filename = szUserDataFolder + "scripts/python/" + "googlepubsub.py";
 #endif
+	std::string python_Dir = python_DirT.str();
+
+	if (!Py_IsInitialized()) {
+		Py_SetProgramName((char*)Python_exe); // will this cast lead to problems ?
+		Py_Initialize();
+		Py_InitModule("domoticz_", DomoticzMethods);
+
+		// TODO: may have a small memleak, remove references in destructor
+		PyObject* sys = PyImport_ImportModule("sys");
+		PyObject *path = PyObject_GetAttrString(sys, "path");
+		PyList_Append(path, PyString_FromString(python_Dir.c_str()));
+	}
+
+	try {
+		object reloader = import("reloader");
+		reloader.attr("_check_reload")();
+
+		//Compile the script only when it is changed
+		struct stat st;
+		if (stat(filename.c_str(), &st) != 0)
+		{
+			_log.Log(LOG_ERROR, "GooglePubSubLink: Script not found: %s", filename.c_str());
+			return;
+		}
+		if ((pPubSubCode == NULL) || (st.st_mtime != m_ScriptModTime))
+		{
+			std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+			std::string szScript((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+			is.close();
+
+			Py_XDECREF(pPubSubCode);
+			Py_XDECREF(pPubSubNamespace);
+			pPubSubCode = NULL;
+			pPubSubNamespace = NULL;
+
+			char * argv[1];
+			argv[0] = (char *)filename.c_str();
+			PySys_SetArgv(1, argv);
+
+			object code(handle<>(Py_CompileString(szScript.c_str(), filename.c_str(), Py_file_input)));
+			object main_module = import("__main__");
+			object main_namespace = dict(main_module.attr("__dict__")).copy();
+			//Not __main__, only define the functions of the script
+			main_namespace["__name__"] = "googlepubsub";
+			main_namespace["__file__"] = filename;
+			object ignored(handle<>(PyEval_EvalCode((PyCodeObject*)code.ptr(), main_namespace.ptr(), main_namespace.ptr())));
+
+			pPubSubCode = code.ptr();
+			Py_INCREF(pPubSubCode);
+			pPubSubNamespace = main_namespace.ptr();
+			Py_INCREF(pPubSubNamespace);
+			m_ScriptModTime = st.st_mtime;
+		}
+
+		object main_namespace(handle<>(borrowed(pPubSubNamespace)));
+		if (main_namespace.contains("publish_batch"))
+		{
+			boost::python::list data;
+			std::vector<std::string>::const_iterator itt;
+			for (itt = items.begin(); itt != items.end(); ++itt)
+				data.append(*itt);
+			main_namespace["publish_batch"](data);
+		}
+		else
+		{
+			//Older script without publish_batch, run it for every item
+			object domoticz_module = import("domoticz");
+			object domoticz_namespace = domoticz_module.attr("__dict__");
+			object run_namespace = dict(main_namespace).copy();
+			run_namespace["__name__"] = "__main__";
+			std::vector<std::string>::const_iterator itt;
+			for (itt = items.begin(); itt != items.end(); ++itt)
+			{
+				run_namespace["data"] = *itt;
+				domoticz_namespace["data"] = *itt;
+				object ignored(handle<>(PyEval_EvalCode((PyCodeObject*)pPubSubCode, run_namespace.ptr(), run_namespace.ptr())));
 			}
 		}
 	}
+	catch (...) {
+		PyObject *exc, *val, *tb;
+		PyErr_Fetch(&exc, &val, &tb);
+		boost::python::handle<> hexc(exc), hval(boost::python::allow_null(val)), htb(boost::python::allow_null(tb));
+		boost::python::object traceback(boost::python::import("traceback"));
+
+		boost::python::object format_exception(traceback.attr("format_exception"));
+		boost::python::object formatted_list = format_exception(hexc, hval, htb);
+		boost::python::object formatted = boost::python::str("\n").join(formatted_list);
+
+		std::string formatted_str = extract<std::string>(formatted);
+		PyErr_Clear();
+		_log.Log(LOG_ERROR, "%s", formatted_str.c_str());
+	}
+#endif
 }
 
 //Webserver helpers
@@ -318,6 +455,13 @@ namespace http {
 			m_sql.UpdatePreferencesVar("GooglePubSubData", data.c_str());
 			m_sql.UpdatePreferencesVar("GooglePubSubActive", ilinkactive);
 			m_sql.UpdatePreferencesVar("GooglePubSubDebug", idebugenabled);
+			//optional
+			std::string batchsize = request::findValue(&req, "batchsize");
+			std::string batchinterval = request::findValue(&req, "batchinterval");
+			if (!batchsize.empty())
+				m_sql.UpdatePreferencesVar("GooglePubSubBatchSize", atoi(batchsize.c_str()));
+			if (!batchinterval.empty())
+				m_sql.UpdatePreferencesVar("GooglePubSubBatchInterval", atoi(batchinterval.c_str()));
 
 			m_googlepubsubpush.UpdateActive();
 			root["status"] = "OK";
@@ -349,6 +493,12 @@ namespace http {
 			{
 				root["GooglePubSubData"] = sValue;
 			}
+			nValue = PUBSUB_DEFAULT_BATCH_SIZE;
+			m_sql.GetPreferencesVar("GooglePubSubBatchSize", nValue);
+			root["GooglePubSubBatchSize"] = nValue;
+			nValue = PUBSUB_DEFAULT_BATCH_INTERVAL;
+			m_sql.GetPreferencesVar("GooglePubSubBatchInterval", nValue);
+			root["GooglePubSubBatchInterval"] = nValue;
 			root["status"] = "OK";
 			root["title"] = "GetGooglePubSubLinkConfig";
 		}
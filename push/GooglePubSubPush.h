@@ -1,6 +1,7 @@
 #pragma once
 
 #include <boost/signals2.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include "BasePush.h"
 
@@ -16,6 +17,20 @@ private:
 
 	void OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
 	void DoGooglePubSubPush();
+
+	boost::shared_ptr<boost::thread> m_background_task_thread;
+	boost::mutex m_background_task_mutex;
+	boost::condition_variable m_background_task_cond;
+	bool m_stoprequested;
+	bool StartThread();
+	void StopThread();
+	void Do_Work();
+	void PublishBatch(const std::vector<std::string> &items);
+
+	std::vector<std::string> m_background_task_queue;
+	int m_BatchSize;
+	int m_BatchInterval; //ms
+	time_t m_ScriptModTime;
 };
 extern CGooglePubSubPush m_googlepubsubpush;
 
@@ -48,6 +48,24 @@ def publish_message(client,topicname,message):
         }
         resp = client.projects().topics().publish(topic=topicname, body=body).execute()
 
+# Called by Domoticz with a list of messages, the script is only loaded once
+# so the client is created on the first call and reused
+pubsub_client = None
+
+def publish_batch(messages):
+        global pubsub_client
+        if pubsub_client is None:
+                pubsub_client = create_pubsub_client()
+        body = {
+                'messages': [{'data': base64.b64encode(message)} for message in messages]
+        }
+        try:
+                resp = pubsub_client.projects().topics().publish(topic=PUBSUB_TOPICNAME, body=body).execute()
+        except Exception:
+                # create a new client on the next batch (expired credentials, ...)
+                pubsub_client = None
+                raise
+
 def main(argv):
         client = create_pubsub_client()
         publish_message(client,PUBSUB_TOPICNAME,data)
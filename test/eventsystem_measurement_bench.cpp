@@ -0,0 +1,371 @@
+/*
+Micro-benchmark of the event system measurement tables.
+
+Compares the full rebuild (GetCurrentMeasurementStates, what every Lua and Blockly
+evaluation did before the tables were kept per device) with the incremental update of
+one changed device (UpdateMeasurementState) on a set of 1,000 devices.
+
+The table maintenance below is a copy of the code in main/EventSystem.cpp, the parsing
+is reduced to the temperature, humidity, barometer, wind and utility sensors. The
+Meter and Rain queries the rebuild does for counters and rain sensors are not part of
+it, so on a real system the rebuild is slower than measured here.
+
+Build and run:
+	g++ -O2 -std=c++11 -o /tmp/eventsystem_measurement_bench test/eventsystem_measurement_bench.cpp
+	/tmp/eventsystem_measurement_bench [devices]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+enum _eBenchDeviceType
+{
+	bTypeTemp = 0,
+	bTypeTempHum,
+	bTypeTempHumBaro,
+	bTypeWind,
+	bTypeUtility,
+	bTypeSwitch,
+	bTypeEnd
+};
+
+struct _tDeviceStatus
+{
+	uint64_t ID;
+	std::string deviceName;
+	unsigned long long nValue;
+	std::string sValue;
+	unsigned char devType;
+};
+
+struct _tMeasurementState
+{
+	std::string deviceName;
+	float temp;
+	float dewpoint;
+	int humidity;
+	float barometer;
+	float utilityval;
+	float winddir;
+	float windspeed;
+	float windgust;
+	bool isTemp;
+	bool isDew;
+	bool isHum;
+	bool isBaro;
+	bool isUtility;
+	bool isWindDir;
+	bool isWindSpeed;
+	bool isWindGust;
+};
+
+static void StringSplit(std::string str, const std::string &delim, std::vector<std::string> &results)
+{
+	results.clear();
+	size_t cutAt;
+	while ((cutAt = str.find(delim)) != std::string::npos)
+	{
+		results.push_back(str.substr(0, cutAt));
+		str = str.substr(cutAt + delim.size());
+	}
+	if (!str.empty())
+		results.push_back(str);
+}
+
+class CMeasurementTables
+{
+public:
+	std::map<uint64_t, _tDeviceStatus> m_devicestates;
+
+	void GetCurrentMeasurementStates()
+	{
+		m_tempValuesByName.clear();
+		m_dewValuesByName.clear();
+		m_humValuesByName.clear();
+		m_baroValuesByName.clear();
+		m_utilityValuesByName.clear();
+		m_winddirValuesByName.clear();
+		m_windspeedValuesByName.clear();
+		m_windgustValuesByName.clear();
+
+		m_tempValuesByID.clear();
+		m_dewValuesByID.clear();
+		m_humValuesByID.clear();
+		m_baroValuesByID.clear();
+		m_utilityValuesByID.clear();
+		m_winddirValuesByID.clear();
+		m_windspeedValuesByID.clear();
+		m_windgustValuesByID.clear();
+
+		m_measurementStates.clear();
+		m_measurementNames.clear();
+
+		std::map<uint64_t, _tDeviceStatus>::const_iterator itt;
+		for (itt = m_devicestates.begin(); itt != m_devicestates.end(); ++itt)
+			UpdateMeasurementState(itt->second);
+	}
+
+	void RemoveMeasurementState(const uint64_t ulDevID)
+	{
+		std::map<uint64_t, _tMeasurementState>::iterator itt = m_measurementStates.find(ulDevID);
+		if (itt == m_measurementStates.end())
+			return;
+		std::string deviceName = itt->second.deviceName;
+		m_tempValuesByID.erase(ulDevID);
+		m_dewValuesByID.erase(ulDevID);
+		m_humValuesByID.erase(ulDevID);
+		m_baroValuesByID.erase(ulDevID);
+		m_utilityValuesByID.erase(ulDevID);
+		m_winddirValuesByID.erase(ulDevID);
+		m_windspeedValuesByID.erase(ulDevID);
+		m_windgustValuesByID.erase(ulDevID);
+		m_measurementStates.erase(itt);
+
+		std::map<std::string, std::set<uint64_t> >::iterator ittName = m_measurementNames.find(deviceName);
+		if (ittName != m_measurementNames.end())
+		{
+			ittName->second.erase(ulDevID);
+			if (ittName->second.empty())
+				m_measurementNames.erase(ittName);
+		}
+		UpdateMeasurementName(deviceName);
+	}
+
+	void UpdateMeasurementState(const _tDeviceStatus &sitem)
+	{
+		RemoveMeasurementState(sitem.ID);
+
+		_tMeasurementState mstate;
+		if (!ParseMeasurementState(sitem, mstate))
+			return;
+
+		if (mstate.isTemp)
+			m_tempValuesByID[sitem.ID] = mstate.temp;
+		if (mstate.isDew)
+			m_dewValuesByID[sitem.ID] = mstate.dewpoint;
+		if (mstate.isHum)
+			m_humValuesByID[sitem.ID] = mstate.humidity;
+		if (mstate.isBaro)
+			m_baroValuesByID[sitem.ID] = mstate.barometer;
+		if (mstate.isUtility)
+			m_utilityValuesByID[sitem.ID] = mstate.utilityval;
+		if (mstate.isWindDir)
+			m_winddirValuesByID[sitem.ID] = mstate.winddir;
+		if (mstate.isWindSpeed)
+			m_windspeedValuesByID[sitem.ID] = mstate.windspeed;
+		if (mstate.isWindGust)
+			m_windgustValuesByID[sitem.ID] = mstate.windgust;
+		m_measurementStates[sitem.ID] = mstate;
+		m_measurementNames[mstate.deviceName].insert(sitem.ID);
+		UpdateMeasurementName(mstate.deviceName);
+	}
+
+	size_t GetTempCount() const
+	{
+		return m_tempValuesByID.size();
+	}
+private:
+	void UpdateMeasurementName(const std::string &deviceName)
+	{
+		m_tempValuesByName.erase(deviceName);
+		m_dewValuesByName.erase(deviceName);
+		m_humValuesByName.erase(deviceName);
+		m_baroValuesByName.erase(deviceName);
+		m_utilityValuesByName.erase(deviceName);
+		m_winddirValuesByName.erase(deviceName);
+		m_windspeedValuesByName.erase(deviceName);
+		m_windgustValuesByName.erase(deviceName);
+
+		std::map<std::string, std::set<uint64_t> >::const_iterator ittName = m_measurementNames.find(deviceName);
+		if (ittName == m_measurementNames.end())
+			return;
+		std::set<uint64_t>::const_iterator ittID;
+		for (ittID = ittName->second.begin(); ittID != ittName->second.end(); ++ittID)
+		{
+			const _tMeasurementState &mstate = m_measurementStates[*ittID];
+			if (mstate.isTemp)
+				m_tempValuesByName[deviceName] = mstate.temp;
+			if (mstate.isDew)
+				m_dewValuesByName[deviceName] = mstate.dewpoint;
+			if (mstate.isHum)
+				m_humValuesByName[deviceName] = mstate.humidity;
+			if (mstate.isBaro)
+				m_baroValuesByName[deviceName] = mstate.barometer;
+			if (mstate.isUtility)
+				m_utilityValuesByName[deviceName] = mstate.utilityval;
+			if (mstate.isWindDir)
+				m_winddirValuesByName[deviceName] = mstate.winddir;
+			if (mstate.isWindSpeed)
+				m_windspeedValuesByName[deviceName] = mstate.windspeed;
+			if (mstate.isWindGust)
+				m_windgustValuesByName[deviceName] = mstate.windgust;
+		}
+	}
+
+	bool ParseMeasurementState(const _tDeviceStatus &sitem, _tMeasurementState &mstate)
+	{
+		std::vector<std::string> splitresults;
+		StringSplit(sitem.sValue, ";", splitresults);
+
+		mstate = _tMeasurementState();
+		switch (sitem.devType)
+		{
+		case bTypeTemp:
+			if (!splitresults.empty())
+			{
+				mstate.temp = static_cast<float>(atof(splitresults[0].c_str()));
+				mstate.isTemp = true;
+			}
+			break;
+		case bTypeTempHum:
+			if (splitresults.size() > 1)
+			{
+				mstate.temp = static_cast<float>(atof(splitresults[0].c_str()));
+				mstate.humidity = atoi(splitresults[1].c_str());
+				mstate.dewpoint = mstate.temp - ((100 - mstate.humidity) / 5.0f);
+				mstate.isTemp = true;
+				mstate.isHum = true;
+				mstate.isDew = true;
+			}
+			break;
+		case bTypeTempHumBaro:
+			if (splitresults.size() > 3)
+			{
+				mstate.temp = static_cast<float>(atof(splitresults[0].c_str()));
+				mstate.humidity = atoi(splitresults[1].c_str());
+				mstate.barometer = static_cast<float>(atof(splitresults[3].c_str()));
+				mstate.dewpoint = mstate.temp - ((100 - mstate.humidity) / 5.0f);
+				mstate.isTemp = true;
+				mstate.isHum = true;
+				mstate.isBaro = true;
+				mstate.isDew = true;
+			}
+			break;
+		case bTypeWind:
+			if (splitresults.size() > 5)
+			{
+				mstate.winddir = static_cast<float>(atof(splitresults[0].c_str()));
+				mstate.windspeed = static_cast<float>(atof(splitresults[2].c_str())) / 10.0f;
+				mstate.windgust = static_cast<float>(atof(splitresults[3].c_str())) / 10.0f;
+				mstate.temp = static_cast<float>(atof(splitresults[4].c_str()));
+				mstate.isWindDir = true;
+				mstate.isWindSpeed = true;
+				mstate.isWindGust = true;
+				mstate.isTemp = true;
+			}
+			break;
+		case bTypeUtility:
+			if (!splitresults.empty())
+			{
+				mstate.utilityval = static_cast<float>(atof(splitresults[0].c_str()));
+				mstate.isUtility = true;
+			}
+			break;
+		default:
+			return false;
+		}
+		mstate.deviceName = sitem.deviceName;
+		return true;
+	}
+
+	std::map<uint64_t, _tMeasurementState> m_measurementStates;
+	std::map<std::string, std::set<uint64_t> > m_measurementNames;
+
+	std::map<std::string, float> m_tempValuesByName;
+	std::map<std::string, float> m_dewValuesByName;
+	std::map<std::string, int> m_humValuesByName;
+	std::map<std::string, float> m_baroValuesByName;
+	std::map<std::string, float> m_utilityValuesByName;
+	std::map<std::string, float> m_winddirValuesByName;
+	std::map<std::string, float> m_windspeedValuesByName;
+	std::map<std::string, float> m_windgustValuesByName;
+
+	std::map<uint64_t, float> m_tempValuesByID;
+	std::map<uint64_t, float> m_dewValuesByID;
+	std::map<uint64_t, int> m_humValuesByID;
+	std::map<uint64_t, float> m_baroValuesByID;
+	std::map<uint64_t, float> m_utilityValuesByID;
+	std::map<uint64_t, float> m_winddirValuesByID;
+	std::map<uint64_t, float> m_windspeedValuesByID;
+	std::map<uint64_t, float> m_windgustValuesByID;
+};
+
+static std::string MakeSValue(const int devType, const int seed)
+{
+	char szTmp[100];
+	float temp = 15.0f + (seed % 100) / 10.0f;
+	switch (devType)
+	{
+	case bTypeTemp:
+		sprintf(szTmp, "%.1f", temp);
+		break;
+	case bTypeTempHum:
+		sprintf(szTmp, "%.1f;%d;1", temp, 40 + (seed % 40));
+		break;
+	case bTypeTempHumBaro:
+		sprintf(szTmp, "%.1f;%d;1;%d;0", temp, 40 + (seed % 40), 990 + (seed % 40));
+		break;
+	case bTypeWind:
+		sprintf(szTmp, "%d;SW;%d;%d;%.1f;%.1f", seed % 360, seed % 100, seed % 150, temp, temp - 2.0f);
+		break;
+	case bTypeUtility:
+		sprintf(szTmp, "%.3f", seed / 7.0f);
+		break;
+	default:
+		sprintf(szTmp, "%d", seed % 2);
+		break;
+	}
+	return szTmp;
+}
+
+int main(int argc, char *argv[])
+{
+	int nDevices = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (nDevices < 1)
+		nDevices = 1000;
+
+	CMeasurementTables tables;
+	for (int ii = 0; ii < nDevices; ii++)
+	{
+		_tDeviceStatus sitem;
+		char szName[50];
+		sprintf(szName, "Device %d", ii);
+		sitem.ID = ii + 1;
+		sitem.deviceName = szName;
+		sitem.devType = (unsigned char)(ii % bTypeEnd);
+		sitem.nValue = 0;
+		sitem.sValue = MakeSValue(sitem.devType, ii);
+		tables.m_devicestates[sitem.ID] = sitem;
+	}
+	tables.GetCurrentMeasurementStates();
+
+	const int nRebuilds = 500;
+	std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < nRebuilds; ii++)
+		tables.GetCurrentMeasurementStates();
+	double rebuildUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tStart).count() / nRebuilds;
+
+	//Each update changes the value of the next device, as a sensor report would
+	const int nUpdates = 200000;
+	tStart = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < nUpdates; ii++)
+	{
+		_tDeviceStatus &sitem = tables.m_devicestates[(ii % nDevices) + 1];
+		sitem.sValue = MakeSValue(sitem.devType, ii);
+		tables.UpdateMeasurementState(sitem);
+	}
+	double updateUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tStart).count() / nUpdates;
+
+	printf("devices: %d (%d with a temperature)\n", nDevices, (int)tables.GetTempCount());
+	printf("full rebuild:       %10.2f us\n", rebuildUs);
+	printf("incremental update: %10.2f us (including the sValue of the update)\n", updateUs);
+	printf("ratio:              %10.1fx\n", rebuildUs / updateUs);
+	return 0;
+}
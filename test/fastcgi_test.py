@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""
+Test of the FastCGI client of the domoticz web server against a stand-in responder.
+
+The script runs a minimal FastCGI responder and checks the replies of domoticz
+for a few php pages. Start domoticz with the responder as FastCGI server and a
+www root that contains the pages (their content is not used, they only have to exist):
+
+	touch www/fcgi_ok.php www/fcgi_redirect.php www/fcgi_missing.php www/fcgi_hang.php
+	domoticz -www 8080 -fastcgi_server 127.0.0.1:9123
+	test/fastcgi_test.py -u http://127.0.0.1:8080 -l 127.0.0.1:9123
+
+The responder answers by script name:
+	fcgi_ok.php        200 with a body that echoes the request parameters
+	fcgi_redirect.php  302 with a Location header
+	fcgi_missing.php   404
+	fcgi_hang.php      never answers, domoticz should give up after its read timeout,
+	                   json requests are answered in the meantime
+
+With -r only the responder is started (for manual tests).
+"""
+
+import argparse
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+
+FCGI_BEGIN_REQUEST = 1
+FCGI_END_REQUEST = 3
+FCGI_PARAMS = 4
+FCGI_STDIN = 5
+FCGI_STDOUT = 6
+FCGI_KEEP_CONN = 1
+
+
+def read_exact(conn, length):
+	data = b""
+	while len(data) < length:
+		chunk = conn.recv(length - len(data))
+		if not chunk:
+			raise EOFError()
+		data += chunk
+	return data
+
+
+def read_record(conn):
+	version, rtype, request_id, length, padding, _ = struct.unpack("!BBHHBB", read_exact(conn, 8))
+	content = read_exact(conn, length)
+	if padding:
+		read_exact(conn, padding)
+	return rtype, request_id, content
+
+
+def write_record(conn, rtype, request_id, content):
+	padding = (8 - len(content) % 8) % 8
+	conn.sendall(struct.pack("!BBHHBB", 1, rtype, request_id, len(content), padding, 0) + content + b"\0" * padding)
+
+
+def decode_params(data):
+	params = {}
+	pos = 0
+	while pos < len(data):
+		lengths = []
+		for _ in range(2):
+			if data[pos] & 0x80:
+				lengths.append(struct.unpack("!I", data[pos:pos + 4])[0] & 0x7FFFFFFF)
+				pos += 4
+			else:
+				lengths.append(data[pos])
+				pos += 1
+		name = data[pos:pos + lengths[0]].decode("latin-1")
+		pos += lengths[0]
+		params[name] = data[pos:pos + lengths[1]].decode("latin-1")
+		pos += lengths[1]
+	return params
+
+
+def respond(params, stdin):
+	script = os.path.basename(params.get("SCRIPT_NAME", ""))
+	if script == "fcgi_redirect.php":
+		return b"Status: 302 Found\r\nLocation: /index.html\r\nContent-Type: text/html\r\n\r\n"
+	if script == "fcgi_missing.php":
+		return b"Status: 404 Not Found\r\nContent-Type: text/html\r\n\r\nnot here"
+	if script == "fcgi_hang.php":
+		return None
+	body = "method=%s query=%s length=%d" % (params.get("REQUEST_METHOD"), params.get("QUERY_STRING"), len(stdin))
+	return ("Content-Type: text/plain\r\n\r\n" + body).encode("latin-1")
+
+
+def serve_connection(conn):
+	try:
+		while True:
+			params_data = b""
+			stdin = b""
+			request_id = None
+			keep_conn = False
+			while True:
+				rtype, rid, content = read_record(conn)
+				if rtype == FCGI_BEGIN_REQUEST:
+					request_id = rid
+					keep_conn = (content[2] & FCGI_KEEP_CONN) != 0
+				elif rtype == FCGI_PARAMS:
+					params_data += content
+				elif rtype == FCGI_STDIN:
+					if not content:
+						break
+					stdin += content
+			output = respond(decode_params(params_data), stdin)
+			if output is None:
+				time.sleep(3600)
+				return
+			# send the output in small records, the client has to join them
+			for pos in range(0, len(output), 16):
+				write_record(conn, FCGI_STDOUT, request_id, output[pos:pos + 16])
+			write_record(conn, FCGI_STDOUT, request_id, b"")
+			write_record(conn, FCGI_END_REQUEST, request_id, struct.pack("!IB3x", 0, 0))
+			if not keep_conn:
+				return
+	except (EOFError, OSError):
+		pass
+	finally:
+		conn.close()
+
+
+def run_responder(listen):
+	if ":" in listen:
+		host, port = listen.rsplit(":", 1)
+		server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+		server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+		server.bind((host, int(port)))
+	else:
+		if os.path.exists(listen):
+			os.unlink(listen)
+		server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+		server.bind(listen)
+	server.listen(16)
+	while True:
+		conn, _ = server.accept()
+		threading.Thread(target=serve_connection, args=(conn,), daemon=True).start()
+
+
+class NoRedirect(urllib.request.HTTPRedirectHandler):
+	def redirect_request(self, req, fp, code, msg, headers, newurl):
+		return None
+
+
+def fetch(url, timeout):
+	opener = urllib.request.build_opener(NoRedirect)
+	try:
+		resp = opener.open(url, timeout=timeout)
+	except urllib.error.HTTPError as e:
+		resp = e
+	body = resp.read()
+	return resp.status if hasattr(resp, "status") else resp.code, resp.headers, body
+
+
+def check(name, condition, details):
+	print("%-40s %s" % (name, "ok" if condition else "FAILED (%s)" % details))
+	return condition
+
+
+def run_tests(base, timeout):
+	ok = True
+	status, headers, body = fetch(base + "/fcgi_ok.php?a=1&b=2", timeout)
+	ok &= check("200 with body", status == 200 and body == b"method=GET query=a=1&b=2 length=0", (status, body))
+	ok &= check("200 Content-Length", headers.get("Content-Length") == str(len(body)), headers.get("Content-Length"))
+
+	# a second request reuses the pooled connection
+	status, headers, body = fetch(base + "/fcgi_ok.php?c=3", timeout)
+	ok &= check("200 on a pooled connection", status == 200 and body.endswith(b"query=c=3 length=0"), (status, body))
+
+	status, headers, body = fetch(base + "/fcgi_redirect.php", timeout)
+	ok &= check("302 keeps Location", status == 302 and headers.get("Location") == "/index.html", (status, headers.get("Location")))
+	ok &= check("302 Content-Length", headers.get("Content-Length") == str(len(body)), (headers.get("Content-Length"), len(body)))
+
+	status, headers, body = fetch(base + "/fcgi_missing.php", timeout)
+	ok &= check("404 status", status == 404, status)
+	ok &= check("404 Content-Length", headers.get("Content-Length") == str(len(body)), (headers.get("Content-Length"), len(body)))
+
+	# the hanging page runs on a scheduler worker, other requests are served meanwhile
+	hang = {}
+
+	def fetch_hang():
+		start = time.time()
+		hang["status"] = fetch(base + "/fcgi_hang.php", timeout)[0]
+		hang["elapsed"] = time.time() - start
+
+	hang_thread = threading.Thread(target=fetch_hang)
+	hang_thread.start()
+	time.sleep(0.5)
+	start = time.time()
+	status, headers, body = fetch(base + "/json.htm?type=command&param=getversion", timeout)
+	elapsed = time.time() - start
+	ok &= check("json during a hanging page", status == 200 and elapsed < 2, (status, "%.1f s" % elapsed))
+	hang_thread.join()
+	ok &= check("hanging responder gives 503", hang.get("status") == 503, hang.get("status"))
+	print("  gave up after %.1f seconds" % hang.get("elapsed", 0))
+
+	status, headers, body = fetch(base + "/fcgi_ok.php?d=4", timeout)
+	ok &= check("200 after the hanging request", status == 200, status)
+	return ok
+
+
+def main():
+	parser = argparse.ArgumentParser(description="domoticz FastCGI client test")
+	parser.add_argument("-u", "--url", default="http://127.0.0.1:8080", help="base url of the web server")
+	parser.add_argument("-l", "--listen", default="127.0.0.1:9123", help="address (host:port) or unix socket of the responder")
+	parser.add_argument("-t", "--timeout", type=float, default=60, help="timeout of a request in seconds")
+	parser.add_argument("-r", "--responder-only", action="store_true", help="only run the responder")
+	args = parser.parse_args()
+
+	if args.responder_only:
+		run_responder(args.listen)
+		return
+	threading.Thread(target=run_responder, args=(args.listen,), daemon=True).start()
+	time.sleep(0.2)
+	sys.exit(0 if run_tests(args.url.rstrip("/"), args.timeout) else 1)
+
+
+if __name__ == "__main__":
+	main()
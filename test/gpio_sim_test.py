@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Test of the GPIO character device backend with the gpio-sim kernel module.
+
+gpio-sim (Linux 5.17 and later) creates a GPIO chip whose input levels are set
+through sysfs, so edges can be generated without hardware. Domoticz uses the
+lowest numbered /dev/gpiochipN, so run this on a machine without other GPIO
+chips (a PC or a virtual machine), as root.
+
+	1. test/gpio_sim_test.py setup
+	   creates the simulated chip (8 lines)
+	2. start domoticz, add a "Raspberry's GPIO port" hardware and a switch on
+	   GPIO 3 (Add Manual Light/Switch, type GPIO), and restart the hardware so
+	   the line is requested as input
+	3. test/gpio_sim_test.py run -u http://127.0.0.1:8080 -i <device idx> -l 3
+	   toggles the line, measures how long domoticz takes to show each change,
+	   then sends a burst of edges and checks that none were missed
+	4. test/gpio_sim_test.py teardown
+
+Use a debounce of 0 ms in the hardware settings, otherwise the kernel drops the
+edges of the burst that are closer together than the debounce time.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+import urllib.request
+
+CONFIGFS = "/sys/kernel/config"
+SIM_NAME = "domoticz-test"
+
+
+def sim_dir():
+	return os.path.join(CONFIGFS, "gpio-sim", SIM_NAME)
+
+
+def write_file(path, value):
+	with open(path, "w") as f:
+		f.write(value)
+
+
+def read_file(path):
+	with open(path) as f:
+		return f.read().strip()
+
+
+def setup(lines):
+	if not os.path.isdir(os.path.join(CONFIGFS, "gpio-sim")):
+		subprocess.call(["modprobe", "gpio-sim"])
+		if not os.path.ismount(CONFIGFS):
+			subprocess.call(["mount", "-t", "configfs", "none", CONFIGFS])
+	os.makedirs(os.path.join(sim_dir(), "bank0"), exist_ok=True)
+	write_file(os.path.join(sim_dir(), "bank0", "num_lines"), str(lines))
+	write_file(os.path.join(sim_dir(), "live"), "1")
+	print("created %s (%s, %d lines)" % (read_file(os.path.join(sim_dir(), "bank0", "chip_name")),
+		read_file(os.path.join(sim_dir(), "dev_name")), lines))
+
+
+def teardown():
+	if not os.path.isdir(sim_dir()):
+		return
+	write_file(os.path.join(sim_dir(), "live"), "0")
+	os.rmdir(os.path.join(sim_dir(), "bank0"))
+	os.rmdir(sim_dir())
+	print("removed the simulated chip")
+
+
+def set_level(line, high):
+	path = os.path.join("/sys/devices/platform", read_file(os.path.join(sim_dir(), "dev_name")),
+		read_file(os.path.join(sim_dir(), "bank0", "chip_name")), "sim_gpio%d" % line, "pull")
+	write_file(path, "pull-up" if high else "pull-down")
+
+
+def get_json(url):
+	with urllib.request.urlopen(url, timeout=10) as resp:
+		return json.loads(resp.read().decode("utf-8"))
+
+
+def device_status(base, idx):
+	result = get_json(base + "type=devices&rid=%s" % idx).get("result", [])
+	return result[0]["Status"] if result else None
+
+
+def log_count(base, idx):
+	return len(get_json(base + "type=lightlog&idx=%s" % idx).get("result", []))
+
+
+def run(base, idx, line, toggles, burst):
+	failed = False
+	latencies = []
+	high = device_status(base, idx) != "On"
+	for _ in range(toggles):
+		start = time.time()
+		set_level(line, high)
+		expected = "On" if high else "Off"
+		while device_status(base, idx) != expected:
+			if time.time() - start > 5:
+				print("device did not change to %s within 5 seconds" % expected)
+				failed = True
+				break
+			time.sleep(0.005)
+		else:
+			latencies.append((time.time() - start) * 1000)
+		high = not high
+		time.sleep(0.2)
+	if latencies:
+		latencies.sort()
+		print("latency over %d edges (includes the json polling): min %.0f ms, median %.0f ms, max %.0f ms" % (
+			len(latencies), latencies[0], latencies[len(latencies) // 2], latencies[-1]))
+
+	# a burst of edges 2 ms apart, every edge should give a log entry
+	before = log_count(base, idx)
+	for _ in range(burst):
+		set_level(line, high)
+		high = not high
+		time.sleep(0.002)
+	time.sleep(2)
+	received = log_count(base, idx) - before
+	print("burst: %d edges sent, %d updates logged" % (burst, received))
+	if received < burst:
+		failed = True
+	return not failed
+
+
+def main():
+	parser = argparse.ArgumentParser(description="domoticz GPIO test with gpio-sim")
+	parser.add_argument("action", choices=["setup", "run", "teardown"])
+	parser.add_argument("-u", "--url", default="http://127.0.0.1:8080", help="base url of the web server")
+	parser.add_argument("-i", "--idx", help="idx of the switch device of the line")
+	parser.add_argument("-l", "--line", type=int, default=3, help="line (GPIO number) of the device")
+	parser.add_argument("-n", "--lines", type=int, default=8, help="number of lines of the simulated chip")
+	parser.add_argument("-t", "--toggles", type=int, default=20, help="number of timed edges")
+	parser.add_argument("-b", "--burst", type=int, default=50, help="number of edges in the burst")
+	args = parser.parse_args()
+
+	if args.action == "setup":
+		setup(args.lines)
+	elif args.action == "teardown":
+		teardown()
+	else:
+		if args.idx is None:
+			parser.error("run needs the idx of the device (-i)")
+		base = args.url.rstrip("/") + "/json.htm?"
+		sys.exit(0 if run(base, args.idx, args.line, args.toggles, args.burst) else 1)
+
+
+if __name__ == "__main__":
+	main()
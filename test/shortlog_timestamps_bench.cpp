@@ -0,0 +1,210 @@
+/*
+Benchmark of the short log queries with text and with epoch timestamps.
+
+Fills a Temperature table (schema and indexes as created by main/SQLHelper.cpp) with 7 days
+of 5 minute values for 100 devices, once with the local time Date column only and once
+with the DateUTC column, its indexes and trigger of the EpochTimestamps option. On both
+it times:
+- graph: the day graph query of every device (json.htm?type=graph&sensor=temp&range=day)
+- insert: one hour of values for all devices in one transaction, as FlushShortLogRecords does
+- retention: 24 hourly retention runs (DeleteInChunks with the 7 day cutoff, moved one hour
+  per run), the cutoff string of the text variant is formatted per run like the real one
+
+The database is kept in memory, so the figures do not include disk writes.
+
+Build and run:
+	g++ -O2 -std=c++11 -o /tmp/shortlog_timestamps_bench test/shortlog_timestamps_bench.cpp -lsqlite3
+	/tmp/shortlog_timestamps_bench [devices]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include <sqlite3.h>
+
+#define BENCH_DAYS 7
+#define BENCH_INTERVAL 300 //seconds
+#define BENCH_DELETE_CHUNK_SIZE 500
+
+static bool Exec(sqlite3 *db, const std::string &szQuery)
+{
+	char *errorMessage = NULL;
+	if (sqlite3_exec(db, szQuery.c_str(), NULL, NULL, &errorMessage) != SQLITE_OK)
+	{
+		fprintf(stderr, "SQL Query(\"%s\") : %s\n", szQuery.c_str(), (errorMessage) ? errorMessage : "unknown error");
+		sqlite3_free(errorMessage);
+		return false;
+	}
+	return true;
+}
+
+static std::string EpochToSQLdatetime(const time_t tEpoch)
+{
+	struct tm ltime;
+	localtime_r(&tEpoch, &ltime);
+	char szDate[40];
+	strftime(szDate, sizeof(szDate), "%Y-%m-%d %H:%M:%S", &ltime);
+	return szDate;
+}
+
+static double ElapsedMs(const std::chrono::steady_clock::time_point &tStart)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+class CShortLogBench
+{
+public:
+	CShortLogBench(const bool bEpoch, const int nDevices, const time_t tNow) :
+		m_bEpoch(bEpoch),
+		m_nDevices(nDevices),
+		m_tNow(tNow),
+		m_db(NULL)
+	{
+	}
+	~CShortLogBench()
+	{
+		if (m_db)
+			sqlite3_close(m_db);
+	}
+	bool Setup()
+	{
+		if (sqlite3_open(":memory:", &m_db) != SQLITE_OK)
+			return false;
+		Exec(m_db, "CREATE TABLE IF NOT EXISTS [Temperature] ([DeviceRowID] BIGINT(10) NOT NULL, [Temperature] FLOAT NOT NULL, [Chill] FLOAT DEFAULT 0, [Humidity] INTEGER DEFAULT 0, [Barometer] INTEGER DEFAULT 0, [DewPoint] FLOAT DEFAULT 0, [SetPoint] FLOAT DEFAULT 0, [Date] DATETIME DEFAULT (datetime('now','localtime')));");
+		Exec(m_db, "create index if not exists t_id_idx        on Temperature(DeviceRowID);");
+		Exec(m_db, "create index if not exists t_id_date_idx   on Temperature(DeviceRowID, Date);");
+		Exec(m_db, "create index if not exists t_date_idx      on Temperature(Date);");
+		if (m_bEpoch)
+		{
+			Exec(m_db, "ALTER TABLE Temperature ADD COLUMN [DateUTC] INTEGER DEFAULT NULL");
+			Exec(m_db, "CREATE INDEX IF NOT EXISTS Temperature_idx_dateutc ON Temperature (DateUTC)");
+			Exec(m_db, "CREATE INDEX IF NOT EXISTS Temperature_idx_id_dateutc ON Temperature (DeviceRowID, DateUTC)");
+			Exec(m_db, "CREATE TRIGGER IF NOT EXISTS Temperature_DateUTC AFTER INSERT ON Temperature WHEN NEW.DateUTC IS NULL BEGIN UPDATE Temperature SET DateUTC=CAST(strftime('%s', NEW.Date, 'utc') AS INTEGER) WHERE (rowid==NEW.rowid); END;");
+		}
+		//The history up to now, the benchmarked inserts add the hour after it
+		return Insert(m_tNow - (BENCH_DAYS * 86400), m_tNow);
+	}
+	bool Insert(const time_t tFrom, const time_t tTo)
+	{
+		std::string szQuery = "INSERT INTO Temperature (DeviceRowID, Temperature, Chill, Humidity, Barometer, DewPoint, SetPoint, Date";
+		szQuery += (m_bEpoch) ? ", DateUTC) VALUES (?,?,?,?,?,?,?,?,?)" : ") VALUES (?,?,?,?,?,?,?,?)";
+		sqlite3_stmt *stmt = NULL;
+		if (sqlite3_prepare_v2(m_db, szQuery.c_str(), -1, &stmt, NULL) != SQLITE_OK)
+			return false;
+		Exec(m_db, "BEGIN TRANSACTION");
+		for (time_t tDate = tFrom; tDate < tTo; tDate += BENCH_INTERVAL)
+		{
+			std::string szDate = EpochToSQLdatetime(tDate);
+			for (int ii = 1; ii <= m_nDevices; ii++)
+			{
+				sqlite3_bind_int(stmt, 1, ii);
+				sqlite3_bind_double(stmt, 2, 15.0 + ((tDate / BENCH_INTERVAL + ii) % 100) / 10.0);
+				sqlite3_bind_double(stmt, 3, 0);
+				sqlite3_bind_int(stmt, 4, 50);
+				sqlite3_bind_int(stmt, 5, 1013);
+				sqlite3_bind_double(stmt, 6, 8.5);
+				sqlite3_bind_double(stmt, 7, 0);
+				sqlite3_bind_text(stmt, 8, szDate.c_str(), -1, SQLITE_TRANSIENT);
+				if (m_bEpoch)
+					sqlite3_bind_int64(stmt, 9, (sqlite3_int64)tDate);
+				sqlite3_step(stmt);
+				sqlite3_reset(stmt);
+			}
+		}
+		Exec(m_db, "COMMIT");
+		sqlite3_finalize(stmt);
+		return true;
+	}
+	int DayGraphs()
+	{
+		std::string szQuery = "SELECT Temperature, Chill, Humidity, Barometer, Date, SetPoint FROM Temperature WHERE (DeviceRowID==?) ORDER BY ";
+		szQuery += (m_bEpoch) ? "DateUTC ASC" : "Date ASC";
+		sqlite3_stmt *stmt = NULL;
+		if (sqlite3_prepare_v2(m_db, szQuery.c_str(), -1, &stmt, NULL) != SQLITE_OK)
+			return 0;
+		int nRows = 0;
+		for (int ii = 1; ii <= m_nDevices; ii++)
+		{
+			sqlite3_bind_int(stmt, 1, ii);
+			while (sqlite3_step(stmt) == SQLITE_ROW)
+			{
+				//The API returns the text Date in both cases
+				std::string szDate = (const char*)sqlite3_column_text(stmt, 4);
+				nRows += (szDate.size() >= 16) ? 1 : 0;
+			}
+			sqlite3_reset(stmt);
+		}
+		sqlite3_finalize(stmt);
+		return nRows;
+	}
+	int Retention(const time_t tNow)
+	{
+		char szFilter[100];
+		if (m_bEpoch)
+			snprintf(szFilter, sizeof(szFilter), "(DateUTC < %lld)", (long long)(tNow - (BENCH_DAYS * 86400)));
+		else
+			snprintf(szFilter, sizeof(szFilter), "(Date < '%s')", EpochToSQLdatetime(tNow - (BENCH_DAYS * 86400)).c_str());
+		char szQuery[300];
+		snprintf(szQuery, sizeof(szQuery), "DELETE FROM Temperature WHERE rowid IN (SELECT rowid FROM Temperature WHERE %s LIMIT %d)", szFilter, BENCH_DELETE_CHUNK_SIZE);
+		int nDeleted = 0;
+		while (true)
+		{
+			if (!Exec(m_db, szQuery))
+				break;
+			int changes = sqlite3_changes(m_db);
+			nDeleted += changes;
+			if (changes < BENCH_DELETE_CHUNK_SIZE)
+				break;
+		}
+		return nDeleted;
+	}
+private:
+	bool m_bEpoch;
+	int m_nDevices;
+	time_t m_tNow;
+	sqlite3 *m_db;
+};
+
+int main(int argc, char *argv[])
+{
+	int nDevices = (argc > 1) ? atoi(argv[1]) : 100;
+	if (nDevices < 1)
+		nDevices = 100;
+	//Whole 5 minutes, like the short log timer
+	time_t tNow = time(NULL);
+	tNow -= tNow % BENCH_INTERVAL;
+
+	printf("%d devices, %d days of %d second values\n", nDevices, BENCH_DAYS, BENCH_INTERVAL);
+	printf("%-10s %12s %12s %14s\n", "", "graph (ms)", "insert (ms)", "retention (ms)");
+	for (int ii = 0; ii < 2; ii++)
+	{
+		bool bEpoch = (ii == 1);
+		CShortLogBench bench(bEpoch, nDevices, tNow);
+		if (!bench.Setup())
+		{
+			fprintf(stderr, "could not create the database\n");
+			return 1;
+		}
+
+		std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		int nRows = bench.DayGraphs();
+		double graphMs = ElapsedMs(tStart);
+
+		tStart = std::chrono::steady_clock::now();
+		bench.Insert(tNow, tNow + 3600);
+		double insertMs = ElapsedMs(tStart);
+
+		int nDeleted = 0;
+		tStart = std::chrono::steady_clock::now();
+		for (int jj = 1; jj <= 24; jj++)
+			nDeleted += bench.Retention(tNow + (jj * 3600));
+		double retentionMs = ElapsedMs(tStart);
+
+		printf("%-10s %12.1f %12.1f %14.1f   (%d graph rows, %d deleted)\n", (bEpoch) ? "epoch" : "text", graphMs, insertMs, retentionMs, nRows, nDeleted);
+	}
+	return 0;
+}
@@ -0,0 +1,250 @@
+/*
+Micro-benchmark of the json.htm dispatch.
+
+Times the resolution of the handler for the 20 most used json.htm requests of the web
+interface, with the dispatch as it was before the dispatch table and with the current one:
+- before: a lookup in the registered commands (or rtypes) map, for the commands that were
+  not registered it was followed by the if (cparam == "...") chain of HandleCommand
+- now: the lookup of the type and of the param in m_webhandlers and the rights check of
+  DispatchJSonRequest
+
+The names are the registered commands, the chain and the rtypes of main/WebServer.cpp before
+the dispatch table, in their original order. The handlers do nothing, only the dispatch
+overhead is measured. The code both paths share (GetJSonPage, the parameter parsing and the
+reply) is left out.
+
+Build and run:
+	g++ -O2 -std=c++11 -o /tmp/webserver_dispatch_bench test/webserver_dispatch_bench.cpp
+	/tmp/webserver_dispatch_bench [iterations]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::function<void(int &)> response_function;
+
+//RegisterCommandCode names
+static const char *szRegisteredCommands[] = {
+	"rfxfirmwaregetpercentage", "sendopenthermcommand", "getlanguage", "getthemes", "logincheck", "getversion",
+	"getlog", "clearlog", "getmemoryusage", "getpollstatistics", "geteventsystemstatistics", "getsystemmetrics",
+	"getwebserverstatistics", "getauth", "getuptime", "gethardwaretypes", "addhardware", "updatehardware",
+	"deletehardware", "wolgetnodes", "woladdnode", "wolupdatenode", "wolremovenode", "wolclearnodes",
+	"mysensorsgetnodes", "mysensorsgetchilds", "mysensorsupdatenode", "mysensorsremovenode", "mysensorsremovechild", "mysensorsupdatechild",
+	"pingersetmode", "pingergetnodes", "pingeraddnode", "pingerupdatenode", "pingerremovenode", "pingerclearnodes",
+	"kodisetmode", "kodigetnodes", "kodiaddnode", "kodiupdatenode", "kodiremovenode", "kodiclearnodes",
+	"kodimediacommand", "panasonicsetmode", "panasonicgetnodes", "panasonicaddnode", "panasonicupdatenode", "panasonicremovenode",
+	"panasonicclearnodes", "panasonicmediacommand", "heossetmode", "heosmediacommand", "bleboxsetmode", "bleboxgetnodes",
+	"bleboxaddnode", "bleboxupdatenode", "bleboxremovenode", "bleboxclearnodes", "bleboxautosearchingnodes", "bleboxupdatefirmware",
+	"lmssetmode", "lmsgetnodes", "lmsgetplaylists", "lmsmediacommand", "savefibarolinkconfig", "getfibarolinkconfig",
+	"getfibarolinks", "savefibarolink", "deletefibarolink", "saveinfluxlinkconfig", "getinfluxlinkconfig", "getinfluxlinks",
+	"saveinfluxlink", "deleteinfluxlink", "savehttplinkconfig", "gethttplinkconfig", "gethttplinks", "savehttplink",
+	"deletehttplink", "savegooglepubsublinkconfig", "getgooglepubsublinkconfig", "getgooglepubsublinks", "savegooglepubsublink", "deletegooglepubsublink",
+	"getdevicevalueoptions", "getdevicevalueoptionwording", "deleteuservariable", "saveuservariable", "updateuservariable", "getuservariables",
+	"getuservariable", "allownewhardware", "addplan", "updateplan", "deleteplan", "getunusedplandevices",
+	"addplanactivedevice", "getplandevices", "deleteplandevice", "setplandevicecoords", "deleteallplandevices", "changeplanorder",
+	"changeplandeviceorder", "gettimerplans", "addtimerplan", "updatetimerplan", "deletetimerplan", "getactualhistory",
+	"getnewhistory", "getconfig", "sendnotification", "emailcamerasnapshot", "udevice", "udevices",
+	"switchlights", "thermostatstate", "system_shutdown", "system_reboot", "execute_script", "getcosts",
+	"checkforupdate", "downloadupdate", "downloadready", "deletedatapoint", "setactivetimerplan", "addtimer",
+	"updatetimer", "deletetimer", "enabletimer", "disabletimer", "cleartimers", "addscenetimer",
+	"updatescenetimer", "deletescenetimer", "enablescenetimer", "disablescenetimer", "clearscenetimers", "getsceneactivations",
+	"addscenecode", "removescenecode", "clearscenecodes", "renamescene", "setsetpoint", "addsetpointtimer",
+	"updatesetpointtimer", "deletesetpointtimer", "enablesetpointtimer", "disablesetpointtimer", "clearsetpointtimers", "serial_devices",
+	"devices_list", "devices_list_onoff", "registerhue", "getcustomiconset", "deletecustomicon", "updatecustomicon",
+	"renamedevice", "setunused", "addlogmessage", "clearshortlog", "vacuumdatabase", "addmobiledevice",
+	"deletemobiledevice", "addyeelight", "addArilux", "updatezwavenode", "deletezwavenode", "zwaveinclude",
+	"zwaveexclude", "zwaveisnodeincluded", "zwaveisnodeexcluded", "zwavesoftreset", "zwavehardreset", "zwavenetworkheal",
+	"zwavenodeheal", "zwavenetworkinfo", "zwaveremovegroupnode", "zwaveaddgroupnode", "zwavegroupinfo", "zwavecancel",
+	"applyzwavenodeconfig", "requestzwavenodeconfig", "zwavestatecheck", "zwavereceiveconfigurationfromothercontroller", "zwavesendconfigurationtosecondcontroller", "zwavetransferprimaryrole",
+	"zwavestartusercodeenrollmentmode", "zwavegetusercodes", "zwaveremoveusercode", "tellstickApplySettings",
+	NULL
+};
+
+//if (cparam == "...") chain of HandleCommand, after the registered commands
+static const char *szCommandChain[] = {
+	"deleteallsubdevices", "deletesubdevice", "addsubdevice", "addscenedevice", "updatescenedevice", "deletescenedevice",
+	"getsubdevices", "getscenedevices", "changescenedeviceorder", "deleteallscenedevices", "getmanualhardware", "getgpio",
+	"getlightswitches", "getlightswitchesscenes", "getcamactivedevices", "addcamactivedevice", "deleteamactivedevice", "deleteallactivecamdevices",
+	"testnotification", "testswitch", "addswitch", "getnotificationtypes", "addnotification", "updatenotification",
+	"deletenotification", "switchdeviceorder", "switchsceneorder", "clearnotifications", "addcamera", "updatecamera",
+	"deletecamera", "adduser", "updateuser", "deleteuser", "clearlightlog", "clearscenelog",
+	"learnsw", "makefavorite", "makescenefavorite", "resetsecuritystatus", "verifypasscode", "switchlight",
+	"switchscene", "getSunRiseSet", "getServerTime", "getsecstatus", "setsecstatus", "setcolbrightnessvalue",
+	"brightnessup", "brightnessdown", "discomode", "discoup", "discodown", "speedup",
+	"speeduplong", "speeddown", "speedmin", "speedmax", "warmer", "cooler",
+	"fulllight", "nightlight", "whitelight", "getfloorplanimages", "addfloorplan", "updatefloorplan",
+	"deletefloorplan", "changefloorplanorder", "getunusedfloorplanplans", "getfloorplanplans", "addfloorplanplan", "updatefloorplanplan",
+	"deletefloorplanplan",
+	NULL
+};
+
+//RegisterRType names
+static const char *szRTypes[] = {
+	"graph", "lightlog", "textlog", "scenelog", "settings", "events",
+	"hardware", "devices", "deletedevice", "cameras", "users", "timers",
+	"scenetimers", "setpointtimers", "gettransfers", "transferdevice", "notifications", "schedules",
+	"getshareduserdevices", "setshareduserdevices", "setused", "scenes", "addscene", "deletescene",
+	"updatescene", "createvirtualsensor", "createevohomesensor", "bindevohome", "createrflinkdevice", "custom_light_icons",
+	"plans", "floorplans", "openzwavenodes",
+	NULL
+};
+
+//type, param
+static const char *szMostUsed[][2] = {
+	{ "devices", "" },
+	{ "scenes", "" },
+	{ "graph", "" },
+	{ "command", "getSunRiseSet" },
+	{ "command", "switchlight" },
+	{ "command", "switchscene" },
+	{ "command", "udevice" },
+	{ "command", "setsetpoint" },
+	{ "command", "getversion" },
+	{ "command", "getauth" },
+	{ "command", "getuptime" },
+	{ "command", "getsecstatus" },
+	{ "command", "getlightswitches" },
+	{ "command", "setcolbrightnessvalue" },
+	{ "command", "getServerTime" },
+	{ "lightlog", "" },
+	{ "settings", "" },
+	{ "hardware", "" },
+	{ "plans", "" },
+	{ "timers", "" },
+};
+#define MOST_USED_COUNT (sizeof(szMostUsed) / sizeof(szMostUsed[0]))
+
+struct _tWebHandler
+{
+	response_function ResponseFunction;
+	int Rights;
+	std::vector<std::string> RequiredParams;
+};
+
+static void Handler(int &nCalls)
+{
+	nCalls++;
+}
+
+class CBaselineDispatch
+{
+public:
+	CBaselineDispatch()
+	{
+		for (int ii = 0; szRegisteredCommands[ii] != NULL; ii++)
+			m_webcommands[szRegisteredCommands[ii]] = Handler;
+		for (int ii = 0; szRTypes[ii] != NULL; ii++)
+			m_webrtypes[szRTypes[ii]] = Handler;
+	}
+	void Dispatch(const std::string &rtype, const std::string &cparam, int &nCalls)
+	{
+		if (rtype == "command")
+		{
+			std::map<std::string, response_function>::const_iterator pf = m_webcommands.find(cparam);
+			if (pf != m_webcommands.end())
+			{
+				pf->second(nCalls);
+				return;
+			}
+			for (int ii = 0; szCommandChain[ii] != NULL; ii++)
+			{
+				if (cparam == szCommandChain[ii])
+				{
+					Handler(nCalls);
+					return;
+				}
+			}
+			return;
+		}
+		std::map<std::string, response_function>::const_iterator pf = m_webrtypes.find(rtype);
+		if (pf != m_webrtypes.end())
+			pf->second(nCalls);
+	}
+private:
+	std::map<std::string, response_function> m_webcommands;
+	std::map<std::string, response_function> m_webrtypes;
+};
+
+class CTableDispatch
+{
+public:
+	CTableDispatch()
+	{
+		for (int ii = 0; szRegisteredCommands[ii] != NULL; ii++)
+			Register("command", szRegisteredCommands[ii]);
+		for (int ii = 0; szCommandChain[ii] != NULL; ii++)
+			Register("command", szCommandChain[ii]);
+		for (int ii = 0; szRTypes[ii] != NULL; ii++)
+			Register(szRTypes[ii], "");
+	}
+	void Dispatch(const std::string &rtype, const std::string &cparam, const int rights, int &nCalls)
+	{
+		std::map<std::string, std::map<std::string, _tWebHandler> >::const_iterator ittType = m_webhandlers.find(rtype);
+		if (ittType == m_webhandlers.end())
+			return;
+		std::map<std::string, _tWebHandler>::const_iterator pf = ittType->second.find(cparam);
+		if (pf == ittType->second.end())
+			return;
+		const _tWebHandler &handler = pf->second;
+		if (rights < handler.Rights)
+			return;
+		handler.ResponseFunction(nCalls);
+	}
+private:
+	void Register(const std::string &rtype, const std::string &cparam)
+	{
+		_tWebHandler handler;
+		handler.ResponseFunction = Handler;
+		handler.Rights = -1;
+		m_webhandlers[rtype][cparam] = handler;
+	}
+	std::map<std::string, std::map<std::string, _tWebHandler> > m_webhandlers;
+};
+
+int main(int argc, char *argv[])
+{
+	int nIterations = (argc > 1) ? atoi(argv[1]) : 1000000;
+	if (nIterations < 1)
+		nIterations = 1000000;
+
+	CBaselineDispatch baseline;
+	CTableDispatch table;
+	int nBaselineCalls = 0;
+	int nTableCalls = 0;
+	double totalBaseline = 0;
+	double totalTable = 0;
+
+	printf("%-24s %12s %12s\n", "request", "before (ns)", "now (ns)");
+	for (size_t ii = 0; ii < MOST_USED_COUNT; ii++)
+	{
+		//Copies, as the values come from the parsed request
+		std::string rtype = szMostUsed[ii][0];
+		std::string cparam = szMostUsed[ii][1];
+
+		std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		for (int jj = 0; jj < nIterations; jj++)
+			baseline.Dispatch(rtype, cparam, nBaselineCalls);
+		double baselineNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tStart).count() / nIterations;
+
+		tStart = std::chrono::steady_clock::now();
+		for (int jj = 0; jj < nIterations; jj++)
+			table.Dispatch(rtype, cparam, 2, nTableCalls);
+		double tableNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tStart).count() / nIterations;
+
+		printf("%-24s %12.1f %12.1f\n", (cparam.empty()) ? rtype.c_str() : cparam.c_str(), baselineNs, tableNs);
+		totalBaseline += baselineNs;
+		totalTable += tableNs;
+	}
+	printf("%-24s %12.1f %12.1f\n", "average", totalBaseline / MOST_USED_COUNT, totalTable / MOST_USED_COUNT);
+	if (nBaselineCalls != nTableCalls)
+	{
+		printf("error: %d handler calls before, %d now\n", nBaselineCalls, nTableCalls);
+		return 1;
+	}
+	return 0;
+}
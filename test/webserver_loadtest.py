@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Load test for the admission control of the domoticz web server.
+
+Floods the server with graph requests (bulk class) and measures how long a
+command request takes while the flood is queued. The command is handled on
+the io_service thread and should not wait for the graphs.
+
+Usage:
+	webserver_loadtest.py [-u http://127.0.0.1:8080] [-i <device idx>] [-n 20] [-c <command>]
+
+The default command (getSunRiseSet) does not change anything. Use for example
+-c "switchlight&idx=12&switchcmd=Toggle" to time a real switch command.
+Run it against a server that does not need authentication for the host
+(for example from a local network listed in the settings).
+"""
+
+import argparse
+import json
+import threading
+import time
+import urllib.error
+import urllib.request
+
+
+def fetch(url, timeout):
+	start = time.time()
+	try:
+		with urllib.request.urlopen(url, timeout=timeout) as resp:
+			resp.read()
+			status = resp.status
+	except urllib.error.HTTPError as e:
+		status = e.code
+	except Exception as e:
+		status = str(e)
+	return status, (time.time() - start) * 1000
+
+
+def main():
+	parser = argparse.ArgumentParser(description="domoticz web server load test")
+	parser.add_argument("-u", "--url", default="http://127.0.0.1:8080", help="base url of the web server")
+	parser.add_argument("-i", "--idx", default="1", help="idx of a device with a graph (temperature, meter, ...)")
+	parser.add_argument("-n", "--requests", type=int, default=20, help="number of graph requests in the flood")
+	parser.add_argument("-c", "--command", default="getSunRiseSet", help="json command that is timed during the flood")
+	parser.add_argument("-t", "--timeout", type=float, default=60, help="timeout of a request in seconds")
+	args = parser.parse_args()
+
+	base = args.url.rstrip("/") + "/json.htm?"
+	graph_url = base + "type=graph&sensor=temp&idx=%s&range=year" % args.idx
+	command_url = base + "type=command&param=" + args.command
+
+	results = []
+	lock = threading.Lock()
+
+	def flood():
+		res = fetch(graph_url, args.timeout)
+		with lock:
+			results.append(res)
+
+	threads = [threading.Thread(target=flood) for _ in range(args.requests)]
+	for t in threads:
+		t.start()
+	# give the flood a head start, so the command is queued behind it
+	time.sleep(0.05)
+	status, elapsed = fetch(command_url, args.timeout)
+	for t in threads:
+		t.join()
+
+	print("command '%s': status %s, %.0f ms" % (args.command, status, elapsed))
+	ok = [r for r in results if r[0] == 200]
+	rejected = [r for r in results if r[0] == 503]
+	print("graphs: %d ok, %d rejected (503), %d failed" % (len(ok), len(rejected), len(results) - len(ok) - len(rejected)))
+	if ok:
+		times = sorted(r[1] for r in ok)
+		print("graph time: min %.0f ms, median %.0f ms, max %.0f ms" % (times[0], times[len(times) // 2], times[-1]))
+
+	try:
+		with urllib.request.urlopen(base + "type=command&param=getwebserverstatistics", timeout=args.timeout) as resp:
+			stats = json.loads(resp.read().decode("utf-8"))
+	except Exception as e:
+		print("statistics not available: %s" % e)
+		return
+	for cls in stats.get("result", []):
+		print("%-8s handled %d, rejected %d/%d, expired %d, avg queue %d ms, avg exec %d ms" % (
+			cls["Name"], cls["Handled"], cls["RejectedClient"], cls["RejectedQueue"],
+			cls["Expired"], cls["AvgQueueTime"], cls["AvgExecTime"]))
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+Replay test for the Xiaomi gateway listener.
+
+Sends gateway reports of a door sensor to the multicast port (9898) of domoticz
+and checks that duplicate reports are dropped and that no state change is lost.
+Add a "Xiaomi Gateway" hardware first; reports from an address that is not a
+configured gateway are handled by the gateway with the lowest hardware id.
+
+	test/xiaomi_replay_test.py -H 127.0.0.1 -u http://127.0.0.1:8080
+
+The door sensor is created on the first report (sid 158d0000fd32c2 by default).
+The test sends every state several times, like the gateway does, and expects one
+light log entry per state change. It then changes the state with udevice and
+checks that the next report of the gateway is not taken for a duplicate.
+"""
+
+import argparse
+import json
+import socket
+import sys
+import time
+import urllib.request
+
+
+def get_json(url):
+	with urllib.request.urlopen(url, timeout=10) as resp:
+		return json.loads(resp.read().decode("utf-8"))
+
+
+def device_id(sid):
+	# same as XiaomiGateway::InsertUpdateSwitch, 8 hex digits of the sid
+	value = int(sid[6:14], 16)
+	return "1" if value == 1 else "%08X" % value
+
+
+def find_device(base, sid):
+	for dev in get_json(base + "type=devices&filter=light&used=all").get("result", []):
+		if dev.get("ID") == device_id(sid):
+			return dev["idx"]
+	return None
+
+
+def log_count(base, idx):
+	return len(get_json(base + "type=lightlog&idx=%s" % idx).get("result", []))
+
+
+def send_report(sock, host, sid, status):
+	report = {
+		"cmd": "report",
+		"model": "magnet",
+		"sid": sid,
+		"short_id": 4343,
+		"data": json.dumps({"status": status}),
+	}
+	sock.sendto(json.dumps(report).encode("utf-8"), (host, 9898))
+
+
+def main():
+	parser = argparse.ArgumentParser(description="domoticz Xiaomi gateway replay test")
+	parser.add_argument("-H", "--host", default="127.0.0.1", help="address of the domoticz host")
+	parser.add_argument("-u", "--url", default="http://127.0.0.1:8080", help="base url of the web server")
+	parser.add_argument("-s", "--sid", default="158d0000fd32c2", help="sid of the simulated door sensor")
+	parser.add_argument("-c", "--changes", type=int, default=10, help="number of state changes")
+	parser.add_argument("-r", "--repeat", type=int, default=3, help="number of times each report is sent")
+	parser.add_argument("-d", "--delay", type=float, default=0.05, help="delay between reports in seconds")
+	args = parser.parse_args()
+
+	base = args.url.rstrip("/") + "/json.htm?"
+	sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+	idx = find_device(base, args.sid)
+	if idx is None:
+		send_report(sock, args.host, args.sid, "close")
+		time.sleep(2)
+		idx = find_device(base, args.sid)
+		if idx is None:
+			print("the door sensor was not created, is a Xiaomi gateway hardware running?")
+			sys.exit(1)
+		print("created the door sensor, idx %s" % idx)
+
+	# start from a known state, this report may or may not be a change
+	send_report(sock, args.host, args.sid, "close")
+	time.sleep(1)
+
+	before = log_count(base, idx)
+	start = time.time()
+	status = "close"
+	for _ in range(args.changes):
+		status = "open" if status == "close" else "close"
+		for _ in range(args.repeat):
+			send_report(sock, args.host, args.sid, status)
+			time.sleep(args.delay)
+	sent = time.time() - start
+	time.sleep(2)
+
+	logged = log_count(base, idx) - before
+	final = get_json(base + "type=devices&rid=%s" % idx)["result"][0]["Status"]
+	expected = "Open" if status == "open" else "Closed"
+
+	# a state set outside the gateway (udevice, scripts, ...) is seen by the next report
+	time.sleep(1.5)
+	get_json(base + "type=command&param=udevice&idx=%s&nvalue=%d&svalue=" % (idx, 0 if status == "open" else 1))
+	time.sleep(1)
+	send_report(sock, args.host, args.sid, status)
+	time.sleep(2)
+	restored = get_json(base + "type=devices&rid=%s" % idx)["result"][0]["Status"]
+	print("%d reports in %.1f seconds (%d changes), %d log entries, final state %s" % (
+		args.changes * args.repeat, sent, args.changes, logged, final))
+	ok = True
+	if logged != args.changes:
+		print("FAILED: expected %d log entries (one per change)" % args.changes)
+		ok = False
+	if final != expected:
+		print("FAILED: expected the final state %s" % expected)
+		ok = False
+	if restored != expected:
+		print("FAILED: a report after udevice did not restore the state %s (got %s)" % (expected, restored))
+		ok = False
+	if ok:
+		print("ok")
+	sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+	main()
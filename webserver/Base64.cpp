@@ -56,6 +56,7 @@ static inline bool is_base64(unsigned char c) {
 
 std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
   std::string ret;
+  ret.reserve(((in_len + 2) / 3) * 4);
   int i = 0;
   unsigned char char_array_3[3];
   unsigned char char_array_4[4];
@@ -8,6 +8,7 @@
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/atomic.hpp>
 #include <boost/uuid/uuid.hpp>            // uuid class
 #include <boost/uuid/uuid_generators.hpp> // uuid generators
 #include <boost/uuid/uuid_io.hpp>         // streaming operators etc.
@@ -17,6 +18,7 @@
 #include "utf.hpp"
 #include "Base64.h"
 #include "GZipHelper.h"
+#include "fastcgi.hpp"
 #include <stdarg.h>
 #include <fstream>
 #include <sstream>
@@ -27,7 +29,8 @@
 #define SHORT_SESSION_TIMEOUT 600 // 10 minutes
 #define LONG_SESSION_TIMEOUT (30 * 86400) // 30 days
 
-int m_failcounter=0;
+//Updated from the io thread and from the bulk workers
+boost::atomic<int> m_failcounter(0);
 
 namespace http {
 	namespace server {
@@ -97,6 +100,15 @@ void cWebem::Stop() {
 	if (myServer != NULL) {
 		myServer->stop();
 	}
+	// Close the connections to the FastCGI server
+	fastcgi_client::close_all();
+}
+
+std::vector<request_scheduler::class_statistics> cWebem::GetRequestStatistics()
+{
+	if (myServer == NULL)
+		return std::vector<request_scheduler::class_statistics>();
+	return myServer->get_request_statistics();
 }
 
 void cWebem::SetAuthenticationMethod(const _eAuthenticationMethod amethod)
@@ -767,12 +779,28 @@ void cWebem::AddUserPassword(const unsigned long ID, const std::string &username
 	wtmp.Password=password;
 	wtmp.userrights=userrights;
 	wtmp.ActiveTabs = activetabs;
+	boost::unique_lock<boost::shared_mutex> lock(m_userpasswordsMutex);
 	m_userpasswords.push_back(wtmp);
 }
 
+// Replace all users at once, so requests are never authenticated against a partial list
+void cWebem::SetUserPasswords(const std::vector<_tWebUserPassword> &users)
+{
+	{
+		boost::unique_lock<boost::shared_mutex> lock(m_userpasswordsMutex);
+		m_userpasswords = users;
+	}
+
+	boost::mutex::scoped_lock lock(m_sessionsMutex);
+	m_sessions.clear();
+}
+
 void cWebem::ClearUserPasswords()
 {
-	m_userpasswords.clear();
+	{
+		boost::unique_lock<boost::shared_mutex> lock(m_userpasswordsMutex);
+		m_userpasswords.clear();
+	}
 
 	boost::mutex::scoped_lock lock(m_sessionsMutex);
 	m_sessions.clear(); //TODO : check if it is really necessary
@@ -901,13 +929,15 @@ const std::string cWebem::GetPort() {
 	return m_settings.listening_port;
 }
 
-WebEmSession * cWebem::GetSession(const std::string & ssid) {
+/// Returns a copy, the session may be removed by another request as soon as the lock is released
+bool cWebem::GetSession(const std::string & ssid, WebEmSession & session) {
 	boost::mutex::scoped_lock lock(m_sessionsMutex);
 	std::map<std::string, WebEmSession>::iterator itt = m_sessions.find(ssid);
 	if (itt != m_sessions.end()) {
-		return &itt->second;
+		session = itt->second;
+		return true;
 	}
-	return NULL;
+	return false;
 }
 void cWebem::AddSession(const WebEmSession & session) {
 	boost::mutex::scoped_lock lock(m_sessionsMutex);
@@ -1061,6 +1091,7 @@ int cWebemRequestHandler::authorize(WebEmSession & session, const request& req,
 				uname=base64_decode(uname);
 				upass = GenerateMD5Hash(base64_decode(upass));
 
+				boost::shared_lock<boost::shared_mutex> lock(myWebem->m_userpasswordsMutex);
 				std::vector<_tWebUserPassword>::iterator itt;
 				for (itt=myWebem->m_userpasswords.begin(); itt!=myWebem->m_userpasswords.end(); ++itt)
 				{
@@ -1085,6 +1116,7 @@ int cWebemRequestHandler::authorize(WebEmSession & session, const request& req,
 		return 0;
 	}
 
+	boost::shared_lock<boost::shared_mutex> lock(myWebem->m_userpasswordsMutex);
 	std::vector<_tWebUserPassword>::iterator itt;
 	for (itt=myWebem->m_userpasswords.begin(); itt!=myWebem->m_userpasswords.end(); ++itt)
 	{
@@ -1351,7 +1383,12 @@ bool cWebemRequestHandler::CheckAuthentication(WebEmSession & session, const req
 {
 	session.rights = -1; // no rights
 
-	if (myWebem->m_userpasswords.size() == 0)
+	bool bNoUsers;
+	{
+		boost::shared_lock<boost::shared_mutex> lock(myWebem->m_userpasswordsMutex);
+		bNoUsers = myWebem->m_userpasswords.empty();
+	}
+	if (bNoUsers)
 	{
 		session.rights = 2;
 		return true;//no username/password we are admin
@@ -1403,8 +1440,9 @@ bool cWebemRequestHandler::CheckAuthentication(WebEmSession & session, const req
 		}
 
 		if (!(sSID.empty() || sAuthToken.empty() || szTime.empty())) {
-			WebEmSession* oldSession = myWebem->GetSession(sSID);
-			if ((oldSession != NULL) && (oldSession->expires < now)) {
+			WebEmSession oldSession;
+			bool bOldSession = myWebem->GetSession(sSID, oldSession);
+			if (bOldSession && (oldSession.expires < now)) {
 				// Check if session stored in memory is not expired (prevent from spoofing expiration time)
 				expired = true;
 			}
@@ -1412,7 +1450,7 @@ bool cWebemRequestHandler::CheckAuthentication(WebEmSession & session, const req
 			{
 				//expired session, remove session
 				m_failcounter = 0;
-				if (oldSession != NULL)
+				if (bOldSession)
 				{
 					// session exists (delete it from memory and database)
 					myWebem->RemoveSession(sSID);
@@ -1421,9 +1459,9 @@ bool cWebemRequestHandler::CheckAuthentication(WebEmSession & session, const req
 				send_authorization_request(rep);
 				return false;
 			}
-			if (oldSession != NULL) {
+			if (bOldSession) {
 				// session already exists
-				session = *oldSession;
+				session = oldSession;
 			} else {
 				// Session does not exists
 				session.id = sSID;
@@ -1535,6 +1573,7 @@ bool cWebemRequestHandler::checkAuthToken(WebEmSession & session) {
 		bool sessionExpires = false;
 		session.username = storedSession.username;
 		session.expires = storedSession.expires;
+		boost::shared_lock<boost::shared_mutex> lock(myWebem->m_userpasswordsMutex);
 		std::vector<_tWebUserPassword>::iterator ittu;
 		for (ittu=myWebem->m_userpasswords.begin(); ittu!=myWebem->m_userpasswords.end(); ++ittu) {
 			if (ittu->Username == session.username) { // the user still exists
@@ -1555,8 +1594,8 @@ bool cWebemRequestHandler::checkAuthToken(WebEmSession & session) {
 			return false;
 		}
 
-		WebEmSession* oldSession = myWebem->GetSession(session.id);
-		if (oldSession == NULL) {
+		WebEmSession oldSession;
+		if (!myWebem->GetSession(session.id, oldSession)) {
 #ifdef DEBUG_WWW
 			_log.Log(LOG_STATUS, "[web:%s] CheckAuthToken(%s_%s_%s) : restore session", myWebem->GetPort().c_str(), session.id.c_str(), session.auth_token.c_str(), session.username.c_str());
 #endif
@@ -1585,8 +1624,8 @@ char *cWebemRequestHandler::strftime_t(const char *format, const time_t rawtime)
 
 void cWebemRequestHandler::handle_request(const request& req, reply& rep)
 {
-	if (_log.isTraceEnabled())	  
-		_log.Log(LOG_TRACE, "WEBH : Host:%s Uri;%s", req.host_address.c_str(), req.uri.c_str());
+	if (_log.isTraceEnabled(LOGCAT_WEBSERVER))	  
+		_log.Log(LOGCAT_WEBSERVER, LOG_TRACE, "WEBH : Host:%s Uri;%s", req.host_address.c_str(), req.uri.c_str());
 
 	// Initialize session
 	WebEmSession session;
@@ -1771,23 +1810,25 @@ void cWebemRequestHandler::handle_request(const request& req, reply& rep)
 
 	} else if (session.id.size() > 0) {
 		// Renew session expiration and authentication token
-		WebEmSession* memSession = myWebem->GetSession(session.id);
-		if (memSession != NULL)
+		WebEmSession memSession;
+		if (myWebem->GetSession(session.id, memSession))
 		{
 			time_t now = mytime(NULL);
 			// Renew session expiration date if half of session duration has been exceeded ("dont remember me" sessions, 10 minutes)
-			if (memSession->expires - (SHORT_SESSION_TIMEOUT / 2) < now)
+			if (memSession.expires - (SHORT_SESSION_TIMEOUT / 2) < now)
 			{
-				memSession->expires = now + SHORT_SESSION_TIMEOUT;
-				memSession->auth_token = generateAuthToken(*memSession, req); // do it after expires to save it also
-				send_cookie(rep, *memSession);
+				memSession.expires = now + SHORT_SESSION_TIMEOUT;
+				memSession.auth_token = generateAuthToken(memSession, req); // do it after expires to save it also
+				myWebem->AddSession(memSession);
+				send_cookie(rep, memSession);
 			}
 			// Renew session expiration date if half of session duration has been exceeded ("remember me" sessions, 30 days)
-			else if ((memSession->expires > SHORT_SESSION_TIMEOUT + now) && (memSession->expires - (LONG_SESSION_TIMEOUT / 2) < now))
+			else if ((memSession.expires > SHORT_SESSION_TIMEOUT + now) && (memSession.expires - (LONG_SESSION_TIMEOUT / 2) < now))
 			{
-				memSession->expires = now + LONG_SESSION_TIMEOUT;
-				memSession->auth_token = generateAuthToken(*memSession, req); // do it after expires to save it also
-				send_cookie(rep, *memSession);
+				memSession.expires = now + LONG_SESSION_TIMEOUT;
+				memSession.auth_token = generateAuthToken(memSession, req); // do it after expires to save it also
+				myWebem->AddSession(memSession);
+				send_cookie(rep, memSession);
 			}
 		}
 	}
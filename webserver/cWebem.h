@@ -191,8 +191,11 @@ namespace http {
 			std::string ExtractRequestPath(const std::string& original_request_path);
 			bool IsBadRequestPath(const std::string& original_request_path);
 			
+			void SetUserPasswords(const std::vector<_tWebUserPassword> &users);
 			void ClearUserPasswords();
+			/// requests are authenticated on several threads, lock m_userpasswordsMutex to use the list
 			std::vector<_tWebUserPassword> m_userpasswords;
+			boost::shared_mutex m_userpasswordsMutex;
 			void AddLocalNetworks(std::string network);
 			void ClearLocalNetworks();
 			std::vector<_tIPNetwork> m_localnetworks;
@@ -206,11 +209,12 @@ namespace http {
 
 			std::string m_zippassword;
 			const std::string GetPort();
-			WebEmSession * GetSession(const std::string & ssid);
+			bool GetSession(const std::string & ssid, WebEmSession & session);
 			void AddSession(const WebEmSession & session);
 			void RemoveSession(const WebEmSession & session);
 			void RemoveSession(const std::string & ssid);
 			int CountSessions();
+			std::vector<request_scheduler::class_statistics> GetRequestStatistics();
 			_eAuthenticationMethod m_authmethod;
 			//Whitelist url strings that bypass authentication checks (not used by basic-auth authentication)
 			std::vector < std::string > myWhitelistURLs;
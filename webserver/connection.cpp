@@ -12,6 +12,7 @@
 #include <vector>
 #include <boost/bind.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 #include "connection_manager.hpp"
 #include "request_handler.hpp"
 #include "../main/localtime_r.h"
@@ -24,9 +25,12 @@ namespace server {
 connection::connection(boost::asio::io_service& io_service,
 		connection_manager& manager,
 		request_handler& handler,
+		request_scheduler& scheduler,
 		int read_timeout) :
 				connection_manager_(manager),
 				request_handler_(handler),
+				request_scheduler_(scheduler),
+				io_service_(io_service),
 				read_timeout_(read_timeout),
 				read_timer_(io_service, boost::posix_time::seconds(read_timeout)),
 				status_(INITIALIZING),
@@ -48,10 +52,13 @@ connection::connection(boost::asio::io_service& io_service,
 connection::connection(boost::asio::io_service& io_service,
 		connection_manager& manager,
 		request_handler& handler,
+		request_scheduler& scheduler,
 		int read_timeout,
 		boost::asio::ssl::context& context) :
 				connection_manager_(manager),
 				request_handler_(handler),
+				request_scheduler_(scheduler),
+				io_service_(io_service),
 				read_timeout_(read_timeout),
 				read_timer_(io_service, boost::posix_time::seconds(read_timeout)),
 				status_(INITIALIZING),
@@ -221,50 +228,30 @@ void connection::handle_read(const boost::system::error_code& error, std::size_t
 			if (request_.host_address.substr(0, 7) == "::ffff:") {
 				request_.host_address = request_.host_address.substr(7);
 			}
-			request_handler_.handle_request(request_, reply_);
-
-			if (request_.keep_alive && ((reply_.status == reply::ok) || (reply_.status == reply::no_content) || (reply_.status == reply::not_modified))) {
-				// Allows request handler to override the header (but it should not)
-				reply::add_header_if_absent(&reply_, "Connection", "Keep-Alive");
-				std::stringstream ss;
-				ss << "max=" << default_max_requests_ << ", timeout=" << read_timeout_;
-				reply::add_header_if_absent(&reply_, "Keep-Alive", ss.str());
+			status_ = WAITING_HANDLER;
+			request_class rclass = request_scheduler::classify(request_);
+			if (request_scheduler::runs_inline(rclass))
+			{
+				request_scheduler_.run(rclass, boost::bind(&connection::handle_request, this, boost::cref(request_), _1));
+				send_reply(request_.method);
+				return;
 			}
-
-			status_ = WAITING_WRITE;
-
-			if (secure_) {
-#ifdef WWW_ENABLE_SSL
-				boost::asio::async_write(*sslsocket_, reply_.to_buffers(request_.method),
-					boost::bind(&connection::handle_write, shared_from_this(),
-						boost::asio::placeholders::error));
-#endif
-			}
-			else {
-				boost::asio::async_write(*socket_, reply_.to_buffers(request_.method),
-					boost::bind(&connection::handle_write, shared_from_this(),
-						boost::asio::placeholders::error));
+			// the request is handled by a worker, the io_service thread keeps serving the other connections
+			int retry_after = 0;
+			if (!request_scheduler_.submit(request_scheduler::client_key(request_), rclass,
+				boost::bind(&connection::handle_queued_request, shared_from_this(), request_, _1), retry_after))
+			{
+				keepalive_ = false;
+				reply_ = reply::stock_reply(reply::service_unavailable);
+				reply::add_header(&reply_, "Retry-After", boost::lexical_cast<std::string>(retry_after));
+				send_reply(request_.method);
 			}
 		}
 		else if (!result)
 		{
 			keepalive_ = false;
 			reply_ = reply::stock_reply(reply::bad_request);
-
-			status_ = WAITING_WRITE;
-
-			if (secure_) {
-#ifdef WWW_ENABLE_SSL
-				boost::asio::async_write(*sslsocket_, reply_.to_buffers(request_.method),
-					boost::bind(&connection::handle_write, shared_from_this(),
-						boost::asio::placeholders::error));
-#endif
-			}
-			else {
-				boost::asio::async_write(*socket_, reply_.to_buffers(request_.method),
-					boost::bind(&connection::handle_write, shared_from_this(),
-						boost::asio::placeholders::error));
-			}
+			send_reply(request_.method);
 		}
 		else
 		{
@@ -277,6 +264,55 @@ void connection::handle_read(const boost::system::error_code& error, std::size_t
 	}
 }
 
+void connection::handle_request(const request& req, int retry_after)
+{
+	if (retry_after == 0)
+	{
+		reply_.reset();
+		request_handler_.handle_request(req, reply_);
+
+		if (req.keep_alive && ((reply_.status == reply::ok) || (reply_.status == reply::no_content) || (reply_.status == reply::not_modified))) {
+			// Allows request handler to override the header (but it should not)
+			reply::add_header_if_absent(&reply_, "Connection", "Keep-Alive");
+			std::stringstream ss;
+			ss << "max=" << default_max_requests_ << ", timeout=" << read_timeout_;
+			reply::add_header_if_absent(&reply_, "Keep-Alive", ss.str());
+		}
+	}
+	else
+	{
+		// waited too long in the queue
+		keepalive_ = false;
+		reply_ = reply::stock_reply(reply::service_unavailable);
+		reply::add_header(&reply_, "Retry-After", boost::lexical_cast<std::string>(retry_after));
+	}
+}
+
+void connection::handle_queued_request(const request& req, int retry_after)
+{
+	handle_request(req, retry_after);
+	// socket operations and the connection manager belong to the io_service thread
+	io_service_.post(boost::bind(&connection::send_reply, shared_from_this(), req.method));
+}
+
+void connection::send_reply(const std::string& method)
+{
+	status_ = WAITING_WRITE;
+
+	if (secure_) {
+#ifdef WWW_ENABLE_SSL
+		boost::asio::async_write(*sslsocket_, reply_.to_buffers(method),
+			boost::bind(&connection::handle_write, shared_from_this(),
+				boost::asio::placeholders::error));
+#endif
+	}
+	else {
+		boost::asio::async_write(*socket_, reply_.to_buffers(method),
+			boost::bind(&connection::handle_write, shared_from_this(),
+				boost::asio::placeholders::error));
+	}
+}
+
 void connection::handle_write(const boost::system::error_code& error)
 {
 	status_ = ENDING_WRITE;
@@ -20,6 +20,7 @@
 #include "request.hpp"
 #include "request_handler.hpp"
 #include "request_parser.hpp"
+#include "request_scheduler.hpp"
 #ifdef WWW_ENABLE_SSL
 #include <boost/asio/ssl.hpp>
 typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket> ssl_socket;
@@ -38,10 +39,10 @@ class connection
 public:
   /// Construct a connection with the given io_service.
   explicit connection(boost::asio::io_service& io_service,
-      connection_manager& manager, request_handler& handler, int timeout);
+      connection_manager& manager, request_handler& handler, request_scheduler& scheduler, int timeout);
 #ifdef WWW_ENABLE_SSL
   explicit connection(boost::asio::io_service& io_service,
-      connection_manager& manager, request_handler& handler, int timeout, boost::asio::ssl::context& context);
+      connection_manager& manager, request_handler& handler, request_scheduler& scheduler, int timeout, boost::asio::ssl::context& context);
 #endif
   ~connection();
 
@@ -67,6 +68,15 @@ private:
   void handle_read(const boost::system::error_code& e, std::size_t bytes_transferred);
   void read_more();
 
+  /// Handle a request and prepare the reply.
+  void handle_request(const request& req, int retry_after);
+
+  /// Handle a request on a worker of the request scheduler.
+  void handle_queued_request(const request& req, int retry_after);
+
+  /// Write the reply to the client.
+  void send_reply(const std::string& method);
+
   /// Handle completion of a write operation.
   void handle_write(const boost::system::error_code& e);
 
@@ -110,6 +120,12 @@ private:
   /// The handler used to process the incoming request.
   request_handler& request_handler_;
 
+  /// The scheduler that decides when the request is handled.
+  request_scheduler& request_scheduler_;
+
+  /// The io_service of the connection, replies are sent from its thread.
+  boost::asio::io_service& io_service_;
+
   /// The parser for the incoming request.
   request_parser request_parser_;
 
@@ -126,6 +142,7 @@ private:
 	ENDING_HANDSHAKE,
     WAITING_READ,
 	READING,
+	WAITING_HANDLER,
     WAITING_WRITE,
 	ENDING_WRITE
   } status_;
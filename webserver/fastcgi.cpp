@@ -4,19 +4,30 @@
 #include <sstream>
 #include <boost/lexical_cast.hpp>
 
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
 #include "../httpclient/UrlEncode.h"
 #include "../main/Helper.h"
+#include "../main/Logger.h"
 
 //(c) 2016 GizMoCuz
 
-//To be done!
-//ibfcgi-dev << source also contains win32 project
-//The below is not FastCGI (yet)
+//When a FastCGI server is configured (-fastcgi_server), php files are handled by the FastCGI client below,
+//otherwise php-cgi is started for every request
+
+#define FCGI_CONNECT_TIMEOUT 5		//seconds
+#define FCGI_READ_TIMEOUT 30		//seconds
+#define FCGI_MAX_IDLE_CONNECTIONS 4	//per server
+#define FCGI_MAX_RECORD_CONTENT 65535
 
 namespace http {
 	namespace server {
 
 uint16_t fastcgi_parser::request_id_ = 1;
+boost::mutex fastcgi_client::pool_mutex_;
+std::multimap<std::string, boost::shared_ptr<fastcgi_connection> > fastcgi_client::pool_;
 		
 //http://www.mit.edu/~yandros/doc/specs/fcgi-spec.html
 struct _tFCGI_Header {
@@ -159,8 +170,495 @@ std::string ExecuteCommandAndReturnRaw(const std::string &szCommand)
 	return ret;
 }
 
+
+//A connection to a FastCGI responder, over TCP or a unix domain socket
+//The calls block the caller, but every operation is limited by a deadline, so a hanging
+//responder can not block the webserver forever
+class fastcgi_connection
+{
+public:
+	explicit fastcgi_connection(const std::string &server) :
+		server_(server),
+		next_request_id_(1),
+		timed_out_(false)
+	{
+	}
+	~fastcgi_connection()
+	{
+		close();
+	}
+	const std::string &server() const
+	{
+		return server_;
+	}
+	bool timed_out() const
+	{
+		return timed_out_;
+	}
+	bool connect()
+	{
+		boost::system::error_code ec;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		if (server_.find(':') == std::string::npos)
+		{
+			local_socket_.reset(new boost::asio::local::stream_protocol::socket(io_service_));
+			result_ = boost::asio::error::would_block;
+			local_socket_->async_connect(boost::asio::local::stream_protocol::endpoint(server_),
+				boost::bind(&fastcgi_connection::handle_io, this, boost::asio::placeholders::error));
+			if (!complete(FCGI_CONNECT_TIMEOUT))
+			{
+				_log.Log(LOG_ERROR, "FastCGI: Could not connect to %s (%s)", server_.c_str(), error_message().c_str());
+				close();
+				return false;
+			}
+			return true;
+		}
+#endif
+		size_t pos = server_.rfind(':');
+		if (pos == std::string::npos)
+		{
+			_log.Log(LOG_ERROR, "FastCGI: Invalid server address: %s", server_.c_str());
+			return false;
+		}
+		boost::asio::ip::tcp::resolver resolver(io_service_);
+		boost::asio::ip::tcp::resolver::query query(server_.substr(0, pos), server_.substr(pos + 1));
+		boost::asio::ip::tcp::resolver::iterator iter = resolver.resolve(query, ec);
+		if (ec)
+		{
+			_log.Log(LOG_ERROR, "FastCGI: Could not resolve %s (%s)", server_.c_str(), ec.message().c_str());
+			return false;
+		}
+		tcp_socket_.reset(new boost::asio::ip::tcp::socket(io_service_));
+		result_ = boost::asio::error::would_block;
+		boost::asio::async_connect(*tcp_socket_, iter,
+			boost::bind(&fastcgi_connection::handle_io, this, boost::asio::placeholders::error));
+		if (!complete(FCGI_CONNECT_TIMEOUT))
+		{
+			_log.Log(LOG_ERROR, "FastCGI: Could not connect to %s (%s)", server_.c_str(), error_message().c_str());
+			close();
+			return false;
+		}
+		tcp_socket_->set_option(boost::asio::ip::tcp::no_delay(true), ec);
+		return true;
+	}
+	void close()
+	{
+		boost::system::error_code ec;
+		if (tcp_socket_)
+		{
+			tcp_socket_->close(ec);
+			tcp_socket_.reset();
+		}
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		if (local_socket_)
+		{
+			local_socket_->close(ec);
+			local_socket_.reset();
+		}
+#endif
+	}
+	bool write(const std::string &data)
+	{
+		result_ = boost::asio::error::would_block;
+		if (tcp_socket_)
+			boost::asio::async_write(*tcp_socket_, boost::asio::buffer(data),
+				boost::bind(&fastcgi_connection::handle_io, this, boost::asio::placeholders::error));
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		else if (local_socket_)
+			boost::asio::async_write(*local_socket_, boost::asio::buffer(data),
+				boost::bind(&fastcgi_connection::handle_io, this, boost::asio::placeholders::error));
+#endif
+		else
+			return false;
+		return complete(FCGI_READ_TIMEOUT);
+	}
+	bool read(char *pData, const size_t length)
+	{
+		result_ = boost::asio::error::would_block;
+		if (tcp_socket_)
+			boost::asio::async_read(*tcp_socket_, boost::asio::buffer(pData, length),
+				boost::bind(&fastcgi_connection::handle_io, this, boost::asio::placeholders::error));
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		else if (local_socket_)
+			boost::asio::async_read(*local_socket_, boost::asio::buffer(pData, length),
+				boost::bind(&fastcgi_connection::handle_io, this, boost::asio::placeholders::error));
+#endif
+		else
+			return false;
+		if (!complete(FCGI_READ_TIMEOUT))
+		{
+			if (timed_out_)
+				_log.Log(LOG_ERROR, "FastCGI: No response from %s within %d seconds", server_.c_str(), FCGI_READ_TIMEOUT);
+			return false;
+		}
+		return true;
+	}
+	//Request IDs are unique per connection, 0 is reserved for management records
+	uint16_t next_request_id()
+	{
+		uint16_t id = next_request_id_++;
+		if (next_request_id_ == 0)
+			next_request_id_ = 1;
+		return id;
+	}
+private:
+	//Runs the io_service until the started operation completed or the deadline expired
+	bool complete(const int seconds)
+	{
+		timed_out_ = false;
+		boost::asio::deadline_timer timer(io_service_, boost::posix_time::seconds(seconds));
+		timer.async_wait(boost::bind(&fastcgi_connection::handle_timeout, this, boost::asio::placeholders::error));
+		io_service_.reset();
+		while (result_ == boost::asio::error::would_block)
+			io_service_.run_one();
+		timer.cancel();
+		//let the cancelled timer handler run
+		io_service_.run();
+		return ((!result_) && (!timed_out_));
+	}
+	void handle_io(const boost::system::error_code &error)
+	{
+		result_ = error;
+	}
+	void handle_timeout(const boost::system::error_code &error)
+	{
+		if (error == boost::asio::error::operation_aborted)
+			return;
+		if (result_ != boost::asio::error::would_block)
+			return;
+		//aborts the pending operation, the connection can not be used anymore
+		timed_out_ = true;
+		boost::system::error_code ec;
+		if (tcp_socket_)
+			tcp_socket_->close(ec);
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		if (local_socket_)
+			local_socket_->close(ec);
+#endif
+	}
+	std::string error_message()
+	{
+		return (timed_out_) ? "timeout" : result_.message();
+	}
+
+	std::string server_;
+	uint16_t next_request_id_;
+	boost::asio::io_service io_service_;
+	boost::system::error_code result_;
+	bool timed_out_;
+	boost::shared_ptr<boost::asio::ip::tcp::socket> tcp_socket_;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	boost::shared_ptr<boost::asio::local::stream_protocol::socket> local_socket_;
+#endif
+};
+
+static void fcgi_add_record(std::string &buffer, const uint8_t type, const uint16_t request_id, const char *pData, const size_t length)
+{
+	_tFCGI_Header header;
+	header.version = FCGI_VERSION_1;
+	header.type = type;
+	header.requestIdB1 = (uint8_t)((request_id >> 8) & 0xFF);
+	header.requestIdB0 = (uint8_t)(request_id & 0xFF);
+	header.contentLengthB1 = (uint8_t)((length >> 8) & 0xFF);
+	header.contentLengthB0 = (uint8_t)(length & 0xFF);
+	//records are aligned on 8 bytes
+	header.paddingLength = (uint8_t)((8 - (length % 8)) % 8);
+	header.reserved = 0;
+	buffer.append((const char*)&header, FCGI_HEADER_LEN);
+	if (length > 0)
+		buffer.append(pData, length);
+	buffer.append(header.paddingLength, '\0');
+}
+
+//Splits a stream in records, an empty record marks the end of the stream
+static void fcgi_add_stream(std::string &buffer, const uint8_t type, const uint16_t request_id, const std::string &data)
+{
+	size_t pos = 0;
+	while (pos < data.size())
+	{
+		size_t length = data.size() - pos;
+		if (length > FCGI_MAX_RECORD_CONTENT)
+			length = FCGI_MAX_RECORD_CONTENT;
+		fcgi_add_record(buffer, type, request_id, data.data() + pos, length);
+		pos += length;
+	}
+	fcgi_add_record(buffer, type, request_id, NULL, 0);
+}
+
+static void fcgi_add_length(std::string &buffer, const size_t length)
+{
+	if (length < 128)
+	{
+		buffer += (char)length;
+		return;
+	}
+	buffer += (char)(((length >> 24) & 0x7F) | 0x80);
+	buffer += (char)((length >> 16) & 0xFF);
+	buffer += (char)((length >> 8) & 0xFF);
+	buffer += (char)(length & 0xFF);
+}
+
+bool fastcgi_client::execute(const std::string &server, const std::vector<std::pair<std::string, std::string> > &params, const std::string &content, std::string &output, std::string &errors)
+{
+	//A pooled connection could have been closed by the responder, retry once on a new connection
+	//(but not when the responder did not answer in time)
+	for (int ii = 0; ii < 2; ii++)
+	{
+		bool bReused = false;
+		boost::shared_ptr<fastcgi_connection> connection = get_connection(server, bReused);
+		if (!connection)
+			return false;
+		size_t output_size = output.size();
+		bool bKeepConnection = false;
+		bool bResult = do_request(*connection, params, content, output, errors, bKeepConnection);
+		if (bKeepConnection)
+			release_connection(connection);
+		if (bResult)
+			return true;
+		if ((!bReused) || (connection->timed_out()) || (output.size() != output_size))
+			return false;
+	}
+	return false;
+}
+
+void fastcgi_client::close_all()
+{
+	boost::lock_guard<boost::mutex> l(pool_mutex_);
+	pool_.clear();
+}
+
+boost::shared_ptr<fastcgi_connection> fastcgi_client::get_connection(const std::string &server, bool &bReused)
+{
+	{
+		boost::lock_guard<boost::mutex> l(pool_mutex_);
+		std::multimap<std::string, boost::shared_ptr<fastcgi_connection> >::iterator itt = pool_.find(server);
+		if (itt != pool_.end())
+		{
+			boost::shared_ptr<fastcgi_connection> connection = itt->second;
+			pool_.erase(itt);
+			bReused = true;
+			return connection;
+		}
+	}
+	bReused = false;
+	boost::shared_ptr<fastcgi_connection> connection(new fastcgi_connection(server));
+	if (!connection->connect())
+		connection.reset();
+	return connection;
+}
+
+void fastcgi_client::release_connection(const boost::shared_ptr<fastcgi_connection> &connection)
+{
+	boost::lock_guard<boost::mutex> l(pool_mutex_);
+	if (pool_.count(connection->server()) >= FCGI_MAX_IDLE_CONNECTIONS)
+		return;
+	pool_.insert(std::pair<std::string, boost::shared_ptr<fastcgi_connection> >(connection->server(), connection));
+}
+
+bool fastcgi_client::do_request(fastcgi_connection &connection, const std::vector<std::pair<std::string, std::string> > &params, const std::string &content, std::string &output, std::string &errors, bool &bKeepConnection)
+{
+	bKeepConnection = false;
+	uint16_t request_id = connection.next_request_id();
+
+	//Build the complete request (begin request, params and stdin) and send it in one write
+	std::string buffer;
+	_tFCGI_BeginRequestBody begin;
+	memset(&begin, 0, sizeof(begin));
+	begin.roleB1 = 0;
+	begin.roleB0 = FCGI_RESPONDER;
+	begin.flags = FCGI_KEEP_CONN;
+	fcgi_add_record(buffer, FCGI_BEGIN_REQUEST, request_id, (const char*)&begin, sizeof(begin));
+
+	std::string szParams;
+	std::vector<std::pair<std::string, std::string> >::const_iterator itt;
+	for (itt = params.begin(); itt != params.end(); ++itt)
+	{
+		fcgi_add_length(szParams, itt->first.size());
+		fcgi_add_length(szParams, itt->second.size());
+		szParams += itt->first;
+		szParams += itt->second;
+	}
+	fcgi_add_stream(buffer, FCGI_PARAMS, request_id, szParams);
+	fcgi_add_stream(buffer, FCGI_STDIN, request_id, content);
+
+	if (!connection.write(buffer))
+		return false;
+
+	//Read the response records, STDOUT is appended as it arrives
+	std::vector<char> record;
+	while (true)
+	{
+		_tFCGI_Header header;
+		if (!connection.read((char*)&header, FCGI_HEADER_LEN))
+			return false;
+		if (header.version != FCGI_VERSION_1)
+		{
+			_log.Log(LOG_ERROR, "FastCGI: Invalid record received from %s", connection.server().c_str());
+			return false;
+		}
+		size_t length = (header.contentLengthB1 << 8) | header.contentLengthB0;
+		size_t total = length + header.paddingLength;
+		record.resize(total);
+		if ((total > 0) && (!connection.read(&record[0], total)))
+			return false;
+
+		uint16_t record_id = (header.requestIdB1 << 8) | header.requestIdB0;
+		if (record_id != request_id)
+			continue; //not for us (management record or an old request)
+
+		switch (header.type)
+		{
+		case FCGI_STDOUT:
+			if (length > 0)
+				output.append(&record[0], length);
+			break;
+		case FCGI_STDERR:
+			if (length > 0)
+				errors.append(&record[0], length);
+			break;
+		case FCGI_END_REQUEST:
+		{
+			if (length < sizeof(_tFCGI_EndRequestBody))
+				return false;
+			_tFCGI_EndRequestBody *pEnd = (_tFCGI_EndRequestBody*)&record[0];
+			if (pEnd->protocolStatus != FCGI_REQUEST_COMPLETE)
+			{
+				_log.Log(LOG_ERROR, "FastCGI: Request rejected by %s (status: %d)", connection.server().c_str(), pEnd->protocolStatus);
+				//FCGI_CANT_MPX_CONN/FCGI_OVERLOADED, do not reuse this connection
+				return false;
+			}
+			bKeepConnection = true;
+			return true;
+		}
+		default:
+			break;
+		}
+	}
+	return false;
+}
+
 extern std::istream & safeGetline(std::istream & is, std::string & line);
 
+//Converts the CGI headers in front of the output to reply headers, the remainder is the content
+bool fastcgi_parser::parse_cgi_output(std::string &output, reply &rep)
+{
+	size_t hend = output.find("\n\r\n");
+	size_t hlen = 3;
+	size_t hend2 = output.find("\n\n");
+	if ((hend2 != std::string::npos) && ((hend == std::string::npos) || (hend2 < hend)))
+	{
+		hend = hend2;
+		hlen = 2;
+	}
+	if (hend == std::string::npos)
+	{
+		rep = reply::stock_reply(reply::internal_server_error);
+		return false;
+	}
+	std::string headers = output.substr(0, hend + 1);
+	output.erase(0, hend + hlen);
+
+	rep.status = reply::ok;
+	int status = reply::ok;
+	std::string location;
+	std::vector<std::string> lines;
+	StringSplit(headers, "\n", lines);
+	std::vector<std::string>::iterator itt;
+	for (itt = lines.begin(); itt != lines.end(); ++itt)
+	{
+		std::string theader = *itt;
+		if ((!theader.empty()) && (theader[theader.size() - 1] == '\r'))
+			theader.erase(theader.size() - 1);
+		size_t tpos = theader.find(':');
+		if (tpos == std::string::npos)
+			continue;
+		std::string hfirst = theader.substr(0, tpos);
+		std::string hlast = theader.substr(tpos + 1);
+		if ((!hlast.empty()) && (hlast[0] == ' '))
+			hlast = hlast.substr(1);
+		if (hlast.empty())
+			continue;
+
+		//Check if we have a status return
+		if (hfirst == "Status")
+		{
+			status = atoi(hlast.c_str());
+			continue;
+		}
+		if (hfirst == "Location")
+			location = hlast;
+		reply::add_header(&rep, hfirst, hlast);
+	}
+	if (status != reply::ok)
+	{
+		//For the FastCGI client the output is the content of the reply, clear it before the stock reply is set
+		output.clear();
+		rep = reply::stock_reply((reply::status_type)status);
+		if ((status >= 300) && (status < 400) && (!location.empty()))
+			reply::add_header(&rep, "Location", location);
+	}
+	return true;
+}
+
+bool fastcgi_parser::handleFastCGI(const server_settings &settings, const std::string &script_path, const request &req, reply &rep, modify_info &mInfo)
+{
+	std::string szQueryString;
+	size_t paramPos = req.uri.find_first_of('?');
+	if (paramPos != std::string::npos)
+		szQueryString = req.uri.substr(paramPos + 1);
+
+	std::vector<std::pair<std::string, std::string> > params;
+	params.push_back(std::make_pair("SCRIPT_FILENAME", settings.www_root + script_path));
+	params.push_back(std::make_pair("QUERY_STRING", szQueryString));
+	params.push_back(std::make_pair("REQUEST_METHOD", req.method));
+	const char *pContent_Type = request::get_req_header(&req, "Content-Type");
+	params.push_back(std::make_pair("CONTENT_TYPE", std::string((pContent_Type != NULL) ? pContent_Type : "")));
+	params.push_back(std::make_pair("CONTENT_LENGTH", boost::lexical_cast<std::string>(req.content.size())));
+	params.push_back(std::make_pair("SCRIPT_NAME", script_path));
+	params.push_back(std::make_pair("REQUEST_URI", req.uri));
+	params.push_back(std::make_pair("DOCUMENT_URI", script_path));
+	params.push_back(std::make_pair("DOCUMENT_ROOT", settings.www_root));
+	params.push_back(std::make_pair("SERVER_PROTOCOL", std::string("HTTP/1.1")));
+	params.push_back(std::make_pair("REQUEST_SCHEME", std::string(settings.is_secure() ? "https" : "http")));
+	if (settings.is_secure())
+		params.push_back(std::make_pair("HTTPS", std::string("on")));
+	params.push_back(std::make_pair("GATEWAY_INTERFACE", std::string("CGI/1.1")));
+	params.push_back(std::make_pair("SERVER_SOFTWARE", std::string("Domoticz")));
+	params.push_back(std::make_pair("REMOTE_ADDR", req.host_address));
+	params.push_back(std::make_pair("REMOTE_PORT", req.host_port));
+	params.push_back(std::make_pair("SERVER_ADDR", settings.listening_address));
+	params.push_back(std::make_pair("SERVER_PORT", settings.listening_port));
+	params.push_back(std::make_pair("SERVER_NAME", std::string("localhost")));
+	params.push_back(std::make_pair("REDIRECT_STATUS", std::string("200")));
+
+	std::vector<header>::const_iterator ittHeader;
+	for (ittHeader = req.headers.begin(); ittHeader != req.headers.end(); ++ittHeader)
+	{
+		std::string rName = "HTTP_" + ittHeader->name;
+		stdreplace(rName, "-", "_");
+		stdupper(rName);
+		if ((rName == "HTTP_CONTENT_TYPE") || (rName == "HTTP_CONTENT_LENGTH"))
+			continue;
+		params.push_back(std::make_pair(rName, ittHeader->value));
+	}
+
+	std::string errors;
+	rep.content.clear();
+	if (!fastcgi_client::execute(settings.fastcgi_server, params, req.content, rep.content, errors))
+	{
+		rep = reply::stock_reply(reply::service_unavailable);
+		return false;
+	}
+	if (!errors.empty())
+		_log.Log(LOG_ERROR, "FastCGI: %s: %s", script_path.c_str(), errors.c_str());
+	if (!parse_cgi_output(rep.content, rep))
+		return false;
+	if (!rep.content.empty())
+		reply::add_header(&rep, "Content-Length", boost::lexical_cast<std::string>(rep.content.size()));
+	mInfo.delay_status = true;
+	return true;
+}
+
 bool fastcgi_parser::handlePHP(const server_settings &settings, const std::string &script_path, const request &req, reply &rep, modify_info &mInfo)
 {
 	std::string full_path = settings.www_root + script_path;
@@ -172,6 +670,9 @@ bool fastcgi_parser::handlePHP(const server_settings &settings, const std::strin
 	}
 	is.close();
 
+	if (!settings.fastcgi_server.empty())
+		return handleFastCGI(settings, script_path, req, rep, mInfo);
+
 	std::multimap<std::string, std::string> parameters;
 
 	std::string request_path2 = req.uri; // we need the raw request string to parse the get-request
@@ -360,57 +861,8 @@ bool fastcgi_parser::handlePHP(const server_settings &settings, const std::strin
 		rep = reply::stock_reply(reply::not_found);
 		return false;
 	}
-	rep.status = reply::ok;
-	//Add the headers
-	bool bDoneWithHeaders = false;
-	while (!bDoneWithHeaders)
-	{
-		size_t tpos = pret.find('\n');
-		if (tpos == std::string::npos)
-		{
-			rep = reply::stock_reply(reply::internal_server_error);
-			return false;
-		}
-
-		if (tpos == 0)
-		{
-			bDoneWithHeaders = true;
-			pret = pret.substr(tpos + 1);
-		}
-		else
-		{
-			std::string theader = pret.substr(0, tpos);
-			pret = pret.substr(tpos + 1);
-
-			//Check if we have a status return
-			if (theader.find("Status") == 0)
-			{
-				tpos = theader.find(':');
-				if (tpos == std::string::npos)
-					continue;
-				theader = theader.substr(tpos + 1);
-				if (theader[0] == ' ')
-					theader = theader.substr(1);
-				tpos = theader.find(' ');
-				if (tpos == std::string::npos)
-					continue;
-				std::string errcode = theader.substr(0, tpos);
-				rep = reply::stock_reply((reply::status_type)atoi(errcode.c_str()));
-				return true;
-			}
-
-			tpos = theader.find(':');
-			if (tpos == std::string::npos)
-				continue;
-			std::string hfirst = theader.substr(0, tpos);
-			std::string hlast = theader.substr(tpos + 1);
-			if (hlast.empty())
-				continue;
-			if (hlast[0] == ' ')
-				hlast = hlast.substr(1);
-			reply::add_header(&rep, hfirst, hlast);
-		}
-	}
+	if (!parse_cgi_output(pret, rep))
+		return false;
 	if (!pret.empty())
 	{
 		rep.content.append(pret);
@@ -5,6 +5,10 @@
 #include "request_handler.hpp"
 #include <boost/logic/tribool.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <vector>
 
 #include "reply.hpp"
 #include "request.hpp"
@@ -19,6 +23,30 @@ class fastcgi_parser
 public:
 	static bool handlePHP(const server_settings &settings, const std::string &script_path, const request &req, reply &rep, modify_info &mInfo);
 	static uint16_t request_id_;
+private:
+	static bool handleFastCGI(const server_settings &settings, const std::string &script_path, const request &req, reply &rep, modify_info &mInfo);
+	static bool parse_cgi_output(std::string &output, reply &rep);
+};
+
+class fastcgi_connection;
+
+//Client for a FastCGI responder (php-fpm, ...)
+//Connections are opened with FCGI_KEEP_CONN and kept in a pool for the next request
+class fastcgi_client
+{
+public:
+	//server is "host:port" or the path of a unix domain socket
+	//The STDOUT stream of the responder is appended to output as the records arrive
+	static bool execute(const std::string &server, const std::vector<std::pair<std::string, std::string> > &params, const std::string &content, std::string &output, std::string &errors);
+	//Close all pooled connections
+	static void close_all();
+private:
+	static boost::shared_ptr<fastcgi_connection> get_connection(const std::string &server, bool &bReused);
+	static void release_connection(const boost::shared_ptr<fastcgi_connection> &connection);
+	static bool do_request(fastcgi_connection &connection, const std::vector<std::pair<std::string, std::string> > &params, const std::string &content, std::string &output, std::string &errors, bool &bKeepConnection);
+
+	static boost::mutex pool_mutex_;
+	static std::multimap<std::string, boost::shared_ptr<fastcgi_connection> > pool_;
 };
 
 } //namespace server
@@ -261,9 +261,7 @@ void request_handler::handle_request(const request &req, reply &rep, modify_info
 			  return;
 		  }
 
-		  //
-		  //For now this is very simplistic!
-		  //Later we should add FastCGI support, or at least provide some environment variables
+		  //Handled by the configured FastCGI server, or by starting php-cgi
 		  fastcgi_parser::handlePHP(myWebem->m_settings, request_path, req, rep, mInfo);
 		  return;
 	  }
@@ -0,0 +1,319 @@
+//
+// request_scheduler.cpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+#include "stdafx.h"
+#include "request_scheduler.hpp"
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "../main/Logger.h"
+
+#define SCHEDULER_SCRIPT_WORKERS 2	// php pages and cgi handlers that run at the same time
+#define SCHEDULER_BULK_WORKERS 2	// graphs, logs, ... that run at the same time
+#define SCHEDULER_WORKERS (SCHEDULER_SCRIPT_WORKERS + SCHEDULER_BULK_WORKERS)	// workers for the queued requests
+#define SCHEDULER_MAX_PER_CLIENT 16	// queued and active bulk requests of one client, a log page loads up to 8 graphs
+#define SCHEDULER_MAX_RETRY_AFTER 60	// seconds
+
+namespace http {
+namespace server {
+
+namespace {
+	struct class_limits {
+		const char *name;
+		bool handled_inline;	// on the io_service thread, not queued
+		int max_active;
+		int max_queued;
+		int max_wait;	// seconds
+	};
+	// The command and static handlers share state (users, sessions, custom icons, ...) that
+	// is only safe to use from one thread, they are handled on the io_service thread.
+	// A php page waits on the FastCGI server (up to its read timeout), so scripts have their
+	// own workers and can not hold up the io_service thread or the graphs.
+	// The bulk queue holds a full page load for several clients
+	const class_limits limits[REQUEST_CLASS_COUNT] = {
+		{ "command", true, 1, 0, 0 },
+		{ "static", true, 1, 0, 0 },
+		{ "script", false, SCHEDULER_SCRIPT_WORKERS, 32, 30 },
+		{ "bulk", false, SCHEDULER_BULK_WORKERS, 64, 30 }
+	};
+
+	// Value of a parameter in the query string of the uri
+	std::string get_uri_parameter(const std::string &uri, const std::string &name)
+	{
+		size_t pos = uri.find('?');
+		while (pos != std::string::npos)
+		{
+			pos++;
+			if (uri.compare(pos, name.size(), name) == 0 && uri[pos + name.size()] == '=')
+			{
+				size_t start = pos + name.size() + 1;
+				size_t end = uri.find('&', start);
+				return uri.substr(start, (end == std::string::npos) ? std::string::npos : end - start);
+			}
+			pos = uri.find('&', pos);
+		}
+		return "";
+	}
+}
+
+request_scheduler::request_scheduler() :
+		stop_requested_(false) {
+	for (int ii = 0; ii < REQUEST_CLASS_COUNT; ii++) {
+		class_state &cs = classes_[ii];
+		cs.active = 0;
+		cs.handled = 0;
+		cs.rejected_client = 0;
+		cs.rejected_queue = 0;
+		cs.expired = 0;
+		cs.total_queue_time = 0;
+		cs.max_queue_time = 0;
+		cs.total_exec_time = 0;
+	}
+}
+
+request_scheduler::~request_scheduler() {
+	stop();
+}
+
+void request_scheduler::start() {
+	boost::lock_guard<boost::mutex> l(mutex_);
+	if (!workers_.empty())
+		return;
+	stop_requested_ = false;
+	for (int ii = 0; ii < SCHEDULER_WORKERS; ii++) {
+		workers_.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&request_scheduler::worker, this))));
+	}
+}
+
+void request_scheduler::stop() {
+	std::vector<boost::shared_ptr<boost::thread> > workers;
+	{
+		boost::lock_guard<boost::mutex> l(mutex_);
+		stop_requested_ = true;
+		workers.swap(workers_);
+		cond_.notify_all();
+	}
+	std::vector<boost::shared_ptr<boost::thread> >::iterator itt;
+	for (itt = workers.begin(); itt != workers.end(); ++itt) {
+		(*itt)->join();
+	}
+
+	// the connections of requests that were still queued are closed by the connection manager
+	boost::lock_guard<boost::mutex> l(mutex_);
+	for (int ii = 0; ii < REQUEST_CLASS_COUNT; ii++) {
+		classes_[ii].queue.clear();
+	}
+	clients_.clear();
+}
+
+bool request_scheduler::submit(const std::string &client, const request_class rclass, const job_func &job, int &retry_after) {
+	boost::lock_guard<boost::mutex> l(mutex_);
+	class_state &cs = classes_[rclass];
+	retry_after = 0;
+	if (limits[rclass].handled_inline) {
+		_log.Log(LOG_ERROR, "[web] %s requests can not be queued", limits[rclass].name);
+		return false;
+	}
+	if (stop_requested_) {
+		retry_after = SCHEDULER_MAX_RETRY_AFTER;
+		return false;
+	}
+	int &outstanding = clients_[client];
+	if (outstanding >= SCHEDULER_MAX_PER_CLIENT) {
+		cs.rejected_client++;
+		retry_after = 1;
+		_log.Log(LOGCAT_WEBSERVER, LOG_TRACE, "[web] %s has %d requests outstanding, %s request rejected", client.c_str(), outstanding, limits[rclass].name);
+		return false;
+	}
+	if ((int)cs.queue.size() >= limits[rclass].max_queued) {
+		cs.rejected_queue++;
+		retry_after = get_retry_after(rclass);
+		_log.Log(LOGCAT_WEBSERVER, LOG_TRACE, "[web] %s queue full, request of %s rejected", limits[rclass].name, client.c_str());
+		return false;
+	}
+	outstanding++;
+
+	queued_job qjob;
+	qjob.client = client;
+	qjob.rclass = rclass;
+	qjob.job = job;
+	qjob.queued = boost::posix_time::microsec_clock::universal_time();
+	cs.queue.push_back(qjob);
+	cond_.notify_one();
+	return true;
+}
+
+void request_scheduler::run(const request_class rclass, const job_func &job) {
+	class_state &cs = classes_[rclass];
+	{
+		boost::lock_guard<boost::mutex> l(mutex_);
+		cs.active++;
+	}
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+	try {
+		job(0);
+	}
+	catch (std::exception& e) {
+		_log.Log(LOG_ERROR, "[web] exception occurred while handling request : '%s'", e.what());
+	}
+	catch (...) {
+		_log.Log(LOG_ERROR, "[web] unknown exception occurred while handling request");
+	}
+	boost::lock_guard<boost::mutex> l(mutex_);
+	cs.active--;
+	cs.handled++;
+	cs.total_exec_time += (boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds();
+}
+
+/// Called with mutex_ locked
+bool request_scheduler::next_job(queued_job &job) {
+	for (int ii = 0; ii < REQUEST_CLASS_COUNT; ii++) {
+		class_state &cs = classes_[ii];
+		if ((cs.queue.empty()) || (cs.active >= limits[ii].max_active))
+			continue;
+		job = cs.queue.front();
+		cs.queue.pop_front();
+		return true;
+	}
+	return false;
+}
+
+/// Called with mutex_ locked, estimate when the queue of the class has room again
+int request_scheduler::get_retry_after(const request_class rclass) {
+	const class_state &cs = classes_[rclass];
+	if (cs.handled == 0)
+		return 1;
+	double avg_exec_time = cs.total_exec_time / cs.handled;
+	int seconds = (int)((cs.queue.size() * avg_exec_time) / (limits[rclass].max_active * 1000)) + 1;
+	return (seconds > SCHEDULER_MAX_RETRY_AFTER) ? SCHEDULER_MAX_RETRY_AFTER : seconds;
+}
+
+/// Called with mutex_ locked
+void request_scheduler::release_client(const std::string &client) {
+	std::map<std::string, int>::iterator itt = clients_.find(client);
+	if (itt == clients_.end())
+		return;
+	if (--itt->second <= 0)
+		clients_.erase(itt);
+}
+
+void request_scheduler::worker() {
+	boost::unique_lock<boost::mutex> lock(mutex_);
+	while (!stop_requested_) {
+		queued_job job;
+		if (!next_job(job)) {
+			cond_.wait(lock);
+			continue;
+		}
+		class_state &cs = classes_[job.rclass];
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		int queue_time = (int)(start - job.queued).total_milliseconds();
+		int retry_after = 0;
+		if (queue_time > limits[job.rclass].max_wait * 1000) {
+			// the client probably gave up already, do not waste time on it
+			cs.expired++;
+			retry_after = get_retry_after(job.rclass);
+		}
+		else {
+			cs.active++;
+			cs.total_queue_time += queue_time;
+			if (queue_time > cs.max_queue_time)
+				cs.max_queue_time = queue_time;
+		}
+		lock.unlock();
+
+		try {
+			job.job(retry_after);
+		}
+		catch (std::exception& e) {
+			_log.Log(LOG_ERROR, "[web] exception occurred while handling request : '%s'", e.what());
+		}
+		catch (...) {
+			_log.Log(LOG_ERROR, "[web] unknown exception occurred while handling request");
+		}
+		job.job.clear();
+
+		lock.lock();
+		if (retry_after == 0) {
+			cs.active--;
+			cs.handled++;
+			cs.total_exec_time += (boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds();
+		}
+		release_client(job.client);
+		// a slot of this class is free again
+		cond_.notify_all();
+	}
+}
+
+std::vector<request_scheduler::class_statistics> request_scheduler::get_statistics() {
+	boost::lock_guard<boost::mutex> l(mutex_);
+	std::vector<class_statistics> ret;
+	for (int ii = 0; ii < REQUEST_CLASS_COUNT; ii++) {
+		const class_state &cs = classes_[ii];
+		class_statistics stats;
+		stats.name = limits[ii].name;
+		stats.active = cs.active;
+		stats.queued = (int)cs.queue.size();
+		stats.handled = cs.handled;
+		stats.rejected_client = cs.rejected_client;
+		stats.rejected_queue = cs.rejected_queue;
+		stats.expired = cs.expired;
+		stats.avg_queue_time = (cs.handled > 0) ? int(cs.total_queue_time / cs.handled) : 0;
+		stats.max_queue_time = cs.max_queue_time;
+		stats.avg_exec_time = (cs.handled > 0) ? int(cs.total_exec_time / cs.handled) : 0;
+		ret.push_back(stats);
+	}
+	return ret;
+}
+
+request_class request_scheduler::classify(const request &req) {
+	std::string path = req.uri.substr(0, req.uri.find('?'));
+	if ((path == "/backupdatabase.php") || (path == "/camsnapshot.jpg") || (path == "/raspberry.cgi") || (path == "/uvccapture.cgi"))
+		return REQUEST_BULK;
+	size_t dot = path.rfind('.');
+	if ((dot != std::string::npos) && (path.find('/', dot) == std::string::npos)) {
+		std::string extension = path.substr(dot + 1);
+		if ((extension == "php") || (extension == "cgi"))
+			return REQUEST_SCRIPT;
+	}
+	if (path == "/json.htm") {
+		std::string rtype = get_uri_parameter(req.uri, "type");
+		if ((rtype == "graph") || (rtype == "lightlog") || (rtype == "textlog") || (rtype == "scenelog"))
+			return REQUEST_BULK;
+		if ((rtype == "command") && (get_uri_parameter(req.uri, "param") == "getlog"))
+			return REQUEST_BULK;
+		return REQUEST_COMMAND;
+	}
+	// posted forms and actions (storesettings, restoredatabase, ...)
+	if ((req.method == "POST") || (path.find(".webem") != std::string::npos))
+		return REQUEST_COMMAND;
+	return REQUEST_STATIC;
+}
+
+bool request_scheduler::runs_inline(const request_class rclass) {
+	return limits[rclass].handled_inline;
+}
+
+std::string request_scheduler::client_key(const request &req) {
+	// Behind a reverse proxy on this host all clients share its address, use the address
+	// the proxy forwards, like the local network check of the authentication does
+	if ((req.host_address == "127.0.0.1") || (req.host_address == "::1")) {
+		const char *forwarded = request::get_req_header(&req, "X-Forwarded-For");
+		if ((forwarded != NULL) && (strchr(forwarded, ',') != NULL))
+			forwarded = request::get_req_header(&req, "X-Real-IP");
+		if (forwarded != NULL)
+			return forwarded;
+		// a proxy that does not forward the address, tell the users apart by their session
+		const char *cookie = request::get_req_header(&req, "Cookie");
+		if (cookie != NULL) {
+			std::string scookie = cookie;
+			size_t pos = scookie.find("SID=");
+			if (pos != std::string::npos)
+				return scookie.substr(pos + 4, scookie.find_first_of("_;", pos) - pos - 4);
+		}
+	}
+	return req.host_address;
+}
+
+} // namespace server
+} // namespace http
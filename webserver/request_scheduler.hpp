@@ -0,0 +1,115 @@
+//
+// request_scheduler.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+#pragma once
+#ifndef HTTP_REQUEST_SCHEDULER_HPP
+#define HTTP_REQUEST_SCHEDULER_HPP
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include "request.hpp"
+
+namespace http {
+namespace server {
+
+/// Request classes, in order of priority
+enum request_class {
+	REQUEST_COMMAND = 0,	// json.htm commands, device lists and actions
+	REQUEST_STATIC,			// files of the web interface
+	REQUEST_SCRIPT,			// php pages and cgi handlers, can wait on an external process
+	REQUEST_BULK,			// graphs, logs, backups and camera snapshots
+	REQUEST_CLASS_COUNT
+};
+
+/// Admission control for the request handlers.
+/// Command and static requests are handled on the io_service thread, as the handlers
+/// of the web interface expect. Script and bulk requests are handled on a small pool of
+/// workers, with a limit per client and a bounded queue. Requests that can not be queued
+/// are answered with a 503 (Service Unavailable) instead of delaying everybody else.
+class request_scheduler : private boost::noncopyable {
+public:
+	/// Called on a worker thread. retry_after is 0 when the request can be handled,
+	/// otherwise the request waited too long in the queue and should be rejected.
+	typedef boost::function< void(int retry_after) > job_func;
+
+	struct class_statistics {
+		std::string name;
+		int active;
+		int queued;
+		unsigned long handled;
+		unsigned long rejected_client;	// client had too many requests outstanding
+		unsigned long rejected_queue;	// queue of the class was full
+		unsigned long expired;			// waited longer than allowed in the queue
+		int avg_queue_time;	// ms
+		int max_queue_time;	// ms
+		int avg_exec_time;	// ms
+	};
+
+	request_scheduler();
+	~request_scheduler();
+
+	void start();
+	void stop();
+
+	/// Queue a request. Returns false when it is rejected, retry_after is then set to
+	/// the number of seconds the client should wait before trying again
+	bool submit(const std::string &client, const request_class rclass, const job_func &job, int &retry_after);
+
+	/// Handle a request of a class that is not queued on the calling thread
+	void run(const request_class rclass, const job_func &job);
+
+	std::vector<class_statistics> get_statistics();
+
+	/// Determine the class of a request from its uri
+	static request_class classify(const request &req);
+
+	/// True when requests of the class are handled on the io_service thread
+	static bool runs_inline(const request_class rclass);
+
+	/// Key that identifies the client of a request for the per client limit
+	static std::string client_key(const request &req);
+private:
+	struct queued_job {
+		std::string client;
+		request_class rclass;
+		job_func job;
+		boost::posix_time::ptime queued;
+	};
+	struct class_state {
+		std::deque<queued_job> queue;
+		int active;
+		unsigned long handled;
+		unsigned long rejected_client;
+		unsigned long rejected_queue;
+		unsigned long expired;
+		double total_queue_time;
+		int max_queue_time;
+		double total_exec_time;
+	};
+
+	void worker();
+	bool next_job(queued_job &job);
+	int get_retry_after(const request_class rclass);
+	void release_client(const std::string &client);
+
+	boost::mutex mutex_;
+	boost::condition_variable cond_;
+	bool stop_requested_;
+	std::vector<boost::shared_ptr<boost::thread> > workers_;
+	class_state classes_[REQUEST_CLASS_COUNT];
+	/// outstanding (queued and active) requests per client
+	std::map<std::string, int> clients_;
+};
+
+} // namespace server
+} // namespace http
+
+#endif // HTTP_REQUEST_SCHEDULER_HPP
@@ -25,6 +25,7 @@ server_base::server_base(const server_settings & settings, request_handler & use
 	if (!settings.is_enabled()) {
 		throw std::invalid_argument("cannot initialize a disabled server (listening port cannot be empty or 0)");
 	}
+	request_scheduler_.start();
 }
 
 void server_base::init(init_connectionhandler_func init_connection_handler, accept_handler_func accept_handler) {
@@ -103,6 +104,8 @@ void server_base::stop() {
 		}
 		sleep_milliseconds(500);
 	}
+	// Wait for the requests that are being handled
+	request_scheduler_.stop();
 }
 
 void server_base::handle_stop() {
@@ -126,7 +129,7 @@ server::server(const server_settings & settings, request_handler & user_request_
 }
 
 void server::init_connection() {
-	new_connection_.reset(new connection(io_service_, connection_manager_, request_handler_, timeout_));
+	new_connection_.reset(new connection(io_service_, connection_manager_, request_handler_, request_scheduler_, timeout_));
 }
 
 /**
@@ -136,7 +139,7 @@ void server::handle_accept(const boost::system::error_code& e) {
 	if (!e) {
 		connection_manager_.start(new_connection_);
 		new_connection_.reset(new connection(io_service_,
-				connection_manager_, request_handler_, timeout_));
+				connection_manager_, request_handler_, request_scheduler_, timeout_));
 		// listen for a subsequent request
 		acceptor_.async_accept(new_connection_->socket(),
 				boost::bind(&server::handle_accept, this,
@@ -171,7 +174,7 @@ ssl_server::ssl_server(const server_settings & settings, request_handler & user_
 
 void ssl_server::init_connection() {
 
-	new_connection_.reset(new connection(io_service_, connection_manager_, request_handler_, timeout_, context_));
+	new_connection_.reset(new connection(io_service_, connection_manager_, request_handler_, request_scheduler_, timeout_, context_));
 
 	// the following line gets the passphrase for protected private server keys
 	context_.set_password_callback(boost::bind(&ssl_server::get_passphrase, this));
@@ -241,7 +244,7 @@ void ssl_server::handle_accept(const boost::system::error_code& e) {
 	if (!e) {
 		connection_manager_.start(new_connection_);
 		new_connection_.reset(new connection(io_service_,
-				connection_manager_, request_handler_, timeout_, context_));
+				connection_manager_, request_handler_, request_scheduler_, timeout_, context_));
 		// listen for a subsequent request
 		acceptor_.async_accept(new_connection_->socket(),
 				boost::bind(&ssl_server::handle_accept, this,
@@ -11,6 +11,7 @@
 #include <boost/noncopyable.hpp>
 #include "connection_manager.hpp"
 #include "request_handler.hpp"
+#include "request_scheduler.hpp"
 #include "server_settings.hpp"
 
 namespace http {
@@ -33,6 +34,11 @@ public:
 	/// Stop the server.
 	void stop();
 
+	/// Admission control statistics of the request classes
+	std::vector<request_scheduler::class_statistics> get_request_statistics() {
+		return request_scheduler_.get_statistics();
+	}
+
 	/// Print server settings to string (debug purpose)
 	virtual std::string to_string() const {
 		return "'server_base[" + settings_.to_string() + "]'";
@@ -53,6 +59,9 @@ protected:
 	connection_ptr new_connection_;
 
 	connection_manager connection_manager_;
+
+	/// Handles the requests of all connections on its workers
+	request_scheduler request_scheduler_;
 	/// server settings
 	server_settings settings_;
 
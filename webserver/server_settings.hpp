@@ -23,8 +23,7 @@ public:
 	std::string listening_port;
 
 	std::string php_cgi_path; //if not empty, php files are handled
-	//feature
-	//std::string fastcgi_php_server; (like nginx)
+	std::string fastcgi_server; //FastCGI responder for php files (host:port or unix socket path), used instead of php_cgi_path
 
 
 	server_settings() :
@@ -34,7 +33,8 @@ public:
 		www_root(s.www_root),
 		listening_address(s.listening_address),
 		listening_port(s.listening_port),
-		php_cgi_path(s.php_cgi_path)
+		php_cgi_path(s.php_cgi_path),
+		fastcgi_server(s.fastcgi_server)
 		{}
 	virtual ~server_settings() {}
 	server_settings & operator=(const server_settings & s) {
@@ -43,6 +43,7 @@ public:
 		listening_address = s.listening_address;
 		listening_port = s.listening_port;
 		php_cgi_path = s.php_cgi_path;
+		fastcgi_server = s.fastcgi_server;
 		return *this;
 	}
 	bool is_secure() const {
@@ -52,7 +53,7 @@ public:
 		return ((listening_port != "0") && (listening_port != ""));
 	}
 	bool is_php_enabled() const {
-		return !php_cgi_path.empty();
+		return ((!php_cgi_path.empty()) || (!fastcgi_server.empty()));
 	}
 	/**
 	 * Set relevant values
@@ -62,6 +63,7 @@ public:
 		listening_address = get_valid_value(listening_address, settings.listening_address);
 		listening_port = get_valid_value(listening_port, settings.listening_port);
 		php_cgi_path = get_valid_value(php_cgi_path, settings.php_cgi_path);
+		fastcgi_server = get_valid_value(fastcgi_server, settings.fastcgi_server);
 		if (listening_port == "0") {
 			listening_port.clear();// server NOT enabled
 		}
@@ -73,6 +75,7 @@ public:
 			", listening_address='" + listening_address + "'" +
 			", listening_port='" + listening_port + "'" +
 			", php_cgi_path='" + php_cgi_path + "'" +
+			", fastcgi_server='" + fastcgi_server + "'" +
 			"]'";
 	}
 
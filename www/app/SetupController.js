@@ -405,6 +405,9 @@ define(['app'], function (app) {
 			  if (typeof data.ShortLogInterval != 'undefined') {
 				$("#shortlogtable #comboshortloginterval").val(data.ShortLogInterval);
 			  }
+			  if (typeof data.EpochTimestamps != 'undefined') {
+				$("#shortlogtable #EpochTimestamps").prop('checked',data.EpochTimestamps==1);
+			  }
 			  if (typeof data.DashboardType != 'undefined') {
 				$("#dashmodetable #combosdashtype").val(data.DashboardType);
 			  }
@@ -574,6 +577,9 @@ define(['app'], function (app) {
 			  if (typeof data.ShowUpdateEffect!= 'undefined') {
 				$("#acceptnewhardwaretable #ShowUpdateEffect").prop('checked',data.ShowUpdateEffect==1);
 			  }
+			  if (typeof data.PythonPluginThreads != 'undefined') {
+				$("#acceptnewhardwaretable #PythonPluginThreads").val(data.PythonPluginThreads);
+			  }
 
 			  if (typeof data.DisableEventScriptSystem!= 'undefined') {
 				$("#eventsystemtable #DisableEventScriptSystem").prop('checked',data.DisableEventScriptSystem==1);
@@ -581,6 +587,9 @@ define(['app'], function (app) {
 			  if (typeof data.LogEventScriptTrigger != 'undefined') {
 			    $("#eventsystemtable #LogEventScriptTrigger").prop('checked',data.LogEventScriptTrigger==1);
 			  }
+			  if (typeof data.LuaScriptTimeout != 'undefined') {
+				$("#eventsystemtable #LuaScriptTimeout").val(data.LuaScriptTimeout);
+			  }
 
 			  if (typeof data.FloorplanPopupDelay!= 'undefined') {
 				$("#floorplanoptionstable #FloorplanPopupDelay").val(data.FloorplanPopupDelay);
@@ -626,6 +635,9 @@ define(['app'], function (app) {
 			  if (typeof data.LogFileName != 'undefined') {
 					$("#LogDebug #LogFilterTable #LogFileName").val(data.LogFileName);
 			  }
+			  if (typeof data.LogTraceCategories != 'undefined') {
+					$("#LogDebug #LogFilterTable #LogTraceCategories").val(data.LogTraceCategories);
+			  }
 			  if (typeof data.cloudenabled != 'undefined') {
 				  if (!data.cloudenabled) {
 					  $("#MyDomoticzTab").css("display", "none");